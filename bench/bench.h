@@ -0,0 +1,51 @@
+#ifndef DEEPC_BENCH_H
+#define DEEPC_BENCH_H
+
+#include <string>
+#include <chrono>
+
+
+namespace deepC
+{
+
+
+//
+// A simple stopwatch for timing benchmark runs.
+//
+
+class BenchTimer
+{
+private:
+    std::chrono::steady_clock::time_point start_;
+
+public:
+    BenchTimer() : start_(std::chrono::steady_clock::now()) {}
+
+    void   restart()       { start_ = std::chrono::steady_clock::now(); }
+    double seconds() const { return std::chrono::duration<double>(std::chrono::steady_clock::now() - start_).count(); }
+};
+
+
+// Print a result line in a consistent format, eg. "put/single  1234.5 objects/sec".
+void benchReport(const std::string &name, double count, const std::string &unit, double seconds);
+
+// Make a temporary directory for benchmarks which need scratch files.
+std::string benchTempDir();
+
+// Remove a temporary directory and everything in it.
+void benchRemoveDir(const std::string &dirName);
+
+
+// The benchmarks.
+void benchProgramDb();
+void benchLineIndex();
+void benchCLexer();
+void benchRelex();
+void benchParallelLex();
+void benchKeywords();
+void benchScan();
+
+
+} // namespace deepC
+
+#endif // DEEPC_BENCH_H
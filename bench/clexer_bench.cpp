@@ -0,0 +1,177 @@
+#include <cstdlib>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include "bench.h"
+#include "clexer.h"
+#include "interner.h"
+#include "threadpool.h"
+
+
+namespace deepC
+{
+
+
+// How much text to lex and how many times.
+static const size_t textSize = 16 * 1024 * 1024;
+static const int    repeats = 10;
+
+
+//
+// Make text which looks like a large generated header.
+//
+
+static std::string makeHeader(size_t size)
+{
+    std::string text;
+    text.reserve(size + 256);
+    for (int i = 0; text.size() < size; i++)
+    {
+        std::string n = std::to_string(i);
+        text += "/* Register block " + n + " */\n";
+        text += "#define REG_" + n + "_BASE 0x" + std::to_string(40000000 + i) + "UL\n";
+        text += "typedef struct reg_block_" + n + " {\n";
+        text += "    volatile unsigned int ctrl;      // Control register.\n";
+        text += "    volatile unsigned int status[4];\n";
+        text += "    const char *name;\n";
+        text += "} reg_block_" + n + "_t;\n";
+        text += "static inline int reg_" + n + "_ready(const reg_block_" + n + "_t *r) { return (r->status[0] & 0x1u) != 0 && r->ctrl >= 1.5e3; }\n";
+        text += "extern const char reg_" + n + "_label[] = \"block " + n + "\\n\";\n\n";
+    }
+
+    return text;
+}
+
+
+//
+// Measure how fast the lexer gets through a big header.
+//
+
+void benchCLexer()
+{
+    std::string text = makeHeader(textSize);
+    TokenStream tokens;
+
+    BenchTimer timer;
+    for (int i = 0; i < repeats; i++)
+    {
+        tokens.clear();
+        CLexer lexer(text);
+        lexer.lexAll(&tokens);
+    }
+
+    double seconds = timer.seconds();
+    benchReport("lex", static_cast<double>(text.size()) * repeats / (1024 * 1024), "MB", seconds);
+    benchReport("lex", static_cast<double>(tokens.size()) * repeats, "tokens", seconds);
+}
+
+
+//
+// Compare relexing a 50,000 line file after a one character change with
+// lexing it all again.
+//
+
+void benchRelex()
+{
+    const size_t lines = 50000;
+    std::string text = makeHeader(4 * 1024 * 1024);
+    size_t end = 0;
+    for (size_t line = 0; line < lines; line++)
+    {
+        end = text.find('\n', end) + 1;
+    }
+
+    text.resize(end);
+
+    TokenStream oldTokens;
+    CLexer oldLexer(text);
+    oldLexer.lexAll(&oldTokens);
+
+    // Make the edits first so only the lexing is timed.
+    const int edits = 200;
+    std::vector<std::string> edited;
+    srand(1);
+    for (int i = 0; i < edits; i++)
+    {
+        std::string changed = text;
+        changed[rand() % changed.size()] = "x; +\n"[i % 5];
+        edited.push_back(changed);
+    }
+
+    TokenStream tokens;
+    size_t lexed = 0;
+    BenchTimer timer;
+    for (const std::string &changed : edited)
+    {
+        CLexer lexer(changed);
+        lexer.relex(text, oldTokens, &tokens);
+        lexed += lexer.lexedTokens();
+    }
+
+    double seconds = timer.seconds();
+    std::cout << lines << " lines, " << oldTokens.size() << " tokens, " << static_cast<double>(lexed) / edits << " tokens lexed per edit" << std::endl;
+    benchReport("relex/one-char", edits, "edits", seconds);
+
+    timer.restart();
+    for (const std::string &changed : edited)
+    {
+        tokens.clear();
+        CLexer lexer(changed);
+        lexer.lexAll(&tokens);
+    }
+
+    benchReport("relex/full-lex", edits, "edits", timer.seconds());
+}
+
+
+//
+// Compare lexing lots of files one after another with lexing them on a
+// thread pool, interning their identifiers into one table.
+//
+
+void benchParallelLex()
+{
+    const int numFiles = 256;
+    std::vector<std::string> texts;
+    size_t totalSize = 0;
+    for (int i = 0; i < numFiles; i++)
+    {
+        texts.push_back(makeHeader(256 * 1024));
+        totalSize += texts.back().size();
+    }
+
+    {
+        Interner interner;
+        BenchTimer timer;
+        for (const std::string &text : texts)
+        {
+            TokenStream tokens;
+            CLexer lexer(text);
+            lexer.setInterner(&interner);
+            lexer.lexAll(&tokens);
+        }
+
+        benchReport("parallel/1-thread", static_cast<double>(totalSize) / (1024 * 1024), "MB", timer.seconds());
+    }
+
+    Interner interner;
+    ThreadPool pool;
+    BenchTimer timer;
+    for (const std::string &text : texts)
+    {
+        pool.submit([&text, &interner](size_t)
+        {
+            TokenStream tokens;
+            CLexer lexer(text);
+            lexer.setInterner(&interner);
+            lexer.lexAll(&tokens);
+        });
+    }
+
+    pool.wait();
+    benchReport("parallel/" + std::to_string(pool.size()) + "-threads", static_cast<double>(totalSize) / (1024 * 1024), "MB", timer.seconds());
+}
+
+
+} // namespace deepC
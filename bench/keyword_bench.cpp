@@ -0,0 +1,148 @@
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+#include <ftw.h>
+
+#include "bench.h"
+#include "clexer.h"
+
+
+// Where to find some real C code to look words up from.
+#ifndef DEEPC_SOURCE_DIR
+#define DEEPC_SOURCE_DIR "."
+#endif
+
+
+namespace deepC
+{
+
+
+// How many lookups to time for each method.
+static const size_t lookups = 50 * 1000 * 1000;
+
+// The C files found so far.
+static std::vector<std::string> *foundFiles;
+
+
+//
+// Remember C source files while walking a directory.
+//
+
+static int findCFile(const char *path, const struct stat *, int type, struct FTW *)
+{
+    std::string_view name(path);
+    if (type == FTW_F && name.size() > 2 && (name.substr(name.size() - 2) == ".c" || name.substr(name.size() - 2) == ".h"))
+    {
+        foundFiles->push_back(path);
+    }
+
+    return 0;
+}
+
+
+//
+// Time looking up each word with the perfect hash and with an
+// unordered_map.
+//
+
+template <typename Enum> static void benchLookup(const std::string &name, const std::vector<std::string_view> &words,
+                                                 Enum (*find)(const char *, size_t), const char *const *texts, int numTexts)
+{
+    std::unordered_map<std::string_view, Enum> map;
+    for (int i = 1; i <= numTexts; i++)
+    {
+        map[texts[i]] = static_cast<Enum>(i);
+    }
+
+    size_t repeats = lookups / words.size() + 1;
+    size_t hashFound = 0;
+    BenchTimer timer;
+    for (size_t r = 0; r < repeats; r++)
+    {
+        for (std::string_view word : words)
+        {
+            hashFound += find(word.data(), word.size()) != Enum::None;
+        }
+    }
+
+    benchReport(name + "/perfect-hash", static_cast<double>(words.size() * repeats), "lookups", timer.seconds());
+
+    size_t mapFound = 0;
+    timer.restart();
+    for (size_t r = 0; r < repeats; r++)
+    {
+        for (std::string_view word : words)
+        {
+            mapFound += map.find(word) != map.end();
+        }
+    }
+
+    benchReport(name + "/unordered_map", static_cast<double>(words.size() * repeats), "lookups", timer.seconds());
+
+    if (hashFound != mapFound)
+    {
+        std::cerr << name << ": perfect hash found " << hashFound << " but unordered_map found " << mapFound << std::endl;
+    }
+}
+
+
+//
+// Compare keyword and punctuator lookup using the perfect hash against
+// an unordered_map, using the identifiers and punctuators from the C
+// code in old/.
+//
+
+void benchKeywords()
+{
+    std::vector<std::string> fileNames;
+    foundFiles = &fileNames;
+    std::string dirName = std::string(DEEPC_SOURCE_DIR) + "/old";
+    nftw(dirName.c_str(), findCFile, 16, FTW_PHYS);
+
+    std::vector<std::string> sources;
+    for (const std::string &fileName : fileNames)
+    {
+        std::ifstream in(fileName);
+        std::stringstream text;
+        text << in.rdbuf();
+        sources.push_back(text.str());
+    }
+
+    // Get the words in the order they appear.
+    std::vector<std::string_view> identifiers;
+    std::vector<std::string_view> punctuators;
+    for (const std::string &source : sources)
+    {
+        TokenStream tokens;
+        CLexer lexer(source);
+        lexer.lexAll(&tokens);
+        for (size_t i = 0; i < tokens.size(); i++)
+        {
+            if (tokens.kind(i) == TokenKind::Identifier)
+            {
+                identifiers.push_back(tokens.text(i, source));
+            }
+            else if (tokens.kind(i) == TokenKind::Punctuator)
+            {
+                punctuators.push_back(tokens.text(i, source));
+            }
+        }
+    }
+
+    if (identifiers.empty() || punctuators.empty())
+    {
+        std::cerr << "no C code found in " << dirName << std::endl;
+        return;
+    }
+
+    std::cout << fileNames.size() << " files, " << identifiers.size() << " identifiers, " << punctuators.size() << " punctuators" << std::endl;
+    benchLookup("keyword", identifiers, lexTables::findKeyword, lexTables::keywordText, lexTables::numKeywords);
+    benchLookup("punctuator", punctuators, lexTables::findPunctuator, lexTables::punctuatorText, lexTables::numPunctuators);
+}
+
+
+} // namespace deepC
@@ -0,0 +1,119 @@
+#include <cstdlib>
+#include <initializer_list>
+#include <iostream>
+#include <string>
+
+#include "bench.h"
+#include "clexer.h"
+#include "lexscan.h"
+
+
+namespace deepC
+{
+
+
+// How much text to scan and how many times.
+static const size_t corpusSize = 16 * 1024 * 1024;
+static const int    repeats = 10;
+
+
+//
+// Make text which looks like ordinary source code, with comment blocks,
+// indentation and long names, which is where the kernels are meant to
+// help.
+//
+
+static std::string makeCorpus(size_t size)
+{
+    std::string text;
+    text.reserve(size + 1024);
+    srand(1);
+    for (int i = 0; text.size() < size; i++)
+    {
+        std::string n = std::to_string(i);
+        text += "/*\n * Handle the completion of request " + n + ". The queue lock must be held by\n"
+                " * the caller, and the request must already have been removed from the list.\n */\n";
+        text += "static int handle_request_completion_" + n + "(struct request_queue_state *queue_state, unsigned long flags)\n{\n";
+        for (int line = rand() % 12; line >= 0; line--)
+        {
+            text += std::string(4 * (1 + line % 4), ' ');
+            text += "queue_state->pending_request_count_" + n + " += compute_request_weight(flags, 0x" + std::to_string(rand()) + "ULL); // Update the totals.\n";
+        }
+
+        text += "    return queue_state->pending_request_count_" + n + " > 1.5e3;\n}\n\n";
+    }
+
+    return text;
+}
+
+
+//
+// Time one kernel by calling it from every position it stops at, which is
+// how the lexer uses it.
+//
+
+static void benchKernel(const std::string &name, const std::string &text, size_t (*kernel)(const char *, size_t, size_t))
+{
+    BenchTimer timer;
+    for (int i = 0; i < repeats; i++)
+    {
+        for (size_t pos = 0; pos < text.size(); pos++)
+        {
+            pos = kernel(text.data(), pos, text.size());
+        }
+    }
+
+    double seconds = timer.seconds();
+    benchReport(name, static_cast<double>(text.size()) * repeats / (1024 * 1024), "MB", seconds);
+}
+
+
+//
+// Compare the kernels for each instruction set this CPU supports, on
+// their own and in the lexer.
+//
+
+void benchScan()
+{
+    std::string corpus = makeCorpus(corpusSize);
+    std::string blanks = std::string(corpusSize / 64, ' ') + "x";
+    std::string comment = makeCorpus(corpusSize / 4);
+    for (char &ch : comment)
+    {
+        // Take out everything which could end a run.
+        if (ch == '*' || ch == '\n' || ch == '\\')
+        {
+            ch = ' ';
+        }
+    }
+
+    std::cout << "best: " << bestScanKernels().name << std::endl;
+    for (ScanLevel level : { ScanLevel::Portable, ScanLevel::Sse42, ScanLevel::Avx2 })
+    {
+        const ScanKernels *kernels = scanKernels(level);
+        if (kernels == nullptr)
+            continue;
+
+        std::string prefix = std::string(kernels->name) + "/";
+        benchKernel(prefix + "blanks", blanks, kernels->skipBlanks);
+        benchKernel(prefix + "identifiers", corpus, kernels->skipIdentifier);
+        benchKernel(prefix + "comment", comment, kernels->findCommentEnd);
+        benchKernel(prefix + "linebreaks", corpus, kernels->findLineBreak);
+
+        TokenStream tokens;
+        BenchTimer timer;
+        for (int i = 0; i < repeats; i++)
+        {
+            tokens.clear();
+            CLexer lexer(corpus);
+            lexer.setScanKernels(*kernels);
+            lexer.lexAll(&tokens);
+        }
+
+        double seconds = timer.seconds();
+        benchReport(prefix + "lex", static_cast<double>(corpus.size()) * repeats / (1024 * 1024), "MB", seconds);
+    }
+}
+
+
+} // namespace deepC
@@ -0,0 +1,143 @@
+#include <iostream>
+#include <string>
+#include <string_view>
+#include <vector>
+#include <random>
+#include <algorithm>
+
+#include "bench.h"
+#include "lineindex.h"
+
+
+namespace deepC
+{
+
+
+// The size of each test file and how many times to scan it.
+static const size_t textSizes[] = { 1 * 1024 * 1024, 4 * 1024 * 1024, 16 * 1024 * 1024 };
+static const int    repeats = 20;
+
+
+//
+// Make some text with source-like line lengths.
+//
+
+static std::string makeText(size_t size)
+{
+    std::mt19937 rng(42);
+    std::string text;
+    text.reserve(size);
+    while (text.size() < size)
+    {
+        size_t len = rng() % 100;
+        if (rng() % 8 == 0)
+        {
+            len = 0;
+        }
+
+        text.append(std::min(len, size - text.size()), 'x');
+        text += '\n';
+    }
+
+    text.resize(size);
+    return text;
+}
+
+
+//
+// The way SourceFile used to split lines, for comparison.
+//
+
+static size_t splitWithFind(std::string_view text)
+{
+    std::vector<std::string_view> lines;
+    size_t pos = 0;
+    while (pos < text.size())
+    {
+        size_t nl = text.find("\n", pos);
+        if (nl == std::string_view::npos)
+        {
+            lines.push_back(text.substr(pos));
+            break;
+        }
+
+        lines.push_back(text.substr(pos, nl - pos));
+        pos = nl + 1;
+    }
+
+    return lines.size();
+}
+
+
+//
+// Time one way of scanning.
+//
+
+using ScanFunc = void (*)(const char *, size_t, uint32_t, std::vector<uint32_t> *);
+
+static void benchScan(const std::string &name, const std::string &text, ScanFunc scan)
+{
+    std::vector<uint32_t> starts;
+    BenchTimer timer;
+    for (int i = 0; i < repeats; i++)
+    {
+        starts.clear();
+        scan(text.data(), text.size(), 0, &starts);
+    }
+
+    benchReport(name, static_cast<double>(text.size()) * repeats / (1024 * 1024), "MB", timer.seconds());
+}
+
+
+//
+// Compare the newline scanners on multi-megabyte files.
+//
+
+void benchLineIndex()
+{
+    std::cout << "sse2: " << (LineIndex::haveSse2() ? "yes" : "no")
+              << ", avx2: " << (LineIndex::haveAvx2() ? "yes" : "no") << std::endl;
+
+    for (size_t size : textSizes)
+    {
+        std::string text = makeText(size);
+        std::string suffix = "/" + std::to_string(size / (1024 * 1024)) + "MB";
+
+        BenchTimer timer;
+        size_t lines = 0;
+        for (int i = 0; i < repeats; i++)
+        {
+            lines = splitWithFind(text);
+        }
+
+        benchReport("find" + suffix, static_cast<double>(text.size()) * repeats / (1024 * 1024), "MB", timer.seconds());
+
+        benchScan("scalar" + suffix, text, LineIndex::scanScalar);
+        if (LineIndex::haveSse2())
+        {
+            benchScan("sse2" + suffix, text, LineIndex::scanSse2);
+        }
+
+        if (LineIndex::haveAvx2())
+        {
+            benchScan("avx2" + suffix, text, LineIndex::scanAvx2);
+        }
+
+        LineIndex index;
+        timer.restart();
+        for (int i = 0; i < repeats; i++)
+        {
+            index.build(text);
+        }
+
+        benchReport("build" + suffix, static_cast<double>(text.size()) * repeats / (1024 * 1024), "MB", timer.seconds());
+
+        if (index.lineCount() != lines)
+        {
+            std::cout << "line counts differ: " << index.lineCount() << " vs " << lines << std::endl;
+        }
+    }
+}
+
+
+} // namespace deepC
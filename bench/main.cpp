@@ -0,0 +1,115 @@
+#include <iostream>
+#include <iomanip>
+#include <cstdlib>
+#include <cstring>
+#include <ftw.h>
+#include <unistd.h>
+
+#include "bench.h"
+
+
+namespace deepC
+{
+
+
+//
+// Print a result line in a consistent format.
+//
+
+void benchReport(const std::string &name, double count, const std::string &unit, double seconds)
+{
+    double rate = seconds > 0.0 ? count / seconds : 0.0;
+    std::cout << std::left << std::setw(32) << name
+              << std::right << std::setw(16) << std::fixed << std::setprecision(1) << rate
+              << " " << unit << "/sec"
+              << "  (" << count << " in " << std::setprecision(3) << seconds << "s)" << std::endl;
+}
+
+
+//
+// Make a temporary directory for benchmarks which need scratch files.
+//
+
+std::string benchTempDir()
+{
+    const char *tmp = getenv("TMPDIR");
+    std::string pattern = std::string(tmp ? tmp : "/tmp") + "/deepcbench.XXXXXX";
+    if (mkdtemp(&pattern[0]) == nullptr)
+    {
+        std::cerr << "can't create temporary directory " << pattern << ": " << strerror(errno) << std::endl;
+        exit(EXIT_FAILURE);
+    }
+
+    return pattern;
+}
+
+
+//
+// Remove a temporary directory and everything in it.
+//
+
+static int removeEntry(const char *path, const struct stat *, int, struct FTW *)
+{
+    return remove(path);
+}
+
+void benchRemoveDir(const std::string &dirName)
+{
+    nftw(dirName.c_str(), removeEntry, 16, FTW_DEPTH | FTW_PHYS);
+}
+
+
+} // namespace deepC
+
+
+using namespace deepC;
+
+
+//
+// The available benchmarks.
+//
+
+struct BenchEntry
+{
+    const char *name;
+    void      (*run)();
+};
+
+static const BenchEntry benchmarks[] =
+{
+    { "programdb", benchProgramDb },
+    { "lineindex", benchLineIndex },
+    { "clexer",    benchCLexer },
+    { "relex",     benchRelex },
+    { "parallel",  benchParallelLex },
+    { "keywords",  benchKeywords },
+    { "scan",      benchScan },
+};
+
+
+//
+// Run all the benchmarks or just the ones named on the command line.
+//
+
+int main(int argc, char *argv[])
+{
+    for (const BenchEntry &b : benchmarks)
+    {
+        bool wanted = (argc == 1);
+        for (int i = 1; i < argc; i++)
+        {
+            if (strcmp(argv[i], b.name) == 0)
+            {
+                wanted = true;
+            }
+        }
+
+        if (wanted)
+        {
+            std::cout << "--- " << b.name << std::endl;
+            b.run();
+        }
+    }
+
+    return 0;
+}
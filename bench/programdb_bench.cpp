@@ -0,0 +1,121 @@
+#include <string>
+#include <vector>
+#include <memory>
+#include <thread>
+#include <iostream>
+
+#include "bench.h"
+#include "programdb.h"
+#include "sourcefile.h"
+
+
+namespace deepC
+{
+
+
+// How many source files to store in each run.
+static const int numSourceFiles = 2000;
+
+
+//
+// Make a set of plausible looking headers.
+//
+
+static std::vector<std::unique_ptr<SourceFileInMemory>> makeSourceFiles(const std::string &prefix)
+{
+    std::vector<std::unique_ptr<SourceFileInMemory>> files;
+    for (int i = 0; i < numSourceFiles; i++)
+    {
+        std::string text;
+        text += "#ifndef HEADER_" + std::to_string(i) + "_H\n";
+        text += "#define HEADER_" + std::to_string(i) + "_H\n\n";
+        for (int j = 0; j < 50; j++)
+        {
+            text += "extern int function_" + std::to_string(i) + "_" + std::to_string(j) + "(int a, const char *b);\n";
+        }
+
+        text += "\n#endif\n";
+        files.push_back(std::make_unique<SourceFileInMemory>(prefix + "/include/header" + std::to_string(i) + ".h", text));
+    }
+
+    return files;
+}
+
+
+//
+// Compare storing source files one transaction at a time with storing
+// them in batches.
+//
+
+void benchProgramDb()
+{
+    std::string dirName = benchTempDir();
+
+    {
+        auto pdb = ProgramDb::create(dirName);
+
+        // One write transaction per object.
+        auto singleFiles = makeSourceFiles("single");
+        BenchTimer timer;
+        for (auto &sf : singleFiles)
+        {
+            pdb->put(*sf);
+        }
+
+        benchReport("programdb put/single", numSourceFiles, "objects", timer.seconds());
+
+        // Look them all up again. These share a single read snapshot.
+        timer.restart();
+        for (auto &sf : singleFiles)
+        {
+            pdb->get(Storable::DbGroup::SourceFiles, pdb->getId(*sf));
+        }
+
+        benchReport("programdb get", numSourceFiles, "objects", timer.seconds());
+
+        // The same lookups from several threads at once.
+        const int numThreads = 8;
+        std::vector<std::thread> threads;
+        timer.restart();
+        for (int t = 0; t < numThreads; t++)
+        {
+            threads.emplace_back([pdb, &singleFiles]() {
+                for (auto &sf : singleFiles)
+                {
+                    pdb->get(Storable::DbGroup::SourceFiles, pdb->getId(*sf));
+                }
+            });
+        }
+
+        for (auto &thread : threads)
+        {
+            thread.join();
+        }
+
+        benchReport("programdb get/" + std::to_string(numThreads) + "threads", numSourceFiles * numThreads, "objects", timer.seconds());
+
+        ProgramDb::ReadStats stats = pdb->readStats();
+        std::cout << "read transactions: " << stats.threadHits << " thread hits, "
+                  << stats.renewed << " renewed, " << stats.created << " created" << std::endl;
+
+        // Batched at a few different commit intervals.
+        for (size_t interval : { 10, 100, 1000, 0 })
+        {
+            auto batchFiles = makeSourceFiles("batch" + std::to_string(interval));
+            timer.restart();
+            ProgramDb::Batch batch(*pdb, interval);
+            for (auto &sf : batchFiles)
+            {
+                batch.put(*sf);
+            }
+
+            batch.commit();
+            benchReport("programdb put/batch" + std::to_string(interval), numSourceFiles, "objects", timer.seconds());
+        }
+    }
+
+    benchRemoveDir(dirName);
+}
+
+
+} // namespace deepC
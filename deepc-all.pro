@@ -4,4 +4,5 @@ SUBDIRS += \
     libdeepcc \
     deepc \
     tests \
+    bench \
     deepcserv
@@ -19,4 +19,4 @@ else:win32:!win32-g++:CONFIG(release, debug|release): PRE_TARGETDEPS += $$OUT_PW
 else:win32:!win32-g++:CONFIG(debug, debug|release): PRE_TARGETDEPS += $$OUT_PWD/../libdeepcc/debug/libdeepcc.lib
 else:unix: PRE_TARGETDEPS += $$OUT_PWD/../libdeepcc/liblibdeepcc.a
 
-unix|win32: LIBS += -llmdb
+unix|win32: LIBS += -llmdb -lpthread
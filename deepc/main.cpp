@@ -1,10 +1,14 @@
 #include <iostream>
 #include <getopt.h>
 #include <cctype>
+#include <cstdlib>
+#include <thread>
 
 #include "compileargs.h"
 #include "compiler.h"
+#include "cparser.h"
 #include "fail.h"
+#include "preprocessor.h"
 
 
 using namespace deepC;
@@ -26,6 +30,8 @@ int main(int argc, char *argv[])
         {"include",       required_argument, nullptr,  'I' },
         {"define",        required_argument, nullptr,  'D' },
         {"warning",       required_argument, nullptr,  'W' },
+        {"db-stats",      no_argument,       nullptr,  'S' },
+        {"jobs",          required_argument, nullptr,  'j' },
         {0,               0,                 0,        0   }
     };
 
@@ -34,12 +40,13 @@ int main(int argc, char *argv[])
     std::vector<std::string> includePath;
     std::vector<std::string> defines;
     std::vector<std::string> warnings;
+    bool showDbStats = false;
 
     // Read the command line parameters.
     int flag = 0;
     do
     {
-        flag = getopt_long(argc, argv, "O:co:gI:W:", longOpts, &longInd);
+        flag = getopt_long(argc, argv, "O:co:gI:W:j:", longOpts, &longInd);
         if (flag >= 0)
         {
             switch (flag)
@@ -76,6 +83,24 @@ int main(int argc, char *argv[])
             case 'W':
                 warnings.push_back(optarg);
                 break;
+
+            case 'S':
+                showDbStats = true;
+                break;
+
+            case 'j':
+                if (!std::isdigit(optarg[0]))
+                {
+                    failf("invalid number of jobs");
+                }
+
+                // Zero means one per hardware thread.
+                args.setJobs(std::atoi(optarg));
+                if (args.jobs() == 0)
+                {
+                    args.setJobs(std::thread::hardware_concurrency());
+                }
+                break;
             }
         }
     } while (flag >= 0);
@@ -86,18 +111,47 @@ int main(int argc, char *argv[])
     args.setWarnings(warnings);
 
     // Get file args.
-    if (optind == argc)
+    if (optind == argc && !showDbStats)
     {
         failf("no files provided");
     }
 
-    // Compile each of the file arguments.
-    Compiler comp(args);
-    while (optind < argc)
+    // Compile the file arguments. Errors in the source are reported with
+    // where they are.
+    bool ok = false;
+    try
+    {
+        Compiler comp(args);
+        ok = comp.compileAll(std::vector<std::string>(argv + optind, argv + argc));
+
+        // Show what's in the program database.
+        if (showDbStats)
+        {
+            ProgramDb::Stats stats = comp.programDb()->stats();
+            std::cout << "source files:  " << stats.sourceFiles << std::endl;
+            std::cout << "source blobs:  " << stats.blobs << std::endl;
+            std::cout << "logical bytes: " << stats.logicalBytes << std::endl;
+            std::cout << "stored bytes:  " << stats.storedBytes << std::endl;
+            std::cout << "dedup ratio:   " << stats.dedupRatio() << std::endl;
+            std::cout << "identifiers:   " << stats.identifiers << std::endl;
+        }
+    }
+    catch (const PreprocessorException &e)
+    {
+        failf("%s", e.what());
+    }
+    catch (const ParserException &e)
+    {
+        failf("%s", e.what());
+    }
+    catch (const SourceFileException &e)
+    {
+        failf("%s", e.what());
+    }
+    catch (const ProgramDbException &e)
     {
-        comp.compile(argv[optind]);
-        optind++;
+        failf("program database: %s", e.what());
     }
 
-    return 0;
+    return ok ? EXIT_SUCCESS : EXIT_FAILURE;
 }
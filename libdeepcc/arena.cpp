@@ -0,0 +1,69 @@
+#include <cstdint>
+
+#include "arena.h"
+
+
+namespace deepC
+{
+
+
+//
+// Constructor.
+//
+
+Arena::Arena(size_t blockSize) :
+    blockSize_(blockSize),
+    next_(nullptr),
+    remaining_(0),
+    allocated_(0)
+{
+}
+
+
+//
+// How far to move a pointer to get the given alignment.
+//
+
+static size_t alignPadding(const char *ptr, size_t align)
+{
+    return (align - (reinterpret_cast<uintptr_t>(ptr) & (align - 1))) & (align - 1);
+}
+
+
+//
+// Allocate some memory from the arena. Large allocations get a block of
+// their own so they don't waste the rest of the current block.
+//
+
+void *Arena::allocate(size_t size, size_t align)
+{
+    size_t padding = alignPadding(next_, align);
+    if (next_ == nullptr || padding + size > remaining_)
+    {
+        // new[] gives us max_align_t alignment, so allow for anything stricter.
+        size_t extra = align > alignof(std::max_align_t) ? align : 0;
+        if (size > blockSize_ / 4)
+        {
+            // A block of its own. The current block is still used afterwards.
+            blocks_.push_back(std::unique_ptr<char[]>(new char[size + extra]));
+            char *block = blocks_.back().get();
+            allocated_ += size;
+            return block + alignPadding(block, align);
+        }
+
+        // Start a new block.
+        blocks_.push_back(std::unique_ptr<char[]>(new char[blockSize_ + extra]));
+        next_ = blocks_.back().get();
+        remaining_ = blockSize_ + extra;
+        padding = alignPadding(next_, align);
+    }
+
+    char *mem = next_ + padding;
+    next_ += padding + size;
+    remaining_ -= padding + size;
+    allocated_ += size;
+    return mem;
+}
+
+
+} // namespace deepC
@@ -0,0 +1,49 @@
+#ifndef DEEPC_ARENA_H
+#define DEEPC_ARENA_H
+
+#include <cstddef>
+#include <memory>
+#include <vector>
+
+
+namespace deepC
+{
+
+
+//
+// A simple bump allocator. Memory is handed out from large blocks and is
+// only freed all at once when the arena is destroyed, which suits data
+// like source text and tokens which live for the whole compilation.
+//
+// An arena isn't thread safe.
+//
+
+class Arena
+{
+public:
+    // The size of each block unless told otherwise.
+    static constexpr size_t defaultBlockSize = 64 * 1024;
+
+private:
+    size_t                               blockSize_;
+    std::vector<std::unique_ptr<char[]>> blocks_;
+    char                                *next_;         // Next free byte in the current block.
+    size_t                               remaining_;    // Bytes left in the current block.
+    size_t                               allocated_;    // Total bytes handed out.
+
+public:
+    explicit Arena(size_t blockSize = defaultBlockSize);
+    Arena(const Arena &) = delete;
+    Arena &operator=(const Arena &) = delete;
+
+    // Allocate some memory which lasts as long as the arena.
+    void  *allocate(size_t size, size_t align = alignof(std::max_align_t));
+
+    size_t bytesAllocated() const { return allocated_; }
+    size_t blockCount() const     { return blocks_.size(); }
+};
+
+
+} // namespace deepC
+
+#endif // DEEPC_ARENA_H
@@ -1,19 +1,458 @@
+#include <algorithm>
 #include <string>
 #include <memory>
+#include <vector>
 
 #include "clexer.h"
-#include "programdb.h"
+#include "clexertables.h"
+#include "diff.h"
+#include "interner.h"
+#include "lexscan.h"
+#include "sourcefile.h"
 
 
 namespace deepC
 {
 
 
-CLexer::CLexer(std::shared_ptr<ProgramDb> pdb, const std::string &sourceFileName) :
-    pdb_(pdb),
-    sourceFileName_(sourceFileName)
+//
+// Constructor for lexing a source file.
+//
+
+CLexer::CLexer(const std::shared_ptr<SourceFile> &sourceFile) :
+    sourceFile_(sourceFile),
+    text_(sourceFile->sourceText()),
+    fileId_(sourceFile->id()),
+    pos_(0),
+    atLineStart_(true),
+    interner_(nullptr),
+    lexedTokens_(0),
+    scan_(&bestScanKernels())
+{
+    if (text_.size() > LineIndex::maxTextSize)
+        throw SourceFileException(std::string("source file ") + sourceFile->fileName() + " is too big");
+}
+
+
+//
+// Constructor for lexing some text.
+//
+
+CLexer::CLexer(std::string_view text, uint32_t fileId) :
+    text_(text),
+    fileId_(fileId),
+    pos_(0),
+    atLineStart_(true),
+    interner_(nullptr),
+    lexedTokens_(0),
+    scan_(&bestScanKernels())
+{
+}
+
+
+//
+// Skip whitespace and comments. Returns the flags for the token which
+// follows.
+//
+
+uint8_t CLexer::skipWhitespace()
+{
+    const char *text = text_.data();
+    size_t size = text_.size();
+    size_t pos = pos_;
+    uint8_t flags = 0;
+
+    while (pos < size)
+    {
+        char ch = text[pos];
+        if (ch == ' ' || ch == '\t')
+        {
+            // By far the most common case. Indentation comes in long runs.
+            pos++;
+            if (pos < size && (text[pos] == ' ' || text[pos] == '\t'))
+            {
+                pos = scan_->skipBlanks(text, pos + 1, size);
+            }
+
+            flags |= Token::PrecededBySpace;
+        }
+        else if (ch > ' ' && ch != '/' && ch != '\\')
+        {
+            // Quickly get back to the tokens.
+            break;
+        }
+        else if (ch == '\r' || ch == '\f' || ch == '\v')
+        {
+            pos++;
+            flags |= Token::PrecededBySpace;
+        }
+        else if (ch == '\n')
+        {
+            pos++;
+            atLineStart_ = true;
+            flags |= Token::PrecededBySpace;
+        }
+        else if (ch == '\\' && pos + 1 < size && (text[pos + 1] == '\n' || (text[pos + 1] == '\r' && pos + 2 < size && text[pos + 2] == '\n')))
+        {
+            // A line continuation.
+            pos += (text[pos + 1] == '\n') ? 2 : 3;
+        }
+        else if (ch == '/' && pos + 1 < size && text[pos + 1] == '/')
+        {
+            // A line comment, which can be continued with a backslash.
+            pos = scan_->findLineBreak(text, pos + 2, size);
+            while (pos < size && text[pos] == '\\')
+            {
+                pos += (pos + 1 < size && text[pos + 1] == '\n') ? 2 : 1;
+                pos = scan_->findLineBreak(text, pos, size);
+            }
+
+            flags |= Token::PrecededBySpace;
+        }
+        else if (ch == '/' && pos + 1 < size && text[pos + 1] == '*')
+        {
+            // A block comment.
+            size_t end = scan_->findCommentEnd(text, pos + 2, size);
+            pos = (end == size) ? size : end + 2;
+            flags |= Token::PrecededBySpace;
+        }
+        else
+        {
+            break;
+        }
+    }
+
+    pos_ = pos;
+    if (atLineStart_)
+    {
+        flags |= Token::StartOfLine;
+    }
+
+    return flags;
+}
+
+
+//
+// Get the next token.
+//
+
+bool CLexer::next(Token *token)
+{
+    using namespace lexTables;
+
+    uint8_t flags = skipWhitespace();
+    size_t start = pos_;
+    if (start >= text_.size())
+    {
+        *token = Token(TokenKind::EndOfFile, SourceLoc(fileId_, static_cast<uint32_t>(start)), 0, flags);
+        return false;
+    }
+
+    // Identifiers and numbers are most of the tokens, and they're only
+    // runs of characters so they're scanned directly. The DFA is left to
+    // sort out the rare cases where a run doesn't end the token: universal
+    // character names, and the prefixes of character constants and string
+    // literals.
+    const uint8_t *text = reinterpret_cast<const uint8_t *>(text_.data());
+    size_t size = text_.size();
+    size_t acceptEnd = 0;
+    uint8_t accept = AcceptNone;
+    uint8_t first = text[start];
+    if (static_cast<uint8_t>((first | 0x20) - 'a') < 26 || first == '_')
+    {
+        size_t end = scan_->skipIdentifier(text_.data(), start + 1, size);
+        if (end == size || (text[end] != '\\' && !(end - start <= 2 && (text[end] == '\'' || text[end] == '"'))))
+        {
+            accept = AcceptIdentifier;
+            acceptEnd = end;
+        }
+    }
+    else if (static_cast<uint8_t>(first - '0') < 10)
+    {
+        // A sign is part of a number if it follows an exponent.
+        size_t end = scan_->skipNumber(text_.data(), start + 1, size);
+        while (end < size && (text[end] == '+' || text[end] == '-') &&
+               ((text[end - 1] | 0x20) == 'e' || (text[end - 1] | 0x20) == 'p'))
+        {
+            end = scan_->skipNumber(text_.data(), end + 1, size);
+        }
+
+        if (end == size || text[end] != '\\')
+        {
+            accept = AcceptPpNumber;
+            acceptEnd = end;
+        }
+    }
+
+    if (accept == AcceptNone)
+    {
+        // Run the DFA for as long as it can go, remembering the last place
+        // where it accepted.
+        size_t pos = start;
+        acceptEnd = start;
+        State state = startState;
+        while (pos < size)
+        {
+            state = transitions[state * numClasses + byteClass[text[pos]]];
+            if (state == deadState)
+                break;
+
+            pos++;
+            uint8_t stateAccept = accepting[state];
+            if (stateAccept)
+            {
+                accept = stateAccept;
+                acceptEnd = pos;
+            }
+        }
+    }
+
+    // The accept numbers follow the order of TokenKind.
+    static_assert(static_cast<int>(TokenKind::Identifier) == AcceptIdentifier &&
+                  static_cast<int>(TokenKind::PpNumber) == AcceptPpNumber &&
+                  static_cast<int>(TokenKind::CharacterConstant) == AcceptCharacterConstant &&
+                  static_cast<int>(TokenKind::StringLiteral) == AcceptStringLiteral &&
+                  static_cast<int>(TokenKind::Punctuator) == AcceptPunctuator,
+                  "TokenKind must match the lexer tables");
+    TokenKind kind = static_cast<TokenKind>(accept);
+    if (accept == AcceptNone)
+    {
+        // It's not a token, so take a single character.
+        kind = TokenKind::Other;
+        acceptEnd = start + 1;
+    }
+
+    // Say which keyword or punctuator it is.
+    const char *tokenText = text_.data() + start;
+    size_t length = acceptEnd - start;
+    uint8_t subKind = 0;
+    if (kind == TokenKind::Identifier)
+    {
+        subKind = static_cast<uint8_t>(findKeyword(tokenText, length));
+    }
+    else if (kind == TokenKind::Punctuator)
+    {
+        subKind = static_cast<uint8_t>(findPunctuator(tokenText, length));
+    }
+
+    *token = Token(kind, SourceLoc(fileId_, static_cast<uint32_t>(start)), static_cast<uint32_t>(length), flags, subKind);
+    pos_ = acceptEnd;
+    atLineStart_ = false;
+
+    return true;
+}
+
+
+//
+// Add a token to a token stream, interning it if it's an identifier.
+//
+
+inline void CLexer::addToken(const Token &token, TokenStream *tokens)
 {
+    uint32_t identId = TokenStream::noIdent;
+    if (interner_ != nullptr && token.kind() == TokenKind::Identifier)
+    {
+        identId = interner_->intern(token.text(text_));
+    }
+
+    tokens->push_back(token, identId);
+    lexedTokens_++;
+}
+
+
+//
+// Get all the remaining tokens.
+//
+
+void CLexer::lexAll(TokenStream *tokens)
+{
+    // Tokens average around five bytes of source each.
+    tokens->setFileId(fileId_);
+    tokens->reserve(tokens->size() + (text_.size() - pos_) / 5);
+
+    Token token;
+    while (next(&token))
+    {
+        addToken(token, tokens);
+    }
+}
+
+
+//
+// A part of the text which has changed. The change is relexed from the
+// start of the line it begins on, since tokens earlier on that line may
+// have looked ahead into it.
+//
+
+struct ChangedRegion
+{
+    size_t oldStart;
+    size_t oldEnd;
+    size_t newStart;
+    size_t newEnd;
+    size_t oldLineStart;    // Where the line the change begins on starts in the old text.
+
+    // How far text between the previous change and this one has moved.
+    ptrdiff_t shift() const        { return static_cast<ptrdiff_t>(newStart) - static_cast<ptrdiff_t>(oldStart); }
+    size_t    newLineStart() const { return oldLineStart + shift(); }
+};
+
+
+//
+// Turn an edit script into a list of changed regions. A change beginning
+// on the same line as the previous one ended is merged with it, since
+// relexing that line covers both.
+//
+
+static void findChangedRegions(std::string_view oldText, const std::vector<DiffEdit> &edits, std::vector<ChangedRegion> *regions)
+{
+    size_t oldPos = 0;
+    size_t newPos = 0;
+    size_t i = 0;
+    while (i < edits.size())
+    {
+        if (edits[i].op() == DiffEdit::Op::Match)
+        {
+            oldPos += edits[i].length();
+            newPos += edits[i].length();
+            i++;
+            continue;
+        }
+
+        ChangedRegion region;
+        region.oldStart = oldPos;
+        region.newStart = newPos;
+        for (; i < edits.size() && edits[i].op() != DiffEdit::Op::Match; i++)
+        {
+            if (edits[i].op() == DiffEdit::Op::Delete)
+            {
+                oldPos += edits[i].length();
+            }
+            else
+            {
+                newPos += edits[i].length();
+            }
+        }
+
+        region.oldEnd = oldPos;
+        region.newEnd = newPos;
+        size_t newline = region.oldStart > 0 ? oldText.rfind('\n', region.oldStart - 1) : std::string_view::npos;
+        region.oldLineStart = (newline == std::string_view::npos) ? 0 : newline + 1;
+
+        if (!regions->empty() && region.oldLineStart <= regions->back().oldEnd)
+        {
+            regions->back().oldEnd = region.oldEnd;
+            regions->back().newEnd = region.newEnd;
+        }
+        else
+        {
+            regions->push_back(region);
+        }
+    }
+}
+
+
+//
+// Lex the text again given the tokens of an earlier version of it. The
+// old and new text are diffed and only the lines with changes on them are
+// lexed again, continuing until the new tokens line up with the old ones.
+// Everything else is copied from the old tokens in bulk, so the cost
+// depends on the size of the change rather than the size of the file.
+//
+// Old tokens which start before the line a change is on can't have seen
+// the change: no token crosses a newline so the lexer never looks past
+// one. After a change, a new token which starts in unchanged text at the
+// same place as an old token, with the same length, kind and flags, means
+// the lexer is back in step and the old tokens can be used up to the next
+// change.
+//
+
+bool CLexer::relex(std::string_view oldText, const TokenStream &oldTokens, TokenStream *tokens)
+{
+    std::vector<DiffEdit> edits;
+    Diff diff(oldText, text_);
+    diff.setMaxCost(maxRelexChange);
+    if (diff.diff(&edits) < 0)
+        return false;
+
+    std::vector<ChangedRegion> regions;
+    findChangedRegions(oldText, edits, &regions);
+
+    tokens->clear();
+    tokens->setFileId(fileId_);
+    tokens->reserve(oldTokens.size() + 64);
+
+    const uint32_t *oldOffsets = oldTokens.offsets();
+    size_t oldSize = oldTokens.size();
+    size_t oldIndex = 0;
+    size_t region = 0;
+    while (region < regions.size())
+    {
+        // Keep the old tokens from before the line the change is on.
+        const ChangedRegion &changed = regions[region];
+        size_t restart = std::lower_bound(oldOffsets + oldIndex, oldOffsets + oldSize, changed.oldLineStart) - oldOffsets;
+        tokens->append(oldTokens, oldIndex, restart, changed.shift());
+        oldIndex = restart;
+
+        // Carry on lexing from the end of the last token we have.
+        if (tokens->empty())
+        {
+            pos_ = 0;
+            atLineStart_ = true;
+        }
+        else
+        {
+            size_t last = tokens->size() - 1;
+            pos_ = tokens->offset(last) + tokens->length(last);
+            atLineStart_ = false;
+        }
+
+        bool inStep = false;
+        Token token;
+        while (next(&token))
+        {
+            size_t pos = token.loc().offset;
+            while (region < regions.size() && regions[region].newEnd <= pos)
+            {
+                region++;
+            }
+
+            // Is it in unchanged text before the line of the next change?
+            if (region == regions.size() || pos < regions[region].newLineStart())
+            {
+                ptrdiff_t shift = (region == regions.size()) ? static_cast<ptrdiff_t>(text_.size()) - static_cast<ptrdiff_t>(oldText.size()) : regions[region].shift();
+                uint32_t oldPos = static_cast<uint32_t>(pos - shift);
+                while (oldIndex < oldSize && oldOffsets[oldIndex] < oldPos)
+                {
+                    oldIndex++;
+                }
+
+                if (oldIndex < oldSize && oldOffsets[oldIndex] == oldPos &&
+                    oldTokens.length(oldIndex) == token.length() &&
+                    oldTokens.kind(oldIndex) == token.kind() &&
+                    oldTokens.subKind(oldIndex) == token.subKind() &&
+                    oldTokens.flags(oldIndex) == token.flags())
+                {
+                    inStep = true;
+                    break;
+                }
+            }
+
+            addToken(token, tokens);
+        }
+
+        if (!inStep)
+        {
+            // The change affected everything to the end of the file.
+            oldIndex = oldSize;
+            break;
+        }
+    }
+
+    // Keep the old tokens after the last change.
+    tokens->append(oldTokens, oldIndex, oldSize, static_cast<ptrdiff_t>(text_.size()) - static_cast<ptrdiff_t>(oldText.size()));
 
+    return true;
 }
 
 
@@ -2,7 +2,10 @@
 #define DEEPC_CLEXER_H
 
 #include <memory>
-#include <string>
+#include <string_view>
+
+#include "token.h"
+#include "tokenstream.h"
 
 
 namespace deepC
@@ -10,20 +13,72 @@ namespace deepC
 
 
 // Forward declarations.
-class ProgramDb;
+class SourceFile;
+class Interner;
+struct ScanKernels;
 
 
 //
-// The lexer converts source text into tokens.
+// The lexer converts source text into preprocessing tokens in a single
+// pass over the text. Tokens are recognised by a table driven DFA which
+// is generated from old/dcparsergen/c_lexical.pgen, see clexertables.h.
+// Whitespace and comments are skipped by hand, as are identifiers and
+// numbers when they don't need the DFA. Long runs of characters are
+// scanned with the vector kernels in lexscan.h.
+//
+// Lines joined with a backslash are only handled between tokens and in
+// comments.
+//
+// When a file changes, relex() lexes only the lines around each change
+// and keeps the rest of the tokens from before the change.
 //
 
 class CLexer
 {
-    std::shared_ptr<ProgramDb> pdb_;
-    std::string                sourceFileName_;
+    std::shared_ptr<SourceFile> sourceFile_;    // Keeps the text valid if it came from a file.
+    std::string_view            text_;
+    uint32_t                    fileId_;
+    size_t                      pos_;
+    bool                        atLineStart_;
+    Interner                   *interner_;      // Identifiers are interned here if it's set.
+    size_t                      lexedTokens_;   // How many tokens have been added to token streams.
+    const ScanKernels          *scan_;          // How runs of characters are scanned.
+
+public:
+    // Files which have changed by more than this many characters are
+    // lexed from scratch rather than relexed.
+    static constexpr size_t maxRelexChange = 4096;
+
+private:
+    // Skip whitespace and comments, returning the token flags.
+    uint8_t skipWhitespace();
+
+    // Add a token to a token stream.
+    void    addToken(const Token &token, TokenStream *tokens);
 
 public:
-    CLexer(std::shared_ptr<ProgramDb> pdb, const std::string &sourceFileName);
+    explicit CLexer(const std::shared_ptr<SourceFile> &sourceFile);
+    explicit CLexer(std::string_view text, uint32_t fileId = 0);
+
+    // Get the next token. Returns false at the end of the file.
+    bool next(Token *token);
+
+    // Give identifiers in token streams their interned ids.
+    void setInterner(Interner *interner) { interner_ = interner; }
+
+    // Use particular scanning kernels rather than the fastest ones.
+    void setScanKernels(const ScanKernels &kernels) { scan_ = &kernels; }
+
+    // Add all the remaining tokens to a token stream.
+    void lexAll(TokenStream *tokens);
+
+    // Replace the contents of a token stream with the tokens of the text,
+    // given the tokens of an earlier version of it. Returns false, having
+    // done nothing, if the text has changed too much.
+    bool relex(std::string_view oldText, const TokenStream &oldTokens, TokenStream *tokens);
+
+    // How many tokens lexAll() and relex() have lexed.
+    size_t lexedTokens() const { return lexedTokens_; }
 };
 
 
@@ -0,0 +1,618 @@
+//
+// Lexer tables generated by dcparsergen from c_lexical.pgen. Don't edit.
+//
+// A minimised DFA with 64 states and 32 byte classes. State 0 is the
+// dead state, which never accepts, and state 1 is the start state.
+// The next state is transitions[state * numClasses + byteClass[ch]].
+//
+// Keywords and punctuators are identified after the DFA has matched
+// them, using a perfect hash.
+//
+
+#ifndef DEEPC_CLEXERTABLES_H
+#define DEEPC_CLEXERTABLES_H
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+
+namespace deepC
+{
+namespace lexTables
+{
+
+
+enum Accept : uint8_t
+{
+    AcceptNone = 0,
+    AcceptIdentifier = 1,
+    AcceptPpNumber = 2,
+    AcceptCharacterConstant = 3,
+    AcceptStringLiteral = 4,
+    AcceptPunctuator = 5
+};
+
+typedef uint8_t State;
+
+static constexpr int   numStates = 64;
+static constexpr int   numClasses = 32;
+static constexpr State deadState = 0;
+static constexpr State startState = 1;
+
+static constexpr uint8_t byteClass[256] =
+{
+      0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   1,   0,   0,   0,   0,   0,
+      0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,
+      0,   2,   3,   4,   0,   5,   6,   7,   8,   8,   2,   9,   8,  10,  11,   2,
+     12,  12,  12,  12,  12,  12,  12,  12,  13,  14,  15,   8,  16,  17,  18,  19,
+      0,  20,  20,  20,  20,  21,  20,  22,  22,  22,  22,  22,  23,  22,  22,  22,
+     24,  22,  22,  22,  22,  25,  22,  22,  22,  22,  22,   8,  26,   8,   2,  22,
+      0,  27,  27,  20,  20,  21,  27,  22,  22,  22,  22,  22,  22,  22,  28,  22,
+     24,  22,  28,  22,  28,  29,  28,  22,  30,  22,  22,   8,  31,   8,   8,   0,
+     22,  22,  22,  22,  22,  22,  22,  22,  22,  22,  22,  22,  22,  22,  22,  22,
+     22,  22,  22,  22,  22,  22,  22,  22,  22,  22,  22,  22,  22,  22,  22,  22,
+     22,  22,  22,  22,  22,  22,  22,  22,  22,  22,  22,  22,  22,  22,  22,  22,
+     22,  22,  22,  22,  22,  22,  22,  22,  22,  22,  22,  22,  22,  22,  22,  22,
+     22,  22,  22,  22,  22,  22,  22,  22,  22,  22,  22,  22,  22,  22,  22,  22,
+     22,  22,  22,  22,  22,  22,  22,  22,  22,  22,  22,  22,  22,  22,  22,  22,
+     22,  22,  22,  22,  22,  22,  22,  22,  22,  22,  22,  22,  22,  22,  22,  22,
+     22,  22,  22,  22,  22,  22,  22,  22,  22,  22,  22,  22,  22,  22,  22,  22,
+};
+
+static constexpr State transitions[numStates * numClasses] =
+{
+    /*   0 */   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,
+                0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,
+    /*   1 */   0,   0,   2,   3,   4,   5,   6,   7,   8,   9,  10,  11,  12,  12,  12,  13,
+               14,   2,  15,   8,  16,  16,  16,  17,  16,  17,  18,  16,  16,  19,  16,  20,
+    /*   2 */   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,
+                0,   8,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,
+    /*   3 */   3,   0,   3,  21,   3,   3,   3,   3,   3,   3,   3,   3,   3,   3,   3,   3,
+                3,   3,   3,   3,   3,   3,   3,   3,   3,   3,  22,   3,   3,   3,   3,   3,
+    /*   4 */   0,   0,   0,   0,   8,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,
+                0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,
+    /*   5 */   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,  23,
+                0,   8,   8,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,
+    /*   6 */   0,   0,   0,   0,   0,   0,   8,   0,   0,   0,   0,   0,   0,   0,   0,   0,
+                0,   8,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,
+    /*   7 */  24,   0,  24,  24,  24,  24,  24,   0,  24,  24,  24,  24,  24,  24,  24,  24,
+               24,  24,  24,  24,  24,  24,  24,  24,  24,  24,  25,  24,  24,  24,  24,  24,
+    /*   8 */   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,
+                0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,
+    /*   9 */   0,   0,   0,   0,   0,   0,   0,   0,   0,   8,   0,   0,   0,   0,   0,   0,
+                0,   8,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,
+    /*  10 */   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   8,   0,   0,   0,   0,   0,
+                0,   8,   8,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,
+    /*  11 */   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,  26,  12,  12,  12,   0,
+                0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,
+    /*  12 */   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,  12,  12,  12,  12,   0,
+                0,   0,   0,   0,  12,  27,  12,  12,  27,  12,  28,  12,  12,  12,  12,   0,
+    /*  13 */   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,
+                0,   0,   8,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,
+    /*  14 */   0,   0,   0,   0,   0,   8,   0,   0,   0,   0,   0,   0,   0,   0,   0,   8,
+                2,   8,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,
+    /*  15 */   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,
+                0,   8,   2,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,
+    /*  16 */   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,  16,  16,  16,   0,
+                0,   0,   0,   0,  16,  16,  16,  16,  16,  16,  18,  16,  16,  16,  16,   0,
+    /*  17 */   0,   0,   0,   3,   0,   0,   0,   7,   0,   0,   0,   0,  16,  16,  16,   0,
+                0,   0,   0,   0,  16,  16,  16,  16,  16,  16,  18,  16,  16,  16,  16,   0,
+    /*  18 */   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,
+                0,   0,   0,   0,   0,   0,   0,   0,   0,  29,   0,   0,   0,  30,   0,   0,
+    /*  19 */   0,   0,   0,   3,   0,   0,   0,   7,   0,   0,   0,   0,  16,  31,  16,   0,
+                0,   0,   0,   0,  16,  16,  16,  16,  16,  16,  18,  16,  16,  16,  16,   0,
+    /*  20 */   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,
+                0,   8,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   8,
+    /*  21 */   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,
+                0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,
+    /*  22 */   0,   0,   0,   3,   0,   0,   0,   3,   0,   0,   0,   0,   3,   0,   0,   0,
+                0,   0,   0,   3,   0,   0,   0,   0,   0,  32,   3,   3,   3,  33,  34,   0,
+    /*  23 */   0,   0,   0,   0,   0,  35,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,
+                0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,
+    /*  24 */  24,   0,  24,  24,  24,  24,  24,  36,  24,  24,  24,  24,  24,  24,  24,  24,
+               24,  24,  24,  24,  24,  24,  24,  24,  24,  24,  25,  24,  24,  24,  24,  24,
+    /*  25 */   0,   0,   0,  24,   0,   0,   0,  24,   0,   0,   0,   0,  24,   0,   0,   0,
+                0,   0,   0,  24,   0,   0,   0,   0,   0,  37,  24,  24,  24,  38,  39,   0,
+    /*  26 */   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   8,   0,   0,   0,   0,
+                0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,
+    /*  27 */   0,   0,   0,   0,   0,   0,   0,   0,   0,  12,  12,  12,  12,  12,  12,   0,
+                0,   0,   0,   0,  12,  27,  12,  12,  27,  12,  28,  12,  12,  12,  12,   0,
+    /*  28 */   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,
+                0,   0,   0,   0,   0,   0,   0,   0,   0,  40,   0,   0,   0,  41,   0,   0,
+    /*  29 */   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,  42,  42,  42,   0,
+                0,   0,   0,   0,  42,  42,   0,   0,   0,   0,   0,  42,   0,   0,   0,   0,
+    /*  30 */   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,  43,  43,  43,   0,
+                0,   0,   0,   0,  43,  43,   0,   0,   0,   0,   0,  43,   0,   0,   0,   0,
+    /*  31 */   0,   0,   0,   3,   0,   0,   0,   0,   0,   0,   0,   0,  16,  16,  16,   0,
+                0,   0,   0,   0,  16,  16,  16,  16,  16,  16,  18,  16,  16,  16,  16,   0,
+    /*  32 */   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,  44,  44,  44,   0,
+                0,   0,   0,   0,  44,  44,   0,   0,   0,   0,   0,  44,   0,   0,   0,   0,
+    /*  33 */   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,  45,  45,  45,   0,
+                0,   0,   0,   0,  45,  45,   0,   0,   0,   0,   0,  45,   0,   0,   0,   0,
+    /*  34 */   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   3,   3,   3,   0,
+                0,   0,   0,   0,   3,   3,   0,   0,   0,   0,   0,   3,   0,   0,   0,   0,
+    /*  35 */   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   8,
+                0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,
+    /*  36 */   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,
+                0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,
+    /*  37 */   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,  46,  46,  46,   0,
+                0,   0,   0,   0,  46,  46,   0,   0,   0,   0,   0,  46,   0,   0,   0,   0,
+    /*  38 */   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,  47,  47,  47,   0,
+                0,   0,   0,   0,  47,  47,   0,   0,   0,   0,   0,  47,   0,   0,   0,   0,
+    /*  39 */   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,  24,  24,  24,   0,
+                0,   0,   0,   0,  24,  24,   0,   0,   0,   0,   0,  24,   0,   0,   0,   0,
+    /*  40 */   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,  48,  48,  48,   0,
+                0,   0,   0,   0,  48,  48,   0,   0,   0,   0,   0,  48,   0,   0,   0,   0,
+    /*  41 */   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,  49,  49,  49,   0,
+                0,   0,   0,   0,  49,  49,   0,   0,   0,   0,   0,  49,   0,   0,   0,   0,
+    /*  42 */   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,  50,  50,  50,   0,
+                0,   0,   0,   0,  50,  50,   0,   0,   0,   0,   0,  50,   0,   0,   0,   0,
+    /*  43 */   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,  51,  51,  51,   0,
+                0,   0,   0,   0,  51,  51,   0,   0,   0,   0,   0,  51,   0,   0,   0,   0,
+    /*  44 */   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,  52,  52,  52,   0,
+                0,   0,   0,   0,  52,  52,   0,   0,   0,   0,   0,  52,   0,   0,   0,   0,
+    /*  45 */   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,  53,  53,  53,   0,
+                0,   0,   0,   0,  53,  53,   0,   0,   0,   0,   0,  53,   0,   0,   0,   0,
+    /*  46 */   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,  54,  54,  54,   0,
+                0,   0,   0,   0,  54,  54,   0,   0,   0,   0,   0,  54,   0,   0,   0,   0,
+    /*  47 */   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,  55,  55,  55,   0,
+                0,   0,   0,   0,  55,  55,   0,   0,   0,   0,   0,  55,   0,   0,   0,   0,
+    /*  48 */   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,  56,  56,  56,   0,
+                0,   0,   0,   0,  56,  56,   0,   0,   0,   0,   0,  56,   0,   0,   0,   0,
+    /*  49 */   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,  57,  57,  57,   0,
+                0,   0,   0,   0,  57,  57,   0,   0,   0,   0,   0,  57,   0,   0,   0,   0,
+    /*  50 */   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,  58,  58,  58,   0,
+                0,   0,   0,   0,  58,  58,   0,   0,   0,   0,   0,  58,   0,   0,   0,   0,
+    /*  51 */   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,  59,  59,  59,   0,
+                0,   0,   0,   0,  59,  59,   0,   0,   0,   0,   0,  59,   0,   0,   0,   0,
+    /*  52 */   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,  60,  60,  60,   0,
+                0,   0,   0,   0,  60,  60,   0,   0,   0,   0,   0,  60,   0,   0,   0,   0,
+    /*  53 */   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,  34,  34,  34,   0,
+                0,   0,   0,   0,  34,  34,   0,   0,   0,   0,   0,  34,   0,   0,   0,   0,
+    /*  54 */   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,  61,  61,  61,   0,
+                0,   0,   0,   0,  61,  61,   0,   0,   0,   0,   0,  61,   0,   0,   0,   0,
+    /*  55 */   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,  39,  39,  39,   0,
+                0,   0,   0,   0,  39,  39,   0,   0,   0,   0,   0,  39,   0,   0,   0,   0,
+    /*  56 */   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,  62,  62,  62,   0,
+                0,   0,   0,   0,  62,  62,   0,   0,   0,   0,   0,  62,   0,   0,   0,   0,
+    /*  57 */   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,  63,  63,  63,   0,
+                0,   0,   0,   0,  63,  63,   0,   0,   0,   0,   0,  63,   0,   0,   0,   0,
+    /*  58 */   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,  30,  30,  30,   0,
+                0,   0,   0,   0,  30,  30,   0,   0,   0,   0,   0,  30,   0,   0,   0,   0,
+    /*  59 */   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,  16,  16,  16,   0,
+                0,   0,   0,   0,  16,  16,   0,   0,   0,   0,   0,  16,   0,   0,   0,   0,
+    /*  60 */   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,  33,  33,  33,   0,
+                0,   0,   0,   0,  33,  33,   0,   0,   0,   0,   0,  33,   0,   0,   0,   0,
+    /*  61 */   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,  38,  38,  38,   0,
+                0,   0,   0,   0,  38,  38,   0,   0,   0,   0,   0,  38,   0,   0,   0,   0,
+    /*  62 */   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,  41,  41,  41,   0,
+                0,   0,   0,   0,  41,  41,   0,   0,   0,   0,   0,  41,   0,   0,   0,   0,
+    /*  63 */   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,  12,  12,  12,   0,
+                0,   0,   0,   0,  12,  12,   0,   0,   0,   0,   0,  12,   0,   0,   0,   0,
+};
+
+static constexpr uint8_t accepting[numStates] =
+{
+    0, 0, 5, 0, 5, 5, 5, 0, 5, 5, 5, 5, 2, 5, 5, 5,
+    1, 1, 0, 1, 5, 4, 0, 5, 0, 0, 0, 2, 0, 0, 0, 1,
+    0, 0, 0, 0, 3, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+    0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+};
+
+
+//
+// Each keyword, found with findKeyword().
+//
+
+enum class Keyword : uint8_t
+{
+    None = 0,
+    Auto,
+    Break,
+    Case,
+    Char,
+    Const,
+    Continue,
+    Default,
+    Do,
+    Double,
+    Else,
+    Enum,
+    Extern,
+    Float,
+    For,
+    Goto,
+    If,
+    Inline,
+    Int,
+    Long,
+    Register,
+    Restrict,
+    Return,
+    Short,
+    Signed,
+    Sizeof,
+    Static,
+    Struct,
+    Switch,
+    Typedef,
+    Union,
+    Unsigned,
+    Void,
+    Volatile,
+    While,
+    Alignas,
+    Alignof,
+    Atomic,
+    Bool,
+    Complex,
+    Generic,
+    Imaginary,
+    Noreturn,
+    StaticAssert,
+    ThreadLocal
+};
+
+static constexpr int      numKeywords = 44;
+static constexpr int      keywordHashBits = 7;
+static constexpr size_t   keywordMinLength = 2;
+static constexpr size_t   keywordMaxLength = 14;
+
+static constexpr uint32_t keywordHash(const char *s, size_t len)
+{
+    return ((uint8_t(s[0]) * 10585207u + uint8_t(len > 1 ? s[1] : 0) * 8691229u +
+             uint8_t(s[len - 1]) * 5688737u + uint32_t(len) * 3228179u) * 0x9e3779b1u) >> (32 - keywordHashBits);
+}
+
+static constexpr uint8_t keywordSlots[1 << keywordHashBits] =
+{
+     0,  0,  0,  0,  0,  0, 36, 21, 34, 10, 40,  0,  0,  0,  0,  0,
+     0,  0,  0,  0,  7,  0,  0,  0,  0, 19,  0, 13,  0,  0,  0, 15,
+     0,  0,  0,  0,  0, 37, 17,  0,  0,  0,  0,  0, 41, 11, 31,  0,
+     0,  0, 25, 18, 39,  0, 30,  0, 20,  0, 23,  0,  0,  0, 16,  0,
+     0,  0,  8,  0, 22,  0,  0, 35,  0,  4,  0,  0,  1, 32,  0,  0,
+     0,  0, 14,  0,  2, 42,  0,  0,  0, 27,  3,  0,  0, 28,  0, 43,
+     0, 33,  0, 24,  6,  9, 38,  0,  0,  0,  0,  0,  0, 44,  0,  0,
+     0,  5,  0,  0,  0,  0, 12,  0,  0,  0, 29, 26,  0,  0,  0,  0,
+};
+
+static constexpr const char *keywordText[numKeywords + 1] =
+{
+    "",
+    "auto",
+    "break",
+    "case",
+    "char",
+    "const",
+    "continue",
+    "default",
+    "do",
+    "double",
+    "else",
+    "enum",
+    "extern",
+    "float",
+    "for",
+    "goto",
+    "if",
+    "inline",
+    "int",
+    "long",
+    "register",
+    "restrict",
+    "return",
+    "short",
+    "signed",
+    "sizeof",
+    "static",
+    "struct",
+    "switch",
+    "typedef",
+    "union",
+    "unsigned",
+    "void",
+    "volatile",
+    "while",
+    "_Alignas",
+    "_Alignof",
+    "_Atomic",
+    "_Bool",
+    "_Complex",
+    "_Generic",
+    "_Imaginary",
+    "_Noreturn",
+    "_Static_assert",
+    "_Thread_local"
+};
+
+static constexpr uint8_t keywordLength[numKeywords + 1] =
+{
+    0, 4, 5, 4, 4, 5, 8, 7, 2, 6, 4, 4, 6, 5, 3, 4,
+    2, 6, 3, 4, 8, 8, 6, 5, 6, 6, 6, 6, 6, 7, 5, 8,
+    4, 8, 5, 8, 8, 7, 5, 8, 8, 10, 9, 14, 13
+};
+
+static constexpr Keyword findKeyword(const char *s, size_t len)
+{
+    if (len < keywordMinLength || len > keywordMaxLength)
+        return Keyword::None;
+
+    uint8_t i = keywordSlots[keywordHash(s, len)];
+    if (i == 0 || keywordLength[i] != len || std::char_traits<char>::compare(keywordText[i], s, len) != 0)
+        return Keyword::None;
+
+    return static_cast<Keyword>(i);
+}
+
+static_assert(findKeyword("auto", 4) == Keyword::Auto, "keyword hash");
+static_assert(findKeyword("break", 5) == Keyword::Break, "keyword hash");
+static_assert(findKeyword("case", 4) == Keyword::Case, "keyword hash");
+static_assert(findKeyword("char", 4) == Keyword::Char, "keyword hash");
+static_assert(findKeyword("const", 5) == Keyword::Const, "keyword hash");
+static_assert(findKeyword("continue", 8) == Keyword::Continue, "keyword hash");
+static_assert(findKeyword("default", 7) == Keyword::Default, "keyword hash");
+static_assert(findKeyword("do", 2) == Keyword::Do, "keyword hash");
+static_assert(findKeyword("double", 6) == Keyword::Double, "keyword hash");
+static_assert(findKeyword("else", 4) == Keyword::Else, "keyword hash");
+static_assert(findKeyword("enum", 4) == Keyword::Enum, "keyword hash");
+static_assert(findKeyword("extern", 6) == Keyword::Extern, "keyword hash");
+static_assert(findKeyword("float", 5) == Keyword::Float, "keyword hash");
+static_assert(findKeyword("for", 3) == Keyword::For, "keyword hash");
+static_assert(findKeyword("goto", 4) == Keyword::Goto, "keyword hash");
+static_assert(findKeyword("if", 2) == Keyword::If, "keyword hash");
+static_assert(findKeyword("inline", 6) == Keyword::Inline, "keyword hash");
+static_assert(findKeyword("int", 3) == Keyword::Int, "keyword hash");
+static_assert(findKeyword("long", 4) == Keyword::Long, "keyword hash");
+static_assert(findKeyword("register", 8) == Keyword::Register, "keyword hash");
+static_assert(findKeyword("restrict", 8) == Keyword::Restrict, "keyword hash");
+static_assert(findKeyword("return", 6) == Keyword::Return, "keyword hash");
+static_assert(findKeyword("short", 5) == Keyword::Short, "keyword hash");
+static_assert(findKeyword("signed", 6) == Keyword::Signed, "keyword hash");
+static_assert(findKeyword("sizeof", 6) == Keyword::Sizeof, "keyword hash");
+static_assert(findKeyword("static", 6) == Keyword::Static, "keyword hash");
+static_assert(findKeyword("struct", 6) == Keyword::Struct, "keyword hash");
+static_assert(findKeyword("switch", 6) == Keyword::Switch, "keyword hash");
+static_assert(findKeyword("typedef", 7) == Keyword::Typedef, "keyword hash");
+static_assert(findKeyword("union", 5) == Keyword::Union, "keyword hash");
+static_assert(findKeyword("unsigned", 8) == Keyword::Unsigned, "keyword hash");
+static_assert(findKeyword("void", 4) == Keyword::Void, "keyword hash");
+static_assert(findKeyword("volatile", 8) == Keyword::Volatile, "keyword hash");
+static_assert(findKeyword("while", 5) == Keyword::While, "keyword hash");
+static_assert(findKeyword("_Alignas", 8) == Keyword::Alignas, "keyword hash");
+static_assert(findKeyword("_Alignof", 8) == Keyword::Alignof, "keyword hash");
+static_assert(findKeyword("_Atomic", 7) == Keyword::Atomic, "keyword hash");
+static_assert(findKeyword("_Bool", 5) == Keyword::Bool, "keyword hash");
+static_assert(findKeyword("_Complex", 8) == Keyword::Complex, "keyword hash");
+static_assert(findKeyword("_Generic", 8) == Keyword::Generic, "keyword hash");
+static_assert(findKeyword("_Imaginary", 10) == Keyword::Imaginary, "keyword hash");
+static_assert(findKeyword("_Noreturn", 9) == Keyword::Noreturn, "keyword hash");
+static_assert(findKeyword("_Static_assert", 14) == Keyword::StaticAssert, "keyword hash");
+static_assert(findKeyword("_Thread_local", 13) == Keyword::ThreadLocal, "keyword hash");
+
+
+//
+// Each punctuator, found with findPunctuator().
+//
+
+enum class Punctuator : uint8_t
+{
+    None = 0,
+    LeftBracket,
+    RightBracket,
+    LeftParen,
+    RightParen,
+    LeftBrace,
+    RightBrace,
+    Dot,
+    MinusGreater,
+    PlusPlus,
+    MinusMinus,
+    Amp,
+    Star,
+    Plus,
+    Minus,
+    Tilde,
+    Exclaim,
+    Slash,
+    Percent,
+    LessLess,
+    GreaterGreater,
+    Less,
+    Greater,
+    LessEqual,
+    GreaterEqual,
+    EqualEqual,
+    ExclaimEqual,
+    Caret,
+    Pipe,
+    AmpAmp,
+    PipePipe,
+    Question,
+    Colon,
+    Semi,
+    DotDotDot,
+    Equal,
+    StarEqual,
+    SlashEqual,
+    PercentEqual,
+    PlusEqual,
+    MinusEqual,
+    LessLessEqual,
+    GreaterGreaterEqual,
+    AmpEqual,
+    CaretEqual,
+    PipeEqual,
+    Comma,
+    Hash,
+    HashHash,
+    LessColon,
+    ColonGreater,
+    LessPercent,
+    PercentGreater,
+    PercentColon,
+    PercentColonPercentColon
+};
+
+static constexpr int      numPunctuators = 54;
+static constexpr int      punctuatorHashBits = 7;
+static constexpr size_t   punctuatorMinLength = 1;
+static constexpr size_t   punctuatorMaxLength = 4;
+
+static constexpr uint32_t punctuatorHash(const char *s, size_t len)
+{
+    return ((uint8_t(s[0]) * 545443u + uint8_t(len > 1 ? s[1] : 0) * 11156031u +
+             uint8_t(s[len - 1]) * 10719839u + uint32_t(len) * 3237211u) * 0x9e3779b1u) >> (32 - punctuatorHashBits);
+}
+
+static constexpr uint8_t punctuatorSlots[1 << punctuatorHashBits] =
+{
+     0, 48, 14, 25, 40,  0,  2,  0, 33, 42,  0, 53, 36, 51,  0,  0,
+     0, 30,  0,  0,  7,  0,  0,  8,  0, 27,  0, 21,  0,  0, 50,  0,
+    16, 49,  0,  0,  3, 26,  0, 17, 44,  0,  0, 24,  0,  0, 35,  0,
+     0,  0, 29,  0, 39,  0,  4,  0,  0,  5,  0,  0,  0,  0, 20,  0,
+    22, 34,  0,  0,  0, 38, 47,  0, 19, 12,  0,  0, 28,  0,  0,  0,
+    10,  0,  0, 31, 37, 45,  0,  0, 52,  0,  9, 23, 13,  0,  6,  0,
+     1,  0,  0,  0,  0,  0,  0,  0, 41,  0,  0, 18,  0, 43,  0, 46,
+     0, 15,  0,  0,  0, 32,  0, 54,  0,  0,  0,  0,  0,  0, 11,  0,
+};
+
+static constexpr const char *punctuatorText[numPunctuators + 1] =
+{
+    "",
+    "[",
+    "]",
+    "(",
+    ")",
+    "{",
+    "}",
+    ".",
+    "->",
+    "++",
+    "--",
+    "&",
+    "*",
+    "+",
+    "-",
+    "~",
+    "!",
+    "/",
+    "%",
+    "<<",
+    ">>",
+    "<",
+    ">",
+    "<=",
+    ">=",
+    "==",
+    "!=",
+    "^",
+    "|",
+    "&&",
+    "||",
+    "?",
+    ":",
+    ";",
+    "...",
+    "=",
+    "*=",
+    "/=",
+    "%=",
+    "+=",
+    "-=",
+    "<<=",
+    ">>=",
+    "&=",
+    "^=",
+    "|=",
+    ",",
+    "#",
+    "##",
+    "<:",
+    ":>",
+    "<%",
+    "%>",
+    "%:",
+    "%:%:"
+};
+
+static constexpr uint8_t punctuatorLength[numPunctuators + 1] =
+{
+    0, 1, 1, 1, 1, 1, 1, 1, 2, 2, 2, 1, 1, 1, 1, 1,
+    1, 1, 1, 2, 2, 1, 1, 2, 2, 2, 2, 1, 1, 2, 2, 1,
+    1, 1, 3, 1, 2, 2, 2, 2, 2, 3, 3, 2, 2, 2, 1, 1,
+    2, 2, 2, 2, 2, 2, 4
+};
+
+static constexpr Punctuator findPunctuator(const char *s, size_t len)
+{
+    if (len < punctuatorMinLength || len > punctuatorMaxLength)
+        return Punctuator::None;
+
+    uint8_t i = punctuatorSlots[punctuatorHash(s, len)];
+    if (i == 0 || punctuatorLength[i] != len || std::char_traits<char>::compare(punctuatorText[i], s, len) != 0)
+        return Punctuator::None;
+
+    return static_cast<Punctuator>(i);
+}
+
+static_assert(findPunctuator("[", 1) == Punctuator::LeftBracket, "punctuator hash");
+static_assert(findPunctuator("]", 1) == Punctuator::RightBracket, "punctuator hash");
+static_assert(findPunctuator("(", 1) == Punctuator::LeftParen, "punctuator hash");
+static_assert(findPunctuator(")", 1) == Punctuator::RightParen, "punctuator hash");
+static_assert(findPunctuator("{", 1) == Punctuator::LeftBrace, "punctuator hash");
+static_assert(findPunctuator("}", 1) == Punctuator::RightBrace, "punctuator hash");
+static_assert(findPunctuator(".", 1) == Punctuator::Dot, "punctuator hash");
+static_assert(findPunctuator("->", 2) == Punctuator::MinusGreater, "punctuator hash");
+static_assert(findPunctuator("++", 2) == Punctuator::PlusPlus, "punctuator hash");
+static_assert(findPunctuator("--", 2) == Punctuator::MinusMinus, "punctuator hash");
+static_assert(findPunctuator("&", 1) == Punctuator::Amp, "punctuator hash");
+static_assert(findPunctuator("*", 1) == Punctuator::Star, "punctuator hash");
+static_assert(findPunctuator("+", 1) == Punctuator::Plus, "punctuator hash");
+static_assert(findPunctuator("-", 1) == Punctuator::Minus, "punctuator hash");
+static_assert(findPunctuator("~", 1) == Punctuator::Tilde, "punctuator hash");
+static_assert(findPunctuator("!", 1) == Punctuator::Exclaim, "punctuator hash");
+static_assert(findPunctuator("/", 1) == Punctuator::Slash, "punctuator hash");
+static_assert(findPunctuator("%", 1) == Punctuator::Percent, "punctuator hash");
+static_assert(findPunctuator("<<", 2) == Punctuator::LessLess, "punctuator hash");
+static_assert(findPunctuator(">>", 2) == Punctuator::GreaterGreater, "punctuator hash");
+static_assert(findPunctuator("<", 1) == Punctuator::Less, "punctuator hash");
+static_assert(findPunctuator(">", 1) == Punctuator::Greater, "punctuator hash");
+static_assert(findPunctuator("<=", 2) == Punctuator::LessEqual, "punctuator hash");
+static_assert(findPunctuator(">=", 2) == Punctuator::GreaterEqual, "punctuator hash");
+static_assert(findPunctuator("==", 2) == Punctuator::EqualEqual, "punctuator hash");
+static_assert(findPunctuator("!=", 2) == Punctuator::ExclaimEqual, "punctuator hash");
+static_assert(findPunctuator("^", 1) == Punctuator::Caret, "punctuator hash");
+static_assert(findPunctuator("|", 1) == Punctuator::Pipe, "punctuator hash");
+static_assert(findPunctuator("&&", 2) == Punctuator::AmpAmp, "punctuator hash");
+static_assert(findPunctuator("||", 2) == Punctuator::PipePipe, "punctuator hash");
+static_assert(findPunctuator("?", 1) == Punctuator::Question, "punctuator hash");
+static_assert(findPunctuator(":", 1) == Punctuator::Colon, "punctuator hash");
+static_assert(findPunctuator(";", 1) == Punctuator::Semi, "punctuator hash");
+static_assert(findPunctuator("...", 3) == Punctuator::DotDotDot, "punctuator hash");
+static_assert(findPunctuator("=", 1) == Punctuator::Equal, "punctuator hash");
+static_assert(findPunctuator("*=", 2) == Punctuator::StarEqual, "punctuator hash");
+static_assert(findPunctuator("/=", 2) == Punctuator::SlashEqual, "punctuator hash");
+static_assert(findPunctuator("%=", 2) == Punctuator::PercentEqual, "punctuator hash");
+static_assert(findPunctuator("+=", 2) == Punctuator::PlusEqual, "punctuator hash");
+static_assert(findPunctuator("-=", 2) == Punctuator::MinusEqual, "punctuator hash");
+static_assert(findPunctuator("<<=", 3) == Punctuator::LessLessEqual, "punctuator hash");
+static_assert(findPunctuator(">>=", 3) == Punctuator::GreaterGreaterEqual, "punctuator hash");
+static_assert(findPunctuator("&=", 2) == Punctuator::AmpEqual, "punctuator hash");
+static_assert(findPunctuator("^=", 2) == Punctuator::CaretEqual, "punctuator hash");
+static_assert(findPunctuator("|=", 2) == Punctuator::PipeEqual, "punctuator hash");
+static_assert(findPunctuator(",", 1) == Punctuator::Comma, "punctuator hash");
+static_assert(findPunctuator("#", 1) == Punctuator::Hash, "punctuator hash");
+static_assert(findPunctuator("##", 2) == Punctuator::HashHash, "punctuator hash");
+static_assert(findPunctuator("<:", 2) == Punctuator::LessColon, "punctuator hash");
+static_assert(findPunctuator(":>", 2) == Punctuator::ColonGreater, "punctuator hash");
+static_assert(findPunctuator("<%", 2) == Punctuator::LessPercent, "punctuator hash");
+static_assert(findPunctuator("%>", 2) == Punctuator::PercentGreater, "punctuator hash");
+static_assert(findPunctuator("%:", 2) == Punctuator::PercentColon, "punctuator hash");
+static_assert(findPunctuator("%:%:", 4) == Punctuator::PercentColonPercentColon, "punctuator hash");
+
+
+} // namespace lexTables
+} // namespace deepC
+
+#endif // DEEPC_CLEXERTABLES_H
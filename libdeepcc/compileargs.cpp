@@ -1,6 +1,7 @@
 #include <unistd.h>
 
 #include "compileargs.h"
+#include "programdb.h"
 
 
 namespace deepC
@@ -12,6 +13,8 @@ CompileArgs::CompileArgs() :
     performLink_(true),
     outputDebugSymbols_(false),
     programDbFileName_("%HOME%/.deepc/%TARGET%/%TARGET%.pdb"),
+    programDbMapSize_(ProgramDb::defaultMapSize),
+    jobs_(1),
     pwd_(getenv("HOME"))
 {
 }
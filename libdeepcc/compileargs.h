@@ -3,6 +3,7 @@
 
 #include <string>
 #include <vector>
+#include <cstddef>
 
 
 namespace deepC
@@ -24,7 +25,9 @@ private:
     std::vector<std::string> defines_;
     std::vector<std::string> warnings_;
     std::string programDbFileName_;
+    size_t      programDbMapSize_;
     std::string target_;
+    size_t      jobs_;
 
     // Internal use.
     const char *pwd_;
@@ -49,7 +52,7 @@ public:
     void setOutputFileName(const std::string &outputFileName) { outputFileName_ = outputFileName; }
     bool outputDebugSymbols() const                  { return outputDebugSymbols_; }
     void setOutputDebugSymbols(bool outputDebugSymbols) { outputDebugSymbols_ = outputDebugSymbols; }
-    std::vector<std::string> includePath() const     { return includePath_; }
+    const std::vector<std::string> &includePath() const { return includePath_; }
     void setIncludePath(const std::vector<std::string> &includePath) { includePath_ = includePath; }
     void addIncludePath(const std::string &includePath) { includePath_.push_back(includePath); }
     std::vector<std::string> defines() const         { return defines_; }
@@ -60,8 +63,12 @@ public:
     void addWarning(const std::string &warning)      { warnings_.push_back(warning); }
     std::string programDbFileName() const            { return programDbFileName_; }
     void setProgramDbFileName(const std::string &programDbFileName) { programDbFileName_ = programDbFileName; }
+    size_t programDbMapSize() const                  { return programDbMapSize_; }
+    void setProgramDbMapSize(size_t programDbMapSize) { programDbMapSize_ = programDbMapSize; }
     std::string target() const                       { return target_; }
     void setTarget(const std::string &target)        { target_ = target; }
+    size_t jobs() const                              { return jobs_; }
+    void setJobs(size_t jobs)                        { jobs_ = jobs; }
 };
 
 
@@ -1,7 +1,10 @@
 #include "compiler.h"
 #include "programdb.h"
-//#include "parser.h"
 #include "clexer.h"
+#include "cparser.h"
+#include "includeinfo.h"
+#include "preprocessor.h"
+#include "threadpool.h"
 
 
 namespace deepC
@@ -13,20 +16,118 @@ namespace deepC
 //
 
 Compiler::Compiler(const CompileArgs &args) :
-    args_(args)
+    args_(args),
+    unchangedFiles_(0),
+    storedFiles_(0),
+    lexedFiles_(0),
+    relexedFiles_(0),
+    reusedTokenFiles_(0),
+    scannedIncludeFiles_(0),
+    reusedIncludeFiles_(0),
+    skippedIncludes_(0),
+    replayedHeaders_(0),
+    preprocessedHeaders_(0),
+    skippedTokens_(0),
+    nextFileId_(0),
+    reservedFileIds_(0)
 {
     // A single instance of program database class is used throughout the run.
-    pdb_ = std::make_shared<ProgramDb>(args.programDbFileName());
+    pdb_ = ProgramDb::create(args.programDbFileName(), args.programDbMapSize());
+    locator_ = SourceLocator(pdb_);
+    pdb_->loadIdentifiers(identifiers_);
+    includeResolver_ = std::make_unique<IncludeResolver>(pdb_, args.includePath());
+    macroContexts_ = std::make_unique<MacroContextCache>(pdb_);
 }
 
 
 //
-// Performs the preprocessing stage of compilation.
+// Gets a source file. If the modification time and size match what's in
+// the program database the stored copy is used, so an unchanged file
+// costs a stat() rather than a read and a database write.
 //
 
-bool Compiler::preprocess(const std::string &sourceFileName)
+std::shared_ptr<SourceFile> Compiler::loadSourceFile(const std::string &sourceFileName)
 {
-    return false;
+    CompileUnit unit(sourceFileName, &sourceArena_);
+    loadSourceFile(unit);
+    return unit.sourceFile;
+}
+
+
+void Compiler::loadSourceFile(CompileUnit &unit)
+{
+    TimePoint modified;
+    uint64_t size;
+    SourceFileOnFilesystem::getFileInfo(unit.sourceFileName, &modified, &size);
+
+    unit.previousVersion.reset();
+    std::shared_ptr<SourceFile> stored = pdb_->getSourceFile(unit.sourceFileName);
+    if (stored && stored->modified() == modified && stored->size() == size)
+    {
+        unchangedFiles_++;
+        unit.sourceFile = stored;
+        unit.sameAsStored = true;
+    }
+    else
+    {
+        // It's new or it's changed so read it and store it.
+        auto sourceFile = std::make_shared<SourceFileOnFilesystem>(unit.sourceFileName, unit.arena);
+        if (stored)
+        {
+            sourceFile->setId(stored->id());
+        }
+
+        // Hashing it reads the whole text from start to end.
+        sourceFile->adviseSequential();
+
+        // If it's only been touched what was stored about it still holds,
+        // otherwise the stored version is kept for relexing.
+        unit.sameAsStored = stored && stored->digest() == sourceFile->digest() && stored->sourceText() == sourceFile->sourceText();
+        if (stored && !unit.sameAsStored)
+        {
+            unit.previousVersion = stored;
+        }
+
+        if (unit.deferWrites)
+        {
+            if (!stored)
+            {
+                sourceFile->setId(newFileId());
+            }
+
+            unit.sourceFileToStore = true;
+        }
+        else
+        {
+            pdb_->put(*sourceFile);
+        }
+
+        storedFiles_++;
+        unit.sourceFile = sourceFile;
+    }
+
+    std::lock_guard<std::mutex> locker(locatorMutex_);
+    locator_.addFile(unit.sourceFile);
+}
+
+
+//
+// Give a new source file an id before it's stored, so the file can be
+// stored in a batch along with its tokens. Ids are reserved in blocks so
+// there's one write per block rather than one per file.
+//
+
+uint32_t Compiler::newFileId()
+{
+    std::lock_guard<std::mutex> locker(fileIdsMutex_);
+    if (reservedFileIds_ == 0)
+    {
+        nextFileId_ = pdb_->reserveIds(Storable::DbGroup::SourceFiles, fileIdBlock);
+        reservedFileIds_ = fileIdBlock;
+    }
+
+    reservedFileIds_--;
+    return nextFileId_++;
 }
 
 
@@ -34,87 +135,516 @@ bool Compiler::preprocess(const std::string &sourceFileName)
 // Lexical analysis.
 //
 
-bool Compiler::lex(const std::string &sourceFileName)
+bool Compiler::lex(CompileUnit &unit)
 {
-    // Create a lexer.
-    lexer_ = std::make_shared<CLexer>(pdb_, sourceFileName);
-    
-    return false;
+    // If the stored tokens were made from the same text they can be used
+    // straight from the program database.
+    const SourceFile &sourceFile = *unit.sourceFile;
+    const ContentDigest &digest = sourceFile.digest();
+    std::shared_ptr<SourceTokens> stored = pdb_->getSourceTokens(sourceFile.id());
+    if (stored)
+    {
+        stored = fromStoredIds(stored);
+    }
+
+    if (stored && unit.sameAsStored && stored->digest() == digest)
+    {
+        unit.tokens = stored;
+        reusedTokenFiles_++;
+        stored.reset();
+        releaseSnapshots(unit);
+        return true;
+    }
+
+    // If they were made from the previous version of the file only the
+    // changes need lexing, otherwise tokenise the whole file.
+    const std::shared_ptr<SourceFile> &previous = unit.previousVersion;
+    unit.tokens = std::make_shared<SourceTokens>(sourceFile.id(), digest);
+    unit.lexer = std::make_shared<CLexer>(unit.sourceFile);
+    unit.lexer->setInterner(&identifiers_);
+    if (stored && previous && previous->id() == sourceFile.id() && previous->digest() == stored->digest() &&
+        unit.lexer->relex(previous->sourceText(), stored->tokens(), &unit.tokens->tokens()))
+    {
+        relexedFiles_++;
+    }
+    else
+    {
+        unit.lexer->lexAll(&unit.tokens->tokens());
+        lexedFiles_++;
+    }
+
+    // The old versions keep a snapshot open, so let them go before writing.
+    stored.reset();
+    releaseSnapshots(unit);
+    unit.tokensToStore = true;
+
+    if (!unit.deferWrites)
+    {
+        // Store any new identifiers so they keep their ids next time, then
+        // the tokens which refer to them.
+        pdb_->saveIdentifiers(identifiers_);
+        std::shared_ptr<SourceTokens> storing = toStoredIds(unit.tokens);
+        pdb_->put(*storing);
+        unit.tokens->setId(storing->id());
+        unit.tokensToStore = false;
+    }
+
+    return true;
 }
 
 
 //
-// Parses source code.
+// Copies what's left of a unit in the program database out of it, so the
+// snapshots it was read from aren't held for the rest of the run. The
+// text of an unchanged file is copied and registered in its place, and
+// stored tokens are copied from the blob they were viewing.
 //
 
-bool Compiler::parse(const std::string &sourceFileName)
+void Compiler::releaseSnapshots(CompileUnit &unit)
 {
-    return false;
+    unit.previousVersion.reset();
+    unit.lexer.reset();
+
+    if (unit.tokens && unit.tokens->tokens().isView())
+    {
+        const TokenStream &tokens = unit.tokens->tokens();
+        auto copy = std::make_shared<SourceTokens>(unit.tokens->sourceFileId(), unit.tokens->digest());
+        copy->setId(unit.tokens->id());
+        copy->tokens().append(tokens, 0, tokens.size());
+        unit.tokens = copy;
+    }
+
+    if (std::dynamic_pointer_cast<SourceFileOnDatabase>(unit.sourceFile))
+    {
+        unit.sourceFile = std::make_shared<SourceFileInMemory>(*unit.sourceFile);
+
+        std::lock_guard<std::mutex> locker(locatorMutex_);
+        locator_.addFile(unit.sourceFile);
+    }
 }
 
 
 //
-// Performs semantic analysis.
+// Performs the preprocessing stage of compilation, on the tokens of the
+// source file.
 //
 
-bool Compiler::semantic(const std::string &sourceFileName)
+bool Compiler::preprocess(CompileUnit &unit)
 {
-    return false;
+    loadIncludeInfo(unit);
+    unit.preProc = std::make_shared<Preprocessor>(*this, args_, unit);
+    unit.preProc->run();
+    skippedIncludes_ += unit.preProc->skippedIncludes();
+    replayedHeaders_ += unit.preProc->replayedHeaders();
+    preprocessedHeaders_ += unit.preProc->preprocessedHeaders();
+    skippedTokens_ += unit.preProc->skippedTokens();
+
+    return true;
 }
 
 
 //
-// Optimises the internal representation.
+// Gets what a unit's source file includes. If the stored information was
+// scanned from the same text it's used as it is, otherwise the file's
+// tokens are scanned.
 //
 
-bool Compiler::optimise(const std::string &sourceFileName)
+void Compiler::loadIncludeInfo(CompileUnit &unit)
 {
-    return false;
+    std::shared_ptr<IncludeInfo> stored = pdb_->getIncludeInfo(unit.sourceFile->id());
+    if (stored && unit.sameAsStored && stored->digest() == unit.sourceFile->digest())
+    {
+        unit.includeInfo = stored;
+        reusedIncludeFiles_++;
+        return;
+    }
+
+    if (!unit.tokens)
+    {
+        lex(unit);
+    }
+
+    // Lexing can replace the source file with a copy.
+    const SourceFile &sourceFile = *unit.sourceFile;
+    auto info = std::make_shared<IncludeInfo>(sourceFile.id(), sourceFile.digest());
+    info->scan(unit.tokens->tokens(), sourceFile.sourceText());
+    unit.includeInfo = info;
+    scannedIncludeFiles_++;
+
+    if (unit.deferWrites)
+    {
+        unit.includeInfoToStore = true;
+    }
+    else
+    {
+        pdb_->put(*info);
+    }
 }
 
 
 //
-// Generates object code.
+// Gets a header which a unit includes. The first time a header is
+// included in this run it's loaded along with its include information,
+// and after that it comes from headers_. The header's writes are deferred
+// if the includer's are.
 //
 
-bool Compiler::codegen(const std::string &sourceFileName)
+std::shared_ptr<CompileUnit> Compiler::includeHeader(const std::string &fileName, const CompileUnit &includer)
 {
-    return false;
+    {
+        std::lock_guard<std::mutex> locker(headersMutex_);
+        auto it = headers_.find(fileName);
+        if (it != headers_.end())
+            return it->second;
+    }
+
+    // If another file loads it at the same time the first one in wins.
+    auto header = std::make_shared<CompileUnit>(fileName, includer.arena);
+    header->deferWrites = includer.deferWrites;
+    loadSourceFile(*header);
+    loadIncludeInfo(*header);
+
+    // Headers are kept for the whole run, so they mustn't hold snapshots
+    // even if they haven't been lexed.
+    releaseSnapshots(*header);
+
+    std::lock_guard<std::mutex> locker(headersMutex_);
+    return headers_.emplace(fileName, header).first->second;
 }
 
 
 //
-// Compiles the whole program from start to end.
+// Gets the tokens of a header. Headers whose include information was
+// stored aren't lexed when they're loaded, so it's done the first time
+// one is preprocessed rather than replayed.
 //
 
-bool Compiler::compile(const std::string &sourceFileName)
+const TokenStream &Compiler::headerTokens(CompileUnit &header)
 {
-    // Preprocess the source file.
-    if (!preprocess(sourceFileName))
-        return false;
+    std::lock_guard<std::mutex> locker(header.mutex);
+    if (!header.tokens)
+    {
+        lex(header);
+    }
+
+    return header.tokens->tokens();
+}
+
+
+//
+// Parses the preprocessed tokens. Syntax errors are rethrown with where
+// they are in the source prepended, as the preprocessor's are.
+//
+
+bool Compiler::parse(CompileUnit &unit)
+{
+    unit.parser = std::make_shared<CParser>(unit.preProc->output());
+    try
+    {
+        unit.parser->parse();
+    }
+    catch (const ParserException &e)
+    {
+        SourcePos pos;
+        {
+            std::lock_guard<std::mutex> locker(locatorMutex_);
+            pos = locator_.toPos(e.loc());
+        }
+
+        if (!pos.exists())
+            throw;
+
+        throw ParserException(pos.fileName() + ":" + std::to_string(pos.line()) + ": " + e.what(), e.loc());
+    }
+
+    return true;
+}
+
+
+//
+// Performs semantic analysis. There's none yet, so nothing can fail.
+//
+
+bool Compiler::semantic(CompileUnit &unit)
+{
+    return true;
+}
+
+
+//
+// Optimises the internal representation. There's no optimisation yet.
+//
+
+bool Compiler::optimise(CompileUnit &unit)
+{
+    return true;
+}
+
+
+//
+// Generates object code. There's no code generation yet.
+//
+
+bool Compiler::codegen(CompileUnit &unit)
+{
+    return true;
+}
+
+
+//
+// Runs all the phases of compilation on a file.
+//
+
+bool Compiler::compileUnit(CompileUnit &unit)
+{
+    // Get the source file.
+    loadSourceFile(unit);
 
     // Lexical analysis.
-    if (!lex(sourceFileName))
+    if (!lex(unit))
+        return false;
+
+    // Preprocess the tokens.
+    if (!preprocess(unit))
         return false;
 
     // Parsing.
-    if (!parse(sourceFileName))
+    if (!parse(unit))
         return false;
 
     // Semantic analysis.
-    if (!semantic(sourceFileName))
+    if (!semantic(unit))
         return false;
 
     // Optimisation.
-    if (!optimise(sourceFileName))
+    if (!optimise(unit))
         return false;
 
     // Code generation.
-    if (!codegen(sourceFileName))
+    if (!codegen(unit))
         return false;
 
     return true;
 }
 
 
+//
+// Compiles the whole program from start to end.
+//
+
+bool Compiler::compile(const std::string &sourceFileName)
+{
+    CompileUnit unit(sourceFileName, &sourceArena_);
+    bool ok = false;
+    std::exception_ptr error;
+    try {
+        ok = compileUnit(unit);
+    }
+    catch (...) {
+        error = std::current_exception();
+    }
+
+    // Where its headers were found, or not, is still worth keeping if it
+    // failed.
+    tokens_ = unit.tokens;
+    includeResolver_->store();
+    macroContexts_->store();
+
+    if (error)
+        std::rethrow_exception(error);
+
+    return ok;
+}
+
+
+//
+// Compiles some files. With more than one job they're compiled in
+// parallel on a work stealing thread pool.
+//
+// Interning identifiers while they're being saved isn't allowed, and
+// committing a transaction per file would serialise the workers on the
+// program database's write lock anyway. So the source files and tokens
+// of all the files are stored together in a single batch once they've
+// all been lexed. New files are given reserved ids in the meantime.
+//
+
+bool Compiler::compileAll(const std::vector<std::string> &sourceFileNames)
+{
+    size_t jobs = args_.jobs();
+    if (jobs <= 1 || sourceFileNames.size() <= 1)
+    {
+        bool ok = true;
+        for (const std::string &sourceFileName : sourceFileNames)
+        {
+            ok = compile(sourceFileName) && ok;
+        }
+
+        return ok;
+    }
+
+    ThreadPool pool(jobs);
+    while (workerArenas_.size() < pool.size())
+    {
+        workerArenas_.push_back(std::make_unique<Arena>());
+    }
+
+    std::vector<std::unique_ptr<CompileUnit>> units;
+    for (const std::string &sourceFileName : sourceFileNames)
+    {
+        units.push_back(std::make_unique<CompileUnit>(sourceFileName, nullptr));
+        units.back()->deferWrites = true;
+    }
+
+    std::atomic<bool> ok(true);
+    for (auto &unit : units)
+    {
+        CompileUnit *u = unit.get();
+        pool.submit([this, u, &ok](size_t worker)
+        {
+            u->arena = workerArenas_[worker].get();
+            if (!compileUnit(*u))
+            {
+                ok = false;
+            }
+        });
+    }
+
+    // If a file failed what the others got done is still stored before
+    // the error is passed on. Units only have things flagged to store
+    // once they're complete.
+    std::exception_ptr error;
+    try {
+        pool.wait();
+    }
+    catch (...) {
+        error = std::current_exception();
+    }
+
+    storeTokens(units);
+    includeResolver_->store();
+    macroContexts_->store();
+
+    if (error)
+        std::rethrow_exception(error);
+
+    tokens_ = units.back()->tokens;
+
+    return ok;
+}
+
+
+//
+// Store the identifiers and then the tokens and include information of
+// some units which were compiled without writing them, and of the headers
+// they included.
+//
+
+void Compiler::storeTokens(const std::vector<std::unique_ptr<CompileUnit>> &units)
+{
+    pdb_->saveIdentifiers(identifiers_);
+
+    // Copies with the stored identifier ids have to last until they're committed.
+    std::vector<std::shared_ptr<SourceTokens>> storing;
+    ProgramDb::Batch batch(*pdb_);
+    auto store = [this, &batch, &storing](CompileUnit &unit)
+    {
+        if (unit.sourceFileToStore)
+        {
+            batch.put(*unit.sourceFile);
+            unit.sourceFileToStore = false;
+        }
+
+        if (unit.tokensToStore)
+        {
+            storing.push_back(toStoredIds(unit.tokens));
+            batch.put(*storing.back());
+            unit.tokensToStore = false;
+        }
+
+        if (unit.includeInfoToStore)
+        {
+            batch.put(*unit.includeInfo);
+            unit.includeInfoToStore = false;
+        }
+    };
+
+    for (auto &unit : units)
+    {
+        store(*unit);
+    }
+
+    std::lock_guard<std::mutex> locker(headersMutex_);
+    for (auto &header : headers_)
+    {
+        store(*header.second);
+    }
+
+    batch.commit();
+}
+
+
+//
+// Get stored tokens with our identifier ids. They're only copied if
+// another compiler gave some identifiers different ids. Returns nullptr
+// if they use identifiers we don't know about, as tokens stored by
+// another compiler since we loaded the identifiers can.
+//
+
+std::shared_ptr<SourceTokens> Compiler::fromStoredIds(const std::shared_ptr<SourceTokens> &stored)
+{
+    const TokenStream &tokens = stored->tokens();
+    std::shared_ptr<SourceTokens> ours;
+    for (size_t i = 0; i < tokens.size(); i++)
+    {
+        uint32_t storedId = tokens.identId(i);
+        if (storedId == TokenStream::noIdent)
+            continue;
+
+        Interner::Id id = identifiers_.fromStored(storedId);
+        if (id == Interner::none)
+            return nullptr;
+
+        if (id != storedId)
+        {
+            if (!ours)
+            {
+                ours = std::make_shared<SourceTokens>(stored->sourceFileId(), stored->digest());
+                ours->setId(stored->id());
+                ours->tokens().append(tokens, 0, tokens.size());
+            }
+
+            ours->tokens().setIdentId(i, id);
+        }
+    }
+
+    return ours ? ours : stored;
+}
+
+
+//
+// Get tokens ready to store, with the program database's identifier ids.
+// The identifiers must have been saved already.
+//
+
+std::shared_ptr<SourceTokens> Compiler::toStoredIds(const std::shared_ptr<SourceTokens> &tokens)
+{
+    if (!identifiers_.storedIdsDiffer())
+        return tokens;
+
+    auto stored = std::make_shared<SourceTokens>(tokens->sourceFileId(), tokens->digest());
+    stored->setId(tokens->id());
+    stored->tokens().append(tokens->tokens(), 0, tokens->tokens().size());
+    for (size_t i = 0; i < stored->tokens().size(); i++)
+    {
+        uint32_t id = stored->tokens().identId(i);
+        if (id != TokenStream::noIdent)
+        {
+            stored->tokens().setIdentId(i, identifiers_.toStored(id));
+        }
+    }
+
+    return stored;
+}
+
+
 } // namespace deepC
@@ -1,10 +1,20 @@
 #ifndef DEEPC_COMPILER_H
 #define DEEPC_COMPILER_H
 
+#include <atomic>
 #include <memory>
+#include <mutex>
+#include <unordered_map>
+#include <vector>
 
+#include "arena.h"
 #include "compileargs.h"
+#include "includeresolver.h"
+#include "interner.h"
+#include "macrocontext.h"
 #include "programdb.h"
+#include "sourceloc.h"
+#include "sourcetokens.h"
 
 
 namespace deepC
@@ -15,6 +25,61 @@ namespace deepC
 class Preprocessor;
 class CLexer;
 class CParser;
+class IncludeInfo;
+
+
+//
+// Everything about one source file while it's being compiled. Files
+// compiled at the same time each have their own.
+//
+
+struct CompileUnit
+{
+    std::string                   sourceFileName;
+
+    // Small source files are read into here.
+    Arena                        *arena;
+
+    // The source file being compiled, and whether it still needs storing.
+    std::shared_ptr<SourceFile>   sourceFile;
+    bool                          sourceFileToStore;
+
+    // The stored version of the source file, if it's changed since then.
+    // Its text stays readable for as long as we hold it so the file's
+    // tokens can be updated rather than lexed from scratch. It's let go
+    // once the file is lexed.
+    std::shared_ptr<SourceFile>   previousVersion;
+
+    // Whether the source text is known to be the text that was stored,
+    // byte for byte, so what's stored about it can be reused. A matching
+    // digest alone isn't enough.
+    bool                          sameAsStored;
+
+    // An instance of the lexer, preprocessor and parser are created for
+    // each file. The parser holds the file's parse tree.
+    std::shared_ptr<Preprocessor> preProc;
+    std::shared_ptr<CLexer>       lexer;
+    std::shared_ptr<CParser>      parser;
+
+    // The tokens of the source file, and whether they still need storing.
+    std::shared_ptr<SourceTokens> tokens;
+    bool                          tokensToStore;
+
+    // What the source file includes and how it's guarded, and whether it
+    // still needs storing.
+    std::shared_ptr<IncludeInfo>  includeInfo;
+    bool                          includeInfoToStore;
+
+    // Whether writes should be left for the caller to batch rather than
+    // made straight away.
+    bool                          deferWrites;
+
+    // Held while a header's tokens are made, as several files being
+    // compiled at once can include it.
+    std::mutex                    mutex;
+
+    CompileUnit(const std::string &fileName, Arena *arena) : sourceFileName(fileName), arena(arena), sourceFileToStore(false), sameAsStored(false), tokensToStore(false), includeInfoToStore(false), deferWrites(false) {}
+};
 
 
 //
@@ -22,34 +87,170 @@ class CParser;
 // It exists for the duration of the program so it keeps a single instance
 // of the program database open even if multiple files are compiled.
 //
+// Each header included during the run is loaded once and kept along with
+// what it includes, so the preprocessor can follow the include graph
+// without opening headers again.
+//
+// Several files can be compiled at once with compileAll(). They share the
+// program database and the identifiers, and their tokens are stored
+// together in one batch once they've all been lexed.
+//
 
 class Compiler
 {
 private:
     const CompileArgs            &args_;
-    
+
 private:
     // A single instance of program database class is used throughout the run.
     std::shared_ptr<ProgramDb>    pdb_;
 
-    // An instance of the lexer and parser are created when compiling each file.
-    std::shared_ptr<Preprocessor> preProc_;
-    std::shared_ptr<CLexer>       lexer_;
-    std::shared_ptr<CParser>      parser_;
+    // Small source files are read into here, or into a worker's own arena
+    // when files are compiled in parallel.
+    Arena                         sourceArena_;
+    std::vector<std::unique_ptr<Arena>> workerArenas_;
+
+    // Converts source locations to line and column for messages.
+    SourceLocator                 locator_;
+    std::mutex                    locatorMutex_;
+
+    // Every identifier in the program, with the same ids as in previous runs.
+    Interner                      identifiers_;
+
+    // How many source files were found unchanged in the program database
+    // and how many had to be read and stored.
+    std::atomic<size_t>           unchangedFiles_;
+    std::atomic<size_t>           storedFiles_;
+
+    // How many files had to be lexed, how many only had their changes
+    // relexed and how many reused their stored tokens.
+    std::atomic<size_t>           lexedFiles_;
+    std::atomic<size_t>           relexedFiles_;
+    std::atomic<size_t>           reusedTokenFiles_;
+
+    // How many files had their #includes scanned, how many used their
+    // stored include information, and how many repeat inclusions of
+    // guarded headers were skipped.
+    std::atomic<size_t>           scannedIncludeFiles_;
+    std::atomic<size_t>           reusedIncludeFiles_;
+    std::atomic<size_t>           skippedIncludes_;
+
+    // How many headers were replayed from a macro context they'd been
+    // included in before, and how many had to be preprocessed.
+    std::atomic<size_t>           replayedHeaders_;
+    std::atomic<size_t>           preprocessedHeaders_;
+
+    // How many tokens were in conditional groups which weren't taken.
+    std::atomic<size_t>           skippedTokens_;
+
+    // Finds the files #includes refer to, caching the results in the
+    // program database.
+    std::unique_ptr<IncludeResolver> includeResolver_;
+
+    // The macro contexts headers have been included in.
+    std::unique_ptr<MacroContextCache> macroContexts_;
+
+    // Ids set aside for new source files whose writes are deferred. They
+    // need an id before they're stored as their tokens refer to it.
+    static constexpr uint32_t     fileIdBlock = 64;
+    uint32_t                      nextFileId_;
+    uint32_t                      reservedFileIds_;
+    std::mutex                    fileIdsMutex_;
+
+    // The headers included so far, by file name. They don't hold any
+    // program database snapshots, see releaseSnapshots().
+    std::unordered_map<std::string, std::shared_ptr<CompileUnit>> headers_;
+    std::mutex                    headersMutex_;
+
+    // The tokens of the file most recently compiled.
+    std::shared_ptr<SourceTokens> tokens_;
 
 private:
     // Compilation phases.
-    bool preprocess(const std::string &sourceFileName);
-    bool lex(const std::string &sourceFileName);
-    bool parse(const std::string &sourceFileName);
-    bool semantic(const std::string &sourceFileName);
-    bool optimise(const std::string &sourceFileName);
-    bool codegen(const std::string &sourceFileName);
+    bool lex(CompileUnit &unit);
+    bool preprocess(CompileUnit &unit);
+    bool parse(CompileUnit &unit);
+    bool semantic(CompileUnit &unit);
+    bool optimise(CompileUnit &unit);
+    bool codegen(CompileUnit &unit);
+
+    // Run all the phases on a file.
+    bool compileUnit(CompileUnit &unit);
+
+    // Get a unit's source file, see loadSourceFile().
+    void loadSourceFile(CompileUnit &unit);
+
+    // Give a new source file an id without storing it yet.
+    uint32_t newFileId();
+
+    // Copy what a unit needs out of the program database once it's lexed,
+    // so the database snapshots it was read from can be let go.
+    void releaseSnapshots(CompileUnit &unit);
+
+    // Get what a unit's source file includes, from the program database
+    // if it hasn't changed.
+    void loadIncludeInfo(CompileUnit &unit);
+
+    // Store the identifiers and then the source files, tokens and include
+    // information of some units and of the headers they included.
+    void storeTokens(const std::vector<std::unique_ptr<CompileUnit>> &units);
+
+    // Convert tokens between our identifier ids and the program
+    // database's, copying them if they differ.
+    std::shared_ptr<SourceTokens> fromStoredIds(const std::shared_ptr<SourceTokens> &stored);
+    std::shared_ptr<SourceTokens> toStoredIds(const std::shared_ptr<SourceTokens> &tokens);
 
 public:
     Compiler(const CompileArgs &args);
 
+    // Compile a file.
     bool compile(const std::string &sourceFileName);
+
+    // Compile some files, args.jobs() at a time. Returns true if they
+    // all compiled.
+    bool compileAll(const std::vector<std::string> &sourceFileNames);
+
+    // Get a source file, only reading it if it's changed since it was
+    // stored in the program database.
+    std::shared_ptr<SourceFile> loadSourceFile(const std::string &sourceFileName);
+    size_t unchangedFiles() const { return unchangedFiles_; }
+    size_t storedFiles() const    { return storedFiles_; }
+    size_t lexedFiles() const     { return lexedFiles_; }
+    size_t relexedFiles() const   { return relexedFiles_; }
+    size_t reusedTokenFiles() const { return reusedTokenFiles_; }
+    size_t scannedIncludeFiles() const { return scannedIncludeFiles_; }
+    size_t reusedIncludeFiles() const  { return reusedIncludeFiles_; }
+    size_t skippedIncludes() const     { return skippedIncludes_; }
+    size_t replayedHeaders() const     { return replayedHeaders_; }
+    size_t preprocessedHeaders() const { return preprocessedHeaders_; }
+    size_t skippedTokens() const       { return skippedTokens_; }
+
+    // Get a header which a unit includes, with its include information.
+    // It's only loaded the first time it's included in the run.
+    std::shared_ptr<CompileUnit> includeHeader(const std::string &fileName, const CompileUnit &includer);
+
+    // Get the tokens of a header, lexing it if its stored include
+    // information meant it hasn't been yet.
+    const TokenStream &headerTokens(CompileUnit &header);
+
+    // Finds the files #includes refer to.
+    IncludeResolver &includeResolver() { return *includeResolver_; }
+
+    // The macro contexts headers have been included in.
+    MacroContextCache &macroContexts() { return *macroContexts_; }
+
+    // The tokens of the file most recently compiled, or of the last file
+    // given to compileAll().
+    std::shared_ptr<SourceTokens> tokens() const { return tokens_; }
+
+    // Converts source locations of loaded files to line and column.
+    SourceLocator &locator()      { return locator_; }
+
+    // The interned identifiers.
+    Interner &identifiers()       { return identifiers_; }
+
+    // The program database used for this run.
+    std::shared_ptr<ProgramDb> programDb() { return pdb_; }
 };
 
 
@@ -0,0 +1,44 @@
+#ifndef DEEPC_CONTENTHASH_H
+#define DEEPC_CONTENTHASH_H
+
+#include <cstdint>
+#include <cstddef>
+#include <string_view>
+
+
+namespace deepC
+{
+
+
+//
+// xxHash64 - a fast non-cryptographic hash. This is the standard
+// algorithm so values match other xxHash64 implementations.
+//
+
+uint64_t xxHash64(const void *data, size_t len, uint64_t seed = 0);
+
+
+//
+// Identifies a piece of content, such as the text of a source file, by
+// its hash and size. Content with the same digest is assumed to be the
+// same. The digest is stored in the program database exactly as laid
+// out here.
+//
+
+struct ContentDigest
+{
+    uint64_t hash;
+    uint64_t size;
+
+    ContentDigest() : hash(0), size(0) {}
+    ContentDigest(uint64_t h, uint64_t s) : hash(h), size(s) {}
+    explicit ContentDigest(std::string_view content) : hash(xxHash64(content.data(), content.size())), size(content.size()) {}
+
+    bool operator==(const ContentDigest &d) const { return hash == d.hash && size == d.size; }
+    bool operator!=(const ContentDigest &d) const { return !(*this == d); }
+};
+
+
+} // namespace deepC
+
+#endif // DEEPC_CONTENTHASH_H
@@ -1,5 +1,11 @@
-#include <string>
-#include <memory>
+//
+// C parser generated by dcparsergen from c_syntax.pgen. Don't edit.
+//
+// A recursive descent parser with a function for each definition. Left
+// recursive definitions are loops, and each choice is a switch on the
+// next token, or the next two where one isn't enough. Each function
+// counts how deeply they're nested, see CParser::maxDepth.
+//
 
 #include "cparser.h"
 
@@ -8,12 +14,5651 @@ namespace deepC
 {
 
 
-CParser::CParser(std::shared_ptr<ProgramDb> pdb, const CompileArgs &args, const std::string &sourceFileName) :
-    pdb_(pdb),
-    args_(args),
-    sourceFileName_(sourceFileName)
+static const char *const ruleNames[] =
 {
+    "identifier",
+    "typedef-name",
+    "constant",
+    "string-literal",
+    "primary-expression",
+    "generic-selection",
+    "generic-assoc-list",
+    "generic-association",
+    "postfix-expression",
+    "argument-expression-list",
+    "unary-expression",
+    "unary-operator",
+    "cast-expression",
+    "multiplicative-expression",
+    "additive-expression",
+    "shift-expression",
+    "relational-expression",
+    "equality-expression",
+    "AND-expression",
+    "exclusive-OR-expression",
+    "inclusive-OR-expression",
+    "logical-AND-expression",
+    "logical-OR-expression",
+    "conditional-expression",
+    "assignment-expression",
+    "assignment-operator",
+    "expression",
+    "constant-expression",
+    "declaration",
+    "declaration-specifiers",
+    "init-declarator-list",
+    "init-declarator",
+    "storage-class-specifier",
+    "type-specifier",
+    "struct-or-union-specifier",
+    "struct-or-union",
+    "struct-declaration-list",
+    "struct-declaration",
+    "specifier-qualifier-list",
+    "struct-declarator-list",
+    "struct-declarator",
+    "enum-specifier",
+    "enumerator-list",
+    "enumerator",
+    "atomic-type-specifier",
+    "type-qualifier",
+    "function-specifier",
+    "alignment-specifier",
+    "declarator",
+    "direct-declarator",
+    "pointer",
+    "type-qualifier-list",
+    "parameter-type-list",
+    "parameter-list",
+    "parameter-declaration",
+    "parameter-declarator",
+    "direct-parameter-declarator",
+    "identifier-list",
+    "type-name",
+    "abstract-declarator",
+    "direct-abstract-declarator",
+    "initializer",
+    "initializer-list",
+    "designation",
+    "designator-list",
+    "designator",
+    "static_assert-declaration",
+    "statement",
+    "labeled-statement",
+    "compound-statement",
+    "block-item-list",
+    "block-item",
+    "expression-statement",
+    "selection-statement",
+    "iteration-statement",
+    "jump-statement",
+    "translation-unit",
+    "external-declaration",
+    "declaration-list",
+};
 
+
+const char *ruleName(Rule rule)
+{
+    return ruleNames[static_cast<size_t>(rule)];
+}
+
+
+const char *CParser::spelling(unsigned terminal)
+{
+    switch (terminal)
+    {
+    case EndOfFile:
+        return "end of file";
+
+    case Identifier:
+        return "identifier";
+
+    case TypedefName:
+        return "typedef-name";
+
+    case Constant:
+        return "constant";
+
+    case StringLiteral:
+        return "string-literal";
+
+    case punctuator(Punctuator::LeftParen):
+        return "'('";
+
+    case punctuator(Punctuator::RightParen):
+        return "')'";
+
+    case keyword(Keyword::Generic):
+        return "'_Generic'";
+
+    case punctuator(Punctuator::Comma):
+        return "','";
+
+    case punctuator(Punctuator::Colon):
+        return "':'";
+
+    case keyword(Keyword::Default):
+        return "'default'";
+
+    case punctuator(Punctuator::LeftBracket):
+        return "'['";
+
+    case punctuator(Punctuator::RightBracket):
+        return "']'";
+
+    case punctuator(Punctuator::Dot):
+        return "'.'";
+
+    case punctuator(Punctuator::MinusGreater):
+        return "'->'";
+
+    case punctuator(Punctuator::PlusPlus):
+        return "'++'";
+
+    case punctuator(Punctuator::MinusMinus):
+        return "'--'";
+
+    case keyword(Keyword::Sizeof):
+        return "'sizeof'";
+
+    case keyword(Keyword::Alignof):
+        return "'_Alignof'";
+
+    case punctuator(Punctuator::Amp):
+        return "'&'";
+
+    case punctuator(Punctuator::Star):
+        return "'*'";
+
+    case punctuator(Punctuator::Plus):
+        return "'+'";
+
+    case punctuator(Punctuator::Minus):
+        return "'-'";
+
+    case punctuator(Punctuator::Tilde):
+        return "'~'";
+
+    case punctuator(Punctuator::Exclaim):
+        return "'!'";
+
+    case punctuator(Punctuator::LeftBrace):
+        return "'{'";
+
+    case punctuator(Punctuator::RightBrace):
+        return "'}'";
+
+    case punctuator(Punctuator::Slash):
+        return "'/'";
+
+    case punctuator(Punctuator::Percent):
+        return "'%'";
+
+    case punctuator(Punctuator::LessLess):
+        return "'<<'";
+
+    case punctuator(Punctuator::GreaterGreater):
+        return "'>>'";
+
+    case punctuator(Punctuator::Less):
+        return "'<'";
+
+    case punctuator(Punctuator::Greater):
+        return "'>'";
+
+    case punctuator(Punctuator::LessEqual):
+        return "'<='";
+
+    case punctuator(Punctuator::GreaterEqual):
+        return "'>='";
+
+    case punctuator(Punctuator::EqualEqual):
+        return "'=='";
+
+    case punctuator(Punctuator::ExclaimEqual):
+        return "'!='";
+
+    case punctuator(Punctuator::Caret):
+        return "'^'";
+
+    case punctuator(Punctuator::Pipe):
+        return "'|'";
+
+    case punctuator(Punctuator::AmpAmp):
+        return "'&&'";
+
+    case punctuator(Punctuator::PipePipe):
+        return "'||'";
+
+    case punctuator(Punctuator::Question):
+        return "'?'";
+
+    case punctuator(Punctuator::Equal):
+        return "'='";
+
+    case punctuator(Punctuator::StarEqual):
+        return "'*='";
+
+    case punctuator(Punctuator::SlashEqual):
+        return "'/='";
+
+    case punctuator(Punctuator::PercentEqual):
+        return "'%='";
+
+    case punctuator(Punctuator::PlusEqual):
+        return "'+='";
+
+    case punctuator(Punctuator::MinusEqual):
+        return "'-='";
+
+    case punctuator(Punctuator::LessLessEqual):
+        return "'<<='";
+
+    case punctuator(Punctuator::GreaterGreaterEqual):
+        return "'>>='";
+
+    case punctuator(Punctuator::AmpEqual):
+        return "'&='";
+
+    case punctuator(Punctuator::CaretEqual):
+        return "'^='";
+
+    case punctuator(Punctuator::PipeEqual):
+        return "'|='";
+
+    case punctuator(Punctuator::Semi):
+        return "';'";
+
+    case keyword(Keyword::Typedef):
+        return "'typedef'";
+
+    case keyword(Keyword::Extern):
+        return "'extern'";
+
+    case keyword(Keyword::Static):
+        return "'static'";
+
+    case keyword(Keyword::ThreadLocal):
+        return "'_Thread_local'";
+
+    case keyword(Keyword::Auto):
+        return "'auto'";
+
+    case keyword(Keyword::Register):
+        return "'register'";
+
+    case keyword(Keyword::Void):
+        return "'void'";
+
+    case keyword(Keyword::Char):
+        return "'char'";
+
+    case keyword(Keyword::Short):
+        return "'short'";
+
+    case keyword(Keyword::Int):
+        return "'int'";
+
+    case keyword(Keyword::Long):
+        return "'long'";
+
+    case keyword(Keyword::Float):
+        return "'float'";
+
+    case keyword(Keyword::Double):
+        return "'double'";
+
+    case keyword(Keyword::Signed):
+        return "'signed'";
+
+    case keyword(Keyword::Unsigned):
+        return "'unsigned'";
+
+    case keyword(Keyword::Bool):
+        return "'_Bool'";
+
+    case keyword(Keyword::Complex):
+        return "'_Complex'";
+
+    case keyword(Keyword::Struct):
+        return "'struct'";
+
+    case keyword(Keyword::Union):
+        return "'union'";
+
+    case keyword(Keyword::Enum):
+        return "'enum'";
+
+    case keyword(Keyword::Atomic):
+        return "'_Atomic'";
+
+    case keyword(Keyword::Const):
+        return "'const'";
+
+    case keyword(Keyword::Restrict):
+        return "'restrict'";
+
+    case keyword(Keyword::Volatile):
+        return "'volatile'";
+
+    case keyword(Keyword::Inline):
+        return "'inline'";
+
+    case keyword(Keyword::Noreturn):
+        return "'_Noreturn'";
+
+    case keyword(Keyword::Alignas):
+        return "'_Alignas'";
+
+    case punctuator(Punctuator::DotDotDot):
+        return "'...'";
+
+    case keyword(Keyword::StaticAssert):
+        return "'_Static_assert'";
+
+    case keyword(Keyword::Case):
+        return "'case'";
+
+    case keyword(Keyword::If):
+        return "'if'";
+
+    case keyword(Keyword::Else):
+        return "'else'";
+
+    case keyword(Keyword::Switch):
+        return "'switch'";
+
+    case keyword(Keyword::While):
+        return "'while'";
+
+    case keyword(Keyword::Do):
+        return "'do'";
+
+    case keyword(Keyword::For):
+        return "'for'";
+
+    case keyword(Keyword::Goto):
+        return "'goto'";
+
+    case keyword(Keyword::Continue):
+        return "'continue'";
+
+    case keyword(Keyword::Break):
+        return "'break'";
+
+    case keyword(Keyword::Return):
+        return "'return'";
+
+    default:
+        return "a token";
+    }
+}
+
+
+//
+// The parsing functions, one for each definition.
+//
+
+class CParser::Rules
+{
+    CParser &p;
+
+public:
+    explicit Rules(CParser &parser) : p(parser) {}
+
+    ParseNode *parsePrimaryExpression();
+    ParseNode *parseGenericSelection();
+    ParseNode *parseGenericAssocList();
+    ParseNode *parseGenericAssociation();
+    ParseNode *parsePostfixExpression();
+    ParseNode *parseArgumentExpressionList();
+    ParseNode *parseUnaryExpression();
+    ParseNode *parseUnaryOperator();
+    ParseNode *parseCastExpression();
+    ParseNode *parseMultiplicativeExpression();
+    ParseNode *parseAdditiveExpression();
+    ParseNode *parseShiftExpression();
+    ParseNode *parseRelationalExpression();
+    ParseNode *parseEqualityExpression();
+    ParseNode *parseANDExpression();
+    ParseNode *parseExclusiveORExpression();
+    ParseNode *parseInclusiveORExpression();
+    ParseNode *parseLogicalANDExpression();
+    ParseNode *parseLogicalORExpression();
+    ParseNode *parseConditionalExpression();
+    ParseNode *parseAssignmentExpression();
+    ParseNode *parseAssignmentOperator();
+    ParseNode *parseExpression();
+    ParseNode *parseConstantExpression();
+    ParseNode *parseDeclaration();
+    ParseNode *parseDeclarationSpecifiers();
+    ParseNode *parseInitDeclaratorList();
+    ParseNode *parseInitDeclarator();
+    ParseNode *parseStorageClassSpecifier();
+    ParseNode *parseTypeSpecifier();
+    ParseNode *parseStructOrUnionSpecifier();
+    ParseNode *parseStructOrUnion();
+    ParseNode *parseStructDeclarationList();
+    ParseNode *parseStructDeclaration();
+    ParseNode *parseSpecifierQualifierList();
+    ParseNode *parseStructDeclaratorList();
+    ParseNode *parseStructDeclarator();
+    ParseNode *parseEnumSpecifier();
+    ParseNode *parseEnumeratorList();
+    ParseNode *parseEnumerator();
+    ParseNode *parseAtomicTypeSpecifier();
+    ParseNode *parseTypeQualifier();
+    ParseNode *parseFunctionSpecifier();
+    ParseNode *parseAlignmentSpecifier();
+    ParseNode *parseDeclarator();
+    ParseNode *parseDirectDeclarator();
+    ParseNode *parsePointer();
+    ParseNode *parseTypeQualifierList();
+    ParseNode *parseParameterTypeList();
+    ParseNode *parseParameterList();
+    ParseNode *parseParameterDeclaration();
+    ParseNode *parseParameterDeclarator();
+    ParseNode *parseDirectParameterDeclarator();
+    ParseNode *parseIdentifierList();
+    ParseNode *parseTypeName();
+    ParseNode *parseAbstractDeclarator();
+    ParseNode *parseDirectAbstractDeclarator();
+    ParseNode *parseInitializer();
+    ParseNode *parseInitializerList();
+    ParseNode *parseDesignation();
+    ParseNode *parseDesignatorList();
+    ParseNode *parseDesignator();
+    ParseNode *parseStaticAssertDeclaration();
+    ParseNode *parseStatement();
+    ParseNode *parseLabeledStatement();
+    ParseNode *parseCompoundStatement();
+    ParseNode *parseBlockItemList();
+    ParseNode *parseBlockItem();
+    ParseNode *parseExpressionStatement();
+    ParseNode *parseSelectionStatement();
+    ParseNode *parseIterationStatement();
+    ParseNode *parseJumpStatement();
+    ParseNode *parseTranslationUnit();
+    ParseNode *parseExternalDeclaration();
+    ParseNode *parseDeclarationList();
+
+    ParseNode *parseDirectDeclaratorHead();
+    ParseNode *parseDirectParameterDeclaratorHead();
+    ParseNode *parseDirectAbstractDeclaratorHead();
+    ParseNode *parseInitializerListHead();
+};
+
+
+ParseNode *CParser::Rules::parsePrimaryExpression()
+{
+    DepthGuard depth(p);
+    Children children(p.position());
+    switch (p.la(0))
+    {
+    case Identifier:
+    case TypedefName:
+        children.add(p.leaf(Rule::Identifier));
+        return children.first;
+
+    case Constant:
+        children.add(p.leaf(Rule::Constant));
+        return children.first;
+
+    case StringLiteral:
+        children.add(p.leaf(Rule::StringLiteral));
+        return children.first;
+
+    case punctuator(Punctuator::LeftParen):
+        p.advance();
+        children.add(parseExpression());
+        p.expect(punctuator(Punctuator::RightParen));
+        return p.node(Rule::PrimaryExpression, 3, children);
+
+    case keyword(Keyword::Generic):
+        children.add(parseGenericSelection());
+        return children.first;
+
+    default:
+        p.unexpected(Rule::PrimaryExpression);
+    }
+}
+
+
+ParseNode *CParser::Rules::parseGenericSelection()
+{
+    DepthGuard depth(p);
+    Children children(p.position());
+    p.expect(keyword(Keyword::Generic));
+    p.expect(punctuator(Punctuator::LeftParen));
+    children.add(parseAssignmentExpression());
+    p.expect(punctuator(Punctuator::Comma));
+    children.add(parseGenericAssocList());
+    p.expect(punctuator(Punctuator::RightParen));
+    return p.node(Rule::GenericSelection, 0, children);
+}
+
+
+ParseNode *CParser::Rules::parseGenericAssocList()
+{
+    DepthGuard depth(p);
+    ParseNode *node = parseGenericAssociation();
+    for (;;)
+    {
+        Children children(node);
+        switch (p.la(0))
+        {
+        case punctuator(Punctuator::Comma):
+            p.advance();
+            children.add(parseGenericAssociation());
+            node = p.node(Rule::GenericAssocList, 1, children);
+            continue;
+
+        default:
+            return node;
+        }
+    }
+}
+
+
+ParseNode *CParser::Rules::parseGenericAssociation()
+{
+    DepthGuard depth(p);
+    Children children(p.position());
+    switch (p.la(0))
+    {
+    case TypedefName:
+    case keyword(Keyword::Void):
+    case keyword(Keyword::Char):
+    case keyword(Keyword::Short):
+    case keyword(Keyword::Int):
+    case keyword(Keyword::Long):
+    case keyword(Keyword::Float):
+    case keyword(Keyword::Double):
+    case keyword(Keyword::Signed):
+    case keyword(Keyword::Unsigned):
+    case keyword(Keyword::Bool):
+    case keyword(Keyword::Complex):
+    case keyword(Keyword::Struct):
+    case keyword(Keyword::Union):
+    case keyword(Keyword::Enum):
+    case keyword(Keyword::Atomic):
+    case keyword(Keyword::Const):
+    case keyword(Keyword::Restrict):
+    case keyword(Keyword::Volatile):
+        children.add(parseTypeName());
+        p.expect(punctuator(Punctuator::Colon));
+        children.add(parseAssignmentExpression());
+        return p.node(Rule::GenericAssociation, 0, children);
+
+    case keyword(Keyword::Default):
+        p.advance();
+        p.expect(punctuator(Punctuator::Colon));
+        children.add(parseAssignmentExpression());
+        return p.node(Rule::GenericAssociation, 1, children);
+
+    default:
+        p.unexpected(Rule::GenericAssociation);
+    }
+}
+
+
+ParseNode *CParser::Rules::parsePostfixExpression()
+{
+    DepthGuard depth(p);
+    ParseNode *node = parsePrimaryExpression();
+    for (;;)
+    {
+        Children children(node);
+        switch (p.la(0))
+        {
+        case punctuator(Punctuator::LeftBracket):
+            p.advance();
+            children.add(parseExpression());
+            p.expect(punctuator(Punctuator::RightBracket));
+            node = p.node(Rule::PostfixExpression, 1, children);
+            continue;
+
+        case punctuator(Punctuator::LeftParen):
+            p.advance();
+            switch (p.la(0))
+            {
+            case Identifier:
+            case TypedefName:
+            case Constant:
+            case StringLiteral:
+            case punctuator(Punctuator::LeftParen):
+            case keyword(Keyword::Generic):
+            case punctuator(Punctuator::PlusPlus):
+            case punctuator(Punctuator::MinusMinus):
+            case keyword(Keyword::Sizeof):
+            case keyword(Keyword::Alignof):
+            case punctuator(Punctuator::Amp):
+            case punctuator(Punctuator::Star):
+            case punctuator(Punctuator::Plus):
+            case punctuator(Punctuator::Minus):
+            case punctuator(Punctuator::Tilde):
+            case punctuator(Punctuator::Exclaim):
+                children.add(parseArgumentExpressionList());
+                p.expect(punctuator(Punctuator::RightParen));
+                node = p.node(Rule::PostfixExpression, 2, children);
+                continue;
+
+            case punctuator(Punctuator::RightParen):
+                p.advance();
+                node = p.node(Rule::PostfixExpression, 2, children);
+                continue;
+
+            default:
+                p.unexpected(Rule::PostfixExpression);
+            }
+
+        case punctuator(Punctuator::Dot):
+            p.advance();
+            children.add(p.expectLeaf(Rule::Identifier, Identifier));
+            node = p.node(Rule::PostfixExpression, 3, children);
+            continue;
+
+        case punctuator(Punctuator::MinusGreater):
+            p.advance();
+            children.add(p.expectLeaf(Rule::Identifier, Identifier));
+            node = p.node(Rule::PostfixExpression, 4, children);
+            continue;
+
+        case punctuator(Punctuator::PlusPlus):
+            p.advance();
+            node = p.node(Rule::PostfixExpression, 5, children);
+            continue;
+
+        case punctuator(Punctuator::MinusMinus):
+            p.advance();
+            node = p.node(Rule::PostfixExpression, 6, children);
+            continue;
+
+        default:
+            return node;
+        }
+    }
+}
+
+
+ParseNode *CParser::Rules::parseArgumentExpressionList()
+{
+    DepthGuard depth(p);
+    ParseNode *node = parseAssignmentExpression();
+    for (;;)
+    {
+        Children children(node);
+        switch (p.la(0))
+        {
+        case punctuator(Punctuator::Comma):
+            p.advance();
+            children.add(parseAssignmentExpression());
+            node = p.node(Rule::ArgumentExpressionList, 1, children);
+            continue;
+
+        default:
+            return node;
+        }
+    }
+}
+
+
+ParseNode *CParser::Rules::parseUnaryExpression()
+{
+    DepthGuard depth(p);
+    Children children(p.position());
+    switch (p.la(0))
+    {
+    case Identifier:
+    case TypedefName:
+    case Constant:
+    case StringLiteral:
+    case punctuator(Punctuator::LeftParen):
+    case keyword(Keyword::Generic):
+        children.add(parsePostfixExpression());
+        return children.first;
+
+    case punctuator(Punctuator::PlusPlus):
+        p.advance();
+        children.add(parseUnaryExpression());
+        return p.node(Rule::UnaryExpression, 1, children);
+
+    case punctuator(Punctuator::MinusMinus):
+        p.advance();
+        children.add(parseUnaryExpression());
+        return p.node(Rule::UnaryExpression, 2, children);
+
+    case punctuator(Punctuator::Amp):
+    case punctuator(Punctuator::Star):
+    case punctuator(Punctuator::Plus):
+    case punctuator(Punctuator::Minus):
+    case punctuator(Punctuator::Tilde):
+    case punctuator(Punctuator::Exclaim):
+        children.add(parseUnaryOperator());
+        children.add(parseCastExpression());
+        return p.node(Rule::UnaryExpression, 3, children);
+
+    case keyword(Keyword::Sizeof):
+        p.advance();
+        int choice1;
+        switch (p.la(0))
+        {
+        case Identifier:
+        case TypedefName:
+        case Constant:
+        case StringLiteral:
+        case keyword(Keyword::Generic):
+        case punctuator(Punctuator::PlusPlus):
+        case punctuator(Punctuator::MinusMinus):
+        case keyword(Keyword::Sizeof):
+        case keyword(Keyword::Alignof):
+        case punctuator(Punctuator::Amp):
+        case punctuator(Punctuator::Star):
+        case punctuator(Punctuator::Plus):
+        case punctuator(Punctuator::Minus):
+        case punctuator(Punctuator::Tilde):
+        case punctuator(Punctuator::Exclaim):
+            choice1 = 0;
+            break;
+
+        case punctuator(Punctuator::LeftParen):
+            switch (p.la(1))
+            {
+            case Identifier:
+            case Constant:
+            case StringLiteral:
+            case punctuator(Punctuator::LeftParen):
+            case keyword(Keyword::Generic):
+            case punctuator(Punctuator::PlusPlus):
+            case punctuator(Punctuator::MinusMinus):
+            case keyword(Keyword::Sizeof):
+            case keyword(Keyword::Alignof):
+            case punctuator(Punctuator::Amp):
+            case punctuator(Punctuator::Star):
+            case punctuator(Punctuator::Plus):
+            case punctuator(Punctuator::Minus):
+            case punctuator(Punctuator::Tilde):
+            case punctuator(Punctuator::Exclaim):
+                choice1 = 0;
+                break;
+
+            case TypedefName:
+            case keyword(Keyword::Void):
+            case keyword(Keyword::Char):
+            case keyword(Keyword::Short):
+            case keyword(Keyword::Int):
+            case keyword(Keyword::Long):
+            case keyword(Keyword::Float):
+            case keyword(Keyword::Double):
+            case keyword(Keyword::Signed):
+            case keyword(Keyword::Unsigned):
+            case keyword(Keyword::Bool):
+            case keyword(Keyword::Complex):
+            case keyword(Keyword::Struct):
+            case keyword(Keyword::Union):
+            case keyword(Keyword::Enum):
+            case keyword(Keyword::Atomic):
+            case keyword(Keyword::Const):
+            case keyword(Keyword::Restrict):
+            case keyword(Keyword::Volatile):
+                choice1 = 1;
+                break;
+
+            default:
+                p.unexpected(Rule::UnaryExpression);
+            }
+            break;
+
+        default:
+            p.unexpected(Rule::UnaryExpression);
+        }
+
+        switch (choice1)
+        {
+        case 0:
+            children.add(parseUnaryExpression());
+            return p.node(Rule::UnaryExpression, 4, children);
+
+        default:
+            p.advance();
+            children.add(parseTypeName());
+            p.expect(punctuator(Punctuator::RightParen));
+            return p.node(Rule::UnaryExpression, 5, children);
+        }
+
+    case keyword(Keyword::Alignof):
+        p.advance();
+        p.expect(punctuator(Punctuator::LeftParen));
+        children.add(parseTypeName());
+        p.expect(punctuator(Punctuator::RightParen));
+        return p.node(Rule::UnaryExpression, 6, children);
+
+    default:
+        p.unexpected(Rule::UnaryExpression);
+    }
+}
+
+
+ParseNode *CParser::Rules::parseUnaryOperator()
+{
+    DepthGuard depth(p);
+    Children children(p.position());
+    switch (p.la(0))
+    {
+    case punctuator(Punctuator::Amp):
+        p.advance();
+        return p.node(Rule::UnaryOperator, 0, children);
+
+    case punctuator(Punctuator::Star):
+        p.advance();
+        return p.node(Rule::UnaryOperator, 1, children);
+
+    case punctuator(Punctuator::Plus):
+        p.advance();
+        return p.node(Rule::UnaryOperator, 2, children);
+
+    case punctuator(Punctuator::Minus):
+        p.advance();
+        return p.node(Rule::UnaryOperator, 3, children);
+
+    case punctuator(Punctuator::Tilde):
+        p.advance();
+        return p.node(Rule::UnaryOperator, 4, children);
+
+    case punctuator(Punctuator::Exclaim):
+        p.advance();
+        return p.node(Rule::UnaryOperator, 5, children);
+
+    default:
+        p.unexpected(Rule::UnaryOperator);
+    }
+}
+
+
+ParseNode *CParser::Rules::parseCastExpression()
+{
+    DepthGuard depth(p);
+    Children children(p.position());
+    int choice2;
+    switch (p.la(0))
+    {
+    case Identifier:
+    case TypedefName:
+    case Constant:
+    case StringLiteral:
+    case keyword(Keyword::Generic):
+    case punctuator(Punctuator::PlusPlus):
+    case punctuator(Punctuator::MinusMinus):
+    case keyword(Keyword::Sizeof):
+    case keyword(Keyword::Alignof):
+    case punctuator(Punctuator::Amp):
+    case punctuator(Punctuator::Star):
+    case punctuator(Punctuator::Plus):
+    case punctuator(Punctuator::Minus):
+    case punctuator(Punctuator::Tilde):
+    case punctuator(Punctuator::Exclaim):
+        choice2 = 0;
+        break;
+
+    case punctuator(Punctuator::LeftParen):
+        switch (p.la(1))
+        {
+        case Identifier:
+        case Constant:
+        case StringLiteral:
+        case punctuator(Punctuator::LeftParen):
+        case keyword(Keyword::Generic):
+        case punctuator(Punctuator::PlusPlus):
+        case punctuator(Punctuator::MinusMinus):
+        case keyword(Keyword::Sizeof):
+        case keyword(Keyword::Alignof):
+        case punctuator(Punctuator::Amp):
+        case punctuator(Punctuator::Star):
+        case punctuator(Punctuator::Plus):
+        case punctuator(Punctuator::Minus):
+        case punctuator(Punctuator::Tilde):
+        case punctuator(Punctuator::Exclaim):
+            choice2 = 0;
+            break;
+
+        case TypedefName:
+        case keyword(Keyword::Void):
+        case keyword(Keyword::Char):
+        case keyword(Keyword::Short):
+        case keyword(Keyword::Int):
+        case keyword(Keyword::Long):
+        case keyword(Keyword::Float):
+        case keyword(Keyword::Double):
+        case keyword(Keyword::Signed):
+        case keyword(Keyword::Unsigned):
+        case keyword(Keyword::Bool):
+        case keyword(Keyword::Complex):
+        case keyword(Keyword::Struct):
+        case keyword(Keyword::Union):
+        case keyword(Keyword::Enum):
+        case keyword(Keyword::Atomic):
+        case keyword(Keyword::Const):
+        case keyword(Keyword::Restrict):
+        case keyword(Keyword::Volatile):
+            choice2 = 1;
+            break;
+
+        default:
+            p.unexpected(Rule::CastExpression);
+        }
+        break;
+
+    default:
+        p.unexpected(Rule::CastExpression);
+    }
+
+    switch (choice2)
+    {
+    case 0:
+        children.add(parseUnaryExpression());
+        return children.first;
+
+    default:
+        p.advance();
+        children.add(parseTypeName());
+        p.expect(punctuator(Punctuator::RightParen));
+        switch (p.la(0))
+        {
+        case Identifier:
+        case TypedefName:
+        case Constant:
+        case StringLiteral:
+        case punctuator(Punctuator::LeftParen):
+        case keyword(Keyword::Generic):
+        case punctuator(Punctuator::PlusPlus):
+        case punctuator(Punctuator::MinusMinus):
+        case keyword(Keyword::Sizeof):
+        case keyword(Keyword::Alignof):
+        case punctuator(Punctuator::Amp):
+        case punctuator(Punctuator::Star):
+        case punctuator(Punctuator::Plus):
+        case punctuator(Punctuator::Minus):
+        case punctuator(Punctuator::Tilde):
+        case punctuator(Punctuator::Exclaim):
+            children.add(parseCastExpression());
+            return p.node(Rule::CastExpression, 1, children);
+
+        case punctuator(Punctuator::LeftBrace):
+            p.advance();
+            children.add(parseInitializerList());
+            switch (p.la(0))
+            {
+            case punctuator(Punctuator::Comma):
+                p.advance();
+                p.expect(punctuator(Punctuator::RightBrace));
+                return p.node(Rule::CastExpression, 2, children);
+
+            case punctuator(Punctuator::RightBrace):
+                p.advance();
+                return p.node(Rule::CastExpression, 2, children);
+
+            default:
+                p.unexpected(Rule::CastExpression);
+            }
+
+        default:
+            p.unexpected(Rule::CastExpression);
+        }
+    }
+}
+
+
+ParseNode *CParser::Rules::parseMultiplicativeExpression()
+{
+    DepthGuard depth(p);
+    ParseNode *node = parseCastExpression();
+    for (;;)
+    {
+        Children children(node);
+        switch (p.la(0))
+        {
+        case punctuator(Punctuator::Star):
+            p.advance();
+            children.add(parseCastExpression());
+            node = p.node(Rule::MultiplicativeExpression, 1, children);
+            continue;
+
+        case punctuator(Punctuator::Slash):
+            p.advance();
+            children.add(parseCastExpression());
+            node = p.node(Rule::MultiplicativeExpression, 2, children);
+            continue;
+
+        case punctuator(Punctuator::Percent):
+            p.advance();
+            children.add(parseCastExpression());
+            node = p.node(Rule::MultiplicativeExpression, 3, children);
+            continue;
+
+        default:
+            return node;
+        }
+    }
+}
+
+
+ParseNode *CParser::Rules::parseAdditiveExpression()
+{
+    DepthGuard depth(p);
+    ParseNode *node = parseMultiplicativeExpression();
+    for (;;)
+    {
+        Children children(node);
+        switch (p.la(0))
+        {
+        case punctuator(Punctuator::Plus):
+            p.advance();
+            children.add(parseMultiplicativeExpression());
+            node = p.node(Rule::AdditiveExpression, 1, children);
+            continue;
+
+        case punctuator(Punctuator::Minus):
+            p.advance();
+            children.add(parseMultiplicativeExpression());
+            node = p.node(Rule::AdditiveExpression, 2, children);
+            continue;
+
+        default:
+            return node;
+        }
+    }
+}
+
+
+ParseNode *CParser::Rules::parseShiftExpression()
+{
+    DepthGuard depth(p);
+    ParseNode *node = parseAdditiveExpression();
+    for (;;)
+    {
+        Children children(node);
+        switch (p.la(0))
+        {
+        case punctuator(Punctuator::LessLess):
+            p.advance();
+            children.add(parseAdditiveExpression());
+            node = p.node(Rule::ShiftExpression, 1, children);
+            continue;
+
+        case punctuator(Punctuator::GreaterGreater):
+            p.advance();
+            children.add(parseAdditiveExpression());
+            node = p.node(Rule::ShiftExpression, 2, children);
+            continue;
+
+        default:
+            return node;
+        }
+    }
+}
+
+
+ParseNode *CParser::Rules::parseRelationalExpression()
+{
+    DepthGuard depth(p);
+    ParseNode *node = parseShiftExpression();
+    for (;;)
+    {
+        Children children(node);
+        switch (p.la(0))
+        {
+        case punctuator(Punctuator::Less):
+            p.advance();
+            children.add(parseShiftExpression());
+            node = p.node(Rule::RelationalExpression, 1, children);
+            continue;
+
+        case punctuator(Punctuator::Greater):
+            p.advance();
+            children.add(parseShiftExpression());
+            node = p.node(Rule::RelationalExpression, 2, children);
+            continue;
+
+        case punctuator(Punctuator::LessEqual):
+            p.advance();
+            children.add(parseShiftExpression());
+            node = p.node(Rule::RelationalExpression, 3, children);
+            continue;
+
+        case punctuator(Punctuator::GreaterEqual):
+            p.advance();
+            children.add(parseShiftExpression());
+            node = p.node(Rule::RelationalExpression, 4, children);
+            continue;
+
+        default:
+            return node;
+        }
+    }
+}
+
+
+ParseNode *CParser::Rules::parseEqualityExpression()
+{
+    DepthGuard depth(p);
+    ParseNode *node = parseRelationalExpression();
+    for (;;)
+    {
+        Children children(node);
+        switch (p.la(0))
+        {
+        case punctuator(Punctuator::EqualEqual):
+            p.advance();
+            children.add(parseRelationalExpression());
+            node = p.node(Rule::EqualityExpression, 1, children);
+            continue;
+
+        case punctuator(Punctuator::ExclaimEqual):
+            p.advance();
+            children.add(parseRelationalExpression());
+            node = p.node(Rule::EqualityExpression, 2, children);
+            continue;
+
+        default:
+            return node;
+        }
+    }
+}
+
+
+ParseNode *CParser::Rules::parseANDExpression()
+{
+    DepthGuard depth(p);
+    ParseNode *node = parseEqualityExpression();
+    for (;;)
+    {
+        Children children(node);
+        switch (p.la(0))
+        {
+        case punctuator(Punctuator::Amp):
+            p.advance();
+            children.add(parseEqualityExpression());
+            node = p.node(Rule::ANDExpression, 1, children);
+            continue;
+
+        default:
+            return node;
+        }
+    }
+}
+
+
+ParseNode *CParser::Rules::parseExclusiveORExpression()
+{
+    DepthGuard depth(p);
+    ParseNode *node = parseANDExpression();
+    for (;;)
+    {
+        Children children(node);
+        switch (p.la(0))
+        {
+        case punctuator(Punctuator::Caret):
+            p.advance();
+            children.add(parseANDExpression());
+            node = p.node(Rule::ExclusiveORExpression, 1, children);
+            continue;
+
+        default:
+            return node;
+        }
+    }
+}
+
+
+ParseNode *CParser::Rules::parseInclusiveORExpression()
+{
+    DepthGuard depth(p);
+    ParseNode *node = parseExclusiveORExpression();
+    for (;;)
+    {
+        Children children(node);
+        switch (p.la(0))
+        {
+        case punctuator(Punctuator::Pipe):
+            p.advance();
+            children.add(parseExclusiveORExpression());
+            node = p.node(Rule::InclusiveORExpression, 1, children);
+            continue;
+
+        default:
+            return node;
+        }
+    }
+}
+
+
+ParseNode *CParser::Rules::parseLogicalANDExpression()
+{
+    DepthGuard depth(p);
+    ParseNode *node = parseInclusiveORExpression();
+    for (;;)
+    {
+        Children children(node);
+        switch (p.la(0))
+        {
+        case punctuator(Punctuator::AmpAmp):
+            p.advance();
+            children.add(parseInclusiveORExpression());
+            node = p.node(Rule::LogicalANDExpression, 1, children);
+            continue;
+
+        default:
+            return node;
+        }
+    }
+}
+
+
+ParseNode *CParser::Rules::parseLogicalORExpression()
+{
+    DepthGuard depth(p);
+    ParseNode *node = parseLogicalANDExpression();
+    for (;;)
+    {
+        Children children(node);
+        switch (p.la(0))
+        {
+        case punctuator(Punctuator::PipePipe):
+            p.advance();
+            children.add(parseLogicalANDExpression());
+            node = p.node(Rule::LogicalORExpression, 1, children);
+            continue;
+
+        default:
+            return node;
+        }
+    }
+}
+
+
+ParseNode *CParser::Rules::parseConditionalExpression()
+{
+    DepthGuard depth(p);
+    Children children(p.position());
+    children.add(parseLogicalORExpression());
+    switch (p.la(0))
+    {
+    case punctuator(Punctuator::Question):
+        p.advance();
+        children.add(parseExpression());
+        p.expect(punctuator(Punctuator::Colon));
+        children.add(parseConditionalExpression());
+        return p.node(Rule::ConditionalExpression, 1, children);
+
+    default:
+        return children.first;
+    }
+}
+
+
+ParseNode *CParser::Rules::parseAssignmentExpression()
+{
+    DepthGuard depth(p);
+    Children children(p.position());
+    children.add(parseConditionalExpression());
+    switch (p.la(0))
+    {
+    case punctuator(Punctuator::Equal):
+    case punctuator(Punctuator::StarEqual):
+    case punctuator(Punctuator::SlashEqual):
+    case punctuator(Punctuator::PercentEqual):
+    case punctuator(Punctuator::PlusEqual):
+    case punctuator(Punctuator::MinusEqual):
+    case punctuator(Punctuator::LessLessEqual):
+    case punctuator(Punctuator::GreaterGreaterEqual):
+    case punctuator(Punctuator::AmpEqual):
+    case punctuator(Punctuator::CaretEqual):
+    case punctuator(Punctuator::PipeEqual):
+        children.add(parseAssignmentOperator());
+        children.add(parseAssignmentExpression());
+        return p.node(Rule::AssignmentExpression, 0, children);
+
+    default:
+        return children.first;
+    }
+}
+
+
+ParseNode *CParser::Rules::parseAssignmentOperator()
+{
+    DepthGuard depth(p);
+    Children children(p.position());
+    switch (p.la(0))
+    {
+    case punctuator(Punctuator::Equal):
+        p.advance();
+        return p.node(Rule::AssignmentOperator, 0, children);
+
+    case punctuator(Punctuator::StarEqual):
+        p.advance();
+        return p.node(Rule::AssignmentOperator, 1, children);
+
+    case punctuator(Punctuator::SlashEqual):
+        p.advance();
+        return p.node(Rule::AssignmentOperator, 2, children);
+
+    case punctuator(Punctuator::PercentEqual):
+        p.advance();
+        return p.node(Rule::AssignmentOperator, 3, children);
+
+    case punctuator(Punctuator::PlusEqual):
+        p.advance();
+        return p.node(Rule::AssignmentOperator, 4, children);
+
+    case punctuator(Punctuator::MinusEqual):
+        p.advance();
+        return p.node(Rule::AssignmentOperator, 5, children);
+
+    case punctuator(Punctuator::LessLessEqual):
+        p.advance();
+        return p.node(Rule::AssignmentOperator, 6, children);
+
+    case punctuator(Punctuator::GreaterGreaterEqual):
+        p.advance();
+        return p.node(Rule::AssignmentOperator, 7, children);
+
+    case punctuator(Punctuator::AmpEqual):
+        p.advance();
+        return p.node(Rule::AssignmentOperator, 8, children);
+
+    case punctuator(Punctuator::CaretEqual):
+        p.advance();
+        return p.node(Rule::AssignmentOperator, 9, children);
+
+    case punctuator(Punctuator::PipeEqual):
+        p.advance();
+        return p.node(Rule::AssignmentOperator, 10, children);
+
+    default:
+        p.unexpected(Rule::AssignmentOperator);
+    }
+}
+
+
+ParseNode *CParser::Rules::parseExpression()
+{
+    DepthGuard depth(p);
+    ParseNode *node = parseAssignmentExpression();
+    for (;;)
+    {
+        Children children(node);
+        switch (p.la(0))
+        {
+        case punctuator(Punctuator::Comma):
+            p.advance();
+            children.add(parseAssignmentExpression());
+            node = p.node(Rule::Expression, 1, children);
+            continue;
+
+        default:
+            return node;
+        }
+    }
+}
+
+
+ParseNode *CParser::Rules::parseConstantExpression()
+{
+    DepthGuard depth(p);
+    Children children(p.position());
+    children.add(parseConditionalExpression());
+    return children.first;
+}
+
+
+ParseNode *CParser::Rules::parseDeclaration()
+{
+    DepthGuard depth(p);
+    Children children(p.position());
+    switch (p.la(0))
+    {
+    case TypedefName:
+    case keyword(Keyword::Typedef):
+    case keyword(Keyword::Extern):
+    case keyword(Keyword::Static):
+    case keyword(Keyword::ThreadLocal):
+    case keyword(Keyword::Auto):
+    case keyword(Keyword::Register):
+    case keyword(Keyword::Void):
+    case keyword(Keyword::Char):
+    case keyword(Keyword::Short):
+    case keyword(Keyword::Int):
+    case keyword(Keyword::Long):
+    case keyword(Keyword::Float):
+    case keyword(Keyword::Double):
+    case keyword(Keyword::Signed):
+    case keyword(Keyword::Unsigned):
+    case keyword(Keyword::Bool):
+    case keyword(Keyword::Complex):
+    case keyword(Keyword::Struct):
+    case keyword(Keyword::Union):
+    case keyword(Keyword::Enum):
+    case keyword(Keyword::Atomic):
+    case keyword(Keyword::Const):
+    case keyword(Keyword::Restrict):
+    case keyword(Keyword::Volatile):
+    case keyword(Keyword::Inline):
+    case keyword(Keyword::Noreturn):
+    case keyword(Keyword::Alignas):
+        children.add(parseDeclarationSpecifiers());
+        switch (p.la(0))
+        {
+        case Identifier:
+        case TypedefName:
+        case punctuator(Punctuator::LeftParen):
+        case punctuator(Punctuator::Star):
+            children.add(parseInitDeclaratorList());
+            p.expect(punctuator(Punctuator::Semi));
+            return p.declared(p.node(Rule::Declaration, 0, children));
+
+        case punctuator(Punctuator::Semi):
+            p.advance();
+            return p.declared(p.node(Rule::Declaration, 0, children));
+
+        default:
+            p.unexpected(Rule::Declaration);
+        }
+
+    case keyword(Keyword::StaticAssert):
+        children.add(parseStaticAssertDeclaration());
+        return p.declared(children.first);
+
+    default:
+        p.unexpected(Rule::Declaration);
+    }
+}
+
+
+ParseNode *CParser::Rules::parseDeclarationSpecifiers()
+{
+    DepthGuard depth(p);
+    Children children(p.position());
+    int choice3;
+    switch (p.la(0))
+    {
+    case keyword(Keyword::Typedef):
+    case keyword(Keyword::Extern):
+    case keyword(Keyword::Static):
+    case keyword(Keyword::ThreadLocal):
+    case keyword(Keyword::Auto):
+    case keyword(Keyword::Register):
+        choice3 = 0;
+        break;
+
+    case TypedefName:
+    case keyword(Keyword::Void):
+    case keyword(Keyword::Char):
+    case keyword(Keyword::Short):
+    case keyword(Keyword::Int):
+    case keyword(Keyword::Long):
+    case keyword(Keyword::Float):
+    case keyword(Keyword::Double):
+    case keyword(Keyword::Signed):
+    case keyword(Keyword::Unsigned):
+    case keyword(Keyword::Bool):
+    case keyword(Keyword::Complex):
+    case keyword(Keyword::Struct):
+    case keyword(Keyword::Union):
+    case keyword(Keyword::Enum):
+        choice3 = 1;
+        break;
+
+    case keyword(Keyword::Const):
+    case keyword(Keyword::Restrict):
+    case keyword(Keyword::Volatile):
+        choice3 = 2;
+        break;
+
+    case keyword(Keyword::Inline):
+    case keyword(Keyword::Noreturn):
+        choice3 = 3;
+        break;
+
+    case keyword(Keyword::Alignas):
+        choice3 = 4;
+        break;
+
+    case keyword(Keyword::Atomic):
+        switch (p.la(1))
+        {
+        case punctuator(Punctuator::LeftParen):
+            choice3 = 1;
+            break;
+
+        case Identifier:
+        case TypedefName:
+        case punctuator(Punctuator::RightParen):
+        case punctuator(Punctuator::Comma):
+        case punctuator(Punctuator::LeftBracket):
+        case punctuator(Punctuator::Star):
+        case punctuator(Punctuator::Semi):
+        case keyword(Keyword::Typedef):
+        case keyword(Keyword::Extern):
+        case keyword(Keyword::Static):
+        case keyword(Keyword::ThreadLocal):
+        case keyword(Keyword::Auto):
+        case keyword(Keyword::Register):
+        case keyword(Keyword::Void):
+        case keyword(Keyword::Char):
+        case keyword(Keyword::Short):
+        case keyword(Keyword::Int):
+        case keyword(Keyword::Long):
+        case keyword(Keyword::Float):
+        case keyword(Keyword::Double):
+        case keyword(Keyword::Signed):
+        case keyword(Keyword::Unsigned):
+        case keyword(Keyword::Bool):
+        case keyword(Keyword::Complex):
+        case keyword(Keyword::Struct):
+        case keyword(Keyword::Union):
+        case keyword(Keyword::Enum):
+        case keyword(Keyword::Atomic):
+        case keyword(Keyword::Const):
+        case keyword(Keyword::Restrict):
+        case keyword(Keyword::Volatile):
+        case keyword(Keyword::Inline):
+        case keyword(Keyword::Noreturn):
+        case keyword(Keyword::Alignas):
+            choice3 = 2;
+            break;
+
+        default:
+            p.unexpected(Rule::DeclarationSpecifiers);
+        }
+        break;
+
+    default:
+        p.unexpected(Rule::DeclarationSpecifiers);
+    }
+
+    switch (choice3)
+    {
+    case 0:
+        children.add(parseStorageClassSpecifier());
+        switch (p.la(0))
+        {
+        case TypedefName:
+        case keyword(Keyword::Typedef):
+        case keyword(Keyword::Extern):
+        case keyword(Keyword::Static):
+        case keyword(Keyword::ThreadLocal):
+        case keyword(Keyword::Auto):
+        case keyword(Keyword::Register):
+        case keyword(Keyword::Void):
+        case keyword(Keyword::Char):
+        case keyword(Keyword::Short):
+        case keyword(Keyword::Int):
+        case keyword(Keyword::Long):
+        case keyword(Keyword::Float):
+        case keyword(Keyword::Double):
+        case keyword(Keyword::Signed):
+        case keyword(Keyword::Unsigned):
+        case keyword(Keyword::Bool):
+        case keyword(Keyword::Complex):
+        case keyword(Keyword::Struct):
+        case keyword(Keyword::Union):
+        case keyword(Keyword::Enum):
+        case keyword(Keyword::Atomic):
+        case keyword(Keyword::Const):
+        case keyword(Keyword::Restrict):
+        case keyword(Keyword::Volatile):
+        case keyword(Keyword::Inline):
+        case keyword(Keyword::Noreturn):
+        case keyword(Keyword::Alignas):
+            children.add(parseDeclarationSpecifiers());
+            return p.node(Rule::DeclarationSpecifiers, 0, children);
+
+        default:
+            return children.first;
+        }
+
+    case 1:
+        children.add(parseTypeSpecifier());
+        switch (p.la(0))
+        {
+        case TypedefName:
+        case keyword(Keyword::Typedef):
+        case keyword(Keyword::Extern):
+        case keyword(Keyword::Static):
+        case keyword(Keyword::ThreadLocal):
+        case keyword(Keyword::Auto):
+        case keyword(Keyword::Register):
+        case keyword(Keyword::Void):
+        case keyword(Keyword::Char):
+        case keyword(Keyword::Short):
+        case keyword(Keyword::Int):
+        case keyword(Keyword::Long):
+        case keyword(Keyword::Float):
+        case keyword(Keyword::Double):
+        case keyword(Keyword::Signed):
+        case keyword(Keyword::Unsigned):
+        case keyword(Keyword::Bool):
+        case keyword(Keyword::Complex):
+        case keyword(Keyword::Struct):
+        case keyword(Keyword::Union):
+        case keyword(Keyword::Enum):
+        case keyword(Keyword::Atomic):
+        case keyword(Keyword::Const):
+        case keyword(Keyword::Restrict):
+        case keyword(Keyword::Volatile):
+        case keyword(Keyword::Inline):
+        case keyword(Keyword::Noreturn):
+        case keyword(Keyword::Alignas):
+            children.add(parseDeclarationSpecifiers());
+            return p.node(Rule::DeclarationSpecifiers, 1, children);
+
+        default:
+            return children.first;
+        }
+
+    case 2:
+        children.add(parseTypeQualifier());
+        switch (p.la(0))
+        {
+        case TypedefName:
+        case keyword(Keyword::Typedef):
+        case keyword(Keyword::Extern):
+        case keyword(Keyword::Static):
+        case keyword(Keyword::ThreadLocal):
+        case keyword(Keyword::Auto):
+        case keyword(Keyword::Register):
+        case keyword(Keyword::Void):
+        case keyword(Keyword::Char):
+        case keyword(Keyword::Short):
+        case keyword(Keyword::Int):
+        case keyword(Keyword::Long):
+        case keyword(Keyword::Float):
+        case keyword(Keyword::Double):
+        case keyword(Keyword::Signed):
+        case keyword(Keyword::Unsigned):
+        case keyword(Keyword::Bool):
+        case keyword(Keyword::Complex):
+        case keyword(Keyword::Struct):
+        case keyword(Keyword::Union):
+        case keyword(Keyword::Enum):
+        case keyword(Keyword::Atomic):
+        case keyword(Keyword::Const):
+        case keyword(Keyword::Restrict):
+        case keyword(Keyword::Volatile):
+        case keyword(Keyword::Inline):
+        case keyword(Keyword::Noreturn):
+        case keyword(Keyword::Alignas):
+            children.add(parseDeclarationSpecifiers());
+            return p.node(Rule::DeclarationSpecifiers, 2, children);
+
+        default:
+            return children.first;
+        }
+
+    case 3:
+        children.add(parseFunctionSpecifier());
+        switch (p.la(0))
+        {
+        case TypedefName:
+        case keyword(Keyword::Typedef):
+        case keyword(Keyword::Extern):
+        case keyword(Keyword::Static):
+        case keyword(Keyword::ThreadLocal):
+        case keyword(Keyword::Auto):
+        case keyword(Keyword::Register):
+        case keyword(Keyword::Void):
+        case keyword(Keyword::Char):
+        case keyword(Keyword::Short):
+        case keyword(Keyword::Int):
+        case keyword(Keyword::Long):
+        case keyword(Keyword::Float):
+        case keyword(Keyword::Double):
+        case keyword(Keyword::Signed):
+        case keyword(Keyword::Unsigned):
+        case keyword(Keyword::Bool):
+        case keyword(Keyword::Complex):
+        case keyword(Keyword::Struct):
+        case keyword(Keyword::Union):
+        case keyword(Keyword::Enum):
+        case keyword(Keyword::Atomic):
+        case keyword(Keyword::Const):
+        case keyword(Keyword::Restrict):
+        case keyword(Keyword::Volatile):
+        case keyword(Keyword::Inline):
+        case keyword(Keyword::Noreturn):
+        case keyword(Keyword::Alignas):
+            children.add(parseDeclarationSpecifiers());
+            return p.node(Rule::DeclarationSpecifiers, 3, children);
+
+        default:
+            return children.first;
+        }
+
+    default:
+        children.add(parseAlignmentSpecifier());
+        switch (p.la(0))
+        {
+        case TypedefName:
+        case keyword(Keyword::Typedef):
+        case keyword(Keyword::Extern):
+        case keyword(Keyword::Static):
+        case keyword(Keyword::ThreadLocal):
+        case keyword(Keyword::Auto):
+        case keyword(Keyword::Register):
+        case keyword(Keyword::Void):
+        case keyword(Keyword::Char):
+        case keyword(Keyword::Short):
+        case keyword(Keyword::Int):
+        case keyword(Keyword::Long):
+        case keyword(Keyword::Float):
+        case keyword(Keyword::Double):
+        case keyword(Keyword::Signed):
+        case keyword(Keyword::Unsigned):
+        case keyword(Keyword::Bool):
+        case keyword(Keyword::Complex):
+        case keyword(Keyword::Struct):
+        case keyword(Keyword::Union):
+        case keyword(Keyword::Enum):
+        case keyword(Keyword::Atomic):
+        case keyword(Keyword::Const):
+        case keyword(Keyword::Restrict):
+        case keyword(Keyword::Volatile):
+        case keyword(Keyword::Inline):
+        case keyword(Keyword::Noreturn):
+        case keyword(Keyword::Alignas):
+            children.add(parseDeclarationSpecifiers());
+            return p.node(Rule::DeclarationSpecifiers, 4, children);
+
+        default:
+            return children.first;
+        }
+    }
+}
+
+
+ParseNode *CParser::Rules::parseInitDeclaratorList()
+{
+    DepthGuard depth(p);
+    ParseNode *node = parseInitDeclarator();
+    for (;;)
+    {
+        Children children(node);
+        switch (p.la(0))
+        {
+        case punctuator(Punctuator::Comma):
+            p.advance();
+            children.add(parseInitDeclarator());
+            node = p.node(Rule::InitDeclaratorList, 1, children);
+            continue;
+
+        default:
+            return node;
+        }
+    }
+}
+
+
+ParseNode *CParser::Rules::parseInitDeclarator()
+{
+    DepthGuard depth(p);
+    Children children(p.position());
+    children.add(parseDeclarator());
+    switch (p.la(0))
+    {
+    case punctuator(Punctuator::Equal):
+        p.advance();
+        children.add(parseInitializer());
+        return p.node(Rule::InitDeclarator, 1, children);
+
+    default:
+        return children.first;
+    }
+}
+
+
+ParseNode *CParser::Rules::parseStorageClassSpecifier()
+{
+    DepthGuard depth(p);
+    Children children(p.position());
+    switch (p.la(0))
+    {
+    case keyword(Keyword::Typedef):
+        p.advance();
+        return p.node(Rule::StorageClassSpecifier, 0, children);
+
+    case keyword(Keyword::Extern):
+        p.advance();
+        return p.node(Rule::StorageClassSpecifier, 1, children);
+
+    case keyword(Keyword::Static):
+        p.advance();
+        return p.node(Rule::StorageClassSpecifier, 2, children);
+
+    case keyword(Keyword::ThreadLocal):
+        p.advance();
+        return p.node(Rule::StorageClassSpecifier, 3, children);
+
+    case keyword(Keyword::Auto):
+        p.advance();
+        return p.node(Rule::StorageClassSpecifier, 4, children);
+
+    case keyword(Keyword::Register):
+        p.advance();
+        return p.node(Rule::StorageClassSpecifier, 5, children);
+
+    default:
+        p.unexpected(Rule::StorageClassSpecifier);
+    }
+}
+
+
+ParseNode *CParser::Rules::parseTypeSpecifier()
+{
+    DepthGuard depth(p);
+    Children children(p.position());
+    switch (p.la(0))
+    {
+    case keyword(Keyword::Void):
+        p.advance();
+        return p.node(Rule::TypeSpecifier, 0, children);
+
+    case keyword(Keyword::Char):
+        p.advance();
+        return p.node(Rule::TypeSpecifier, 1, children);
+
+    case keyword(Keyword::Short):
+        p.advance();
+        return p.node(Rule::TypeSpecifier, 2, children);
+
+    case keyword(Keyword::Int):
+        p.advance();
+        return p.node(Rule::TypeSpecifier, 3, children);
+
+    case keyword(Keyword::Long):
+        p.advance();
+        return p.node(Rule::TypeSpecifier, 4, children);
+
+    case keyword(Keyword::Float):
+        p.advance();
+        return p.node(Rule::TypeSpecifier, 5, children);
+
+    case keyword(Keyword::Double):
+        p.advance();
+        return p.node(Rule::TypeSpecifier, 6, children);
+
+    case keyword(Keyword::Signed):
+        p.advance();
+        return p.node(Rule::TypeSpecifier, 7, children);
+
+    case keyword(Keyword::Unsigned):
+        p.advance();
+        return p.node(Rule::TypeSpecifier, 8, children);
+
+    case keyword(Keyword::Bool):
+        p.advance();
+        return p.node(Rule::TypeSpecifier, 9, children);
+
+    case keyword(Keyword::Complex):
+        p.advance();
+        return p.node(Rule::TypeSpecifier, 10, children);
+
+    case keyword(Keyword::Atomic):
+        children.add(parseAtomicTypeSpecifier());
+        return children.first;
+
+    case keyword(Keyword::Struct):
+    case keyword(Keyword::Union):
+        children.add(parseStructOrUnionSpecifier());
+        return children.first;
+
+    case keyword(Keyword::Enum):
+        children.add(parseEnumSpecifier());
+        return children.first;
+
+    case TypedefName:
+        children.add(p.leaf(Rule::TypedefName));
+        return children.first;
+
+    default:
+        p.unexpected(Rule::TypeSpecifier);
+    }
+}
+
+
+ParseNode *CParser::Rules::parseStructOrUnionSpecifier()
+{
+    DepthGuard depth(p);
+    Children children(p.position());
+    children.add(parseStructOrUnion());
+    switch (p.la(0))
+    {
+    case Identifier:
+    case TypedefName:
+        children.add(p.leaf(Rule::Identifier));
+        switch (p.la(0))
+        {
+        case punctuator(Punctuator::LeftBrace):
+            p.advance();
+            children.add(parseStructDeclarationList());
+            p.expect(punctuator(Punctuator::RightBrace));
+            return p.node(Rule::StructOrUnionSpecifier, 0, children);
+
+        default:
+            return p.node(Rule::StructOrUnionSpecifier, 1, children);
+        }
+
+    case punctuator(Punctuator::LeftBrace):
+        p.advance();
+        children.add(parseStructDeclarationList());
+        p.expect(punctuator(Punctuator::RightBrace));
+        return p.node(Rule::StructOrUnionSpecifier, 0, children);
+
+    default:
+        p.unexpected(Rule::StructOrUnionSpecifier);
+    }
+}
+
+
+ParseNode *CParser::Rules::parseStructOrUnion()
+{
+    DepthGuard depth(p);
+    Children children(p.position());
+    switch (p.la(0))
+    {
+    case keyword(Keyword::Struct):
+        p.advance();
+        return p.node(Rule::StructOrUnion, 0, children);
+
+    case keyword(Keyword::Union):
+        p.advance();
+        return p.node(Rule::StructOrUnion, 1, children);
+
+    default:
+        p.unexpected(Rule::StructOrUnion);
+    }
+}
+
+
+ParseNode *CParser::Rules::parseStructDeclarationList()
+{
+    DepthGuard depth(p);
+    ParseNode *node = parseStructDeclaration();
+    for (;;)
+    {
+        Children children(node);
+        switch (p.la(0))
+        {
+        case TypedefName:
+        case keyword(Keyword::Void):
+        case keyword(Keyword::Char):
+        case keyword(Keyword::Short):
+        case keyword(Keyword::Int):
+        case keyword(Keyword::Long):
+        case keyword(Keyword::Float):
+        case keyword(Keyword::Double):
+        case keyword(Keyword::Signed):
+        case keyword(Keyword::Unsigned):
+        case keyword(Keyword::Bool):
+        case keyword(Keyword::Complex):
+        case keyword(Keyword::Struct):
+        case keyword(Keyword::Union):
+        case keyword(Keyword::Enum):
+        case keyword(Keyword::Atomic):
+        case keyword(Keyword::Const):
+        case keyword(Keyword::Restrict):
+        case keyword(Keyword::Volatile):
+        case keyword(Keyword::StaticAssert):
+            children.add(parseStructDeclaration());
+            node = p.node(Rule::StructDeclarationList, 1, children);
+            continue;
+
+        default:
+            return node;
+        }
+    }
+}
+
+
+ParseNode *CParser::Rules::parseStructDeclaration()
+{
+    DepthGuard depth(p);
+    Children children(p.position());
+    switch (p.la(0))
+    {
+    case TypedefName:
+    case keyword(Keyword::Void):
+    case keyword(Keyword::Char):
+    case keyword(Keyword::Short):
+    case keyword(Keyword::Int):
+    case keyword(Keyword::Long):
+    case keyword(Keyword::Float):
+    case keyword(Keyword::Double):
+    case keyword(Keyword::Signed):
+    case keyword(Keyword::Unsigned):
+    case keyword(Keyword::Bool):
+    case keyword(Keyword::Complex):
+    case keyword(Keyword::Struct):
+    case keyword(Keyword::Union):
+    case keyword(Keyword::Enum):
+    case keyword(Keyword::Atomic):
+    case keyword(Keyword::Const):
+    case keyword(Keyword::Restrict):
+    case keyword(Keyword::Volatile):
+        children.add(parseSpecifierQualifierList());
+        switch (p.la(0))
+        {
+        case Identifier:
+        case TypedefName:
+        case punctuator(Punctuator::LeftParen):
+        case punctuator(Punctuator::Colon):
+        case punctuator(Punctuator::Star):
+            children.add(parseStructDeclaratorList());
+            p.expect(punctuator(Punctuator::Semi));
+            return p.node(Rule::StructDeclaration, 0, children);
+
+        case punctuator(Punctuator::Semi):
+            p.advance();
+            return p.node(Rule::StructDeclaration, 0, children);
+
+        default:
+            p.unexpected(Rule::StructDeclaration);
+        }
+
+    case keyword(Keyword::StaticAssert):
+        children.add(parseStaticAssertDeclaration());
+        return children.first;
+
+    default:
+        p.unexpected(Rule::StructDeclaration);
+    }
+}
+
+
+ParseNode *CParser::Rules::parseSpecifierQualifierList()
+{
+    DepthGuard depth(p);
+    Children children(p.position());
+    int choice4;
+    switch (p.la(0))
+    {
+    case TypedefName:
+    case keyword(Keyword::Void):
+    case keyword(Keyword::Char):
+    case keyword(Keyword::Short):
+    case keyword(Keyword::Int):
+    case keyword(Keyword::Long):
+    case keyword(Keyword::Float):
+    case keyword(Keyword::Double):
+    case keyword(Keyword::Signed):
+    case keyword(Keyword::Unsigned):
+    case keyword(Keyword::Bool):
+    case keyword(Keyword::Complex):
+    case keyword(Keyword::Struct):
+    case keyword(Keyword::Union):
+    case keyword(Keyword::Enum):
+        choice4 = 0;
+        break;
+
+    case keyword(Keyword::Const):
+    case keyword(Keyword::Restrict):
+    case keyword(Keyword::Volatile):
+        choice4 = 1;
+        break;
+
+    case keyword(Keyword::Atomic):
+        switch (p.la(1))
+        {
+        case punctuator(Punctuator::LeftParen):
+            choice4 = 0;
+            break;
+
+        case Identifier:
+        case TypedefName:
+        case punctuator(Punctuator::RightParen):
+        case punctuator(Punctuator::Colon):
+        case punctuator(Punctuator::LeftBracket):
+        case punctuator(Punctuator::Star):
+        case punctuator(Punctuator::Semi):
+        case keyword(Keyword::Void):
+        case keyword(Keyword::Char):
+        case keyword(Keyword::Short):
+        case keyword(Keyword::Int):
+        case keyword(Keyword::Long):
+        case keyword(Keyword::Float):
+        case keyword(Keyword::Double):
+        case keyword(Keyword::Signed):
+        case keyword(Keyword::Unsigned):
+        case keyword(Keyword::Bool):
+        case keyword(Keyword::Complex):
+        case keyword(Keyword::Struct):
+        case keyword(Keyword::Union):
+        case keyword(Keyword::Enum):
+        case keyword(Keyword::Atomic):
+        case keyword(Keyword::Const):
+        case keyword(Keyword::Restrict):
+        case keyword(Keyword::Volatile):
+            choice4 = 1;
+            break;
+
+        default:
+            p.unexpected(Rule::SpecifierQualifierList);
+        }
+        break;
+
+    default:
+        p.unexpected(Rule::SpecifierQualifierList);
+    }
+
+    switch (choice4)
+    {
+    case 0:
+        children.add(parseTypeSpecifier());
+        switch (p.la(0))
+        {
+        case TypedefName:
+        case keyword(Keyword::Void):
+        case keyword(Keyword::Char):
+        case keyword(Keyword::Short):
+        case keyword(Keyword::Int):
+        case keyword(Keyword::Long):
+        case keyword(Keyword::Float):
+        case keyword(Keyword::Double):
+        case keyword(Keyword::Signed):
+        case keyword(Keyword::Unsigned):
+        case keyword(Keyword::Bool):
+        case keyword(Keyword::Complex):
+        case keyword(Keyword::Struct):
+        case keyword(Keyword::Union):
+        case keyword(Keyword::Enum):
+        case keyword(Keyword::Atomic):
+        case keyword(Keyword::Const):
+        case keyword(Keyword::Restrict):
+        case keyword(Keyword::Volatile):
+            children.add(parseSpecifierQualifierList());
+            return p.node(Rule::SpecifierQualifierList, 0, children);
+
+        default:
+            return children.first;
+        }
+
+    default:
+        children.add(parseTypeQualifier());
+        switch (p.la(0))
+        {
+        case TypedefName:
+        case keyword(Keyword::Void):
+        case keyword(Keyword::Char):
+        case keyword(Keyword::Short):
+        case keyword(Keyword::Int):
+        case keyword(Keyword::Long):
+        case keyword(Keyword::Float):
+        case keyword(Keyword::Double):
+        case keyword(Keyword::Signed):
+        case keyword(Keyword::Unsigned):
+        case keyword(Keyword::Bool):
+        case keyword(Keyword::Complex):
+        case keyword(Keyword::Struct):
+        case keyword(Keyword::Union):
+        case keyword(Keyword::Enum):
+        case keyword(Keyword::Atomic):
+        case keyword(Keyword::Const):
+        case keyword(Keyword::Restrict):
+        case keyword(Keyword::Volatile):
+            children.add(parseSpecifierQualifierList());
+            return p.node(Rule::SpecifierQualifierList, 1, children);
+
+        default:
+            return children.first;
+        }
+    }
+}
+
+
+ParseNode *CParser::Rules::parseStructDeclaratorList()
+{
+    DepthGuard depth(p);
+    ParseNode *node = parseStructDeclarator();
+    for (;;)
+    {
+        Children children(node);
+        switch (p.la(0))
+        {
+        case punctuator(Punctuator::Comma):
+            p.advance();
+            children.add(parseStructDeclarator());
+            node = p.node(Rule::StructDeclaratorList, 1, children);
+            continue;
+
+        default:
+            return node;
+        }
+    }
+}
+
+
+ParseNode *CParser::Rules::parseStructDeclarator()
+{
+    DepthGuard depth(p);
+    Children children(p.position());
+    switch (p.la(0))
+    {
+    case Identifier:
+    case TypedefName:
+    case punctuator(Punctuator::LeftParen):
+    case punctuator(Punctuator::Star):
+        children.add(parseDeclarator());
+        switch (p.la(0))
+        {
+        case punctuator(Punctuator::Colon):
+            p.advance();
+            children.add(parseConstantExpression());
+            return p.node(Rule::StructDeclarator, 1, children);
+
+        default:
+            return children.first;
+        }
+
+    case punctuator(Punctuator::Colon):
+        p.advance();
+        children.add(parseConstantExpression());
+        return p.node(Rule::StructDeclarator, 1, children);
+
+    default:
+        p.unexpected(Rule::StructDeclarator);
+    }
+}
+
+
+ParseNode *CParser::Rules::parseEnumSpecifier()
+{
+    DepthGuard depth(p);
+    Children children(p.position());
+    p.expect(keyword(Keyword::Enum));
+    switch (p.la(0))
+    {
+    case Identifier:
+    case TypedefName:
+        children.add(p.leaf(Rule::Identifier));
+        switch (p.la(0))
+        {
+        case punctuator(Punctuator::LeftBrace):
+            p.advance();
+            children.add(parseEnumeratorList());
+            switch (p.la(0))
+            {
+            case punctuator(Punctuator::RightBrace):
+                p.advance();
+                return p.node(Rule::EnumSpecifier, 0, children);
+
+            case punctuator(Punctuator::Comma):
+                p.advance();
+                p.expect(punctuator(Punctuator::RightBrace));
+                return p.node(Rule::EnumSpecifier, 1, children);
+
+            default:
+                p.unexpected(Rule::EnumSpecifier);
+            }
+
+        default:
+            return p.node(Rule::EnumSpecifier, 2, children);
+        }
+
+    case punctuator(Punctuator::LeftBrace):
+        p.advance();
+        children.add(parseEnumeratorList());
+        switch (p.la(0))
+        {
+        case punctuator(Punctuator::RightBrace):
+            p.advance();
+            return p.node(Rule::EnumSpecifier, 0, children);
+
+        case punctuator(Punctuator::Comma):
+            p.advance();
+            p.expect(punctuator(Punctuator::RightBrace));
+            return p.node(Rule::EnumSpecifier, 1, children);
+
+        default:
+            p.unexpected(Rule::EnumSpecifier);
+        }
+
+    default:
+        p.unexpected(Rule::EnumSpecifier);
+    }
+}
+
+
+ParseNode *CParser::Rules::parseEnumeratorList()
+{
+    DepthGuard depth(p);
+    ParseNode *node = parseEnumerator();
+    for (;;)
+    {
+        Children children(node);
+        int choice5;
+        switch (p.la(0))
+        {
+        case punctuator(Punctuator::Comma):
+            switch (p.la(1))
+            {
+            case Identifier:
+            case TypedefName:
+                choice5 = 0;
+                break;
+
+            default:
+                choice5 = 1;
+                break;
+            }
+            break;
+
+        default:
+            choice5 = 1;
+            break;
+        }
+
+        switch (choice5)
+        {
+        case 0:
+            p.advance();
+            children.add(parseEnumerator());
+            node = p.node(Rule::EnumeratorList, 1, children);
+            continue;
+
+        default:
+            return node;
+        }
+    }
+}
+
+
+ParseNode *CParser::Rules::parseEnumerator()
+{
+    DepthGuard depth(p);
+    Children children(p.position());
+    children.add(p.expectLeaf(Rule::Identifier, Identifier));
+    switch (p.la(0))
+    {
+    case punctuator(Punctuator::Equal):
+        p.advance();
+        children.add(parseConstantExpression());
+        return p.node(Rule::Enumerator, 1, children);
+
+    default:
+        return children.first;
+    }
+}
+
+
+ParseNode *CParser::Rules::parseAtomicTypeSpecifier()
+{
+    DepthGuard depth(p);
+    Children children(p.position());
+    p.expect(keyword(Keyword::Atomic));
+    p.expect(punctuator(Punctuator::LeftParen));
+    children.add(parseTypeName());
+    p.expect(punctuator(Punctuator::RightParen));
+    return p.node(Rule::AtomicTypeSpecifier, 0, children);
+}
+
+
+ParseNode *CParser::Rules::parseTypeQualifier()
+{
+    DepthGuard depth(p);
+    Children children(p.position());
+    switch (p.la(0))
+    {
+    case keyword(Keyword::Const):
+        p.advance();
+        return p.node(Rule::TypeQualifier, 0, children);
+
+    case keyword(Keyword::Restrict):
+        p.advance();
+        return p.node(Rule::TypeQualifier, 1, children);
+
+    case keyword(Keyword::Volatile):
+        p.advance();
+        return p.node(Rule::TypeQualifier, 2, children);
+
+    case keyword(Keyword::Atomic):
+        p.advance();
+        return p.node(Rule::TypeQualifier, 3, children);
+
+    default:
+        p.unexpected(Rule::TypeQualifier);
+    }
+}
+
+
+ParseNode *CParser::Rules::parseFunctionSpecifier()
+{
+    DepthGuard depth(p);
+    Children children(p.position());
+    switch (p.la(0))
+    {
+    case keyword(Keyword::Inline):
+        p.advance();
+        return p.node(Rule::FunctionSpecifier, 0, children);
+
+    case keyword(Keyword::Noreturn):
+        p.advance();
+        return p.node(Rule::FunctionSpecifier, 1, children);
+
+    default:
+        p.unexpected(Rule::FunctionSpecifier);
+    }
+}
+
+
+ParseNode *CParser::Rules::parseAlignmentSpecifier()
+{
+    DepthGuard depth(p);
+    Children children(p.position());
+    p.expect(keyword(Keyword::Alignas));
+    p.expect(punctuator(Punctuator::LeftParen));
+    int choice6;
+    switch (p.la(0))
+    {
+    case keyword(Keyword::Void):
+    case keyword(Keyword::Char):
+    case keyword(Keyword::Short):
+    case keyword(Keyword::Int):
+    case keyword(Keyword::Long):
+    case keyword(Keyword::Float):
+    case keyword(Keyword::Double):
+    case keyword(Keyword::Signed):
+    case keyword(Keyword::Unsigned):
+    case keyword(Keyword::Bool):
+    case keyword(Keyword::Complex):
+    case keyword(Keyword::Struct):
+    case keyword(Keyword::Union):
+    case keyword(Keyword::Enum):
+    case keyword(Keyword::Atomic):
+    case keyword(Keyword::Const):
+    case keyword(Keyword::Restrict):
+    case keyword(Keyword::Volatile):
+        choice6 = 0;
+        break;
+
+    case Identifier:
+    case Constant:
+    case StringLiteral:
+    case punctuator(Punctuator::LeftParen):
+    case keyword(Keyword::Generic):
+    case punctuator(Punctuator::PlusPlus):
+    case punctuator(Punctuator::MinusMinus):
+    case keyword(Keyword::Sizeof):
+    case keyword(Keyword::Alignof):
+    case punctuator(Punctuator::Amp):
+    case punctuator(Punctuator::Star):
+    case punctuator(Punctuator::Plus):
+    case punctuator(Punctuator::Minus):
+    case punctuator(Punctuator::Tilde):
+    case punctuator(Punctuator::Exclaim):
+        choice6 = 1;
+        break;
+
+    case TypedefName:
+        switch (p.la(1))
+        {
+        case punctuator(Punctuator::Dot):
+        case punctuator(Punctuator::MinusGreater):
+        case punctuator(Punctuator::PlusPlus):
+        case punctuator(Punctuator::MinusMinus):
+        case punctuator(Punctuator::Amp):
+        case punctuator(Punctuator::Plus):
+        case punctuator(Punctuator::Minus):
+        case punctuator(Punctuator::Slash):
+        case punctuator(Punctuator::Percent):
+        case punctuator(Punctuator::LessLess):
+        case punctuator(Punctuator::GreaterGreater):
+        case punctuator(Punctuator::Less):
+        case punctuator(Punctuator::Greater):
+        case punctuator(Punctuator::LessEqual):
+        case punctuator(Punctuator::GreaterEqual):
+        case punctuator(Punctuator::EqualEqual):
+        case punctuator(Punctuator::ExclaimEqual):
+        case punctuator(Punctuator::Caret):
+        case punctuator(Punctuator::Pipe):
+        case punctuator(Punctuator::AmpAmp):
+        case punctuator(Punctuator::PipePipe):
+        case punctuator(Punctuator::Question):
+            choice6 = 1;
+            break;
+
+        default:
+            choice6 = 0;
+            break;
+        }
+        break;
+
+    default:
+        p.unexpected(Rule::AlignmentSpecifier);
+    }
+
+    switch (choice6)
+    {
+    case 0:
+        children.add(parseTypeName());
+        p.expect(punctuator(Punctuator::RightParen));
+        return p.node(Rule::AlignmentSpecifier, 0, children);
+
+    default:
+        children.add(parseConstantExpression());
+        p.expect(punctuator(Punctuator::RightParen));
+        return p.node(Rule::AlignmentSpecifier, 1, children);
+    }
+}
+
+
+ParseNode *CParser::Rules::parseDeclarator()
+{
+    DepthGuard depth(p);
+    Children children(p.position());
+    switch (p.la(0))
+    {
+    case punctuator(Punctuator::Star):
+        children.add(parsePointer());
+        children.add(parseDirectDeclarator());
+        return p.node(Rule::Declarator, 0, children);
+
+    case Identifier:
+    case TypedefName:
+    case punctuator(Punctuator::LeftParen):
+        children.add(parseDirectDeclarator());
+        return children.first;
+
+    default:
+        p.unexpected(Rule::Declarator);
+    }
+}
+
+
+ParseNode *CParser::Rules::parseDirectDeclaratorHead()
+{
+    DepthGuard depth(p);
+    Children children(p.position());
+    switch (p.la(0))
+    {
+    case Identifier:
+    case TypedefName:
+        children.add(p.leaf(Rule::Identifier));
+        return children.first;
+
+    case punctuator(Punctuator::LeftParen):
+        p.advance();
+        children.add(parseDeclarator());
+        p.expect(punctuator(Punctuator::RightParen));
+        return p.node(Rule::DirectDeclarator, 1, children);
+
+    default:
+        p.unexpected(Rule::DirectDeclarator);
+    }
+}
+
+
+ParseNode *CParser::Rules::parseDirectDeclarator()
+{
+    DepthGuard depth(p);
+    ParseNode *node = parseDirectDeclaratorHead();
+    for (;;)
+    {
+        Children children(node);
+        switch (p.la(0))
+        {
+        case punctuator(Punctuator::LeftBracket):
+            p.advance();
+            int choice7;
+            switch (p.la(0))
+            {
+            case keyword(Keyword::Atomic):
+            case keyword(Keyword::Const):
+            case keyword(Keyword::Restrict):
+            case keyword(Keyword::Volatile):
+                choice7 = 0;
+                break;
+
+            case Identifier:
+            case TypedefName:
+            case Constant:
+            case StringLiteral:
+            case punctuator(Punctuator::LeftParen):
+            case keyword(Keyword::Generic):
+            case punctuator(Punctuator::PlusPlus):
+            case punctuator(Punctuator::MinusMinus):
+            case keyword(Keyword::Sizeof):
+            case keyword(Keyword::Alignof):
+            case punctuator(Punctuator::Amp):
+            case punctuator(Punctuator::Plus):
+            case punctuator(Punctuator::Minus):
+            case punctuator(Punctuator::Tilde):
+            case punctuator(Punctuator::Exclaim):
+                choice7 = 1;
+                break;
+
+            case punctuator(Punctuator::RightBracket):
+                choice7 = 2;
+                break;
+
+            case keyword(Keyword::Static):
+                choice7 = 3;
+                break;
+
+            case punctuator(Punctuator::Star):
+                switch (p.la(1))
+                {
+                case Identifier:
+                case TypedefName:
+                case Constant:
+                case StringLiteral:
+                case punctuator(Punctuator::LeftParen):
+                case keyword(Keyword::Generic):
+                case punctuator(Punctuator::PlusPlus):
+                case punctuator(Punctuator::MinusMinus):
+                case keyword(Keyword::Sizeof):
+                case keyword(Keyword::Alignof):
+                case punctuator(Punctuator::Amp):
+                case punctuator(Punctuator::Star):
+                case punctuator(Punctuator::Plus):
+                case punctuator(Punctuator::Minus):
+                case punctuator(Punctuator::Tilde):
+                case punctuator(Punctuator::Exclaim):
+                    choice7 = 1;
+                    break;
+
+                case punctuator(Punctuator::RightBracket):
+                    choice7 = 4;
+                    break;
+
+                default:
+                    p.unexpected(Rule::DirectDeclarator);
+                }
+                break;
+
+            default:
+                p.unexpected(Rule::DirectDeclarator);
+            }
+
+            switch (choice7)
+            {
+            case 0:
+                children.add(parseTypeQualifierList());
+                int choice8;
+                switch (p.la(0))
+                {
+                case Identifier:
+                case TypedefName:
+                case Constant:
+                case StringLiteral:
+                case punctuator(Punctuator::LeftParen):
+                case keyword(Keyword::Generic):
+                case punctuator(Punctuator::PlusPlus):
+                case punctuator(Punctuator::MinusMinus):
+                case keyword(Keyword::Sizeof):
+                case keyword(Keyword::Alignof):
+                case punctuator(Punctuator::Amp):
+                case punctuator(Punctuator::Plus):
+                case punctuator(Punctuator::Minus):
+                case punctuator(Punctuator::Tilde):
+                case punctuator(Punctuator::Exclaim):
+                    choice8 = 0;
+                    break;
+
+                case punctuator(Punctuator::RightBracket):
+                    choice8 = 1;
+                    break;
+
+                case keyword(Keyword::Static):
+                    choice8 = 2;
+                    break;
+
+                case punctuator(Punctuator::Star):
+                    switch (p.la(1))
+                    {
+                    case Identifier:
+                    case TypedefName:
+                    case Constant:
+                    case StringLiteral:
+                    case punctuator(Punctuator::LeftParen):
+                    case keyword(Keyword::Generic):
+                    case punctuator(Punctuator::PlusPlus):
+                    case punctuator(Punctuator::MinusMinus):
+                    case keyword(Keyword::Sizeof):
+                    case keyword(Keyword::Alignof):
+                    case punctuator(Punctuator::Amp):
+                    case punctuator(Punctuator::Star):
+                    case punctuator(Punctuator::Plus):
+                    case punctuator(Punctuator::Minus):
+                    case punctuator(Punctuator::Tilde):
+                    case punctuator(Punctuator::Exclaim):
+                        choice8 = 0;
+                        break;
+
+                    case punctuator(Punctuator::RightBracket):
+                        choice8 = 3;
+                        break;
+
+                    default:
+                        p.unexpected(Rule::DirectDeclarator);
+                    }
+                    break;
+
+                default:
+                    p.unexpected(Rule::DirectDeclarator);
+                }
+
+                switch (choice8)
+                {
+                case 0:
+                    children.add(parseAssignmentExpression());
+                    p.expect(punctuator(Punctuator::RightBracket));
+                    node = p.node(Rule::DirectDeclarator, 2, children);
+                    continue;
+
+                case 1:
+                    p.advance();
+                    node = p.node(Rule::DirectDeclarator, 2, children);
+                    continue;
+
+                case 2:
+                    p.advance();
+                    children.add(parseAssignmentExpression());
+                    p.expect(punctuator(Punctuator::RightBracket));
+                    node = p.node(Rule::DirectDeclarator, 4, children);
+                    continue;
+
+                default:
+                    p.advance();
+                    p.expect(punctuator(Punctuator::RightBracket));
+                    node = p.node(Rule::DirectDeclarator, 5, children);
+                    continue;
+                }
+
+            case 1:
+                children.add(parseAssignmentExpression());
+                p.expect(punctuator(Punctuator::RightBracket));
+                node = p.node(Rule::DirectDeclarator, 2, children);
+                continue;
+
+            case 2:
+                p.advance();
+                node = p.node(Rule::DirectDeclarator, 2, children);
+                continue;
+
+            case 3:
+                p.advance();
+                switch (p.la(0))
+                {
+                case keyword(Keyword::Atomic):
+                case keyword(Keyword::Const):
+                case keyword(Keyword::Restrict):
+                case keyword(Keyword::Volatile):
+                    children.add(parseTypeQualifierList());
+                    children.add(parseAssignmentExpression());
+                    p.expect(punctuator(Punctuator::RightBracket));
+                    node = p.node(Rule::DirectDeclarator, 3, children);
+                    continue;
+
+                case Identifier:
+                case TypedefName:
+                case Constant:
+                case StringLiteral:
+                case punctuator(Punctuator::LeftParen):
+                case keyword(Keyword::Generic):
+                case punctuator(Punctuator::PlusPlus):
+                case punctuator(Punctuator::MinusMinus):
+                case keyword(Keyword::Sizeof):
+                case keyword(Keyword::Alignof):
+                case punctuator(Punctuator::Amp):
+                case punctuator(Punctuator::Star):
+                case punctuator(Punctuator::Plus):
+                case punctuator(Punctuator::Minus):
+                case punctuator(Punctuator::Tilde):
+                case punctuator(Punctuator::Exclaim):
+                    children.add(parseAssignmentExpression());
+                    p.expect(punctuator(Punctuator::RightBracket));
+                    node = p.node(Rule::DirectDeclarator, 3, children);
+                    continue;
+
+                default:
+                    p.unexpected(Rule::DirectDeclarator);
+                }
+
+            default:
+                p.advance();
+                p.expect(punctuator(Punctuator::RightBracket));
+                node = p.node(Rule::DirectDeclarator, 5, children);
+                continue;
+            }
+
+        case punctuator(Punctuator::LeftParen):
+            p.advance();
+            switch (p.la(0))
+            {
+            case TypedefName:
+            case keyword(Keyword::Typedef):
+            case keyword(Keyword::Extern):
+            case keyword(Keyword::Static):
+            case keyword(Keyword::ThreadLocal):
+            case keyword(Keyword::Auto):
+            case keyword(Keyword::Register):
+            case keyword(Keyword::Void):
+            case keyword(Keyword::Char):
+            case keyword(Keyword::Short):
+            case keyword(Keyword::Int):
+            case keyword(Keyword::Long):
+            case keyword(Keyword::Float):
+            case keyword(Keyword::Double):
+            case keyword(Keyword::Signed):
+            case keyword(Keyword::Unsigned):
+            case keyword(Keyword::Bool):
+            case keyword(Keyword::Complex):
+            case keyword(Keyword::Struct):
+            case keyword(Keyword::Union):
+            case keyword(Keyword::Enum):
+            case keyword(Keyword::Atomic):
+            case keyword(Keyword::Const):
+            case keyword(Keyword::Restrict):
+            case keyword(Keyword::Volatile):
+            case keyword(Keyword::Inline):
+            case keyword(Keyword::Noreturn):
+            case keyword(Keyword::Alignas):
+                children.add(parseParameterTypeList());
+                p.expect(punctuator(Punctuator::RightParen));
+                node = p.node(Rule::DirectDeclarator, 6, children);
+                continue;
+
+            case Identifier:
+                children.add(parseIdentifierList());
+                p.expect(punctuator(Punctuator::RightParen));
+                node = p.node(Rule::DirectDeclarator, 7, children);
+                continue;
+
+            case punctuator(Punctuator::RightParen):
+                p.advance();
+                node = p.node(Rule::DirectDeclarator, 7, children);
+                continue;
+
+            default:
+                p.unexpected(Rule::DirectDeclarator);
+            }
+
+        default:
+            return node;
+        }
+    }
+}
+
+
+ParseNode *CParser::Rules::parsePointer()
+{
+    DepthGuard depth(p);
+    Children children(p.position());
+    p.expect(punctuator(Punctuator::Star));
+    switch (p.la(0))
+    {
+    case keyword(Keyword::Atomic):
+    case keyword(Keyword::Const):
+    case keyword(Keyword::Restrict):
+    case keyword(Keyword::Volatile):
+        children.add(parseTypeQualifierList());
+        switch (p.la(0))
+        {
+        case punctuator(Punctuator::Star):
+            children.add(parsePointer());
+            return p.node(Rule::Pointer, 1, children);
+
+        default:
+            return p.node(Rule::Pointer, 0, children);
+        }
+
+    case punctuator(Punctuator::Star):
+        children.add(parsePointer());
+        return p.node(Rule::Pointer, 1, children);
+
+    default:
+        return p.node(Rule::Pointer, 0, children);
+    }
+}
+
+
+ParseNode *CParser::Rules::parseTypeQualifierList()
+{
+    DepthGuard depth(p);
+    ParseNode *node = parseTypeQualifier();
+    for (;;)
+    {
+        Children children(node);
+        switch (p.la(0))
+        {
+        case keyword(Keyword::Atomic):
+        case keyword(Keyword::Const):
+        case keyword(Keyword::Restrict):
+        case keyword(Keyword::Volatile):
+            children.add(parseTypeQualifier());
+            node = p.node(Rule::TypeQualifierList, 1, children);
+            continue;
+
+        default:
+            return node;
+        }
+    }
+}
+
+
+ParseNode *CParser::Rules::parseParameterTypeList()
+{
+    DepthGuard depth(p);
+    Children children(p.position());
+    children.add(parseParameterList());
+    switch (p.la(0))
+    {
+    case punctuator(Punctuator::Comma):
+        p.advance();
+        p.expect(punctuator(Punctuator::DotDotDot));
+        return p.node(Rule::ParameterTypeList, 1, children);
+
+    default:
+        return children.first;
+    }
+}
+
+
+ParseNode *CParser::Rules::parseParameterList()
+{
+    DepthGuard depth(p);
+    ParseNode *node = parseParameterDeclaration();
+    for (;;)
+    {
+        Children children(node);
+        int choice9;
+        switch (p.la(0))
+        {
+        case punctuator(Punctuator::Comma):
+            switch (p.la(1))
+            {
+            case TypedefName:
+            case keyword(Keyword::Typedef):
+            case keyword(Keyword::Extern):
+            case keyword(Keyword::Static):
+            case keyword(Keyword::ThreadLocal):
+            case keyword(Keyword::Auto):
+            case keyword(Keyword::Register):
+            case keyword(Keyword::Void):
+            case keyword(Keyword::Char):
+            case keyword(Keyword::Short):
+            case keyword(Keyword::Int):
+            case keyword(Keyword::Long):
+            case keyword(Keyword::Float):
+            case keyword(Keyword::Double):
+            case keyword(Keyword::Signed):
+            case keyword(Keyword::Unsigned):
+            case keyword(Keyword::Bool):
+            case keyword(Keyword::Complex):
+            case keyword(Keyword::Struct):
+            case keyword(Keyword::Union):
+            case keyword(Keyword::Enum):
+            case keyword(Keyword::Atomic):
+            case keyword(Keyword::Const):
+            case keyword(Keyword::Restrict):
+            case keyword(Keyword::Volatile):
+            case keyword(Keyword::Inline):
+            case keyword(Keyword::Noreturn):
+            case keyword(Keyword::Alignas):
+                choice9 = 0;
+                break;
+
+            default:
+                choice9 = 1;
+                break;
+            }
+            break;
+
+        default:
+            choice9 = 1;
+            break;
+        }
+
+        switch (choice9)
+        {
+        case 0:
+            p.advance();
+            children.add(parseParameterDeclaration());
+            node = p.node(Rule::ParameterList, 1, children);
+            continue;
+
+        default:
+            return node;
+        }
+    }
+}
+
+
+ParseNode *CParser::Rules::parseParameterDeclaration()
+{
+    DepthGuard depth(p);
+    Children children(p.position());
+    children.add(parseDeclarationSpecifiers());
+    switch (p.la(0))
+    {
+    case Identifier:
+    case TypedefName:
+    case punctuator(Punctuator::LeftParen):
+    case punctuator(Punctuator::LeftBracket):
+    case punctuator(Punctuator::Star):
+        children.add(parseParameterDeclarator());
+        return p.node(Rule::ParameterDeclaration, 0, children);
+
+    default:
+        return children.first;
+    }
+}
+
+
+ParseNode *CParser::Rules::parseParameterDeclarator()
+{
+    DepthGuard depth(p);
+    Children children(p.position());
+    switch (p.la(0))
+    {
+    case punctuator(Punctuator::Star):
+        children.add(parsePointer());
+        switch (p.la(0))
+        {
+        case Identifier:
+        case TypedefName:
+        case punctuator(Punctuator::LeftParen):
+        case punctuator(Punctuator::LeftBracket):
+            children.add(parseDirectParameterDeclarator());
+            return p.node(Rule::ParameterDeclarator, 0, children);
+
+        default:
+            return children.first;
+        }
+
+    case Identifier:
+    case TypedefName:
+    case punctuator(Punctuator::LeftParen):
+    case punctuator(Punctuator::LeftBracket):
+        children.add(parseDirectParameterDeclarator());
+        return children.first;
+
+    default:
+        p.unexpected(Rule::ParameterDeclarator);
+    }
+}
+
+
+ParseNode *CParser::Rules::parseDirectParameterDeclaratorHead()
+{
+    DepthGuard depth(p);
+    Children children(p.position());
+    switch (p.la(0))
+    {
+    case Identifier:
+    case TypedefName:
+        children.add(p.leaf(Rule::Identifier));
+        return children.first;
+
+    case punctuator(Punctuator::LeftParen):
+        p.advance();
+        switch (p.la(0))
+        {
+        case Identifier:
+        case punctuator(Punctuator::LeftParen):
+        case punctuator(Punctuator::LeftBracket):
+        case punctuator(Punctuator::Star):
+            children.add(parseParameterDeclarator());
+            p.expect(punctuator(Punctuator::RightParen));
+            return p.node(Rule::DirectParameterDeclarator, 1, children);
+
+        case TypedefName:
+        case keyword(Keyword::Typedef):
+        case keyword(Keyword::Extern):
+        case keyword(Keyword::Static):
+        case keyword(Keyword::ThreadLocal):
+        case keyword(Keyword::Auto):
+        case keyword(Keyword::Register):
+        case keyword(Keyword::Void):
+        case keyword(Keyword::Char):
+        case keyword(Keyword::Short):
+        case keyword(Keyword::Int):
+        case keyword(Keyword::Long):
+        case keyword(Keyword::Float):
+        case keyword(Keyword::Double):
+        case keyword(Keyword::Signed):
+        case keyword(Keyword::Unsigned):
+        case keyword(Keyword::Bool):
+        case keyword(Keyword::Complex):
+        case keyword(Keyword::Struct):
+        case keyword(Keyword::Union):
+        case keyword(Keyword::Enum):
+        case keyword(Keyword::Atomic):
+        case keyword(Keyword::Const):
+        case keyword(Keyword::Restrict):
+        case keyword(Keyword::Volatile):
+        case keyword(Keyword::Inline):
+        case keyword(Keyword::Noreturn):
+        case keyword(Keyword::Alignas):
+            children.add(parseParameterTypeList());
+            p.expect(punctuator(Punctuator::RightParen));
+            return p.node(Rule::DirectParameterDeclarator, 6, children);
+
+        case punctuator(Punctuator::RightParen):
+            p.advance();
+            return p.node(Rule::DirectParameterDeclarator, 6, children);
+
+        default:
+            p.unexpected(Rule::DirectParameterDeclarator);
+        }
+
+    case punctuator(Punctuator::LeftBracket):
+        p.advance();
+        int choice10;
+        switch (p.la(0))
+        {
+        case keyword(Keyword::Atomic):
+        case keyword(Keyword::Const):
+        case keyword(Keyword::Restrict):
+        case keyword(Keyword::Volatile):
+            choice10 = 0;
+            break;
+
+        case Identifier:
+        case TypedefName:
+        case Constant:
+        case StringLiteral:
+        case punctuator(Punctuator::LeftParen):
+        case keyword(Keyword::Generic):
+        case punctuator(Punctuator::PlusPlus):
+        case punctuator(Punctuator::MinusMinus):
+        case keyword(Keyword::Sizeof):
+        case keyword(Keyword::Alignof):
+        case punctuator(Punctuator::Amp):
+        case punctuator(Punctuator::Plus):
+        case punctuator(Punctuator::Minus):
+        case punctuator(Punctuator::Tilde):
+        case punctuator(Punctuator::Exclaim):
+            choice10 = 1;
+            break;
+
+        case punctuator(Punctuator::RightBracket):
+            choice10 = 2;
+            break;
+
+        case keyword(Keyword::Static):
+            choice10 = 3;
+            break;
+
+        case punctuator(Punctuator::Star):
+            switch (p.la(1))
+            {
+            case Identifier:
+            case TypedefName:
+            case Constant:
+            case StringLiteral:
+            case punctuator(Punctuator::LeftParen):
+            case keyword(Keyword::Generic):
+            case punctuator(Punctuator::PlusPlus):
+            case punctuator(Punctuator::MinusMinus):
+            case keyword(Keyword::Sizeof):
+            case keyword(Keyword::Alignof):
+            case punctuator(Punctuator::Amp):
+            case punctuator(Punctuator::Star):
+            case punctuator(Punctuator::Plus):
+            case punctuator(Punctuator::Minus):
+            case punctuator(Punctuator::Tilde):
+            case punctuator(Punctuator::Exclaim):
+                choice10 = 1;
+                break;
+
+            case punctuator(Punctuator::RightBracket):
+                choice10 = 4;
+                break;
+
+            default:
+                p.unexpected(Rule::DirectParameterDeclarator);
+            }
+            break;
+
+        default:
+            p.unexpected(Rule::DirectParameterDeclarator);
+        }
+
+        switch (choice10)
+        {
+        case 0:
+            children.add(parseTypeQualifierList());
+            switch (p.la(0))
+            {
+            case Identifier:
+            case TypedefName:
+            case Constant:
+            case StringLiteral:
+            case punctuator(Punctuator::LeftParen):
+            case keyword(Keyword::Generic):
+            case punctuator(Punctuator::PlusPlus):
+            case punctuator(Punctuator::MinusMinus):
+            case keyword(Keyword::Sizeof):
+            case keyword(Keyword::Alignof):
+            case punctuator(Punctuator::Amp):
+            case punctuator(Punctuator::Star):
+            case punctuator(Punctuator::Plus):
+            case punctuator(Punctuator::Minus):
+            case punctuator(Punctuator::Tilde):
+            case punctuator(Punctuator::Exclaim):
+                children.add(parseAssignmentExpression());
+                p.expect(punctuator(Punctuator::RightBracket));
+                return p.node(Rule::DirectParameterDeclarator, 2, children);
+
+            case punctuator(Punctuator::RightBracket):
+                p.advance();
+                return p.node(Rule::DirectParameterDeclarator, 2, children);
+
+            case keyword(Keyword::Static):
+                p.advance();
+                children.add(parseAssignmentExpression());
+                p.expect(punctuator(Punctuator::RightBracket));
+                return p.node(Rule::DirectParameterDeclarator, 4, children);
+
+            default:
+                p.unexpected(Rule::DirectParameterDeclarator);
+            }
+
+        case 1:
+            children.add(parseAssignmentExpression());
+            p.expect(punctuator(Punctuator::RightBracket));
+            return p.node(Rule::DirectParameterDeclarator, 2, children);
+
+        case 2:
+            p.advance();
+            return p.node(Rule::DirectParameterDeclarator, 2, children);
+
+        case 3:
+            p.advance();
+            switch (p.la(0))
+            {
+            case keyword(Keyword::Atomic):
+            case keyword(Keyword::Const):
+            case keyword(Keyword::Restrict):
+            case keyword(Keyword::Volatile):
+                children.add(parseTypeQualifierList());
+                children.add(parseAssignmentExpression());
+                p.expect(punctuator(Punctuator::RightBracket));
+                return p.node(Rule::DirectParameterDeclarator, 3, children);
+
+            case Identifier:
+            case TypedefName:
+            case Constant:
+            case StringLiteral:
+            case punctuator(Punctuator::LeftParen):
+            case keyword(Keyword::Generic):
+            case punctuator(Punctuator::PlusPlus):
+            case punctuator(Punctuator::MinusMinus):
+            case keyword(Keyword::Sizeof):
+            case keyword(Keyword::Alignof):
+            case punctuator(Punctuator::Amp):
+            case punctuator(Punctuator::Star):
+            case punctuator(Punctuator::Plus):
+            case punctuator(Punctuator::Minus):
+            case punctuator(Punctuator::Tilde):
+            case punctuator(Punctuator::Exclaim):
+                children.add(parseAssignmentExpression());
+                p.expect(punctuator(Punctuator::RightBracket));
+                return p.node(Rule::DirectParameterDeclarator, 3, children);
+
+            default:
+                p.unexpected(Rule::DirectParameterDeclarator);
+            }
+
+        default:
+            p.advance();
+            p.expect(punctuator(Punctuator::RightBracket));
+            return p.node(Rule::DirectParameterDeclarator, 5, children);
+        }
+
+    default:
+        p.unexpected(Rule::DirectParameterDeclarator);
+    }
+}
+
+
+ParseNode *CParser::Rules::parseDirectParameterDeclarator()
+{
+    DepthGuard depth(p);
+    ParseNode *node = parseDirectParameterDeclaratorHead();
+    for (;;)
+    {
+        Children children(node);
+        switch (p.la(0))
+        {
+        case punctuator(Punctuator::LeftBracket):
+            p.advance();
+            int choice11;
+            switch (p.la(0))
+            {
+            case keyword(Keyword::Atomic):
+            case keyword(Keyword::Const):
+            case keyword(Keyword::Restrict):
+            case keyword(Keyword::Volatile):
+                choice11 = 0;
+                break;
+
+            case Identifier:
+            case TypedefName:
+            case Constant:
+            case StringLiteral:
+            case punctuator(Punctuator::LeftParen):
+            case keyword(Keyword::Generic):
+            case punctuator(Punctuator::PlusPlus):
+            case punctuator(Punctuator::MinusMinus):
+            case keyword(Keyword::Sizeof):
+            case keyword(Keyword::Alignof):
+            case punctuator(Punctuator::Amp):
+            case punctuator(Punctuator::Plus):
+            case punctuator(Punctuator::Minus):
+            case punctuator(Punctuator::Tilde):
+            case punctuator(Punctuator::Exclaim):
+                choice11 = 1;
+                break;
+
+            case punctuator(Punctuator::RightBracket):
+                choice11 = 2;
+                break;
+
+            case keyword(Keyword::Static):
+                choice11 = 3;
+                break;
+
+            case punctuator(Punctuator::Star):
+                switch (p.la(1))
+                {
+                case Identifier:
+                case TypedefName:
+                case Constant:
+                case StringLiteral:
+                case punctuator(Punctuator::LeftParen):
+                case keyword(Keyword::Generic):
+                case punctuator(Punctuator::PlusPlus):
+                case punctuator(Punctuator::MinusMinus):
+                case keyword(Keyword::Sizeof):
+                case keyword(Keyword::Alignof):
+                case punctuator(Punctuator::Amp):
+                case punctuator(Punctuator::Star):
+                case punctuator(Punctuator::Plus):
+                case punctuator(Punctuator::Minus):
+                case punctuator(Punctuator::Tilde):
+                case punctuator(Punctuator::Exclaim):
+                    choice11 = 1;
+                    break;
+
+                case punctuator(Punctuator::RightBracket):
+                    choice11 = 4;
+                    break;
+
+                default:
+                    p.unexpected(Rule::DirectParameterDeclarator);
+                }
+                break;
+
+            default:
+                p.unexpected(Rule::DirectParameterDeclarator);
+            }
+
+            switch (choice11)
+            {
+            case 0:
+                children.add(parseTypeQualifierList());
+                switch (p.la(0))
+                {
+                case Identifier:
+                case TypedefName:
+                case Constant:
+                case StringLiteral:
+                case punctuator(Punctuator::LeftParen):
+                case keyword(Keyword::Generic):
+                case punctuator(Punctuator::PlusPlus):
+                case punctuator(Punctuator::MinusMinus):
+                case keyword(Keyword::Sizeof):
+                case keyword(Keyword::Alignof):
+                case punctuator(Punctuator::Amp):
+                case punctuator(Punctuator::Star):
+                case punctuator(Punctuator::Plus):
+                case punctuator(Punctuator::Minus):
+                case punctuator(Punctuator::Tilde):
+                case punctuator(Punctuator::Exclaim):
+                    children.add(parseAssignmentExpression());
+                    p.expect(punctuator(Punctuator::RightBracket));
+                    node = p.node(Rule::DirectParameterDeclarator, 2, children);
+                    continue;
+
+                case punctuator(Punctuator::RightBracket):
+                    p.advance();
+                    node = p.node(Rule::DirectParameterDeclarator, 2, children);
+                    continue;
+
+                case keyword(Keyword::Static):
+                    p.advance();
+                    children.add(parseAssignmentExpression());
+                    p.expect(punctuator(Punctuator::RightBracket));
+                    node = p.node(Rule::DirectParameterDeclarator, 4, children);
+                    continue;
+
+                default:
+                    p.unexpected(Rule::DirectParameterDeclarator);
+                }
+
+            case 1:
+                children.add(parseAssignmentExpression());
+                p.expect(punctuator(Punctuator::RightBracket));
+                node = p.node(Rule::DirectParameterDeclarator, 2, children);
+                continue;
+
+            case 2:
+                p.advance();
+                node = p.node(Rule::DirectParameterDeclarator, 2, children);
+                continue;
+
+            case 3:
+                p.advance();
+                switch (p.la(0))
+                {
+                case keyword(Keyword::Atomic):
+                case keyword(Keyword::Const):
+                case keyword(Keyword::Restrict):
+                case keyword(Keyword::Volatile):
+                    children.add(parseTypeQualifierList());
+                    children.add(parseAssignmentExpression());
+                    p.expect(punctuator(Punctuator::RightBracket));
+                    node = p.node(Rule::DirectParameterDeclarator, 3, children);
+                    continue;
+
+                case Identifier:
+                case TypedefName:
+                case Constant:
+                case StringLiteral:
+                case punctuator(Punctuator::LeftParen):
+                case keyword(Keyword::Generic):
+                case punctuator(Punctuator::PlusPlus):
+                case punctuator(Punctuator::MinusMinus):
+                case keyword(Keyword::Sizeof):
+                case keyword(Keyword::Alignof):
+                case punctuator(Punctuator::Amp):
+                case punctuator(Punctuator::Star):
+                case punctuator(Punctuator::Plus):
+                case punctuator(Punctuator::Minus):
+                case punctuator(Punctuator::Tilde):
+                case punctuator(Punctuator::Exclaim):
+                    children.add(parseAssignmentExpression());
+                    p.expect(punctuator(Punctuator::RightBracket));
+                    node = p.node(Rule::DirectParameterDeclarator, 3, children);
+                    continue;
+
+                default:
+                    p.unexpected(Rule::DirectParameterDeclarator);
+                }
+
+            default:
+                p.advance();
+                p.expect(punctuator(Punctuator::RightBracket));
+                node = p.node(Rule::DirectParameterDeclarator, 5, children);
+                continue;
+            }
+
+        case punctuator(Punctuator::LeftParen):
+            p.advance();
+            switch (p.la(0))
+            {
+            case TypedefName:
+            case keyword(Keyword::Typedef):
+            case keyword(Keyword::Extern):
+            case keyword(Keyword::Static):
+            case keyword(Keyword::ThreadLocal):
+            case keyword(Keyword::Auto):
+            case keyword(Keyword::Register):
+            case keyword(Keyword::Void):
+            case keyword(Keyword::Char):
+            case keyword(Keyword::Short):
+            case keyword(Keyword::Int):
+            case keyword(Keyword::Long):
+            case keyword(Keyword::Float):
+            case keyword(Keyword::Double):
+            case keyword(Keyword::Signed):
+            case keyword(Keyword::Unsigned):
+            case keyword(Keyword::Bool):
+            case keyword(Keyword::Complex):
+            case keyword(Keyword::Struct):
+            case keyword(Keyword::Union):
+            case keyword(Keyword::Enum):
+            case keyword(Keyword::Atomic):
+            case keyword(Keyword::Const):
+            case keyword(Keyword::Restrict):
+            case keyword(Keyword::Volatile):
+            case keyword(Keyword::Inline):
+            case keyword(Keyword::Noreturn):
+            case keyword(Keyword::Alignas):
+                children.add(parseParameterTypeList());
+                p.expect(punctuator(Punctuator::RightParen));
+                node = p.node(Rule::DirectParameterDeclarator, 6, children);
+                continue;
+
+            case punctuator(Punctuator::RightParen):
+                p.advance();
+                node = p.node(Rule::DirectParameterDeclarator, 6, children);
+                continue;
+
+            case Identifier:
+                children.add(parseIdentifierList());
+                p.expect(punctuator(Punctuator::RightParen));
+                node = p.node(Rule::DirectParameterDeclarator, 7, children);
+                continue;
+
+            default:
+                p.unexpected(Rule::DirectParameterDeclarator);
+            }
+
+        default:
+            return node;
+        }
+    }
+}
+
+
+ParseNode *CParser::Rules::parseIdentifierList()
+{
+    DepthGuard depth(p);
+    ParseNode *node = p.expectLeaf(Rule::Identifier, Identifier);
+    for (;;)
+    {
+        Children children(node);
+        switch (p.la(0))
+        {
+        case punctuator(Punctuator::Comma):
+            p.advance();
+            children.add(p.expectLeaf(Rule::Identifier, Identifier));
+            node = p.node(Rule::IdentifierList, 1, children);
+            continue;
+
+        default:
+            return node;
+        }
+    }
+}
+
+
+ParseNode *CParser::Rules::parseTypeName()
+{
+    DepthGuard depth(p);
+    Children children(p.position());
+    children.add(parseSpecifierQualifierList());
+    switch (p.la(0))
+    {
+    case punctuator(Punctuator::LeftParen):
+    case punctuator(Punctuator::LeftBracket):
+    case punctuator(Punctuator::Star):
+        children.add(parseAbstractDeclarator());
+        return p.node(Rule::TypeName, 0, children);
+
+    default:
+        return children.first;
+    }
+}
+
+
+ParseNode *CParser::Rules::parseAbstractDeclarator()
+{
+    DepthGuard depth(p);
+    Children children(p.position());
+    switch (p.la(0))
+    {
+    case punctuator(Punctuator::Star):
+        children.add(parsePointer());
+        switch (p.la(0))
+        {
+        case punctuator(Punctuator::LeftParen):
+        case punctuator(Punctuator::LeftBracket):
+            children.add(parseDirectAbstractDeclarator());
+            return p.node(Rule::AbstractDeclarator, 1, children);
+
+        default:
+            return children.first;
+        }
+
+    case punctuator(Punctuator::LeftParen):
+    case punctuator(Punctuator::LeftBracket):
+        children.add(parseDirectAbstractDeclarator());
+        return children.first;
+
+    default:
+        p.unexpected(Rule::AbstractDeclarator);
+    }
+}
+
+
+ParseNode *CParser::Rules::parseDirectAbstractDeclaratorHead()
+{
+    DepthGuard depth(p);
+    Children children(p.position());
+    switch (p.la(0))
+    {
+    case punctuator(Punctuator::LeftParen):
+        p.advance();
+        switch (p.la(0))
+        {
+        case punctuator(Punctuator::LeftParen):
+        case punctuator(Punctuator::LeftBracket):
+        case punctuator(Punctuator::Star):
+            children.add(parseAbstractDeclarator());
+            p.expect(punctuator(Punctuator::RightParen));
+            return p.node(Rule::DirectAbstractDeclarator, 0, children);
+
+        case TypedefName:
+        case keyword(Keyword::Typedef):
+        case keyword(Keyword::Extern):
+        case keyword(Keyword::Static):
+        case keyword(Keyword::ThreadLocal):
+        case keyword(Keyword::Auto):
+        case keyword(Keyword::Register):
+        case keyword(Keyword::Void):
+        case keyword(Keyword::Char):
+        case keyword(Keyword::Short):
+        case keyword(Keyword::Int):
+        case keyword(Keyword::Long):
+        case keyword(Keyword::Float):
+        case keyword(Keyword::Double):
+        case keyword(Keyword::Signed):
+        case keyword(Keyword::Unsigned):
+        case keyword(Keyword::Bool):
+        case keyword(Keyword::Complex):
+        case keyword(Keyword::Struct):
+        case keyword(Keyword::Union):
+        case keyword(Keyword::Enum):
+        case keyword(Keyword::Atomic):
+        case keyword(Keyword::Const):
+        case keyword(Keyword::Restrict):
+        case keyword(Keyword::Volatile):
+        case keyword(Keyword::Inline):
+        case keyword(Keyword::Noreturn):
+        case keyword(Keyword::Alignas):
+            children.add(parseParameterTypeList());
+            p.expect(punctuator(Punctuator::RightParen));
+            return p.node(Rule::DirectAbstractDeclarator, 5, children);
+
+        case punctuator(Punctuator::RightParen):
+            p.advance();
+            return p.node(Rule::DirectAbstractDeclarator, 5, children);
+
+        default:
+            p.unexpected(Rule::DirectAbstractDeclarator);
+        }
+
+    case punctuator(Punctuator::LeftBracket):
+        p.advance();
+        int choice12;
+        switch (p.la(0))
+        {
+        case keyword(Keyword::Atomic):
+        case keyword(Keyword::Const):
+        case keyword(Keyword::Restrict):
+        case keyword(Keyword::Volatile):
+            choice12 = 0;
+            break;
+
+        case Identifier:
+        case TypedefName:
+        case Constant:
+        case StringLiteral:
+        case punctuator(Punctuator::LeftParen):
+        case keyword(Keyword::Generic):
+        case punctuator(Punctuator::PlusPlus):
+        case punctuator(Punctuator::MinusMinus):
+        case keyword(Keyword::Sizeof):
+        case keyword(Keyword::Alignof):
+        case punctuator(Punctuator::Amp):
+        case punctuator(Punctuator::Plus):
+        case punctuator(Punctuator::Minus):
+        case punctuator(Punctuator::Tilde):
+        case punctuator(Punctuator::Exclaim):
+            choice12 = 1;
+            break;
+
+        case punctuator(Punctuator::RightBracket):
+            choice12 = 2;
+            break;
+
+        case keyword(Keyword::Static):
+            choice12 = 3;
+            break;
+
+        case punctuator(Punctuator::Star):
+            switch (p.la(1))
+            {
+            case Identifier:
+            case TypedefName:
+            case Constant:
+            case StringLiteral:
+            case punctuator(Punctuator::LeftParen):
+            case keyword(Keyword::Generic):
+            case punctuator(Punctuator::PlusPlus):
+            case punctuator(Punctuator::MinusMinus):
+            case keyword(Keyword::Sizeof):
+            case keyword(Keyword::Alignof):
+            case punctuator(Punctuator::Amp):
+            case punctuator(Punctuator::Star):
+            case punctuator(Punctuator::Plus):
+            case punctuator(Punctuator::Minus):
+            case punctuator(Punctuator::Tilde):
+            case punctuator(Punctuator::Exclaim):
+                choice12 = 1;
+                break;
+
+            case punctuator(Punctuator::RightBracket):
+                choice12 = 4;
+                break;
+
+            default:
+                p.unexpected(Rule::DirectAbstractDeclarator);
+            }
+            break;
+
+        default:
+            p.unexpected(Rule::DirectAbstractDeclarator);
+        }
+
+        switch (choice12)
+        {
+        case 0:
+            children.add(parseTypeQualifierList());
+            switch (p.la(0))
+            {
+            case Identifier:
+            case TypedefName:
+            case Constant:
+            case StringLiteral:
+            case punctuator(Punctuator::LeftParen):
+            case keyword(Keyword::Generic):
+            case punctuator(Punctuator::PlusPlus):
+            case punctuator(Punctuator::MinusMinus):
+            case keyword(Keyword::Sizeof):
+            case keyword(Keyword::Alignof):
+            case punctuator(Punctuator::Amp):
+            case punctuator(Punctuator::Star):
+            case punctuator(Punctuator::Plus):
+            case punctuator(Punctuator::Minus):
+            case punctuator(Punctuator::Tilde):
+            case punctuator(Punctuator::Exclaim):
+                children.add(parseAssignmentExpression());
+                p.expect(punctuator(Punctuator::RightBracket));
+                return p.node(Rule::DirectAbstractDeclarator, 1, children);
+
+            case punctuator(Punctuator::RightBracket):
+                p.advance();
+                return p.node(Rule::DirectAbstractDeclarator, 1, children);
+
+            case keyword(Keyword::Static):
+                p.advance();
+                children.add(parseAssignmentExpression());
+                p.expect(punctuator(Punctuator::RightBracket));
+                return p.node(Rule::DirectAbstractDeclarator, 3, children);
+
+            default:
+                p.unexpected(Rule::DirectAbstractDeclarator);
+            }
+
+        case 1:
+            children.add(parseAssignmentExpression());
+            p.expect(punctuator(Punctuator::RightBracket));
+            return p.node(Rule::DirectAbstractDeclarator, 1, children);
+
+        case 2:
+            p.advance();
+            return p.node(Rule::DirectAbstractDeclarator, 1, children);
+
+        case 3:
+            p.advance();
+            switch (p.la(0))
+            {
+            case keyword(Keyword::Atomic):
+            case keyword(Keyword::Const):
+            case keyword(Keyword::Restrict):
+            case keyword(Keyword::Volatile):
+                children.add(parseTypeQualifierList());
+                children.add(parseAssignmentExpression());
+                p.expect(punctuator(Punctuator::RightBracket));
+                return p.node(Rule::DirectAbstractDeclarator, 2, children);
+
+            case Identifier:
+            case TypedefName:
+            case Constant:
+            case StringLiteral:
+            case punctuator(Punctuator::LeftParen):
+            case keyword(Keyword::Generic):
+            case punctuator(Punctuator::PlusPlus):
+            case punctuator(Punctuator::MinusMinus):
+            case keyword(Keyword::Sizeof):
+            case keyword(Keyword::Alignof):
+            case punctuator(Punctuator::Amp):
+            case punctuator(Punctuator::Star):
+            case punctuator(Punctuator::Plus):
+            case punctuator(Punctuator::Minus):
+            case punctuator(Punctuator::Tilde):
+            case punctuator(Punctuator::Exclaim):
+                children.add(parseAssignmentExpression());
+                p.expect(punctuator(Punctuator::RightBracket));
+                return p.node(Rule::DirectAbstractDeclarator, 2, children);
+
+            default:
+                p.unexpected(Rule::DirectAbstractDeclarator);
+            }
+
+        default:
+            p.advance();
+            p.expect(punctuator(Punctuator::RightBracket));
+            return p.node(Rule::DirectAbstractDeclarator, 4, children);
+        }
+
+    default:
+        p.unexpected(Rule::DirectAbstractDeclarator);
+    }
+}
+
+
+ParseNode *CParser::Rules::parseDirectAbstractDeclarator()
+{
+    DepthGuard depth(p);
+    ParseNode *node = parseDirectAbstractDeclaratorHead();
+    for (;;)
+    {
+        Children children(node);
+        switch (p.la(0))
+        {
+        case punctuator(Punctuator::LeftBracket):
+            p.advance();
+            int choice13;
+            switch (p.la(0))
+            {
+            case keyword(Keyword::Atomic):
+            case keyword(Keyword::Const):
+            case keyword(Keyword::Restrict):
+            case keyword(Keyword::Volatile):
+                choice13 = 0;
+                break;
+
+            case Identifier:
+            case TypedefName:
+            case Constant:
+            case StringLiteral:
+            case punctuator(Punctuator::LeftParen):
+            case keyword(Keyword::Generic):
+            case punctuator(Punctuator::PlusPlus):
+            case punctuator(Punctuator::MinusMinus):
+            case keyword(Keyword::Sizeof):
+            case keyword(Keyword::Alignof):
+            case punctuator(Punctuator::Amp):
+            case punctuator(Punctuator::Plus):
+            case punctuator(Punctuator::Minus):
+            case punctuator(Punctuator::Tilde):
+            case punctuator(Punctuator::Exclaim):
+                choice13 = 1;
+                break;
+
+            case punctuator(Punctuator::RightBracket):
+                choice13 = 2;
+                break;
+
+            case keyword(Keyword::Static):
+                choice13 = 3;
+                break;
+
+            case punctuator(Punctuator::Star):
+                switch (p.la(1))
+                {
+                case Identifier:
+                case TypedefName:
+                case Constant:
+                case StringLiteral:
+                case punctuator(Punctuator::LeftParen):
+                case keyword(Keyword::Generic):
+                case punctuator(Punctuator::PlusPlus):
+                case punctuator(Punctuator::MinusMinus):
+                case keyword(Keyword::Sizeof):
+                case keyword(Keyword::Alignof):
+                case punctuator(Punctuator::Amp):
+                case punctuator(Punctuator::Star):
+                case punctuator(Punctuator::Plus):
+                case punctuator(Punctuator::Minus):
+                case punctuator(Punctuator::Tilde):
+                case punctuator(Punctuator::Exclaim):
+                    choice13 = 1;
+                    break;
+
+                case punctuator(Punctuator::RightBracket):
+                    choice13 = 4;
+                    break;
+
+                default:
+                    p.unexpected(Rule::DirectAbstractDeclarator);
+                }
+                break;
+
+            default:
+                p.unexpected(Rule::DirectAbstractDeclarator);
+            }
+
+            switch (choice13)
+            {
+            case 0:
+                children.add(parseTypeQualifierList());
+                switch (p.la(0))
+                {
+                case Identifier:
+                case TypedefName:
+                case Constant:
+                case StringLiteral:
+                case punctuator(Punctuator::LeftParen):
+                case keyword(Keyword::Generic):
+                case punctuator(Punctuator::PlusPlus):
+                case punctuator(Punctuator::MinusMinus):
+                case keyword(Keyword::Sizeof):
+                case keyword(Keyword::Alignof):
+                case punctuator(Punctuator::Amp):
+                case punctuator(Punctuator::Star):
+                case punctuator(Punctuator::Plus):
+                case punctuator(Punctuator::Minus):
+                case punctuator(Punctuator::Tilde):
+                case punctuator(Punctuator::Exclaim):
+                    children.add(parseAssignmentExpression());
+                    p.expect(punctuator(Punctuator::RightBracket));
+                    node = p.node(Rule::DirectAbstractDeclarator, 1, children);
+                    continue;
+
+                case punctuator(Punctuator::RightBracket):
+                    p.advance();
+                    node = p.node(Rule::DirectAbstractDeclarator, 1, children);
+                    continue;
+
+                case keyword(Keyword::Static):
+                    p.advance();
+                    children.add(parseAssignmentExpression());
+                    p.expect(punctuator(Punctuator::RightBracket));
+                    node = p.node(Rule::DirectAbstractDeclarator, 3, children);
+                    continue;
+
+                default:
+                    p.unexpected(Rule::DirectAbstractDeclarator);
+                }
+
+            case 1:
+                children.add(parseAssignmentExpression());
+                p.expect(punctuator(Punctuator::RightBracket));
+                node = p.node(Rule::DirectAbstractDeclarator, 1, children);
+                continue;
+
+            case 2:
+                p.advance();
+                node = p.node(Rule::DirectAbstractDeclarator, 1, children);
+                continue;
+
+            case 3:
+                p.advance();
+                switch (p.la(0))
+                {
+                case keyword(Keyword::Atomic):
+                case keyword(Keyword::Const):
+                case keyword(Keyword::Restrict):
+                case keyword(Keyword::Volatile):
+                    children.add(parseTypeQualifierList());
+                    children.add(parseAssignmentExpression());
+                    p.expect(punctuator(Punctuator::RightBracket));
+                    node = p.node(Rule::DirectAbstractDeclarator, 2, children);
+                    continue;
+
+                case Identifier:
+                case TypedefName:
+                case Constant:
+                case StringLiteral:
+                case punctuator(Punctuator::LeftParen):
+                case keyword(Keyword::Generic):
+                case punctuator(Punctuator::PlusPlus):
+                case punctuator(Punctuator::MinusMinus):
+                case keyword(Keyword::Sizeof):
+                case keyword(Keyword::Alignof):
+                case punctuator(Punctuator::Amp):
+                case punctuator(Punctuator::Star):
+                case punctuator(Punctuator::Plus):
+                case punctuator(Punctuator::Minus):
+                case punctuator(Punctuator::Tilde):
+                case punctuator(Punctuator::Exclaim):
+                    children.add(parseAssignmentExpression());
+                    p.expect(punctuator(Punctuator::RightBracket));
+                    node = p.node(Rule::DirectAbstractDeclarator, 2, children);
+                    continue;
+
+                default:
+                    p.unexpected(Rule::DirectAbstractDeclarator);
+                }
+
+            default:
+                p.advance();
+                p.expect(punctuator(Punctuator::RightBracket));
+                node = p.node(Rule::DirectAbstractDeclarator, 4, children);
+                continue;
+            }
+
+        case punctuator(Punctuator::LeftParen):
+            p.advance();
+            switch (p.la(0))
+            {
+            case TypedefName:
+            case keyword(Keyword::Typedef):
+            case keyword(Keyword::Extern):
+            case keyword(Keyword::Static):
+            case keyword(Keyword::ThreadLocal):
+            case keyword(Keyword::Auto):
+            case keyword(Keyword::Register):
+            case keyword(Keyword::Void):
+            case keyword(Keyword::Char):
+            case keyword(Keyword::Short):
+            case keyword(Keyword::Int):
+            case keyword(Keyword::Long):
+            case keyword(Keyword::Float):
+            case keyword(Keyword::Double):
+            case keyword(Keyword::Signed):
+            case keyword(Keyword::Unsigned):
+            case keyword(Keyword::Bool):
+            case keyword(Keyword::Complex):
+            case keyword(Keyword::Struct):
+            case keyword(Keyword::Union):
+            case keyword(Keyword::Enum):
+            case keyword(Keyword::Atomic):
+            case keyword(Keyword::Const):
+            case keyword(Keyword::Restrict):
+            case keyword(Keyword::Volatile):
+            case keyword(Keyword::Inline):
+            case keyword(Keyword::Noreturn):
+            case keyword(Keyword::Alignas):
+                children.add(parseParameterTypeList());
+                p.expect(punctuator(Punctuator::RightParen));
+                node = p.node(Rule::DirectAbstractDeclarator, 5, children);
+                continue;
+
+            case punctuator(Punctuator::RightParen):
+                p.advance();
+                node = p.node(Rule::DirectAbstractDeclarator, 5, children);
+                continue;
+
+            default:
+                p.unexpected(Rule::DirectAbstractDeclarator);
+            }
+
+        default:
+            return node;
+        }
+    }
+}
+
+
+ParseNode *CParser::Rules::parseInitializer()
+{
+    DepthGuard depth(p);
+    Children children(p.position());
+    switch (p.la(0))
+    {
+    case Identifier:
+    case TypedefName:
+    case Constant:
+    case StringLiteral:
+    case punctuator(Punctuator::LeftParen):
+    case keyword(Keyword::Generic):
+    case punctuator(Punctuator::PlusPlus):
+    case punctuator(Punctuator::MinusMinus):
+    case keyword(Keyword::Sizeof):
+    case keyword(Keyword::Alignof):
+    case punctuator(Punctuator::Amp):
+    case punctuator(Punctuator::Star):
+    case punctuator(Punctuator::Plus):
+    case punctuator(Punctuator::Minus):
+    case punctuator(Punctuator::Tilde):
+    case punctuator(Punctuator::Exclaim):
+        children.add(parseAssignmentExpression());
+        return children.first;
+
+    case punctuator(Punctuator::LeftBrace):
+        p.advance();
+        children.add(parseInitializerList());
+        switch (p.la(0))
+        {
+        case punctuator(Punctuator::RightBrace):
+            p.advance();
+            return p.node(Rule::Initializer, 1, children);
+
+        case punctuator(Punctuator::Comma):
+            p.advance();
+            p.expect(punctuator(Punctuator::RightBrace));
+            return p.node(Rule::Initializer, 2, children);
+
+        default:
+            p.unexpected(Rule::Initializer);
+        }
+
+    default:
+        p.unexpected(Rule::Initializer);
+    }
+}
+
+
+ParseNode *CParser::Rules::parseInitializerListHead()
+{
+    DepthGuard depth(p);
+    Children children(p.position());
+    switch (p.la(0))
+    {
+    case punctuator(Punctuator::LeftBracket):
+    case punctuator(Punctuator::Dot):
+        children.add(parseDesignation());
+        children.add(parseInitializer());
+        return p.node(Rule::InitializerList, 0, children);
+
+    case Identifier:
+    case TypedefName:
+    case Constant:
+    case StringLiteral:
+    case punctuator(Punctuator::LeftParen):
+    case keyword(Keyword::Generic):
+    case punctuator(Punctuator::PlusPlus):
+    case punctuator(Punctuator::MinusMinus):
+    case keyword(Keyword::Sizeof):
+    case keyword(Keyword::Alignof):
+    case punctuator(Punctuator::Amp):
+    case punctuator(Punctuator::Star):
+    case punctuator(Punctuator::Plus):
+    case punctuator(Punctuator::Minus):
+    case punctuator(Punctuator::Tilde):
+    case punctuator(Punctuator::Exclaim):
+    case punctuator(Punctuator::LeftBrace):
+        children.add(parseInitializer());
+        return children.first;
+
+    default:
+        p.unexpected(Rule::InitializerList);
+    }
+}
+
+
+ParseNode *CParser::Rules::parseInitializerList()
+{
+    DepthGuard depth(p);
+    ParseNode *node = parseInitializerListHead();
+    for (;;)
+    {
+        Children children(node);
+        int choice14;
+        switch (p.la(0))
+        {
+        case punctuator(Punctuator::Comma):
+            switch (p.la(1))
+            {
+            case Identifier:
+            case TypedefName:
+            case Constant:
+            case StringLiteral:
+            case punctuator(Punctuator::LeftParen):
+            case keyword(Keyword::Generic):
+            case punctuator(Punctuator::LeftBracket):
+            case punctuator(Punctuator::Dot):
+            case punctuator(Punctuator::PlusPlus):
+            case punctuator(Punctuator::MinusMinus):
+            case keyword(Keyword::Sizeof):
+            case keyword(Keyword::Alignof):
+            case punctuator(Punctuator::Amp):
+            case punctuator(Punctuator::Star):
+            case punctuator(Punctuator::Plus):
+            case punctuator(Punctuator::Minus):
+            case punctuator(Punctuator::Tilde):
+            case punctuator(Punctuator::Exclaim):
+            case punctuator(Punctuator::LeftBrace):
+                choice14 = 0;
+                break;
+
+            default:
+                choice14 = 1;
+                break;
+            }
+            break;
+
+        default:
+            choice14 = 1;
+            break;
+        }
+
+        switch (choice14)
+        {
+        case 0:
+            p.advance();
+            switch (p.la(0))
+            {
+            case punctuator(Punctuator::LeftBracket):
+            case punctuator(Punctuator::Dot):
+                children.add(parseDesignation());
+                children.add(parseInitializer());
+                node = p.node(Rule::InitializerList, 1, children);
+                continue;
+
+            case Identifier:
+            case TypedefName:
+            case Constant:
+            case StringLiteral:
+            case punctuator(Punctuator::LeftParen):
+            case keyword(Keyword::Generic):
+            case punctuator(Punctuator::PlusPlus):
+            case punctuator(Punctuator::MinusMinus):
+            case keyword(Keyword::Sizeof):
+            case keyword(Keyword::Alignof):
+            case punctuator(Punctuator::Amp):
+            case punctuator(Punctuator::Star):
+            case punctuator(Punctuator::Plus):
+            case punctuator(Punctuator::Minus):
+            case punctuator(Punctuator::Tilde):
+            case punctuator(Punctuator::Exclaim):
+            case punctuator(Punctuator::LeftBrace):
+                children.add(parseInitializer());
+                node = p.node(Rule::InitializerList, 1, children);
+                continue;
+
+            default:
+                p.unexpected(Rule::InitializerList);
+            }
+
+        default:
+            return node;
+        }
+    }
+}
+
+
+ParseNode *CParser::Rules::parseDesignation()
+{
+    DepthGuard depth(p);
+    Children children(p.position());
+    children.add(parseDesignatorList());
+    p.expect(punctuator(Punctuator::Equal));
+    return p.node(Rule::Designation, 0, children);
+}
+
+
+ParseNode *CParser::Rules::parseDesignatorList()
+{
+    DepthGuard depth(p);
+    ParseNode *node = parseDesignator();
+    for (;;)
+    {
+        Children children(node);
+        switch (p.la(0))
+        {
+        case punctuator(Punctuator::LeftBracket):
+        case punctuator(Punctuator::Dot):
+            children.add(parseDesignator());
+            node = p.node(Rule::DesignatorList, 1, children);
+            continue;
+
+        default:
+            return node;
+        }
+    }
+}
+
+
+ParseNode *CParser::Rules::parseDesignator()
+{
+    DepthGuard depth(p);
+    Children children(p.position());
+    switch (p.la(0))
+    {
+    case punctuator(Punctuator::LeftBracket):
+        p.advance();
+        children.add(parseConstantExpression());
+        p.expect(punctuator(Punctuator::RightBracket));
+        return p.node(Rule::Designator, 0, children);
+
+    case punctuator(Punctuator::Dot):
+        p.advance();
+        children.add(p.expectLeaf(Rule::Identifier, Identifier));
+        return p.node(Rule::Designator, 1, children);
+
+    default:
+        p.unexpected(Rule::Designator);
+    }
+}
+
+
+ParseNode *CParser::Rules::parseStaticAssertDeclaration()
+{
+    DepthGuard depth(p);
+    Children children(p.position());
+    p.expect(keyword(Keyword::StaticAssert));
+    p.expect(punctuator(Punctuator::LeftParen));
+    children.add(parseConstantExpression());
+    p.expect(punctuator(Punctuator::Comma));
+    children.add(p.expectLeaf(Rule::StringLiteral, StringLiteral));
+    p.expect(punctuator(Punctuator::RightParen));
+    p.expect(punctuator(Punctuator::Semi));
+    return p.node(Rule::StaticAssertDeclaration, 0, children);
+}
+
+
+ParseNode *CParser::Rules::parseStatement()
+{
+    DepthGuard depth(p);
+    Children children(p.position());
+    int choice15;
+    switch (p.la(0))
+    {
+    case keyword(Keyword::Default):
+    case keyword(Keyword::Case):
+        choice15 = 0;
+        break;
+
+    case punctuator(Punctuator::LeftBrace):
+        choice15 = 1;
+        break;
+
+    case Constant:
+    case StringLiteral:
+    case punctuator(Punctuator::LeftParen):
+    case keyword(Keyword::Generic):
+    case punctuator(Punctuator::PlusPlus):
+    case punctuator(Punctuator::MinusMinus):
+    case keyword(Keyword::Sizeof):
+    case keyword(Keyword::Alignof):
+    case punctuator(Punctuator::Amp):
+    case punctuator(Punctuator::Star):
+    case punctuator(Punctuator::Plus):
+    case punctuator(Punctuator::Minus):
+    case punctuator(Punctuator::Tilde):
+    case punctuator(Punctuator::Exclaim):
+    case punctuator(Punctuator::Semi):
+        choice15 = 2;
+        break;
+
+    case keyword(Keyword::If):
+    case keyword(Keyword::Switch):
+        choice15 = 3;
+        break;
+
+    case keyword(Keyword::While):
+    case keyword(Keyword::Do):
+    case keyword(Keyword::For):
+        choice15 = 4;
+        break;
+
+    case keyword(Keyword::Goto):
+    case keyword(Keyword::Continue):
+    case keyword(Keyword::Break):
+    case keyword(Keyword::Return):
+        choice15 = 5;
+        break;
+
+    case Identifier:
+        switch (p.la(1))
+        {
+        case punctuator(Punctuator::Colon):
+            choice15 = 0;
+            break;
+
+        case punctuator(Punctuator::LeftParen):
+        case punctuator(Punctuator::Comma):
+        case punctuator(Punctuator::LeftBracket):
+        case punctuator(Punctuator::Dot):
+        case punctuator(Punctuator::MinusGreater):
+        case punctuator(Punctuator::PlusPlus):
+        case punctuator(Punctuator::MinusMinus):
+        case punctuator(Punctuator::Amp):
+        case punctuator(Punctuator::Star):
+        case punctuator(Punctuator::Plus):
+        case punctuator(Punctuator::Minus):
+        case punctuator(Punctuator::Slash):
+        case punctuator(Punctuator::Percent):
+        case punctuator(Punctuator::LessLess):
+        case punctuator(Punctuator::GreaterGreater):
+        case punctuator(Punctuator::Less):
+        case punctuator(Punctuator::Greater):
+        case punctuator(Punctuator::LessEqual):
+        case punctuator(Punctuator::GreaterEqual):
+        case punctuator(Punctuator::EqualEqual):
+        case punctuator(Punctuator::ExclaimEqual):
+        case punctuator(Punctuator::Caret):
+        case punctuator(Punctuator::Pipe):
+        case punctuator(Punctuator::AmpAmp):
+        case punctuator(Punctuator::PipePipe):
+        case punctuator(Punctuator::Question):
+        case punctuator(Punctuator::Equal):
+        case punctuator(Punctuator::StarEqual):
+        case punctuator(Punctuator::SlashEqual):
+        case punctuator(Punctuator::PercentEqual):
+        case punctuator(Punctuator::PlusEqual):
+        case punctuator(Punctuator::MinusEqual):
+        case punctuator(Punctuator::LessLessEqual):
+        case punctuator(Punctuator::GreaterGreaterEqual):
+        case punctuator(Punctuator::AmpEqual):
+        case punctuator(Punctuator::CaretEqual):
+        case punctuator(Punctuator::PipeEqual):
+        case punctuator(Punctuator::Semi):
+            choice15 = 2;
+            break;
+
+        default:
+            p.unexpected(Rule::Statement);
+        }
+        break;
+
+    case TypedefName:
+        switch (p.la(1))
+        {
+        case punctuator(Punctuator::Colon):
+            choice15 = 0;
+            break;
+
+        case punctuator(Punctuator::LeftParen):
+        case punctuator(Punctuator::Comma):
+        case punctuator(Punctuator::LeftBracket):
+        case punctuator(Punctuator::Dot):
+        case punctuator(Punctuator::MinusGreater):
+        case punctuator(Punctuator::PlusPlus):
+        case punctuator(Punctuator::MinusMinus):
+        case punctuator(Punctuator::Amp):
+        case punctuator(Punctuator::Star):
+        case punctuator(Punctuator::Plus):
+        case punctuator(Punctuator::Minus):
+        case punctuator(Punctuator::Slash):
+        case punctuator(Punctuator::Percent):
+        case punctuator(Punctuator::LessLess):
+        case punctuator(Punctuator::GreaterGreater):
+        case punctuator(Punctuator::Less):
+        case punctuator(Punctuator::Greater):
+        case punctuator(Punctuator::LessEqual):
+        case punctuator(Punctuator::GreaterEqual):
+        case punctuator(Punctuator::EqualEqual):
+        case punctuator(Punctuator::ExclaimEqual):
+        case punctuator(Punctuator::Caret):
+        case punctuator(Punctuator::Pipe):
+        case punctuator(Punctuator::AmpAmp):
+        case punctuator(Punctuator::PipePipe):
+        case punctuator(Punctuator::Question):
+        case punctuator(Punctuator::Equal):
+        case punctuator(Punctuator::StarEqual):
+        case punctuator(Punctuator::SlashEqual):
+        case punctuator(Punctuator::PercentEqual):
+        case punctuator(Punctuator::PlusEqual):
+        case punctuator(Punctuator::MinusEqual):
+        case punctuator(Punctuator::LessLessEqual):
+        case punctuator(Punctuator::GreaterGreaterEqual):
+        case punctuator(Punctuator::AmpEqual):
+        case punctuator(Punctuator::CaretEqual):
+        case punctuator(Punctuator::PipeEqual):
+        case punctuator(Punctuator::Semi):
+            choice15 = 2;
+            break;
+
+        default:
+            p.unexpected(Rule::Statement);
+        }
+        break;
+
+    default:
+        p.unexpected(Rule::Statement);
+    }
+
+    switch (choice15)
+    {
+    case 0:
+        children.add(parseLabeledStatement());
+        return children.first;
+
+    case 1:
+        children.add(parseCompoundStatement());
+        return children.first;
+
+    case 2:
+        children.add(parseExpressionStatement());
+        return children.first;
+
+    case 3:
+        children.add(parseSelectionStatement());
+        return children.first;
+
+    case 4:
+        children.add(parseIterationStatement());
+        return children.first;
+
+    default:
+        children.add(parseJumpStatement());
+        return children.first;
+    }
+}
+
+
+ParseNode *CParser::Rules::parseLabeledStatement()
+{
+    DepthGuard depth(p);
+    Children children(p.position());
+    switch (p.la(0))
+    {
+    case Identifier:
+    case TypedefName:
+        children.add(p.leaf(Rule::Identifier));
+        p.expect(punctuator(Punctuator::Colon));
+        children.add(parseStatement());
+        return p.node(Rule::LabeledStatement, 0, children);
+
+    case keyword(Keyword::Case):
+        p.advance();
+        children.add(parseConstantExpression());
+        p.expect(punctuator(Punctuator::Colon));
+        children.add(parseStatement());
+        return p.node(Rule::LabeledStatement, 1, children);
+
+    case keyword(Keyword::Default):
+        p.advance();
+        p.expect(punctuator(Punctuator::Colon));
+        children.add(parseStatement());
+        return p.node(Rule::LabeledStatement, 2, children);
+
+    default:
+        p.unexpected(Rule::LabeledStatement);
+    }
+}
+
+
+ParseNode *CParser::Rules::parseCompoundStatement()
+{
+    DepthGuard depth(p);
+    ScopeGuard scope(p);
+    Children children(p.position());
+    p.expect(punctuator(Punctuator::LeftBrace));
+    switch (p.la(0))
+    {
+    case Identifier:
+    case TypedefName:
+    case Constant:
+    case StringLiteral:
+    case punctuator(Punctuator::LeftParen):
+    case keyword(Keyword::Generic):
+    case keyword(Keyword::Default):
+    case punctuator(Punctuator::PlusPlus):
+    case punctuator(Punctuator::MinusMinus):
+    case keyword(Keyword::Sizeof):
+    case keyword(Keyword::Alignof):
+    case punctuator(Punctuator::Amp):
+    case punctuator(Punctuator::Star):
+    case punctuator(Punctuator::Plus):
+    case punctuator(Punctuator::Minus):
+    case punctuator(Punctuator::Tilde):
+    case punctuator(Punctuator::Exclaim):
+    case punctuator(Punctuator::LeftBrace):
+    case punctuator(Punctuator::Semi):
+    case keyword(Keyword::Typedef):
+    case keyword(Keyword::Extern):
+    case keyword(Keyword::Static):
+    case keyword(Keyword::ThreadLocal):
+    case keyword(Keyword::Auto):
+    case keyword(Keyword::Register):
+    case keyword(Keyword::Void):
+    case keyword(Keyword::Char):
+    case keyword(Keyword::Short):
+    case keyword(Keyword::Int):
+    case keyword(Keyword::Long):
+    case keyword(Keyword::Float):
+    case keyword(Keyword::Double):
+    case keyword(Keyword::Signed):
+    case keyword(Keyword::Unsigned):
+    case keyword(Keyword::Bool):
+    case keyword(Keyword::Complex):
+    case keyword(Keyword::Struct):
+    case keyword(Keyword::Union):
+    case keyword(Keyword::Enum):
+    case keyword(Keyword::Atomic):
+    case keyword(Keyword::Const):
+    case keyword(Keyword::Restrict):
+    case keyword(Keyword::Volatile):
+    case keyword(Keyword::Inline):
+    case keyword(Keyword::Noreturn):
+    case keyword(Keyword::Alignas):
+    case keyword(Keyword::StaticAssert):
+    case keyword(Keyword::Case):
+    case keyword(Keyword::If):
+    case keyword(Keyword::Switch):
+    case keyword(Keyword::While):
+    case keyword(Keyword::Do):
+    case keyword(Keyword::For):
+    case keyword(Keyword::Goto):
+    case keyword(Keyword::Continue):
+    case keyword(Keyword::Break):
+    case keyword(Keyword::Return):
+        children.add(parseBlockItemList());
+        p.expect(punctuator(Punctuator::RightBrace));
+        return p.node(Rule::CompoundStatement, 0, children);
+
+    case punctuator(Punctuator::RightBrace):
+        p.advance();
+        return p.node(Rule::CompoundStatement, 0, children);
+
+    default:
+        p.unexpected(Rule::CompoundStatement);
+    }
+}
+
+
+ParseNode *CParser::Rules::parseBlockItemList()
+{
+    DepthGuard depth(p);
+    ParseNode *node = parseBlockItem();
+    for (;;)
+    {
+        Children children(node);
+        switch (p.la(0))
+        {
+        case Identifier:
+        case TypedefName:
+        case Constant:
+        case StringLiteral:
+        case punctuator(Punctuator::LeftParen):
+        case keyword(Keyword::Generic):
+        case keyword(Keyword::Default):
+        case punctuator(Punctuator::PlusPlus):
+        case punctuator(Punctuator::MinusMinus):
+        case keyword(Keyword::Sizeof):
+        case keyword(Keyword::Alignof):
+        case punctuator(Punctuator::Amp):
+        case punctuator(Punctuator::Star):
+        case punctuator(Punctuator::Plus):
+        case punctuator(Punctuator::Minus):
+        case punctuator(Punctuator::Tilde):
+        case punctuator(Punctuator::Exclaim):
+        case punctuator(Punctuator::LeftBrace):
+        case punctuator(Punctuator::Semi):
+        case keyword(Keyword::Typedef):
+        case keyword(Keyword::Extern):
+        case keyword(Keyword::Static):
+        case keyword(Keyword::ThreadLocal):
+        case keyword(Keyword::Auto):
+        case keyword(Keyword::Register):
+        case keyword(Keyword::Void):
+        case keyword(Keyword::Char):
+        case keyword(Keyword::Short):
+        case keyword(Keyword::Int):
+        case keyword(Keyword::Long):
+        case keyword(Keyword::Float):
+        case keyword(Keyword::Double):
+        case keyword(Keyword::Signed):
+        case keyword(Keyword::Unsigned):
+        case keyword(Keyword::Bool):
+        case keyword(Keyword::Complex):
+        case keyword(Keyword::Struct):
+        case keyword(Keyword::Union):
+        case keyword(Keyword::Enum):
+        case keyword(Keyword::Atomic):
+        case keyword(Keyword::Const):
+        case keyword(Keyword::Restrict):
+        case keyword(Keyword::Volatile):
+        case keyword(Keyword::Inline):
+        case keyword(Keyword::Noreturn):
+        case keyword(Keyword::Alignas):
+        case keyword(Keyword::StaticAssert):
+        case keyword(Keyword::Case):
+        case keyword(Keyword::If):
+        case keyword(Keyword::Switch):
+        case keyword(Keyword::While):
+        case keyword(Keyword::Do):
+        case keyword(Keyword::For):
+        case keyword(Keyword::Goto):
+        case keyword(Keyword::Continue):
+        case keyword(Keyword::Break):
+        case keyword(Keyword::Return):
+            children.add(parseBlockItem());
+            node = p.node(Rule::BlockItemList, 1, children);
+            continue;
+
+        default:
+            return node;
+        }
+    }
+}
+
+
+ParseNode *CParser::Rules::parseBlockItem()
+{
+    DepthGuard depth(p);
+    Children children(p.position());
+    int choice16;
+    switch (p.la(0))
+    {
+    case keyword(Keyword::Typedef):
+    case keyword(Keyword::Extern):
+    case keyword(Keyword::Static):
+    case keyword(Keyword::ThreadLocal):
+    case keyword(Keyword::Auto):
+    case keyword(Keyword::Register):
+    case keyword(Keyword::Void):
+    case keyword(Keyword::Char):
+    case keyword(Keyword::Short):
+    case keyword(Keyword::Int):
+    case keyword(Keyword::Long):
+    case keyword(Keyword::Float):
+    case keyword(Keyword::Double):
+    case keyword(Keyword::Signed):
+    case keyword(Keyword::Unsigned):
+    case keyword(Keyword::Bool):
+    case keyword(Keyword::Complex):
+    case keyword(Keyword::Struct):
+    case keyword(Keyword::Union):
+    case keyword(Keyword::Enum):
+    case keyword(Keyword::Atomic):
+    case keyword(Keyword::Const):
+    case keyword(Keyword::Restrict):
+    case keyword(Keyword::Volatile):
+    case keyword(Keyword::Inline):
+    case keyword(Keyword::Noreturn):
+    case keyword(Keyword::Alignas):
+    case keyword(Keyword::StaticAssert):
+        choice16 = 0;
+        break;
+
+    case Identifier:
+    case Constant:
+    case StringLiteral:
+    case punctuator(Punctuator::LeftParen):
+    case keyword(Keyword::Generic):
+    case keyword(Keyword::Default):
+    case punctuator(Punctuator::PlusPlus):
+    case punctuator(Punctuator::MinusMinus):
+    case keyword(Keyword::Sizeof):
+    case keyword(Keyword::Alignof):
+    case punctuator(Punctuator::Amp):
+    case punctuator(Punctuator::Star):
+    case punctuator(Punctuator::Plus):
+    case punctuator(Punctuator::Minus):
+    case punctuator(Punctuator::Tilde):
+    case punctuator(Punctuator::Exclaim):
+    case punctuator(Punctuator::LeftBrace):
+    case punctuator(Punctuator::Semi):
+    case keyword(Keyword::Case):
+    case keyword(Keyword::If):
+    case keyword(Keyword::Switch):
+    case keyword(Keyword::While):
+    case keyword(Keyword::Do):
+    case keyword(Keyword::For):
+    case keyword(Keyword::Goto):
+    case keyword(Keyword::Continue):
+    case keyword(Keyword::Break):
+    case keyword(Keyword::Return):
+        choice16 = 1;
+        break;
+
+    case TypedefName:
+        switch (p.la(1))
+        {
+        case punctuator(Punctuator::Comma):
+        case punctuator(Punctuator::Colon):
+        case punctuator(Punctuator::LeftBracket):
+        case punctuator(Punctuator::Dot):
+        case punctuator(Punctuator::MinusGreater):
+        case punctuator(Punctuator::PlusPlus):
+        case punctuator(Punctuator::MinusMinus):
+        case punctuator(Punctuator::Amp):
+        case punctuator(Punctuator::Plus):
+        case punctuator(Punctuator::Minus):
+        case punctuator(Punctuator::Slash):
+        case punctuator(Punctuator::Percent):
+        case punctuator(Punctuator::LessLess):
+        case punctuator(Punctuator::GreaterGreater):
+        case punctuator(Punctuator::Less):
+        case punctuator(Punctuator::Greater):
+        case punctuator(Punctuator::LessEqual):
+        case punctuator(Punctuator::GreaterEqual):
+        case punctuator(Punctuator::EqualEqual):
+        case punctuator(Punctuator::ExclaimEqual):
+        case punctuator(Punctuator::Caret):
+        case punctuator(Punctuator::Pipe):
+        case punctuator(Punctuator::AmpAmp):
+        case punctuator(Punctuator::PipePipe):
+        case punctuator(Punctuator::Question):
+        case punctuator(Punctuator::Equal):
+        case punctuator(Punctuator::StarEqual):
+        case punctuator(Punctuator::SlashEqual):
+        case punctuator(Punctuator::PercentEqual):
+        case punctuator(Punctuator::PlusEqual):
+        case punctuator(Punctuator::MinusEqual):
+        case punctuator(Punctuator::LessLessEqual):
+        case punctuator(Punctuator::GreaterGreaterEqual):
+        case punctuator(Punctuator::AmpEqual):
+        case punctuator(Punctuator::CaretEqual):
+        case punctuator(Punctuator::PipeEqual):
+            choice16 = 1;
+            break;
+
+        default:
+            choice16 = 0;
+            break;
+        }
+        break;
+
+    default:
+        p.unexpected(Rule::BlockItem);
+    }
+
+    switch (choice16)
+    {
+    case 0:
+        children.add(parseDeclaration());
+        return children.first;
+
+    default:
+        children.add(parseStatement());
+        return children.first;
+    }
+}
+
+
+ParseNode *CParser::Rules::parseExpressionStatement()
+{
+    DepthGuard depth(p);
+    Children children(p.position());
+    switch (p.la(0))
+    {
+    case Identifier:
+    case TypedefName:
+    case Constant:
+    case StringLiteral:
+    case punctuator(Punctuator::LeftParen):
+    case keyword(Keyword::Generic):
+    case punctuator(Punctuator::PlusPlus):
+    case punctuator(Punctuator::MinusMinus):
+    case keyword(Keyword::Sizeof):
+    case keyword(Keyword::Alignof):
+    case punctuator(Punctuator::Amp):
+    case punctuator(Punctuator::Star):
+    case punctuator(Punctuator::Plus):
+    case punctuator(Punctuator::Minus):
+    case punctuator(Punctuator::Tilde):
+    case punctuator(Punctuator::Exclaim):
+        children.add(parseExpression());
+        p.expect(punctuator(Punctuator::Semi));
+        return p.node(Rule::ExpressionStatement, 0, children);
+
+    case punctuator(Punctuator::Semi):
+        p.advance();
+        return p.node(Rule::ExpressionStatement, 0, children);
+
+    default:
+        p.unexpected(Rule::ExpressionStatement);
+    }
+}
+
+
+ParseNode *CParser::Rules::parseSelectionStatement()
+{
+    DepthGuard depth(p);
+    ScopeGuard scope(p);
+    Children children(p.position());
+    switch (p.la(0))
+    {
+    case keyword(Keyword::If):
+        p.advance();
+        p.expect(punctuator(Punctuator::LeftParen));
+        children.add(parseExpression());
+        p.expect(punctuator(Punctuator::RightParen));
+        children.add(parseStatement());
+        switch (p.la(0))
+        {
+        case keyword(Keyword::Else):
+            p.advance();
+            children.add(parseStatement());
+            return p.node(Rule::SelectionStatement, 1, children);
+
+        default:
+            return p.node(Rule::SelectionStatement, 0, children);
+        }
+
+    case keyword(Keyword::Switch):
+        p.advance();
+        p.expect(punctuator(Punctuator::LeftParen));
+        children.add(parseExpression());
+        p.expect(punctuator(Punctuator::RightParen));
+        children.add(parseStatement());
+        return p.node(Rule::SelectionStatement, 2, children);
+
+    default:
+        p.unexpected(Rule::SelectionStatement);
+    }
+}
+
+
+ParseNode *CParser::Rules::parseIterationStatement()
+{
+    DepthGuard depth(p);
+    ScopeGuard scope(p);
+    Children children(p.position());
+    switch (p.la(0))
+    {
+    case keyword(Keyword::While):
+        p.advance();
+        p.expect(punctuator(Punctuator::LeftParen));
+        children.add(parseExpression());
+        p.expect(punctuator(Punctuator::RightParen));
+        children.add(parseStatement());
+        return p.node(Rule::IterationStatement, 0, children);
+
+    case keyword(Keyword::Do):
+        p.advance();
+        children.add(parseStatement());
+        p.expect(keyword(Keyword::While));
+        p.expect(punctuator(Punctuator::LeftParen));
+        children.add(parseExpression());
+        p.expect(punctuator(Punctuator::RightParen));
+        p.expect(punctuator(Punctuator::Semi));
+        return p.node(Rule::IterationStatement, 1, children);
+
+    case keyword(Keyword::For):
+        p.advance();
+        p.expect(punctuator(Punctuator::LeftParen));
+        int choice17;
+        switch (p.la(0))
+        {
+        case Identifier:
+        case Constant:
+        case StringLiteral:
+        case punctuator(Punctuator::LeftParen):
+        case keyword(Keyword::Generic):
+        case punctuator(Punctuator::PlusPlus):
+        case punctuator(Punctuator::MinusMinus):
+        case keyword(Keyword::Sizeof):
+        case keyword(Keyword::Alignof):
+        case punctuator(Punctuator::Amp):
+        case punctuator(Punctuator::Star):
+        case punctuator(Punctuator::Plus):
+        case punctuator(Punctuator::Minus):
+        case punctuator(Punctuator::Tilde):
+        case punctuator(Punctuator::Exclaim):
+            choice17 = 0;
+            break;
+
+        case punctuator(Punctuator::Semi):
+            choice17 = 1;
+            break;
+
+        case keyword(Keyword::Typedef):
+        case keyword(Keyword::Extern):
+        case keyword(Keyword::Static):
+        case keyword(Keyword::ThreadLocal):
+        case keyword(Keyword::Auto):
+        case keyword(Keyword::Register):
+        case keyword(Keyword::Void):
+        case keyword(Keyword::Char):
+        case keyword(Keyword::Short):
+        case keyword(Keyword::Int):
+        case keyword(Keyword::Long):
+        case keyword(Keyword::Float):
+        case keyword(Keyword::Double):
+        case keyword(Keyword::Signed):
+        case keyword(Keyword::Unsigned):
+        case keyword(Keyword::Bool):
+        case keyword(Keyword::Complex):
+        case keyword(Keyword::Struct):
+        case keyword(Keyword::Union):
+        case keyword(Keyword::Enum):
+        case keyword(Keyword::Atomic):
+        case keyword(Keyword::Const):
+        case keyword(Keyword::Restrict):
+        case keyword(Keyword::Volatile):
+        case keyword(Keyword::Inline):
+        case keyword(Keyword::Noreturn):
+        case keyword(Keyword::Alignas):
+        case keyword(Keyword::StaticAssert):
+            choice17 = 2;
+            break;
+
+        case TypedefName:
+            switch (p.la(1))
+            {
+            case punctuator(Punctuator::Comma):
+            case punctuator(Punctuator::LeftBracket):
+            case punctuator(Punctuator::Dot):
+            case punctuator(Punctuator::MinusGreater):
+            case punctuator(Punctuator::PlusPlus):
+            case punctuator(Punctuator::MinusMinus):
+            case punctuator(Punctuator::Amp):
+            case punctuator(Punctuator::Plus):
+            case punctuator(Punctuator::Minus):
+            case punctuator(Punctuator::Slash):
+            case punctuator(Punctuator::Percent):
+            case punctuator(Punctuator::LessLess):
+            case punctuator(Punctuator::GreaterGreater):
+            case punctuator(Punctuator::Less):
+            case punctuator(Punctuator::Greater):
+            case punctuator(Punctuator::LessEqual):
+            case punctuator(Punctuator::GreaterEqual):
+            case punctuator(Punctuator::EqualEqual):
+            case punctuator(Punctuator::ExclaimEqual):
+            case punctuator(Punctuator::Caret):
+            case punctuator(Punctuator::Pipe):
+            case punctuator(Punctuator::AmpAmp):
+            case punctuator(Punctuator::PipePipe):
+            case punctuator(Punctuator::Question):
+            case punctuator(Punctuator::Equal):
+            case punctuator(Punctuator::StarEqual):
+            case punctuator(Punctuator::SlashEqual):
+            case punctuator(Punctuator::PercentEqual):
+            case punctuator(Punctuator::PlusEqual):
+            case punctuator(Punctuator::MinusEqual):
+            case punctuator(Punctuator::LessLessEqual):
+            case punctuator(Punctuator::GreaterGreaterEqual):
+            case punctuator(Punctuator::AmpEqual):
+            case punctuator(Punctuator::CaretEqual):
+            case punctuator(Punctuator::PipeEqual):
+                choice17 = 0;
+                break;
+
+            default:
+                choice17 = 2;
+                break;
+            }
+            break;
+
+        default:
+            p.unexpected(Rule::IterationStatement);
+        }
+
+        switch (choice17)
+        {
+        case 0:
+            children.add(parseExpression());
+            p.expect(punctuator(Punctuator::Semi));
+            switch (p.la(0))
+            {
+            case Identifier:
+            case TypedefName:
+            case Constant:
+            case StringLiteral:
+            case punctuator(Punctuator::LeftParen):
+            case keyword(Keyword::Generic):
+            case punctuator(Punctuator::PlusPlus):
+            case punctuator(Punctuator::MinusMinus):
+            case keyword(Keyword::Sizeof):
+            case keyword(Keyword::Alignof):
+            case punctuator(Punctuator::Amp):
+            case punctuator(Punctuator::Star):
+            case punctuator(Punctuator::Plus):
+            case punctuator(Punctuator::Minus):
+            case punctuator(Punctuator::Tilde):
+            case punctuator(Punctuator::Exclaim):
+                children.add(parseExpression());
+                p.expect(punctuator(Punctuator::Semi));
+                switch (p.la(0))
+                {
+                case Identifier:
+                case TypedefName:
+                case Constant:
+                case StringLiteral:
+                case punctuator(Punctuator::LeftParen):
+                case keyword(Keyword::Generic):
+                case punctuator(Punctuator::PlusPlus):
+                case punctuator(Punctuator::MinusMinus):
+                case keyword(Keyword::Sizeof):
+                case keyword(Keyword::Alignof):
+                case punctuator(Punctuator::Amp):
+                case punctuator(Punctuator::Star):
+                case punctuator(Punctuator::Plus):
+                case punctuator(Punctuator::Minus):
+                case punctuator(Punctuator::Tilde):
+                case punctuator(Punctuator::Exclaim):
+                    children.add(parseExpression());
+                    p.expect(punctuator(Punctuator::RightParen));
+                    children.add(parseStatement());
+                    return p.node(Rule::IterationStatement, 2, children);
+
+                case punctuator(Punctuator::RightParen):
+                    p.advance();
+                    children.add(parseStatement());
+                    return p.node(Rule::IterationStatement, 2, children);
+
+                default:
+                    p.unexpected(Rule::IterationStatement);
+                }
+
+            case punctuator(Punctuator::Semi):
+                p.advance();
+                switch (p.la(0))
+                {
+                case Identifier:
+                case TypedefName:
+                case Constant:
+                case StringLiteral:
+                case punctuator(Punctuator::LeftParen):
+                case keyword(Keyword::Generic):
+                case punctuator(Punctuator::PlusPlus):
+                case punctuator(Punctuator::MinusMinus):
+                case keyword(Keyword::Sizeof):
+                case keyword(Keyword::Alignof):
+                case punctuator(Punctuator::Amp):
+                case punctuator(Punctuator::Star):
+                case punctuator(Punctuator::Plus):
+                case punctuator(Punctuator::Minus):
+                case punctuator(Punctuator::Tilde):
+                case punctuator(Punctuator::Exclaim):
+                    children.add(parseExpression());
+                    p.expect(punctuator(Punctuator::RightParen));
+                    children.add(parseStatement());
+                    return p.node(Rule::IterationStatement, 2, children);
+
+                case punctuator(Punctuator::RightParen):
+                    p.advance();
+                    children.add(parseStatement());
+                    return p.node(Rule::IterationStatement, 2, children);
+
+                default:
+                    p.unexpected(Rule::IterationStatement);
+                }
+
+            default:
+                p.unexpected(Rule::IterationStatement);
+            }
+
+        case 1:
+            p.advance();
+            switch (p.la(0))
+            {
+            case Identifier:
+            case TypedefName:
+            case Constant:
+            case StringLiteral:
+            case punctuator(Punctuator::LeftParen):
+            case keyword(Keyword::Generic):
+            case punctuator(Punctuator::PlusPlus):
+            case punctuator(Punctuator::MinusMinus):
+            case keyword(Keyword::Sizeof):
+            case keyword(Keyword::Alignof):
+            case punctuator(Punctuator::Amp):
+            case punctuator(Punctuator::Star):
+            case punctuator(Punctuator::Plus):
+            case punctuator(Punctuator::Minus):
+            case punctuator(Punctuator::Tilde):
+            case punctuator(Punctuator::Exclaim):
+                children.add(parseExpression());
+                p.expect(punctuator(Punctuator::Semi));
+                switch (p.la(0))
+                {
+                case Identifier:
+                case TypedefName:
+                case Constant:
+                case StringLiteral:
+                case punctuator(Punctuator::LeftParen):
+                case keyword(Keyword::Generic):
+                case punctuator(Punctuator::PlusPlus):
+                case punctuator(Punctuator::MinusMinus):
+                case keyword(Keyword::Sizeof):
+                case keyword(Keyword::Alignof):
+                case punctuator(Punctuator::Amp):
+                case punctuator(Punctuator::Star):
+                case punctuator(Punctuator::Plus):
+                case punctuator(Punctuator::Minus):
+                case punctuator(Punctuator::Tilde):
+                case punctuator(Punctuator::Exclaim):
+                    children.add(parseExpression());
+                    p.expect(punctuator(Punctuator::RightParen));
+                    children.add(parseStatement());
+                    return p.node(Rule::IterationStatement, 2, children);
+
+                case punctuator(Punctuator::RightParen):
+                    p.advance();
+                    children.add(parseStatement());
+                    return p.node(Rule::IterationStatement, 2, children);
+
+                default:
+                    p.unexpected(Rule::IterationStatement);
+                }
+
+            case punctuator(Punctuator::Semi):
+                p.advance();
+                switch (p.la(0))
+                {
+                case Identifier:
+                case TypedefName:
+                case Constant:
+                case StringLiteral:
+                case punctuator(Punctuator::LeftParen):
+                case keyword(Keyword::Generic):
+                case punctuator(Punctuator::PlusPlus):
+                case punctuator(Punctuator::MinusMinus):
+                case keyword(Keyword::Sizeof):
+                case keyword(Keyword::Alignof):
+                case punctuator(Punctuator::Amp):
+                case punctuator(Punctuator::Star):
+                case punctuator(Punctuator::Plus):
+                case punctuator(Punctuator::Minus):
+                case punctuator(Punctuator::Tilde):
+                case punctuator(Punctuator::Exclaim):
+                    children.add(parseExpression());
+                    p.expect(punctuator(Punctuator::RightParen));
+                    children.add(parseStatement());
+                    return p.node(Rule::IterationStatement, 2, children);
+
+                case punctuator(Punctuator::RightParen):
+                    p.advance();
+                    children.add(parseStatement());
+                    return p.node(Rule::IterationStatement, 2, children);
+
+                default:
+                    p.unexpected(Rule::IterationStatement);
+                }
+
+            default:
+                p.unexpected(Rule::IterationStatement);
+            }
+
+        default:
+            children.add(parseDeclaration());
+            switch (p.la(0))
+            {
+            case Identifier:
+            case TypedefName:
+            case Constant:
+            case StringLiteral:
+            case punctuator(Punctuator::LeftParen):
+            case keyword(Keyword::Generic):
+            case punctuator(Punctuator::PlusPlus):
+            case punctuator(Punctuator::MinusMinus):
+            case keyword(Keyword::Sizeof):
+            case keyword(Keyword::Alignof):
+            case punctuator(Punctuator::Amp):
+            case punctuator(Punctuator::Star):
+            case punctuator(Punctuator::Plus):
+            case punctuator(Punctuator::Minus):
+            case punctuator(Punctuator::Tilde):
+            case punctuator(Punctuator::Exclaim):
+                children.add(parseExpression());
+                p.expect(punctuator(Punctuator::Semi));
+                switch (p.la(0))
+                {
+                case Identifier:
+                case TypedefName:
+                case Constant:
+                case StringLiteral:
+                case punctuator(Punctuator::LeftParen):
+                case keyword(Keyword::Generic):
+                case punctuator(Punctuator::PlusPlus):
+                case punctuator(Punctuator::MinusMinus):
+                case keyword(Keyword::Sizeof):
+                case keyword(Keyword::Alignof):
+                case punctuator(Punctuator::Amp):
+                case punctuator(Punctuator::Star):
+                case punctuator(Punctuator::Plus):
+                case punctuator(Punctuator::Minus):
+                case punctuator(Punctuator::Tilde):
+                case punctuator(Punctuator::Exclaim):
+                    children.add(parseExpression());
+                    p.expect(punctuator(Punctuator::RightParen));
+                    children.add(parseStatement());
+                    return p.node(Rule::IterationStatement, 3, children);
+
+                case punctuator(Punctuator::RightParen):
+                    p.advance();
+                    children.add(parseStatement());
+                    return p.node(Rule::IterationStatement, 3, children);
+
+                default:
+                    p.unexpected(Rule::IterationStatement);
+                }
+
+            case punctuator(Punctuator::Semi):
+                p.advance();
+                switch (p.la(0))
+                {
+                case Identifier:
+                case TypedefName:
+                case Constant:
+                case StringLiteral:
+                case punctuator(Punctuator::LeftParen):
+                case keyword(Keyword::Generic):
+                case punctuator(Punctuator::PlusPlus):
+                case punctuator(Punctuator::MinusMinus):
+                case keyword(Keyword::Sizeof):
+                case keyword(Keyword::Alignof):
+                case punctuator(Punctuator::Amp):
+                case punctuator(Punctuator::Star):
+                case punctuator(Punctuator::Plus):
+                case punctuator(Punctuator::Minus):
+                case punctuator(Punctuator::Tilde):
+                case punctuator(Punctuator::Exclaim):
+                    children.add(parseExpression());
+                    p.expect(punctuator(Punctuator::RightParen));
+                    children.add(parseStatement());
+                    return p.node(Rule::IterationStatement, 3, children);
+
+                case punctuator(Punctuator::RightParen):
+                    p.advance();
+                    children.add(parseStatement());
+                    return p.node(Rule::IterationStatement, 3, children);
+
+                default:
+                    p.unexpected(Rule::IterationStatement);
+                }
+
+            default:
+                p.unexpected(Rule::IterationStatement);
+            }
+        }
+
+    default:
+        p.unexpected(Rule::IterationStatement);
+    }
+}
+
+
+ParseNode *CParser::Rules::parseJumpStatement()
+{
+    DepthGuard depth(p);
+    Children children(p.position());
+    switch (p.la(0))
+    {
+    case keyword(Keyword::Goto):
+        p.advance();
+        children.add(p.expectLeaf(Rule::Identifier, Identifier));
+        p.expect(punctuator(Punctuator::Semi));
+        return p.node(Rule::JumpStatement, 0, children);
+
+    case keyword(Keyword::Continue):
+        p.advance();
+        p.expect(punctuator(Punctuator::Semi));
+        return p.node(Rule::JumpStatement, 1, children);
+
+    case keyword(Keyword::Break):
+        p.advance();
+        p.expect(punctuator(Punctuator::Semi));
+        return p.node(Rule::JumpStatement, 2, children);
+
+    case keyword(Keyword::Return):
+        p.advance();
+        switch (p.la(0))
+        {
+        case Identifier:
+        case TypedefName:
+        case Constant:
+        case StringLiteral:
+        case punctuator(Punctuator::LeftParen):
+        case keyword(Keyword::Generic):
+        case punctuator(Punctuator::PlusPlus):
+        case punctuator(Punctuator::MinusMinus):
+        case keyword(Keyword::Sizeof):
+        case keyword(Keyword::Alignof):
+        case punctuator(Punctuator::Amp):
+        case punctuator(Punctuator::Star):
+        case punctuator(Punctuator::Plus):
+        case punctuator(Punctuator::Minus):
+        case punctuator(Punctuator::Tilde):
+        case punctuator(Punctuator::Exclaim):
+            children.add(parseExpression());
+            p.expect(punctuator(Punctuator::Semi));
+            return p.node(Rule::JumpStatement, 3, children);
+
+        case punctuator(Punctuator::Semi):
+            p.advance();
+            return p.node(Rule::JumpStatement, 3, children);
+
+        default:
+            p.unexpected(Rule::JumpStatement);
+        }
+
+    default:
+        p.unexpected(Rule::JumpStatement);
+    }
+}
+
+
+ParseNode *CParser::Rules::parseTranslationUnit()
+{
+    DepthGuard depth(p);
+    ParseNode *node = parseExternalDeclaration();
+    for (;;)
+    {
+        Children children(node);
+        switch (p.la(0))
+        {
+        case TypedefName:
+        case keyword(Keyword::Typedef):
+        case keyword(Keyword::Extern):
+        case keyword(Keyword::Static):
+        case keyword(Keyword::ThreadLocal):
+        case keyword(Keyword::Auto):
+        case keyword(Keyword::Register):
+        case keyword(Keyword::Void):
+        case keyword(Keyword::Char):
+        case keyword(Keyword::Short):
+        case keyword(Keyword::Int):
+        case keyword(Keyword::Long):
+        case keyword(Keyword::Float):
+        case keyword(Keyword::Double):
+        case keyword(Keyword::Signed):
+        case keyword(Keyword::Unsigned):
+        case keyword(Keyword::Bool):
+        case keyword(Keyword::Complex):
+        case keyword(Keyword::Struct):
+        case keyword(Keyword::Union):
+        case keyword(Keyword::Enum):
+        case keyword(Keyword::Atomic):
+        case keyword(Keyword::Const):
+        case keyword(Keyword::Restrict):
+        case keyword(Keyword::Volatile):
+        case keyword(Keyword::Inline):
+        case keyword(Keyword::Noreturn):
+        case keyword(Keyword::Alignas):
+        case keyword(Keyword::StaticAssert):
+            children.add(parseExternalDeclaration());
+            node = p.node(Rule::TranslationUnit, 1, children);
+            continue;
+
+        default:
+            return node;
+        }
+    }
+}
+
+
+ParseNode *CParser::Rules::parseExternalDeclaration()
+{
+    DepthGuard depth(p);
+    Children children(p.position());
+    switch (p.la(0))
+    {
+    case TypedefName:
+    case keyword(Keyword::Typedef):
+    case keyword(Keyword::Extern):
+    case keyword(Keyword::Static):
+    case keyword(Keyword::ThreadLocal):
+    case keyword(Keyword::Auto):
+    case keyword(Keyword::Register):
+    case keyword(Keyword::Void):
+    case keyword(Keyword::Char):
+    case keyword(Keyword::Short):
+    case keyword(Keyword::Int):
+    case keyword(Keyword::Long):
+    case keyword(Keyword::Float):
+    case keyword(Keyword::Double):
+    case keyword(Keyword::Signed):
+    case keyword(Keyword::Unsigned):
+    case keyword(Keyword::Bool):
+    case keyword(Keyword::Complex):
+    case keyword(Keyword::Struct):
+    case keyword(Keyword::Union):
+    case keyword(Keyword::Enum):
+    case keyword(Keyword::Atomic):
+    case keyword(Keyword::Const):
+    case keyword(Keyword::Restrict):
+    case keyword(Keyword::Volatile):
+    case keyword(Keyword::Inline):
+    case keyword(Keyword::Noreturn):
+    case keyword(Keyword::Alignas):
+        children.add(parseDeclarationSpecifiers());
+        switch (p.la(0))
+        {
+        case Identifier:
+        case TypedefName:
+        case punctuator(Punctuator::LeftParen):
+        case punctuator(Punctuator::Star):
+            children.add(parseDeclarator());
+            switch (p.la(0))
+            {
+            case punctuator(Punctuator::Equal):
+                p.advance();
+                children.add(parseInitializer());
+                switch (p.la(0))
+                {
+                case punctuator(Punctuator::Comma):
+                    p.advance();
+                    children.add(parseInitDeclaratorList());
+                    p.expect(punctuator(Punctuator::Semi));
+                    return p.declared(p.node(Rule::ExternalDeclaration, 0, children));
+
+                case punctuator(Punctuator::Semi):
+                    p.advance();
+                    return p.declared(p.node(Rule::ExternalDeclaration, 0, children));
+
+                default:
+                    p.unexpected(Rule::ExternalDeclaration);
+                }
+
+            case punctuator(Punctuator::Comma):
+                p.advance();
+                children.add(parseInitDeclaratorList());
+                p.expect(punctuator(Punctuator::Semi));
+                return p.declared(p.node(Rule::ExternalDeclaration, 0, children));
+
+            case punctuator(Punctuator::Semi):
+                p.advance();
+                return p.declared(p.node(Rule::ExternalDeclaration, 0, children));
+
+            case TypedefName:
+            case keyword(Keyword::Typedef):
+            case keyword(Keyword::Extern):
+            case keyword(Keyword::Static):
+            case keyword(Keyword::ThreadLocal):
+            case keyword(Keyword::Auto):
+            case keyword(Keyword::Register):
+            case keyword(Keyword::Void):
+            case keyword(Keyword::Char):
+            case keyword(Keyword::Short):
+            case keyword(Keyword::Int):
+            case keyword(Keyword::Long):
+            case keyword(Keyword::Float):
+            case keyword(Keyword::Double):
+            case keyword(Keyword::Signed):
+            case keyword(Keyword::Unsigned):
+            case keyword(Keyword::Bool):
+            case keyword(Keyword::Complex):
+            case keyword(Keyword::Struct):
+            case keyword(Keyword::Union):
+            case keyword(Keyword::Enum):
+            case keyword(Keyword::Atomic):
+            case keyword(Keyword::Const):
+            case keyword(Keyword::Restrict):
+            case keyword(Keyword::Volatile):
+            case keyword(Keyword::Inline):
+            case keyword(Keyword::Noreturn):
+            case keyword(Keyword::Alignas):
+            case keyword(Keyword::StaticAssert):
+                children.add(parseDeclarationList());
+                children.add(parseCompoundStatement());
+                return p.declared(p.node(Rule::ExternalDeclaration, 1, children));
+
+            case punctuator(Punctuator::LeftBrace):
+                children.add(parseCompoundStatement());
+                return p.declared(p.node(Rule::ExternalDeclaration, 1, children));
+
+            default:
+                p.unexpected(Rule::ExternalDeclaration);
+            }
+
+        case punctuator(Punctuator::Semi):
+            p.advance();
+            return p.declared(p.node(Rule::ExternalDeclaration, 0, children));
+
+        default:
+            p.unexpected(Rule::ExternalDeclaration);
+        }
+
+    case keyword(Keyword::StaticAssert):
+        children.add(parseStaticAssertDeclaration());
+        return p.declared(children.first);
+
+    default:
+        p.unexpected(Rule::ExternalDeclaration);
+    }
+}
+
+
+ParseNode *CParser::Rules::parseDeclarationList()
+{
+    DepthGuard depth(p);
+    ParseNode *node = parseDeclaration();
+    for (;;)
+    {
+        Children children(node);
+        switch (p.la(0))
+        {
+        case TypedefName:
+        case keyword(Keyword::Typedef):
+        case keyword(Keyword::Extern):
+        case keyword(Keyword::Static):
+        case keyword(Keyword::ThreadLocal):
+        case keyword(Keyword::Auto):
+        case keyword(Keyword::Register):
+        case keyword(Keyword::Void):
+        case keyword(Keyword::Char):
+        case keyword(Keyword::Short):
+        case keyword(Keyword::Int):
+        case keyword(Keyword::Long):
+        case keyword(Keyword::Float):
+        case keyword(Keyword::Double):
+        case keyword(Keyword::Signed):
+        case keyword(Keyword::Unsigned):
+        case keyword(Keyword::Bool):
+        case keyword(Keyword::Complex):
+        case keyword(Keyword::Struct):
+        case keyword(Keyword::Union):
+        case keyword(Keyword::Enum):
+        case keyword(Keyword::Atomic):
+        case keyword(Keyword::Const):
+        case keyword(Keyword::Restrict):
+        case keyword(Keyword::Volatile):
+        case keyword(Keyword::Inline):
+        case keyword(Keyword::Noreturn):
+        case keyword(Keyword::Alignas):
+        case keyword(Keyword::StaticAssert):
+            children.add(parseDeclaration());
+            node = p.node(Rule::DeclarationList, 1, children);
+            continue;
+
+        default:
+            return node;
+        }
+    }
+}
+
+
+//
+// Parse the tokens. Returns nullptr if there aren't any.
+//
+
+ParseNode *CParser::parse()
+{
+    if (la(0) == EndOfFile)
+        return nullptr;
+
+    Rules rules(*this);
+    ParseNode *root = rules.parseTranslationUnit();
+    expect(EndOfFile);
+    tree_.setRoot(root);
+
+    return root;
 }
 
 
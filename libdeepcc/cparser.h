@@ -1,32 +1,194 @@
 #ifndef DEEPC_CPARSER_H
 #define DEEPC_CPARSER_H
 
-
+#include <cstddef>
+#include <cstdint>
+#include <exception>
 #include <string>
-#include <memory>
+
+#include "parserules.h"
+#include "parsetree.h"
+#include "pptokenstream.h"
+#include "typenames.h"
 
 
 namespace deepC
 {
 
 
-// Forward declarations.
-class ProgramDb;
-class CompileArgs;
-
+//
+// The C parser. Most of it is generated from c_syntax.pgen by dcparsergen
+// into cparser.cpp: a recursive descent parser which makes a parse tree
+// of the preprocessed tokens. It doesn't backtrack. Each choice looks at
+// the next token, or the next two, as a terminal, and left recursive
+// definitions are loops. Everything it makes is allocated in the parse
+// tree's arena.
+//
+// An identifier is the TypedefName terminal if it's been declared as a
+// typedef in a scope the parser is in, so the parser declares names as
+// it parses declarations.
+//
 
 class CParser
 {
+public:
+    // What the grammar sees tokens as.
+    enum Terminal : unsigned
+    {
+        EndOfFile,
+        Identifier,
+        TypedefName,
+        Constant,
+        StringLiteral,
+        Other,
+        KeywordBase = 8,
+        PunctuatorBase = KeywordBase + lexTables::numKeywords + 1
+    };
+
+    static constexpr unsigned keyword(Keyword keyword)           { return KeywordBase + static_cast<unsigned>(keyword); }
+    static constexpr unsigned punctuator(Punctuator punctuator)  { return PunctuatorBase + static_cast<unsigned>(punctuator); }
+
+    // How deeply the parsing functions can nest, which stops deeply nested
+    // expressions and declarators running out of stack. Each level of
+    // parentheses in an expression is about twenty.
+    static constexpr int maxDepth = 5000;
+
 private:
-    std::shared_ptr<ProgramDb>  pdb_;
-    const CompileArgs          &args_;
-    const std::string          &sourceFileName_;
-    
+    // The generated parsing functions.
+    class Rules;
+    friend class Rules;
+
+    // The children of a node being made.
+    struct Children
+    {
+        ParseNode *first;
+        ParseNode *last;
+        size_t     token;
+
+        explicit Children(size_t token) : first(nullptr), last(nullptr), token(token) {}
+        explicit Children(ParseNode *node) : first(node), last(node), token(node->token) {}
+
+        void add(ParseNode *node)
+        {
+            if (last != nullptr)
+            {
+                last->next = node;
+            }
+            else
+            {
+                first = node;
+            }
+
+            last = node;
+        }
+    };
+
+    // A scope for typedef names, for as long as it exists.
+    class ScopeGuard
+    {
+        CParser &parser_;
+
+    public:
+        explicit ScopeGuard(CParser &parser) : parser_(parser)  { parser_.typeNames_.pushScope(); parser_.forget(); }
+        ~ScopeGuard()                                           { parser_.typeNames_.popScope(); parser_.forget(); }
+    };
+
+    // How deeply the parsing functions are nested, for as long as one is
+    // running.
+    class DepthGuard
+    {
+        CParser &parser_;
+
+    public:
+        explicit DepthGuard(CParser &parser) : parser_(parser)  { if (++parser_.depth_ > maxDepth) parser_.tooDeep(); }
+        ~DepthGuard()                                           { parser_.depth_--; }
+    };
+
+    const PpTokenStream &tokens_;
+    ParseTree            tree_;
+    TypeNames            typeNames_;
+    size_t               pos_;
+    int                  depth_;
+
+    // The last two tokens looked at and their terminals. Which tokens are
+    // typedef names changes with declarations and scopes, so they're
+    // forgotten then.
+    size_t               laPos_[2];
+    unsigned             la_[2];
+
+    unsigned terminal(size_t i) const;
+    bool     namesDeclarator(size_t i) const;
+    void     forget()                       { laPos_[0] = laPos_[1] = SIZE_MAX; }
+    std::string found() const;
+    SourceLoc   location() const;
+
+    // What the generated code uses.
+    size_t   position() const               { return pos_; }
+    void     advance()                      { pos_++; }
+
+    unsigned la(size_t ahead)
+    {
+        size_t i = pos_ + ahead;
+        size_t slot = i & 1;
+        if (laPos_[slot] != i)
+        {
+            laPos_[slot] = i;
+            la_[slot] = terminal(i);
+        }
+
+        return la_[slot];
+    }
+
+    ParseNode *node(Rule rule, unsigned option, const Children &children)
+    {
+        return tree_.newNode(rule, option, children.token, pos_, children.first);
+    }
+
+    ParseNode *leaf(Rule rule);
+    ParseNode *expectLeaf(Rule rule, unsigned terminal);
+    void       expect(unsigned terminal);
+    ParseNode *declared(ParseNode *declaration);
+    [[noreturn]] void unexpected(Rule rule);
+    [[noreturn]] void tooDeep();
+
+public:
+    explicit CParser(const PpTokenStream &tokens);
+    CParser(const CParser &) = delete;
+    CParser &operator=(const CParser &) = delete;
+
+    // Parse the tokens, returning the tree's root or nullptr if there are
+    // no tokens. Throws a ParserException on a syntax error.
+    ParseNode *parse();
+
+    const ParseTree &tree() const           { return tree_; }
+
+    // How a terminal is written in error messages.
+    static const char *spelling(unsigned terminal);
+};
+
+
+//
+// An exception thrown on a syntax error. It says where in the source the
+// token it's at is.
+//
+
+class ParserException : public std::exception
+{
+    std::string message_;
+    SourceLoc   loc_;
+
 public:
-    CParser(std::shared_ptr<ProgramDb> pdb, const CompileArgs &args, const std::string &sourceFileName);
+    ParserException(const std::string &message, SourceLoc loc) : message_(message), loc_(loc) {}
+
+    SourceLoc loc() const { return loc_; }
+
+    const char * what () const throw ()
+    {
+        return message_.c_str();
+    }
 };
 
 
-}
+} // namespace deepC
 
 #endif // DEEPC_CPARSER_H
@@ -0,0 +1,243 @@
+//
+// The hand written parts of CParser, which the parser generated from
+// c_syntax.pgen in cparser.cpp uses.
+//
+
+#include "cparser.h"
+
+
+namespace deepC
+{
+
+
+//
+// Constructor.
+//
+
+CParser::CParser(const PpTokenStream &tokens) :
+    tokens_(tokens),
+    typeNames_(tree_.arena()),
+    pos_(0),
+    depth_(0)
+{
+    forget();
+}
+
+
+//
+// Get the terminal the grammar sees a token as. Digraphs are the same as
+// the punctuators they stand for.
+//
+
+unsigned CParser::terminal(size_t i) const
+{
+    if (i >= tokens_.size())
+        return EndOfFile;
+
+    switch (tokens_.kind(i))
+    {
+    case TokenKind::EndOfFile:
+        return EndOfFile;
+
+    case TokenKind::Identifier:
+        if (tokens_.subKind(i) != 0)
+            return keyword(static_cast<Keyword>(tokens_.subKind(i)));
+
+        return typeNames_.isTypedefName(tokens_.text(i)) && !namesDeclarator(i) ? TypedefName : Identifier;
+
+    case TokenKind::PpNumber:
+    case TokenKind::CharacterConstant:
+        return Constant;
+
+    case TokenKind::StringLiteral:
+        return StringLiteral;
+
+    case TokenKind::Punctuator:
+        switch (tokens_.punctuator(i))
+        {
+        case Punctuator::LessColon:         return punctuator(Punctuator::LeftBracket);
+        case Punctuator::ColonGreater:      return punctuator(Punctuator::RightBracket);
+        case Punctuator::LessPercent:       return punctuator(Punctuator::LeftBrace);
+        case Punctuator::PercentGreater:    return punctuator(Punctuator::RightBrace);
+        default:                            return punctuator(tokens_.punctuator(i));
+        }
+
+    default:
+        return Other;
+    }
+}
+
+
+//
+// Check if a typedef name can only be the name a declarator declares, as
+// it can't be a type specifier: it follows a pointer or another type
+// specifier, perhaps with type qualifiers in between, as in "int T;",
+// "struct S *const T;" or "T T;". That's how a typedef name is hidden.
+//
+
+bool CParser::namesDeclarator(size_t i) const
+{
+    while (i > 0)
+    {
+        i--;
+        if (tokens_.kind(i) == TokenKind::Punctuator)
+            return tokens_.punctuator(i) == Punctuator::Star;
+
+        if (tokens_.kind(i) != TokenKind::Identifier)
+            return false;
+
+        switch (static_cast<Keyword>(tokens_.subKind(i)))
+        {
+        case Keyword::Const:
+        case Keyword::Restrict:
+        case Keyword::Volatile:
+            break;
+
+        case Keyword::Void:
+        case Keyword::Char:
+        case Keyword::Short:
+        case Keyword::Int:
+        case Keyword::Long:
+        case Keyword::Float:
+        case Keyword::Double:
+        case Keyword::Signed:
+        case Keyword::Unsigned:
+        case Keyword::Bool:
+        case Keyword::Complex:
+            return true;
+
+        default:
+            if (tokens_.subKind(i) != 0)
+                return false;
+
+            // A tag.
+            if (i > 0 && tokens_.kind(i - 1) == TokenKind::Identifier)
+            {
+                switch (static_cast<Keyword>(tokens_.subKind(i - 1)))
+                {
+                case Keyword::Struct:
+                case Keyword::Union:
+                case Keyword::Enum:
+                    return true;
+
+                default:
+                    break;
+                }
+            }
+
+            // A typedef name which is the type specifier, as in "T T;".
+            return typeNames_.isTypedefName(tokens_.text(i)) && !namesDeclarator(i);
+        }
+    }
+
+    return false;
+}
+
+
+//
+// Describe the next token for an error message, and say where it is. The
+// end of the file is where the last token is.
+//
+
+std::string CParser::found() const
+{
+    if (pos_ >= tokens_.size())
+        return "end of file";
+
+    return "'" + std::string(tokens_.text(pos_)) + "'";
+}
+
+
+SourceLoc CParser::location() const
+{
+    if (tokens_.empty())
+        return SourceLoc();
+
+    return tokens_.expansionLoc(pos_ < tokens_.size() ? pos_ : tokens_.size() - 1);
+}
+
+
+//
+// Make a leaf of the next token. Adjacent string literals are a single
+// leaf, as they're concatenated.
+//
+
+ParseNode *CParser::leaf(Rule rule)
+{
+    size_t first = pos_++;
+    if (rule == Rule::StringLiteral)
+    {
+        while (pos_ < tokens_.size() && tokens_.kind(pos_) == TokenKind::StringLiteral)
+        {
+            pos_++;
+        }
+    }
+
+    return tree_.newNode(rule, 0, first, pos_, nullptr);
+}
+
+
+//
+// Take the next token, which must be a terminal, or one it can stand for:
+// a typedef name can be used as an identifier wherever the grammar says
+// identifier, like a member name.
+//
+
+void CParser::expect(unsigned terminal)
+{
+    unsigned next = la(0);
+    if (next == terminal || (terminal == Identifier && next == TypedefName))
+    {
+        pos_++;
+        return;
+    }
+
+    throw ParserException(std::string("expected ") + spelling(terminal) + " but found " + found(), location());
+}
+
+
+ParseNode *CParser::expectLeaf(Rule rule, unsigned terminal)
+{
+    unsigned next = la(0);
+    if (next != terminal && !(terminal == Identifier && next == TypedefName))
+    {
+        expect(terminal);
+    }
+
+    return leaf(rule);
+}
+
+
+//
+// Declare the names a declaration declares once it's been parsed, so the
+// following tokens are seen in its light.
+//
+
+ParseNode *CParser::declared(ParseNode *declaration)
+{
+    typeNames_.declare(declaration, tokens_);
+    forget();
+
+    return declaration;
+}
+
+
+void CParser::unexpected(Rule rule)
+{
+    throw ParserException("unexpected " + found() + " in " + ruleName(rule), location());
+}
+
+
+//
+// Give up on source which is nested too deeply. The guard which found it
+// didn't finish being made, so it won't undo its count.
+//
+
+void CParser::tooDeep()
+{
+    depth_--;
+    throw ParserException("nested too deeply at " + found(), location());
+}
+
+
+} // namespace deepC
@@ -0,0 +1,284 @@
+/* The edit script is found using Myers' solution to SES/LCS with the
+ * Hirschberg linear space refinement, as described in:
+ *
+ *   E. Myers, ``An O(ND) Difference Algorithm and Its Variations,''
+ *   Algorithmica 1, 2 (1986), 251-266.
+ *
+ * It's based on diff.c from libmba:
+ *
+ * Copyright (c) 2004 Michael B. Allen <mba2000 ioplex.com>
+ *
+ * The MIT License
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included
+ * in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR
+ * OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE,
+ * ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#include <cstring>
+
+#include "diff.h"
+
+
+namespace deepC
+{
+
+
+//
+// Finds the middle snake, the diagonal run in the middle of the shortest
+// edit script, by searching forward from the start and backward from the
+// end at the same time until the two searches meet. Returns the cost of
+// the edit script, or -1 if it's more than maxCost_.
+//
+
+ssize_t Diff::findMiddleSnake(size_t aoff, ssize_t alen, size_t boff, ssize_t blen, MiddleSnake *ms)
+{
+    const char *a = a_.data() + aoff;
+    const char *b = b_.data() + boff;
+    ssize_t delta = alen - blen;
+    bool odd = (delta & 1) != 0;
+    ssize_t mid = (alen + blen) / 2 + (odd ? 1 : 0);
+
+    fwd(1) = 0;
+    rev(delta - 1) = alen;
+
+    for (ssize_t d = 0; d <= mid; d++)
+    {
+        if (d > 0 && static_cast<size_t>(2 * d - 1) > maxCost_)
+            return -1;
+
+        // Extend the forward paths.
+        for (ssize_t k = d; k >= -d; k -= 2)
+        {
+            ssize_t x;
+            if (k == -d || (k != d && fwd(k - 1) < fwd(k + 1)))
+            {
+                x = fwd(k + 1);
+            }
+            else
+            {
+                x = fwd(k - 1) + 1;
+            }
+
+            ssize_t y = x - k;
+            ms->x = x;
+            ms->y = y;
+            while (x < alen && y < blen && a[x] == b[y])
+            {
+                x++;
+                y++;
+            }
+
+            fwd(k) = x;
+
+            if (odd && k >= delta - (d - 1) && k <= delta + (d - 1) && x >= rev(k))
+            {
+                ms->u = x;
+                ms->v = y;
+                return 2 * d - 1;
+            }
+        }
+
+        // Extend the reverse paths.
+        for (ssize_t k = d; k >= -d; k -= 2)
+        {
+            ssize_t kr = delta + k;
+            ssize_t x;
+            if (k == d || (k != -d && rev(kr - 1) < rev(kr + 1)))
+            {
+                x = rev(kr - 1);
+            }
+            else
+            {
+                x = rev(kr + 1) - 1;
+            }
+
+            ssize_t y = x - kr;
+            ms->u = x;
+            ms->v = y;
+            while (x > 0 && y > 0 && a[x - 1] == b[y - 1])
+            {
+                x--;
+                y--;
+            }
+
+            rev(kr) = x;
+
+            if (!odd && kr >= -d && kr <= d && x <= fwd(kr))
+            {
+                ms->x = x;
+                ms->y = y;
+                return 2 * d;
+            }
+        }
+    }
+
+    return -1;
+}
+
+
+//
+// Add an edit to the script, or lengthen the last one if it's the same
+// kind of edit.
+//
+
+void Diff::edit(DiffEdit::Op op, size_t offset, size_t length)
+{
+    if (length == 0)
+        return;
+
+    if (!edits_->empty() && edits_->back().op() == op)
+    {
+        edits_->back().addLength(length);
+    }
+    else
+    {
+        edits_->push_back(DiffEdit(op, offset, length));
+    }
+}
+
+
+//
+// Find the edit script for part of the texts by splitting it at its
+// middle snake and solving each side. Returns the cost of the script or
+// -1 if it's too expensive.
+//
+
+ssize_t Diff::findEditSequence(size_t aoff, ssize_t alen, size_t boff, ssize_t blen)
+{
+    if (alen == 0)
+    {
+        edit(DiffEdit::Op::Insert, boff, blen);
+        return blen;
+    }
+
+    if (blen == 0)
+    {
+        edit(DiffEdit::Op::Delete, aoff, alen);
+        return alen;
+    }
+
+    MiddleSnake ms;
+    ssize_t d = findMiddleSnake(aoff, alen, boff, blen, &ms);
+    if (d < 0)
+        return -1;
+
+    if (d > 1)
+    {
+        // Solve each side of the middle snake.
+        if (findEditSequence(aoff, ms.x, boff, ms.y) < 0)
+            return -1;
+
+        edit(DiffEdit::Op::Match, aoff + ms.x, ms.u - ms.x);
+
+        if (findEditSequence(aoff + ms.u, alen - ms.u, boff + ms.v, blen - ms.v) < 0)
+            return -1;
+    }
+    else if (blen > alen)
+    {
+        // One character was inserted, either before or after the snake.
+        if (ms.x == ms.u)
+        {
+            edit(DiffEdit::Op::Match, aoff, alen);
+            edit(DiffEdit::Op::Insert, boff + blen - 1, 1);
+        }
+        else
+        {
+            edit(DiffEdit::Op::Insert, boff, 1);
+            edit(DiffEdit::Op::Match, aoff, alen);
+        }
+    }
+    else
+    {
+        // One character was deleted.
+        if (ms.x == ms.u)
+        {
+            edit(DiffEdit::Op::Match, aoff, blen);
+            edit(DiffEdit::Op::Delete, aoff + alen - 1, 1);
+        }
+        else
+        {
+            edit(DiffEdit::Op::Delete, aoff, 1);
+            edit(DiffEdit::Op::Match, aoff + 1, blen);
+        }
+    }
+
+    return d;
+}
+
+
+//
+// Find the shortest edit script from the old text to the new one.
+//
+
+ssize_t Diff::diff(std::vector<DiffEdit> *edits)
+{
+    edits_ = edits;
+    edits_->clear();
+
+    // Match the common start and end directly. This is the whole job when
+    // the texts are the same and most of it when there's one small change.
+    // Blocks are compared with memcmp() first since it's much faster than
+    // comparing a byte at a time.
+    const size_t block = 64;
+    size_t size = a_.size() < b_.size() ? a_.size() : b_.size();
+    size_t prefix = 0;
+    while (prefix + block <= size && memcmp(a_.data() + prefix, b_.data() + prefix, block) == 0)
+    {
+        prefix += block;
+    }
+
+    while (prefix < size && a_[prefix] == b_[prefix])
+    {
+        prefix++;
+    }
+
+    size_t suffix = 0;
+    while (suffix + block <= size - prefix && memcmp(a_.data() + a_.size() - suffix - block, b_.data() + b_.size() - suffix - block, block) == 0)
+    {
+        suffix += block;
+    }
+
+    while (suffix < size - prefix && a_[a_.size() - 1 - suffix] == b_[b_.size() - 1 - suffix])
+    {
+        suffix++;
+    }
+
+    ssize_t alen = static_cast<ssize_t>(a_.size() - prefix - suffix);
+    ssize_t blen = static_cast<ssize_t>(b_.size() - prefix - suffix);
+    ssize_t lengthDifference = alen > blen ? alen - blen : blen - alen;
+    if (static_cast<size_t>(lengthDifference) > maxCost_)
+    {
+        edits_->clear();
+        return -1;
+    }
+
+    edit(DiffEdit::Op::Match, 0, prefix);
+    ssize_t cost = findEditSequence(prefix, alen, prefix, blen);
+    if (cost < 0)
+    {
+        edits_->clear();
+        return -1;
+    }
+
+    edit(DiffEdit::Op::Match, a_.size() - suffix, suffix);
+
+    return cost;
+}
+
+
+} // namespace deepC
@@ -0,0 +1,113 @@
+#ifndef DEEPC_DIFF_H
+#define DEEPC_DIFF_H
+
+#include <cstddef>
+#include <string_view>
+#include <vector>
+#include <sys/types.h>
+
+
+namespace deepC
+{
+
+
+//
+// One run of a shortest edit script. Matches and deletions are offsets
+// into the old text, insertions are offsets into the new text.
+//
+
+class DiffEdit
+{
+public:
+    enum class Op
+    {
+        Match = 1,
+        Delete,
+        Insert
+    };
+
+private:
+    Op     op_;
+    size_t offset_;
+    size_t length_;
+
+public:
+    DiffEdit(Op op, size_t offset, size_t length) : op_(op), offset_(offset), length_(length) {}
+
+    Op     op() const     { return op_; }
+    size_t offset() const { return offset_; }
+    size_t length() const { return length_; }
+    void   addLength(size_t add) { length_ += add; }
+};
+
+
+//
+// Computes the shortest edit script which turns one text into another,
+// using Myers' O(ND) algorithm with the linear space refinement. This is
+// the same algorithm GNU diff uses.
+//
+// The work is proportional to the size of the texts times the number of
+// differences, so a limit can be put on how many differences are worth
+// finding. Text which is the same at the start and end of both texts is
+// matched directly first, so a small change to a big file is cheap.
+//
+
+class Diff
+{
+public:
+    // No limit on the cost of the edit script.
+    static constexpr size_t unlimited = static_cast<size_t>(-1);
+
+private:
+    // Where a middle snake starts and ends.
+    struct MiddleSnake
+    {
+        ssize_t x, y, u, v;
+    };
+
+    std::string_view      a_;
+    std::string_view      b_;
+    size_t                maxCost_;
+
+    // The furthest reaching paths on each diagonal. Diagonals can be
+    // negative so they're split into positive and negative halves, which
+    // only grow as far as the cost of the edit script.
+    std::vector<ssize_t>  forward_[2];
+    std::vector<ssize_t>  reverse_[2];
+    std::vector<DiffEdit> *edits_;
+
+private:
+    static ssize_t &diagonal(std::vector<ssize_t> *halves, ssize_t k)
+    {
+        std::vector<ssize_t> &v = halves[k < 0 ? 1 : 0];
+        size_t i = static_cast<size_t>(k < 0 ? -k : k);
+        if (i >= v.size())
+        {
+            v.resize(i + 1);
+        }
+
+        return v[i];
+    }
+
+    ssize_t &fwd(ssize_t k) { return diagonal(forward_, k); }
+    ssize_t &rev(ssize_t k) { return diagonal(reverse_, k); }
+
+    ssize_t findMiddleSnake(size_t aoff, ssize_t alen, size_t boff, ssize_t blen, MiddleSnake *ms);
+    ssize_t findEditSequence(size_t aoff, ssize_t alen, size_t boff, ssize_t blen);
+    void    edit(DiffEdit::Op op, size_t offset, size_t length);
+
+public:
+    Diff(std::string_view a, std::string_view b) : a_(a), b_(b), maxCost_(unlimited), edits_(nullptr) {}
+
+    // Give up if more than this many characters are inserted and deleted.
+    void    setMaxCost(size_t maxCost) { maxCost_ = maxCost; }
+
+    // Find the edits. Returns how many characters were inserted and
+    // deleted, or -1 if that's more than the maximum cost.
+    ssize_t diff(std::vector<DiffEdit> *edits);
+};
+
+
+} // namespace deepC
+
+#endif // DEEPC_DIFF_H
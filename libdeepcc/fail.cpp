@@ -22,11 +22,11 @@ static void msgfv(const SourcePos &pos, const char *format, va_list args)
 {
     if (pos.exists())
     {
-        std::cout << "::: ";
+        std::cout << pos.fileName() << ":" << pos.line() << ":" << pos.column() << ": ";
     }
     else
     {
-        std::cout << pos.fileName() << ":" << pos.line() << ":" << pos.column() << ": ";
+        std::cout << "::: ";
     }
 
     char line[maxErrorLine];
@@ -0,0 +1,150 @@
+#include <algorithm>
+#include <cstring>
+#include <iterator>
+
+#include "hideset.h"
+#include "contenthash.h"
+
+
+namespace deepC
+{
+
+
+//
+// See whether a set has an id in it. Most sets only have a few.
+//
+
+bool HideSet::contains(Interner::Id id) const
+{
+    if (size <= 8)
+        return std::find(ids, ids + size, id) != ids + size;
+
+    return std::binary_search(ids, ids + size, id);
+}
+
+
+bool HideSetTable::SetEqual::operator()(const HideSet *a, const HideSet *b) const
+{
+    return a->size == b->size && std::equal(a->ids, a->ids + a->size, b->ids);
+}
+
+
+//
+// Get the one set with some sorted ids in it, making it if it's new.
+//
+
+const HideSet *HideSetTable::make(const std::vector<Interner::Id> &ids)
+{
+    if (ids.empty())
+        return nullptr;
+
+    HideSet probe;
+    probe.ids = ids.data();
+    probe.size = static_cast<uint32_t>(ids.size());
+    probe.index = 0;
+    probe.hash = xxHash64(ids.data(), ids.size() * sizeof(Interner::Id));
+    auto it = unique_.find(&probe);
+    if (it != unique_.end())
+        return *it;
+
+    Interner::Id *copy = static_cast<Interner::Id *>(ids_.allocate(ids.size() * sizeof(Interner::Id), alignof(Interner::Id)));
+    memcpy(copy, ids.data(), ids.size() * sizeof(Interner::Id));
+    probe.ids = copy;
+    probe.index = static_cast<uint32_t>(sets_.size() + 1);
+    sets_.push_back(probe);
+    unique_.insert(&sets_.back());
+    return &sets_.back();
+}
+
+
+//
+// Get a set with another id in it.
+//
+
+const HideSet *HideSetTable::add(const HideSet *set, Interner::Id id)
+{
+    if (!set)
+    {
+        scratch_.assign(1, id);
+        return make(scratch_);
+    }
+
+    uint64_t k = (uint64_t(set->index) << 32) | id;
+    auto it = added_.find(k);
+    if (it != added_.end())
+        return it->second;
+
+    const HideSet *result = set;
+    if (!set->contains(id))
+    {
+        scratch_.assign(set->ids, set->ids + set->size);
+        scratch_.insert(std::lower_bound(scratch_.begin(), scratch_.end(), id), id);
+        result = make(scratch_);
+    }
+
+    added_.emplace(k, result);
+    return result;
+}
+
+
+//
+// Get the union of two sets.
+//
+
+const HideSet *HideSetTable::unite(const HideSet *a, const HideSet *b)
+{
+    if (!a || a == b)
+        return b;
+
+    if (!b)
+        return a;
+
+    if (a->index > b->index)
+    {
+        std::swap(a, b);
+    }
+
+    uint64_t k = key(a, b);
+    auto it = united_.find(k);
+    if (it != united_.end())
+        return it->second;
+
+    scratch_.clear();
+    std::set_union(a->ids, a->ids + a->size, b->ids, b->ids + b->size, std::back_inserter(scratch_));
+    const HideSet *result = make(scratch_);
+    united_.emplace(k, result);
+    return result;
+}
+
+
+//
+// Get the intersection of two sets.
+//
+
+const HideSet *HideSetTable::intersect(const HideSet *a, const HideSet *b)
+{
+    if (!a || !b)
+        return nullptr;
+
+    if (a == b)
+        return a;
+
+    if (a->index > b->index)
+    {
+        std::swap(a, b);
+    }
+
+    uint64_t k = key(a, b);
+    auto it = intersected_.find(k);
+    if (it != intersected_.end())
+        return it->second;
+
+    scratch_.clear();
+    std::set_intersection(a->ids, a->ids + a->size, b->ids, b->ids + b->size, std::back_inserter(scratch_));
+    const HideSet *result = make(scratch_);
+    intersected_.emplace(k, result);
+    return result;
+}
+
+
+} // namespace deepC
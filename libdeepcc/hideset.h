@@ -0,0 +1,96 @@
+#ifndef DEEPC_HIDESET_H
+#define DEEPC_HIDESET_H
+
+#include <cstdint>
+#include <deque>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+#include "arena.h"
+#include "interner.h"
+
+
+namespace deepC
+{
+
+
+//
+// The set of macros which made a token during macro expansion, which
+// mustn't expand it again. The ids are sorted. Sets are only made by a
+// HideSetTable, which makes just one of each, so two tokens with the same
+// hide set share it and sets can be compared by address. The empty set
+// is nullptr.
+//
+
+struct HideSet
+{
+    const Interner::Id *ids;
+    uint32_t            size;
+    uint32_t            index;      // Where it is in the table, from 1.
+    uint64_t            hash;
+
+    bool contains(Interner::Id id) const;
+};
+
+
+//
+// Makes hide sets. Expanding a macro gives every token of the expansion
+// the same hide set, and the same few sets come up again and again in
+// macro heavy code, so the results of adding to, uniting and intersecting
+// sets are kept rather than being worked out each time.
+//
+// Sets last as long as the table. It isn't thread safe.
+//
+
+class HideSetTable
+{
+private:
+    struct SetHash
+    {
+        size_t operator()(const HideSet *set) const { return set->hash; }
+    };
+
+    struct SetEqual
+    {
+        bool operator()(const HideSet *a, const HideSet *b) const;
+    };
+
+    Arena                                                  ids_;
+    std::deque<HideSet>                                    sets_;
+    std::unordered_set<const HideSet *, SetHash, SetEqual> unique_;
+    std::vector<Interner::Id>                              scratch_;
+
+    // The results of operations, by the indexes of their operands.
+    std::unordered_map<uint64_t, const HideSet *>          added_;
+    std::unordered_map<uint64_t, const HideSet *>          united_;
+    std::unordered_map<uint64_t, const HideSet *>          intersected_;
+
+private:
+    const HideSet *make(const std::vector<Interner::Id> &ids);
+
+    static uint64_t key(const HideSet *a, const HideSet *b) { return (uint64_t(a->index) << 32) | b->index; }
+
+public:
+    HideSetTable() : ids_(16 * 1024) {}
+    HideSetTable(const HideSetTable &) = delete;
+    HideSetTable &operator=(const HideSetTable &) = delete;
+
+    // Get a set with another id in it.
+    const HideSet *add(const HideSet *set, Interner::Id id);
+
+    // Get the union or the intersection of two sets.
+    const HideSet *unite(const HideSet *a, const HideSet *b);
+    const HideSet *intersect(const HideSet *a, const HideSet *b);
+
+    // See whether a set, which may be empty, has an id in it.
+    static bool contains(const HideSet *set, Interner::Id id) { return set && set->contains(id); }
+
+    // The number of different sets made.
+    size_t size() const { return sets_.size(); }
+};
+
+
+} // namespace deepC
+
+#endif // DEEPC_HIDESET_H
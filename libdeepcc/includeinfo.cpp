@@ -0,0 +1,278 @@
+#include "includeinfo.h"
+#include "programdb.h"
+#include "flatbuffers/flatbuffers.h"
+#include "storedobject_generated.h"
+
+
+namespace deepC
+{
+
+
+//
+// A preprocessing directive: a '#' at the start of a line, and the rest
+// of the tokens on the line.
+//
+
+struct Directive
+{
+    size_t           hash;      // The index of the '#'.
+    size_t           end;       // One past the last token on the line.
+    std::string_view name;      // Empty if there isn't one.
+};
+
+
+static bool isHash(const TokenStream &tokens, size_t i)
+{
+    Punctuator punct = tokens.punctuator(i);
+    return punct == Punctuator::Hash || punct == Punctuator::PercentColon;
+}
+
+
+static std::vector<Directive> findDirectives(const TokenStream &tokens, std::string_view text)
+{
+    std::vector<Directive> directives;
+    size_t size = tokens.size();
+    size_t i = 0;
+    while (i < size)
+    {
+        if ((tokens.flags(i) & Token::StartOfLine) && isHash(tokens, i))
+        {
+            Directive directive;
+            directive.hash = i;
+            directive.end = i + 1;
+            while (directive.end < size && !(tokens.flags(directive.end) & Token::StartOfLine))
+            {
+                directive.end++;
+            }
+
+            if (i + 1 < directive.end && tokens.kind(i + 1) == TokenKind::Identifier)
+            {
+                directive.name = tokens.text(i + 1, text);
+            }
+
+            directives.push_back(directive);
+            i = directive.end;
+        }
+        else
+        {
+            i++;
+        }
+    }
+
+    return directives;
+}
+
+
+//
+// How a directive changes the nesting of conditionals.
+//
+
+static int nesting(const Directive &directive)
+{
+    if (directive.name == "if" || directive.name == "ifdef" || directive.name == "ifndef")
+        return 1;
+
+    if (directive.name == "endif")
+        return -1;
+
+    return 0;
+}
+
+
+//
+// Get the macro an opening guard directive tests, either "#ifndef X",
+// "#if !defined X" or "#if !defined(X)". Returns an empty string if it's
+// not one of those.
+//
+
+static std::string_view guardTest(const TokenStream &tokens, std::string_view text, const Directive &directive)
+{
+    size_t first = directive.hash + 2;
+    size_t count = directive.end - first;
+    if (directive.name == "ifndef" && count == 1 && tokens.kind(first) == TokenKind::Identifier)
+        return tokens.text(first, text);
+
+    if (directive.name == "if" && (count == 3 || count == 5) &&
+        tokens.punctuator(first) == Punctuator::Exclaim &&
+        tokens.text(first + 1, text) == "defined")
+    {
+        if (count == 3 && tokens.kind(first + 2) == TokenKind::Identifier)
+            return tokens.text(first + 2, text);
+
+        if (count == 5 && tokens.punctuator(first + 2) == Punctuator::LeftParen &&
+            tokens.kind(first + 3) == TokenKind::Identifier &&
+            tokens.punctuator(first + 4) == Punctuator::RightParen)
+            return tokens.text(first + 3, text);
+    }
+
+    return std::string_view();
+}
+
+
+//
+// Work out what the file includes and how it's guarded from its tokens.
+//
+// A file has an IfndefGuard if its first tokens are a #ifndef X followed
+// straight away by #define X, and the matching #endif is its last line.
+// Since comments aren't tokens they can be anywhere.
+//
+
+void IncludeInfo::scan(const TokenStream &tokens, std::string_view text)
+{
+    guard_ = Guard::None;
+    guardMacro_.clear();
+    includes_.clear();
+
+    std::vector<Directive> directives = findDirectives(tokens, text);
+
+    // Look for a guard around the whole file.
+    if (directives.size() >= 3 && directives[0].hash == 0)
+    {
+        std::string_view macro = guardTest(tokens, text, directives[0]);
+        const Directive &define = directives[1];
+        if (!macro.empty() && define.hash == directives[0].end && define.name == "define" &&
+            define.hash + 2 < define.end && tokens.text(define.hash + 2, text) == macro)
+        {
+            // Find the #endif which closes it.
+            int depth = 0;
+            for (size_t i = 0; i < directives.size(); i++)
+            {
+                depth += nesting(directives[i]);
+                if (depth == 1 && (directives[i].name == "else" || directives[i].name == "elif"))
+                    break;
+
+                if (depth == 0)
+                {
+                    if (i == directives.size() - 1 && directives[i].end == tokens.size())
+                    {
+                        guard_ = Guard::IfndefGuard;
+                        guardMacro_ = std::string(macro);
+                    }
+
+                    break;
+                }
+            }
+        }
+    }
+
+    int depth = 0;
+    for (const Directive &directive : directives)
+    {
+        depth += nesting(directive);
+        size_t first = directive.hash + 2;
+        if (directive.name == "pragma" && depth == 0 && first < directive.end &&
+            tokens.text(first, text) == "once")
+        {
+            guard_ = Guard::PragmaOnce;
+            guardMacro_.clear();
+        }
+        else if (directive.name == "include" && first < directive.end)
+        {
+            Include include;
+            include.angled = false;
+            include.computed = false;
+            std::string_view operand = tokens.text(first, text);
+            if (first + 1 == directive.end && tokens.kind(first) == TokenKind::StringLiteral && operand.front() == '"')
+            {
+                include.name = std::string(operand.substr(1, operand.size() - 2));
+            }
+            else
+            {
+                // The lexer doesn't know about header names so <name> comes
+                // out as several tokens.
+                size_t greater = first + 1;
+                while (greater < directive.end && tokens.punctuator(greater) != Punctuator::Greater)
+                {
+                    greater++;
+                }
+
+                if (tokens.punctuator(first) == Punctuator::Less && greater + 1 == directive.end)
+                {
+                    include.name = std::string(text.substr(tokens.offset(first) + 1, tokens.offset(greater) - tokens.offset(first) - 1));
+                    include.angled = true;
+                }
+                else
+                {
+                    size_t last = directive.end - 1;
+                    include.name = std::string(text.substr(tokens.offset(first), tokens.offset(last) + tokens.length(last) - tokens.offset(first)));
+                    include.computed = true;
+                }
+            }
+
+            includes_.push_back(include);
+        }
+    }
+}
+
+
+//
+// Serialise the content of this object so it can be stored in the database.
+//
+
+void IncludeInfo::serialiseContent(flatbuffers::FlatBufferBuilder &builder) const
+{
+    std::vector<flatbuffers::Offset<fb::Include>> includes;
+    for (const Include &include : includes_)
+    {
+        includes.push_back(fb::CreateInclude(builder, builder.CreateString(include.name), include.angled, include.computed));
+    }
+
+    auto includesVec = builder.CreateVector(includes);
+    auto guardMacro = builder.CreateString(guardMacro_);
+    fb::Digest digest(digest_.hash, digest_.size);
+    auto info = fb::CreateIncludeInfo(builder, sourceFileId_, &digest, static_cast<uint8_t>(guard_), guardMacro, includesVec);
+    fb::FinishStoredObjectBuffer(builder, fb::CreateStoredObject(builder, fb::StoredAny_IncludeInfo, info.Union()));
+}
+
+
+//
+// Serialise the key of this object so it can be found in the database.
+//
+
+void IncludeInfo::serialiseKey(flatbuffers::FlatBufferBuilder &builder) const
+{
+    serialiseKey(builder, sourceFileId_);
+}
+
+
+//
+// Serialise the key for the include information of a given source file.
+//
+
+void IncludeInfo::serialiseKey(flatbuffers::FlatBufferBuilder &builder, uint32_t sourceFileId)
+{
+    auto idKey = fb::CreateIdKey(builder, sourceFileId);
+    fb::FinishStoredObjectBuffer(builder, fb::CreateStoredObject(builder, fb::StoredAny_IdKey, idKey.Union()));
+}
+
+
+//
+// Fill out this object from a database serialised form.
+//
+
+void IncludeInfo::unserialise(const fb::StoredObject &so)
+{
+    const fb::IncludeInfo *info = so.obj_as_IncludeInfo();
+    sourceFileId_ = info->source_file();
+    if (info->digest())
+    {
+        digest_ = ContentDigest(info->digest()->hash(), info->digest()->size());
+    }
+
+    guard_ = static_cast<Guard>(info->guard());
+    if (guard_ > Guard::PragmaOnce)
+        throw ProgramDbException("the include information of source file " + std::to_string(sourceFileId_) + " is damaged");
+
+    guardMacro_ = info->guard_macro() ? info->guard_macro()->str() : std::string();
+    includes_.clear();
+    if (info->includes())
+    {
+        for (const fb::Include *include : *info->includes())
+        {
+            includes_.push_back(Include{ include->name() ? include->name()->str() : std::string(), include->angled(), include->computed() });
+        }
+    }
+}
+
+
+} // namespace deepC
@@ -0,0 +1,87 @@
+#ifndef DEEPC_INCLUDEINFO_H
+#define DEEPC_INCLUDEINFO_H
+
+#include <memory>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "storable.h"
+#include "tokenstream.h"
+
+
+namespace deepC
+{
+
+
+//
+// What a source file includes and how it guards against being included
+// twice, as stored in the program database. Together these records make
+// up the program's include graph.
+//
+// It's worked out from the file's tokens by scan() and stored along with
+// the digest of the text it came from, so an unchanged header never has
+// to be read or scanned again to find out whether including it a second
+// time can be skipped.
+//
+
+class IncludeInfo : public Storable
+{
+public:
+    // How a header protects itself from being included more than once.
+    enum class Guard : uint8_t
+    {
+        None,
+        IfndefGuard,    // The whole file is inside #ifndef X / #define X ... #endif.
+        PragmaOnce      // It has a #pragma once outside any conditional.
+    };
+
+    // An #include directive.
+    struct Include
+    {
+        std::string name;       // The header name without its quotes or brackets.
+        bool        angled;     // It's a <name> rather than a "name".
+        bool        computed;   // It's made by macros, and name is the text of the directive.
+
+        bool operator==(const Include &other) const { return name == other.name && angled == other.angled && computed == other.computed; }
+    };
+
+private:
+    uint32_t             sourceFileId_;     // The SourceFile this describes.
+    ContentDigest        digest_;           // The text it was scanned from.
+    Guard                guard_;
+    std::string          guardMacro_;       // The macro of an IfndefGuard.
+    std::vector<Include> includes_;         // In the order they appear.
+
+public:
+    // Constructors.
+    explicit IncludeInfo(uint32_t sourceFileId, const ContentDigest &digest) : sourceFileId_(sourceFileId), digest_(digest), guard_(Guard::None) {}
+    explicit IncludeInfo(uint32_t id, const std::shared_ptr<ProgramDbSnapshot> &) : Storable(id), sourceFileId_(0), guard_(Guard::None) {}
+
+    // Fill this out from the tokens of the source text.
+    void scan(const TokenStream &tokens, std::string_view text);
+
+    // Accessors.
+    uint32_t                    sourceFileId() const { return sourceFileId_; }
+    const ContentDigest        &digest() const       { return digest_; }
+    Guard                       guard() const        { return guard_; }
+    const std::string          &guardMacro() const   { return guardMacro_; }
+    const std::vector<Include> &includes() const     { return includes_; }
+
+    // Which databases to use for the content and the key mapping.
+    DbGroup contentDbGroup() const override { return Storable::DbGroup::IncludeInfos; }
+    DbGroup keyDbGroup() const override     { return Storable::DbGroup::IncludeInfoKeys; }
+
+    // To store this type in the database.
+    void serialiseContent(flatbuffers::FlatBufferBuilder &builder) const override;
+    void serialiseKey(flatbuffers::FlatBufferBuilder &builder) const override;
+    void unserialise(const fb::StoredObject &so) override;
+
+    // Serialise the key for a source file, to look it up without an object.
+    static void serialiseKey(flatbuffers::FlatBufferBuilder &builder, uint32_t sourceFileId);
+};
+
+
+} // namespace deepC
+
+#endif // DEEPC_INCLUDEINFO_H
@@ -0,0 +1,307 @@
+#include <sys/stat.h>
+
+#include "includeresolver.h"
+#include "contenthash.h"
+#include "programdb.h"
+#include "flatbuffers/flatbuffers.h"
+#include "storedobject_generated.h"
+
+
+namespace deepC
+{
+
+
+//
+// Serialise the content of this object so it can be stored in the database.
+//
+
+void IncludeResolution::serialiseContent(flatbuffers::FlatBufferBuilder &builder) const
+{
+    std::vector<flatbuffers::Offset<fb::WatchedDir>> watchedDirs;
+    for (const WatchedDir &dir : watchedDirs_)
+    {
+        watchedDirs.push_back(fb::CreateWatchedDir(builder, builder.CreateString(dir.name), dir.modified));
+    }
+
+    auto watchedDirsVec = builder.CreateVector(watchedDirs);
+    auto key = builder.CreateString(key_);
+    auto fileName = builder.CreateString(fileName_);
+    auto resolution = fb::CreateIncludeResolution(builder, key, fileName, watchedDirsVec);
+    fb::FinishStoredObjectBuffer(builder, fb::CreateStoredObject(builder, fb::StoredAny_IncludeResolution, resolution.Union()));
+}
+
+
+//
+// Serialise the key of this object so it can be found in the database.
+//
+
+void IncludeResolution::serialiseKey(flatbuffers::FlatBufferBuilder &builder) const
+{
+    serialiseKey(builder, key_);
+}
+
+
+void IncludeResolution::serialiseKey(flatbuffers::FlatBufferBuilder &builder, const std::string &key)
+{
+    auto keyStr = builder.CreateString(key);
+    auto stringKey = fb::CreateStringKey(builder, keyStr);
+    fb::FinishStoredObjectBuffer(builder, fb::CreateStoredObject(builder, fb::StoredAny_StringKey, stringKey.Union()));
+}
+
+
+//
+// Fill out this object from a database serialised form.
+//
+
+void IncludeResolution::unserialise(const fb::StoredObject &so)
+{
+    const fb::IncludeResolution *resolution = so.obj_as_IncludeResolution();
+    key_ = resolution->key() ? resolution->key()->str() : std::string();
+    fileName_ = resolution->file_name() ? resolution->file_name()->str() : std::string();
+    watchedDirs_.clear();
+    if (resolution->watched_dirs())
+    {
+        for (const fb::WatchedDir *dir : *resolution->watched_dirs())
+        {
+            watchedDirs_.push_back(WatchedDir{ dir->name() ? dir->name()->str() : std::string(), dir->modified() });
+        }
+    }
+}
+
+
+//
+// Constructor.
+//
+
+IncludeResolver::IncludeResolver(std::shared_ptr<ProgramDb> pdb, const std::vector<std::string> &includePath) :
+    pdb_(pdb),
+    includePath_(includePath),
+    cacheHits_(0),
+    storedHits_(0),
+    searches_(0),
+    fileStats_(0),
+    dirStats_(0)
+{
+    // The names are separated with nul characters, which can't be in them.
+    std::string joined;
+    for (const std::string &dir : includePath_)
+    {
+        joined += dir;
+        joined.push_back('\0');
+    }
+
+    includePathHash_ = std::to_string(xxHash64(joined.data(), joined.size()));
+}
+
+
+//
+// Find the file an #include refers to. An #include_next gives the index
+// of the include path directory to start at. Returns an empty string if
+// there isn't one.
+//
+
+std::string IncludeResolver::resolve(const std::string &name, bool angled, const std::string &includerDir, size_t firstDir)
+{
+    // Where a "name" is looked for depends on the includer, but a <name>
+    // or an absolute name is found in the same place from anywhere.
+    bool absolute = !name.empty() && name[0] == '/';
+    std::string kind = absolute ? std::string("/") : firstDir > 0 ? "<" + std::to_string(firstDir) : angled ? std::string("<") : "\"" + includerDir;
+    std::string key = kind + '\0' + includePathHash_ + '\0' + name;
+
+    {
+        std::lock_guard<std::mutex> locker(mutex_);
+        auto it = resolved_.find(key);
+        if (it != resolved_.end())
+        {
+            cacheHits_++;
+            return it->second;
+        }
+    }
+
+    // A stored result holds if none of the directories it watches have
+    // changed.
+    std::unique_ptr<IncludeResolution> resolution;
+    std::shared_ptr<IncludeResolution> stored = pdb_->getIncludeResolution(key);
+    bool valid = stored != nullptr;
+    if (valid)
+    {
+        for (const IncludeResolution::WatchedDir &dir : stored->watchedDirs())
+        {
+            if (dirTime(dir.name) != dir.modified)
+            {
+                valid = false;
+                break;
+            }
+        }
+    }
+
+    std::string fileName;
+    if (valid)
+    {
+        storedHits_++;
+        fileName = stored->fileName();
+    }
+    else
+    {
+        searches_++;
+        resolution = search(key, name, (angled || firstDir > 0) && !absolute, absolute ? std::string() : includerDir, firstDir);
+        fileName = resolution->fileName();
+        if (stored)
+        {
+            resolution->setId(stored->id());
+        }
+    }
+
+    std::lock_guard<std::mutex> locker(mutex_);
+    resolved_.emplace(key, fileName);
+    if (resolution)
+    {
+        unstored_.push_back(std::move(resolution));
+    }
+
+    return fileName;
+}
+
+
+//
+// Look for the file in each directory in turn, watching each directory
+// it wasn't found in and the one it was.
+//
+
+std::unique_ptr<IncludeResolution> IncludeResolver::search(const std::string &key, const std::string &name, bool angled, const std::string &includerDir, size_t firstDir)
+{
+    auto resolution = std::make_unique<IncludeResolution>(key);
+
+    auto join = [&name](const std::string &dir)
+    {
+        return dir.empty() || dir.back() == '/' ? dir + name : dir + "/" + name;
+    };
+
+    std::vector<std::string> candidates;
+    if (!name.empty() && name[0] == '/')
+    {
+        candidates.push_back(name);
+    }
+    else
+    {
+        if (!angled)
+        {
+            candidates.push_back(join(includerDir));
+        }
+
+        for (size_t i = firstDir; i < includePath_.size(); i++)
+        {
+            candidates.push_back(join(includePath_[i]));
+        }
+    }
+
+    for (const std::string &candidate : candidates)
+    {
+        std::string dir = existingDir(candidate);
+        resolution->addWatchedDir(dir, dirTime(dir));
+
+        struct stat fileInfo;
+        fileStats_++;
+        if (stat(candidate.c_str(), &fileInfo) == 0 && S_ISREG(fileInfo.st_mode))
+        {
+            resolution->setFileName(candidate);
+            break;
+        }
+    }
+
+    return resolution;
+}
+
+
+//
+// Get the modification time of a directory, or -1 if it doesn't exist.
+// Each directory is only looked at once in a run.
+//
+
+int64_t IncludeResolver::dirTime(const std::string &dirName)
+{
+    {
+        std::lock_guard<std::mutex> locker(mutex_);
+        auto it = dirTimes_.find(dirName);
+        if (it != dirTimes_.end())
+            return it->second;
+    }
+
+    struct stat dirInfo;
+    int64_t modified = -1;
+    dirStats_++;
+    if (stat(dirName.empty() ? "." : dirName.c_str(), &dirInfo) == 0 && S_ISDIR(dirInfo.st_mode))
+    {
+        modified = static_cast<int64_t>(dirInfo.st_mtim.tv_sec) * 1000000000 + dirInfo.st_mtim.tv_nsec;
+    }
+
+    std::lock_guard<std::mutex> locker(mutex_);
+    dirTimes_.emplace(dirName, modified);
+    return modified;
+}
+
+
+//
+// Get the innermost directory on the way to a file which exists. If a
+// file appears there, or a directory which leads to it, the directory's
+// modification time changes.
+//
+
+std::string IncludeResolver::existingDir(const std::string &fileName)
+{
+    std::string dir = fileName;
+    for (;;)
+    {
+        size_t slash = dir.rfind('/');
+        if (slash == std::string::npos)
+            return std::string();
+
+        dir.erase(slash == 0 ? 1 : slash);
+        if (dir == "/" || dirTime(dir) >= 0)
+            return dir;
+    }
+}
+
+
+//
+// Store the results found by searching since the last time.
+//
+
+void IncludeResolver::store()
+{
+    std::vector<std::unique_ptr<IncludeResolution>> unstored;
+    {
+        std::lock_guard<std::mutex> locker(mutex_);
+        unstored.swap(unstored_);
+    }
+
+    if (unstored.empty())
+        return;
+
+    ProgramDb::Batch batch(*pdb_);
+    for (auto &resolution : unstored)
+    {
+        batch.put(*resolution);
+    }
+
+    batch.commit();
+}
+
+
+//
+// Get the counters.
+//
+
+IncludeResolver::Stats IncludeResolver::stats() const
+{
+    Stats stats;
+    stats.cacheHits = cacheHits_;
+    stats.storedHits = storedHits_;
+    stats.searches = searches_;
+    stats.fileStats = fileStats_;
+    stats.dirStats = dirStats_;
+    return stats;
+}
+
+
+} // namespace deepC
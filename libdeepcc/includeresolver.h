@@ -0,0 +1,152 @@
+#ifndef DEEPC_INCLUDERESOLVER_H
+#define DEEPC_INCLUDERESOLVER_H
+
+#include <atomic>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "storable.h"
+
+
+namespace deepC
+{
+
+
+// Forward declarations.
+class ProgramDb;
+
+
+//
+// Where an #include was found, or that it wasn't found, as stored in the
+// program database. The key is the header name along with everything
+// else which affects the search: whether it's a <name>, the directory of
+// the includer for a "name", and a hash of the include path.
+//
+// It also holds the modification time of each directory whose contents
+// decided the result. Adding or removing a file changes the modification
+// time of the directory it's in, so while those are the same the result
+// still holds, whether it was found or not.
+//
+
+class IncludeResolution : public Storable
+{
+public:
+    // A directory whose contents the result depends on.
+    struct WatchedDir
+    {
+        std::string name;
+        int64_t     modified;   // In nanoseconds, or -1 if it didn't exist.
+    };
+
+private:
+    std::string             key_;
+    std::string             fileName_;      // Empty if it wasn't found.
+    std::vector<WatchedDir> watchedDirs_;
+
+public:
+    // Constructors.
+    explicit IncludeResolution(const std::string &key) : key_(key) {}
+    explicit IncludeResolution(uint32_t id, const std::shared_ptr<ProgramDbSnapshot> &) : Storable(id) {}
+
+    // Accessors.
+    const std::string             &key() const         { return key_; }
+    const std::string             &fileName() const    { return fileName_; }
+    void                           setFileName(const std::string &fileName) { fileName_ = fileName; }
+    bool                           found() const       { return !fileName_.empty(); }
+    const std::vector<WatchedDir> &watchedDirs() const { return watchedDirs_; }
+    void                           addWatchedDir(const std::string &name, int64_t modified) { watchedDirs_.push_back(WatchedDir{ name, modified }); }
+
+    // Which databases to use for the content and the key mapping.
+    DbGroup contentDbGroup() const override { return Storable::DbGroup::IncludeResolutions; }
+    DbGroup keyDbGroup() const override     { return Storable::DbGroup::IncludeResolutionKeys; }
+
+    // To store this type in the database.
+    void serialiseContent(flatbuffers::FlatBufferBuilder &builder) const override;
+    void serialiseKey(flatbuffers::FlatBufferBuilder &builder) const override;
+    void unserialise(const fb::StoredObject &so) override;
+
+    // Serialise a key, to look one up without an object.
+    static void serialiseKey(flatbuffers::FlatBufferBuilder &builder, const std::string &key);
+};
+
+
+//
+// Finds the files #includes refer to. A "name" is looked for next to the
+// file which includes it and then on the include path, and a <name> only
+// on the include path. An #include_next starts part way along the path.
+//
+// Searching means a stat() for every directory on the include path, for
+// every #include. Instead results are cached, both in memory for the rest
+// of the run and in the program database for later runs. Misses are cached
+// as well as hits. A stored result is checked by looking at the times of
+// its watched directories, and each directory is only looked at once per
+// run.
+//
+// Headers aren't expected to come and go during a run. It's safe to use
+// from several threads at once.
+//
+
+class IncludeResolver
+{
+public:
+    // Counters showing how well the cache works.
+    struct Stats
+    {
+        uint64_t cacheHits;     // Resolved from memory.
+        uint64_t storedHits;    // Resolved from the program database.
+        uint64_t searches;      // Resolved by searching the directories.
+        uint64_t fileStats;     // stat() calls made on candidate files.
+        uint64_t dirStats;      // stat() calls made on watched directories.
+    };
+
+private:
+    std::shared_ptr<ProgramDb>  pdb_;
+    std::vector<std::string>    includePath_;
+    std::string                 includePathHash_;
+
+    // Results from this run, and the times of directories looked at.
+    std::mutex                  mutex_;
+    std::unordered_map<std::string, std::string> resolved_;
+    std::unordered_map<std::string, int64_t>     dirTimes_;
+
+    // New results which haven't been stored yet.
+    std::vector<std::unique_ptr<IncludeResolution>> unstored_;
+
+    std::atomic<uint64_t>       cacheHits_;
+    std::atomic<uint64_t>       storedHits_;
+    std::atomic<uint64_t>       searches_;
+    std::atomic<uint64_t>       fileStats_;
+    std::atomic<uint64_t>       dirStats_;
+
+private:
+    // Look for the file in each directory in turn.
+    std::unique_ptr<IncludeResolution> search(const std::string &key, const std::string &name, bool angled, const std::string &includerDir, size_t firstDir);
+
+    // Get the modification time of a directory, or -1 if it doesn't exist.
+    int64_t dirTime(const std::string &dirName);
+
+    // Get the innermost directory on the way to a file which exists.
+    std::string existingDir(const std::string &fileName);
+
+public:
+    IncludeResolver(std::shared_ptr<ProgramDb> pdb, const std::vector<std::string> &includePath);
+
+    // Find the file an #include refers to, searching the include path from
+    // firstDir. Returns an empty string if there isn't one.
+    std::string resolve(const std::string &name, bool angled, const std::string &includerDir, size_t firstDir = 0);
+
+    const std::vector<std::string> &includePath() const { return includePath_; }
+
+    // Store the results found by searching since the last time.
+    void store();
+
+    Stats stats() const;
+};
+
+
+} // namespace deepC
+
+#endif // DEEPC_INCLUDERESOLVER_H
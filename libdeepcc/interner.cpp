@@ -0,0 +1,235 @@
+#include <cstring>
+#include <stdexcept>
+
+#include "contenthash.h"
+#include "interner.h"
+
+
+namespace deepC
+{
+
+
+// Each shard's hash table starts this big.
+static const size_t initialSlots = 256;
+
+
+//
+// Constructor.
+//
+
+Interner::Interner() :
+    shards_(new Shard[numShards]),
+    chunks_(new std::atomic<Entry *>[maxChunks]),
+    nextId_(1),
+    savedCount_(0)
+{
+    for (size_t i = 0; i < maxChunks; i++)
+    {
+        chunks_[i].store(nullptr, std::memory_order_relaxed);
+    }
+
+    for (int i = 0; i < numShards; i++)
+    {
+        shards_[i].slots.resize(initialSlots);
+    }
+}
+
+
+//
+// Destructor.
+//
+
+Interner::~Interner()
+{
+    for (size_t i = 0; i < maxChunks; i++)
+    {
+        delete[] chunks_[i].load(std::memory_order_relaxed);
+    }
+}
+
+
+//
+// Get our id for an id in the program database.
+//
+
+Interner::Id Interner::fromStored(Id stored) const
+{
+    if (ourIds_.empty())
+        return stored <= savedCount_ ? stored : none;
+
+    return stored < ourIds_.size() ? ourIds_[stored] : none;
+}
+
+
+//
+// Note the program database's id for one of ours. Ids have to be given
+// in order. The mapping is only kept once the two differ.
+//
+
+void Interner::setStoredId(Id id, Id stored)
+{
+    if (storedIds_.empty())
+    {
+        if (id == stored)
+            return;
+
+        // Everything up to here was the same.
+        for (Id same = 0; same < id; same++)
+        {
+            storedIds_.push_back(same);
+            ourIds_.push_back(same);
+        }
+    }
+
+    if (storedIds_.size() <= id)
+    {
+        storedIds_.resize(id + 1, none);
+    }
+
+    if (ourIds_.size() <= stored)
+    {
+        ourIds_.resize(stored + 1, none);
+    }
+
+    storedIds_[id] = stored;
+    ourIds_[stored] = id;
+}
+
+
+//
+// Get where the text of an id is kept.
+//
+
+Interner::Entry &Interner::entry(Id id) const
+{
+    Entry *chunk = chunks_[id >> chunkBits].load(std::memory_order_acquire);
+    return chunk[id & (chunkSize - 1)];
+}
+
+
+//
+// Get the id of an identifier, adding it if it's new.
+//
+
+Interner::Id Interner::intern(std::string_view text)
+{
+    uint64_t hash = xxHash64(text.data(), text.size());
+    Shard &shard = shards_[hash >> (64 - shardBits)];
+    uint32_t shortHash = static_cast<uint32_t>(hash);
+
+    std::lock_guard<std::mutex> locker(shard.mutex);
+    size_t mask = shard.slots.size() - 1;
+    for (size_t slot = hash & mask; ; slot = (slot + 1) & mask)
+    {
+        const Slot &s = shard.slots[slot];
+        if (s.id == none)
+            return insert(shard, text, hash, slot);
+
+        if (s.hash == shortHash)
+        {
+            const Entry &e = entry(s.id);
+            if (e.length == text.size() && memcmp(e.text, text.data(), text.size()) == 0)
+                return s.id;
+        }
+    }
+}
+
+
+//
+// Get the id of an identifier without adding it.
+//
+
+Interner::Id Interner::find(std::string_view text) const
+{
+    uint64_t hash = xxHash64(text.data(), text.size());
+    Shard &shard = shards_[hash >> (64 - shardBits)];
+    uint32_t shortHash = static_cast<uint32_t>(hash);
+
+    std::lock_guard<std::mutex> locker(shard.mutex);
+    size_t mask = shard.slots.size() - 1;
+    for (size_t slot = hash & mask; ; slot = (slot + 1) & mask)
+    {
+        const Slot &s = shard.slots[slot];
+        if (s.id == none)
+            return none;
+
+        if (s.hash == shortHash)
+        {
+            const Entry &e = entry(s.id);
+            if (e.length == text.size() && memcmp(e.text, text.data(), text.size()) == 0)
+                return s.id;
+        }
+    }
+}
+
+
+//
+// Add a new identifier in a free slot. The caller holds the shard's lock.
+//
+
+Interner::Id Interner::insert(Shard &shard, std::string_view text, uint64_t hash, size_t slot)
+{
+    Id id = nextId_.fetch_add(1, std::memory_order_relaxed);
+    size_t chunkNum = id >> chunkBits;
+    if (chunkNum >= maxChunks || text.size() > UINT32_MAX)
+        throw std::length_error("too many identifiers");
+
+    // Find or make the chunk the entry goes in.
+    Entry *chunk = chunks_[chunkNum].load(std::memory_order_acquire);
+    if (chunk == nullptr)
+    {
+        Entry *newChunk = new Entry[chunkSize];
+        if (chunks_[chunkNum].compare_exchange_strong(chunk, newChunk, std::memory_order_acq_rel))
+        {
+            chunk = newChunk;
+        }
+        else
+        {
+            // Another shard got there first.
+            delete[] newChunk;
+        }
+    }
+
+    char *copy = static_cast<char *>(shard.text.allocate(text.size(), 1));
+    memcpy(copy, text.data(), text.size());
+    chunk[id & (chunkSize - 1)] = Entry{ copy, static_cast<uint32_t>(text.size()) };
+
+    shard.slots[slot] = Slot{ static_cast<uint32_t>(hash), id };
+    shard.used++;
+    if (shard.used * 2 > shard.slots.size())
+    {
+        grow(shard);
+    }
+
+    return id;
+}
+
+
+//
+// Double the size of a shard's hash table. The slot only keeps the low 32
+// bits of the hash but that's all the table ever indexes with.
+//
+
+void Interner::grow(Shard &shard)
+{
+    std::vector<Slot> slots(shard.slots.size() * 2);
+    size_t mask = slots.size() - 1;
+    for (const Slot &s : shard.slots)
+    {
+        if (s.id == none)
+            continue;
+
+        size_t slot = s.hash & mask;
+        while (slots[slot].id != none)
+        {
+            slot = (slot + 1) & mask;
+        }
+
+        slots[slot] = s;
+    }
+
+    shard.slots.swap(slots);
+}
+
+
+} // namespace deepC
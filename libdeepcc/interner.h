@@ -0,0 +1,127 @@
+#ifndef DEEPC_INTERNER_H
+#define DEEPC_INTERNER_H
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string_view>
+#include <vector>
+
+#include "arena.h"
+
+
+namespace deepC
+{
+
+
+//
+// Maps identifiers to small dense id numbers, so identifiers can be
+// compared and looked up as integers rather than as strings. Ids start at
+// 1 and 0 is never used, so it can mean "no identifier".
+//
+// The table is split into shards, each with its own lock, arena and open
+// addressing hash table. Which shard an identifier goes in depends on its
+// hash so threads lexing different files rarely wait for each other.
+//
+// The program database keeps the table so ids stay the same from one run
+// to the next, see ProgramDb::loadIdentifiers(). If another compiler using
+// the same database stores some of the same identifiers first they can
+// end up with different ids there, so the interner also keeps a mapping
+// between its ids and the stored ones, see ProgramDb::saveIdentifiers().
+//
+
+class Interner
+{
+public:
+    typedef uint32_t Id;
+
+    // The id which is never given to an identifier.
+    static constexpr Id none = 0;
+
+private:
+    static constexpr int      shardBits = 6;
+    static constexpr int      numShards = 1 << shardBits;
+    static constexpr int      chunkBits = 12;
+    static constexpr size_t   chunkSize = size_t(1) << chunkBits;
+    static constexpr size_t   maxChunks = size_t(1) << 14;
+
+    // A place in a shard's hash table. An id of none means it's free.
+    struct Slot
+    {
+        uint32_t hash;      // The low bits of the hash, to skip most comparisons.
+        Id       id;
+    };
+
+    struct Shard
+    {
+        std::mutex        mutex;
+        std::vector<Slot> slots;    // A power of two in size, at most half full.
+        size_t            used;
+        Arena             text;
+
+        Shard() : used(0), text(16 * 1024) {}
+    };
+
+    // Where the text of each id is. Looked up by id without any locking,
+    // in chunks which never move once they're allocated.
+    struct Entry
+    {
+        const char *text;
+        uint32_t    length;
+    };
+
+    std::unique_ptr<Shard[]>             shards_;
+    std::unique_ptr<std::atomic<Entry *>[]> chunks_;
+    std::atomic<Id>                      nextId_;
+    Id                                   savedCount_;
+
+    // Where the stored ids differ from ours. Both are empty while they're
+    // all the same.
+    std::vector<Id>                      storedIds_;    // Indexed by our id.
+    std::vector<Id>                      ourIds_;       // Indexed by stored id.
+
+private:
+    Id       insert(Shard &shard, std::string_view text, uint64_t hash, size_t slot);
+    void     grow(Shard &shard);
+    Entry   &entry(Id id) const;
+
+public:
+    Interner();
+    ~Interner();
+    Interner(const Interner &) = delete;
+    Interner &operator=(const Interner &) = delete;
+
+    // Get the id of an identifier, giving it a new one if it doesn't
+    // have one yet. Safe to call from any thread.
+    Id               intern(std::string_view text);
+
+    // Get the id of an identifier, or none if it doesn't have one.
+    Id               find(std::string_view text) const;
+
+    // Get the text of an identifier.
+    std::string_view text(Id id) const { const Entry &e = entry(id); return std::string_view(e.text, e.length); }
+
+    // The number of ids given out. Ids run from 1 to size().
+    size_t           size() const { return nextId_.load(std::memory_order_relaxed) - 1; }
+
+    // How many of our ids are known to be in the program database.
+    Id               savedCount() const        { return savedCount_; }
+    void             setSavedCount(Id count)   { savedCount_ = count; }
+
+    // How many of the program database's ids we have ids for.
+    Id               storedCount() const       { return ourIds_.empty() ? savedCount_ : static_cast<Id>(ourIds_.size() - 1); }
+
+    // Convert between our ids and the program database's. fromStored()
+    // gives none for a stored id we don't know about yet.
+    bool             storedIdsDiffer() const   { return !storedIds_.empty(); }
+    Id               toStored(Id id) const     { return storedIds_.empty() ? id : (id < storedIds_.size() ? storedIds_[id] : none); }
+    Id               fromStored(Id stored) const;
+    void             setStoredId(Id id, Id stored);
+};
+
+
+} // namespace deepC
+
+#endif // DEEPC_INTERNER_H
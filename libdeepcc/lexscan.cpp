@@ -0,0 +1,483 @@
+#include <cstdint>
+#include <cstring>
+#include <initializer_list>
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define DEEPC_LEXSCAN_X86
+#include <immintrin.h>
+#endif
+
+#include "lexscan.h"
+
+
+namespace deepC
+{
+
+
+//
+// What each byte can be part of.
+//
+
+enum : uint8_t
+{
+    BlankChar      = 1,
+    IdentifierChar = 2,
+    NumberChar     = 4,
+    SkipStopChar   = 8
+};
+
+static constexpr struct CharTable
+{
+    uint8_t kinds[256];
+
+    constexpr CharTable() : kinds()
+    {
+        kinds[static_cast<uint8_t>(' ')] = BlankChar;
+        kinds[static_cast<uint8_t>('\t')] = BlankChar;
+        for (int ch = 0; ch < 256; ch++)
+        {
+            if ((ch >= 'a' && ch <= 'z') || (ch >= 'A' && ch <= 'Z') || (ch >= '0' && ch <= '9') || ch == '_' || ch >= 0x80)
+            {
+                kinds[ch] = IdentifierChar | NumberChar;
+            }
+        }
+
+        kinds[static_cast<uint8_t>('.')] = NumberChar;
+        for (char ch : { '#', '%', '/', '"', '\'' })
+        {
+            kinds[static_cast<uint8_t>(ch)] = SkipStopChar;
+        }
+    }
+} charTable;
+
+
+static inline bool isKind(char ch, uint8_t kind)
+{
+    return (charTable.kinds[static_cast<uint8_t>(ch)] & kind) != 0;
+}
+
+
+//
+// The portable kernels, which are also used for the ends of the text the
+// vector kernels leave over.
+//
+
+static size_t skipKindPortable(const char *text, size_t pos, size_t size, uint8_t kind)
+{
+    while (pos < size && isKind(text[pos], kind))
+    {
+        pos++;
+    }
+
+    return pos;
+}
+
+
+static size_t skipBlanksPortable(const char *text, size_t pos, size_t size)
+{
+    return skipKindPortable(text, pos, size, BlankChar);
+}
+
+
+static size_t skipIdentifierPortable(const char *text, size_t pos, size_t size)
+{
+    return skipKindPortable(text, pos, size, IdentifierChar);
+}
+
+
+static size_t skipNumberPortable(const char *text, size_t pos, size_t size)
+{
+    return skipKindPortable(text, pos, size, NumberChar);
+}
+
+
+static size_t findCommentEndPortable(const char *text, size_t pos, size_t size)
+{
+    while (pos + 1 < size)
+    {
+        const void *star = memchr(text + pos, '*', size - 1 - pos);
+        if (star == nullptr)
+            break;
+
+        pos = static_cast<const char *>(star) - text;
+        if (text[pos + 1] == '/')
+            return pos;
+
+        pos++;
+    }
+
+    return size;
+}
+
+
+static size_t findLineBreakPortable(const char *text, size_t pos, size_t size)
+{
+    while (pos < size && text[pos] != '\n' && text[pos] != '\\')
+    {
+        pos++;
+    }
+
+    return pos;
+}
+
+
+static size_t findSkipStopPortable(const char *text, size_t pos, size_t size)
+{
+    while (pos < size && !isKind(text[pos], SkipStopChar))
+    {
+        pos++;
+    }
+
+    return pos;
+}
+
+
+static const ScanKernels portableKernels =
+{
+    "portable",
+    skipBlanksPortable,
+    skipIdentifierPortable,
+    skipNumberPortable,
+    findCommentEndPortable,
+    findLineBreakPortable,
+    findSkipStopPortable
+};
+
+
+#ifdef DEEPC_LEXSCAN_X86
+
+//
+// The SSE4.2 kernels. The character classes are given to PCMPESTRI as
+// ranges, and it returns the index of the first byte outside them, or 16
+// if there isn't one. Explicit lengths are used so that nul characters
+// in the text aren't taken as the end of it.
+//
+
+#define DEEPC_SSE42 __attribute__((target("sse4.2")))
+
+static constexpr int rangesOutside = _SIDD_UBYTE_OPS | _SIDD_CMP_RANGES | _SIDD_NEGATIVE_POLARITY | _SIDD_LEAST_SIGNIFICANT;
+static constexpr int equalAny = _SIDD_UBYTE_OPS | _SIDD_CMP_EQUAL_ANY | _SIDD_LEAST_SIGNIFICANT;
+
+
+DEEPC_SSE42 static inline size_t skipRangesSse42(const char *text, size_t pos, size_t size, const char *ranges, int numRanges)
+{
+    __m128i set = _mm_loadu_si128(reinterpret_cast<const __m128i *>(ranges));
+    while (pos + 16 <= size)
+    {
+        __m128i block = _mm_loadu_si128(reinterpret_cast<const __m128i *>(text + pos));
+        int index = _mm_cmpestri(set, numRanges * 2, block, 16, rangesOutside);
+        if (index < 16)
+            return pos + index;
+
+        pos += 16;
+    }
+
+    return pos;
+}
+
+
+// The sets are padded to 16 bytes since they're loaded whole.
+alignas(16) static const char blankRanges[16]      = { ' ', ' ', '\t', '\t' };
+alignas(16) static const char identifierRanges[16] = { 'a', 'z', 'A', 'Z', '0', '9', '_', '_', '\x80', '\xff' };
+alignas(16) static const char numberRanges[16]     = { 'a', 'z', 'A', 'Z', '0', '9', '_', '_', '\x80', '\xff', '.', '.' };
+alignas(16) static const char lineBreakChars[16]   = { '\n', '\\' };
+alignas(16) static const char skipStopChars[16]    = { '#', '%', '/', '"', '\'' };
+
+
+DEEPC_SSE42 static size_t skipBlanksSse42(const char *text, size_t pos, size_t size)
+{
+    return skipBlanksPortable(text, skipRangesSse42(text, pos, size, blankRanges, 2), size);
+}
+
+
+DEEPC_SSE42 static size_t skipIdentifierSse42(const char *text, size_t pos, size_t size)
+{
+    return skipIdentifierPortable(text, skipRangesSse42(text, pos, size, identifierRanges, 5), size);
+}
+
+
+DEEPC_SSE42 static size_t skipNumberSse42(const char *text, size_t pos, size_t size)
+{
+    return skipNumberPortable(text, skipRangesSse42(text, pos, size, numberRanges, 6), size);
+}
+
+
+DEEPC_SSE42 static size_t findCommentEndSse42(const char *text, size_t pos, size_t size)
+{
+    // Compare each byte with '*' and the byte after it with '/'.
+    const __m128i star = _mm_set1_epi8('*');
+    const __m128i slash = _mm_set1_epi8('/');
+    while (pos + 17 <= size)
+    {
+        __m128i first = _mm_loadu_si128(reinterpret_cast<const __m128i *>(text + pos));
+        __m128i second = _mm_loadu_si128(reinterpret_cast<const __m128i *>(text + pos + 1));
+        __m128i found = _mm_and_si128(_mm_cmpeq_epi8(first, star), _mm_cmpeq_epi8(second, slash));
+        unsigned mask = static_cast<unsigned>(_mm_movemask_epi8(found));
+        if (mask != 0)
+            return pos + __builtin_ctz(mask);
+
+        pos += 16;
+    }
+
+    return findCommentEndPortable(text, pos, size);
+}
+
+
+DEEPC_SSE42 static size_t findLineBreakSse42(const char *text, size_t pos, size_t size)
+{
+    __m128i set = _mm_loadu_si128(reinterpret_cast<const __m128i *>(lineBreakChars));
+    while (pos + 16 <= size)
+    {
+        __m128i block = _mm_loadu_si128(reinterpret_cast<const __m128i *>(text + pos));
+        int index = _mm_cmpestri(set, 2, block, 16, equalAny);
+        if (index < 16)
+            return pos + index;
+
+        pos += 16;
+    }
+
+    return findLineBreakPortable(text, pos, size);
+}
+
+
+DEEPC_SSE42 static size_t findSkipStopSse42(const char *text, size_t pos, size_t size)
+{
+    __m128i set = _mm_loadu_si128(reinterpret_cast<const __m128i *>(skipStopChars));
+    while (pos + 16 <= size)
+    {
+        __m128i block = _mm_loadu_si128(reinterpret_cast<const __m128i *>(text + pos));
+        int index = _mm_cmpestri(set, 5, block, 16, equalAny);
+        if (index < 16)
+            return pos + index;
+
+        pos += 16;
+    }
+
+    return findSkipStopPortable(text, pos, size);
+}
+
+
+static const ScanKernels sse42Kernels =
+{
+    "sse4.2",
+    skipBlanksSse42,
+    skipIdentifierSse42,
+    skipNumberSse42,
+    findCommentEndSse42,
+    findLineBreakSse42,
+    findSkipStopSse42
+};
+
+
+//
+// The AVX2 kernels. Each block of 32 bytes is classified with compares
+// into a mask of the bytes which are in the run, and the first zero bit
+// of the mask is where the run ends.
+//
+
+#define DEEPC_AVX2 __attribute__((target("avx2,bmi")))
+
+
+DEEPC_AVX2 static inline __m256i loadAvx2(const char *text)
+{
+    return _mm256_loadu_si256(reinterpret_cast<const __m256i *>(text));
+}
+
+
+// Whether each byte is between low and high inclusive. There's no
+// unsigned compare so the range is moved to the bottom of the signed one.
+DEEPC_AVX2 static inline __m256i inRangeAvx2(__m256i block, char low, char high)
+{
+    __m256i shifted = _mm256_add_epi8(block, _mm256_set1_epi8(static_cast<char>(-128 - low)));
+    return _mm256_cmpgt_epi8(_mm256_set1_epi8(static_cast<char>(-128 + (high - low) + 1)), shifted);
+}
+
+
+// Whether each byte is a letter, a digit, '_' or from 0x80 up.
+DEEPC_AVX2 static inline __m256i identifierCharsAvx2(__m256i block)
+{
+    // Setting bit 5 makes upper case letters lower case, and nothing else
+    // lower case.
+    __m256i letters = inRangeAvx2(_mm256_or_si256(block, _mm256_set1_epi8(0x20)), 'a', 'z');
+    __m256i digits = inRangeAvx2(block, '0', '9');
+    __m256i underscores = _mm256_cmpeq_epi8(block, _mm256_set1_epi8('_'));
+    __m256i high = _mm256_cmpgt_epi8(_mm256_setzero_si256(), block);
+    return _mm256_or_si256(_mm256_or_si256(letters, digits), _mm256_or_si256(underscores, high));
+}
+
+
+// The position of the first byte not in a run given its mask, or the end
+// of the block if they all are.
+DEEPC_AVX2 static inline size_t runEndAvx2(__m256i inRun)
+{
+    uint32_t outside = ~static_cast<uint32_t>(_mm256_movemask_epi8(inRun));
+    return outside == 0 ? 32 : _tzcnt_u32(outside);
+}
+
+
+DEEPC_AVX2 static size_t skipBlanksAvx2(const char *text, size_t pos, size_t size)
+{
+    const __m256i space = _mm256_set1_epi8(' ');
+    const __m256i tab = _mm256_set1_epi8('\t');
+    while (pos + 32 <= size)
+    {
+        __m256i block = loadAvx2(text + pos);
+        size_t end = runEndAvx2(_mm256_or_si256(_mm256_cmpeq_epi8(block, space), _mm256_cmpeq_epi8(block, tab)));
+        pos += end;
+        if (end < 32)
+            return pos;
+    }
+
+    return skipBlanksPortable(text, pos, size);
+}
+
+
+DEEPC_AVX2 static size_t skipIdentifierAvx2(const char *text, size_t pos, size_t size)
+{
+    while (pos + 32 <= size)
+    {
+        size_t end = runEndAvx2(identifierCharsAvx2(loadAvx2(text + pos)));
+        pos += end;
+        if (end < 32)
+            return pos;
+    }
+
+    return skipIdentifierPortable(text, pos, size);
+}
+
+
+DEEPC_AVX2 static size_t skipNumberAvx2(const char *text, size_t pos, size_t size)
+{
+    const __m256i dot = _mm256_set1_epi8('.');
+    while (pos + 32 <= size)
+    {
+        __m256i block = loadAvx2(text + pos);
+        size_t end = runEndAvx2(_mm256_or_si256(identifierCharsAvx2(block), _mm256_cmpeq_epi8(block, dot)));
+        pos += end;
+        if (end < 32)
+            return pos;
+    }
+
+    return skipNumberPortable(text, pos, size);
+}
+
+
+DEEPC_AVX2 static size_t findCommentEndAvx2(const char *text, size_t pos, size_t size)
+{
+    const __m256i star = _mm256_set1_epi8('*');
+    const __m256i slash = _mm256_set1_epi8('/');
+    while (pos + 33 <= size)
+    {
+        __m256i found = _mm256_and_si256(_mm256_cmpeq_epi8(loadAvx2(text + pos), star),
+                                         _mm256_cmpeq_epi8(loadAvx2(text + pos + 1), slash));
+        uint32_t mask = static_cast<uint32_t>(_mm256_movemask_epi8(found));
+        if (mask != 0)
+            return pos + _tzcnt_u32(mask);
+
+        pos += 32;
+    }
+
+    return findCommentEndPortable(text, pos, size);
+}
+
+
+DEEPC_AVX2 static size_t findLineBreakAvx2(const char *text, size_t pos, size_t size)
+{
+    const __m256i newline = _mm256_set1_epi8('\n');
+    const __m256i backslash = _mm256_set1_epi8('\\');
+    while (pos + 32 <= size)
+    {
+        __m256i block = loadAvx2(text + pos);
+        __m256i found = _mm256_or_si256(_mm256_cmpeq_epi8(block, newline), _mm256_cmpeq_epi8(block, backslash));
+        uint32_t mask = static_cast<uint32_t>(_mm256_movemask_epi8(found));
+        if (mask != 0)
+            return pos + _tzcnt_u32(mask);
+
+        pos += 32;
+    }
+
+    return findLineBreakPortable(text, pos, size);
+}
+
+
+DEEPC_AVX2 static size_t findSkipStopAvx2(const char *text, size_t pos, size_t size)
+{
+    while (pos + 32 <= size)
+    {
+        __m256i block = loadAvx2(text + pos);
+        __m256i found = _mm256_or_si256(_mm256_or_si256(_mm256_cmpeq_epi8(block, _mm256_set1_epi8('#')), _mm256_cmpeq_epi8(block, _mm256_set1_epi8('%'))),
+                                        _mm256_or_si256(_mm256_cmpeq_epi8(block, _mm256_set1_epi8('/')), _mm256_cmpeq_epi8(block, _mm256_set1_epi8('"'))));
+        found = _mm256_or_si256(found, _mm256_cmpeq_epi8(block, _mm256_set1_epi8('\'')));
+        uint32_t mask = static_cast<uint32_t>(_mm256_movemask_epi8(found));
+        if (mask != 0)
+            return pos + _tzcnt_u32(mask);
+
+        pos += 32;
+    }
+
+    return findSkipStopPortable(text, pos, size);
+}
+
+
+static const ScanKernels avx2Kernels =
+{
+    "avx2",
+    skipBlanksAvx2,
+    skipIdentifierAvx2,
+    skipNumberAvx2,
+    findCommentEndAvx2,
+    findLineBreakAvx2,
+    findSkipStopAvx2
+};
+
+#endif // DEEPC_LEXSCAN_X86
+
+
+//
+// Get the kernels for an instruction set, or null if this CPU can't run
+// them.
+//
+
+const ScanKernels *scanKernels(ScanLevel level)
+{
+    switch (level)
+    {
+    case ScanLevel::Portable:
+        return &portableKernels;
+
+#ifdef DEEPC_LEXSCAN_X86
+    case ScanLevel::Sse42:
+        return __builtin_cpu_supports("sse4.2") ? &sse42Kernels : nullptr;
+
+    case ScanLevel::Avx2:
+        return (__builtin_cpu_supports("avx2") && __builtin_cpu_supports("bmi")) ? &avx2Kernels : nullptr;
+#endif
+
+    default:
+        return nullptr;
+    }
+}
+
+
+//
+// The fastest kernels this CPU can run. They're chosen the first time
+// they're asked for.
+//
+
+const ScanKernels &bestScanKernels()
+{
+    static const ScanKernels *best = []() {
+        for (ScanLevel level : { ScanLevel::Avx2, ScanLevel::Sse42 })
+        {
+            if (const ScanKernels *kernels = scanKernels(level))
+                return kernels;
+        }
+
+        return &portableKernels;
+    }();
+
+    return *best;
+}
+
+
+} // namespace deepC
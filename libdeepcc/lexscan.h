@@ -0,0 +1,72 @@
+#ifndef DEEPC_LEXSCAN_H
+#define DEEPC_LEXSCAN_H
+
+#include <cstddef>
+
+
+namespace deepC
+{
+
+
+//
+// Kernels for the long runs of characters the lexer gets through without
+// needing to know where tokens start and end: blanks, comments, and the
+// characters of identifiers and numbers, along with the text of the
+// conditional groups the preprocessor skips. Each kernel is given the
+// text, where to start and the size of the text, and returns the position
+// of the first character which isn't part of the run, or the size if the
+// run goes to the end.
+//
+// The AVX2 and SSE4.2 versions classify 32 or 16 bytes at a time. The
+// portable version does one byte at a time. The best version this CPU
+// can run is picked at run time using CPUID.
+//
+
+struct ScanKernels
+{
+    const char *name;
+
+    // Skip spaces and tabs.
+    size_t (*skipBlanks)(const char *text, size_t pos, size_t size);
+
+    // Skip letters, digits, '_' and bytes from 0x80 up, which are the
+    // characters of an identifier apart from universal character names.
+    size_t (*skipIdentifier)(const char *text, size_t pos, size_t size);
+
+    // Skip the same characters as skipIdentifier() as well as '.', which
+    // are the characters of a pp-number apart from signs after exponents.
+    size_t (*skipNumber)(const char *text, size_t pos, size_t size);
+
+    // Find the "*/" at the end of a block comment.
+    size_t (*findCommentEnd)(const char *text, size_t pos, size_t size);
+
+    // Find the next newline or backslash, which is what ends or continues
+    // a line comment.
+    size_t (*findLineBreak)(const char *text, size_t pos, size_t size);
+
+    // Find the next '#', '%', '/', '"' or '\'', which are the characters
+    // which could start a directive, a comment or a literal.
+    size_t (*findSkipStop)(const char *text, size_t pos, size_t size);
+};
+
+
+// The instruction sets there are kernels for.
+enum class ScanLevel
+{
+    Portable,
+    Sse42,
+    Avx2
+};
+
+
+// Get the kernels for an instruction set, or null if this CPU can't run
+// them.
+const ScanKernels *scanKernels(ScanLevel level);
+
+// The fastest kernels this CPU can run.
+const ScanKernels &bestScanKernels();
+
+
+} // namespace deepC
+
+#endif // DEEPC_LEXSCAN_H
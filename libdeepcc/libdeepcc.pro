@@ -33,34 +33,75 @@ QMAKE_EXTRA_COMPILERS += flatc
 INCLUDEPATH += $$OUT_PWD
 
 SOURCES += \
+    arena.cpp \
     clexer.cpp \
     codegen.cpp \
     compileargs.cpp \
     compiler.cpp \
+    contenthash.cpp \
     cparser.cpp \
+    cparsersupport.cpp \
+    diff.cpp \
     fail.cpp \
+    hideset.cpp \
+    includeinfo.cpp \
+    includeresolver.cpp \
+    interner.cpp \
+    lexscan.cpp \
+    lineindex.cpp \
+    macro.cpp \
+    macrocontext.cpp \
+    macroexpander.cpp \
     parsetree.cpp \
+    ppexpression.cpp \
+    pptokenstream.cpp \
     preprocessor.cpp \
     programdb.cpp \
     sourcefile.cpp \
+    sourceloc.cpp \
+    sourcetokens.cpp \
     storable.cpp \
-    token.cpp
+    threadpool.cpp \
+    token.cpp \
+    tokenstream.cpp \
+    typenames.cpp
 
 HEADERS += \
+    arena.h \
     clexer.h \
+    clexertables.h \
     codegen.h \
     compileargs.h \
     compiler.h \
+    contenthash.h \
     cparser.h \
     deeptypes.h \
+    diff.h \
     fail.h \
+    hideset.h \
+    includeinfo.h \
+    includeresolver.h \
+    interner.h \
+    lexscan.h \
+    lineindex.h \
+    macro.h \
+    macrocontext.h \
+    macroexpander.h \
+    parserules.h \
     parsetree.h \
+    ppexpression.h \
+    pptokenstream.h \
     preprocessor.h \
     programdb.h \
     sourcefile.h \
+    sourceloc.h \
+    sourcetokens.h \
     sourcepos.h \
     storable.h \
-    token.h
+    threadpool.h \
+    token.h \
+    tokenstream.h \
+    typenames.h
 
 FLATC_SOURCES += \
     storedobject.fbs
@@ -0,0 +1,159 @@
+#include <cstring>
+#include <algorithm>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#define DEEPC_X86 1
+#endif
+
+#include "lineindex.h"
+
+
+namespace deepC
+{
+
+
+//
+// Index some text.
+//
+
+void LineIndex::build(std::string_view text)
+{
+    starts_.clear();
+    if (text.empty())
+        return;
+
+    // Guess at an average line length to avoid most reallocation.
+    starts_.reserve(text.size() / 32 + 2);
+    starts_.push_back(0);
+    scan(text.data(), text.size(), 0, &starts_);
+
+    // If there's no '\n' at the end, mark the end as if there was.
+    if (text.back() != '\n')
+    {
+        starts_.push_back(static_cast<uint32_t>(text.size() + 1));
+    }
+}
+
+
+//
+// Use a previously built table.
+//
+
+void LineIndex::assign(const void *table, size_t tableSize)
+{
+    starts_.resize(tableSize);
+    memcpy(starts_.data(), table, tableSize * sizeof(uint32_t));
+}
+
+
+//
+// Find which line an offset is in. Offsets past the end are in the last
+// line.
+//
+
+size_t LineIndex::lineOf(uint32_t offset) const
+{
+    if (starts_.size() < 2)
+        return 0;
+
+    auto it = std::upper_bound(starts_.begin(), starts_.end() - 1, offset);
+    return (it - starts_.begin()) - 1;
+}
+
+
+//
+// Find newlines a byte at a time. Used on its own when nothing faster
+// is available and for the tail end of the vector versions.
+//
+
+void LineIndex::scanScalar(const char *text, size_t size, uint32_t base, std::vector<uint32_t> *starts)
+{
+    const char *pos = text;
+    const char *end = text + size;
+    while ((pos = static_cast<const char *>(memchr(pos, '\n', end - pos))) != nullptr)
+    {
+        pos++;
+        starts->push_back(base + static_cast<uint32_t>(pos - text));
+    }
+}
+
+
+#ifdef DEEPC_X86
+
+//
+// Find newlines 16 bytes at a time.
+//
+
+__attribute__((target("sse2")))
+void LineIndex::scanSse2(const char *text, size_t size, uint32_t base, std::vector<uint32_t> *starts)
+{
+    const __m128i newline = _mm_set1_epi8('\n');
+    size_t pos = 0;
+    for (; pos + 16 <= size; pos += 16)
+    {
+        __m128i chunk = _mm_loadu_si128(reinterpret_cast<const __m128i *>(text + pos));
+        uint32_t mask = _mm_movemask_epi8(_mm_cmpeq_epi8(chunk, newline));
+        while (mask)
+        {
+            starts->push_back(base + static_cast<uint32_t>(pos + __builtin_ctz(mask) + 1));
+            mask &= mask - 1;
+        }
+    }
+
+    scanScalar(text + pos, size - pos, base + static_cast<uint32_t>(pos), starts);
+}
+
+
+//
+// Find newlines 32 bytes at a time.
+//
+
+__attribute__((target("avx2")))
+void LineIndex::scanAvx2(const char *text, size_t size, uint32_t base, std::vector<uint32_t> *starts)
+{
+    const __m256i newline = _mm256_set1_epi8('\n');
+    size_t pos = 0;
+    for (; pos + 32 <= size; pos += 32)
+    {
+        __m256i chunk = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(text + pos));
+        uint32_t mask = _mm256_movemask_epi8(_mm256_cmpeq_epi8(chunk, newline));
+        while (mask)
+        {
+            starts->push_back(base + static_cast<uint32_t>(pos + __builtin_ctz(mask) + 1));
+            mask &= mask - 1;
+        }
+    }
+
+    scanScalar(text + pos, size - pos, base + static_cast<uint32_t>(pos), starts);
+}
+
+
+bool LineIndex::haveSse2() { return __builtin_cpu_supports("sse2"); }
+bool LineIndex::haveAvx2() { return __builtin_cpu_supports("avx2"); }
+
+#else
+
+// No vector versions on this architecture.
+void LineIndex::scanSse2(const char *text, size_t size, uint32_t base, std::vector<uint32_t> *starts) { scanScalar(text, size, base, starts); }
+void LineIndex::scanAvx2(const char *text, size_t size, uint32_t base, std::vector<uint32_t> *starts) { scanScalar(text, size, base, starts); }
+bool LineIndex::haveSse2() { return false; }
+bool LineIndex::haveAvx2() { return false; }
+
+#endif
+
+
+//
+// Find newlines using the fastest method available.
+//
+
+void LineIndex::scan(const char *text, size_t size, uint32_t base, std::vector<uint32_t> *starts)
+{
+    using ScanFunc = void (*)(const char *, size_t, uint32_t, std::vector<uint32_t> *);
+    static const ScanFunc best = haveAvx2() ? scanAvx2 : haveSse2() ? scanSse2 : scanScalar;
+
+    best(text, size, base, starts);
+}
+
+
+} // namespace deepC
@@ -0,0 +1,71 @@
+#ifndef DEEPC_LINEINDEX_H
+#define DEEPC_LINEINDEX_H
+
+#include <cstdint>
+#include <cstddef>
+#include <string_view>
+#include <vector>
+
+
+namespace deepC
+{
+
+
+//
+// An index of where each line starts in a piece of source text. It's just
+// a table of 32 bit offsets so it's compact enough to keep for every file
+// and to store in the program database. Lines are sliced out of the text
+// on demand. Line numbers here start at 0.
+//
+// A line includes everything up to but not including its '\n'. A final
+// line with no '\n' is only counted if it isn't empty.
+//
+// The table has an extra entry at the end for where the line after the
+// last one would start, so every line ends one before the next starts.
+//
+
+class LineIndex
+{
+private:
+    std::vector<uint32_t> starts_;      // Offset of the start of each line, then the end marker.
+
+public:
+    // The largest text which can be indexed.
+    static constexpr size_t maxTextSize = UINT32_MAX - 1;
+
+    // Index some text.
+    void   build(std::string_view text);
+
+    // Use a previously built table, eg. from the program database.
+    // The table may not be aligned.
+    void   assign(const void *table, size_t tableSize);
+
+    // Accessors.
+    size_t          lineCount() const            { return starts_.empty() ? 0 : starts_.size() - 1; }
+    uint32_t        lineStart(size_t line) const { return starts_[line]; }
+    uint32_t        lineEnd(size_t line) const   { return starts_[line + 1] - 1; }
+    const uint32_t *table() const                { return starts_.data(); }
+    size_t          tableSize() const            { return starts_.size(); }
+    bool            empty() const                { return starts_.empty(); }
+
+    // Get the text of a line.
+    std::string_view line(std::string_view text, size_t line) const { return text.substr(lineStart(line), lineEnd(line) - lineStart(line)); }
+
+    // Find which line an offset is in.
+    size_t lineOf(uint32_t offset) const;
+
+    // Append the offset after each '\n' in text to starts. The offsets
+    // are relative to text, plus base. Each has the same result; scan()
+    // uses the fastest one the CPU supports.
+    static void scan(const char *text, size_t size, uint32_t base, std::vector<uint32_t> *starts);
+    static void scanScalar(const char *text, size_t size, uint32_t base, std::vector<uint32_t> *starts);
+    static void scanSse2(const char *text, size_t size, uint32_t base, std::vector<uint32_t> *starts);
+    static void scanAvx2(const char *text, size_t size, uint32_t base, std::vector<uint32_t> *starts);
+    static bool haveSse2();
+    static bool haveAvx2();
+};
+
+
+} // namespace deepC
+
+#endif // DEEPC_LINEINDEX_H
@@ -0,0 +1,270 @@
+#include <algorithm>
+
+#include "macro.h"
+#include "clexer.h"
+#include "contenthash.h"
+
+
+namespace deepC
+{
+
+
+//
+// Constructor. Lexes the replacement list, finds the parameters in it and
+// works out the hash.
+//
+
+Macro::Macro(const std::string &name, bool functionLike, bool variadic, const std::vector<std::string> &params, const std::string &body) :
+    name(name),
+    functionLike(functionLike),
+    variadic(variadic),
+    params(params),
+    body(body),
+    id_(Interner::none)
+{
+    CLexer lexer(this->body);
+    Token token;
+    while (lexer.next(&token))
+    {
+        // The replacement list is all on one line wherever it's used.
+        tokens.push_back(Token(token.kind(), token.loc(), token.length(), token.flags() & ~Token::StartOfLine, token.subKind()));
+        tokenParams.push_back(functionLike && token.kind() == TokenKind::Identifier ? param(token.text(this->body)) : -1);
+    }
+
+    std::string definition = name;
+    definition.push_back(functionLike ? '(' : ' ');
+    for (const std::string &param : params)
+    {
+        definition += param;
+        definition.push_back(',');
+    }
+
+    definition.push_back(variadic ? '.' : ')');
+    definition += body;
+    hash = xxHash64(definition.data(), definition.size());
+    if (hash == MacroEnvironment::undefined)
+    {
+        hash = 1;
+    }
+}
+
+
+//
+// Get the index of a parameter, or -1 if it isn't one.
+//
+
+int Macro::param(std::string_view name) const
+{
+    for (size_t i = 0; i < params.size(); i++)
+    {
+        if (params[i] == name)
+            return static_cast<int>(i);
+    }
+
+    return -1;
+}
+
+
+//
+// Work out the interned ids of the name and the replacement list's
+// identifiers.
+//
+
+void Macro::intern(Interner &identifiers) const
+{
+    std::call_once(internOnce_, [this, &identifiers]()
+    {
+        id_ = identifiers.intern(name);
+        tokenIds_.reserve(tokens.size());
+        for (size_t i = 0; i < tokens.size(); i++)
+        {
+            tokenIds_.push_back(tokens[i].kind() == TokenKind::Identifier ? identifiers.intern(text(i)) : Interner::none);
+        }
+    });
+}
+
+
+//
+// Constructors.
+//
+
+MacroEnvironment::MacroEnvironment(Interner &identifiers) :
+    identifiers_(identifiers),
+    size_(0)
+{
+}
+
+
+MacroEnvironment::MacroEnvironment() :
+    ownIdentifiers_(std::make_unique<Interner>()),
+    identifiers_(*ownIdentifiers_),
+    size_(0)
+{
+}
+
+
+//
+// Look up a macro, recording the look up if a header is being recorded.
+//
+
+const Macro *MacroEnvironment::find(Interner::Id id)
+{
+    const Macro *macro = id < macros_.size() ? macros_[id].get() : nullptr;
+    if (!recordings_.empty())
+    {
+        read(id, macro ? macro->hash : undefined);
+    }
+
+    return macro;
+}
+
+
+const Macro *MacroEnvironment::find(const std::string &name)
+{
+    Interner::Id id = identifiers_.find(name);
+    if (id == Interner::none)
+    {
+        if (!recordings_.empty())
+        {
+            read(identifiers_.intern(name), undefined);
+        }
+
+        return nullptr;
+    }
+
+    return find(id);
+}
+
+
+//
+// Look up a macro without recording it.
+//
+
+std::shared_ptr<const Macro> MacroEnvironment::get(const std::string &name) const
+{
+    Interner::Id id = identifiers_.find(name);
+    return id == Interner::none ? nullptr : get(id);
+}
+
+
+uint64_t MacroEnvironment::hash(const std::string &name) const
+{
+    std::shared_ptr<const Macro> macro = get(name);
+    return macro ? macro->hash : undefined;
+}
+
+
+//
+// Define a macro, replacing any definition it already has.
+//
+
+void MacroEnvironment::define(const std::shared_ptr<const Macro> &macro)
+{
+    macro->intern(identifiers_);
+    Interner::Id id = macro->id();
+    if (id >= macros_.size())
+    {
+        macros_.resize(std::max<size_t>(id + 1, macros_.size() * 2));
+    }
+
+    if (!macros_[id])
+    {
+        size_++;
+    }
+
+    macros_[id] = macro;
+    if (!recordings_.empty())
+    {
+        recordings_.back().writes.insert(id);
+    }
+}
+
+
+//
+// Undefine a macro. It doesn't matter if it isn't defined.
+//
+
+void MacroEnvironment::undefine(const std::string &name)
+{
+    Interner::Id id = identifiers_.find(name);
+    if (id != Interner::none && id < macros_.size() && macros_[id])
+    {
+        macros_[id].reset();
+        size_--;
+    }
+
+    if (!recordings_.empty())
+    {
+        recordings_.back().writes.insert(id != Interner::none ? id : identifiers_.intern(name));
+    }
+}
+
+
+//
+// Record the value of a macro which was read. Only the first read counts,
+// and not even that if the header has already changed the macro.
+//
+
+void MacroEnvironment::read(Interner::Id id, uint64_t hash)
+{
+    IdRecording &recording = recordings_.back();
+    if (recording.writes.find(id) == recording.writes.end())
+    {
+        recording.reads.emplace(id, hash);
+    }
+}
+
+
+//
+// Stop recording the innermost header, and add what it did to the
+// header which included it. What it did is given by the macros' names.
+//
+
+MacroEnvironment::Recording MacroEnvironment::endRecording()
+{
+    IdRecording ended = std::move(recordings_.back());
+    recordings_.pop_back();
+    if (!recordings_.empty())
+    {
+        for (const auto &read : ended.reads)
+        {
+            this->read(read.first, read.second);
+        }
+
+        recordings_.back().writes.insert(ended.writes.begin(), ended.writes.end());
+    }
+
+    Recording recording;
+    recording.reads.reserve(ended.reads.size());
+    for (const auto &read : ended.reads)
+    {
+        recording.reads.emplace(identifiers_.text(read.first), read.second);
+    }
+
+    recording.writes.reserve(ended.writes.size());
+    for (Interner::Id id : ended.writes)
+    {
+        recording.writes.emplace(identifiers_.text(id));
+    }
+
+    return recording;
+}
+
+
+//
+// Record reads made somewhere else.
+//
+
+void MacroEnvironment::addReads(const std::vector<std::pair<std::string, uint64_t>> &reads)
+{
+    if (recordings_.empty())
+        return;
+
+    for (const auto &read : reads)
+    {
+        this->read(identifiers_.intern(read.first), read.second);
+    }
+}
+
+
+} // namespace deepC
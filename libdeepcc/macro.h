@@ -0,0 +1,154 @@
+#ifndef DEEPC_MACRO_H
+#define DEEPC_MACRO_H
+
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+#include "interner.h"
+#include "token.h"
+
+
+namespace deepC
+{
+
+
+//
+// A macro definition. The replacement list is kept as text with a single
+// space wherever there was whitespace between its tokens, which is how
+// two definitions are compared and how a definition is stored. It's lexed
+// once into tokens which refer to that text.
+//
+// The interned ids of the name and of the identifiers in the replacement
+// list are worked out the first time they're wanted, as macros loaded
+// from the program database are made without an Interner. A macro is only
+// ever used with one Interner, and once it's been defined it's immutable
+// apart from that, so it can be shared between threads.
+//
+
+struct Macro
+{
+    std::string              name;
+    bool                     functionLike;
+    bool                     variadic;      // The last parameter takes the rest of the arguments.
+    std::vector<std::string> params;        // A plain ... is called __VA_ARGS__.
+    std::string              body;          // The replacement list.
+    std::vector<Token>       tokens;        // The replacement list's tokens, in body.
+    std::vector<int>         tokenParams;   // The parameter each token names, or -1.
+    std::vector<SourceLoc>   tokenLocs;     // Where each token was written in its #define, if it's known.
+    uint64_t                 hash;          // Identifies the definition, and is never 0.
+
+    Macro(const std::string &name, bool functionLike, bool variadic, const std::vector<std::string> &params, const std::string &body);
+
+    // Get the index of a parameter, or -1 if it isn't one.
+    int param(std::string_view name) const;
+
+    // The text of one of the replacement list's tokens.
+    std::string_view text(size_t i) const { return tokens[i].text(body); }
+
+    // Work out the interned ids, if they haven't been already.
+    void intern(Interner &identifiers) const;
+
+    // The id of the name, and of each of the replacement list's tokens
+    // or Interner::none if it isn't an identifier. Only once intern() has
+    // been called.
+    Interner::Id id() const                { return id_; }
+    Interner::Id tokenId(size_t i) const   { return tokenIds_[i]; }
+
+private:
+    mutable std::once_flag            internOnce_;
+    mutable Interner::Id              id_;
+    mutable std::vector<Interner::Id> tokenIds_;
+};
+
+
+//
+// The macros defined at some point while preprocessing. They're kept in a
+// table indexed by the interned ids of their names.
+//
+// While a header is being preprocessed its use of the environment can be
+// recorded: the value of each macro it looked up before it changed it,
+// and each macro it changed. A header which reads the same values again
+// will make the same changes, so those are all that need checking to
+// reuse what it did last time, see MacroContext. Recordings nest along
+// with the headers, and when one ends what it read and wrote is added to
+// the enclosing one. They're kept by the ids of the macros' names, and
+// only given as names when they end.
+//
+
+class MacroEnvironment
+{
+public:
+    // The hash of a macro which isn't defined.
+    static constexpr uint64_t undefined = 0;
+
+    // What a header read from the environment and changed in it.
+    struct Recording
+    {
+        std::unordered_map<std::string, uint64_t> reads;    // The first value of each macro looked up.
+        std::unordered_set<std::string>           writes;   // The macros defined or undefined.
+    };
+
+private:
+    // A recording which is still going, by the ids of the names.
+    struct IdRecording
+    {
+        std::unordered_map<Interner::Id, uint64_t> reads;
+        std::unordered_set<Interner::Id>           writes;
+    };
+
+    std::unique_ptr<Interner>                  ownIdentifiers_;
+    Interner                                  &identifiers_;
+    std::vector<std::shared_ptr<const Macro>>  macros_;     // By the id of the name.
+    size_t                                     size_;
+    std::vector<IdRecording>                   recordings_;
+
+private:
+    void read(Interner::Id id, uint64_t hash);
+
+public:
+    // Make an environment whose macros are looked up by the ids they have
+    // in an Interner, or in one of its own.
+    explicit MacroEnvironment(Interner &identifiers);
+    MacroEnvironment();
+    MacroEnvironment(const MacroEnvironment &) = delete;
+    MacroEnvironment &operator=(const MacroEnvironment &) = delete;
+
+    // Look up a macro, recording the look up. Returns nullptr if it isn't
+    // defined.
+    const Macro *find(Interner::Id id);
+    const Macro *find(const std::string &name);
+
+    // Look up a macro without recording it.
+    std::shared_ptr<const Macro> get(Interner::Id id) const { return id < macros_.size() ? macros_[id] : nullptr; }
+    std::shared_ptr<const Macro> get(const std::string &name) const;
+    uint64_t hash(const std::string &name) const;
+
+    // Define or undefine a macro.
+    void define(const std::shared_ptr<const Macro> &macro);
+    void undefine(const std::string &name);
+
+    // Record the use of the environment until the matching endRecording().
+    void beginRecording()       { recordings_.emplace_back(); }
+    Recording endRecording();
+    bool recording() const      { return !recordings_.empty(); }
+
+    // Record reads made somewhere else, as when a header's stored changes
+    // are replayed.
+    void addReads(const std::vector<std::pair<std::string, uint64_t>> &reads);
+
+    // The identifiers the macros are looked up by.
+    Interner &identifiers()     { return identifiers_; }
+
+    size_t size() const         { return size_; }
+};
+
+
+} // namespace deepC
+
+#endif // DEEPC_MACRO_H
@@ -0,0 +1,364 @@
+#include "macrocontext.h"
+#include "programdb.h"
+#include "sourcefile.h"
+#include "flatbuffers/flatbuffers.h"
+#include "storedobject_generated.h"
+
+
+namespace deepC
+{
+
+
+//
+// Work out the fingerprint from everything which has to be checked before
+// the context can be reused.
+//
+
+void MacroContext::setFingerprint()
+{
+    std::string data;
+    auto addNumber = [&data](uint64_t n)
+    {
+        data.append(reinterpret_cast<const char *>(&n), sizeof(n));
+    };
+
+    for (const auto &read : reads)
+    {
+        data += read.first;
+        data.push_back('\0');
+        addNumber(read.second);
+    }
+
+    data.push_back('\0');
+    for (const auto &read : onceReads)
+    {
+        data += read.first;
+        data.push_back(read.second ? '\1' : '\0');
+    }
+
+    data.push_back('\0');
+    for (const Inclusion &inclusion : inclusions)
+    {
+        data += inclusion.name;
+        data.push_back(inclusion.angled ? '>' : '"');
+        data += inclusion.includerDir;
+        data.push_back('\0');
+        data += inclusion.fileName;
+        data.push_back('\0');
+        addNumber(inclusion.firstDir);
+        addNumber(inclusion.digest.hash);
+        addNumber(inclusion.digest.size);
+    }
+
+    fingerprint = xxHash64(data.data(), data.size());
+}
+
+
+//
+// Add a context unless there's already one with the same fingerprint.
+// The oldest ones go once there are too many.
+//
+
+bool HeaderMacroContexts::add(const std::shared_ptr<const MacroContext> &context)
+{
+    for (const auto &existing : contexts_)
+    {
+        if (existing->fingerprint == context->fingerprint)
+            return false;
+    }
+
+    if (contexts_.size() >= maxContexts)
+    {
+        contexts_.erase(contexts_.begin());
+    }
+
+    contexts_.push_back(context);
+    return true;
+}
+
+
+//
+// Serialise the content of this object so it can be stored in the database.
+//
+
+void HeaderMacroContexts::serialiseContent(flatbuffers::FlatBufferBuilder &builder) const
+{
+    std::vector<flatbuffers::Offset<fb::MacroContext>> contexts;
+    for (const auto &context : contexts_)
+    {
+        std::vector<flatbuffers::Offset<fb::MacroRead>> reads;
+        for (const auto &read : context->reads)
+        {
+            reads.push_back(fb::CreateMacroRead(builder, builder.CreateString(read.first), read.second));
+        }
+
+        std::vector<flatbuffers::Offset<fb::OnceRead>> onceReads;
+        for (const auto &read : context->onceReads)
+        {
+            onceReads.push_back(fb::CreateOnceRead(builder, builder.CreateString(read.first), read.second));
+        }
+
+        std::vector<flatbuffers::Offset<fb::Inclusion>> inclusions;
+        for (const MacroContext::Inclusion &inclusion : context->inclusions)
+        {
+            fb::Digest digest(inclusion.digest.hash, inclusion.digest.size);
+            inclusions.push_back(fb::CreateInclusion(builder, builder.CreateString(inclusion.name), inclusion.angled, builder.CreateString(inclusion.includerDir),
+                                                     inclusion.firstDir, builder.CreateString(inclusion.fileName), &digest, inclusion.entered));
+        }
+
+        std::vector<flatbuffers::Offset<fb::MacroChange>> changes;
+        for (const MacroContext::MacroChange &change : context->changes)
+        {
+            const Macro *macro = change.macro.get();
+            std::vector<flatbuffers::Offset<flatbuffers::String>> params;
+            if (macro)
+            {
+                for (const std::string &param : macro->params)
+                {
+                    params.push_back(builder.CreateString(param));
+                }
+            }
+
+            auto paramsVec = builder.CreateVector(params);
+            auto body = builder.CreateString(macro ? macro->body : std::string());
+            changes.push_back(fb::CreateMacroChange(builder, builder.CreateString(change.name), macro != nullptr,
+                                                    macro && macro->functionLike, macro && macro->variadic, paramsVec, body));
+        }
+
+        std::vector<flatbuffers::Offset<flatbuffers::String>> onceFiles;
+        for (const std::string &fileName : context->onceFiles)
+        {
+            onceFiles.push_back(builder.CreateString(fileName));
+        }
+
+        auto readsVec = builder.CreateVector(reads);
+        auto onceReadsVec = builder.CreateVector(onceReads);
+        auto inclusionsVec = builder.CreateVector(inclusions);
+        auto changesVec = builder.CreateVector(changes);
+        auto onceFilesVec = builder.CreateVector(onceFiles);
+        uint8_t *blob = nullptr;
+        auto output = builder.CreateUninitializedVector(context->output.blobSize(), &blob);
+        context->output.writeBlob(blob);
+        contexts.push_back(fb::CreateMacroContext(builder, context->fingerprint, readsVec, onceReadsVec, inclusionsVec, changesVec,
+                                                  onceFilesVec, output, context->skippedIncludes));
+    }
+
+    auto contextsVec = builder.CreateVector(contexts);
+    fb::Digest digest(digest_.hash, digest_.size);
+    auto header = fb::CreateHeaderMacroContexts(builder, sourceFileId_, &digest, contextsVec);
+    fb::FinishStoredObjectBuffer(builder, fb::CreateStoredObject(builder, fb::StoredAny_HeaderMacroContexts, header.Union()));
+}
+
+
+//
+// Serialise the key of this object so it can be found in the database.
+//
+
+void HeaderMacroContexts::serialiseKey(flatbuffers::FlatBufferBuilder &builder) const
+{
+    serialiseKey(builder, sourceFileId_);
+}
+
+
+//
+// Serialise the key for the macro contexts of a given source file.
+//
+
+void HeaderMacroContexts::serialiseKey(flatbuffers::FlatBufferBuilder &builder, uint32_t sourceFileId)
+{
+    auto idKey = fb::CreateIdKey(builder, sourceFileId);
+    fb::FinishStoredObjectBuffer(builder, fb::CreateStoredObject(builder, fb::StoredAny_IdKey, idKey.Union()));
+}
+
+
+//
+// Fill out this object from a database serialised form.
+//
+
+void HeaderMacroContexts::unserialise(const fb::StoredObject &so)
+{
+    auto str = [](const flatbuffers::String *s)
+    {
+        return s ? s->str() : std::string();
+    };
+
+    const fb::HeaderMacroContexts *header = so.obj_as_HeaderMacroContexts();
+    sourceFileId_ = header->source_file();
+    if (header->digest())
+    {
+        digest_ = ContentDigest(header->digest()->hash(), header->digest()->size());
+    }
+
+    contexts_.clear();
+    if (!header->contexts())
+        return;
+
+    for (const fb::MacroContext *stored : *header->contexts())
+    {
+        auto context = std::make_shared<MacroContext>();
+        context->fingerprint = stored->fingerprint();
+        context->skippedIncludes = stored->skipped_includes();
+        context->loaded = true;
+        // Output which isn't a valid token stream is from an older version.
+        if (stored->output() && !context->output.assign(stored->output()->data(), stored->output()->size()))
+            continue;
+
+        if (stored->reads())
+        {
+            for (const fb::MacroRead *read : *stored->reads())
+            {
+                context->reads.emplace_back(str(read->name()), read->hash());
+            }
+        }
+
+        if (stored->once_reads())
+        {
+            for (const fb::OnceRead *read : *stored->once_reads())
+            {
+                context->onceReads.emplace_back(str(read->file_name()), read->included());
+            }
+        }
+
+        if (stored->inclusions())
+        {
+            for (const fb::Inclusion *inclusion : *stored->inclusions())
+            {
+                MacroContext::Inclusion loaded;
+                loaded.name = str(inclusion->name());
+                loaded.angled = inclusion->angled();
+                loaded.includerDir = str(inclusion->includer_dir());
+                loaded.firstDir = inclusion->first_dir();
+                loaded.fileName = str(inclusion->file_name());
+                if (inclusion->digest())
+                {
+                    loaded.digest = ContentDigest(inclusion->digest()->hash(), inclusion->digest()->size());
+                }
+
+                loaded.entered = inclusion->entered();
+                context->inclusions.push_back(loaded);
+            }
+        }
+
+        if (stored->changes())
+        {
+            for (const fb::MacroChange *change : *stored->changes())
+            {
+                MacroContext::MacroChange loaded;
+                loaded.name = str(change->name());
+                if (change->defined())
+                {
+                    std::vector<std::string> params;
+                    if (change->params())
+                    {
+                        for (const flatbuffers::String *param : *change->params())
+                        {
+                            params.push_back(str(param));
+                        }
+                    }
+
+                    loaded.macro = std::make_shared<Macro>(loaded.name, change->function_like(), change->variadic(), params, str(change->body()));
+                }
+
+                context->changes.push_back(loaded);
+            }
+        }
+
+        if (stored->once_files())
+        {
+            for (const flatbuffers::String *fileName : *stored->once_files())
+            {
+                context->onceFiles.push_back(str(fileName));
+            }
+        }
+
+        contexts_.push_back(context);
+    }
+}
+
+
+//
+// Get the contexts a header has been included in before. They're
+// forgotten if the header has changed since, or might have.
+//
+
+std::vector<std::shared_ptr<const MacroContext>> MacroContextCache::find(const SourceFile &header, bool sameAsStored)
+{
+    {
+        std::lock_guard<std::mutex> locker(mutex_);
+        auto it = headers_.find(header.id());
+        if (it != headers_.end() && it->second->digest() == header.digest())
+            return it->second->contexts();
+    }
+
+    std::shared_ptr<HeaderMacroContexts> stored = pdb_->getHeaderMacroContexts(header.id());
+
+    std::lock_guard<std::mutex> locker(mutex_);
+    auto &contexts = headers_[header.id()];
+    if (!contexts)
+    {
+        contexts = stored;
+    }
+
+    if (!contexts || contexts->digest() != header.digest() || (contexts == stored && !sameAsStored))
+    {
+        auto fresh = std::make_shared<HeaderMacroContexts>(header.id(), header.digest());
+        if (contexts)
+        {
+            fresh->setId(contexts->id());
+        }
+
+        contexts = fresh;
+    }
+
+    return contexts->contexts();
+}
+
+
+//
+// Add a context a header has been included in.
+//
+
+void MacroContextCache::add(const SourceFile &header, const std::shared_ptr<const MacroContext> &context)
+{
+    std::lock_guard<std::mutex> locker(mutex_);
+    auto &contexts = headers_[header.id()];
+    if (!contexts || contexts->digest() != header.digest())
+    {
+        auto fresh = std::make_shared<HeaderMacroContexts>(header.id(), header.digest());
+        if (contexts)
+        {
+            fresh->setId(contexts->id());
+        }
+
+        contexts = fresh;
+    }
+
+    if (contexts->add(context))
+    {
+        unstored_.insert(header.id());
+    }
+}
+
+
+//
+// Store the headers which have new contexts.
+//
+
+void MacroContextCache::store()
+{
+    std::lock_guard<std::mutex> locker(mutex_);
+    if (unstored_.empty())
+        return;
+
+    ProgramDb::Batch batch(*pdb_);
+    for (uint32_t id : unstored_)
+    {
+        batch.put(*headers_[id]);
+    }
+
+    batch.commit();
+    unstored_.clear();
+}
+
+
+} // namespace deepC
@@ -0,0 +1,158 @@
+#ifndef DEEPC_MACROCONTEXT_H
+#define DEEPC_MACROCONTEXT_H
+
+#include <atomic>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <unordered_set>
+#include <utility>
+#include <vector>
+
+#include "contenthash.h"
+#include "macro.h"
+#include "pptokenstream.h"
+#include "storable.h"
+
+
+namespace deepC
+{
+
+
+// Forward declarations.
+class ProgramDb;
+class SourceFile;
+
+
+//
+// What preprocessing a header did when it was included in a particular
+// context, which is enough to do it again without the header's tokens.
+//
+// The context is everything that preprocessing read from outside the
+// header: the value of each macro it looked up before it changed it, the
+// #pragma once state of the headers it included, and where its #includes
+// were found. If those are the same at a later inclusion, preprocessing
+// would make the same changes to the macros and the same output, so the
+// changes are replayed and the output copied instead.
+//
+// The reads, writes and output cover the headers it includes as well.
+//
+
+struct MacroContext
+{
+    // An #include the header made, or one of the headers it included made.
+    struct Inclusion
+    {
+        std::string   name;         // The header name, after any macros are expanded.
+        bool          angled;
+        std::string   includerDir;  // Where a "name" is looked for first.
+        uint32_t      firstDir;     // Which include path directory #include_next starts at, or 0.
+        std::string   fileName;     // Where it was found, or empty if it wasn't.
+        ContentDigest digest;       // The text of the file which was found.
+        bool          entered;      // It was preprocessed rather than skipped.
+    };
+
+    // A macro the header defined or undefined, as it was at the end.
+    struct MacroChange
+    {
+        std::string                  name;
+        std::shared_ptr<const Macro> macro;     // nullptr if it was undefined.
+    };
+
+    uint64_t                                      fingerprint;  // A hash of everything below which is checked.
+    std::vector<std::pair<std::string, uint64_t>> reads;        // Each macro read and its hash, by name.
+    std::vector<std::pair<std::string, bool>>     onceReads;    // Headers whose #pragma once state was looked at.
+    std::vector<Inclusion>                        inclusions;   // In the order they were made.
+    std::vector<MacroChange>                      changes;      // By name.
+    std::vector<std::string>                      onceFiles;    // Headers it marked #pragma once.
+    PpTokenStream                                 output;       // The preprocessed tokens, holding their own text.
+    size_t                                        skippedIncludes;  // Repeat inclusions it skipped.
+    bool                                          loaded;       // From the program database rather than this run.
+
+    MacroContext() : fingerprint(0), skippedIncludes(0), loaded(false) {}
+
+    // Work out the fingerprint from what's been read.
+    void setFingerprint();
+};
+
+
+//
+// The contexts a header has been included in, as stored in the program
+// database along with the digest of the header's text. A few contexts
+// are kept, most recent last.
+//
+
+class HeaderMacroContexts : public Storable
+{
+public:
+    // How many contexts are kept for each header.
+    static constexpr size_t maxContexts = 8;
+
+private:
+    uint32_t                                   sourceFileId_;
+    ContentDigest                              digest_;
+    std::vector<std::shared_ptr<const MacroContext>> contexts_;
+
+public:
+    // Constructors.
+    explicit HeaderMacroContexts(uint32_t sourceFileId, const ContentDigest &digest) : sourceFileId_(sourceFileId), digest_(digest) {}
+    explicit HeaderMacroContexts(uint32_t id, const std::shared_ptr<ProgramDbSnapshot> &) : Storable(id), sourceFileId_(0) {}
+
+    // Accessors.
+    uint32_t             sourceFileId() const { return sourceFileId_; }
+    const ContentDigest &digest() const       { return digest_; }
+    const std::vector<std::shared_ptr<const MacroContext>> &contexts() const { return contexts_; }
+
+    // Add a context unless there's one with the same fingerprint. Returns
+    // true if it was added.
+    bool add(const std::shared_ptr<const MacroContext> &context);
+
+    // Which databases to use for the content and the key mapping.
+    DbGroup contentDbGroup() const override { return Storable::DbGroup::MacroContexts; }
+    DbGroup keyDbGroup() const override     { return Storable::DbGroup::MacroContextKeys; }
+
+    // To store this type in the database.
+    void serialiseContent(flatbuffers::FlatBufferBuilder &builder) const override;
+    void serialiseKey(flatbuffers::FlatBufferBuilder &builder) const override;
+    void unserialise(const fb::StoredObject &so) override;
+
+    // Serialise the key for a source file, to look it up without an object.
+    static void serialiseKey(flatbuffers::FlatBufferBuilder &builder, uint32_t sourceFileId);
+};
+
+
+//
+// The macro contexts of the headers used in a run. Each header's are
+// loaded from the program database the first time they're wanted, and
+// new ones are kept until store() is called. It's safe to use from
+// several threads at once.
+//
+
+class MacroContextCache
+{
+private:
+    std::shared_ptr<ProgramDb> pdb_;
+    std::mutex                 mutex_;
+    std::unordered_map<uint32_t, std::shared_ptr<HeaderMacroContexts>> headers_;
+    std::unordered_set<uint32_t> unstored_;     // Headers with new contexts.
+
+public:
+    explicit MacroContextCache(std::shared_ptr<ProgramDb> pdb) : pdb_(pdb) {}
+
+    // Get the contexts a header has been included in before. The stored
+    // ones are only used if the header's text is the text they were
+    // stored with.
+    std::vector<std::shared_ptr<const MacroContext>> find(const SourceFile &header, bool sameAsStored);
+
+    // Add a context a header has been included in.
+    void add(const SourceFile &header, const std::shared_ptr<const MacroContext> &context);
+
+    // Store the headers with new contexts.
+    void store();
+};
+
+
+} // namespace deepC
+
+#endif // DEEPC_MACROCONTEXT_H
@@ -0,0 +1,580 @@
+#include <algorithm>
+#include <iterator>
+
+#include "macroexpander.h"
+#include "clexer.h"
+
+
+namespace deepC
+{
+
+
+//
+// Constructor.
+//
+
+MacroExpander::MacroExpander(MacroEnvironment &env, Builtins *builtins) :
+    env_(env),
+    identifiers_(env.identifiers()),
+    builtins_(builtins),
+    keepDefined_(false),
+    definedId_(identifiers_.intern("defined")),
+    newSpellings_(&spellings_),
+    memo_(nullptr),
+    memoInput_(nullptr),
+    memoHits_(0)
+{
+}
+
+
+//
+// Get the next token from a vector.
+//
+
+bool MacroExpander::VectorSource::next(PpToken *token)
+{
+    if (pos_ >= tokens_.size())
+        return false;
+
+    *token = tokens_[pos_++];
+    return true;
+}
+
+
+//
+// Expand all the tokens from a source.
+//
+
+void MacroExpander::expand(Source &source, std::vector<PpToken> *out)
+{
+    spellings_.clear();
+    retired_.clear();
+    Input in(&source);
+    expand(in, out);
+}
+
+
+//
+// Get the next token to look at.
+//
+
+bool MacroExpander::next(Input &in, PpToken *token)
+{
+    if (!in.pending.empty())
+    {
+        *token = std::move(in.pending.front());
+        in.pending.pop_front();
+        return true;
+    }
+
+    return in.source->next(token);
+}
+
+
+//
+// Expand the tokens of some input. The results of each expansion are put
+// back in front of the rest of the input to be looked at again.
+//
+
+void MacroExpander::expand(Input &in, std::vector<PpToken> *out)
+{
+    PpToken token;
+    while (next(in, &token))
+    {
+        if (token.kind != TokenKind::Identifier)
+        {
+            out->push_back(std::move(token));
+            continue;
+        }
+
+        if (token.id == Interner::none)
+        {
+            token.id = identifiers_.intern(token.text);
+        }
+
+        if (keepDefined_ && token.id == definedId_)
+        {
+            // Pass on "defined X" or "defined ( X )" as it is.
+            out->push_back(std::move(token));
+            bool paren = false;
+            while (next(in, &token))
+            {
+                paren = paren || token.punctuator() == Punctuator::LeftParen;
+                bool last = !paren || token.punctuator() == Punctuator::RightParen;
+                out->push_back(std::move(token));
+                if (last)
+                    break;
+            }
+
+            continue;
+        }
+
+        bool hidden = HideSetTable::contains(token.hideSet, token.id);
+        const Macro *macro = hidden ? nullptr : lookup(token.id);
+        if (!macro)
+        {
+            PpToken result;
+            std::string_view name = token.text;
+            if (builtins_ && name.size() > 2 && name[0] == '_' && name[1] == '_' && !hidden &&
+                builtins_->expandBuiltin(token, &result))
+            {
+                if (memo_)
+                {
+                    memo_->usable = false;
+                }
+
+                out->push_back(std::move(result));
+            }
+            else
+            {
+                out->push_back(std::move(token));
+            }
+
+            continue;
+        }
+
+        std::vector<PpToken> result;
+        if (!macro->functionLike)
+        {
+            if (!memo_ && !keepDefined_ && expandMemoised(*macro, token, out))
+                continue;
+
+            substitute(*macro, token, std::vector<std::vector<PpToken>>(), hideSets_.add(token.hideSet, token.id), &result);
+        }
+        else
+        {
+            // It's only an invocation if the next token is a '('.
+            PpToken leftParen;
+            if (!next(in, &leftParen))
+            {
+                if (&in == memoInput_)
+                {
+                    // The '(' could come from after the macro being memoised.
+                    memo_->usable = false;
+                }
+
+                out->push_back(std::move(token));
+                continue;
+            }
+
+            if (leftParen.punctuator() != Punctuator::LeftParen)
+            {
+                in.pending.push_front(std::move(leftParen));
+                out->push_back(std::move(token));
+                continue;
+            }
+
+            std::vector<std::vector<PpToken>> args;
+            PpToken rightParen;
+            collectArgs(in, *macro, &args, &rightParen);
+
+            const HideSet *hideSet = hideSets_.add(hideSets_.intersect(token.hideSet, rightParen.hideSet), token.id);
+            substitute(*macro, token, args, hideSet, &result);
+        }
+
+        in.pending.insert(in.pending.begin(), std::make_move_iterator(result.begin()), std::make_move_iterator(result.end()));
+    }
+}
+
+
+//
+// Look up a macro, noting the look up if an expansion is being memoised.
+//
+
+const Macro *MacroExpander::lookup(Interner::Id id)
+{
+    const Macro *macro = env_.find(id);
+    if (memo_)
+    {
+        memo_->uses.emplace_back(id, macro ? macro->hash : MacroEnvironment::undefined);
+    }
+
+    return macro;
+}
+
+
+//
+// Collect the arguments of a function like macro, up to and including
+// the closing parenthesis. Parenthesised commas don't separate arguments,
+// and neither do the commas in the variable arguments.
+//
+
+void MacroExpander::collectArgs(Input &in, const Macro &macro, std::vector<std::vector<PpToken>> *args, PpToken *rightParen)
+{
+    args->emplace_back();
+    int depth = 0;
+    PpToken token;
+    for (;;)
+    {
+        if (!next(in, &token))
+            throw MacroException("unterminated argument list invoking macro \"" + macro.name + "\"");
+
+        Punctuator punct = token.punctuator();
+        if (punct == Punctuator::LeftParen)
+        {
+            depth++;
+        }
+        else if (punct == Punctuator::RightParen)
+        {
+            if (depth == 0)
+            {
+                *rightParen = std::move(token);
+                break;
+            }
+
+            depth--;
+        }
+        else if (punct == Punctuator::Comma && depth == 0 && !(macro.variadic && args->size() == macro.params.size()))
+        {
+            args->emplace_back();
+            continue;
+        }
+
+        // A line break in an argument is just whitespace.
+        if (token.flags & Token::StartOfLine)
+        {
+            token.flags = (token.flags & ~Token::StartOfLine) | Token::PrecededBySpace;
+        }
+
+        args->back().push_back(std::move(token));
+    }
+
+    size_t given = args->size();
+    size_t wanted = macro.params.size();
+    if (wanted == 0 && given == 1 && args->front().empty())
+    {
+        args->clear();
+    }
+    else if (macro.variadic && given == wanted - 1)
+    {
+        args->emplace_back();
+    }
+    else if (given != wanted)
+    {
+        throw MacroException("macro \"" + macro.name + "\" given " + std::to_string(given) + " arguments, but takes " + std::to_string(wanted));
+    }
+}
+
+
+//
+// Substitute the arguments into a macro's replacement list, and apply #
+// and ##. The results are marked with the hide set, and the first one
+// takes the place of the macro's name.
+//
+
+void MacroExpander::substitute(const Macro &macro, const PpToken &name, const std::vector<std::vector<PpToken>> &args, const HideSet *hideSet, std::vector<PpToken> *result)
+{
+    std::vector<std::vector<PpToken>> expandedArgs(args.size());
+    std::vector<bool> haveExpanded(args.size(), false);
+    bool pasteNext = false;     // The previous token was ##.
+    bool lastEmpty = false;     // The last thing substituted was an empty argument.
+    size_t count = macro.tokens.size();
+    for (size_t i = 0; i < count; i++)
+    {
+        const Token &bodyToken = macro.tokens[i];
+        Punctuator punct = bodyToken.punctuator();
+        if (isPaste(punct))
+        {
+            pasteNext = true;
+            continue;
+        }
+
+        std::vector<PpToken> items;
+        int param = macro.tokenParams[i];
+        int stringized = macro.functionLike && isStringize(punct) && i + 1 < count ? macro.tokenParams[i + 1] : -1;
+        if (stringized >= 0)
+        {
+            items.push_back(stringize(args[stringized], bodyToken));
+            i++;
+        }
+        else if (param >= 0)
+        {
+            // The operands of ## aren't expanded first.
+            if (pasteNext || (i + 1 < count && isPaste(macro.tokens[i + 1].punctuator())))
+            {
+                items = args[param];
+            }
+            else
+            {
+                if (!haveExpanded[param])
+                {
+                    VectorSource source(args[param]);
+                    Input in(&source);
+                    expand(in, &expandedArgs[param]);
+                    haveExpanded[param] = true;
+                }
+
+                items = expandedArgs[param];
+            }
+
+            if (!items.empty())
+            {
+                items.front().flags = (items.front().flags & ~(Token::StartOfLine | Token::PrecededBySpace)) | (bodyToken.flags() & Token::PrecededBySpace);
+            }
+        }
+        else
+        {
+            PpToken token;
+            token.kind = bodyToken.kind();
+            token.subKind = bodyToken.subKind();
+            token.flags = bodyToken.flags();
+            token.id = macro.tokenId(i);
+            token.text = macro.text(i);
+            if (!macro.tokenLocs.empty())
+            {
+                token.original = macro.tokenLocs[i];
+            }
+
+            items.push_back(std::move(token));
+        }
+
+        bool empty = items.empty();
+        if (pasteNext)
+        {
+            pasteNext = false;
+
+            // A comma before ## __VA_ARGS__ goes if there aren't any
+            // variable arguments, and otherwise nothing is pasted.
+            if (macro.variadic && param == static_cast<int>(macro.params.size()) - 1 && i >= 2 &&
+                macro.tokens[i - 2].punctuator() == Punctuator::Comma && !result->empty() && !lastEmpty)
+            {
+                if (empty)
+                {
+                    result->pop_back();
+                    lastEmpty = true;
+                    continue;
+                }
+            }
+            else if (empty)
+            {
+                // Pasting an empty argument leaves the other side as it is.
+                continue;
+            }
+            else if (!lastEmpty && !result->empty())
+            {
+                result->back() = paste(result->back(), items.front());
+                items.erase(items.begin());
+            }
+        }
+
+        lastEmpty = empty;
+        result->insert(result->end(), std::make_move_iterator(items.begin()), std::make_move_iterator(items.end()));
+    }
+
+    for (PpToken &token : *result)
+    {
+        token.hideSet = hideSets_.unite(token.hideSet, hideSet);
+        token.expanded = true;
+        token.loc = name.loc;
+    }
+
+    if (!result->empty())
+    {
+        PpToken &first = result->front();
+        first.flags = (first.flags & ~(Token::StartOfLine | Token::PrecededBySpace)) | (name.flags & (Token::StartOfLine | Token::PrecededBySpace));
+    }
+}
+
+
+//
+// Make a string literal from the spelling of an argument.
+//
+
+PpToken MacroExpander::stringize(const std::vector<PpToken> &arg, const Token &hash)
+{
+    std::string text = "\"";
+    for (size_t i = 0; i < arg.size(); i++)
+    {
+        const PpToken &token = arg[i];
+        if (i > 0 && (token.flags & (Token::StartOfLine | Token::PrecededBySpace)))
+        {
+            text.push_back(' ');
+        }
+
+        if (token.kind == TokenKind::StringLiteral || token.kind == TokenKind::CharacterConstant)
+        {
+            for (char c : token.text)
+            {
+                if (c == '"' || c == '\\')
+                {
+                    text.push_back('\\');
+                }
+
+                text.push_back(c);
+            }
+        }
+        else
+        {
+            text += token.text;
+        }
+    }
+
+    text.push_back('"');
+    newSpellings_->push_back(std::move(text));
+
+    PpToken result;
+    result.kind = TokenKind::StringLiteral;
+    result.flags = hash.flags();
+    result.text = newSpellings_->back();
+    return result;
+}
+
+
+//
+// Paste two tokens together with ##. The result has to be a single token.
+//
+
+PpToken MacroExpander::paste(const PpToken &left, const PpToken &right)
+{
+    std::string text = std::string(left.text) + std::string(right.text);
+    CLexer lexer(text);
+    Token token;
+    Token after;
+    if (!lexer.next(&token) || token.length() != text.size() || lexer.next(&after))
+        throw MacroException("pasting \"" + std::string(left.text) + "\" and \"" + std::string(right.text) + "\" does not give a valid preprocessing token");
+
+    newSpellings_->push_back(std::move(text));
+
+    PpToken result = left;
+    result.kind = token.kind();
+    result.subKind = token.subKind();
+    result.id = Interner::none;
+    result.text = newSpellings_->back();
+    result.original = SourceLoc();
+    return result;
+}
+
+
+//
+// Use the memoised expansion of an object like macro, working it out if
+// there isn't one or the macros it used have changed since. Returns false
+// if it can't be used here, and the macro has to be expanded as usual.
+//
+
+bool MacroExpander::expandMemoised(const Macro &macro, const PpToken &name, std::vector<PpToken> *out)
+{
+    Memo &memo = memos_[name.id];
+    bool valid = memo.hash == macro.hash;
+    if (valid && !memo.usable)
+        return false;
+
+    if (valid)
+    {
+        for (const auto &use : memo.uses)
+        {
+            const Macro *used = env_.find(use.first);
+            if ((used ? used->hash : MacroEnvironment::undefined) != use.second)
+            {
+                valid = false;
+                break;
+            }
+        }
+    }
+
+    if (!valid)
+    {
+        retired_.push_back(std::move(memo.spellings));
+        memoise(macro, &memo);
+        if (!memo.usable)
+            return false;
+    }
+
+    // A macro it used mustn't be hidden where it's being used now.
+    for (const auto &use : memo.uses)
+    {
+        if (HideSetTable::contains(name.hideSet, use.first))
+            return false;
+    }
+
+    if (valid)
+    {
+        memoHits_++;
+    }
+
+    size_t first = out->size();
+    for (const PpToken &token : memo.tokens)
+    {
+        out->push_back(token);
+        PpToken &copy = out->back();
+        copy.hideSet = hideSets_.unite(name.hideSet, token.hideSet);
+        copy.loc = name.loc;
+    }
+
+    if (out->size() > first)
+    {
+        PpToken &token = (*out)[first];
+        token.flags = (token.flags & ~(Token::StartOfLine | Token::PrecededBySpace)) | (name.flags & (Token::StartOfLine | Token::PrecededBySpace));
+    }
+
+    return true;
+}
+
+
+//
+// Work out the full expansion of an object like macro on its own. It's
+// marked unusable if it turns out to depend on where it's used.
+//
+
+void MacroExpander::memoise(const Macro &macro, Memo *memo)
+{
+    memo->hash = macro.hash;
+    memo->usable = true;
+    memo->tokens.clear();
+    memo->uses.clear();
+    memo->macros.clear();
+    memo->spellings.clear();
+
+    PpToken name;
+    name.kind = TokenKind::Identifier;
+    name.id = macro.id();
+    name.text = macro.name;
+
+    memo_ = memo;
+    newSpellings_ = &memo->spellings;
+    try
+    {
+        std::vector<PpToken> body;
+        substitute(macro, name, std::vector<std::vector<PpToken>>(), hideSets_.add(nullptr, macro.id()), &body);
+        VectorSource source(body);
+        Input in(&source);
+        memoInput_ = &in;
+        expand(in, &memo->tokens);
+    }
+    catch (const MacroException &)
+    {
+        // It may only be an error here, eg. if it runs into the arguments
+        // of a function like macro which come after it.
+        memo->usable = false;
+    }
+    catch (...)
+    {
+        memo_ = nullptr;
+        memoInput_ = nullptr;
+        newSpellings_ = &spellings_;
+        throw;
+    }
+
+    memo_ = nullptr;
+    memoInput_ = nullptr;
+    newSpellings_ = &spellings_;
+    if (!memo->usable)
+    {
+        memo->tokens.clear();
+        memo->uses.clear();
+        return;
+    }
+
+    std::sort(memo->uses.begin(), memo->uses.end());
+    memo->uses.erase(std::unique(memo->uses.begin(), memo->uses.end()), memo->uses.end());
+    memo->macros.push_back(env_.get(macro.id()));
+    for (const auto &use : memo->uses)
+    {
+        if (use.second != MacroEnvironment::undefined)
+        {
+            memo->macros.push_back(env_.get(use.first));
+        }
+    }
+}
+
+
+} // namespace deepC
@@ -0,0 +1,206 @@
+#ifndef DEEPC_MACROEXPANDER_H
+#define DEEPC_MACROEXPANDER_H
+
+#include <deque>
+#include <exception>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include "hideset.h"
+#include "interner.h"
+#include "macro.h"
+#include "token.h"
+
+
+namespace deepC
+{
+
+
+//
+// A token being preprocessed. A token from a source file refers to the
+// file's text, and one made by macro expansion refers to the macro's
+// replacement list or to text the expander made.
+//
+// An identifier's interned id can be left as Interner::none, and the
+// expander works it out from the text.
+//
+
+struct PpToken
+{
+    TokenKind             kind;
+    uint8_t               subKind;
+    uint8_t               flags;        // See Token::Flags.
+    bool                  expanded;     // It was made by expanding a macro.
+    Interner::Id          id;           // The interned id of an identifier.
+    std::string_view      text;
+    SourceLoc             loc;          // Where it is, or where the macro it came from was used.
+    SourceLoc             original;     // Where it was written, if it was.
+    const HideSet        *hideSet;      // The macros which made it, which mustn't expand it again.
+
+    PpToken() : kind(TokenKind::EndOfFile), subKind(0), flags(0), expanded(false), id(Interner::none), hideSet(nullptr) {}
+
+    Punctuator punctuator() const { return kind == TokenKind::Punctuator ? static_cast<Punctuator>(subKind) : Punctuator::None; }
+};
+
+
+//
+// Expands macros in a run of tokens, using the hide set algorithm from
+// Dave Prosser's notes on the C standard's rules. Each token carries the
+// set of macros whose expansion produced it, and a macro isn't expanded
+// again in any token whose hide set includes it. Macros are looked up by
+// their interned ids, and hide sets are shared, see HideSetTable.
+//
+// The full expansion of an object like macro is kept and reused while
+// the macros it used keep the same definitions, as long as it didn't
+// depend on where it was used: on a builtin like __LINE__, or on tokens
+// after it which a function like macro at its end could take as
+// arguments. Looking the macros up again records them as read, so using
+// a memoised expansion is the same to a MacroContext as expanding it.
+//
+// Arguments are fully expanded before they're substituted, except where
+// they're the operand of # or ##. The GNU extension where , ## __VA_ARGS__
+// drops the comma if there are no variable arguments is supported.
+//
+// Tokens which the expander makes, by # or ##, refer to text it keeps
+// until the next call to expand().
+//
+
+class MacroExpander
+{
+public:
+    // Where the tokens to expand come from. The invocation of a function
+    // like macro can take as many tokens from it as it needs.
+    class Source
+    {
+    public:
+        virtual ~Source() {}
+        virtual bool next(PpToken *token) = 0;
+    };
+
+    // A source of tokens which are already in a vector.
+    class VectorSource : public Source
+    {
+        const std::vector<PpToken> &tokens_;
+        size_t                      pos_;
+
+    public:
+        explicit VectorSource(const std::vector<PpToken> &tokens) : tokens_(tokens), pos_(0) {}
+
+        bool next(PpToken *token) override;
+    };
+
+    // Expands the predefined macros whose values depend on where they're
+    // used, like __LINE__. Returns false if the token isn't one of them.
+    class Builtins
+    {
+    public:
+        virtual ~Builtins() {}
+        virtual bool expandBuiltin(const PpToken &name, PpToken *result) = 0;
+    };
+
+private:
+    // Tokens still to be looked at: ones which have been read ahead or
+    // which are the results of an expansion, then the rest of the source.
+    struct Input
+    {
+        Source             *source;
+        std::deque<PpToken> pending;
+
+        explicit Input(Source *source) : source(source) {}
+    };
+
+    // The full expansion of an object like macro. The macros it looked
+    // up, including ones which weren't defined, are kept with their
+    // hashes to see whether it's still valid, and the ones which were
+    // defined are kept alive as the tokens refer to them.
+    struct Memo
+    {
+        uint64_t                                      hash;         // The macro's.
+        bool                                          usable;       // It doesn't depend on where it's used.
+        std::vector<PpToken>                          tokens;
+        std::vector<std::pair<Interner::Id, uint64_t>> uses;
+        std::vector<std::shared_ptr<const Macro>>     macros;
+        std::deque<std::string>                       spellings;    // The text of tokens made by # and ##.
+    };
+
+    MacroEnvironment       &env_;
+    Interner               &identifiers_;
+    Builtins               *builtins_;
+    bool                    keepDefined_;   // Leave "defined X" alone, for #if.
+    Interner::Id            definedId_;
+    HideSetTable            hideSets_;
+    std::deque<std::string> spellings_;     // The text of tokens made by # and ##.
+    std::deque<std::string> *newSpellings_; // Where they go.
+
+    // Memoised expansions by macro, and ones which were replaced but may
+    // still be referred to by tokens from this call to expand().
+    std::unordered_map<Interner::Id, Memo> memos_;
+    std::vector<std::deque<std::string>>   retired_;
+
+    // The expansion being memoised, if there is one.
+    Memo                   *memo_;
+    Input                  *memoInput_;
+    size_t                  memoHits_;
+
+private:
+    bool    next(Input &in, PpToken *token);
+    void    expand(Input &in, std::vector<PpToken> *out);
+    const Macro *lookup(Interner::Id id);
+    void    collectArgs(Input &in, const Macro &macro, std::vector<std::vector<PpToken>> *args, PpToken *rightParen);
+    void    substitute(const Macro &macro, const PpToken &name, const std::vector<std::vector<PpToken>> &args, const HideSet *hideSet, std::vector<PpToken> *result);
+    PpToken stringize(const std::vector<PpToken> &arg, const Token &hash);
+    PpToken paste(const PpToken &left, const PpToken &right);
+
+    // Memoised expansions.
+    bool    expandMemoised(const Macro &macro, const PpToken &name, std::vector<PpToken> *out);
+    void    memoise(const Macro &macro, Memo *memo);
+
+public:
+    explicit MacroExpander(MacroEnvironment &env, Builtins *builtins = nullptr);
+
+    // Whether to leave the defined operator and its operand unexpanded,
+    // for evaluating #if.
+    void setKeepDefined(bool keepDefined) { keepDefined_ = keepDefined; }
+
+    // Expand all the tokens from a source, adding the results to out.
+    void expand(Source &source, std::vector<PpToken> *out);
+
+    // How many different hide sets and memoised expansions there are, and
+    // how many times one was reused.
+    size_t hideSetCount() const { return hideSets_.size(); }
+    size_t memoCount() const    { return memos_.size(); }
+    size_t memoHits() const     { return memoHits_; }
+
+    // Whether a token is ## or its digraph.
+    static bool isPaste(Punctuator punct) { return punct == Punctuator::HashHash || punct == Punctuator::PercentColonPercentColon; }
+
+    // Whether a token is # or its digraph.
+    static bool isStringize(Punctuator punct) { return punct == Punctuator::Hash || punct == Punctuator::PercentColon; }
+};
+
+
+//
+// An exception thrown when a macro can't be expanded.
+//
+
+class MacroException : public std::exception
+{
+    std::string message_;
+
+public:
+    MacroException(const std::string &message) : message_(message) {}
+
+    const char * what () const throw ()
+    {
+        return message_.c_str();
+    }
+};
+
+
+} // namespace deepC
+
+#endif // DEEPC_MACROEXPANDER_H
@@ -0,0 +1,109 @@
+//
+// Parse tree rules generated by dcparsergen from c_syntax.pgen. Don't edit.
+//
+// There's a rule for each token which is a leaf of the parse tree and
+// for each definition of the grammar.
+//
+
+#ifndef DEEPC_PARSERULES_H
+#define DEEPC_PARSERULES_H
+
+#include <cstdint>
+
+
+namespace deepC
+{
+
+
+enum class Rule : uint16_t
+{
+    Identifier,
+    TypedefName,
+    Constant,
+    StringLiteral,
+    PrimaryExpression,
+    GenericSelection,
+    GenericAssocList,
+    GenericAssociation,
+    PostfixExpression,
+    ArgumentExpressionList,
+    UnaryExpression,
+    UnaryOperator,
+    CastExpression,
+    MultiplicativeExpression,
+    AdditiveExpression,
+    ShiftExpression,
+    RelationalExpression,
+    EqualityExpression,
+    ANDExpression,
+    ExclusiveORExpression,
+    InclusiveORExpression,
+    LogicalANDExpression,
+    LogicalORExpression,
+    ConditionalExpression,
+    AssignmentExpression,
+    AssignmentOperator,
+    Expression,
+    ConstantExpression,
+    Declaration,
+    DeclarationSpecifiers,
+    InitDeclaratorList,
+    InitDeclarator,
+    StorageClassSpecifier,
+    TypeSpecifier,
+    StructOrUnionSpecifier,
+    StructOrUnion,
+    StructDeclarationList,
+    StructDeclaration,
+    SpecifierQualifierList,
+    StructDeclaratorList,
+    StructDeclarator,
+    EnumSpecifier,
+    EnumeratorList,
+    Enumerator,
+    AtomicTypeSpecifier,
+    TypeQualifier,
+    FunctionSpecifier,
+    AlignmentSpecifier,
+    Declarator,
+    DirectDeclarator,
+    Pointer,
+    TypeQualifierList,
+    ParameterTypeList,
+    ParameterList,
+    ParameterDeclaration,
+    ParameterDeclarator,
+    DirectParameterDeclarator,
+    IdentifierList,
+    TypeName,
+    AbstractDeclarator,
+    DirectAbstractDeclarator,
+    Initializer,
+    InitializerList,
+    Designation,
+    DesignatorList,
+    Designator,
+    StaticAssertDeclaration,
+    Statement,
+    LabeledStatement,
+    CompoundStatement,
+    BlockItemList,
+    BlockItem,
+    ExpressionStatement,
+    SelectionStatement,
+    IterationStatement,
+    JumpStatement,
+    TranslationUnit,
+    ExternalDeclaration,
+    DeclarationList,
+    Count
+};
+
+
+// The grammar's name for a rule, like "postfix-expression".
+const char *ruleName(Rule rule);
+
+
+} // namespace deepC
+
+#endif // DEEPC_PARSERULES_H
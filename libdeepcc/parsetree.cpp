@@ -1,13 +1,81 @@
 #include "parsetree.h"
+#include "pptokenstream.h"
 
 
 namespace deepC
 {
 
 
-ParseTree::ParseTree()
+//
+// Constructor.
+//
+
+ParseTree::ParseTree() :
+    root_(nullptr)
+{
+}
+
+
+//
+// Add the text of a run of tokens, separated by spaces.
+//
+
+static void appendTokens(std::string &text, const PpTokenStream &tokens, size_t first, size_t last)
+{
+    for (size_t i = first; i < last; i++)
+    {
+        if (!text.empty())
+        {
+            text.push_back(' ');
+        }
+
+        text += tokens.text(i);
+    }
+}
+
+
+static void appendNode(std::string &text, const ParseNode *node, const PpTokenStream &tokens)
+{
+    if (node->child == nullptr)
+    {
+        appendTokens(text, tokens, node->token, node->endToken);
+        return;
+    }
+
+    if (!text.empty())
+    {
+        text.push_back(' ');
+    }
+
+    text.push_back('(');
+    text += ruleName(node->rule);
+    size_t pos = node->token;
+    for (const ParseNode *child = node->child; child != nullptr; child = child->next)
+    {
+        appendTokens(text, tokens, pos, child->token);
+        appendNode(text, child, tokens);
+        pos = child->endToken;
+    }
+
+    appendTokens(text, tokens, pos, node->endToken);
+    text.push_back(')');
+}
+
+
+//
+// Make an S-expression of a node. A node without children is just its
+// tokens.
+//
+
+std::string ParseTree::toText(const ParseNode *node, const PpTokenStream &tokens)
 {
+    std::string text;
+    if (node != nullptr)
+    {
+        appendNode(text, node, tokens);
+    }
 
+    return text;
 }
 
 
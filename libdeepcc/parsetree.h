@@ -1,15 +1,73 @@
 #ifndef DEEPC_PARSETREE_H
 #define DEEPC_PARSETREE_H
 
+#include <cstddef>
+#include <cstdint>
+#include <new>
+#include <string>
+
+#include "arena.h"
+#include "parserules.h"
+
 
 namespace deepC
 {
 
 
+// Forward declarations.
+class PpTokenStream;
+
+
+//
+// A node of the parse tree. A leaf is a token the grammar treats as a
+// terminal, like an identifier. Any other node is an option of one of the
+// grammar's definitions, and its children are the definitions and leaves
+// in the option, linked in order through next. An option with a single
+// child and no other tokens hasn't got a node of its own, so "x" parsed
+// as an expression is just the identifier. A node covers the preprocessed
+// tokens from token up to endToken.
+//
+
+struct ParseNode
+{
+    Rule       rule;
+    uint16_t   option;      // Which option of the definition it is.
+    uint32_t   token;       // Its first token.
+    uint32_t   endToken;    // The token after its last.
+    ParseNode *child;
+    ParseNode *next;
+};
+
+
+//
+// A parse tree. Its nodes are allocated in its arena, which the parser
+// also uses for everything else it needs, so they're all freed together.
+//
+
 class ParseTree
 {
+private:
+    Arena      arena_;
+    ParseNode *root_;
+
 public:
     ParseTree();
+    ParseTree(const ParseTree &) = delete;
+    ParseTree &operator=(const ParseTree &) = delete;
+
+    ParseNode *newNode(Rule rule, unsigned option, size_t token, size_t endToken, ParseNode *child)
+    {
+        void *memory = arena_.allocate(sizeof(ParseNode), alignof(ParseNode));
+        return new (memory) ParseNode{ rule, static_cast<uint16_t>(option), static_cast<uint32_t>(token), static_cast<uint32_t>(endToken), child, nullptr };
+    }
+
+    Arena     &arena()                      { return arena_; }
+    ParseNode *root() const                 { return root_; }
+    void       setRoot(ParseNode *root)     { root_ = root; }
+
+    // Make an S-expression of a node, like "(additive-expression a + b)",
+    // with the tokens which aren't children in their places.
+    static std::string toText(const ParseNode *node, const PpTokenStream &tokens);
 };
 
 
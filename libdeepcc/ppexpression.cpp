@@ -0,0 +1,501 @@
+#include <cctype>
+#include <string>
+
+#include "ppexpression.h"
+#include "preprocessor.h"
+
+
+namespace deepC
+{
+
+
+//
+// Evaluate an expression.
+//
+
+bool PpExpression::evaluate(const std::vector<PpToken> &tokens, MacroEnvironment &env)
+{
+    if (tokens.empty())
+        throw PreprocessorException("#if with no expression");
+
+    PpExpression expr(tokens, env);
+    Value value = expr.expression(true);
+    if (expr.pos_ < tokens.size())
+        throw PreprocessorException("missing binary operator before \"" + std::string(tokens[expr.pos_].text) + "\"");
+
+    return value.isTrue();
+}
+
+
+//
+// expression: conditional { , conditional }
+//
+
+PpExpression::Value PpExpression::expression(bool evaluate)
+{
+    Value value = conditional(evaluate);
+    while (peekPunctuator() == Punctuator::Comma)
+    {
+        pos_++;
+        value = conditional(evaluate);
+    }
+
+    return value;
+}
+
+
+//
+// conditional: binary [ ? expression : conditional ]
+//
+
+PpExpression::Value PpExpression::conditional(bool evaluate)
+{
+    Value condition = binary(1, evaluate);
+    if (peekPunctuator() != Punctuator::Question)
+        return condition;
+
+    pos_++;
+    Value ifTrue = expression(evaluate && condition.isTrue());
+    expect(Punctuator::Colon, "':' in ?: expression");
+    Value ifFalse = conditional(evaluate && !condition.isTrue());
+
+    Value result = condition.isTrue() ? ifTrue : ifFalse;
+    result.isUnsigned = ifTrue.isUnsigned || ifFalse.isUnsigned;
+    return result;
+}
+
+
+//
+// Get the precedence of a binary operator, or 0 if it isn't one.
+//
+
+static int precedence(Punctuator punct)
+{
+    switch (punct)
+    {
+    case Punctuator::Star:
+    case Punctuator::Slash:
+    case Punctuator::Percent:           return 10;
+    case Punctuator::Plus:
+    case Punctuator::Minus:             return 9;
+    case Punctuator::LessLess:
+    case Punctuator::GreaterGreater:    return 8;
+    case Punctuator::Less:
+    case Punctuator::Greater:
+    case Punctuator::LessEqual:
+    case Punctuator::GreaterEqual:      return 7;
+    case Punctuator::EqualEqual:
+    case Punctuator::ExclaimEqual:      return 6;
+    case Punctuator::Amp:               return 5;
+    case Punctuator::Caret:             return 4;
+    case Punctuator::Pipe:              return 3;
+    case Punctuator::AmpAmp:            return 2;
+    case Punctuator::PipePipe:          return 1;
+    default:                            return 0;
+    }
+}
+
+
+//
+// The binary operators, by precedence climbing. Both operands are
+// converted to unsigned if either of them is.
+//
+
+PpExpression::Value PpExpression::binary(int minPrecedence, bool evaluate)
+{
+    Value left = unary(evaluate);
+    for (;;)
+    {
+        Punctuator op = peekPunctuator();
+        int prec = precedence(op);
+        if (prec == 0 || prec < minPrecedence)
+            return left;
+
+        pos_++;
+        if (op == Punctuator::AmpAmp || op == Punctuator::PipePipe)
+        {
+            bool shortCircuit = op == Punctuator::AmpAmp ? !left.isTrue() : left.isTrue();
+            Value right = binary(prec + 1, evaluate && !shortCircuit);
+            bool result = op == Punctuator::AmpAmp ? left.isTrue() && right.isTrue() : left.isTrue() || right.isTrue();
+            left = Value{ result ? 1u : 0u, false };
+            continue;
+        }
+
+        Value right = binary(prec + 1, evaluate);
+        bool isUnsigned = left.isUnsigned || right.isUnsigned;
+        uint64_t a = left.bits;
+        uint64_t b = right.bits;
+        Value result{ 0, isUnsigned };
+        switch (op)
+        {
+        case Punctuator::Star:
+            result.bits = a * b;
+            break;
+
+        case Punctuator::Slash:
+        case Punctuator::Percent:
+            if (b == 0)
+            {
+                if (evaluate)
+                    throw PreprocessorException("division by zero in #if");
+
+                break;
+            }
+
+            if (isUnsigned)
+            {
+                result.bits = op == Punctuator::Slash ? a / b : a % b;
+            }
+            else if (left.asSigned() == INT64_MIN && right.asSigned() == -1)
+            {
+                // Overflows, so wrap around.
+                result.bits = op == Punctuator::Slash ? a : 0;
+            }
+            else
+            {
+                result.bits = static_cast<uint64_t>(op == Punctuator::Slash ? left.asSigned() / right.asSigned() : left.asSigned() % right.asSigned());
+            }
+            break;
+
+        case Punctuator::Plus:
+            result.bits = a + b;
+            break;
+
+        case Punctuator::Minus:
+            result.bits = a - b;
+            break;
+
+        case Punctuator::LessLess:
+        case Punctuator::GreaterGreater:
+        {
+            // The type is the left operand's, and shifting by a negative
+            // amount shifts the other way.
+            result.isUnsigned = left.isUnsigned;
+            int64_t count = right.isUnsigned && b > 64 ? 64 : right.asSigned();
+            bool leftShift = (op == Punctuator::LessLess) == (count >= 0);
+            uint64_t amount = count >= 0 ? static_cast<uint64_t>(count) : -static_cast<uint64_t>(count);
+            if (leftShift)
+            {
+                result.bits = amount >= 64 ? 0 : a << amount;
+            }
+            else if (left.isUnsigned)
+            {
+                result.bits = amount >= 64 ? 0 : a >> amount;
+            }
+            else
+            {
+                result.bits = static_cast<uint64_t>(left.asSigned() >> (amount >= 64 ? 63 : amount));
+            }
+            break;
+        }
+
+        case Punctuator::Less:
+        case Punctuator::Greater:
+        case Punctuator::LessEqual:
+        case Punctuator::GreaterEqual:
+        {
+            int order = isUnsigned ? (a < b ? -1 : a > b) : (left.asSigned() < right.asSigned() ? -1 : left.asSigned() > right.asSigned());
+            bool holds = op == Punctuator::Less ? order < 0 : op == Punctuator::Greater ? order > 0 : op == Punctuator::LessEqual ? order <= 0 : order >= 0;
+            result = Value{ holds ? 1u : 0u, false };
+            break;
+        }
+
+        case Punctuator::EqualEqual:
+            result = Value{ a == b ? 1u : 0u, false };
+            break;
+
+        case Punctuator::ExclaimEqual:
+            result = Value{ a != b ? 1u : 0u, false };
+            break;
+
+        case Punctuator::Amp:
+            result.bits = a & b;
+            break;
+
+        case Punctuator::Caret:
+            result.bits = a ^ b;
+            break;
+
+        case Punctuator::Pipe:
+            result.bits = a | b;
+            break;
+
+        default:
+            break;
+        }
+
+        left = result;
+    }
+}
+
+
+//
+// unary: [ + - ~ ! ] unary | defined identifier | defined ( identifier ) | primary
+//
+
+PpExpression::Value PpExpression::unary(bool evaluate)
+{
+    const PpToken *token = peek();
+    if (!token)
+        throw PreprocessorException("#if with an incomplete expression");
+
+    switch (token->punctuator())
+    {
+    case Punctuator::Plus:
+        pos_++;
+        return unary(evaluate);
+
+    case Punctuator::Minus:
+    {
+        pos_++;
+        Value value = unary(evaluate);
+        value.bits = -value.bits;
+        return value;
+    }
+
+    case Punctuator::Tilde:
+    {
+        pos_++;
+        Value value = unary(evaluate);
+        value.bits = ~value.bits;
+        return value;
+    }
+
+    case Punctuator::Exclaim:
+    {
+        pos_++;
+        Value value = unary(evaluate);
+        return Value{ value.isTrue() ? 0u : 1u, false };
+    }
+
+    default:
+        break;
+    }
+
+    if (token->kind == TokenKind::Identifier && token->text == "defined")
+    {
+        pos_++;
+        bool paren = peekPunctuator() == Punctuator::LeftParen;
+        if (paren)
+        {
+            pos_++;
+        }
+
+        const PpToken *name = peek();
+        if (!name || name->kind != TokenKind::Identifier)
+            throw PreprocessorException("operator \"defined\" requires an identifier");
+
+        pos_++;
+        if (paren)
+        {
+            expect(Punctuator::RightParen, "')' after \"defined\"");
+        }
+
+        const Macro *macro = name->id != Interner::none ? env_.find(name->id) : env_.find(std::string(name->text));
+        return Value{ macro ? 1u : 0u, false };
+    }
+
+    return primary(evaluate);
+}
+
+
+//
+// primary: number | character constant | identifier | ( expression )
+//
+
+PpExpression::Value PpExpression::primary(bool evaluate)
+{
+    const PpToken &token = tokens_[pos_++];
+    switch (token.kind)
+    {
+    case TokenKind::PpNumber:
+        return number(token);
+
+    case TokenKind::CharacterConstant:
+        return character(token);
+
+    case TokenKind::Identifier:
+        // Identifiers which aren't macros are 0, except C23's true.
+        return Value{ token.text == "true" ? 1u : 0u, false };
+
+    case TokenKind::Punctuator:
+        if (token.punctuator() == Punctuator::LeftParen)
+        {
+            Value value = expression(evaluate);
+            expect(Punctuator::RightParen, "')' in expression");
+            return value;
+        }
+        break;
+
+    default:
+        break;
+    }
+
+    throw PreprocessorException("token \"" + std::string(token.text) + "\" is not valid in preprocessor expressions");
+}
+
+
+//
+// Get the value of an integer constant.
+//
+
+PpExpression::Value PpExpression::number(const PpToken &token) const
+{
+    std::string_view text = token.text;
+    size_t pos = 0;
+    unsigned base = 10;
+    if (text.size() > 1 && text[0] == '0' && (text[1] == 'x' || text[1] == 'X'))
+    {
+        base = 16;
+        pos = 2;
+    }
+    else if (text.size() > 1 && text[0] == '0' && (text[1] == 'b' || text[1] == 'B'))
+    {
+        base = 2;
+        pos = 2;
+    }
+    else if (text[0] == '0')
+    {
+        base = 8;
+    }
+
+    uint64_t value = 0;
+    bool overflow = false;
+    size_t digits = 0;
+    for (; pos < text.size(); pos++)
+    {
+        char c = text[pos];
+        if (c == '\'')
+            continue;
+
+        unsigned digit;
+        if (c >= '0' && c <= '9')
+            digit = c - '0';
+        else if (base == 16 && c >= 'a' && c <= 'f')
+            digit = c - 'a' + 10;
+        else if (base == 16 && c >= 'A' && c <= 'F')
+            digit = c - 'A' + 10;
+        else
+            break;
+
+        if (digit >= base)
+            throw PreprocessorException("invalid digit in integer constant \"" + std::string(text) + "\"");
+
+        if (value > (UINT64_MAX - digit) / base)
+        {
+            overflow = true;
+        }
+
+        value = value * base + digit;
+        digits++;
+    }
+
+    // The rest has to be an integer suffix.
+    std::string suffix;
+    for (; pos < text.size(); pos++)
+    {
+        suffix.push_back(static_cast<char>(std::tolower(static_cast<unsigned char>(text[pos]))));
+    }
+
+    static const char *suffixes[] = { "", "u", "l", "ul", "lu", "ll", "ull", "llu", "z", "uz", "zu" };
+    bool validSuffix = false;
+    for (const char *valid : suffixes)
+    {
+        validSuffix = validSuffix || suffix == valid;
+    }
+
+    if ((digits == 0 && base != 8) || !validSuffix)
+    {
+        bool isFloat = text.find('.') != std::string_view::npos || (base == 10 && suffix.find_first_of("ef") != std::string::npos) ||
+                       (base == 16 && suffix.find('p') != std::string::npos);
+        throw PreprocessorException(isFloat ? "floating constant in preprocessor expression" : "invalid integer constant \"" + std::string(text) + "\"");
+    }
+
+    if (overflow)
+        throw PreprocessorException("integer constant \"" + std::string(text) + "\" is too large");
+
+    return Value{ value, suffix.find('u') != std::string::npos || value > static_cast<uint64_t>(INT64_MAX) };
+}
+
+
+//
+// Get the value of a character constant. A plain one is a char, which is
+// signed, and one with more than one character has them all in the
+// value, most significant first.
+//
+
+PpExpression::Value PpExpression::character(const PpToken &token) const
+{
+    std::string_view text = token.text;
+    size_t quote = text.find('\'');
+    bool plain = quote == 0;
+    uint64_t value = 0;
+    size_t chars = 0;
+    for (size_t pos = quote + 1; pos + 1 < text.size(); chars++)
+    {
+        uint64_t c = static_cast<unsigned char>(text[pos++]);
+        if (c == '\\' && pos + 1 < text.size())
+        {
+            char escape = text[pos++];
+            switch (escape)
+            {
+            case 'n':   c = '\n'; break;
+            case 't':   c = '\t'; break;
+            case 'r':   c = '\r'; break;
+            case 'a':   c = '\a'; break;
+            case 'b':   c = '\b'; break;
+            case 'f':   c = '\f'; break;
+            case 'v':   c = '\v'; break;
+            case 'x':
+                c = 0;
+                while (pos + 1 < text.size() && std::isxdigit(static_cast<unsigned char>(text[pos])))
+                {
+                    char h = text[pos++];
+                    c = c * 16 + (h <= '9' ? h - '0' : (h | 0x20) - 'a' + 10);
+                }
+                break;
+
+            default:
+                if (escape >= '0' && escape <= '7')
+                {
+                    c = escape - '0';
+                    for (int i = 0; i < 2 && pos + 1 < text.size() && text[pos] >= '0' && text[pos] <= '7'; i++)
+                    {
+                        c = c * 8 + (text[pos++] - '0');
+                    }
+                }
+                else
+                {
+                    c = static_cast<unsigned char>(escape);
+                }
+                break;
+            }
+        }
+
+        value = plain ? (value << 8) | (c & 0xff) : c;
+    }
+
+    if (chars == 0)
+        throw PreprocessorException("empty character constant in preprocessor expression");
+
+    if (plain && chars == 1)
+        return Value{ static_cast<uint64_t>(static_cast<int64_t>(static_cast<signed char>(value))), false };
+
+    return Value{ value, false };
+}
+
+
+//
+// Expect a particular punctuator next.
+//
+
+void PpExpression::expect(Punctuator punct, const char *what)
+{
+    if (peekPunctuator() != punct)
+        throw PreprocessorException(std::string("expected ") + what);
+
+    pos_++;
+}
+
+
+} // namespace deepC
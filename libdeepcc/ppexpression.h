@@ -0,0 +1,65 @@
+#ifndef DEEPC_PPEXPRESSION_H
+#define DEEPC_PPEXPRESSION_H
+
+#include <cstdint>
+#include <vector>
+
+#include "macroexpander.h"
+
+
+namespace deepC
+{
+
+
+//
+// Evaluates the controlling expression of a #if or #elif, after its
+// macros have been expanded with the defined operator left alone.
+//
+// Arithmetic is done in intmax_t and uintmax_t, as the standard says. The
+// operands of && || and ?: which aren't evaluated can't cause errors, such
+// as dividing by zero.
+//
+
+class PpExpression
+{
+private:
+    // A value, which is signed unless it says otherwise.
+    struct Value
+    {
+        uint64_t bits;
+        bool     isUnsigned;
+
+        int64_t  asSigned() const { return static_cast<int64_t>(bits); }
+        bool     isTrue() const   { return bits != 0; }
+    };
+
+    const std::vector<PpToken> &tokens_;
+    MacroEnvironment           &env_;
+    size_t                      pos_;
+
+private:
+    PpExpression(const std::vector<PpToken> &tokens, MacroEnvironment &env) : tokens_(tokens), env_(env), pos_(0) {}
+
+    Value expression(bool evaluate);
+    Value conditional(bool evaluate);
+    Value binary(int minPrecedence, bool evaluate);
+    Value unary(bool evaluate);
+    Value primary(bool evaluate);
+
+    Value number(const PpToken &token) const;
+    Value character(const PpToken &token) const;
+
+    const PpToken *peek() const { return pos_ < tokens_.size() ? &tokens_[pos_] : nullptr; }
+    Punctuator     peekPunctuator() const { return pos_ < tokens_.size() ? tokens_[pos_].punctuator() : Punctuator::None; }
+    void           expect(Punctuator punct, const char *what);
+
+public:
+    // Evaluate an expression. Throws a PreprocessorException if it isn't
+    // a valid one.
+    static bool evaluate(const std::vector<PpToken> &tokens, MacroEnvironment &env);
+};
+
+
+} // namespace deepC
+
+#endif // DEEPC_PPEXPRESSION_H
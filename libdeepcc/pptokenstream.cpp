@@ -0,0 +1,360 @@
+#include <algorithm>
+#include <cctype>
+#include <cstring>
+
+#include "pptokenstream.h"
+
+
+namespace deepC
+{
+
+
+namespace
+{
+
+
+//
+// Whether two characters could be read as part of the same token if
+// they were next to each other.
+//
+
+bool couldJoin(char left, char right)
+{
+    auto word = [](char c)
+    {
+        return isalnum(static_cast<unsigned char>(c)) || c == '_' || c == '.';
+    };
+
+    auto punctuator = [](char c)
+    {
+        return strchr("+-*/%<>=!&|^#.:", c) != nullptr;
+    };
+
+    return (word(left) && (word(right) || right == '"' || right == '\'')) || (punctuator(left) && punctuator(right));
+}
+
+
+} // namespace
+
+
+//
+// Make room for some tokens.
+//
+
+void PpTokenStream::reserve(size_t capacity)
+{
+    kinds_.reserve(capacity);
+    subKinds_.reserve(capacity);
+    flags_.reserve(capacity);
+    identIds_.reserve(capacity);
+    lengths_.reserve(capacity);
+    textLocs_.reserve(capacity);
+    originalLocs_.reserve(capacity);
+    expansionLocs_.reserve(capacity);
+}
+
+
+void PpTokenStream::clear()
+{
+    kinds_.clear();
+    subKinds_.clear();
+    flags_.clear();
+    identIds_.clear();
+    lengths_.clear();
+    textLocs_.clear();
+    originalLocs_.clear();
+    expansionLocs_.clear();
+    spellings_.clear();
+    files_.clear();
+}
+
+
+//
+// Say where the text of a file is.
+//
+
+void PpTokenStream::addFile(uint32_t fileId, std::string_view text)
+{
+    if (fileId != 0)
+    {
+        files_[fileId] = text;
+    }
+}
+
+
+//
+// Add a token.
+//
+
+void PpTokenStream::push_back(TokenKind kind, uint8_t subKind, uint8_t flags, uint32_t identId, std::string_view text, SourceLoc originalLoc, SourceLoc expansionLoc)
+{
+    SourceLoc textLoc = originalLoc;
+    if (!originalLoc.exists() || !hasFile(originalLoc.fileId))
+    {
+        textLoc = SourceLoc(0, static_cast<uint32_t>(spellings_.size()));
+        spellings_ += text;
+    }
+
+    kinds_.push_back(static_cast<uint8_t>(kind));
+    subKinds_.push_back(subKind);
+    flags_.push_back(flags);
+    identIds_.push_back(identId);
+    lengths_.push_back(static_cast<uint32_t>(text.size()));
+    textLocs_.push_back(textLoc);
+    originalLocs_.push_back(originalLoc);
+    expansionLocs_.push_back(expansionLoc);
+}
+
+
+//
+// Add a run of tokens from another stream. The part of the other
+// stream's spellings they use is copied all at once.
+//
+
+void PpTokenStream::append(const PpTokenStream &from, size_t first, size_t last)
+{
+    // Find the part of the other stream's spellings these tokens use. Their
+    // offsets move by where it goes less where it was, which wraps around
+    // with unsigned arithmetic when it's negative.
+    size_t spellingsStart = from.spellings_.size();
+    size_t spellingsEnd = 0;
+    for (size_t i = first; i < last; i++)
+    {
+        SourceLoc textLoc = from.textLocs_[i];
+        if (textLoc.fileId == 0)
+        {
+            spellingsStart = std::min<size_t>(spellingsStart, textLoc.offset);
+            spellingsEnd = std::max<size_t>(spellingsEnd, textLoc.offset + from.lengths_[i]);
+        }
+    }
+
+    uint32_t shift = 0;
+    if (spellingsStart < spellingsEnd)
+    {
+        shift = static_cast<uint32_t>(spellings_.size() - spellingsStart);
+        spellings_.append(from.spellings_, spellingsStart, spellingsEnd - spellingsStart);
+    }
+
+    reserve(size() + (last - first));
+    for (size_t i = first; i < last; i++)
+    {
+        SourceLoc textLoc = from.textLocs_[i];
+        if (textLoc.fileId == 0)
+        {
+            textLoc.offset += shift;
+        }
+        else if (!hasFile(textLoc.fileId))
+        {
+            std::string_view text = from.text(i);
+            textLoc = SourceLoc(0, static_cast<uint32_t>(spellings_.size()));
+            spellings_ += text;
+        }
+
+        kinds_.push_back(from.kinds_[i]);
+        subKinds_.push_back(from.subKinds_[i]);
+        flags_.push_back(from.flags_[i]);
+        identIds_.push_back(from.identIds_[i]);
+        lengths_.push_back(from.lengths_[i]);
+        textLocs_.push_back(textLoc);
+        originalLocs_.push_back(from.originalLocs_[i]);
+        expansionLocs_.push_back(from.expansionLocs_[i]);
+    }
+}
+
+
+//
+// Copy a run of tokens into a stream which holds all their text.
+//
+
+PpTokenStream PpTokenStream::slice(size_t first, size_t last) const
+{
+    PpTokenStream result;
+    result.reserve(last - first);
+    for (size_t i = first; i < last; i++)
+    {
+        std::string_view text = this->text(i);
+        result.kinds_.push_back(kinds_[i]);
+        result.subKinds_.push_back(subKinds_[i]);
+        result.flags_.push_back(flags_[i]);
+        result.identIds_.push_back(identIds_[i]);
+        result.lengths_.push_back(lengths_[i]);
+        result.textLocs_.push_back(SourceLoc(0, static_cast<uint32_t>(result.spellings_.size())));
+        result.originalLocs_.push_back(originalLocs_[i]);
+        result.expansionLocs_.push_back(expansionLocs_[i]);
+        result.spellings_ += text;
+    }
+
+    return result;
+}
+
+
+//
+// Get the text of a token.
+//
+
+std::string_view PpTokenStream::text(size_t i) const
+{
+    SourceLoc textLoc = textLocs_[i];
+    if (textLoc.fileId == 0)
+        return std::string_view(spellings_).substr(textLoc.offset, lengths_[i]);
+
+    return files_.find(textLoc.fileId)->second.substr(textLoc.offset, lengths_[i]);
+}
+
+
+//
+// The size of the blob for the stream.
+//
+
+size_t PpTokenStream::blobSize() const
+{
+    return sizeof(Header) + size() * (2 * sizeof(SourceLoc) + 2 * sizeof(uint32_t) + 3) + spellings_.size();
+}
+
+
+//
+// Write the stream to a blob of blobSize() bytes:
+//
+//      header | expansionLocs | originalLocs | textOffsets | lengths |
+//      kinds | subKinds | flags | spellings
+//
+
+void PpTokenStream::writeBlob(void *blob) const
+{
+    size_t count = size();
+    Header header;
+    header.magic = blobMagic;
+    header.count = static_cast<uint32_t>(count);
+    header.spellingsSize = static_cast<uint32_t>(spellings_.size());
+    header.unused = 0;
+
+    char *pos = static_cast<char *>(blob);
+    auto write = [&pos](const void *data, size_t size)
+    {
+        if (size != 0)
+        {
+            memcpy(pos, data, size);
+            pos += size;
+        }
+    };
+
+    write(&header, sizeof(header));
+    write(expansionLocs_.data(), count * sizeof(SourceLoc));
+    write(originalLocs_.data(), count * sizeof(SourceLoc));
+    for (const SourceLoc &textLoc : textLocs_)
+    {
+        write(&textLoc.offset, sizeof(uint32_t));
+    }
+
+    write(lengths_.data(), count * sizeof(uint32_t));
+    write(kinds_.data(), count);
+    write(subKinds_.data(), count);
+    write(flags_.data(), count);
+    write(spellings_.data(), spellings_.size());
+}
+
+
+//
+// Read the stream from a blob made by writeBlob(). Returns false and
+// leaves the stream empty if it's not a valid blob.
+//
+
+bool PpTokenStream::assign(const void *blob, size_t blobSize)
+{
+    clear();
+    Header header;
+    if (blobSize < sizeof(header))
+        return false;
+
+    memcpy(&header, blob, sizeof(header));
+    size_t count = header.count;
+    if (header.magic != blobMagic || blobSize != sizeof(Header) + count * (2 * sizeof(SourceLoc) + 2 * sizeof(uint32_t) + 3) + header.spellingsSize)
+        return false;
+
+    const char *pos = static_cast<const char *>(blob) + sizeof(header);
+    auto read = [&pos](void *data, size_t size)
+    {
+        if (size != 0)
+        {
+            memcpy(data, pos, size);
+            pos += size;
+        }
+    };
+
+    kinds_.resize(count);
+    subKinds_.resize(count);
+    flags_.resize(count);
+    identIds_.assign(count, noIdent);
+    lengths_.resize(count);
+    textLocs_.resize(count);
+    originalLocs_.resize(count);
+    expansionLocs_.resize(count);
+
+    read(expansionLocs_.data(), count * sizeof(SourceLoc));
+    read(originalLocs_.data(), count * sizeof(SourceLoc));
+    for (SourceLoc &textLoc : textLocs_)
+    {
+        read(&textLoc.offset, sizeof(uint32_t));
+    }
+
+    read(lengths_.data(), count * sizeof(uint32_t));
+    read(kinds_.data(), count);
+    read(subKinds_.data(), count);
+    read(flags_.data(), count);
+    spellings_.assign(pos, header.spellingsSize);
+
+    for (size_t i = 0; i < count; i++)
+    {
+        if (uint64_t(textLocs_[i].offset) + lengths_[i] > spellings_.size())
+        {
+            clear();
+            return false;
+        }
+    }
+
+    return true;
+}
+
+
+//
+// Make text from the tokens.
+//
+
+std::string PpTokenStream::toText() const
+{
+    std::string result;
+    bool lastExpanded = false;
+    for (size_t i = 0; i < size(); i++)
+    {
+        std::string_view text = this->text(i);
+        if (text.empty())
+            continue;
+
+        uint8_t flags = flags_[i];
+        bool expanded = (flags & Expanded) != 0;
+        if (!result.empty())
+        {
+            if (flags & Token::StartOfLine)
+            {
+                result.push_back('\n');
+            }
+            else if ((flags & Token::PrecededBySpace) || ((expanded || lastExpanded) && couldJoin(result.back(), text.front())))
+            {
+                result.push_back(' ');
+            }
+        }
+
+        result += text;
+        lastExpanded = expanded;
+    }
+
+    if (!result.empty())
+    {
+        result.push_back('\n');
+    }
+
+    return result;
+}
+
+
+} // namespace deepC
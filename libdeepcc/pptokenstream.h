@@ -0,0 +1,130 @@
+#ifndef DEEPC_PPTOKENSTREAM_H
+#define DEEPC_PPTOKENSTREAM_H
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+#include "sourceloc.h"
+#include "token.h"
+
+
+namespace deepC
+{
+
+
+//
+// The preprocessed tokens of a compile unit, which is what the parser
+// reads. Like a TokenStream they're kept as parallel arrays, but they
+// come from many files and from macro expansions, so each token has its
+// own locations:
+//
+//  * its original location, which is where it was written: in a source
+//    file, or in the #define of the macro it came from. Tokens which were
+//    made by # and ## or by builtins like __LINE__ haven't got one.
+//  * its expansion location, which is where it is in the source: the
+//    token itself, or the use of the outermost macro it was expanded from.
+//
+// A token's text stays in the source file it's in when the file is one
+// the stream has been told about with addFile(), otherwise it's copied
+// into the stream. The files' text must outlive the stream.
+//
+// A stream which holds all of its own text, as made by slice(), can be
+// written to a blob and read back, which is how a header's output is kept
+// in its MacroContext. Identifier ids aren't kept in blobs, as ids given
+// out while preprocessing aren't stored, so they come back as noIdent.
+//
+
+class PpTokenStream
+{
+public:
+    // The identId of a token which isn't an interned identifier.
+    static constexpr uint32_t noIdent = 0;
+
+    // Flags besides Token::Flags.
+    enum Flags : uint8_t
+    {
+        Expanded        = 0x04      // It came from a macro expansion.
+    };
+
+private:
+    // The start of a blob.
+    struct Header
+    {
+        uint32_t magic;
+        uint32_t count;
+        uint32_t spellingsSize;
+        uint32_t unused;
+    };
+
+    static constexpr uint32_t blobMagic = 0x50544344;   // "DCTP".
+
+    std::vector<uint8_t>   kinds_;
+    std::vector<uint8_t>   subKinds_;
+    std::vector<uint8_t>   flags_;
+    std::vector<uint32_t>  identIds_;
+    std::vector<uint32_t>  lengths_;
+    std::vector<SourceLoc> textLocs_;       // Where the text is, in a file or at an offset in spellings_ if the file id is 0.
+    std::vector<SourceLoc> originalLocs_;
+    std::vector<SourceLoc> expansionLocs_;
+    std::string            spellings_;      // The text of tokens which isn't in a known file.
+    std::unordered_map<uint32_t, std::string_view> files_;
+
+public:
+    // Size.
+    size_t   size() const     { return kinds_.size(); }
+    bool     empty() const    { return kinds_.empty(); }
+    void     reserve(size_t capacity);
+    void     clear();
+
+    // Say where the text of a file is, so tokens in it can refer to it.
+    void     addFile(uint32_t fileId, std::string_view text);
+    bool     hasFile(uint32_t fileId) const { return files_.find(fileId) != files_.end(); }
+
+    // Add a token. Its text is copied unless its original location is in
+    // a file the stream knows about.
+    void     push_back(TokenKind kind, uint8_t subKind, uint8_t flags, uint32_t identId, std::string_view text, SourceLoc originalLoc, SourceLoc expansionLoc);
+
+    // Add a run of tokens from another stream.
+    void     append(const PpTokenStream &from, size_t first, size_t last);
+
+    // Copy a run of tokens into a stream which holds all their text.
+    PpTokenStream slice(size_t first, size_t last) const;
+
+    // Get parts of a token.
+    TokenKind  kind(size_t i) const          { return static_cast<TokenKind>(kinds_[i]); }
+    uint8_t    subKind(size_t i) const       { return subKinds_[i]; }
+    Punctuator punctuator(size_t i) const    { return kind(i) == TokenKind::Punctuator ? static_cast<Punctuator>(subKinds_[i]) : Punctuator::None; }
+    uint8_t    flags(size_t i) const         { return flags_[i]; }
+    uint32_t   identId(size_t i) const       { return identIds_[i]; }
+    uint32_t   length(size_t i) const        { return lengths_[i]; }
+    SourceLoc  originalLoc(size_t i) const   { return originalLocs_[i]; }
+    SourceLoc  expansionLoc(size_t i) const  { return expansionLocs_[i]; }
+    std::string_view text(size_t i) const;
+
+    void       setIdentId(size_t i, uint32_t identId) { identIds_[i] = identId; }
+    void       setFlags(size_t i, uint8_t flags)      { flags_[i] = flags; }
+
+    // The arrays, for scanning.
+    const uint8_t *kinds() const    { return kinds_.data(); }
+    const uint8_t *flags() const    { return flags_.data(); }
+
+    // Convert to and from a single blob for storage. Only a stream which
+    // holds all its own text can be written.
+    size_t   blobSize() const;
+    void     writeBlob(void *blob) const;
+    bool     assign(const void *blob, size_t blobSize);
+
+    // Make text from the tokens: a line for each line of source, with
+    // a space wherever there was whitespace in the source or where tokens
+    // from expansions would otherwise run together.
+    std::string toText() const;
+};
+
+
+} // namespace deepC
+
+#endif // DEEPC_PPTOKENSTREAM_H
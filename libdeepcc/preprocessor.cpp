@@ -1,16 +1,1079 @@
+#include <algorithm>
+#include <cctype>
+#include <cstring>
+#include <ctime>
+
 #include "preprocessor.h"
+#include "clexer.h"
+#include "compiler.h"
+#include "ppexpression.h"
+#include "sourcefile.h"
 
 
 namespace deepC
 {
 
 
-Preprocessor::Preprocessor(std::shared_ptr<ProgramDb> pdb, const CompileArgs &args, const std::string &sourceFileName) :
-    pdb_(pdb),
+namespace
+{
+
+
+//
+// Quote a file name as a string literal.
+//
+
+std::string quoted(const std::string &fileName)
+{
+    std::string result = "\"";
+    for (char c : fileName)
+    {
+        if (c == '"' || c == '\\')
+        {
+            result.push_back('\\');
+        }
+
+        result.push_back(c);
+    }
+
+    result.push_back('"');
+    return result;
+}
+
+
+//
+// Get the directory a file is in, which is where a "name" it includes is
+// looked for first.
+//
+
+std::string dirOf(const std::string &fileName)
+{
+    size_t slash = fileName.rfind('/');
+    return (slash == std::string::npos) ? std::string() : fileName.substr(0, slash == 0 ? 1 : slash);
+}
+
+
+//
+// The error for a header which can't be found.
+//
+
+std::string notFound(const MacroContext::Inclusion &inclusion)
+{
+    return "can't find header " + (inclusion.angled ? "<" + inclusion.name + ">" : quoted(inclusion.name));
+}
+
+
+} // namespace
+
+
+//
+// The tokens of a file up to the next directive, for the macro expander.
+// A function like macro's arguments can carry on over several lines.
+//
+
+class Preprocessor::FileSource : public MacroExpander::Source
+{
+    const Preprocessor &pp_;
+    File               &file_;
+
+public:
+    FileSource(const Preprocessor &pp, File &file) : pp_(pp), file_(file) {}
+
+    bool next(PpToken *token) override
+    {
+        if (file_.pos >= file_.tokens.size() || pp_.isDirective(file_, file_.pos))
+            return false;
+
+        *token = pp_.token(file_, file_.pos++);
+        return true;
+    }
+};
+
+
+//
+// Constructors.
+//
+
+Preprocessor::File::File(const std::string &fileName, const TokenStream &tokens, std::string_view text, size_t pathIndex) :
+    fileName(fileName),
+    quotedName(quoted(fileName)),
+    tokens(tokens),
+    text(text),
+    pathIndex(pathIndex),
+    pos(0),
+    lineOffset(0),
+    line(1)
+{
+}
+
+
+Preprocessor::Preprocessor(Compiler &compiler, const CompileArgs &args, CompileUnit &unit) :
+    compiler_(compiler),
     args_(args),
-    sourceFileName_(sourceFileName)
+    unit_(unit),
+    env_(compiler.identifiers()),
+    expander_(env_, this),
+    counter_(0),
+    lineStart_(false),
+    skippedIncludes_(0),
+    replayedHeaders_(0),
+    preprocessedHeaders_(0),
+    skippedTokens_(0)
+{
+}
+
+
+//
+// Preprocess the unit's source file. Its tokens must already have been
+// made. The predefined macros and the -D options are defined first, by
+// preprocessing them as a file of #defines.
+//
+
+void Preprocessor::run()
+{
+    commandLineText_ = "#define __STDC__ 1\n#define __STDC_VERSION__ 201710L\n#define __STDC_HOSTED__ 1\n";
+    for (const std::string &define : args_.defines())
+    {
+        size_t equals = define.find('=');
+        if (equals == std::string::npos)
+        {
+            commandLineText_ += "#define " + define + " 1\n";
+        }
+        else
+        {
+            commandLineText_ += "#define " + define.substr(0, equals) + " " + define.substr(equals + 1) + "\n";
+        }
+    }
+
+    CLexer lexer(commandLineText_);
+    lexer.lexAll(&commandLineTokens_);
+    File commandLine("<command line>", commandLineTokens_, commandLineText_, 0);
+    processFile(commandLine, 0);
+
+    File file(unit_.sourceFileName, unit_.tokens->tokens(), unit_.sourceFile->sourceText(), 0);
+    processFile(file, 0);
+    startLine();
+}
+
+
+//
+// Preprocess a file, expanding the macros in each run of lines between
+// directives.
+//
+
+void Preprocessor::processFile(File &file, int depth)
+{
+    files_.push_back(&file);
+    output_.addFile(file.tokens.fileId(), file.text);
+    size_t count = file.tokens.size();
+    while (file.pos < count)
+    {
+        if (isDirective(file, file.pos))
+        {
+            directive(file, depth);
+            continue;
+        }
+
+        if (!file.conditionals.empty() && !file.conditionals.back().active)
+        {
+            skipGroup(file);
+            continue;
+        }
+
+        size_t start = file.pos;
+        std::vector<PpToken> out;
+        FileSource source(*this, file);
+        builtinText_.clear();
+        try
+        {
+            expander_.expand(source, &out);
+        }
+        catch (const MacroException &e)
+        {
+            error(file, start, e.what());
+        }
+
+        emit(out);
+    }
+
+    if (!file.conditionals.empty())
+        error(file, count, "unterminated conditional directive");
+
+    files_.pop_back();
+}
+
+
+//
+// Preprocess a header. If it's been included before in the same context
+// what it did then is replayed, otherwise it's preprocessed from its
+// tokens and what it did is kept as a new context.
+//
+
+void Preprocessor::processHeader(CompileUnit &header, size_t pathIndex, int depth)
+{
+    const SourceFile &sourceFile = *header.sourceFile;
+    MacroContextCache &cache = compiler_.macroContexts();
+    for (const auto &context : cache.find(sourceFile, header.sameAsStored))
+    {
+        if (matches(*context))
+        {
+            replay(header.sourceFileName, *context);
+            replayedHeaders_++;
+            return;
+        }
+    }
+
+    File file(header.sourceFileName, compiler_.headerTokens(header), sourceFile.sourceText(), pathIndex);
+    startLine();
+    frames_.emplace_back(output_.size());
+    env_.beginRecording();
+    processFile(file, depth);
+    MacroEnvironment::Recording recording = env_.endRecording();
+    Frame frame = std::move(frames_.back());
+    frames_.pop_back();
+    preprocessedHeaders_++;
+
+    if (frame.cacheable)
+    {
+        auto context = std::make_shared<MacroContext>();
+        context->reads.assign(recording.reads.begin(), recording.reads.end());
+        std::sort(context->reads.begin(), context->reads.end());
+        context->onceReads.assign(frame.onceReads.begin(), frame.onceReads.end());
+        context->inclusions = frame.inclusions;
+
+        std::vector<std::string> writes(recording.writes.begin(), recording.writes.end());
+        std::sort(writes.begin(), writes.end());
+        for (const std::string &name : writes)
+        {
+            context->changes.push_back(MacroContext::MacroChange{ name, env_.get(name) });
+        }
+
+        context->onceFiles.assign(frame.onceFiles.begin(), frame.onceFiles.end());
+        context->output = output_.slice(frame.outputStart, output_.size());
+        context->skippedIncludes = frame.skippedIncludes;
+        context->setFingerprint();
+        cache.add(sourceFile, context);
+    }
+
+    addToFrame(frame);
+}
+
+
+//
+// Carry out a directive. Conditional directives are looked at even in
+// groups which are skipped, so their nesting can be followed, but the
+// rest are ignored there.
+//
+
+void Preprocessor::directive(File &file, int depth)
+{
+    size_t first = file.pos + 1;
+    size_t end = lineEnd(file, file.pos);
+    file.pos = end;
+
+    bool active = file.conditionals.empty() || file.conditionals.back().active;
+    if (first == end || (file.tokens.kind(first) == TokenKind::PpNumber && active))
+        return;
+
+    if (file.tokens.kind(first) != TokenKind::Identifier)
+    {
+        if (!active)
+            return;
+
+        error(file, first, "invalid preprocessing directive");
+    }
+
+    std::string_view name = file.tokens.text(first, file.text);
+    if (name == "if" || name == "ifdef" || name == "ifndef")
+    {
+        bool value = false;
+        if (active)
+        {
+            value = (name == "if") ? ifDirective(file, first + 1, end) : (ifdefDirective(file, first + 1, end) == (name == "ifdef"));
+        }
+
+        file.conditionals.push_back(Conditional{ value, value || !active, false });
+        return;
+    }
+
+    if (name == "elif" || name == "elifdef" || name == "elifndef")
+    {
+        if (file.conditionals.empty())
+            error(file, first, "#" + std::string(name) + " without #if");
+
+        Conditional &conditional = file.conditionals.back();
+        if (conditional.seenElse)
+            error(file, first, "#" + std::string(name) + " after #else");
+
+        if (conditional.taken)
+        {
+            conditional.active = false;
+        }
+        else
+        {
+            bool value = (name == "elif") ? ifDirective(file, first + 1, end) : (ifdefDirective(file, first + 1, end) == (name == "elifdef"));
+            conditional.active = value;
+            conditional.taken = value;
+        }
+
+        return;
+    }
+
+    if (name == "else")
+    {
+        if (file.conditionals.empty())
+            error(file, first, "#else without #if");
+
+        Conditional &conditional = file.conditionals.back();
+        if (conditional.seenElse)
+            error(file, first, "#else after #else");
+
+        conditional.seenElse = true;
+        conditional.active = !conditional.taken;
+        conditional.taken = true;
+        return;
+    }
+
+    if (name == "endif")
+    {
+        if (file.conditionals.empty())
+            error(file, first, "#endif without #if");
+
+        file.conditionals.pop_back();
+        return;
+    }
+
+    if (!active)
+        return;
+
+    if (name == "define")
+    {
+        defineDirective(file, first + 1, end);
+    }
+    else if (name == "undef")
+    {
+        if (first + 1 == end || file.tokens.kind(first + 1) != TokenKind::Identifier)
+            error(file, first + 1, "macro names must be identifiers");
+
+        env_.undefine(std::string(file.tokens.text(first + 1, file.text)));
+    }
+    else if (name == "include" || name == "include_next")
+    {
+        includeDirective(file, first + 1, end, name == "include_next", depth);
+    }
+    else if (name == "pragma")
+    {
+        // Other pragmas are ignored, as nothing after the preprocessor
+        // understands them and the parser would see them as syntax errors.
+        if (first + 1 < end && file.tokens.text(first + 1, file.text) == "once")
+        {
+            markOnce(file.fileName);
+        }
+    }
+    else if (name == "error")
+    {
+        std::string message;
+        if (first + 1 < end)
+        {
+            uint32_t start = file.tokens.offset(first + 1);
+            message = std::string(file.text.substr(start, file.tokens.offset(end - 1) + file.tokens.length(end - 1) - start));
+        }
+
+        error(file, first, "#error " + message);
+    }
+    else if (name != "warning" && name != "line" && name != "ident" && name != "sccs" && name != "assert" && name != "unassert")
+    {
+        error(file, first, "invalid preprocessing directive #" + std::string(name));
+    }
+}
+
+
+//
+// Define a macro. Its replacement list is kept as text with a single
+// space between tokens which had whitespace between them.
+//
+
+void Preprocessor::defineDirective(File &file, size_t first, size_t end)
+{
+    const TokenStream &tokens = file.tokens;
+    if (first == end || tokens.kind(first) != TokenKind::Identifier)
+        error(file, first, "macro names must be identifiers");
+
+    std::string name(tokens.text(first, file.text));
+    if (name == "defined")
+        error(file, first, "\"defined\" cannot be used as a macro name");
+
+    // A function like macro has a '(' straight after its name.
+    size_t i = first + 1;
+    bool functionLike = false;
+    bool variadic = false;
+    std::vector<std::string> params;
+    if (i < end && tokens.punctuator(i) == Punctuator::LeftParen && !(tokens.flags(i) & Token::PrecededBySpace))
+    {
+        functionLike = true;
+        i++;
+        if (i < end && tokens.punctuator(i) == Punctuator::RightParen)
+        {
+            i++;
+        }
+        else
+        {
+            for (;;)
+            {
+                if (i >= end)
+                    error(file, end - 1, "missing ')' in macro parameter list");
+
+                if (tokens.punctuator(i) == Punctuator::DotDotDot)
+                {
+                    params.push_back("__VA_ARGS__");
+                    variadic = true;
+                }
+                else if (tokens.kind(i) == TokenKind::Identifier)
+                {
+                    std::string param(tokens.text(i, file.text));
+                    if (std::find(params.begin(), params.end(), param) != params.end())
+                        error(file, i, "duplicate macro parameter \"" + param + "\"");
+
+                    params.push_back(param);
+                    if (i + 1 < end && tokens.punctuator(i + 1) == Punctuator::DotDotDot)
+                    {
+                        variadic = true;
+                        i++;
+                    }
+                }
+                else
+                {
+                    error(file, i, "expected parameter name");
+                }
+
+                i++;
+                if (i >= end)
+                    error(file, end - 1, "missing ')' in macro parameter list");
+
+                if (tokens.punctuator(i) == Punctuator::RightParen)
+                {
+                    i++;
+                    break;
+                }
+
+                if (variadic || tokens.punctuator(i) != Punctuator::Comma)
+                    error(file, i, "expected ',' or ')' in macro parameter list");
+
+                i++;
+            }
+        }
+    }
+
+    if (i < end && (MacroExpander::isPaste(tokens.punctuator(i)) || MacroExpander::isPaste(tokens.punctuator(end - 1))))
+        error(file, i, "'##' cannot appear at either end of a macro expansion");
+
+    std::string body;
+    for (size_t j = i; j < end; j++)
+    {
+        if (functionLike && MacroExpander::isStringize(tokens.punctuator(j)) &&
+            (j + 1 == end || tokens.kind(j + 1) != TokenKind::Identifier ||
+             std::find(params.begin(), params.end(), tokens.text(j + 1, file.text)) == params.end()))
+        {
+            error(file, j, "'#' is not followed by a macro parameter");
+        }
+
+        if (j > i && (tokens.flags(j) & Token::PrecededBySpace))
+        {
+            body.push_back(' ');
+        }
+
+        body += tokens.text(j, file.text);
+    }
+
+    auto macro = std::make_shared<Macro>(name, functionLike, variadic, params, body);
+    if (macro->tokens.size() == end - i)
+    {
+        for (size_t j = i; j < end; j++)
+        {
+            macro->tokenLocs.push_back(tokens.loc(j));
+        }
+    }
+
+    env_.define(macro);
+}
+
+
+//
+// Include a header. The name is either a string literal, a <name> or
+// tokens which make one of those once their macros are expanded.
+//
+
+void Preprocessor::includeDirective(File &file, size_t first, size_t end, bool next, int depth)
+{
+    if (first == end)
+        error(file, first - 1, "#include expects \"FILENAME\" or <FILENAME>");
+
+    MacroContext::Inclusion inclusion;
+    inclusion.angled = false;
+    const TokenStream &tokens = file.tokens;
+    if (tokens.kind(first) == TokenKind::StringLiteral && file.text[tokens.offset(first)] == '"')
+    {
+        std::string_view text = tokens.text(first, file.text);
+        inclusion.name = std::string(text.substr(1, text.size() - 2));
+    }
+    else if (tokens.punctuator(first) == Punctuator::Less)
+    {
+        // The name is the text between the brackets, as it is.
+        size_t close = first + 1;
+        while (close < end && tokens.punctuator(close) != Punctuator::Greater)
+        {
+            close++;
+        }
+
+        if (close == end)
+            error(file, first, "missing terminating > character");
+
+        uint32_t start = tokens.offset(first) + 1;
+        inclusion.name = std::string(file.text.substr(start, tokens.offset(close) - start));
+        inclusion.angled = true;
+    }
+    else
+    {
+        std::vector<PpToken> input = this->tokens(file, first, end);
+        std::vector<PpToken> expanded;
+        MacroExpander::VectorSource source(input);
+        builtinText_.clear();
+        try
+        {
+            expander_.expand(source, &expanded);
+        }
+        catch (const MacroException &e)
+        {
+            error(file, first, e.what());
+        }
+
+        if (!expanded.empty() && expanded.front().kind == TokenKind::StringLiteral && expanded.front().text.front() == '"')
+        {
+            std::string_view text = expanded.front().text;
+            inclusion.name = std::string(text.substr(1, text.size() - 2));
+        }
+        else if (!expanded.empty() && expanded.front().punctuator() == Punctuator::Less)
+        {
+            size_t close = 1;
+            for (; close < expanded.size() && expanded[close].punctuator() != Punctuator::Greater; close++)
+            {
+                if (close > 1 && (expanded[close].flags & (Token::StartOfLine | Token::PrecededBySpace)))
+                {
+                    inclusion.name.push_back(' ');
+                }
+
+                inclusion.name += expanded[close].text;
+            }
+
+            if (close == expanded.size())
+                error(file, first, "missing terminating > character");
+
+            inclusion.angled = true;
+        }
+        else
+        {
+            error(file, first, "#include expects \"FILENAME\" or <FILENAME>");
+        }
+    }
+
+    // #include_next carries on searching the include path after the
+    // directory the includer was found in.
+    inclusion.includerDir = dirOf(file.fileName);
+    inclusion.firstDir = next ? static_cast<uint32_t>(file.pathIndex) : 0;
+    inclusion.entered = false;
+    include(file, first, inclusion, depth);
+}
+
+
+//
+// Include a header, skipping it if it's guarded and has been included
+// already. The inclusion is recorded in the includer's frame. The header
+// name is at token i.
+//
+
+void Preprocessor::include(File &file, size_t i, MacroContext::Inclusion &inclusion, int depth)
+{
+    if (depth >= maxIncludeDepth)
+        throw PreprocessorException("#include nested too deeply in " + file.fileName);
+
+    IncludeResolver &resolver = compiler_.includeResolver();
+    inclusion.fileName = resolver.resolve(inclusion.name, inclusion.angled, inclusion.includerDir, inclusion.firstDir);
+    if (inclusion.fileName.empty())
+        error(file, i, notFound(inclusion));
+
+    // This only opens the header the first time it's included in this
+    // run, after that it's in the Compiler's include graph.
+    std::shared_ptr<CompileUnit> header = compiler_.includeHeader(inclusion.fileName, unit_);
+    inclusion.digest = header->sourceFile->digest();
+    const IncludeInfo &info = *header->includeInfo;
+    bool skip = (info.guard() == IncludeInfo::Guard::PragmaOnce && onceIncluded(inclusion.fileName)) ||
+                (info.guard() == IncludeInfo::Guard::IfndefGuard && env_.find(info.guardMacro()) != nullptr);
+
+    inclusion.entered = !skip;
+    if (!frames_.empty())
+    {
+        frames_.back().inclusions.push_back(inclusion);
+    }
+
+    if (skip)
+    {
+        skippedIncludes_++;
+        if (!frames_.empty())
+        {
+            frames_.back().skippedIncludes++;
+        }
+
+        return;
+    }
+
+    // Work out which include path directory it was found in, for any
+    // #include_next it makes.
+    size_t pathIndex = 0;
+    const std::vector<std::string> &includePath = resolver.includePath();
+    for (size_t i = inclusion.firstDir; i < includePath.size(); i++)
+    {
+        const std::string &dir = includePath[i];
+        std::string candidate = dir.empty() || dir.back() == '/' ? dir + inclusion.name : dir + "/" + inclusion.name;
+        if (candidate == inclusion.fileName)
+        {
+            pathIndex = i + 1;
+            break;
+        }
+    }
+
+    includedFiles_.push_back(inclusion.fileName);
+    processHeader(*header, pathIndex, depth + 1);
+}
+
+
+//
+// Evaluate the expression of a #if or #elif.
+//
+
+bool Preprocessor::ifDirective(File &file, size_t first, size_t end)
+{
+    if (first == end)
+        error(file, first - 1, "#if with no expression");
+
+    std::vector<PpToken> input = tokens(file, first, end);
+    std::vector<PpToken> expanded;
+    MacroExpander::VectorSource source(input);
+    builtinText_.clear();
+    expander_.setKeepDefined(true);
+    try
+    {
+        expander_.expand(source, &expanded);
+    }
+    catch (const MacroException &e)
+    {
+        expander_.setKeepDefined(false);
+        error(file, first, e.what());
+    }
+
+    expander_.setKeepDefined(false);
+    try
+    {
+        return PpExpression::evaluate(expanded, env_);
+    }
+    catch (const PreprocessorException &e)
+    {
+        error(file, first, e.what());
+    }
+}
+
+
+//
+// See whether the macro of a #ifdef or #ifndef is defined.
+//
+
+bool Preprocessor::ifdefDirective(File &file, size_t first, size_t end)
+{
+    if (first == end || file.tokens.kind(first) != TokenKind::Identifier)
+        error(file, first, "macro names must be identifiers");
+
+    return env_.find(std::string(file.tokens.text(first, file.text))) != nullptr;
+}
+
+
+//
+// Skip a conditional group which isn't taken, up to the next directive.
+// The lexer has already marked the tokens which start a line, so only
+// their flags and kinds need looking at. Directives in the group are
+// still carried out, so nested conditionals are followed.
+//
+
+void Preprocessor::skipGroup(File &file)
+{
+    size_t start = file.pos;
+    size_t count = file.tokens.size();
+    for (file.pos++; file.pos < count && !isDirective(file, file.pos); file.pos++)
+    {
+    }
+
+    skippedTokens_ += file.pos - start;
+}
+
+
+//
+// See whether a stored context matches the current one: the macros it
+// read have the same values, the headers it looked at have the same
+// #pragma once state, and its #includes find the same files with the
+// same text.
+//
+
+bool Preprocessor::matches(const MacroContext &context)
+{
+    for (const auto &read : context.reads)
+    {
+        if (env_.hash(read.first) != read.second)
+            return false;
+    }
+
+    for (const auto &read : context.onceReads)
+    {
+        if ((onceFiles_.count(read.first) != 0) != read.second)
+            return false;
+    }
+
+    IncludeResolver &resolver = compiler_.includeResolver();
+    for (const MacroContext::Inclusion &inclusion : context.inclusions)
+    {
+        std::string fileName = resolver.resolve(inclusion.name, inclusion.angled, inclusion.includerDir, inclusion.firstDir);
+        if (fileName != inclusion.fileName)
+            return false;
+
+        if (fileName.empty())
+            continue;
+
+        // A stored context can only vouch for text which is the same as
+        // what was stored, not just text with the same digest.
+        std::shared_ptr<CompileUnit> header = compiler_.includeHeader(fileName, unit_);
+        if (header->sourceFile->digest() != inclusion.digest || (context.loaded && !header->sameAsStored))
+            return false;
+    }
+
+    return true;
+}
+
+
+//
+// Do what a header did in a matching context again: make its changes to
+// the macros and add its output. A context stored with an #include which
+// couldn't be found is still an error.
+//
+
+void Preprocessor::replay(const std::string &fileName, const MacroContext &context)
+{
+    for (const MacroContext::Inclusion &inclusion : context.inclusions)
+    {
+        if (inclusion.fileName.empty())
+            throw PreprocessorException(fileName + ": " + notFound(inclusion));
+    }
+
+    env_.addReads(context.reads);
+    for (const MacroContext::MacroChange &change : context.changes)
+    {
+        if (change.macro)
+        {
+            env_.define(change.macro);
+        }
+        else
+        {
+            env_.undefine(change.name);
+        }
+    }
+
+    onceFiles_.insert(context.onceFiles.begin(), context.onceFiles.end());
+    if (!frames_.empty())
+    {
+        Frame child(0);
+        child.onceReads.insert(context.onceReads.begin(), context.onceReads.end());
+        child.onceFiles.insert(context.onceFiles.begin(), context.onceFiles.end());
+        child.inclusions = context.inclusions;
+        child.skippedIncludes = context.skippedIncludes;
+        addToFrame(child);
+    }
+
+    skippedIncludes_ += context.skippedIncludes;
+    for (const MacroContext::Inclusion &inclusion : context.inclusions)
+    {
+        if (inclusion.entered)
+        {
+            includedFiles_.push_back(inclusion.fileName);
+        }
+    }
+
+    startLine();
+    size_t first = output_.size();
+    output_.append(context.output, 0, context.output.size());
+
+    // Identifiers in output which was stored haven't got ids in this run.
+    for (size_t i = first; i < output_.size(); i++)
+    {
+        if (output_.kind(i) == TokenKind::Identifier && output_.identId(i) == PpTokenStream::noIdent)
+        {
+            output_.setIdentId(i, compiler_.identifiers().intern(output_.text(i)));
+        }
+    }
+}
+
+
+//
+// Add what a header which has finished did to the frame of the header
+// which included it. The #pragma once state it read only counts where
+// the includer hadn't set it already.
+//
+
+void Preprocessor::addToFrame(const Frame &child)
 {
+    if (frames_.empty())
+        return;
+
+    Frame &parent = frames_.back();
+    for (const auto &read : child.onceReads)
+    {
+        if (!parent.onceFiles.count(read.first))
+        {
+            parent.onceReads.emplace(read.first, read.second);
+        }
+    }
+
+    parent.onceFiles.insert(child.onceFiles.begin(), child.onceFiles.end());
+    parent.inclusions.insert(parent.inclusions.end(), child.inclusions.begin(), child.inclusions.end());
+    parent.skippedIncludes += child.skippedIncludes;
+    parent.cacheable = parent.cacheable && child.cacheable;
+}
+
+
+//
+// See whether a header with #pragma once has been included, recording
+// that it was looked at.
+//
+
+bool Preprocessor::onceIncluded(const std::string &fileName)
+{
+    bool included = onceFiles_.count(fileName) != 0;
+    if (!frames_.empty() && !frames_.back().onceFiles.count(fileName))
+    {
+        frames_.back().onceReads.emplace(fileName, included);
+    }
+
+    return included;
+}
+
+
+//
+// Note that a header has #pragma once.
+//
+
+void Preprocessor::markOnce(const std::string &fileName)
+{
+    onceFiles_.insert(fileName);
+    if (!frames_.empty())
+    {
+        frames_.back().onceFiles.insert(fileName);
+    }
+}
+
+
+//
+// Whether a token starts a directive.
+//
+
+bool Preprocessor::isDirective(const File &file, size_t i) const
+{
+    return (file.tokens.flags(i) & Token::StartOfLine) && MacroExpander::isStringize(file.tokens.punctuator(i));
+}
+
+
+//
+// Get the index of the first token on the line after a token's.
+//
+
+size_t Preprocessor::lineEnd(const File &file, size_t i) const
+{
+    size_t count = file.tokens.size();
+    const uint8_t *flags = file.tokens.flags();
+    for (i++; i < count && !(flags[i] & Token::StartOfLine); i++)
+    {
+    }
+
+    return i;
+}
+
+
+//
+// Get a token of a file for the macro expander.
+//
+
+PpToken Preprocessor::token(const File &file, size_t i) const
+{
+    PpToken token;
+    token.kind = file.tokens.kind(i);
+    token.subKind = file.tokens.subKind(i);
+    token.flags = file.tokens.flags(i);
+    token.id = file.tokens.identId(i);
+    token.text = file.tokens.text(i, file.text);
+    token.loc = file.tokens.loc(i);
+    token.original = token.loc;
+    return token;
+}
+
+
+std::vector<PpToken> Preprocessor::tokens(const File &file, size_t first, size_t end) const
+{
+    std::vector<PpToken> result;
+    result.reserve(end - first);
+    for (size_t i = first; i < end; i++)
+    {
+        result.push_back(token(file, i));
+    }
+
+    return result;
+}
+
+
+//
+// Add tokens to the output. Each line of source starts a line of output,
+// and each token keeps where it was written and where it was expanded.
+//
+
+void Preprocessor::emit(const std::vector<PpToken> &tokens)
+{
+    for (const PpToken &token : tokens)
+    {
+        if (token.text.empty())
+            continue;
+
+        uint8_t flags = token.flags & (Token::StartOfLine | Token::PrecededBySpace);
+        if (token.expanded)
+        {
+            flags |= PpTokenStream::Expanded;
+        }
+
+        if (lineStart_)
+        {
+            flags |= Token::StartOfLine;
+            lineStart_ = false;
+        }
+
+        output_.push_back(token.kind, token.subKind, flags, token.id, token.text, token.original, token.loc);
+    }
+}
+
+
+//
+// Make sure the next token output starts a line.
+//
+
+void Preprocessor::startLine()
+{
+    lineStart_ = true;
+}
+
+
+//
+// Get the line number of an offset in a file. Lines are counted on from
+// the last one asked for, as that's usually nearby.
+//
+
+size_t Preprocessor::lineOf(File &file, uint32_t offset)
+{
+    if (offset < file.lineOffset)
+    {
+        file.lineOffset = 0;
+        file.line = 1;
+    }
+
+    const char *p = file.text.data() + file.lineOffset;
+    const char *end = file.text.data() + std::min<size_t>(offset, file.text.size());
+    while (p < end && (p = static_cast<const char *>(memchr(p, '\n', end - p))) != nullptr)
+    {
+        file.line++;
+        p++;
+    }
+
+    file.lineOffset = offset;
+    return file.line;
+}
+
+
+//
+// Throw an exception for an error at a token.
+//
+
+void Preprocessor::error(File &file, size_t i, const std::string &message)
+{
+    uint32_t offset = i < file.tokens.size() ? file.tokens.offset(i) : static_cast<uint32_t>(file.text.size());
+    throw PreprocessorException(file.fileName + ":" + std::to_string(lineOf(file, offset)) + ": " + message);
+}
+
+
+//
+// Expand the predefined macros whose values depend on where they're used.
+// The ones which aren't the same each time a header is included stop its
+// context being kept.
+//
+
+bool Preprocessor::expandBuiltin(const PpToken &name, PpToken *result)
+{
+    File &file = *files_.back();
+    TokenKind kind = TokenKind::PpNumber;
+    bool cacheable = true;
+    std::string text;
+    if (name.text == "__FILE__")
+    {
+        text = file.quotedName;
+        kind = TokenKind::StringLiteral;
+    }
+    else if (name.text == "__LINE__")
+    {
+        text = std::to_string(lineOf(file, name.loc.offset));
+    }
+    else if (name.text == "__COUNTER__")
+    {
+        text = std::to_string(counter_++);
+        cacheable = false;
+    }
+    else if (name.text == "__INCLUDE_LEVEL__")
+    {
+        text = std::to_string(frames_.size());
+        cacheable = false;
+    }
+    else if (name.text == "__BASE_FILE__")
+    {
+        text = quoted(unit_.sourceFileName);
+        kind = TokenKind::StringLiteral;
+        cacheable = false;
+    }
+    else if (name.text == "__DATE__" || name.text == "__TIME__")
+    {
+        time_t now = time(nullptr);
+        struct tm local;
+        localtime_r(&now, &local);
+        char buffer[32];
+        strftime(buffer, sizeof(buffer), name.text == "__DATE__" ? "\"%b %e %Y\"" : "\"%H:%M:%S\"", &local);
+        text = buffer;
+        kind = TokenKind::StringLiteral;
+        cacheable = false;
+    }
+    else
+    {
+        return false;
+    }
+
+    if (!cacheable && !frames_.empty())
+    {
+        frames_.back().cacheable = false;
+    }
 
+    builtinText_.push_back(std::move(text));
+    *result = name;
+    result->kind = kind;
+    result->subKind = 0;
+    result->expanded = true;
+    result->text = builtinText_.back();
+    result->original = SourceLoc();
+    return true;
 }
 
 
@@ -1,17 +1,32 @@
 #ifndef DEEPC_PREPROCESSOR_H
 #define DEEPC_PREPROCESSOR_H
 
-#include <string>
+#include <deque>
+#include <map>
 #include <memory>
+#include <set>
+#include <string>
+#include <unordered_set>
+#include <vector>
 
 #include "compileargs.h"
-#include "programdb.h"
+#include "includeinfo.h"
+#include "macro.h"
+#include "macrocontext.h"
+#include "macroexpander.h"
+#include "pptokenstream.h"
+#include "tokenstream.h"
 
 
 namespace deepC
 {
 
 
+// Forward declarations.
+class Compiler;
+struct CompileUnit;
+
+
 //
 // The preprocessor applies #includes and #defines.
 //
@@ -21,22 +36,171 @@ namespace deepC
 //  * macros it's dependent on.
 //  * files it includes.
 //  * macros it defines.
-//  * preprocessed source output.
+//  * preprocessed source output, as a PpTokenStream.
+//
+// It works on the tokens the lexer has already made for each file.
+// Included files are found through the include graph kept by the Compiler
+// and the program database, see IncludeInfo. A header which is guarded by
+// #pragma once, or by a #ifndef guard whose macro is already defined, is
+// skipped on a repeat inclusion without being opened or scanned.
+//
+// The macros a header reads and the ones it changes are recorded for each
+// context it's included in, see MacroContext. When a header is included
+// in a context it's been in before, in this run or an earlier one, its
+// changes and its output are replayed rather than being worked out again
+// from its tokens.
+//
+// The tokens of a conditional group which isn't taken are passed over by
+// their flags alone, up to the next directive, without being expanded.
 //
 
-class Preprocessor
+class Preprocessor : private MacroExpander::Builtins
 {
+public:
+    // How deeply #includes can nest, which stops unguarded headers which
+    // include themselves.
+    static constexpr int maxIncludeDepth = 200;
+
+private:
+    // A conditional directive whose #endif hasn't been reached yet.
+    struct Conditional
+    {
+        bool active;        // The current group is being preprocessed.
+        bool taken;         // No later group can be, as one already was or the enclosing one isn't active.
+        bool seenElse;
+    };
+
+    // A file being preprocessed.
+    struct File
+    {
+        std::string              fileName;
+        std::string              quotedName;    // The value of __FILE__.
+        const TokenStream       &tokens;
+        std::string_view         text;
+        size_t                   pathIndex;     // One past the include path directory it was found in, or 0.
+        size_t                   pos;           // The next token.
+        std::vector<Conditional> conditionals;
+        uint32_t                 lineOffset;    // A place, and its line number, to count lines from.
+        size_t                   line;
+
+        File(const std::string &fileName, const TokenStream &tokens, std::string_view text, size_t pathIndex);
+    };
+
+    // A header being preprocessed, and what it's done which its macro
+    // context needs besides its use of the macros.
+    struct Frame
+    {
+        size_t                               outputStart;   // The index of its first output token.
+        bool                                 cacheable;     // Its output depends only on what's recorded.
+        std::map<std::string, bool>          onceReads;
+        std::set<std::string>                onceFiles;
+        std::vector<MacroContext::Inclusion> inclusions;
+        size_t                               skippedIncludes;
+
+        explicit Frame(size_t outputStart) : outputStart(outputStart), cacheable(true), skippedIncludes(0) {}
+    };
+
+    class FileSource;
+
     // Inputs for this preprocessing operation.
-    std::shared_ptr<ProgramDb> pdb_;
-    const CompileArgs         &args_;
-    std::string                sourceFileName_;
+    Compiler                       &compiler_;
+    const CompileArgs              &args_;
+    CompileUnit                    &unit_;
+
+    // The macros, and the files being preprocessed with the innermost last.
+    MacroEnvironment                env_;
+    MacroExpander                   expander_;
+    std::vector<File *>             files_;
+    std::vector<Frame>              frames_;
+    std::unordered_set<std::string> onceFiles_;         // Headers with #pragma once which have been included.
+    std::deque<std::string>         builtinText_;       // The text of expanded builtins like __LINE__.
+    unsigned                        counter_;           // The next value of __COUNTER__.
+    bool                            lineStart_;         // The next token output starts a line.
+
+    // The predefined macros and the -D options, as a file of #defines.
+    std::string                     commandLineText_;
+    TokenStream                     commandLineTokens_;
 
     // Results of preprocessing.
-    std::string                preProcText_;    // The preprocessed source text.
+    PpTokenStream                   output_;            // The preprocessed tokens.
+    std::vector<std::string>        includedFiles_;     // Each header which was included, in order.
+    size_t                          skippedIncludes_;   // Repeat inclusions which were skipped.
+    size_t                          replayedHeaders_;   // Headers whose macro context was replayed.
+    size_t                          preprocessedHeaders_; // Headers which were preprocessed from their tokens.
+    size_t                          skippedTokens_;     // The tokens of the conditional groups which weren't taken.
+
+private:
+    // Preprocess a file, or a header along with its macro context.
+    void processFile(File &file, int depth);
+    void processHeader(CompileUnit &header, size_t pathIndex, int depth);
+
+    // Directives.
+    void directive(File &file, int depth);
+    void defineDirective(File &file, size_t first, size_t end);
+    void includeDirective(File &file, size_t first, size_t end, bool next, int depth);
+    bool ifDirective(File &file, size_t first, size_t end);
+    bool ifdefDirective(File &file, size_t first, size_t end);
+    void skipGroup(File &file);
+
+    // Include a header unless it's guarded and has been already.
+    void include(File &file, size_t i, MacroContext::Inclusion &inclusion, int depth);
+
+    // Macro contexts.
+    bool matches(const MacroContext &context);
+    void replay(const std::string &fileName, const MacroContext &context);
+    void addToFrame(const Frame &child);
+    bool onceIncluded(const std::string &fileName);
+    void markOnce(const std::string &fileName);
+
+    // Tokens and output.
+    bool    isDirective(const File &file, size_t i) const;
+    size_t  lineEnd(const File &file, size_t i) const;
+    PpToken token(const File &file, size_t i) const;
+    std::vector<PpToken> tokens(const File &file, size_t first, size_t end) const;
+    void    emit(const std::vector<PpToken> &tokens);
+    void    startLine();
+
+    // Errors.
+    size_t  lineOf(File &file, uint32_t offset);
+    [[noreturn]] void error(File &file, size_t i, const std::string &message);
+
+    // Expand __FILE__, __LINE__ and the like.
+    bool expandBuiltin(const PpToken &name, PpToken *result) override;
+
+public:
+    Preprocessor(Compiler &compiler, const CompileArgs &args, CompileUnit &unit);
+
+    // Preprocess the unit's source file.
+    void run();
+
+    const PpTokenStream &output() const                     { return output_; }
+    std::string preprocessedText() const                    { return output_.toText(); }
+    const std::vector<std::string> &includedFiles() const   { return includedFiles_; }
+    size_t skippedIncludes() const                          { return skippedIncludes_; }
+    size_t replayedHeaders() const                          { return replayedHeaders_; }
+    size_t preprocessedHeaders() const                      { return preprocessedHeaders_; }
+    size_t skippedTokens() const                            { return skippedTokens_; }
+
+    // The macros defined at the end.
+    const MacroEnvironment &macros() const                  { return env_; }
+};
+
+
+//
+// An exception thrown when preprocessing fails.
+//
+
+class PreprocessorException : public std::exception
+{
+    std::string message_;
 
 public:
-    Preprocessor(std::shared_ptr<ProgramDb> pdb, const CompileArgs &args, const std::string &sourceFileName);
-    const std::string &preprocessedText() { return preProcText_; }
+    PreprocessorException(const std::string &message) : message_(message) {}
+
+    const char * what () const throw ()
+    {
+        return message_.c_str();
+    }
 };
 
 
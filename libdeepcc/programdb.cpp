@@ -12,9 +12,16 @@
 #include <sys/types.h>
 #include <sys/stat.h>
 #include <sys/mman.h>
+#include <cstring>
+#include <unordered_map>
 
+#include "includeinfo.h"
+#include "includeresolver.h"
+#include "interner.h"
+#include "macrocontext.h"
 #include "programdb.h"
 #include "sourcefile.h"
+#include "sourcetokens.h"
 #include "storedobject_generated.h"
 
 
@@ -29,65 +36,197 @@ namespace deepC
 // The program database is stored using an LMDB memory-mapped database.
 // This database has several sub-databases:
 //   * global         - stores top level information which relates to
-//                      overall operation.
+//                      overall operation, such as the next id to use
+//                      in each table.
 //   * sourceFileById - keeps a list of known source file names indexed
 //                      by their unique file ids.
 //   * sourceText     - the complete source text of each source file,
 //                      indexed by file id.
+//   * sourceBlobs    - source text indexed by its content digest. Source
+//                      files with identical text share one copy, which is
+//                      reference counted in sourceBlobRefs.
 //
 
-ProgramDb::ProgramDb(const std::string &filename) :
+ProgramDb::ProgramDb(const std::string &filename, size_t initialMapSize) :
     env_(nullptr),
-    isOpen_(false)
+    isOpen_(false),
+    writeGeneration_(0),
+    mapSize_(initialMapSize),
+    activeReaders_(0),
+    threadHits_(0),
+    renewed_(0),
+    created_(0)
 {
     // Open the environment.
     int rc = mdb_env_create(&env_);
     if (rc)
-        throw ProgramDbException(std::string("mdb_env_create: ") + mdb_strerror(rc));
+        throw ProgramDbException(std::string("mdb_env_create: ") + mdb_strerror(rc), rc);
 
-    rc = mdb_env_set_mapsize(env_, 1UL * 1024UL * 1024UL * 1024UL); /* 1 GiB */
+    rc = mdb_env_set_mapsize(env_, mapSize_);
     if (rc)
-        throw ProgramDbException(std::string("mdb_env_set_mapsize: ") + mdb_strerror(rc));
+        throw ProgramDbException(std::string("mdb_env_set_mapsize: ") + mdb_strerror(rc), rc);
 
-    rc = mdb_env_open(env_, filename.c_str(), 0, 0664);
+    // The number of named databases has to be set before the environment is opened.
+    rc = mdb_env_set_maxdbs(env_, 32);
     if (rc)
-        throw ProgramDbException(std::string("mdb_env_open: ") + mdb_strerror(rc));
+        throw ProgramDbException(std::string("mdb_env_set_maxdbs: ") + mdb_strerror(rc), rc);
 
-    rc = mdb_env_set_maxdbs(env_, 32);
-        throw ProgramDbException(std::string("mdb_env_set_maxdbs: ") + mdb_strerror(rc));
+    // Every worker thread may hold a snapshot, as may objects read through
+    // older snapshots, so allow plenty of readers.
+    rc = mdb_env_set_maxreaders(env_, 1024);
+    if (rc)
+        throw ProgramDbException(std::string("mdb_env_set_maxreaders: ") + mdb_strerror(rc), rc);
+
+    // Read transactions are pooled and may be held by snapshots on any
+    // thread, so they can't be tied to thread local storage.
+    rc = mdb_env_open(env_, filename.c_str(), MDB_NOTLS, 0664);
+    if (rc)
+        throw ProgramDbException(std::string("mdb_env_open: ") + mdb_strerror(rc), rc);
+
+    // An existing database may already be bigger than we asked for.
+    MDB_envinfo info;
+    if (mdb_env_info(env_, &info) == 0)
+    {
+        mapSize_ = info.me_mapsize;
+    }
 
     // Open the transaction we'll use to open the databases.
     MDB_txn *txn = nullptr;
     rc = mdb_txn_begin(env_, nullptr, 0, &txn);
     if (rc)
-        throw ProgramDbException(std::string("mdb_txn_begin: ") + mdb_strerror(rc));
+        throw ProgramDbException(std::string("mdb_txn_begin: ") + mdb_strerror(rc), rc);
 
     // Open the databases.
+    rc = mdb_dbi_open(txn, "Global", MDB_CREATE, &globalDbi_);
+    if (rc)
+    {
+        mdb_txn_abort(txn);
+        throw ProgramDbException(std::string("mdb_dbi_open(Global): ") + mdb_strerror(rc), rc);
+    }
+
     rc = mdb_dbi_open(txn, "SourceFiles", MDB_INTEGERKEY | MDB_CREATE, &sourceFilesDbi_);
     if (rc)
     {
         mdb_txn_abort(txn);
-        throw ProgramDbException(std::string("mdb_dbi_open(SourceFiles): ") + mdb_strerror(rc));
+        throw ProgramDbException(std::string("mdb_dbi_open(SourceFiles): ") + mdb_strerror(rc), rc);
     }
 
     rc = mdb_dbi_open(txn, "SourceFileIdsByFilename", MDB_CREATE, &sourceFileKeysDbi_);
     if (rc)
     {
         mdb_txn_abort(txn);
-        throw ProgramDbException(std::string("mdb_dbi_open(SourceFileIdsByFilename): ") + mdb_strerror(rc));
+        throw ProgramDbException(std::string("mdb_dbi_open(SourceFileIdsByFilename): ") + mdb_strerror(rc), rc);
+    }
+
+    rc = mdb_dbi_open(txn, "SourceBlobs", MDB_CREATE, &sourceBlobsDbi_);
+    if (rc)
+    {
+        mdb_txn_abort(txn);
+        throw ProgramDbException(std::string("mdb_dbi_open(SourceBlobs): ") + mdb_strerror(rc), rc);
+    }
+
+    rc = mdb_dbi_open(txn, "SourceBlobRefs", MDB_CREATE, &sourceBlobRefsDbi_);
+    if (rc)
+    {
+        mdb_txn_abort(txn);
+        throw ProgramDbException(std::string("mdb_dbi_open(SourceBlobRefs): ") + mdb_strerror(rc), rc);
+    }
+
+    rc = mdb_dbi_open(txn, "SourceTokens", MDB_INTEGERKEY | MDB_CREATE, &sourceTokensDbi_);
+    if (rc)
+    {
+        mdb_txn_abort(txn);
+        throw ProgramDbException(std::string("mdb_dbi_open(SourceTokens): ") + mdb_strerror(rc), rc);
+    }
+
+    rc = mdb_dbi_open(txn, "SourceTokenIdsBySourceFile", MDB_CREATE, &sourceTokenKeysDbi_);
+    if (rc)
+    {
+        mdb_txn_abort(txn);
+        throw ProgramDbException(std::string("mdb_dbi_open(SourceTokenIdsBySourceFile): ") + mdb_strerror(rc), rc);
+    }
+
+    rc = mdb_dbi_open(txn, "IncludeInfos", MDB_INTEGERKEY | MDB_CREATE, &includeInfosDbi_);
+    if (rc)
+    {
+        mdb_txn_abort(txn);
+        throw ProgramDbException(std::string("mdb_dbi_open(IncludeInfos): ") + mdb_strerror(rc), rc);
+    }
+
+    rc = mdb_dbi_open(txn, "IncludeInfoIdsBySourceFile", MDB_CREATE, &includeInfoKeysDbi_);
+    if (rc)
+    {
+        mdb_txn_abort(txn);
+        throw ProgramDbException(std::string("mdb_dbi_open(IncludeInfoIdsBySourceFile): ") + mdb_strerror(rc), rc);
+    }
+
+    rc = mdb_dbi_open(txn, "IncludeResolutions", MDB_INTEGERKEY | MDB_CREATE, &includeResolutionsDbi_);
+    if (rc)
+    {
+        mdb_txn_abort(txn);
+        throw ProgramDbException(std::string("mdb_dbi_open(IncludeResolutions): ") + mdb_strerror(rc), rc);
+    }
+
+    rc = mdb_dbi_open(txn, "IncludeResolutionIdsByKey", MDB_CREATE, &includeResolutionKeysDbi_);
+    if (rc)
+    {
+        mdb_txn_abort(txn);
+        throw ProgramDbException(std::string("mdb_dbi_open(IncludeResolutionIdsByKey): ") + mdb_strerror(rc), rc);
+    }
+
+    rc = mdb_dbi_open(txn, "HeaderMacroContexts", MDB_INTEGERKEY | MDB_CREATE, &macroContextsDbi_);
+    if (rc)
+    {
+        mdb_txn_abort(txn);
+        throw ProgramDbException(std::string("mdb_dbi_open(HeaderMacroContexts): ") + mdb_strerror(rc), rc);
+    }
+
+    rc = mdb_dbi_open(txn, "HeaderMacroContextIdsBySourceFile", MDB_CREATE, &macroContextKeysDbi_);
+    if (rc)
+    {
+        mdb_txn_abort(txn);
+        throw ProgramDbException(std::string("mdb_dbi_open(HeaderMacroContextIdsBySourceFile): ") + mdb_strerror(rc), rc);
+    }
+
+    rc = mdb_dbi_open(txn, "Identifiers", MDB_INTEGERKEY | MDB_CREATE, &identifiersDbi_);
+    if (rc)
+    {
+        mdb_txn_abort(txn);
+        throw ProgramDbException(std::string("mdb_dbi_open(Identifiers): ") + mdb_strerror(rc), rc);
     }
 
     // Close the transaction without closing the databases.
     rc = mdb_txn_commit(txn);
     if (rc)
-        throw ProgramDbException(std::string("mdb_txn_commit: ") + mdb_strerror(rc));
+        throw ProgramDbException(std::string("mdb_txn_commit: ") + mdb_strerror(rc), rc);
 
     isOpen_ = true;
 }
 
 
+//
+// Open a program database.
+//
+
+std::shared_ptr<ProgramDb> ProgramDb::create(const std::string &filename, size_t initialMapSize)
+{
+    return std::shared_ptr<ProgramDb>(new ProgramDb(filename, initialMapSize));
+}
+
+
 ProgramDb::~ProgramDb()
 {
+    // Return the threads' read transactions to the pool.
+    threadReads_.clear();
+
+    // Free any pooled read transactions.
+    for (MDB_txn *txn : readPool_)
+    {
+        mdb_txn_abort(txn);
+    }
+
+    readPool_.clear();
+
     if (env_)
     {
         mdb_env_close(env_);
@@ -97,122 +236,909 @@ ProgramDb::~ProgramDb()
 
 
 //
-// Given a Storable object with the key set, find the object id.
-// Returns false if not found.
+// Given a Storable object with the key set, find the object id.
+// Returns false if not found.
+//
+
+uint32_t ProgramDb::getId(const Storable &obj)
+{
+    // Create the key.
+    flatbuffers::FlatBufferBuilder builder;
+    obj.serialiseKey(builder);
+    MDB_val key;
+    key.mv_size = builder.GetSize();
+    key.mv_data = reinterpret_cast<void *>(builder.GetBufferPointer());
+
+    // Get the record.
+    try {
+        return snapshot()->getIdByKey(getDbHandle(obj.keyDbGroup()), key);
+    }
+    catch (const ProgramDbException &e) {
+        throw ProgramDbException(std::string("can't get id, ") + e.what());
+    }
+}
+
+
+//
+// Get a stored source file by its file name. Returns nullptr if it's not
+// in the database.
+//
+
+std::shared_ptr<SourceFile> ProgramDb::getSourceFile(const std::string &fileName)
+{
+    // Create the key.
+    flatbuffers::FlatBufferBuilder builder;
+    SourceFile::serialiseKey(builder, fileName);
+    MDB_val key;
+    key.mv_size = builder.GetSize();
+    key.mv_data = reinterpret_cast<void *>(builder.GetBufferPointer());
+
+    // Look it up.
+    std::shared_ptr<ProgramDbSnapshot> snap = snapshot();
+    uint32_t id;
+    try {
+        id = snap->getIdByKey(sourceFileKeysDbi_, key);
+    }
+    catch (const ProgramDbException &e) {
+        throw ProgramDbException(std::string("can't get source file id, ") + e.what(), e.rc());
+    }
+
+    if (id == 0)
+        return nullptr;
+
+    return std::dynamic_pointer_cast<SourceFile>(get(snap, Storable::DbGroup::SourceFiles, id));
+}
+
+
+//
+// Get the stored tokens of a source file. Returns nullptr if there aren't
+// any. The tokens are used in place in the snapshot.
+//
+
+std::shared_ptr<SourceTokens> ProgramDb::getSourceTokens(uint32_t sourceFileId)
+{
+    // Create the key.
+    flatbuffers::FlatBufferBuilder builder;
+    SourceTokens::serialiseKey(builder, sourceFileId);
+    MDB_val key;
+    key.mv_size = builder.GetSize();
+    key.mv_data = reinterpret_cast<void *>(builder.GetBufferPointer());
+
+    // Look it up.
+    std::shared_ptr<ProgramDbSnapshot> snap = snapshot();
+    uint32_t id;
+    try {
+        id = snap->getIdByKey(sourceTokenKeysDbi_, key);
+    }
+    catch (const ProgramDbException &e) {
+        throw ProgramDbException(std::string("can't get source tokens id, ") + e.what(), e.rc());
+    }
+
+    if (id == 0)
+        return nullptr;
+
+    return std::dynamic_pointer_cast<SourceTokens>(get(snap, Storable::DbGroup::SourceTokens, id));
+}
+
+
+//
+// Get the stored include information of a source file. Returns nullptr if
+// there isn't any.
+//
+
+std::shared_ptr<IncludeInfo> ProgramDb::getIncludeInfo(uint32_t sourceFileId)
+{
+    // Create the key.
+    flatbuffers::FlatBufferBuilder builder;
+    IncludeInfo::serialiseKey(builder, sourceFileId);
+    MDB_val key;
+    key.mv_size = builder.GetSize();
+    key.mv_data = reinterpret_cast<void *>(builder.GetBufferPointer());
+
+    // Look it up.
+    std::shared_ptr<ProgramDbSnapshot> snap = snapshot();
+    uint32_t id;
+    try {
+        id = snap->getIdByKey(includeInfoKeysDbi_, key);
+    }
+    catch (const ProgramDbException &e) {
+        throw ProgramDbException(std::string("can't get include information id, ") + e.what(), e.rc());
+    }
+
+    if (id == 0)
+        return nullptr;
+
+    return std::dynamic_pointer_cast<IncludeInfo>(get(snap, Storable::DbGroup::IncludeInfos, id));
+}
+
+
+//
+// Get a stored include resolution by its key. Returns nullptr if there
+// isn't one.
+//
+
+std::shared_ptr<IncludeResolution> ProgramDb::getIncludeResolution(const std::string &resolutionKey)
+{
+    // Create the key.
+    flatbuffers::FlatBufferBuilder builder;
+    IncludeResolution::serialiseKey(builder, resolutionKey);
+    MDB_val key;
+    key.mv_size = builder.GetSize();
+    key.mv_data = reinterpret_cast<void *>(builder.GetBufferPointer());
+
+    // Look it up.
+    std::shared_ptr<ProgramDbSnapshot> snap = snapshot();
+    uint32_t id;
+    try {
+        id = snap->getIdByKey(includeResolutionKeysDbi_, key);
+    }
+    catch (const ProgramDbException &e) {
+        throw ProgramDbException(std::string("can't get include resolution id, ") + e.what(), e.rc());
+    }
+
+    if (id == 0)
+        return nullptr;
+
+    return std::dynamic_pointer_cast<IncludeResolution>(get(snap, Storable::DbGroup::IncludeResolutions, id));
+}
+
+
+//
+// Get the stored macro contexts of a header. Returns nullptr if there
+// aren't any.
+//
+
+std::shared_ptr<HeaderMacroContexts> ProgramDb::getHeaderMacroContexts(uint32_t sourceFileId)
+{
+    // Create the key.
+    flatbuffers::FlatBufferBuilder builder;
+    HeaderMacroContexts::serialiseKey(builder, sourceFileId);
+    MDB_val key;
+    key.mv_size = builder.GetSize();
+    key.mv_data = reinterpret_cast<void *>(builder.GetBufferPointer());
+
+    // Look it up.
+    std::shared_ptr<ProgramDbSnapshot> snap = snapshot();
+    uint32_t id;
+    try {
+        id = snap->getIdByKey(macroContextKeysDbi_, key);
+    }
+    catch (const ProgramDbException &e) {
+        throw ProgramDbException(std::string("can't get macro contexts id, ") + e.what(), e.rc());
+    }
+
+    if (id == 0)
+        return nullptr;
+
+    return std::dynamic_pointer_cast<HeaderMacroContexts>(get(snap, Storable::DbGroup::MacroContexts, id));
+}
+
+
+//
+// Get an object given the database and id, using the current snapshot.
+//
+
+std::shared_ptr<Storable> ProgramDb::get(Storable::DbGroup dbg, uint32_t id)
+{
+    return get(snapshot(), dbg, id);
+}
+
+
+//
+// Get an object given the database and id. The object may refer directly
+// to data in the snapshot so it keeps the snapshot open.
+//
+
+std::shared_ptr<Storable> ProgramDb::get(const std::shared_ptr<ProgramDbSnapshot> &snap, Storable::DbGroup dbg, uint32_t id)
+{
+    MDB_val val;
+
+    try {
+        // Get the record.
+        if (!snap->getById(getDbHandle(dbg), id, &val))
+            return nullptr;
+        
+        // Convert the binary form into an object.
+        const fb::StoredObject *so = fb::GetStoredObject(val.mv_data);
+        std::shared_ptr<Storable> obj = Storable::create(id, *so, snap);
+
+        // Point it at its payload, without copying it.
+        ContentDigest digest;
+        MDB_val blob;
+        if (obj->blobDigest(&digest) && snap->getBlob(sourceBlobsDbi_, digest, &blob))
+        {
+            obj->setBlob(std::string_view(reinterpret_cast<const char *>(blob.mv_data), blob.mv_size));
+        }
+
+        return obj;
+    }
+    catch (const ProgramDbException &e) {
+        throw ProgramDbException(std::string("can't get by id ") + std::to_string(id) + ", " + e.what());
+    }
+}
+
+
+//
+// Get a read-only snapshot of the database. Each thread keeps a reference
+// to its current read transaction and reuses it for as long as nothing
+// new has been written, so hot lookups don't need a transaction each and
+// threads don't share one.
+//
+
+std::shared_ptr<ProgramDbSnapshot> ProgramDb::snapshot()
+{
+    std::thread::id thread = std::this_thread::get_id();
+    std::shared_ptr<ReadTxn> stale;
+    {
+        std::lock_guard<std::mutex> locker(threadReadsMutex_);
+        std::shared_ptr<ReadTxn> &current = threadReads_[thread];
+        if (current && current->generation == writeGeneration_)
+        {
+            threadHits_++;
+            return std::make_shared<ProgramDbSnapshot>(shared_from_this(), current);
+        }
+
+        // Let it go once we're not holding the lock.
+        stale = std::move(current);
+    }
+
+    // Start a new one for this thread to use.
+    auto read = std::make_shared<ReadTxn>(*this);
+    {
+        std::lock_guard<std::mutex> locker(threadReadsMutex_);
+        threadReads_[thread] = read;
+    }
+
+    return std::make_shared<ProgramDbSnapshot>(shared_from_this(), read);
+}
+
+
+//
+// Get the read transaction reuse counters.
+//
+
+ProgramDb::ReadStats ProgramDb::readStats() const
+{
+    ReadStats stats;
+    stats.threadHits = threadHits_;
+    stats.renewed    = renewed_;
+    stats.created    = created_;
+
+    return stats;
+}
+
+
+//
+// A write has been committed. Any snapshots already taken keep seeing
+// the old data, but no thread reuses them for new lookups. The id
+// sequences are reloaded by the next write transaction, as another
+// handle on the database may have moved them on in the meantime. The
+// caller must hold writeMutex_.
+//
+
+void ProgramDb::committed()
+{
+    idSequences_.clear();
+    writeGeneration_++;
+    dropThreadReads();
+}
+
+
+//
+// Forget each thread's current read transaction. They go back to the
+// pool once the snapshots using them are done.
+//
+
+void ProgramDb::dropThreadReads()
+{
+    std::map<std::thread::id, std::shared_ptr<ReadTxn>> dropped;
+    {
+        std::lock_guard<std::mutex> locker(threadReadsMutex_);
+        dropped.swap(threadReads_);
+    }
+}
+
+
+//
+// Store a SourceFile in the database.
+//
+
+void ProgramDb::put(Storable &source)
+{
+    std::lock_guard<std::mutex> locker(writeMutex_);
+    Storable::Id originalId = source.id();
+
+    for (;;)
+    {
+        try {
+            Transaction txn(*this, true);
+            putInTxn(txn, source);
+            writeIdSequences(txn);
+            txn.commit();
+            committed();
+            return;
+        }
+        catch (const ProgramDbException &e) {
+            // Any id it was given was lost with the transaction.
+            source.setId(originalId);
+
+            // If the map filled up, grow it and try again.
+            if (!recoverFromWriteError(e.rc()))
+                throw;
+        }
+    }
+}
+
+
+//
+// Set aside a run of ids in a table so objects can be given them before
+// they're stored, without a write transaction each. An object stored
+// under a reserved id gets its key mapped to it then.
+//
+
+uint32_t ProgramDb::reserveIds(Storable::DbGroup dbg, uint32_t count)
+{
+    std::lock_guard<std::mutex> locker(writeMutex_);
+
+    for (;;)
+    {
+        try {
+            Transaction txn(*this, true);
+            uint32_t first = allocateId(txn, dbg);
+            for (uint32_t i = 1; i < count; i++)
+            {
+                allocateId(txn, dbg);
+            }
+
+            writeIdSequences(txn);
+            txn.commit();
+            committed();
+            return first;
+        }
+        catch (const ProgramDbException &e) {
+            // The sequence has to be loaded again as it wasn't written.
+            idSequences_.erase(dbg);
+            if (!recoverFromWriteError(e.rc()))
+                throw;
+        }
+    }
+}
+
+
+//
+// Store a Storable item using a write transaction which is already open.
+// The caller must hold writeMutex_ since the builders are shared.
+//
+
+void ProgramDb::putInTxn(Transaction &txn, Storable &source)
+{
+    // Encode the Storable item's key and content.
+    MDB_val key;
+    keyBuilder_.Clear();
+    source.serialiseKey(keyBuilder_);
+    key.mv_data = keyBuilder_.GetBufferPointer();
+    key.mv_size = keyBuilder_.GetSize();
+
+    MDB_val val;
+    contentBuilder_.Clear();
+    source.serialiseContent(contentBuilder_);
+    val.mv_data = contentBuilder_.GetBufferPointer();
+    val.mv_size = contentBuilder_.GetSize();
+
+    MDB_dbi contentDbi = getDbHandle(source.contentDbGroup());
+    MDB_dbi keyDbi     = getDbHandle(source.keyDbGroup());
+    
+    // Does it have a payload to share?
+    ContentDigest digest;
+    bool hasBlob = source.blobDigest(&digest);
+
+    // Do we already know the file id?
+    uint32_t id = source.id();
+    if (id == 0)
+    {
+        // See if it already exists in the database.
+        id = txn.getIdByKey(keyDbi, key);
+    }
+
+    // If this file has no file id, make one.
+    if (id == 0)
+    {
+        if (hasBlob)
+        {
+            txn.addBlobRef(sourceBlobsDbi_, sourceBlobRefsDbi_, digest, source.blob());
+        }
+
+        // Store the row under a new id.
+        id = allocateId(txn, source.contentDbGroup());
+        txn.addRow(contentDbi, id, val);
+
+        // Add the name to id lookup.
+        source.setId(id);
+        txn.addKeyToIdMapping(keyDbi, key, id);
+    }
+    else
+    {
+        // There's no row yet if the id was reserved for it.
+        MDB_val oldVal;
+        bool hadRow = txn.getById(contentDbi, id, &oldVal);
+
+        if (hasBlob)
+        {
+            // If the payload hasn't changed there's nothing more to store,
+            // otherwise swap the old payload for the new one.
+            ContentDigest oldDigest;
+            bool hadBlob = hadRow && Storable::storedBlobDigest(*fb::GetStoredObject(oldVal.mv_data), &oldDigest);
+
+            if (hadBlob && oldDigest == digest)
+            {
+                txn.checkBlob(sourceBlobsDbi_, digest, source.blob());
+            }
+            else
+            {
+                txn.addBlobRef(sourceBlobsDbi_, sourceBlobRefsDbi_, digest, source.blob());
+                if (hadBlob)
+                {
+                    txn.releaseBlobRef(sourceBlobsDbi_, sourceBlobRefsDbi_, oldDigest);
+                }
+            }
+        }
+
+        // Store the row under the id it already has.
+        source.setId(id);
+        txn.putRow(contentDbi, id, val);
+
+        if (!hadRow)
+        {
+            txn.addKeyToIdMapping(keyDbi, key, id);
+        }
+    }
+}
+
+
+//
+// Gather statistics about what's stored, including how much the sharing
+// of identical source text is saving.
+//
+
+ProgramDb::Stats ProgramDb::stats()
+{
+    Stats stats = {};
+    std::shared_ptr<ProgramDbSnapshot> snap = snapshot();
+
+    MDB_stat dbStat;
+    int rc = mdb_stat(snap->getTxn(), sourceFilesDbi_, &dbStat);
+    if (rc)
+        throw ProgramDbException(std::string("can't get source file stats: ") + mdb_strerror(rc), rc);
+
+    stats.sourceFiles = dbStat.ms_entries;
+
+    rc = mdb_stat(snap->getTxn(), identifiersDbi_, &dbStat);
+    if (rc)
+        throw ProgramDbException(std::string("can't get identifier stats: ") + mdb_strerror(rc), rc);
+
+    stats.identifiers = dbStat.ms_entries;
+
+    // The reference counts tell us how many source files use each blob.
+    MDB_cursor *cursor = nullptr;
+    rc = mdb_cursor_open(snap->getTxn(), sourceBlobRefsDbi_, &cursor);
+    if (rc)
+        throw ProgramDbException(std::string("can't get blob stats: ") + mdb_strerror(rc), rc);
+
+    MDB_val key;
+    MDB_val val;
+    for (rc = mdb_cursor_get(cursor, &key, &val, MDB_FIRST); rc == 0; rc = mdb_cursor_get(cursor, &key, &val, MDB_NEXT))
+    {
+        if (key.mv_size != sizeof(ContentDigest) || val.mv_size != sizeof(uint32_t))
+            continue;
+
+        ContentDigest digest;
+        uint32_t refs;
+        memcpy(&digest, key.mv_data, sizeof(digest));
+        memcpy(&refs, val.mv_data, sizeof(refs));
+
+        stats.blobs++;
+        stats.storedBytes += digest.size;
+        stats.logicalBytes += digest.size * refs;
+    }
+
+    mdb_cursor_close(cursor);
+    if (rc != MDB_NOTFOUND)
+        throw ProgramDbException(std::string("can't get blob stats: ") + mdb_strerror(rc), rc);
+
+    return stats;
+}
+
+
+//
+// Load the stored identifiers into an interner, from the first one it
+// doesn't have yet. They're interned in id order so each gets the same
+// id it had when it was stored.
+//
+
+void ProgramDb::loadIdentifiers(Interner &interner)
+{
+    std::shared_ptr<ProgramDbSnapshot> snap = snapshot();
+    MDB_cursor *cursor = nullptr;
+    int rc = mdb_cursor_open(snap->getTxn(), identifiersDbi_, &cursor);
+    if (rc)
+        throw ProgramDbException(std::string("can't load identifiers: ") + mdb_strerror(rc), rc);
+
+    uint32_t id = static_cast<uint32_t>(interner.size()) + 1;
+    MDB_val key;
+    key.mv_size = sizeof(id);
+    key.mv_data = reinterpret_cast<void *>(&id);
+    MDB_val val;
+    for (rc = mdb_cursor_get(cursor, &key, &val, MDB_SET_RANGE); rc == 0; rc = mdb_cursor_get(cursor, &key, &val, MDB_NEXT))
+    {
+        uint32_t storedId;
+        memcpy(&storedId, key.mv_data, sizeof(storedId));
+        std::string_view text(static_cast<const char *>(val.mv_data), val.mv_size);
+        if (key.mv_size != sizeof(storedId) || interner.intern(text) != storedId)
+        {
+            mdb_cursor_close(cursor);
+            throw ProgramDbException("the stored identifiers don't match, identifier " + std::to_string(storedId) + " is \"" + std::string(text) + "\"");
+        }
+    }
+
+    mdb_cursor_close(cursor);
+    if (rc != MDB_NOTFOUND)
+        throw ProgramDbException(std::string("can't load identifiers: ") + mdb_strerror(rc), rc);
+
+    interner.setSavedCount(static_cast<Interner::Id>(interner.size()));
+}
+
+
+//
+// Store the identifiers which have been interned since they were last
+// loaded or saved. If other compilers have stored identifiers in the
+// meantime ours are merged with theirs by spelling: one they've already
+// stored keeps their id, and ones they stored which we haven't seen are
+// interned here, so we can read their tokens. Where that leaves our ids
+// different from the stored ones the interner maps between them.
+//
+
+void ProgramDb::saveIdentifiers(Interner &interner)
+{
+    if (interner.savedCount() >= interner.size())
+        return;
+
+    std::lock_guard<std::mutex> locker(writeMutex_);
+    for (;;)
+    {
+        try {
+            Transaction txn(*this, true);
+            Interner::Id count = static_cast<Interner::Id>(interner.size());
+
+            // Find how many are stored already.
+            MDB_cursor *cursor = nullptr;
+            int rc = mdb_cursor_open(txn.getTxn(), identifiersDbi_, &cursor);
+            if (rc)
+                throw ProgramDbException(std::string("can't save identifiers: ") + mdb_strerror(rc), rc);
+
+            MDB_val key;
+            MDB_val val;
+            rc = mdb_cursor_get(cursor, &key, &val, MDB_LAST);
+            mdb_cursor_close(cursor);
+            if (rc != 0 && rc != MDB_NOTFOUND)
+                throw ProgramDbException(std::string("can't save identifiers: ") + mdb_strerror(rc), rc);
+
+            Interner::Id stored = 0;
+            if (rc == 0 && key.mv_size == sizeof(stored))
+            {
+                memcpy(&stored, key.mv_data, sizeof(stored));
+            }
+
+            // The ones other compilers have stored since we last looked.
+            Interner::Id known = interner.storedCount();
+            std::vector<std::string_view> theirs;
+            std::unordered_map<std::string_view, Interner::Id> theirIds;
+            for (Interner::Id id = known + 1; id <= stored; id++)
+            {
+                if (!txn.getById(identifiersDbi_, id, &val))
+                    throw ProgramDbException("identifier " + std::to_string(id) + " is missing");
+
+                theirs.emplace_back(static_cast<const char *>(val.mv_data), val.mv_size);
+                theirIds.emplace(theirs.back(), id);
+            }
+
+            // Ours get the id of the same identifier if they've stored it,
+            // or a new one after theirs.
+            std::vector<std::pair<Interner::Id, Interner::Id>> storedIds;
+            Interner::Id next = stored;
+            for (Interner::Id id = interner.savedCount() + 1; id <= count; id++)
+            {
+                std::string_view text = interner.text(id);
+                auto it = theirIds.find(text);
+                if (it != theirIds.end())
+                {
+                    storedIds.emplace_back(id, it->second);
+                    theirIds.erase(it);
+                    continue;
+                }
+
+                val.mv_size = text.size();
+                val.mv_data = const_cast<char *>(text.data());
+                txn.addRow(identifiersDbi_, ++next, val);
+                storedIds.emplace_back(id, next);
+            }
+
+            // Theirs which we haven't seen get ids of our own.
+            for (Interner::Id id = known + 1; id <= stored; id++)
+            {
+                std::string_view text = theirs[id - known - 1];
+                if (theirIds.count(text) != 0)
+                {
+                    storedIds.emplace_back(interner.intern(text), id);
+                }
+            }
+
+            txn.commit();
+            committed();
+            for (const auto &ids : storedIds)
+            {
+                interner.setStoredId(ids.first, ids.second);
+            }
+
+            interner.setSavedCount(static_cast<Interner::Id>(interner.size()));
+            return;
+        }
+        catch (const ProgramDbException &e) {
+            // If the map filled up, grow it and try again.
+            if (!recoverFromWriteError(e.rc()))
+                throw;
+        }
+    }
+}
+
+
+//
+// Convert a database group id to the handle for that database.
+//
+
+MDB_dbi ProgramDb::getDbHandle(Storable::DbGroup db) const
+{
+    switch (db)
+    {
+    case Storable::DbGroup::SourceFiles:           return sourceFilesDbi_;
+    case Storable::DbGroup::SourceFileKeys:        return sourceFileKeysDbi_;
+    case Storable::DbGroup::SourceTokens:          return sourceTokensDbi_;
+    case Storable::DbGroup::SourceTokenKeys:       return sourceTokenKeysDbi_;
+    case Storable::DbGroup::IncludeInfos:          return includeInfosDbi_;
+    case Storable::DbGroup::IncludeInfoKeys:       return includeInfoKeysDbi_;
+    case Storable::DbGroup::IncludeResolutions:    return includeResolutionsDbi_;
+    case Storable::DbGroup::IncludeResolutionKeys: return includeResolutionKeysDbi_;
+    case Storable::DbGroup::MacroContexts:         return macroContextsDbi_;
+    case Storable::DbGroup::MacroContextKeys:      return macroContextKeysDbi_;
+    default:                                       throw ProgramDbException("invalid db group");
+    }
+}
+
+
+//
+// The key of the global table record which holds a table's id sequence.
+//
+
+std::string ProgramDb::idSequenceKey(Storable::DbGroup dbg)
+{
+    switch (dbg)
+    {
+    case Storable::DbGroup::SourceFiles:        return "NextId.SourceFiles";
+    case Storable::DbGroup::SourceTokens:       return "NextId.SourceTokens";
+    case Storable::DbGroup::IncludeInfos:       return "NextId.IncludeInfos";
+    case Storable::DbGroup::IncludeResolutions: return "NextId.IncludeResolutions";
+    case Storable::DbGroup::MacroContexts:      return "NextId.MacroContexts";
+    default:                                    throw ProgramDbException("db group has no ids");
+    }
+}
+
+
+//
+// Allocate a new id in a table. Ids are handed out from a sequence kept
+// in memory, so this doesn't need to look at the table itself. The
+// sequence is written to the global table when the transaction commits.
+//
+
+uint32_t ProgramDb::allocateId(Transaction &txn, Storable::DbGroup dbg)
+{
+    auto it = idSequences_.find(dbg);
+    if (it == idSequences_.end())
+    {
+        // Load it from the global table.
+        IdSequence seq;
+        seq.nextId = txn.getNextId(globalDbi_, getDbHandle(dbg), idSequenceKey(dbg));
+        seq.dirty = false;
+        it = idSequences_.emplace(dbg, seq).first;
+    }
+
+    IdSequence &seq = it->second;
+    if (seq.nextId == 0)
+        throw ProgramDbException("out of ids");
+
+    seq.dirty = true;
+    return seq.nextId++;
+}
+
+
+//
+// Write any id sequences which have changed to the global table, as
+// part of the transaction which used them.
+//
+
+void ProgramDb::writeIdSequences(Transaction &txn)
+{
+    for (auto &item : idSequences_)
+    {
+        IdSequence &seq = item.second;
+        if (seq.dirty)
+        {
+            txn.putNextId(globalDbi_, idSequenceKey(item.first), seq.nextId);
+            seq.dirty = false;
+        }
+    }
+}
+
+
+//
+// A write transaction failed so the in-memory id sequences may be ahead
+// of what's stored. Reload them next time they're needed.
+//
+
+void ProgramDb::forgetIdSequences()
+{
+    idSequences_.clear();
+}
+
+
+//
+// Get a read transaction, renewing a pooled one if there is one.
+//
+
+MDB_txn *ProgramDb::acquireReadTxn()
+{
+    MDB_txn *txn = nullptr;
+    {
+        std::lock_guard<std::mutex> locker(readPoolMutex_);
+        activeReaders_++;
+
+        if (!readPool_.empty())
+        {
+            txn = readPool_.back();
+            readPool_.pop_back();
+        }
+    }
+
+    if (txn)
+    {
+        int rc = mdb_txn_renew(txn);
+        if (rc == 0)
+        {
+            renewed_++;
+            return txn;
+        }
+
+        // It couldn't be renewed so get rid of it and start a new one.
+        mdb_txn_abort(txn);
+        txn = nullptr;
+    }
+
+    int rc = mdb_txn_begin(env_, nullptr, MDB_RDONLY, &txn);
+    if (rc)
+    {
+        std::lock_guard<std::mutex> locker(readPoolMutex_);
+        activeReaders_--;
+        throw ProgramDbException(std::string("can't create read transaction on program database: ") + mdb_strerror(rc), rc);
+    }
+
+    created_++;
+    return txn;
+}
+
+
+//
+// Reset a read transaction and return it to the pool.
+//
+
+void ProgramDb::releaseReadTxn(MDB_txn *txn)
+{
+    mdb_txn_reset(txn);
+
+    std::lock_guard<std::mutex> locker(readPoolMutex_);
+    readPool_.push_back(txn);
+    activeReaders_--;
+}
+
+
+//
+// Deal with a write which failed. If the map was full it's grown
+// geometrically, and if another process has grown it we pick up the new
+// size. Returns true if the write should be retried, or false if the
+// original error stands, which includes the map needing to change size
+// while objects read from it are still in use.
 //
 
-uint32_t ProgramDb::getId(const Storable &obj)
+bool ProgramDb::recoverFromWriteError(int rc)
 {
-    // Create the key.
-    flatbuffers::FlatBufferBuilder builder;
-    obj.serialiseKey(builder);
-    MDB_val key;
-    key.mv_size = builder.GetSize();
-    key.mv_data = reinterpret_cast<void *>(builder.GetBufferPointer());
+    switch (rc)
+    {
+    case MDB_MAP_FULL:
+        return resizeMap(mapSize_ * 2);
 
-    // Get the record.
-    Transaction txn(*this, false);
+    case MDB_MAP_RESIZED:
+        return resizeMap(0);
 
-    try {
-        return txn.getIdByKey(getDbHandle(obj.keyDbGroup()), key);
-    }
-    catch (const ProgramDbException &e) {
-        throw ProgramDbException(std::string("can't get id, ") + e.what());
+    default:
+        return false;
     }
 }
 
 
 //
-// Get an object given the database and id.
+// Change the size of the memory map. A size of 0 adopts the size the
+// database already has. LMDB remaps the file, which would pull the data
+// out from under anything still reading from the old map, so this only
+// happens when there are no readers and returns false otherwise. It never
+// waits, since readers may be objects which live as long as the caller.
 //
 
-std::shared_ptr<Storable> ProgramDb::get(Storable::DbGroup dbg, uint32_t id)
+bool ProgramDb::resizeMap(size_t newSize)
 {
-    Transaction txn(*this, false);
-    MDB_val val;
+    // The threads' cached read transactions don't count as readers.
+    dropThreadReads();
 
-    try {
-        // Get the record.
-        if (!txn.getById(getDbHandle(dbg), id, &val))
-            return nullptr;
-        
-        // Convert the binary form into an object.
-        const fb::StoredObject *so = fb::GetStoredObject(val.mv_data);
-        return Storable::create(id, *so);
+    std::lock_guard<std::mutex> locker(readPoolMutex_);
+    if (activeReaders_ > 0)
+        return false;
+
+    int rc = mdb_env_set_mapsize(env_, newSize);
+    if (rc)
+        throw ProgramDbException(std::string("can't resize the program database: ") + mdb_strerror(rc), rc);
+
+    // Find out what size we ended up with.
+    MDB_envinfo info;
+    if (mdb_env_info(env_, &info) == 0)
+    {
+        mapSize_ = info.me_mapsize;
     }
-    catch (const ProgramDbException &e) {
-        throw ProgramDbException(std::string("can't get by id ") + std::to_string(id) + ", " + e.what());
+    else
+    {
+        mapSize_ = newSize;
     }
+
+    return true;
 }
 
 
 //
-// Store a SourceFile in the database.
+// Constructor for ReadTxn. Takes a read transaction from the pool.
 //
 
-void ProgramDb::put(Storable &source)
+ProgramDb::ReadTxn::ReadTxn(ProgramDb &pdb) :
+    pdb(pdb),
+    generation(pdb.writeGeneration()),
+    txn(pdb.acquireReadTxn())
 {
-    std::lock_guard<std::mutex> locker(writeMutex_);
-    
-    // Encode the Storable item's key and content.
-    MDB_val key;
-    keyBuilder_.Clear();
-    source.serialiseKey(keyBuilder_);
-    key.mv_data = keyBuilder_.GetBufferPointer();
-    key.mv_size = keyBuilder_.GetSize();
-
-    MDB_val val;
-    contentBuilder_.Clear();
-    source.serialiseContent(contentBuilder_);
-    val.mv_data = contentBuilder_.GetBufferPointer();
-    val.mv_size = contentBuilder_.GetSize();
-
-    MDB_dbi contentDbi = getDbHandle(source.contentDbGroup());
-    MDB_dbi keyDbi     = getDbHandle(source.keyDbGroup());
-    
-    // Do we already know the file id?
-    Transaction txn(*this, true);
-
-    uint32_t id = source.id();
-    if (id == 0)
-    {
-        // See if it already exists in the database.
-        id = txn.getIdByKey(keyDbi, key);
-    }
+}
 
-    // If this file has no file id, make one.
-    if (id == 0)
-    {
-        // Store the row under a new id.
-        id = txn.addRow(contentDbi, val);
 
-        // Add the name to id lookup.
-        source.setId(id);
-        txn.addKeyToIdMapping(keyDbi, key, id);
-    }
-    else
-    {
-        // Store an existing row.
-        txn.putRow(contentDbi, id, val);
-    }
+//
+// Destructor for ReadTxn. Returns the read transaction to the pool.
+//
 
-    // Commit the transaction.
-    txn.commit();
+ProgramDb::ReadTxn::~ReadTxn()
+{
+    pdb.releaseReadTxn(txn);
 }
 
 
 //
-// Convert a database group id to the handle for that database.
+// Constructor for ProgramDbSnapshot.
 //
 
-MDB_dbi ProgramDb::getDbHandle(Storable::DbGroup db) const
+ProgramDbSnapshot::ProgramDbSnapshot(const std::shared_ptr<ProgramDb> &pdb, const std::shared_ptr<ProgramDb::ReadTxn> &read) :
+    pdb_(pdb),
+    read_(read)
 {
-    switch (db)
-    {
-    case Storable::DbGroup::SourceFiles:    return sourceFilesDbi_;
-    case Storable::DbGroup::SourceFileKeys: return sourceFileKeysDbi_;
-    default:                                throw ProgramDbException("invalid db group");
-    }
+    txn_ = read_->txn;
 }
 
 
@@ -221,12 +1147,14 @@ MDB_dbi ProgramDb::getDbHandle(Storable::DbGroup db) const
 //
 
 ProgramDb::Transaction::Transaction(ProgramDb &pdb, bool writeable) :
+    pdb_(&pdb),
     txn_(nullptr),
+    writeable_(writeable),
     committed_(false)
 {
     int rc = mdb_txn_begin(pdb.getEnv(), nullptr, writeable ? 0 : MDB_RDONLY, &txn_);
     if (rc)
-        throw ProgramDbException(std::string("can't create transaction on program database: ") + mdb_strerror(rc));
+        throw ProgramDbException(std::string("can't create transaction on program database: ") + mdb_strerror(rc), rc);
 }
 
 
@@ -239,6 +1167,12 @@ ProgramDb::Transaction::~Transaction()
     if (!committed_)
     {
         mdb_txn_abort(txn_);
+
+        // Any ids allocated in this transaction went with it.
+        if (writeable_)
+        {
+            pdb_->forgetIdSequences();
+        }
     }
 }
 
@@ -249,14 +1183,160 @@ ProgramDb::Transaction::~Transaction()
 
 void ProgramDb::Transaction::commit()
 {
+    // mdb_txn_commit() frees the transaction even if it fails.
     int rc = mdb_txn_commit(txn_);
+    committed_ = true;
     if (rc)
     {
-        mdb_txn_abort(txn_);
-        throw ProgramDbException(std::string("can't commit to program database: ") + mdb_strerror(rc));
+        if (writeable_)
+        {
+            pdb_->forgetIdSequences();
+        }
+
+        throw ProgramDbException(std::string("can't commit to program database: ") + mdb_strerror(rc), rc);
     }
+}
 
-    committed_ = true;
+
+//
+// Constructor for a Batch. Takes the write lock. The first write
+// transaction is opened by the first put().
+//
+
+ProgramDb::Batch::Batch(ProgramDb &pdb, size_t commitInterval) :
+    pdb_(pdb),
+    locker_(pdb.writeMutex_),
+    commitInterval_(commitInterval)
+{
+}
+
+
+//
+// Destructor for a Batch. Anything which hasn't been committed is aborted
+// by the Transaction destructor.
+//
+
+ProgramDb::Batch::~Batch()
+{
+}
+
+
+//
+// Store an object as part of the batch. Commits the transaction and starts
+// a new one once commitInterval objects have been stored.
+//
+
+void ProgramDb::Batch::put(Storable &obj)
+{
+    uncommitted_.emplace_back(&obj, obj.id());
+
+    try {
+        if (!txn_)
+        {
+            txn_ = std::make_unique<Transaction>(pdb_, true);
+        }
+
+        pdb_.putInTxn(*txn_, obj);
+    }
+    catch (const ProgramDbException &e) {
+        // The transaction can't be used after an error.
+        txn_.reset();
+        if (!pdb_.recoverFromWriteError(e.rc()))
+        {
+            abandon();
+            throw;
+        }
+
+        // The map has grown so write everything again.
+        replay();
+    }
+
+    if (commitInterval_ > 0 && uncommitted_.size() >= commitInterval_)
+    {
+        commit();
+    }
+}
+
+
+//
+// Commit everything stored in the batch so far. The batch can continue
+// to be used after this.
+//
+
+void ProgramDb::Batch::commit()
+{
+    while (txn_)
+    {
+        // The transaction is finished with whether or not the commit works.
+        std::unique_ptr<Transaction> txn = std::move(txn_);
+
+        try {
+            pdb_.writeIdSequences(*txn);
+            txn->commit();
+        }
+        catch (const ProgramDbException &e) {
+            if (!pdb_.recoverFromWriteError(e.rc()))
+            {
+                abandon();
+                throw;
+            }
+
+            // The map has grown so write everything again and retry.
+            replay();
+            continue;
+        }
+
+        uncommitted_.clear();
+        pdb_.committed();
+    }
+}
+
+
+//
+// Write all the uncommitted objects again in a new transaction. Used
+// after the map has grown.
+//
+
+void ProgramDb::Batch::replay()
+{
+    for (;;)
+    {
+        try {
+            txn_ = std::make_unique<Transaction>(pdb_, true);
+            for (auto &item : uncommitted_)
+            {
+                // Any id it was given was lost with the transaction.
+                item.first->setId(item.second);
+                pdb_.putInTxn(*txn_, *item.first);
+            }
+
+            return;
+        }
+        catch (const ProgramDbException &e) {
+            txn_.reset();
+            if (!pdb_.recoverFromWriteError(e.rc()))
+            {
+                abandon();
+                throw;
+            }
+        }
+    }
+}
+
+
+//
+// Give up on the uncommitted objects after an unrecoverable error. Ids
+// they were given in the failed transaction are taken back.
+//
+
+void ProgramDb::Batch::abandon()
+{
+    for (auto &item : uncommitted_)
+    {
+        item.first->setId(item.second);
+    }
+
+    uncommitted_.clear();
 }
 
 
@@ -280,7 +1360,7 @@ bool ProgramDb::Transaction::getById(MDB_dbi dbi, uint32_t id, MDB_val *v)
         else
         {
             // Failed.
-            throw ProgramDbException(std::string("can't get by id ") + std::to_string(id) + ": " + mdb_strerror(rc));
+            throw ProgramDbException(std::string("can't get by id ") + std::to_string(id) + ": " + mdb_strerror(rc), rc);
         }
     }
 
@@ -306,50 +1386,102 @@ uint32_t ProgramDb::Transaction::getIdByKey(MDB_dbi dbi, const MDB_val &key)
         else
         {
             // Failed.
-            throw ProgramDbException(mdb_strerror(rc));
+            throw ProgramDbException(mdb_strerror(rc), rc);
         }
     }
     
     if (val.mv_size != sizeof(uint32_t))
         throw ProgramDbException("incorrect size object");
 
-    return *reinterpret_cast<uint32_t *>(&val.mv_data);
+    return *reinterpret_cast<const uint32_t *>(val.mv_data);
+}
+
+
+//
+// Store an item in the database with a new unique row id. Ids are
+// allocated in increasing order so the row always goes at the end.
+//
+
+void ProgramDb::Transaction::addRow(MDB_dbi dbi, uint32_t id, const MDB_val &val)
+{
+    MDB_val key;
+    key.mv_size = sizeof(id);
+    key.mv_data = reinterpret_cast<void *>(&id);
+
+    int rc = mdb_put(txn_, dbi, &key, const_cast<MDB_val *>(&val), MDB_APPEND);
+    if (rc)
+        throw ProgramDbException(std::string("can't add row ") + std::to_string(id) + ": " + mdb_strerror(rc), rc);
 }
 
 
 //
-// Store an item in the database with a new unique row id.
+// Get the next id to use in a table from its sequence record in the
+// global table. Databases written before sequences were kept don't have
+// one, so in that case it's worked out from the last row in the table.
 //
 
-uint32_t ProgramDb::Transaction::addRow(MDB_dbi dbi, const MDB_val &val)
+uint32_t ProgramDb::Transaction::getNextId(MDB_dbi globalDbi, MDB_dbi tableDbi, const std::string &seqKey)
 {
-    // Doesn't exist, get a new file id and add it.
+    MDB_val key;
+    key.mv_size = seqKey.size();
+    key.mv_data = const_cast<char *>(seqKey.data());
+
+    MDB_val val;
+    int rc = mdb_get(txn_, globalDbi, &key, &val);
+    if (rc == 0)
+    {
+        if (val.mv_size != sizeof(uint32_t))
+            throw ProgramDbException("incorrect size id sequence " + seqKey);
+
+        return *reinterpret_cast<const uint32_t *>(val.mv_data);
+    }
+    else if (rc != MDB_NOTFOUND)
+    {
+        throw ProgramDbException(std::string("can't get id sequence ") + seqKey + ": " + mdb_strerror(rc), rc);
+    }
+
+    // There's no sequence yet so look at the last entry in the table.
     MDB_cursor *cursor = nullptr;
-    int rc = mdb_cursor_open(txn_, dbi, &cursor);
+    rc = mdb_cursor_open(txn_, tableDbi, &cursor);
     if (rc)
-        throw ProgramDbException(std::string("can't create new id: ") + mdb_strerror(rc));
+        throw ProgramDbException(std::string("can't create new id: ") + mdb_strerror(rc), rc);
 
-    // Get the last entry in the SourceFiles db.
     MDB_val numKey;
     MDB_val numData;
     rc = mdb_cursor_get(cursor, &numKey, &numData, MDB_LAST);
-    if (rc)
-        throw ProgramDbException(std::string("can't get last id: ") + mdb_strerror(rc));
+    mdb_cursor_close(cursor);
+
+    if (rc == 0)
+    {
+        return *reinterpret_cast<const uint32_t *>(numKey.mv_data) + 1;
+    }
+    else if (rc != MDB_NOTFOUND)
+    {
+        throw ProgramDbException(std::string("can't get last id: ") + mdb_strerror(rc), rc);
+    }
+
+    // The table is empty. Id 0 means "no id" so start at 1.
+    return 1;
+}
+
 
-    // Increment the file id.
-    uint32_t *numDataIdPtr = reinterpret_cast<uint32_t *>(numKey.mv_data);
-    (*numDataIdPtr)++;
-    uint32_t id = *numDataIdPtr;
+//
+// Write the next id to use in a table to its sequence record.
+//
 
-    // Write the SourceFile data.
+void ProgramDb::Transaction::putNextId(MDB_dbi globalDbi, const std::string &seqKey, uint32_t nextId)
+{
     MDB_val key;
-    key.mv_size = sizeof(id);
-    key.mv_data = reinterpret_cast<void *>(id);
-    rc = mdb_put(txn_, dbi, &key, const_cast<MDB_val *>(&val), 0);
+    key.mv_size = seqKey.size();
+    key.mv_data = const_cast<char *>(seqKey.data());
+
+    MDB_val val;
+    val.mv_size = sizeof(nextId);
+    val.mv_data = reinterpret_cast<void *>(&nextId);
+
+    int rc = mdb_put(txn_, globalDbi, &key, &val, 0);
     if (rc)
-        throw ProgramDbException(std::string("can't add row ") + std::to_string(id) + ": " + mdb_strerror(rc));
-    
-    return id;
+        throw ProgramDbException(std::string("can't put id sequence ") + seqKey + ": " + mdb_strerror(rc), rc);
 }
 
 
@@ -361,11 +1493,11 @@ void ProgramDb::Transaction::putRow(MDB_dbi dbi, uint32_t id, const MDB_val &val
 {
     MDB_val key;
     key.mv_size = sizeof(id);
-    key.mv_data = reinterpret_cast<void *>(id);
+    key.mv_data = reinterpret_cast<void *>(&id);
 
     int rc = mdb_put(txn_, dbi, &key, const_cast<MDB_val *>(&val), 0);
     if (rc)
-        throw ProgramDbException(std::string("can't put row ") + std::to_string(id) + ": " + mdb_strerror(rc));
+        throw ProgramDbException(std::string("can't put row ") + std::to_string(id) + ": " + mdb_strerror(rc), rc);
 }
 
 
@@ -378,11 +1510,136 @@ void ProgramDb::Transaction::addKeyToIdMapping(MDB_dbi dbi, const MDB_val &key,
 {
     MDB_val val;
     val.mv_size = sizeof(id);
-    val.mv_data = reinterpret_cast<void *>(id);
+    val.mv_data = reinterpret_cast<void *>(&id);
 
     int rc = mdb_put(txn_, dbi, const_cast<MDB_val *>(&key), &val, 0);
     if (rc)
-        throw ProgramDbException(std::string("can't put mapping ") + std::to_string(id) + ": " + mdb_strerror(rc));
+        throw ProgramDbException(std::string("can't put mapping ") + std::to_string(id) + ": " + mdb_strerror(rc), rc);
+}
+
+
+//
+// Get a blob of content given its digest. Returns false if it's not stored.
+//
+
+bool ProgramDb::Transaction::getBlob(MDB_dbi blobsDbi, const ContentDigest &digest, MDB_val *val)
+{
+    MDB_val key;
+    key.mv_size = sizeof(digest);
+    key.mv_data = const_cast<ContentDigest *>(&digest);
+
+    int rc = mdb_get(txn_, blobsDbi, &key, val);
+    if (rc == MDB_NOTFOUND)
+        return false;
+    else if (rc)
+        throw ProgramDbException(std::string("can't get blob: ") + mdb_strerror(rc), rc);
+
+    return true;
+}
+
+
+//
+// Make sure the blob stored under a digest really is the same as one
+// with the same digest which is about to share it. Different text which
+// happens to have the same digest can't be stored.
+//
+
+void ProgramDb::Transaction::checkBlob(MDB_dbi blobsDbi, const ContentDigest &digest, std::string_view blob)
+{
+    MDB_val val;
+    if (!getBlob(blobsDbi, digest, &val))
+        throw ProgramDbException("a shared blob is missing");
+
+    if (std::string_view(static_cast<const char *>(val.mv_data), val.mv_size) != blob)
+        throw ProgramDbException("different text is stored with the same digest");
+}
+
+
+//
+// Add a reference to a blob, storing the blob if this is the first one.
+//
+
+void ProgramDb::Transaction::addBlobRef(MDB_dbi blobsDbi, MDB_dbi refsDbi, const ContentDigest &digest, std::string_view blob)
+{
+    MDB_val key;
+    key.mv_size = sizeof(digest);
+    key.mv_data = const_cast<ContentDigest *>(&digest);
+
+    // How many references does it have already?
+    uint32_t refs = 0;
+    MDB_val val;
+    int rc = mdb_get(txn_, refsDbi, &key, &val);
+    if (rc == 0)
+    {
+        memcpy(&refs, val.mv_data, sizeof(refs));
+    }
+    else if (rc != MDB_NOTFOUND)
+    {
+        throw ProgramDbException(std::string("can't get blob references: ") + mdb_strerror(rc), rc);
+    }
+
+    // Store the blob itself if it's new, otherwise share it if it's the same.
+    if (refs > 0)
+    {
+        checkBlob(blobsDbi, digest, blob);
+    }
+    else
+    {
+        MDB_val blobVal;
+        blobVal.mv_size = blob.size();
+        blobVal.mv_data = const_cast<char *>(blob.data());
+        rc = mdb_put(txn_, blobsDbi, &key, &blobVal, 0);
+        if (rc)
+            throw ProgramDbException(std::string("can't put blob: ") + mdb_strerror(rc), rc);
+    }
+
+    refs++;
+    val.mv_size = sizeof(refs);
+    val.mv_data = &refs;
+    rc = mdb_put(txn_, refsDbi, &key, &val, 0);
+    if (rc)
+        throw ProgramDbException(std::string("can't put blob references: ") + mdb_strerror(rc), rc);
+}
+
+
+//
+// Remove a reference to a blob, deleting the blob if nothing else uses it.
+//
+
+void ProgramDb::Transaction::releaseBlobRef(MDB_dbi blobsDbi, MDB_dbi refsDbi, const ContentDigest &digest)
+{
+    MDB_val key;
+    key.mv_size = sizeof(digest);
+    key.mv_data = const_cast<ContentDigest *>(&digest);
+
+    MDB_val val;
+    int rc = mdb_get(txn_, refsDbi, &key, &val);
+    if (rc == MDB_NOTFOUND)
+        return;
+    else if (rc)
+        throw ProgramDbException(std::string("can't get blob references: ") + mdb_strerror(rc), rc);
+
+    uint32_t refs;
+    memcpy(&refs, val.mv_data, sizeof(refs));
+    if (refs > 1)
+    {
+        refs--;
+        val.mv_size = sizeof(refs);
+        val.mv_data = &refs;
+        rc = mdb_put(txn_, refsDbi, &key, &val, 0);
+    }
+    else
+    {
+        // That was the last one.
+        rc = mdb_del(txn_, refsDbi, &key, nullptr);
+        if (rc == 0)
+        {
+            rc = mdb_del(txn_, blobsDbi, &key, nullptr);
+        }
+    }
+
+    if (rc && rc != MDB_NOTFOUND)
+        throw ProgramDbException(std::string("can't release blob: ") + mdb_strerror(rc), rc);
 }
 
 
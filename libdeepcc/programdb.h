@@ -16,6 +16,9 @@
 #include <vector>
 #include <string>
 #include <memory>
+#include <mutex>
+#include <atomic>
+#include <thread>
 #include <lmdb.h>
 
 #include "sourcefile.h"
@@ -27,6 +30,15 @@ namespace deepC
 {
 
 
+// Forward declarations.
+class ProgramDbSnapshot;
+class Interner;
+class SourceTokens;
+class IncludeInfo;
+class IncludeResolution;
+class HeaderMacroContexts;
+
+
 //
 // A program database. This stores intermediate information about a program
 // which is used to quickly resume compilation on subsequent executions.
@@ -35,12 +47,17 @@ namespace deepC
 //
 //  * a list of source files.
 //  * the contents of the source files.
+//  * the text of every interned identifier, so identifier ids are stable.
 //  * the tokenised contents of each of the source files.
+//  * what each source file includes and how it's guarded, see IncludeInfo.
+//  * where each #include was found, or that it wasn't, see IncludeResolution.
+//  * what preprocessing each header did in the contexts it was included in,
+//    see MacroContext.
 //  * an index of the top level declarations in each source file.
 //  * a parse tree for each of the top level declarations.
 //  * a compiled object for each of the top level declarations.
 
-class ProgramDb
+class ProgramDb : public std::enable_shared_from_this<ProgramDb>
 {
 public:
     // Results from "get" calls.
@@ -51,6 +68,37 @@ public:
         ERROR
     };
 
+    // How many objects a Batch stores between commits by default.
+    static constexpr size_t defaultCommitInterval = 1000;
+
+    // The initial size of the memory map unless told otherwise. The map is
+    // only address space until it's written to, so 64-bit systems reserve
+    // enough that it should never need to grow. If it does fill up it
+    // doubles in size, but only while nothing is reading from it.
+    static constexpr size_t defaultMapSize = sizeof(size_t) >= 8 ?
+        static_cast<size_t>(64) * 1024 * 1024 * 1024 : /* 64 GiB */
+        static_cast<size_t>(1) * 1024 * 1024 * 1024;   /* 1 GiB */
+
+    // Statistics about what's in the database.
+    struct Stats
+    {
+        uint64_t sourceFiles;   // Source file records.
+        uint64_t blobs;         // Distinct source texts actually stored.
+        uint64_t logicalBytes;  // Total size of the source text of all the source files.
+        uint64_t storedBytes;   // Total size of the distinct source texts.
+        uint64_t identifiers;   // Interned identifiers.
+
+        double   dedupRatio() const { return storedBytes > 0 ? static_cast<double>(logicalBytes) / storedBytes : 1.0; }
+    };
+
+    // Counters showing how well read transactions are being reused.
+    struct ReadStats
+    {
+        uint64_t threadHits;    // Lookups which reused their thread's current read transaction.
+        uint64_t renewed;       // New read transactions which renewed a pooled one.
+        uint64_t created;       // New read transactions which had to begin one.
+    };
+
 
     //
     // An RAII wrapper for database transactions.
@@ -59,8 +107,13 @@ public:
     class Transaction
     {
     protected:
-        MDB_txn *txn_;
-        bool     committed_;
+        ProgramDb *pdb_;
+        MDB_txn   *txn_;
+        bool       writeable_;
+        bool       committed_;
+
+        // For subclasses which manage the transaction handle themselves.
+        explicit Transaction() : pdb_(nullptr), txn_(nullptr), writeable_(false), committed_(true) {}
 
     public:
         explicit Transaction(ProgramDb &pdb, bool writeable);
@@ -72,9 +125,59 @@ public:
 
         bool     getById(MDB_dbi dbi, uint32_t id, MDB_val *val);
         uint32_t getIdByKey(MDB_dbi dbi, const MDB_val &key);
-        uint32_t addRow(MDB_dbi dbi, const MDB_val &val);
+        void     addRow(MDB_dbi dbi, uint32_t id, const MDB_val &val);
+        uint32_t getNextId(MDB_dbi globalDbi, MDB_dbi tableDbi, const std::string &seqKey);
+        void     putNextId(MDB_dbi globalDbi, const std::string &seqKey, uint32_t nextId);
         void     putRow(MDB_dbi dbi, uint32_t id, const MDB_val &val);
         void     addKeyToIdMapping(MDB_dbi dbi, const MDB_val &key, uint32_t id);
+        bool     getBlob(MDB_dbi blobsDbi, const ContentDigest &digest, MDB_val *val);
+        void     checkBlob(MDB_dbi blobsDbi, const ContentDigest &digest, std::string_view blob);
+        void     addBlobRef(MDB_dbi blobsDbi, MDB_dbi refsDbi, const ContentDigest &digest, std::string_view blob);
+        void     releaseBlobRef(MDB_dbi blobsDbi, MDB_dbi refsDbi, const ContentDigest &digest);
+    };
+
+
+    //
+    // A batch of writes which share write transactions. Each put() in a
+    // batch is written into the same transaction and the transaction is
+    // only committed every commitInterval objects, so a bulk import pays
+    // for one commit (and one fsync) per interval rather than one per
+    // object. A commitInterval of 0 means everything is committed at once
+    // when commit() is called.
+    //
+    // The batch holds the write lock for its whole lifetime. Anything put
+    // since the last commit is discarded if the batch is destroyed without
+    // calling commit().
+    //
+    // If the memory map fills up the uncommitted objects are written again
+    // after it has grown, so objects passed to put() must stay valid until
+    // the next commit.
+    //
+
+    class Batch
+    {
+    private:
+        ProgramDb                   &pdb_;
+        std::unique_lock<std::mutex> locker_;
+        std::unique_ptr<Transaction> txn_;
+        size_t                       commitInterval_;
+
+        // Objects written since the last commit and the ids they had before.
+        std::vector<std::pair<Storable *, Storable::Id>> uncommitted_;
+
+        void   replay();
+        void   abandon();
+
+    public:
+        explicit Batch(ProgramDb &pdb, size_t commitInterval = defaultCommitInterval);
+        ~Batch();
+
+        size_t commitInterval() const                  { return commitInterval_; }
+        void   setCommitInterval(size_t commitInterval) { commitInterval_ = commitInterval; }
+        size_t uncommitted() const                     { return uncommitted_.size(); }
+
+        void   put(Storable &obj);
+        void   commit();
     };
 
 
@@ -84,34 +187,173 @@ private:
     bool     isOpen_;
 
     // The sub-databases we plan to use.
+    MDB_dbi  globalDbi_;
     MDB_dbi  sourceFilesDbi_;
     MDB_dbi  sourceFileKeysDbi_;
+    MDB_dbi  sourceBlobsDbi_;
+    MDB_dbi  sourceBlobRefsDbi_;
+    MDB_dbi  sourceTokensDbi_;
+    MDB_dbi  sourceTokenKeysDbi_;
+    MDB_dbi  includeInfosDbi_;
+    MDB_dbi  includeInfoKeysDbi_;
+    MDB_dbi  includeResolutionsDbi_;
+    MDB_dbi  includeResolutionKeysDbi_;
+    MDB_dbi  macroContextsDbi_;
+    MDB_dbi  macroContextKeysDbi_;
+    MDB_dbi  identifiersDbi_;
 
     // Write lock.
     std::mutex writeMutex_;
     flatbuffers::FlatBufferBuilder keyBuilder_;
     flatbuffers::FlatBufferBuilder contentBuilder_;
 
+    // The next id to allocate in each table. These are loaded from the
+    // global table the first time a write transaction needs them, then
+    // only kept in memory until it's committed or aborted. Protected by
+    // writeMutex_.
+    struct IdSequence
+    {
+        uint32_t nextId;
+        bool     dirty;     // Needs to be written to the global table.
+    };
+
+    std::map<Storable::DbGroup, IdSequence> idSequences_;
+
+    // Counts committed writes so snapshots know when they're out of date.
+    std::atomic<uint64_t> writeGeneration_;
+
+    // A read transaction shared by all the snapshots a thread takes
+    // between writes. It goes back to the pool when the last one is done.
+    struct ReadTxn
+    {
+        ProgramDb &pdb;
+        uint64_t   generation;  // writeGeneration_ when it began.
+        MDB_txn   *txn;
+
+        explicit ReadTxn(ProgramDb &pdb);
+        ~ReadTxn();
+    };
+
+    // Each thread's current read transaction. Entries are dropped when a
+    // write commits so old readers don't hold on to stale pages.
+    std::mutex                                          threadReadsMutex_;
+    std::map<std::thread::id, std::shared_ptr<ReadTxn>> threadReads_;
+
+    // Read transactions which have been reset and are waiting to be renewed.
+    std::mutex                       readPoolMutex_;
+    std::vector<MDB_txn *>           readPool_;
+
+    // The map can only be resized when no read transactions are active.
+    size_t                           mapSize_;
+    size_t                           activeReaders_;
+
+    // Read transaction reuse counters.
+    std::atomic<uint64_t>            threadHits_;
+    std::atomic<uint64_t>            renewed_;
+    std::atomic<uint64_t>            created_;
+
 protected:
-    // Generate a new id in sourceFiles.
-    uint32_t createSourceFilesId(Transaction &txn);
+    // Allocate a new id in a table. The caller must hold writeMutex_.
+    static std::string idSequenceKey(Storable::DbGroup dbg);
+    uint32_t allocateId(Transaction &txn, Storable::DbGroup dbg);
+    void     writeIdSequences(Transaction &txn);
+    void     forgetIdSequences();
     uint32_t getIdByKey(Transaction &txn, MDB_dbi dbi, const Storable &source);
     MDB_dbi  getDbHandle(Storable::DbGroup db) const;
 
+    // Store an object using an existing write transaction. The caller
+    // must hold writeMutex_.
+    void     putInTxn(Transaction &txn, Storable &source);
+
+    // Get a read transaction from the pool and hand it back afterwards.
+    MDB_txn *acquireReadTxn();
+    void     releaseReadTxn(MDB_txn *txn);
+
+    // Note that a write has been committed.
+    void     committed();
+    void     dropThreadReads();
+
+    // Deal with a failed write. Grows the map and returns true if the
+    // write should be retried. The caller must hold writeMutex_ and have
+    // no write transaction open.
+    bool     recoverFromWriteError(int rc);
+    bool     resizeMap(size_t newSize);
+
+    friend class ProgramDbSnapshot;
+
+private:
+    // Use create() instead, so snapshots can keep the database open.
+    ProgramDb(const std::string &filename, size_t initialMapSize);
+
 public:
-    // Constructor for the source bag.
-    ProgramDb(const std::string &filename);
+    // Open a program database. It's always owned by a shared_ptr, which
+    // every snapshot holds a copy of, so anything read from it can outlive
+    // the caller's reference.
+    static std::shared_ptr<ProgramDb> create(const std::string &filename, size_t initialMapSize = defaultMapSize);
     ~ProgramDb();
 
     bool     isOpen() const { return isOpen_; }
     MDB_env *getEnv()       { return env_; }
+    size_t   mapSize() const { return mapSize_; }
+    uint64_t writeGeneration() const { return writeGeneration_; }
+
+    // Get a read-only snapshot of the database. Each thread keeps using
+    // the same read transaction until something new is written.
+    std::shared_ptr<ProgramDbSnapshot> snapshot();
+    ReadStats readStats() const;
+
+    // Statistics about what's stored.
+    Stats stats();
+
+    // Load the interned identifiers which aren't in an interner yet, and
+    // save the ones which aren't in the database yet. Nothing else may be
+    // interning while they're saved.
+    void loadIdentifiers(Interner &interner);
+    void saveIdentifiers(Interner &interner);
 
-    // Source file access.
-    
     // Get/put Storable items.
     uint32_t getId(const Storable &obj);
+    std::shared_ptr<SourceFile> getSourceFile(const std::string &fileName);
+    std::shared_ptr<SourceTokens> getSourceTokens(uint32_t sourceFileId);
+    std::shared_ptr<IncludeInfo> getIncludeInfo(uint32_t sourceFileId);
+    std::shared_ptr<IncludeResolution> getIncludeResolution(const std::string &key);
+    std::shared_ptr<HeaderMacroContexts> getHeaderMacroContexts(uint32_t sourceFileId);
     std::shared_ptr<Storable> get(Storable::DbGroup dbg, uint32_t id);
+    std::shared_ptr<Storable> get(const std::shared_ptr<ProgramDbSnapshot> &snap, Storable::DbGroup dbg, uint32_t id);
     void put(Storable &source);
+
+    // Set aside some ids in a table for objects which need one before
+    // they're stored. Gives the first of count consecutive ids.
+    uint32_t reserveIds(Storable::DbGroup dbg, uint32_t count);
+};
+
+
+//
+// A read-only snapshot of the program database. Objects read through a
+// snapshot can refer directly to data in LMDB's memory map without
+// copying it, so they hold a shared_ptr to the snapshot to keep it open.
+//
+// Snapshots taken on the same thread share a read transaction until
+// something is written. The transaction handle is reset and returned to
+// the ProgramDb's pool when the last snapshot using it goes away, and is
+// renewed rather than created again the next time one is needed. The
+// snapshot also keeps the ProgramDb open.
+//
+
+class ProgramDbSnapshot : public ProgramDb::Transaction
+{
+private:
+    std::shared_ptr<ProgramDb>          pdb_;
+    std::shared_ptr<ProgramDb::ReadTxn> read_;
+
+public:
+    ProgramDbSnapshot(const std::shared_ptr<ProgramDb> &pdb, const std::shared_ptr<ProgramDb::ReadTxn> &read);
+
+    ProgramDbSnapshot(const ProgramDbSnapshot &) = delete;
+    ProgramDbSnapshot &operator=(const ProgramDbSnapshot &) = delete;
+
+    // Whether nothing has been written since the snapshot was taken.
+    bool isCurrent() const { return read_->generation == pdb_->writeGeneration(); }
 };
 
 
@@ -122,9 +364,12 @@ public:
 class ProgramDbException : public std::exception
 {
     std::string message_;
+    int         rc_;        // The LMDB error code if there was one.
 
 public:
-    ProgramDbException(const std::string &message) : message_(message) {}
+    ProgramDbException(const std::string &message, int rc = 0) : message_(message), rc_(rc) {}
+
+    int rc() const { return rc_; }
 
     const char * what () const throw ()
     {
@@ -8,6 +8,7 @@
 #include <sys/stat.h>
 #include <sys/mman.h>
 #include <cstring>
+#include <algorithm>
 #include <string_view>
 
 #include "sourcefile.h"
@@ -27,10 +28,12 @@ namespace deepC
 void SourceFile::serialiseContent(flatbuffers::FlatBufferBuilder &builder) const
 {
     // Encode the SourceFile data.
+    // The text itself is stored separately and referred to by its digest.
     auto filenameStr = builder.CreateString(fileName_);
-    auto sourceStr = builder.CreateString(std::string(sourceText_));
-    auto srcFile = fb::CreateSourceFile(builder, filenameStr, sourceStr, modified_.time_since_epoch().count());
-    fb::CreateStoredObject(builder, fb::StoredAny_SourceFile, srcFile.Union());
+    fb::Digest digest(this->digest().hash, this->digest().size);
+    auto lineStarts = builder.CreateVector(lineIndex().table(), lineIndex().tableSize());
+    auto srcFile = fb::CreateSourceFile(builder, filenameStr, 0, modified_.time_since_epoch().count(), &digest, lineStarts);
+    fb::FinishStoredObjectBuffer(builder, fb::CreateStoredObject(builder, fb::StoredAny_SourceFile, srcFile.Union()));
 }
 
 
@@ -39,11 +42,21 @@ void SourceFile::serialiseContent(flatbuffers::FlatBufferBuilder &builder) const
 //
 
 void SourceFile::serialiseKey(flatbuffers::FlatBufferBuilder &builder) const
+{
+    serialiseKey(builder, fileName_);
+}
+
+
+//
+// Serialise the key for a given file name.
+//
+
+void SourceFile::serialiseKey(flatbuffers::FlatBufferBuilder &builder, const std::string &fileName)
 {
     // Encode just the key.
-    auto keyStr = builder.CreateString(fileName_);
+    auto keyStr = builder.CreateString(fileName);
     auto srcKey = fb::CreateStringKey(builder, keyStr);
-    fb::CreateStoredObject(builder, fb::StoredAny_StringKey, srcKey.Union());
+    fb::FinishStoredObjectBuffer(builder, fb::CreateStoredObject(builder, fb::StoredAny_StringKey, srcKey.Union()));
 }
 
 
@@ -56,48 +69,104 @@ void SourceFile::unserialise(const fb::StoredObject &so)
     const fb::SourceFile *sf = so.obj_as_SourceFile();
     fileName_ = sf->filename()->str();
     modified_ = TimePoint(Duration(sf->modified()));
-    sourceText_ = std::string_view(sf->source()->data(), sf->source()->size());
+
+    if (sf->digest())
+    {
+        // The text is filled in from the blob table with setBlob().
+        digest_ = ContentDigest(sf->digest()->hash(), sf->digest()->size());
+        haveDigest_ = true;
+    }
+    else if (sf->source())
+    {
+        // Older records have the text inline.
+        sourceText_ = std::string_view(sf->source()->data(), sf->source()->size());
+        haveDigest_ = false;
+    }
+
+    if (sf->line_starts())
+    {
+        lineIndex_.assign(sf->line_starts()->Data(), sf->line_starts()->size());
+        haveLineIndex_ = true;
+    }
+    else
+    {
+        haveLineIndex_ = false;
+    }
 }
 
 
 //
-// Split the file into lines.
+// Get the digest of the source text, working it out if necessary.
 //
 
-const std::vector<std::string_view> &SourceFile::makeLines()
+const ContentDigest &SourceFile::digest() const
 {
-    std::string_view::size_type nextPos = 0;
-    lines_.clear();
+    if (!haveDigest_)
+    {
+        digest_ = ContentDigest(sourceText_);
+        haveDigest_ = true;
+    }
+
+    return digest_;
+}
 
-    for (std::string_view::size_type pos = 0; pos != std::string_view::npos; pos = nextPos)
+
+//
+// Get the line index, building it if necessary.
+//
+
+const LineIndex &SourceFile::lineIndex() const
+{
+    if (!haveLineIndex_)
     {
-        nextPos = sourceText_.find("\n", pos);
-        if (nextPos != std::string_view::npos)
-        {
-            // Add a line before the end of the file.
-            lines_.push_back(std::string_view(&sourceText_[pos], nextPos - pos));
-        }
-        else
-        {
-            // Add a line which isn't EOL terminated.
-            if (sourceText_.size() > pos)
-            {
-                lines_.push_back(std::string_view(&sourceText_[pos], sourceText_.size() - pos));
-            }
-        }
+        if (sourceText_.size() > LineIndex::maxTextSize)
+            throw SourceFileException(std::string("source file ") + fileName_ + " is too big");
+
+        lineIndex_.build(sourceText_);
+        haveLineIndex_ = true;
     }
 
-    return lines_;
+    return lineIndex_;
+}
+
+
+//
+// Convert a file modification time to a time_point.
+//
+
+static TimePoint fileTime(const struct stat &fileInfo)
+{
+    int64_t nanos = static_cast<int64_t>(fileInfo.st_mtim.tv_sec) * 1000000000 + fileInfo.st_mtim.tv_nsec;
+    return TimePoint(std::chrono::duration_cast<Duration>(std::chrono::nanoseconds(nanos)));
+}
+
+
+//
+// Get a file's modification time and size with a stat() so we can tell if
+// it's changed since it was stored without reading it.
+//
+
+void SourceFileOnFilesystem::getFileInfo(const std::string &fileName, TimePoint *modified, uint64_t *size)
+{
+    struct stat fileInfo;
+    if (stat(fileName.c_str(), &fileInfo))
+        throw SourceFileException(std::string("can't stat() source file ") + fileName + ": " + strerror(errno));
+
+    *modified = fileTime(fileInfo);
+    *size = fileInfo.st_size;
 }
 
 
 //
 // Constructor for SourceFileOnFilesystem: read a file, get the modification time and contents.
 //
+// Small files are read with a single pread() into the arena. Anything
+// else is memory mapped without populating it, so pages are only read
+// from disk as they're used.
+//
 
-SourceFileOnFilesystem::SourceFileOnFilesystem(const std::string &fileName) :
+SourceFileOnFilesystem::SourceFileOnFilesystem(const std::string &fileName, Arena *arena) :
     SourceFile(fileName),
-    fd_(-1),
     mapData_(nullptr),
     mapSize_(0)
 {
@@ -109,20 +178,93 @@ SourceFileOnFilesystem::SourceFileOnFilesystem(const std::string &fileName) :
     // Get the file modification time.
     struct stat fileInfo;
     if (fstat(fd, &fileInfo))
-        throw SourceFileException(std::string("can't stat() source file ") + fileName + ": " + strerror(errno));
+    {
+        int err = errno;
+        ::close(fd);
+        throw SourceFileException(std::string("can't stat() source file ") + fileName + ": " + strerror(err));
+    }
 
     // Convert to a time_point.
-    int64_t nanos = static_cast<int64_t>(fileInfo.st_mtim.tv_sec) * 1000000000 + fileInfo.st_mtim.tv_nsec;
-    modified_ = TimePoint(std::chrono::duration_cast<Duration>(std::chrono::nanoseconds(nanos)));
+    modified_ = fileTime(fileInfo);
+
+    size_t size = fileInfo.st_size;
+    if (size == 0)
+    {
+        // Nothing to read, and mmap() won't map an empty file.
+    }
+    else if (arena && size <= smallFileSize)
+    {
+        // Read it in one go.
+        char *text = static_cast<char *>(arena->allocate(size, 1));
+        size_t got = 0;
+        while (got < size)
+        {
+            ssize_t n = pread(fd, text + got, size - got, got);
+            if (n < 0 && errno == EINTR)
+                continue;
+
+            if (n <= 0)
+            {
+                int err = n < 0 ? errno : EIO;
+                ::close(fd);
+                throw SourceFileException(std::string("can't read source file ") + fileName + ": " + strerror(err));
+            }
+
+            got += n;
+        }
+
+        sourceText_ = std::string_view(text, size);
+    }
+    else
+    {
+        // Memory map the file.
+        void *mapData = mmap(NULL, size, PROT_READ, MAP_PRIVATE, fd, 0);
+        if (mapData == MAP_FAILED)
+        {
+            int err = errno;
+            ::close(fd);
+            throw SourceFileException(std::string("can't mmap() source file ") + fileName + ": " + strerror(err));
+        }
+
+        mapData_ = mapData;
+        mapSize_ = size;
+        sourceText_ = std::string_view(reinterpret_cast<char *>(mapData_), mapSize_);
+    }
+
+    // The mapping stays valid after the file is closed.
+    ::close(fd);
+}
+
 
-    // Memory map the file.
-    mapSize_ = fileInfo.st_size;
-    mapData_ = mmap(NULL, mapSize_, PROT_READ, MAP_PRIVATE | MAP_POPULATE, fd, 0);
-    if (mapData_ == MAP_FAILED)
-        throw SourceFileException(std::string("can't mmap() source file ") + fileName + ": " + strerror(errno));
+//
+// Tell the kernel the text will be read from start to end, so it can
+// read ahead aggressively and drop pages behind us.
+//
 
-    // Create the string_view.
-    sourceText_ = std::string_view(reinterpret_cast<char *>(mapData_), mapSize_);
+void SourceFileOnFilesystem::adviseSequential()
+{
+    if (mapData_)
+    {
+        madvise(mapData_, mapSize_, MADV_SEQUENTIAL);
+    }
+}
+
+
+//
+// Tell the kernel a range of the text will be needed soon so it can start
+// reading it in.
+//
+
+void SourceFileOnFilesystem::willNeed(size_t offset, size_t length)
+{
+    if (!mapData_ || offset >= mapSize_)
+        return;
+
+    // madvise() needs a page aligned start.
+    static const size_t pageSize = sysconf(_SC_PAGESIZE);
+    size_t start = offset & ~(pageSize - 1);
+    size_t end = std::min(offset + length, mapSize_);
+    madvise(static_cast<char *>(mapData_) + start, end - start, MADV_WILLNEED);
 }
 
 
@@ -136,11 +278,6 @@ SourceFileOnFilesystem::~SourceFileOnFilesystem()
     {
         munmap(mapData_, mapSize_);
     }
-    
-    if (fd_ >= 0)
-    {
-        ::close(fd_);
-    }
 }
 
 
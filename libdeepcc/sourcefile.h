@@ -11,6 +11,8 @@
 
 #include "storable.h"
 #include "deeptypes.h"
+#include "arena.h"
+#include "lineindex.h"
 
 
 namespace deepC
@@ -31,32 +33,39 @@ protected:
     std::string      fileName_;      // Path to source file.
     TimePoint        modified_;      // When it was last modified.
     std::string_view sourceText_;    // The full source text.
+    mutable ContentDigest digest_;   // Identifies the source text.
+    mutable bool     haveDigest_;    // Whether digest_ has been worked out yet.
 
-    std::vector<std::string_view> lines_; // The source file split into lines.
-    bool             haveLines_;     // Whether we've lazily created lines_ yet.
+    mutable LineIndex lineIndex_;    // Where each line starts.
+    mutable bool     haveLineIndex_; // Whether lineIndex_ has been built or loaded yet.
 
 protected:
     // Constructors.
-    explicit SourceFile(uint32_t id) : Storable(id), haveLines_(false) {}
-    explicit SourceFile(const std::string &fileName) : fileName_(fileName), haveLines_(false) {}
-    explicit SourceFile(const std::string &fileName, const TimePoint &modified) : fileName_(fileName), modified_(modified), haveLines_(false) {}
+    explicit SourceFile(uint32_t id) : Storable(id), haveDigest_(false), haveLineIndex_(false) {}
+    explicit SourceFile(const std::string &fileName) : fileName_(fileName), haveDigest_(false), haveLineIndex_(false) {}
+    explicit SourceFile(const std::string &fileName, const TimePoint &modified) : fileName_(fileName), modified_(modified), haveDigest_(false), haveLineIndex_(false) {}
     virtual ~SourceFile() {}
-
-    // Split the file into lines.
-    const std::vector<std::string_view> &makeLines();
     
 public:
     // Accessors.
     const std::string      &fileName()   const { return fileName_; }
     const TimePoint        &modified()   const { return modified_; }
     const std::string_view &sourceText() const { return sourceText_; }
+    uint64_t                size()       const { return haveDigest_ ? digest_.size : sourceText_.size(); }
 
     void setFileName(const std::string &fileName) { fileName_ = fileName; }
     void setModified(const TimePoint &modified)   { modified_ = modified; }
-    void setSourceText(std::string_view &source)  { sourceText_ = source; }
+    void setSourceText(std::string_view &source)  { sourceText_ = source; haveDigest_ = false; haveLineIndex_ = false; }
+
+    // The digest of the source text. Files with the same digest have the
+    // same contents.
+    const ContentDigest &digest() const;
 
-    // Split the file into lines.
-    const std::vector<std::string_view> &getLines() { if (haveLines_) return lines_; else return makeLines(); }
+    // The file split into lines. The index is stored in the program
+    // database so files read from there don't need to be scanned again.
+    const LineIndex &lineIndex() const;
+    size_t           lineCount() const       { return lineIndex().lineCount(); }
+    std::string_view line(size_t line) const { return lineIndex().line(sourceText_, line); }
 
     // Which databases to use for the content and the key mapping.
     DbGroup contentDbGroup() const override { return Storable::DbGroup::SourceFiles; }
@@ -66,6 +75,14 @@ public:
     void serialiseContent(flatbuffers::FlatBufferBuilder &builder) const override;
     void serialiseKey(flatbuffers::FlatBufferBuilder &builder) const override;
     void unserialise(const fb::StoredObject &so) override;
+
+    // Serialise the key for a file name, to look it up without an object.
+    static void serialiseKey(flatbuffers::FlatBufferBuilder &builder, const std::string &fileName);
+
+    // The source text is stored separately so it can be shared.
+    bool             blobDigest(ContentDigest *digest) const override { *digest = this->digest(); return true; }
+    std::string_view blob() const override                            { return sourceText_; }
+    void             setBlob(std::string_view blob) override          { sourceText_ = blob; }
 };
 
 
@@ -78,16 +95,33 @@ public:
 
 class SourceFileOnFilesystem : public SourceFile
 {
+public:
+    // Files up to this size are read into an arena, if one is given,
+    // rather than being memory mapped. Setting up a mapping costs more
+    // than just reading a small file.
+    static constexpr size_t smallFileSize = 16 * 1024;
+
 private:
     // Members.
-    int      fd_;               // The file descriptor of the mmap()ed file.
     void    *mapData_;          // The memory mapped data.
     size_t   mapSize_;          // The size of the memory mapped area.
 
 public:
-    // Constructors.
-    explicit SourceFileOnFilesystem(const std::string &fileName);
+    // Constructors. Large files are mapped lazily so pages are only read
+    // when they're used - see adviseSequential() and willNeed().
+    explicit SourceFileOnFilesystem(const std::string &fileName, Arena *arena = nullptr);
     virtual ~SourceFileOnFilesystem();
+
+    // Whether the text is memory mapped rather than read into memory.
+    bool isMapped() const { return mapData_ != nullptr; }
+
+    // Hints from whatever's consuming the text about how it'll be read.
+    // These only make a difference for mapped files.
+    void adviseSequential();
+    void willNeed(size_t offset, size_t length);
+
+    // Get a file's modification time and size without reading it.
+    static void getFileInfo(const std::string &fileName, TimePoint *modified, uint64_t *size);
 };
 
 
@@ -102,12 +136,41 @@ class SourceFileOnDatabase : public SourceFile
 {
 private:
     // Members.
-    std::shared_ptr<ProgramDb> pdb_; // We keep this to make sure the database isn't closed prematurely.
+    std::shared_ptr<ProgramDbSnapshot> snapshot_; // sourceText_ points into this snapshot so we keep it open.
 
 public:
     // Constructors.
-    explicit SourceFileOnDatabase(uint32_t id) : SourceFile(id) {}
+    explicit SourceFileOnDatabase(uint32_t id, const std::shared_ptr<ProgramDbSnapshot> &snapshot) : SourceFile(id), snapshot_(snapshot) {}
     virtual ~SourceFileOnDatabase();
+
+    const std::shared_ptr<ProgramDbSnapshot> &snapshot() const { return snapshot_; }
+};
+
+
+//
+// A source file whose text is held in memory rather than read from a file
+// or the program database.
+//
+
+class SourceFileInMemory : public SourceFile
+{
+private:
+    // Members.
+    std::string text_;              // sourceText_ points into this.
+
+public:
+    // Constructors.
+    explicit SourceFileInMemory(const std::string &fileName, const std::string &text, const TimePoint &modified = Clock::now()) :
+        SourceFile(fileName, modified), text_(text) { sourceText_ = text_; }
+
+    // Copy another source file, keeping its id, digest and line index.
+    // Used so a file read from the program database doesn't have to keep
+    // the database snapshot open.
+    explicit SourceFileInMemory(const SourceFile &other) :
+        SourceFile(other), text_(other.sourceText()) { sourceText_ = text_; }
+
+    SourceFileInMemory(const SourceFileInMemory &) = delete;
+    SourceFileInMemory &operator=(const SourceFileInMemory &) = delete;
 };
 
 
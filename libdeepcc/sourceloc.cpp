@@ -0,0 +1,109 @@
+#include <algorithm>
+
+#include "sourceloc.h"
+#include "sourcefile.h"
+#include "programdb.h"
+
+
+namespace deepC
+{
+
+
+//
+// Register a source file.
+//
+
+void SourceLocator::addFile(const std::shared_ptr<SourceFile> &sourceFile)
+{
+    files_[sourceFile->id()] = sourceFile;
+}
+
+
+//
+// Get a source file, fetching it from the program database if we haven't
+// seen it yet.
+//
+
+std::shared_ptr<SourceFile> SourceLocator::getFile(uint32_t fileId)
+{
+    auto it = files_.find(fileId);
+    if (it != files_.end())
+        return it->second;
+
+    if (!pdb_ || fileId == 0)
+        return nullptr;
+
+    auto sourceFile = std::dynamic_pointer_cast<SourceFile>(pdb_->get(Storable::DbGroup::SourceFiles, fileId));
+    if (sourceFile)
+    {
+        files_[fileId] = sourceFile;
+    }
+
+    return sourceFile;
+}
+
+
+//
+// Convert a SourceLoc to a line and column.
+//
+
+bool SourceLocator::lineColumn(SourceLoc loc, uint32_t *line, uint32_t *column)
+{
+    std::shared_ptr<SourceFile> sourceFile = getFile(loc.fileId);
+    if (!sourceFile)
+        return false;
+
+    const LineIndex &index = sourceFile->lineIndex();
+    if (index.empty())
+    {
+        *line = 1;
+        *column = 1;
+        return true;
+    }
+
+    size_t lineNo = index.lineOf(loc.offset);
+    uint32_t offset = std::min(loc.offset, index.lineEnd(lineNo));
+    *line = static_cast<uint32_t>(lineNo + 1);
+    *column = offset - index.lineStart(lineNo) + 1;
+    return true;
+}
+
+
+//
+// Convert a SourceLoc to a printable position.
+//
+
+SourcePos SourceLocator::toPos(SourceLoc loc)
+{
+    uint32_t line;
+    uint32_t column;
+    if (!lineColumn(loc, &line, &column))
+        return SourcePos();
+
+    return SourcePos(getFile(loc.fileId)->fileName(), line, column);
+}
+
+
+//
+// Convert a line and column to a SourceLoc.
+//
+
+SourceLoc SourceLocator::toLoc(uint32_t fileId, uint32_t line, uint32_t column)
+{
+    std::shared_ptr<SourceFile> sourceFile = getFile(fileId);
+    if (!sourceFile || line == 0)
+        return SourceLoc();
+
+    const LineIndex &index = sourceFile->lineIndex();
+    if (line > index.lineCount())
+        return SourceLoc();
+
+    uint32_t start = index.lineStart(line - 1);
+    uint32_t length = index.lineEnd(line - 1) - start;
+    uint32_t col = column > 0 ? column - 1 : 0;
+
+    return SourceLoc(fileId, start + std::min(col, length));
+}
+
+
+} // namespace deepC
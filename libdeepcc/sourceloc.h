@@ -0,0 +1,85 @@
+#ifndef DEEPC_SOURCELOC_H
+#define DEEPC_SOURCELOC_H
+
+#include <cstdint>
+#include <memory>
+#include <unordered_map>
+
+#include "sourcepos.h"
+
+
+namespace deepC
+{
+
+
+// Forward declarations.
+class ProgramDb;
+class SourceFile;
+
+
+//
+// A compact position in the source code: the database id of the source
+// file and a byte offset into it. It's small enough for every token and
+// parse tree node to carry one. The line and column are worked out only
+// when they're needed, using SourceLocator.
+//
+
+struct SourceLoc
+{
+    uint32_t fileId;    // The source file's id in the program database, or 0 for none.
+    uint32_t offset;    // Byte offset from the start of the file.
+
+    SourceLoc() : fileId(0), offset(0) {}
+    SourceLoc(uint32_t fileId, uint32_t offset) : fileId(fileId), offset(offset) {}
+
+    bool exists() const { return fileId != 0; }
+    bool operator==(const SourceLoc &other) const { return fileId == other.fileId && offset == other.offset; }
+    bool operator!=(const SourceLoc &other) const { return !(*this == other); }
+};
+
+static_assert(sizeof(SourceLoc) == 8, "SourceLoc should stay compact");
+
+
+//
+// Converts between SourceLocs and line/column positions. Lines and
+// columns start at 1, and columns count bytes. Converting a SourceLoc to
+// a line is a binary search of the file's LineIndex, and converting a
+// line and column to a SourceLoc is a table lookup.
+//
+// Files are registered as they're loaded. Files which haven't been are
+// read from the program database, if there is one. A SourceLocator isn't
+// thread safe.
+//
+
+class SourceLocator
+{
+private:
+    std::shared_ptr<ProgramDb> pdb_;
+    std::unordered_map<uint32_t, std::shared_ptr<SourceFile>> files_;
+
+public:
+    explicit SourceLocator(std::shared_ptr<ProgramDb> pdb = nullptr) : pdb_(pdb) {}
+
+    // Register a source file. It must already have an id.
+    void addFile(const std::shared_ptr<SourceFile> &sourceFile);
+
+    // Get a source file by id. Returns nullptr if it's not known.
+    std::shared_ptr<SourceFile> getFile(uint32_t fileId);
+
+    // Convert a SourceLoc to a line and column. Returns false if the file
+    // isn't known. Offsets past the end are on the last line.
+    bool      lineColumn(SourceLoc loc, uint32_t *line, uint32_t *column);
+
+    // Convert a SourceLoc to a printable position.
+    SourcePos toPos(SourceLoc loc);
+
+    // Convert a line and column to a SourceLoc. Columns past the end of
+    // the line are at the end of the line. Returns a SourceLoc which
+    // doesn't exist if the file or line isn't known.
+    SourceLoc toLoc(uint32_t fileId, uint32_t line, uint32_t column);
+};
+
+
+} // namespace deepC
+
+#endif // DEEPC_SOURCELOC_H
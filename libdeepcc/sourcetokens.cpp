@@ -0,0 +1,71 @@
+#include "sourcetokens.h"
+#include "programdb.h"
+#include "flatbuffers/flatbuffers.h"
+#include "storedobject_generated.h"
+
+
+namespace deepC
+{
+
+
+//
+// Serialise the content of this object so it can be stored in the database.
+// The token stream's blob is written straight into the buffer, aligned so
+// it can be used in place when it's read back.
+//
+
+void SourceTokens::serialiseContent(flatbuffers::FlatBufferBuilder &builder) const
+{
+    size_t blobSize = tokens_.blobSize();
+    uint8_t *blob = nullptr;
+    builder.ForceVectorAlignment(blobSize, sizeof(uint8_t), 8);
+    auto tokensVec = builder.CreateUninitializedVector(blobSize, &blob);
+    tokens_.writeBlob(blob);
+
+    fb::Digest digest(digest_.hash, digest_.size);
+    auto srcTokens = fb::CreateSourceTokens(builder, sourceFileId_, &digest, tokensVec);
+    fb::FinishStoredObjectBuffer(builder, fb::CreateStoredObject(builder, fb::StoredAny_SourceTokens, srcTokens.Union()));
+}
+
+
+//
+// Serialise the key of this object so it can be found in the database.
+//
+
+void SourceTokens::serialiseKey(flatbuffers::FlatBufferBuilder &builder) const
+{
+    serialiseKey(builder, sourceFileId_);
+}
+
+
+//
+// Serialise the key for the tokens of a given source file.
+//
+
+void SourceTokens::serialiseKey(flatbuffers::FlatBufferBuilder &builder, uint32_t sourceFileId)
+{
+    auto idKey = fb::CreateIdKey(builder, sourceFileId);
+    fb::FinishStoredObjectBuffer(builder, fb::CreateStoredObject(builder, fb::StoredAny_IdKey, idKey.Union()));
+}
+
+
+//
+// Fill out this object from a database serialised form. The tokens are
+// viewed where they are, in the snapshot.
+//
+
+void SourceTokens::unserialise(const fb::StoredObject &so)
+{
+    const fb::SourceTokens *st = so.obj_as_SourceTokens();
+    sourceFileId_ = st->source_file();
+    if (st->digest())
+    {
+        digest_ = ContentDigest(st->digest()->hash(), st->digest()->size());
+    }
+
+    if (st->tokens() == nullptr || !tokens_.viewBlob(st->tokens()->data(), st->tokens()->size()))
+        throw ProgramDbException("the tokens of source file " + std::to_string(sourceFileId_) + " are damaged");
+}
+
+
+} // namespace deepC
@@ -0,0 +1,58 @@
+#ifndef DEEPC_SOURCETOKENS_H
+#define DEEPC_SOURCETOKENS_H
+
+#include <memory>
+
+#include "storable.h"
+#include "tokenstream.h"
+
+
+namespace deepC
+{
+
+
+//
+// The tokens of a source file, as stored in the program database. They're
+// stored along with the digest of the source text they were made from, so
+// if a file hasn't changed its tokens can be used again without lexing it.
+//
+// Tokens read from the database are used in place in LMDB's memory map
+// rather than being copied, so the object keeps its snapshot open.
+//
+
+class SourceTokens : public Storable
+{
+private:
+    uint32_t                           sourceFileId_;   // The SourceFile these are the tokens of.
+    ContentDigest                      digest_;         // The text they were made from.
+    TokenStream                        tokens_;
+    std::shared_ptr<ProgramDbSnapshot> snapshot_;       // tokens_ may point into this snapshot.
+
+public:
+    // Constructors.
+    explicit SourceTokens(uint32_t sourceFileId, const ContentDigest &digest) : sourceFileId_(sourceFileId), digest_(digest), tokens_(sourceFileId) {}
+    explicit SourceTokens(uint32_t id, const std::shared_ptr<ProgramDbSnapshot> &snapshot) : Storable(id), sourceFileId_(0), snapshot_(snapshot) {}
+
+    // Accessors.
+    uint32_t             sourceFileId() const { return sourceFileId_; }
+    const ContentDigest &digest() const       { return digest_; }
+    const TokenStream   &tokens() const       { return tokens_; }
+    TokenStream         &tokens()             { return tokens_; }
+
+    // Which databases to use for the content and the key mapping.
+    DbGroup contentDbGroup() const override { return Storable::DbGroup::SourceTokens; }
+    DbGroup keyDbGroup() const override     { return Storable::DbGroup::SourceTokenKeys; }
+
+    // To store this type in the database.
+    void serialiseContent(flatbuffers::FlatBufferBuilder &builder) const override;
+    void serialiseKey(flatbuffers::FlatBufferBuilder &builder) const override;
+    void unserialise(const fb::StoredObject &so) override;
+
+    // Serialise the key for a source file, to look it up without an object.
+    static void serialiseKey(flatbuffers::FlatBufferBuilder &builder, uint32_t sourceFileId);
+};
+
+
+} // namespace deepC
+
+#endif // DEEPC_SOURCETOKENS_H
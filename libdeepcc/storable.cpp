@@ -1,6 +1,10 @@
 #include "storable.h"
 #include "deeptypes.h"
 #include "sourcefile.h"
+#include "sourcetokens.h"
+#include "includeinfo.h"
+#include "includeresolver.h"
+#include "macrocontext.h"
 #include "programdb.h"
 #include "flatbuffers/flatbuffers.h"
 #include "storedobject_generated.h"
@@ -10,7 +14,7 @@ namespace deepC
 {
 
 // Factory method to create an appropriately typed Storable from stored data.
-std::shared_ptr<Storable> Storable::create(uint32_t id, const fb::StoredObject &so)
+std::shared_ptr<Storable> Storable::create(uint32_t id, const fb::StoredObject &so, const std::shared_ptr<ProgramDbSnapshot> &snapshot)
 {
     std::shared_ptr<Storable> obj;
     
@@ -18,7 +22,23 @@ std::shared_ptr<Storable> Storable::create(uint32_t id, const fb::StoredObject &
     switch (so.obj_type())
     {
     case fb::StoredAny_SourceFile:
-        obj = std::make_shared<SourceFileOnDatabase>(id);
+        obj = std::make_shared<SourceFileOnDatabase>(id, snapshot);
+        break;
+
+    case fb::StoredAny_SourceTokens:
+        obj = std::make_shared<SourceTokens>(id, snapshot);
+        break;
+
+    case fb::StoredAny_IncludeInfo:
+        obj = std::make_shared<IncludeInfo>(id, snapshot);
+        break;
+
+    case fb::StoredAny_IncludeResolution:
+        obj = std::make_shared<IncludeResolution>(id, snapshot);
+        break;
+
+    case fb::StoredAny_HeaderMacroContexts:
+        obj = std::make_shared<HeaderMacroContexts>(id, snapshot);
         break;
         
     default:
@@ -32,4 +52,25 @@ std::shared_ptr<Storable> Storable::create(uint32_t id, const fb::StoredObject &
     return obj;
 }
 
+
+// Get the payload digest from stored data without creating the object.
+bool Storable::storedBlobDigest(const fb::StoredObject &so, ContentDigest *digest)
+{
+    switch (so.obj_type())
+    {
+    case fb::StoredAny_SourceFile:
+    {
+        const fb::Digest *d = so.obj_as_SourceFile()->digest();
+        if (d == nullptr)
+            return false;
+
+        *digest = ContentDigest(d->hash(), d->size());
+        return true;
+    }
+
+    default:
+        return false;
+    }
+}
+
 } // namespace deepC
@@ -3,8 +3,10 @@
 
 #include <chrono>
 #include <memory>
+#include <string_view>
 
 #include "deeptypes.h"
+#include "contenthash.h"
 
 
 // Forward declarations.
@@ -16,6 +18,7 @@ namespace deepC
 {
 
 class ProgramDb;
+class ProgramDbSnapshot;
 
 namespace fb {
     struct StoredObject;
@@ -38,7 +41,15 @@ public:
     enum class DbGroup
     {
         SourceFiles,
-        SourceFileKeys
+        SourceFileKeys,
+        SourceTokens,
+        SourceTokenKeys,
+        IncludeInfos,
+        IncludeInfoKeys,
+        IncludeResolutions,
+        IncludeResolutionKeys,
+        MacroContexts,
+        MacroContextKeys
     };
     
 protected:
@@ -64,9 +75,21 @@ public:
 
     // To unserialise this type.
     virtual void unserialise(const fb::StoredObject &so) = 0;
+
+    // Some objects have a large payload, like the text of a source file,
+    // which is kept in a content addressed table so identical payloads are
+    // only stored once. The object's own record just holds the digest.
+    // Objects with a payload return true and its digest from blobDigest().
+    virtual bool             blobDigest(ContentDigest *) const { return false; }
+    virtual std::string_view blob() const                       { return std::string_view(); }
+    virtual void             setBlob(std::string_view)          {}
+
+    // Get the payload digest from stored data without creating the object.
+    static bool storedBlobDigest(const fb::StoredObject &so, ContentDigest *digest);
     
     // Factory method to create an appropriately typed Storable from stored data.
-    static std::shared_ptr<Storable> create(uint32_t id, const fb::StoredObject &so);
+    // The object may refer to data in the snapshot so it's kept open.
+    static std::shared_ptr<Storable> create(uint32_t id, const fb::StoredObject &so, const std::shared_ptr<ProgramDbSnapshot> &snapshot);
 };
 
 
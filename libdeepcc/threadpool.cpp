@@ -0,0 +1,182 @@
+#include "threadpool.h"
+
+
+namespace deepC
+{
+
+
+// The pool and worker the current thread belongs to, if any.
+static thread_local ThreadPool *currentPool = nullptr;
+static thread_local size_t      currentWorker = 0;
+
+
+//
+// Constructor. Starts the worker threads.
+//
+
+ThreadPool::ThreadPool(size_t numWorkers) :
+    numWorkers_(numWorkers),
+    queued_(0),
+    unfinished_(0),
+    stopping_(false),
+    nextQueue_(0)
+{
+    if (numWorkers_ == 0)
+    {
+        numWorkers_ = std::thread::hardware_concurrency();
+        if (numWorkers_ == 0)
+        {
+            numWorkers_ = 1;
+        }
+    }
+
+    workers_.reset(new Worker[numWorkers_]);
+    for (size_t i = 0; i < numWorkers_; i++)
+    {
+        threads_.emplace_back(&ThreadPool::run, this, i);
+    }
+}
+
+
+//
+// Destructor. Waits for the tasks to finish and stops the workers.
+//
+
+ThreadPool::~ThreadPool()
+{
+    {
+        std::unique_lock<std::mutex> locker(mutex_);
+        idle_.wait(locker, [this]() { return unfinished_ == 0; });
+        stopping_ = true;
+    }
+
+    wake_.notify_all();
+    for (std::thread &thread : threads_)
+    {
+        thread.join();
+    }
+}
+
+
+//
+// Add a task. A task submitted by a worker goes on that worker's own
+// queue, otherwise the queues are used in turn.
+//
+
+void ThreadPool::submit(Task task)
+{
+    // It's counted first so it can't finish before it's been counted.
+    {
+        std::lock_guard<std::mutex> locker(mutex_);
+        unfinished_++;
+        queued_++;
+    }
+
+    size_t queue = (currentPool == this) ? currentWorker : nextQueue_++ % numWorkers_;
+    {
+        std::lock_guard<std::mutex> locker(workers_[queue].mutex);
+        workers_[queue].tasks.push_back(std::move(task));
+    }
+
+    wake_.notify_one();
+}
+
+
+//
+// Get a task to run, newest first from the worker's own queue or oldest
+// first from another worker's. Returns false if there aren't any.
+//
+
+bool ThreadPool::takeTask(size_t worker, Task *task)
+{
+    {
+        Worker &own = workers_[worker];
+        std::lock_guard<std::mutex> locker(own.mutex);
+        if (!own.tasks.empty())
+        {
+            *task = std::move(own.tasks.back());
+            own.tasks.pop_back();
+            queued_--;
+            return true;
+        }
+    }
+
+    for (size_t i = 1; i < numWorkers_; i++)
+    {
+        Worker &victim = workers_[(worker + i) % numWorkers_];
+        std::lock_guard<std::mutex> locker(victim.mutex);
+        if (!victim.tasks.empty())
+        {
+            *task = std::move(victim.tasks.front());
+            victim.tasks.pop_front();
+            queued_--;
+            return true;
+        }
+    }
+
+    return false;
+}
+
+
+//
+// A worker thread. Runs tasks until the pool is stopped.
+//
+
+void ThreadPool::run(size_t worker)
+{
+    currentPool = this;
+    currentWorker = worker;
+
+    for (;;)
+    {
+        Task task;
+        if (takeTask(worker, &task))
+        {
+            try {
+                task(worker);
+            }
+            catch (...) {
+                std::lock_guard<std::mutex> locker(mutex_);
+                if (!error_)
+                {
+                    error_ = std::current_exception();
+                }
+            }
+
+            std::lock_guard<std::mutex> locker(mutex_);
+            if (--unfinished_ == 0)
+            {
+                idle_.notify_all();
+            }
+
+            continue;
+        }
+
+        // Nothing to do so sleep until there is.
+        std::unique_lock<std::mutex> locker(mutex_);
+        wake_.wait(locker, [this]() { return stopping_ || queued_ > 0; });
+        if (stopping_ && queued_ == 0)
+            return;
+    }
+}
+
+
+//
+// Wait for all the tasks to finish.
+//
+
+void ThreadPool::wait()
+{
+    std::unique_lock<std::mutex> locker(mutex_);
+    idle_.wait(locker, [this]() { return unfinished_ == 0; });
+
+    if (error_)
+    {
+        std::exception_ptr error = error_;
+        error_ = nullptr;
+        std::rethrow_exception(error);
+    }
+}
+
+
+} // namespace deepC
@@ -0,0 +1,82 @@
+#ifndef DEEPC_THREADPOOL_H
+#define DEEPC_THREADPOOL_H
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+
+namespace deepC
+{
+
+
+//
+// A fixed set of worker threads which run tasks. Each worker has its own
+// queue. A worker takes its newest task first, so work a task submits is
+// done while its data is still in the cache. When its queue is empty it
+// steals the oldest task from another worker, which tends to be a large
+// piece of work. Tasks submitted from outside the pool are spread across
+// the queues.
+//
+// Tasks are given the index of the worker running them, so they can use
+// per-worker resources like an Arena without locking.
+//
+
+class ThreadPool
+{
+public:
+    typedef std::function<void(size_t worker)> Task;
+
+private:
+    struct Worker
+    {
+        std::mutex       mutex;
+        std::deque<Task> tasks;
+    };
+
+    size_t                    numWorkers_;
+    std::unique_ptr<Worker[]> workers_;
+    std::vector<std::thread>  threads_;
+
+    // Protects the counts and the wait conditions.
+    std::mutex                mutex_;
+    std::condition_variable   wake_;        // There's a task to do or we're stopping.
+    std::condition_variable   idle_;        // Every task has finished.
+    std::atomic<size_t>       queued_;      // Tasks waiting in a queue.
+    size_t                    unfinished_;  // Tasks submitted but not finished.
+    bool                      stopping_;
+    std::atomic<size_t>       nextQueue_;   // Where the next task from outside the pool goes.
+    std::exception_ptr        error_;       // The first exception thrown by a task.
+
+private:
+    bool takeTask(size_t worker, Task *task);
+    void run(size_t worker);
+
+public:
+    // Start the workers. Zero means one per hardware thread.
+    explicit ThreadPool(size_t numWorkers = 0);
+    ~ThreadPool();
+    ThreadPool(const ThreadPool &) = delete;
+    ThreadPool &operator=(const ThreadPool &) = delete;
+
+    size_t size() const { return numWorkers_; }
+
+    // Add a task. Tasks may submit more tasks.
+    void submit(Task task);
+
+    // Wait for every task to finish. If any task threw an exception the
+    // first one is thrown from here.
+    void wait();
+};
+
+
+} // namespace deepC
+
+#endif // DEEPC_THREADPOOL_H
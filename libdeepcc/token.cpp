@@ -5,9 +5,24 @@ namespace deepC
 {
 
 
-Token::Token()
+//
+// Get the name of a kind of token.
+//
+
+const char *tokenKindName(TokenKind kind)
 {
+    switch (kind)
+    {
+    case TokenKind::EndOfFile:          return "end of file";
+    case TokenKind::Identifier:         return "identifier";
+    case TokenKind::PpNumber:           return "number";
+    case TokenKind::CharacterConstant:  return "character constant";
+    case TokenKind::StringLiteral:      return "string literal";
+    case TokenKind::Punctuator:         return "punctuator";
+    case TokenKind::Other:              return "unexpected character";
+    }
 
+    return "unknown token";
 }
 
 
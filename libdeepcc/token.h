@@ -1,17 +1,85 @@
 #ifndef DEEPC_TOKEN_H
 #define DEEPC_TOKEN_H
 
+#include <cstdint>
+#include <string_view>
+
+#include "clexertables.h"
+#include "sourceloc.h"
+
 
 namespace deepC
 {
 
 
+//
+// The kinds of preprocessing token the lexer produces.
+//
+
+enum class TokenKind : uint8_t
+{
+    EndOfFile,
+    Identifier,
+    PpNumber,
+    CharacterConstant,
+    StringLiteral,
+    Punctuator,
+    Other           // A character which doesn't start any token, like a stray '`'.
+};
+
+
+// Keywords and punctuators, as generated from c_lexical.pgen.
+using Keyword = lexTables::Keyword;
+using Punctuator = lexTables::Punctuator;
+
+
+//
+// A token. It refers to its text by location rather than holding a copy.
+// Identifiers which are keywords and punctuators also say which keyword or
+// punctuator they are, so they can be compared as integers.
+//
+
 class Token
 {
 public:
-    Token();
+    // Flags describing what came before the token.
+    enum Flags : uint8_t
+    {
+        StartOfLine     = 0x01,     // First token on a line.
+        PrecededBySpace = 0x02      // Whitespace or a comment came before it.
+    };
+
+private:
+    SourceLoc loc_;
+    uint32_t  length_;
+    TokenKind kind_;
+    uint8_t   subKind_;     // The Keyword or Punctuator, or 0.
+    uint8_t   flags_;
+
+public:
+    Token() : length_(0), kind_(TokenKind::EndOfFile), subKind_(0), flags_(0) {}
+    Token(TokenKind kind, SourceLoc loc, uint32_t length, uint8_t flags, uint8_t subKind = 0) : loc_(loc), length_(length), kind_(kind), subKind_(subKind), flags_(flags) {}
+
+    TokenKind kind() const   { return kind_; }
+    uint8_t   subKind() const { return subKind_; }
+    Keyword   keyword() const    { return kind_ == TokenKind::Identifier ? static_cast<Keyword>(subKind_) : Keyword::None; }
+    Punctuator punctuator() const { return kind_ == TokenKind::Punctuator ? static_cast<Punctuator>(subKind_) : Punctuator::None; }
+    SourceLoc loc() const    { return loc_; }
+    uint32_t  length() const { return length_; }
+    uint8_t   flags() const  { return flags_; }
+    bool      startOfLine() const     { return (flags_ & StartOfLine) != 0; }
+    bool      precededBySpace() const { return (flags_ & PrecededBySpace) != 0; }
+
+    // The text of the token, given the text of its source file.
+    std::string_view text(std::string_view source) const { return source.substr(loc_.offset, length_); }
 };
 
+static_assert(sizeof(Token) == 16, "Token should stay compact");
+
+
+// Get the name of a kind of token, for messages.
+const char *tokenKindName(TokenKind kind);
+
 
 } // namespace deepC
 
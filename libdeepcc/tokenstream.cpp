@@ -0,0 +1,290 @@
+#include <cstring>
+#include <utility>
+
+#include "tokenstream.h"
+
+
+namespace deepC
+{
+
+
+//
+// Constructor.
+//
+
+TokenStream::TokenStream(uint32_t fileId) :
+    data_(nullptr),
+    size_(0),
+    capacity_(0),
+    fileId_(fileId),
+    offsets_(nullptr),
+    lengths_(nullptr),
+    identIds_(nullptr),
+    kinds_(nullptr),
+    subKinds_(nullptr),
+    flags_(nullptr)
+{
+}
+
+
+//
+// Move constructor.
+//
+
+TokenStream::TokenStream(TokenStream &&other) noexcept :
+    TokenStream(other.fileId_)
+{
+    *this = std::move(other);
+}
+
+
+//
+// Move assignment. The arrays stay where they are so the pointers can be
+// taken as they are.
+//
+
+TokenStream &TokenStream::operator=(TokenStream &&other) noexcept
+{
+    if (this != &other)
+    {
+        block_ = std::move(other.block_);
+        data_ = other.data_;
+        size_ = other.size_;
+        capacity_ = other.capacity_;
+        fileId_ = other.fileId_;
+        offsets_ = other.offsets_;
+        lengths_ = other.lengths_;
+        identIds_ = other.identIds_;
+        kinds_ = other.kinds_;
+        subKinds_ = other.subKinds_;
+        flags_ = other.flags_;
+
+        other.data_ = nullptr;
+        other.size_ = 0;
+        other.capacity_ = 0;
+        other.offsets_ = other.lengths_ = other.identIds_ = nullptr;
+        other.kinds_ = other.subKinds_ = other.flags_ = nullptr;
+    }
+
+    return *this;
+}
+
+
+//
+// Point the arrays into a block with room for the given number of tokens.
+// Arrays in a blob we're viewing are only written after reallocating.
+//
+
+void TokenStream::setArrays(const char *data, size_t capacity)
+{
+    char *pos = const_cast<char *>(data) + sizeof(Header);
+    offsets_ = reinterpret_cast<uint32_t *>(pos);
+    pos += capacity * sizeof(uint32_t);
+    lengths_ = reinterpret_cast<uint32_t *>(pos);
+    pos += capacity * sizeof(uint32_t);
+    identIds_ = reinterpret_cast<uint32_t *>(pos);
+    pos += capacity * sizeof(uint32_t);
+    kinds_ = reinterpret_cast<uint8_t *>(pos);
+    pos += capacity;
+    subKinds_ = reinterpret_cast<uint8_t *>(pos);
+    pos += capacity;
+    flags_ = reinterpret_cast<uint8_t *>(pos);
+
+    data_ = data;
+    capacity_ = capacity;
+}
+
+
+//
+// Move the tokens to a new block of our own.
+//
+
+void TokenStream::reallocate(size_t capacity)
+{
+    if (capacity < size_)
+    {
+        capacity = size_;
+    }
+
+    std::unique_ptr<char[]> block(new char[blockSize(capacity)]);
+    uint32_t *offsets = offsets_;
+    uint32_t *lengths = lengths_;
+    uint32_t *identIds = identIds_;
+    uint8_t  *kinds = kinds_;
+    uint8_t  *subKinds = subKinds_;
+    uint8_t  *flags = flags_;
+    setArrays(block.get(), capacity);
+
+    if (size_ > 0)
+    {
+        memcpy(offsets_, offsets, size_ * sizeof(uint32_t));
+        memcpy(lengths_, lengths, size_ * sizeof(uint32_t));
+        memcpy(identIds_, identIds, size_ * sizeof(uint32_t));
+        memcpy(kinds_, kinds, size_);
+        memcpy(subKinds_, subKinds, size_);
+        memcpy(flags_, flags, size_);
+    }
+
+    block_ = std::move(block);
+}
+
+
+//
+// Make room for at least this many tokens.
+//
+
+void TokenStream::reserve(size_t capacity)
+{
+    if (capacity > capacity_)
+    {
+        reallocate(capacity);
+    }
+}
+
+
+//
+// Append tokens [first, last) of another stream. Each array is copied in
+// one go and only the offsets need adjusting.
+//
+
+void TokenStream::append(const TokenStream &from, size_t first, size_t last, ptrdiff_t offsetShift)
+{
+    if (last <= first)
+        return;
+
+    size_t count = last - first;
+    if (size_ + count > capacity_)
+    {
+        reallocate(size_ + count > capacity_ * 2 ? size_ + count : capacity_ * 2);
+    }
+
+    // Shifting with unsigned arithmetic wraps around for negative shifts.
+    uint32_t shift = static_cast<uint32_t>(offsetShift);
+    const uint32_t *fromOffsets = from.offsets_ + first;
+    uint32_t *offsets = offsets_ + size_;
+    for (size_t i = 0; i < count; i++)
+    {
+        offsets[i] = fromOffsets[i] + shift;
+    }
+
+    memcpy(lengths_ + size_, from.lengths_ + first, count * sizeof(uint32_t));
+    memcpy(identIds_ + size_, from.identIds_ + first, count * sizeof(uint32_t));
+    memcpy(kinds_ + size_, from.kinds_ + first, count);
+    memcpy(subKinds_ + size_, from.subKinds_ + first, count);
+    memcpy(flags_ + size_, from.flags_ + first, count);
+    size_ += count;
+}
+
+
+//
+// Set the interned identifier id of a token.
+//
+
+void TokenStream::setIdentId(size_t i, uint32_t identId)
+{
+    if (isView())
+    {
+        reallocate(size_);
+    }
+
+    identIds_[i] = identId;
+}
+
+
+//
+// Write the tokens as a single blob of blobSize() bytes. The blob has no
+// spare capacity.
+//
+
+void TokenStream::writeBlob(void *blob) const
+{
+    Header header;
+    header.magic = blobMagic;
+    header.count = static_cast<uint32_t>(size_);
+    header.fileId = fileId_;
+    header.capacity = static_cast<uint32_t>(size_);
+
+    char *pos = static_cast<char *>(blob);
+    memcpy(pos, &header, sizeof(header));
+    pos += sizeof(header);
+    if (size_ == 0)
+        return;
+
+    memcpy(pos, offsets_, size_ * sizeof(uint32_t));
+    pos += size_ * sizeof(uint32_t);
+    memcpy(pos, lengths_, size_ * sizeof(uint32_t));
+    pos += size_ * sizeof(uint32_t);
+    memcpy(pos, identIds_, size_ * sizeof(uint32_t));
+    pos += size_ * sizeof(uint32_t);
+    memcpy(pos, kinds_, size_);
+    pos += size_;
+    memcpy(pos, subKinds_, size_);
+    pos += size_;
+    memcpy(pos, flags_, size_);
+}
+
+
+//
+// Use the tokens in a blob made by writeBlob(). Returns false and leaves
+// the stream empty if it's not a valid blob. The blob is viewed where it
+// is, so it must stay valid and unchanged for as long as the stream uses
+// it. If it's not aligned well enough to use directly it's copied.
+//
+
+bool TokenStream::viewBlob(const void *blob, size_t blobSize)
+{
+    block_.reset();
+    data_ = nullptr;
+    size_ = 0;
+    capacity_ = 0;
+    offsets_ = lengths_ = identIds_ = nullptr;
+    kinds_ = subKinds_ = flags_ = nullptr;
+
+    Header header;
+    if (blobSize < sizeof(header))
+        return false;
+
+    memcpy(&header, blob, sizeof(header));
+    if (header.magic != blobMagic || header.count > header.capacity || blockSize(header.capacity) != blobSize)
+        return false;
+
+    fileId_ = header.fileId;
+    if ((reinterpret_cast<uintptr_t>(blob) & (alignof(uint32_t) - 1)) != 0)
+    {
+        // The arrays would be misaligned so we need a copy.
+        block_.reset(new char[blobSize]);
+        memcpy(block_.get(), blob, blobSize);
+        blob = block_.get();
+    }
+
+    setArrays(static_cast<const char *>(blob), header.capacity);
+    size_ = header.count;
+    if (!block_)
+    {
+        capacity_ = 0;
+    }
+
+    return true;
+}
+
+
+//
+// Copy the tokens from a blob made by writeBlob(). Returns false and
+// leaves the stream empty if it's not a valid blob.
+//
+
+bool TokenStream::assignBlob(const void *blob, size_t blobSize)
+{
+    if (!viewBlob(blob, blobSize))
+        return false;
+
+    if (isView())
+    {
+        reallocate(size_);
+    }
+
+    return true;
+}
+
+
+} // namespace deepC
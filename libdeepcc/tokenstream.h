@@ -0,0 +1,153 @@
+#ifndef DEEPC_TOKENSTREAM_H
+#define DEEPC_TOKENSTREAM_H
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string_view>
+
+#include "token.h"
+
+
+namespace deepC
+{
+
+
+//
+// All the tokens of a source file, stored as parallel arrays rather than
+// as an array of Tokens. Scanning the kinds of tokens, which is what the
+// parser and the incremental diff mostly do, then only touches one byte
+// per token.
+//
+// The arrays all live in a single block of memory with a small header:
+//
+//      header | offsets | lengths | identIds | kinds | subKinds | flags
+//
+// A stream is stored in the program database as exactly that block, so it
+// can be written with one copy and used straight from a stored blob
+// without unpacking it. A stream which views a blob copies it into its own
+// block the first time it's modified.
+//
+// All the tokens are in the same file so the file id is only stored once.
+//
+
+class TokenStream
+{
+public:
+    // The identId of a token which isn't an interned identifier.
+    static constexpr uint32_t noIdent = 0;
+
+    // The bytes of storage each token needs.
+    static constexpr size_t bytesPerToken = 3 * sizeof(uint32_t) + 3 * sizeof(uint8_t);
+
+private:
+    // The start of the block.
+    struct Header
+    {
+        uint32_t magic;
+        uint32_t count;
+        uint32_t fileId;
+        uint32_t capacity;
+    };
+
+    static constexpr uint32_t blobMagic = 0x4b544344;   // "DCTK".
+
+    std::unique_ptr<char[]> block_;     // Our own block, or null if we're viewing a blob.
+    const char             *data_;      // The block in use.
+    size_t                  size_;
+    size_t                  capacity_;  // 0 when viewing a blob, so adding to it reallocates.
+    uint32_t                fileId_;
+
+    // The arrays in the current block.
+    uint32_t               *offsets_;
+    uint32_t               *lengths_;
+    uint32_t               *identIds_;
+    uint8_t                *kinds_;
+    uint8_t                *subKinds_;
+    uint8_t                *flags_;
+
+private:
+    static size_t blockSize(size_t capacity) { return sizeof(Header) + capacity * bytesPerToken; }
+    void   setArrays(const char *data, size_t capacity);
+    void   reallocate(size_t capacity);
+
+public:
+    explicit TokenStream(uint32_t fileId = 0);
+    TokenStream(TokenStream &&other) noexcept;
+    TokenStream &operator=(TokenStream &&other) noexcept;
+    TokenStream(const TokenStream &) = delete;
+    TokenStream &operator=(const TokenStream &) = delete;
+
+    // Size.
+    size_t   size() const     { return size_; }
+    bool     empty() const    { return size_ == 0; }
+    size_t   capacity() const { return capacity_; }
+    void     reserve(size_t capacity);
+    void     clear()          { size_ = 0; }
+
+    uint32_t fileId() const             { return fileId_; }
+    void     setFileId(uint32_t fileId) { fileId_ = fileId; }
+
+    // Add a token.
+    void     push_back(TokenKind kind, uint8_t subKind, uint32_t offset, uint32_t length, uint8_t flags, uint32_t identId = noIdent)
+    {
+        if (size_ >= capacity_)
+        {
+            reallocate(size_ < 16 ? 32 : size_ * 2);
+        }
+
+        offsets_[size_] = offset;
+        lengths_[size_] = length;
+        identIds_[size_] = identId;
+        kinds_[size_] = static_cast<uint8_t>(kind);
+        subKinds_[size_] = subKind;
+        flags_[size_] = flags;
+        size_++;
+    }
+
+    void     push_back(const Token &token, uint32_t identId = noIdent) { push_back(token.kind(), token.subKind(), token.loc().offset, token.length(), token.flags(), identId); }
+
+    // Add a run of tokens from another stream, moving them by offsetShift
+    // bytes. This is how unchanged tokens are kept when a file is relexed.
+    void     append(const TokenStream &from, size_t first, size_t last, ptrdiff_t offsetShift = 0);
+
+    // Get parts of a token.
+    TokenKind kind(size_t i) const    { return static_cast<TokenKind>(kinds_[i]); }
+    uint8_t   subKind(size_t i) const { return subKinds_[i]; }
+    Keyword   keyword(size_t i) const { return kind(i) == TokenKind::Identifier ? static_cast<Keyword>(subKinds_[i]) : Keyword::None; }
+    Punctuator punctuator(size_t i) const { return kind(i) == TokenKind::Punctuator ? static_cast<Punctuator>(subKinds_[i]) : Punctuator::None; }
+    uint8_t   flags(size_t i) const   { return flags_[i]; }
+    uint32_t  offset(size_t i) const  { return offsets_[i]; }
+    uint32_t  length(size_t i) const  { return lengths_[i]; }
+    uint32_t  identId(size_t i) const { return identIds_[i]; }
+    SourceLoc loc(size_t i) const     { return SourceLoc(fileId_, offsets_[i]); }
+    void      setIdentId(size_t i, uint32_t identId);
+
+    // The text of a token, given the text of the source file.
+    std::string_view text(size_t i, std::string_view source) const { return source.substr(offsets_[i], lengths_[i]); }
+
+    // Get a whole token.
+    Token     operator[](size_t i) const { return Token(kind(i), loc(i), lengths_[i], flags_[i], subKinds_[i]); }
+
+    // The arrays, for scanning.
+    const uint8_t  *kinds() const    { return kinds_; }
+    const uint8_t  *subKinds() const { return subKinds_; }
+    const uint8_t  *flags() const    { return flags_; }
+    const uint32_t *offsets() const  { return offsets_; }
+    const uint32_t *lengths() const  { return lengths_; }
+    const uint32_t *identIds() const { return identIds_; }
+
+    // Whether the tokens are being used in place in a blob.
+    bool     isView() const { return data_ != nullptr && !block_; }
+
+    // Convert to and from a single blob for storage.
+    size_t   blobSize() const { return blockSize(size_); }
+    void     writeBlob(void *blob) const;
+    bool     assignBlob(const void *blob, size_t blobSize);
+    bool     viewBlob(const void *blob, size_t blobSize);
+};
+
+
+} // namespace deepC
+
+#endif // DEEPC_TOKENSTREAM_H
@@ -0,0 +1,267 @@
+#include <cstring>
+
+#include "parsetree.h"
+#include "pptokenstream.h"
+#include "typenames.h"
+
+
+namespace deepC
+{
+
+
+//
+// Constructor.
+//
+
+TypeNames::TypeNames(Arena &arena) :
+    arena_(arena),
+    buckets_(nullptr),
+    numBuckets_(0),
+    count_(0),
+    scope_(nullptr),
+    freeScopes_(nullptr),
+    freeShadows_(nullptr)
+{
+    grow();
+}
+
+
+//
+// FNV-1a.
+//
+
+uint32_t TypeNames::hash(std::string_view text)
+{
+    uint32_t h = 2166136261u;
+    for (char ch : text)
+    {
+        h = (h ^ static_cast<uint8_t>(ch)) * 16777619u;
+    }
+
+    return h;
+}
+
+
+TypeNames::Entry *TypeNames::find(std::string_view text, uint32_t hash) const
+{
+    for (Entry *entry = buckets_[hash & (numBuckets_ - 1)]; entry != nullptr; entry = entry->next)
+    {
+        if (entry->hash == hash && entry->text == text)
+            return entry;
+    }
+
+    return nullptr;
+}
+
+
+//
+// Double the number of buckets. The old ones stay in the arena.
+//
+
+void TypeNames::grow()
+{
+    size_t numBuckets = numBuckets_ == 0 ? initialBuckets : numBuckets_ * 2;
+    Entry **buckets = static_cast<Entry **>(arena_.allocate(numBuckets * sizeof(Entry *), alignof(Entry *)));
+    std::memset(buckets, 0, numBuckets * sizeof(Entry *));
+
+    for (size_t i = 0; i < numBuckets_; i++)
+    {
+        Entry *entry = buckets_[i];
+        while (entry != nullptr)
+        {
+            Entry *next = entry->next;
+            Entry *&bucket = buckets[entry->hash & (numBuckets - 1)];
+            entry->next = bucket;
+            bucket = entry;
+            entry = next;
+        }
+    }
+
+    buckets_ = buckets;
+    numBuckets_ = numBuckets;
+}
+
+
+bool TypeNames::isTypedefName(std::string_view text) const
+{
+    Entry *entry = find(text, hash(text));
+    return entry != nullptr && entry->typedefName;
+}
+
+
+//
+// Declare an identifier. A name which isn't known only needs adding if
+// it's a typedef name.
+//
+
+void TypeNames::declare(std::string_view text, bool typedefName)
+{
+    uint32_t h = hash(text);
+    Entry *entry = find(text, h);
+    if (entry == nullptr)
+    {
+        if (!typedefName)
+            return;
+
+        entry = static_cast<Entry *>(arena_.allocate(sizeof(Entry), alignof(Entry)));
+        Entry *&bucket = buckets_[h & (numBuckets_ - 1)];
+        *entry = Entry{ text, h, false, bucket };
+        bucket = entry;
+        if (++count_ > numBuckets_)
+        {
+            grow();
+        }
+    }
+
+    if (entry->typedefName == typedefName)
+        return;
+
+    if (scope_ != nullptr)
+    {
+        Shadow *shadow = freeShadows_;
+        if (shadow != nullptr)
+        {
+            freeShadows_ = shadow->next;
+        }
+        else
+        {
+            shadow = static_cast<Shadow *>(arena_.allocate(sizeof(Shadow), alignof(Shadow)));
+        }
+
+        *shadow = Shadow{ entry, entry->typedefName, scope_->shadows };
+        scope_->shadows = shadow;
+    }
+
+    entry->typedefName = typedefName;
+}
+
+
+//
+// Check if declaration specifiers include typedef, which is the first
+// option of storage-class-specifier.
+//
+
+static bool hasTypedef(const ParseNode *specifiers)
+{
+    if (specifiers->rule == Rule::StorageClassSpecifier)
+        return specifiers->option == 0;
+
+    if (specifiers->rule != Rule::DeclarationSpecifiers)
+        return false;
+
+    for (const ParseNode *child = specifiers->child; child != nullptr; child = child->next)
+    {
+        if (hasTypedef(child))
+            return true;
+    }
+
+    return false;
+}
+
+
+//
+// Declare the identifier a declarator declares, or those of a list of
+// declarators.
+//
+
+static void declareNames(TypeNames &typeNames, const ParseNode *node, const PpTokenStream &tokens, bool typedefName)
+{
+    while (node != nullptr)
+    {
+        switch (node->rule)
+        {
+        case Rule::Identifier:
+            typeNames.declare(tokens.text(node->token), typedefName);
+            return;
+
+        case Rule::InitDeclaratorList:
+            for (const ParseNode *child = node->child; child != nullptr; child = child->next)
+            {
+                declareNames(typeNames, child, tokens, typedefName);
+            }
+            return;
+
+        case Rule::Declarator:
+            // A pointer then the direct declarator.
+            node = node->child->next;
+            break;
+
+        case Rule::InitDeclarator:
+        case Rule::DirectDeclarator:
+            node = node->child;
+            break;
+
+        default:
+            return;
+        }
+    }
+}
+
+
+//
+// Declare the names of a declaration or an external declaration. The
+// children after the declaration specifiers are declarators, and in an
+// external declaration the initializers of the first ones too, which
+// come after an '='. A function definition only declares the function.
+//
+
+void TypeNames::declare(const ParseNode *declaration, const PpTokenStream &tokens)
+{
+    if ((declaration->rule != Rule::Declaration && declaration->rule != Rule::ExternalDeclaration) || declaration->child == nullptr)
+        return;
+
+    bool typedefName = hasTypedef(declaration->child);
+    for (const ParseNode *child = declaration->child->next; child != nullptr; child = child->next)
+    {
+        if (tokens.punctuator(child->token - 1) != Punctuator::Equal)
+        {
+            declareNames(*this, child, tokens, typedefName);
+        }
+
+        if (declaration->rule == Rule::ExternalDeclaration && declaration->option != 0)
+            break;
+    }
+}
+
+
+void TypeNames::pushScope()
+{
+    Scope *scope = freeScopes_;
+    if (scope != nullptr)
+    {
+        freeScopes_ = scope->outer;
+    }
+    else
+    {
+        scope = static_cast<Scope *>(arena_.allocate(sizeof(Scope), alignof(Scope)));
+    }
+
+    *scope = Scope{ nullptr, scope_ };
+    scope_ = scope;
+}
+
+
+//
+// Restore what the names declared in the scope were, latest first.
+//
+
+void TypeNames::popScope()
+{
+    Scope *scope = scope_;
+    Shadow *shadow = scope->shadows;
+    while (shadow != nullptr)
+    {
+        Shadow *next = shadow->next;
+        shadow->entry->typedefName = shadow->typedefName;
+        shadow->next = freeShadows_;
+        freeShadows_ = shadow;
+        shadow = next;
+    }
+
+    scope_ = scope->outer;
+    scope->outer = freeScopes_;
+    freeScopes_ = scope;
+}
+
+
+} // namespace deepC
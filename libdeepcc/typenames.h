@@ -0,0 +1,94 @@
+#ifndef DEEPC_TYPENAMES_H
+#define DEEPC_TYPENAMES_H
+
+#include <cstddef>
+#include <cstdint>
+#include <string_view>
+
+#include "arena.h"
+
+
+namespace deepC
+{
+
+
+// Forward declarations.
+class PpTokenStream;
+struct ParseNode;
+
+
+//
+// The typedef names in scope while parsing. The parser needs them to tell
+// a typedef name from other identifiers, as "T * x;" declares x if T is a
+// typedef name and is a multiplication otherwise.
+//
+// Names are kept in a hash table. Declaring a name in a scope remembers
+// what it was before so that's restored at the end of the scope. Names
+// are only added when they're declared as typedefs, so declaring other
+// identifiers costs nothing unless they hide a typedef. Everything is
+// allocated in an arena, and what a scope used is reused by later ones.
+//
+
+class TypeNames
+{
+private:
+    struct Entry
+    {
+        std::string_view text;
+        uint32_t         hash;
+        bool             typedefName;
+        Entry           *next;
+    };
+
+    // What a name was before a scope declared it.
+    struct Shadow
+    {
+        Entry  *entry;
+        bool    typedefName;
+        Shadow *next;
+    };
+
+    struct Scope
+    {
+        Shadow *shadows;
+        Scope  *outer;
+    };
+
+    static constexpr size_t initialBuckets = 256;
+
+    Arena  &arena_;
+    Entry **buckets_;
+    size_t  numBuckets_;
+    size_t  count_;
+    Scope  *scope_;
+    Scope  *freeScopes_;
+    Shadow *freeShadows_;
+
+    static uint32_t hash(std::string_view text);
+    Entry          *find(std::string_view text, uint32_t hash) const;
+    void            grow();
+
+public:
+    explicit TypeNames(Arena &arena);
+    TypeNames(const TypeNames &) = delete;
+    TypeNames &operator=(const TypeNames &) = delete;
+
+    // Check if an identifier is a typedef name.
+    bool isTypedefName(std::string_view text) const;
+
+    // Declare an identifier as a typedef name or something else. Its text
+    // must last as long as the TypeNames.
+    void declare(std::string_view text, bool typedefName);
+
+    // Declare the names a declaration declares.
+    void declare(const ParseNode *declaration, const PpTokenStream &tokens);
+
+    // Scopes. Names declared in a scope are forgotten at its end.
+    void pushScope();
+    void popScope();
+};
+
+
+} // namespace deepC
+
+#endif // DEEPC_TYPENAMES_H
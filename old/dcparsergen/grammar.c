@@ -90,6 +90,7 @@ bool GrammarRead(Grammar *grammar, const char *fileName)
         grammar->lineNo++;
     }
     
+    fclose(srcFile);
     return true;
 
 grErrExit:
@@ -130,7 +131,8 @@ bool GrammarParseDefinition(Grammar *grammar, char *line)
     char *pos = line;
     def->name = GrammarParseIdentifier(&pos);
 
-    // There should only be a colon after the identifier.
+    // There should only be a colon after the identifier. Some definitions
+    // in the standard use a double colon.
     SkipWhitespace(&pos);
     if (*pos != ':')
     {
@@ -139,6 +141,11 @@ bool GrammarParseDefinition(Grammar *grammar, char *line)
     }
 
     pos++;
+    if (*pos == ':')
+    {
+        pos++;
+    }
+
     if (*pos != 0)
     {
         AllocSprintf(&grammar->errMsg, "unexpected text after definition, line %d", grammar->lineNo);
@@ -193,8 +200,14 @@ bool GrammarParseOption(Grammar *grammar, char *line)
 
     // Parse the items.
     bool ok = false;
-    while (GrammarParseItem(grammar, opt, &pos, &ok))
+    while (GrammarParseItem(grammar, &opt->firstItem, &opt->lastItem, &pos, &ok))
+    {
+    }
+
+    if (ok && *pos != 0)
     {
+        AllocSprintf(&grammar->errMsg, "unexpected ']' in line %d", grammar->lineNo);
+        ok = false;
     }
 
     return ok;
@@ -202,16 +215,17 @@ bool GrammarParseOption(Grammar *grammar, char *line)
 
 
 //
-// Parse a single item and add it to an option.
+// Parse a single item and add it to a list of items. Returns false at the
+// end of the line or a closing square bracket, or on error.
 //
 
-bool GrammarParseItem(Grammar *grammar, GrammarOption *option, char **pos, bool *ok)
+bool GrammarParseItem(Grammar *grammar, GrammarItem **firstItem, GrammarItem **lastItem, char **pos, bool *ok)
 {
     *ok = true;
 
-    // Are we at the end of the line?
+    // Are we at the end of the line or the end of an optional group?
     SkipWhitespace(pos);
-    if (**pos == 0)
+    if (**pos == 0 || **pos == ']')
     {
         // There are no more items.
         return false;
@@ -222,43 +236,49 @@ bool GrammarParseItem(Grammar *grammar, GrammarOption *option, char **pos, bool
     if (item == NULL)
     {
         AllocSprintf(&grammar->errMsg, "out of memory");
+        *ok = false;
         return false;
     }
 
-    // Add it to the end of the list.
-    if (option->firstItem == NULL)
-    {
-        option->firstItem = item;
-        option->lastItem = item;
-    }
-    else
-    {
-        option->lastItem->nextItem = item;
-        option->lastItem = item;
-    }
-
     item->nextItem = NULL;
-    item->repeated = false;
+    item->optional = false;
     item->definitionName = NULL;
     item->token = NULL;
     item->charSet = NULL;
+    item->group = NULL;
+    item->symbol = 0;
 
-    // Is it repeated?
-    bool repeated = false;
+    // What kind of token is next?
     char ch = **pos;
-    if (ch == '[')
+    switch (ch)
+    {
+    case '[':
     {
-        repeated = true;
+        // An optional group of items.
         (*pos)++;
-    }
+        item->optional = true;
 
-    // What kind of token is next?
-    switch (ch)
-    {
-    case 0:
-        AllocSprintf(&grammar->errMsg, "missing item after '[' in line %d\n", grammar->lineNo);
-        *ok = false;
+        GrammarItem *lastInGroup = NULL;
+        while (GrammarParseItem(grammar, &item->group, &lastInGroup, pos, ok))
+        {
+        }
+
+        if (*ok && item->group == NULL)
+        {
+            AllocSprintf(&grammar->errMsg, "missing item after '[' in line %d", grammar->lineNo);
+            *ok = false;
+        }
+        else if (*ok && **pos != ']')
+        {
+            AllocSprintf(&grammar->errMsg, "expected closing ']' after optional term in line %d", grammar->lineNo);
+            *ok = false;
+        }
+        else if (*ok)
+        {
+            (*pos)++;
+        }
         break;
+    }
 
     case '\'':
         *ok = GrammarParseString(grammar, item, pos);
@@ -277,31 +297,31 @@ bool GrammarParseItem(Grammar *grammar, GrammarOption *option, char **pos, bool
         else
         {
             // It's something unknown.
-            AllocSprintf(&grammar->errMsg, "unknown character in line %d\n", grammar->lineNo);
+            AllocSprintf(&grammar->errMsg, "unknown character in line %d", grammar->lineNo);
             *ok = false;
         }
         break;
     }
 
-    // If it was repeated, make sure we have a closing square bracket.
-    if (repeated)
-    {
-        if (**pos != ']')
-        {
-            AllocSprintf(&grammar->errMsg, "expected closing ']' after repeated term in line %d\n", grammar->lineNo);
-            *ok = false;
-        }
-
-        item->repeated = true;
-    }
-
     // If we're failing out deallocate the item.
     if (!*ok)
     {
-        free(item);
+        GrammarFreeItems(item);
         return false;
     }
 
+    // Add it to the end of the list.
+    if (*firstItem == NULL)
+    {
+        *firstItem = item;
+        *lastItem = item;
+    }
+    else
+    {
+        (*lastItem)->nextItem = item;
+        *lastItem = item;
+    }
+
     return true;
 }
 
@@ -316,7 +336,7 @@ char *GrammarParseIdentifier(char **pos)
 {
     char *startPos = *pos;
 
-    while (isalnum(**pos))
+    while (isalnum(**pos) || **pos == '_' || **pos == '-')
     {
         (*pos)++;
     }
@@ -404,11 +424,19 @@ bool GrammarParseCharSet(Grammar *grammar, GrammarItem *item, char **pos)
         memset(charSet, 0, sizeof(charSet));
     }
 
-    // Add/remove each of the specified characters.
+    // Add/remove each of the specified characters or ranges of characters.
     int ch;
     while (**pos != '}' && **pos != 0 && GrammarParseCharacter(pos, &ch))
     {
-        if (ch < MAX_CHARSET)
+        int lastCh = ch;
+        if (**pos == '-' && (*pos)[1] != '}' && (*pos)[1] != 0)
+        {
+            (*pos)++;
+            if (!GrammarParseCharacter(pos, &lastCh))
+                break;
+        }
+
+        for (; ch <= lastCh && ch < MAX_CHARSET; ch++)
         {
             if (positiveSet)
             {
@@ -447,17 +475,30 @@ bool GrammarParseCharSet(Grammar *grammar, GrammarItem *item, char **pos)
 
 bool GrammarParseCharacter(char **pos, int *ch)
 {
-    *ch = **pos;
+    *ch = (unsigned char)**pos;
 
     switch (*ch)
     {
     case '\\':
         // An escaped character.
         (*pos)++;
-        *ch = **pos;
+        *ch = (unsigned char)**pos;
+        if (*ch == 0)
+            return false;
+
+        (*pos)++;
         switch (*ch)
         {
-        case 0: return false;
+        case 'x':
+            // A hex character code.
+            *ch = 0;
+            while (isxdigit(**pos))
+            {
+                *ch = *ch * 16 + (isdigit(**pos) ? **pos - '0' : tolower(**pos) - 'a' + 10);
+                (*pos)++;
+            }
+            break;
+
         case 'a': *ch = '\a'; break;
         case 'b': *ch = '\b'; break;
         case 'e': *ch = '\e'; break;
@@ -471,8 +512,7 @@ bool GrammarParseCharacter(char **pos, int *ch)
         break;
 
     case '\'':
-        // End of string.
-        (*pos)++;
+        // End of string. The caller skips the quote.
         return false;
 
     case 0:
@@ -503,6 +543,7 @@ void GrammarFreeDefinitions(GrammarDefinition *def)
         
         FreeStr(&def->name);
         GrammarFreeOptions(def->firstOption);
+        free(def);
         
         def = next;
     }
@@ -517,6 +558,7 @@ void GrammarFreeOptions(GrammarOption *opt)
         GrammarOption *next = opt->nextOption;
         
         GrammarFreeItems(opt->firstItem);
+        free(opt);
         
         opt = next;
     }
@@ -537,7 +579,36 @@ void GrammarFreeItems(GrammarItem *item)
         {
             free(item->charSet);
         }
+
+        GrammarFreeItems(item->group);
+        free(item);
         
         item = next;
     }
 }
+
+
+//
+// Find a definition by name. Returns NULL if there isn't one.
+//
+
+GrammarDefinition *GrammarFindDefinition(Grammar *grammar, const char *name)
+{
+    for (GrammarDefinition *def = grammar->firstDef; def != NULL; def = def->nextDefinition)
+    {
+        if (strcmp(def->name, name) == 0)
+            return def;
+    }
+
+    return NULL;
+}
+
+
+//
+// Check if a character is in a character set.
+//
+
+bool GrammarCharSetHas(const uint8_t *charSet, int ch)
+{
+    return (charSet[ch/8] & (1<<(ch%8))) != 0;
+}
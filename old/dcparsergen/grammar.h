@@ -24,6 +24,7 @@ struct _GrammarDefinition
     char              *name;
     GrammarOption     *firstOption;
     GrammarOption     *lastOption;
+    bool               expanding;      // Used by generators to detect recursion.
 };
 
 
@@ -46,16 +47,19 @@ struct _GrammarOption
 // An item from an option.
 //
 // Each option can be the name of a definition or a token or
-// a set of characters to match on.
+// a set of characters to match on. Items in square brackets are
+// optional and are gathered into a group.
 //
 
 struct _GrammarItem
 {
     GrammarItem *nextItem;
-    bool         repeated;
+    bool         optional;
     char        *definitionName;
     char        *token;
     uint8_t     *charSet;
+    GrammarItem *group;
+    int          symbol;        // Used by generators for what it refers to.
 };
 
 
@@ -83,7 +87,7 @@ const char *GrammarGetError(Grammar *grammar);
 // Internal prototypes.
 bool GrammarParseDefinition(Grammar *grammar, char *line);
 bool GrammarParseOption(Grammar *grammar, char *line);
-bool GrammarParseItem(Grammar *grammar, GrammarOption *option, char **pos, bool *err);
+bool GrammarParseItem(Grammar *grammar, GrammarItem **firstItem, GrammarItem **lastItem, char **pos, bool *err);
 char *GrammarParseIdentifier(char **pos);
 bool GrammarParseString(Grammar *grammar, GrammarItem *item, char **pos);
 bool GrammarParseCharacter(char **pos, int *ch);
@@ -91,5 +95,7 @@ bool GrammarParseCharSet(Grammar *grammar, GrammarItem *item, char **pos);
 void GrammarFreeDefinitions(GrammarDefinition *def);
 void GrammarFreeOptions(GrammarOption *opt);
 void GrammarFreeItems(GrammarItem *item);
+GrammarDefinition *GrammarFindDefinition(Grammar *grammar, const char *name);
+bool GrammarCharSetHas(const uint8_t *charSet, int ch);
 
 #endif // GRAMMAR_H
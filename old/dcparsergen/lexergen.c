@@ -1,9 +1,29 @@
+#include <stdio.h>
+#include <stdlib.h>
 #include <string.h>
+#include <ctype.h>
 
 #include "lexergen.h"
 #include "util.h"
 
 
+//
+// A piece of the non-deterministic automaton with a single start and
+// end state. The end state has no transitions out of it yet.
+//
+
+typedef struct
+{
+    int start;
+    int end;
+} LexFragment;
+
+
+// Internal prototypes.
+static bool LexerGenBuildItems(LexerGen *lgen, GrammarItem *first, GrammarItem *last, LexFragment *frag);
+static bool LexerGenBuildDefinition(LexerGen *lgen, const char *name, LexFragment *frag);
+
+
 void LexerGenInit(LexerGen *lgen)
 {
     memset(lgen, 0, sizeof(*lgen));
@@ -15,6 +35,9 @@ void LexerGenClose(LexerGen *lgen)
 {
     GrammarClose(&lgen->grammar);
     FreeStr(&lgen->errMsg);
+    free(lgen->nfa);
+    free(lgen->dfa.transitions);
+    free(lgen->dfa.accept);
 }
 
 bool LexerGenReadGrammar(LexerGen *lgen, const char *fileName)
@@ -24,7 +47,7 @@ bool LexerGenReadGrammar(LexerGen *lgen, const char *fileName)
         lgen->errMsg = strdup(GrammarGetError(&lgen->grammar));
         return false;
     }
-    
+
     return true;
 }
 
@@ -32,3 +55,1141 @@ const char *LexerGenGetError(LexerGen *lgen)
 {
     return lgen->errMsg;
 }
+
+
+//
+// Add a new state to the non-deterministic automaton.
+//
+
+static int LexerGenNewState(LexerGen *lgen)
+{
+    if (lgen->nfaSize == lgen->nfaCapacity)
+    {
+        lgen->nfaCapacity = lgen->nfaCapacity ? lgen->nfaCapacity * 2 : 1024;
+        lgen->nfa = realloc(lgen->nfa, lgen->nfaCapacity * sizeof(LexNfaState));
+        if (lgen->nfa == NULL)
+        {
+            fprintf(stderr, "out of memory\n");
+            exit(EXIT_FAILURE);
+        }
+    }
+
+    LexNfaState *state = &lgen->nfa[lgen->nfaSize];
+    memset(state, 0, sizeof(*state));
+    state->out1 = -1;
+    state->out2 = -1;
+    state->next = -1;
+
+    return lgen->nfaSize++;
+}
+
+
+//
+// Add an epsilon transition.
+//
+
+static void LexerGenEpsilon(LexerGen *lgen, int from, int to)
+{
+    LexNfaState *state = &lgen->nfa[from];
+    if (state->out1 < 0)
+    {
+        state->out1 = to;
+    }
+    else
+    {
+        state->out2 = to;
+    }
+}
+
+
+//
+// Make a fragment which matches nothing.
+//
+
+static LexFragment LexerGenEmpty(LexerGen *lgen)
+{
+    LexFragment frag;
+    frag.start = LexerGenNewState(lgen);
+    frag.end = frag.start;
+
+    return frag;
+}
+
+
+//
+// Make a fragment which matches a single character from a set.
+//
+
+static LexFragment LexerGenCharSet(LexerGen *lgen, const uint8_t *charSet)
+{
+    LexFragment frag;
+    frag.start = LexerGenNewState(lgen);
+    frag.end = LexerGenNewState(lgen);
+    lgen->nfa[frag.start].next = frag.end;
+    memcpy(lgen->nfa[frag.start].charSet, charSet, sizeof(lgen->nfa[frag.start].charSet));
+
+    return frag;
+}
+
+
+//
+// Make a fragment which matches one fragment followed by another.
+//
+
+static LexFragment LexerGenConcat(LexerGen *lgen, LexFragment a, LexFragment b)
+{
+    LexerGenEpsilon(lgen, a.end, b.start);
+
+    LexFragment frag;
+    frag.start = a.start;
+    frag.end = b.end;
+
+    return frag;
+}
+
+
+//
+// Make a fragment which matches any one of a number of fragments.
+//
+
+static LexFragment LexerGenAlternatives(LexerGen *lgen, LexFragment *alts, int numAlts)
+{
+    if (numAlts == 1)
+        return alts[0];
+
+    LexFragment frag;
+    frag.start = LexerGenNewState(lgen);
+    frag.end = LexerGenNewState(lgen);
+
+    // Each state can only split two ways so chain them together.
+    int split = frag.start;
+    for (int i = 0; i < numAlts; i++)
+    {
+        if (i < numAlts - 2)
+        {
+            int nextSplit = LexerGenNewState(lgen);
+            LexerGenEpsilon(lgen, split, alts[i].start);
+            LexerGenEpsilon(lgen, split, nextSplit);
+            split = nextSplit;
+        }
+        else
+        {
+            LexerGenEpsilon(lgen, split, alts[i].start);
+        }
+
+        LexerGenEpsilon(lgen, alts[i].end, frag.end);
+    }
+
+    return frag;
+}
+
+
+//
+// Make a fragment which matches zero or more of a fragment.
+//
+
+static LexFragment LexerGenStar(LexerGen *lgen, LexFragment a)
+{
+    LexFragment frag;
+    frag.start = LexerGenNewState(lgen);
+    frag.end = LexerGenNewState(lgen);
+    LexerGenEpsilon(lgen, frag.start, a.start);
+    LexerGenEpsilon(lgen, frag.start, frag.end);
+    LexerGenEpsilon(lgen, a.end, a.start);
+    LexerGenEpsilon(lgen, a.end, frag.end);
+
+    return frag;
+}
+
+
+//
+// Make a fragment which matches zero or one of a fragment.
+//
+
+static LexFragment LexerGenOptional(LexerGen *lgen, LexFragment a)
+{
+    LexFragment frag;
+    frag.start = LexerGenNewState(lgen);
+    frag.end = LexerGenNewState(lgen);
+    LexerGenEpsilon(lgen, frag.start, a.start);
+    LexerGenEpsilon(lgen, frag.start, frag.end);
+    LexerGenEpsilon(lgen, a.end, frag.end);
+
+    return frag;
+}
+
+
+//
+// Build a fragment for a single grammar item.
+//
+
+static bool LexerGenBuildItem(LexerGen *lgen, GrammarItem *item, LexFragment *frag)
+{
+    if (item->optional)
+    {
+        LexFragment group;
+        if (!LexerGenBuildItems(lgen, item->group, NULL, &group))
+            return false;
+
+        *frag = LexerGenOptional(lgen, group);
+    }
+    else if (item->token)
+    {
+        // A sequence of characters.
+        *frag = LexerGenEmpty(lgen);
+        for (const char *pos = item->token; *pos != 0; pos++)
+        {
+            uint8_t charSet[32];
+            int ch = (unsigned char)*pos;
+            memset(charSet, 0, sizeof(charSet));
+            charSet[ch/8] = 1<<(ch%8);
+            *frag = LexerGenConcat(lgen, *frag, LexerGenCharSet(lgen, charSet));
+        }
+    }
+    else if (item->charSet)
+    {
+        *frag = LexerGenCharSet(lgen, item->charSet);
+    }
+    else
+    {
+        return LexerGenBuildDefinition(lgen, item->definitionName, frag);
+    }
+
+    return true;
+}
+
+
+//
+// Build a fragment for a sequence of items, stopping before "last".
+//
+
+static bool LexerGenBuildItems(LexerGen *lgen, GrammarItem *first, GrammarItem *last, LexFragment *frag)
+{
+    *frag = LexerGenEmpty(lgen);
+    for (GrammarItem *item = first; item != last; item = item->nextItem)
+    {
+        LexFragment itemFrag;
+        if (!LexerGenBuildItem(lgen, item, &itemFrag))
+            return false;
+
+        *frag = LexerGenConcat(lgen, *frag, itemFrag);
+    }
+
+    return true;
+}
+
+
+//
+// Check if an item refers to a given definition.
+//
+
+static bool LexerGenIsReference(GrammarItem *item, GrammarDefinition *def)
+{
+    return item != NULL && !item->optional && item->definitionName != NULL && strcmp(item->definitionName, def->name) == 0;
+}
+
+
+//
+// Build a fragment for a definition. The definitions in the lexical
+// grammar are regular apart from definitions which refer to themselves
+// at the start or the end of an option, like:
+//
+//     identifier:
+//         identifier-nondigit
+//         identifier digit
+//
+// These become a repetition: identifier-nondigit followed by any number
+// of digits. Any other recursion is an error.
+//
+
+static bool LexerGenBuildDefinition(LexerGen *lgen, const char *name, LexFragment *frag)
+{
+    GrammarDefinition *def = GrammarFindDefinition(&lgen->grammar, name);
+    if (def == NULL)
+    {
+        AllocSprintf(&lgen->errMsg, "undefined definition '%s'", name);
+        return false;
+    }
+
+    if (def->expanding)
+    {
+        AllocSprintf(&lgen->errMsg, "'%s' is recursive in a way which isn't regular", name);
+        return false;
+    }
+
+    def->expanding = true;
+
+    // Sort the options into ones which start with this definition, ones
+    // which end with it and the rest.
+    int numOptions = 0;
+    for (GrammarOption *opt = def->firstOption; opt != NULL; opt = opt->nextOption)
+    {
+        numOptions++;
+    }
+
+    LexFragment *bases = calloc(numOptions, sizeof(LexFragment));
+    LexFragment *tails = calloc(numOptions, sizeof(LexFragment));
+    LexFragment *heads = calloc(numOptions, sizeof(LexFragment));
+    int numBases = 0;
+    int numTails = 0;
+    int numHeads = 0;
+    bool ok = true;
+
+    for (GrammarOption *opt = def->firstOption; opt != NULL && ok; opt = opt->nextOption)
+    {
+        if (LexerGenIsReference(opt->firstItem, def) && opt->firstItem != opt->lastItem)
+        {
+            // Left recursive - what follows can repeat.
+            ok = LexerGenBuildItems(lgen, opt->firstItem->nextItem, NULL, &tails[numTails++]);
+        }
+        else if (LexerGenIsReference(opt->lastItem, def) && opt->firstItem != opt->lastItem)
+        {
+            // Right recursive - what precedes can repeat.
+            ok = LexerGenBuildItems(lgen, opt->firstItem, opt->lastItem, &heads[numHeads++]);
+        }
+        else
+        {
+            ok = LexerGenBuildItems(lgen, opt->firstItem, NULL, &bases[numBases++]);
+        }
+    }
+
+    if (ok && numBases == 0)
+    {
+        AllocSprintf(&lgen->errMsg, "'%s' never stops recursing", name);
+        ok = false;
+    }
+
+    if (ok && numTails > 0 && numHeads > 0)
+    {
+        AllocSprintf(&lgen->errMsg, "'%s' is both left and right recursive", name);
+        ok = false;
+    }
+
+    if (ok)
+    {
+        *frag = LexerGenAlternatives(lgen, bases, numBases);
+        if (numTails > 0)
+        {
+            *frag = LexerGenConcat(lgen, *frag, LexerGenStar(lgen, LexerGenAlternatives(lgen, tails, numTails)));
+        }
+
+        if (numHeads > 0)
+        {
+            *frag = LexerGenConcat(lgen, LexerGenStar(lgen, LexerGenAlternatives(lgen, heads, numHeads)), *frag);
+        }
+    }
+
+    free(bases);
+    free(tails);
+    free(heads);
+    def->expanding = false;
+
+    return ok;
+}
+
+
+//
+// Bit sets of NFA states.
+//
+
+typedef uint64_t LexSetWord;
+
+static int LexerGenSetWords(LexerGen *lgen)
+{
+    return (lgen->nfaSize + 63) / 64;
+}
+
+static bool LexerGenSetHas(const LexSetWord *set, int state)
+{
+    return (set[state / 64] >> (state % 64)) & 1;
+}
+
+static void LexerGenSetAdd(LexSetWord *set, int state)
+{
+    set[state / 64] |= (LexSetWord)1 << (state % 64);
+}
+
+
+//
+// Add all the states reachable by epsilon transitions to a set.
+//
+
+static void LexerGenClosure(LexerGen *lgen, LexSetWord *set, int *stack)
+{
+    int sp = 0;
+    for (int state = 0; state < lgen->nfaSize; state++)
+    {
+        if (LexerGenSetHas(set, state))
+        {
+            stack[sp++] = state;
+        }
+    }
+
+    while (sp > 0)
+    {
+        LexNfaState *state = &lgen->nfa[stack[--sp]];
+        int outs[2] = { state->out1, state->out2 };
+        for (int i = 0; i < 2; i++)
+        {
+            if (outs[i] >= 0 && !LexerGenSetHas(set, outs[i]))
+            {
+                LexerGenSetAdd(set, outs[i]);
+                stack[sp++] = outs[i];
+            }
+        }
+    }
+}
+
+
+//
+// Work out which bytes the NFA can't tell apart. These share a class so
+// the DFA only needs one transition for each class.
+//
+
+static int LexerGenNfaClasses(LexerGen *lgen, uint8_t *byteClass, int *classRep)
+{
+    int words = LexerGenSetWords(lgen);
+    LexSetWord *columns = calloc(256 * words, sizeof(LexSetWord));
+    for (int ch = 0; ch < 256; ch++)
+    {
+        for (int state = 0; state < lgen->nfaSize; state++)
+        {
+            if (lgen->nfa[state].next >= 0 && GrammarCharSetHas(lgen->nfa[state].charSet, ch))
+            {
+                LexerGenSetAdd(&columns[ch * words], state);
+            }
+        }
+    }
+
+    int numClasses = 0;
+    for (int ch = 0; ch < 256; ch++)
+    {
+        int cls;
+        for (cls = 0; cls < numClasses; cls++)
+        {
+            if (memcmp(&columns[ch * words], &columns[classRep[cls] * words], words * sizeof(LexSetWord)) == 0)
+                break;
+        }
+
+        if (cls == numClasses)
+        {
+            classRep[numClasses++] = ch;
+        }
+
+        byteClass[ch] = cls;
+    }
+
+    free(columns);
+    return numClasses;
+}
+
+
+//
+// Convert the NFA to a DFA using the subset construction.
+//
+
+static bool LexerGenSubsets(LexerGen *lgen, LexDfa *dfa)
+{
+    int words = LexerGenSetWords(lgen);
+    int classRep[256];
+    dfa->numClasses = LexerGenNfaClasses(lgen, dfa->byteClass, classRep);
+
+    int capacity = 256;
+    LexSetWord *sets = calloc(capacity * words, sizeof(LexSetWord));
+    dfa->transitions = calloc(capacity * dfa->numClasses, sizeof(int));
+    dfa->accept = calloc(capacity, sizeof(int));
+    int *stack = calloc(lgen->nfaSize, sizeof(int));
+    LexSetWord *moved = calloc(words, sizeof(LexSetWord));
+
+    // State 0 is the empty set, state 1 is the start.
+    dfa->numStates = 2;
+    LexerGenSetAdd(&sets[1 * words], lgen->nfaStart);
+    LexerGenClosure(lgen, &sets[1 * words], stack);
+
+    for (int from = 0; from < dfa->numStates; from++)
+    {
+        // Is it accepting? The earliest root wins.
+        for (int state = 0; state < lgen->nfaSize; state++)
+        {
+            int accept = lgen->nfa[state].accept;
+            if (accept && LexerGenSetHas(&sets[from * words], state) && (dfa->accept[from] == 0 || accept < dfa->accept[from]))
+            {
+                dfa->accept[from] = accept;
+            }
+        }
+
+        for (int cls = 0; cls < dfa->numClasses; cls++)
+        {
+            // Where can we get to on this class of character?
+            memset(moved, 0, words * sizeof(LexSetWord));
+            for (int state = 0; state < lgen->nfaSize; state++)
+            {
+                LexNfaState *nfaState = &lgen->nfa[state];
+                if (nfaState->next >= 0 && LexerGenSetHas(&sets[from * words], state) && GrammarCharSetHas(nfaState->charSet, classRep[cls]))
+                {
+                    LexerGenSetAdd(moved, nfaState->next);
+                }
+            }
+
+            LexerGenClosure(lgen, moved, stack);
+
+            // Have we seen this set before?
+            int to;
+            for (to = 0; to < dfa->numStates; to++)
+            {
+                if (memcmp(&sets[to * words], moved, words * sizeof(LexSetWord)) == 0)
+                    break;
+            }
+
+            if (to == dfa->numStates)
+            {
+                // It's a new state.
+                if (dfa->numStates == capacity)
+                {
+                    capacity *= 2;
+                    sets = realloc(sets, capacity * words * sizeof(LexSetWord));
+                    dfa->transitions = realloc(dfa->transitions, capacity * dfa->numClasses * sizeof(int));
+                    dfa->accept = realloc(dfa->accept, capacity * sizeof(int));
+                }
+
+                memcpy(&sets[to * words], moved, words * sizeof(LexSetWord));
+                dfa->accept[to] = 0;
+                dfa->numStates++;
+            }
+
+            dfa->transitions[from * dfa->numClasses + cls] = to;
+        }
+    }
+
+    free(moved);
+    free(stack);
+    free(sets);
+
+    return true;
+}
+
+
+//
+// Minimise a DFA by repeatedly splitting groups of states until states
+// in the same group always go to the same groups. Then merge the byte
+// classes which the minimised DFA treats the same.
+//
+
+static void LexerGenMinimise(LexDfa *dfa, LexDfa *min)
+{
+    int numStates = dfa->numStates;
+    int numClasses = dfa->numClasses;
+    int *group = calloc(numStates, sizeof(int));
+    int *newGroup = calloc(numStates, sizeof(int));
+    int *rep = calloc(numStates, sizeof(int));
+
+    // Start by grouping on what each state accepts.
+    for (int state = 0; state < numStates; state++)
+    {
+        group[state] = dfa->accept[state];
+    }
+
+    int numGroups = 0;
+    for (;;)
+    {
+        // Split groups where the transitions differ.
+        int count = 0;
+        for (int state = 0; state < numStates; state++)
+        {
+            int g;
+            for (g = 0; g < count; g++)
+            {
+                int other = rep[g];
+                if (group[other] != group[state])
+                    continue;
+
+                int cls;
+                for (cls = 0; cls < numClasses; cls++)
+                {
+                    if (group[dfa->transitions[state * numClasses + cls]] != group[dfa->transitions[other * numClasses + cls]])
+                        break;
+                }
+
+                if (cls == numClasses)
+                    break;
+            }
+
+            if (g == count)
+            {
+                rep[count++] = state;
+            }
+
+            newGroup[state] = g;
+        }
+
+        memcpy(group, newGroup, numStates * sizeof(int));
+        if (count == numGroups)
+            break;
+
+        numGroups = count;
+    }
+
+    // Number the groups in the order they're reached from the start,
+    // keeping the dead state as 0 and the start as 1.
+    int *order = malloc(numGroups * sizeof(int));
+    int *queue = malloc(numGroups * sizeof(int));
+    for (int g = 0; g < numGroups; g++)
+    {
+        order[g] = -1;
+    }
+
+    int numOrdered = 0;
+    order[group[0]] = numOrdered++;
+    int head = 0;
+    int tail = 0;
+    if (order[group[1]] < 0)
+    {
+        order[group[1]] = numOrdered++;
+        queue[tail++] = group[1];
+    }
+
+    while (head < tail)
+    {
+        int g = queue[head++];
+        for (int cls = 0; cls < numClasses; cls++)
+        {
+            int to = group[dfa->transitions[rep[g] * numClasses + cls]];
+            if (order[to] < 0)
+            {
+                order[to] = numOrdered++;
+                queue[tail++] = to;
+            }
+        }
+    }
+
+    // Merge byte classes with identical columns.
+    int classMap[256];
+    int numMinClasses = 0;
+    for (int cls = 0; cls < numClasses; cls++)
+    {
+        int other;
+        for (other = 0; other < cls; other++)
+        {
+            int g;
+            for (g = 0; g < numGroups; g++)
+            {
+                if (group[dfa->transitions[rep[g] * numClasses + cls]] != group[dfa->transitions[rep[g] * numClasses + other]])
+                    break;
+            }
+
+            if (g == numGroups)
+                break;
+        }
+
+        classMap[cls] = (other < cls) ? classMap[other] : numMinClasses++;
+    }
+
+    // Build the minimised DFA from the reachable groups.
+    min->numStates = numOrdered;
+    min->numClasses = numMinClasses;
+    min->transitions = calloc(numOrdered * numMinClasses, sizeof(int));
+    min->accept = calloc(numOrdered, sizeof(int));
+    for (int ch = 0; ch < 256; ch++)
+    {
+        min->byteClass[ch] = classMap[dfa->byteClass[ch]];
+    }
+
+    for (int g = 0; g < numGroups; g++)
+    {
+        int state = order[g];
+        if (state < 0)
+            continue;
+
+        min->accept[state] = dfa->accept[rep[g]];
+        for (int cls = 0; cls < numClasses; cls++)
+        {
+            min->transitions[state * numMinClasses + classMap[cls]] = order[group[dfa->transitions[rep[g] * numClasses + cls]]];
+        }
+    }
+
+    free(queue);
+    free(order);
+    free(rep);
+    free(newGroup);
+    free(group);
+}
+
+
+//
+// Generate a minimised DFA which recognises the given definitions. If
+// more than one matches the same text the earliest one wins.
+//
+
+bool LexerGenGenerate(LexerGen *lgen, const char **rootNames, int numRoots)
+{
+    lgen->rootNames = rootNames;
+    lgen->numRoots = numRoots;
+
+    // Build an NFA for each root.
+    LexFragment *roots = calloc(numRoots, sizeof(LexFragment));
+    for (int i = 0; i < numRoots; i++)
+    {
+        if (!LexerGenBuildDefinition(lgen, rootNames[i], &roots[i]))
+        {
+            free(roots);
+            return false;
+        }
+
+        lgen->nfa[roots[i].end].accept = i + 1;
+    }
+
+    // Join them together.
+    lgen->nfaStart = LexerGenAlternatives(lgen, roots, numRoots).start;
+    free(roots);
+
+    // Convert to a DFA and minimise it.
+    LexDfa dfa;
+    memset(&dfa, 0, sizeof(dfa));
+    if (!LexerGenSubsets(lgen, &dfa))
+        return false;
+
+    LexerGenMinimise(&dfa, &lgen->dfa);
+    free(dfa.transitions);
+    free(dfa.accept);
+
+    return true;
+}
+
+
+//
+// Convert a definition name like "pp-number" to a C++ style name like
+// "PpNumber".
+//
+
+void LexerGenCamelCase(const char *name, char *buf, size_t bufSize)
+{
+    size_t len = 0;
+    bool upper = true;
+    for (const char *pos = name; *pos != 0 && len + 1 < bufSize; pos++)
+    {
+        if (*pos == '-' || *pos == '_')
+        {
+            upper = true;
+        }
+        else
+        {
+            buf[len++] = upper ? toupper(*pos) : *pos;
+            upper = false;
+        }
+    }
+
+    buf[len] = 0;
+}
+
+
+//
+// The names used for each punctuation character when naming punctuators.
+// A punctuator's name is the names of its characters joined together, so
+// "->" is "MinusGreater".
+//
+
+static const char *LexerGenCharName(char ch)
+{
+    switch (ch)
+    {
+    case '[':   return "LeftBracket";
+    case ']':   return "RightBracket";
+    case '(':   return "LeftParen";
+    case ')':   return "RightParen";
+    case '{':   return "LeftBrace";
+    case '}':   return "RightBrace";
+    case '.':   return "Dot";
+    case '-':   return "Minus";
+    case '+':   return "Plus";
+    case '>':   return "Greater";
+    case '<':   return "Less";
+    case '&':   return "Amp";
+    case '*':   return "Star";
+    case '~':   return "Tilde";
+    case '!':   return "Exclaim";
+    case '/':   return "Slash";
+    case '%':   return "Percent";
+    case '=':   return "Equal";
+    case '^':   return "Caret";
+    case '|':   return "Pipe";
+    case '?':   return "Question";
+    case ':':   return "Colon";
+    case ';':   return "Semi";
+    case ',':   return "Comma";
+    case '#':   return "Hash";
+    default:    return NULL;
+    }
+}
+
+
+//
+// Make an enumerator name for a word. Words which start with a letter or
+// underscore are camel cased, anything else is named after its characters.
+//
+
+bool LexerGenWordName(const char *word, char *buf, size_t bufSize)
+{
+    if (isalpha((unsigned char)word[0]) || word[0] == '_')
+    {
+        LexerGenCamelCase(word, buf, bufSize);
+        return true;
+    }
+
+    buf[0] = 0;
+    for (const char *pos = word; *pos != 0; pos++)
+    {
+        const char *name = LexerGenCharName(*pos);
+        if (name == NULL || strlen(buf) + strlen(name) + 1 > bufSize)
+            return false;
+
+        strcat(buf, name);
+    }
+
+    return true;
+}
+
+
+//
+// Get the words in a definition where every option is a single token,
+// like "keyword" or "punctuator".
+//
+
+static bool LexerGenWordList(LexerGen *lgen, const char *defName, const char ***words, int *numWords)
+{
+    GrammarDefinition *def = GrammarFindDefinition(&lgen->grammar, defName);
+    if (def == NULL)
+    {
+        AllocSprintf(&lgen->errMsg, "can't find definition '%s'", defName);
+        return false;
+    }
+
+    int count = 0;
+    for (GrammarOption *opt = def->firstOption; opt != NULL; opt = opt->nextOption)
+    {
+        count++;
+    }
+
+    *words = calloc(count, sizeof(const char *));
+    *numWords = 0;
+    for (GrammarOption *opt = def->firstOption; opt != NULL; opt = opt->nextOption)
+    {
+        GrammarItem *item = opt->firstItem;
+        if (item == NULL || item->nextItem != NULL || item->token == NULL || item->token[0] == 0 || item->optional)
+        {
+            AllocSprintf(&lgen->errMsg, "every option of '%s' should be a single token", defName);
+            free(*words);
+            return false;
+        }
+
+        (*words)[(*numWords)++] = item->token;
+    }
+
+    return true;
+}
+
+
+//
+// The hash used to look words up. It mixes the first two characters, the
+// last character and the length. The generated C++ does exactly the same.
+//
+
+static uint32_t LexerGenWordHash(const char *word, const uint32_t *mult, int bits)
+{
+    size_t len = strlen(word);
+    uint32_t x = (uint32_t)(uint8_t)word[0] * mult[0] +
+                 (uint32_t)(uint8_t)(len > 1 ? word[1] : 0) * mult[1] +
+                 (uint32_t)(uint8_t)word[len - 1] * mult[2] +
+                 (uint32_t)len * mult[3];
+
+    return (x * 0x9e3779b1u) >> (32 - bits);
+}
+
+
+//
+// Search for multipliers which give every word a different slot in a
+// table of 2^bits slots. Returns false if there aren't any.
+//
+
+static bool LexerGenFindWordHash(const char **words, int numWords, int bits, uint32_t *mult)
+{
+    int size = 1 << bits;
+    uint8_t *used = malloc(size);
+    uint32_t seed = 12345;
+    bool found = false;
+
+    for (int attempt = 0; attempt < 1000000 && !found; attempt++)
+    {
+        // A simple LCG so the tables come out the same every time.
+        for (int i = 0; i < 4; i++)
+        {
+            seed = seed * 1103515245u + 12345u;
+            mult[i] = (seed >> 8) | 1;
+        }
+
+        memset(used, 0, size);
+        found = true;
+        for (int i = 0; i < numWords && found; i++)
+        {
+            uint32_t slot = LexerGenWordHash(words[i], mult, bits);
+            found = !used[slot];
+            used[slot] = 1;
+        }
+    }
+
+    free(used);
+    return found;
+}
+
+
+//
+// Write a perfect hash of the words in a definition, as an enum and a
+// constexpr function to find a word. Finding a word costs one hash, one
+// table lookup and one comparison.
+//
+
+static bool LexerGenWritePerfectHash(LexerGen *lgen, FILE *out, const char *defName)
+{
+    const char **words;
+    int numWords;
+    if (!LexerGenWordList(lgen, defName, &words, &numWords))
+        return false;
+
+    if (numWords > 255)
+    {
+        AllocSprintf(&lgen->errMsg, "too many words in '%s' to hash", defName);
+        free(words);
+        return false;
+    }
+
+    // Use the smallest table we can find a perfect hash for.
+    int bits = 1;
+    while ((1 << bits) < numWords)
+    {
+        bits++;
+    }
+
+    uint32_t mult[4];
+    int maxBits = bits + 3;
+    while (bits <= maxBits && !LexerGenFindWordHash(words, numWords, bits, mult))
+    {
+        bits++;
+    }
+
+    if (bits > maxBits)
+    {
+        AllocSprintf(&lgen->errMsg, "can't find a perfect hash for '%s'", defName);
+        free(words);
+        return false;
+    }
+
+    size_t minLen = strlen(words[0]);
+    size_t maxLen = minLen;
+    for (int i = 1; i < numWords; i++)
+    {
+        size_t len = strlen(words[i]);
+        minLen = len < minLen ? len : minLen;
+        maxLen = len > maxLen ? len : maxLen;
+    }
+
+    char type[256];
+    char lower[256];
+    char name[256];
+    LexerGenCamelCase(defName, type, sizeof(type));
+    snprintf(lower, sizeof(lower), "%s", type);
+    lower[0] = tolower(lower[0]);
+
+    // The enum.
+    fprintf(out, "//\n");
+    fprintf(out, "// Each %s, found with find%s().\n", defName, type);
+    fprintf(out, "//\n\n");
+    fprintf(out, "enum class %s : uint8_t\n{\n    None = 0", type);
+    for (int i = 0; i < numWords; i++)
+    {
+        if (!LexerGenWordName(words[i], name, sizeof(name)))
+        {
+            AllocSprintf(&lgen->errMsg, "can't name '%s' in '%s'", words[i], defName);
+            free(words);
+            return false;
+        }
+
+        fprintf(out, ",\n    %s", name);
+    }
+
+    fprintf(out, "\n};\n\n");
+    fprintf(out, "static constexpr int      num%ss = %d;\n", type, numWords);
+    fprintf(out, "static constexpr int      %sHashBits = %d;\n", lower, bits);
+    fprintf(out, "static constexpr size_t   %sMinLength = %d;\n", lower, (int)minLen);
+    fprintf(out, "static constexpr size_t   %sMaxLength = %d;\n\n", lower, (int)maxLen);
+
+    // The hash function.
+    fprintf(out, "static constexpr uint32_t %sHash(const char *s, size_t len)\n{\n", lower);
+    fprintf(out, "    return ((uint8_t(s[0]) * %uu + uint8_t(len > 1 ? s[1] : 0) * %uu +\n", mult[0], mult[1]);
+    fprintf(out, "             uint8_t(s[len - 1]) * %uu + uint32_t(len) * %uu) * 0x9e3779b1u) >> (32 - %sHashBits);\n", mult[2], mult[3], lower);
+    fprintf(out, "}\n\n");
+
+    // Which word is in each slot.
+    int size = 1 << bits;
+    uint8_t *slots = calloc(size, 1);
+    for (int i = 0; i < numWords; i++)
+    {
+        slots[LexerGenWordHash(words[i], mult, bits)] = i + 1;
+    }
+
+    fprintf(out, "static constexpr uint8_t %sSlots[1 << %sHashBits] =\n{", lower, lower);
+    for (int slot = 0; slot < size; slot++)
+    {
+        fprintf(out, "%s%2d,", (slot % 16 == 0) ? "\n    " : " ", slots[slot]);
+    }
+
+    fprintf(out, "\n};\n\n");
+    free(slots);
+
+    // The text of each word.
+    fprintf(out, "static constexpr const char *%sText[num%ss + 1] =\n{\n    \"\"", lower, type);
+    for (int i = 0; i < numWords; i++)
+    {
+        fprintf(out, ",\n    \"%s\"", words[i]);
+    }
+
+    fprintf(out, "\n};\n\n");
+    fprintf(out, "static constexpr uint8_t %sLength[num%ss + 1] =\n{\n    0", lower, type);
+    for (int i = 0; i < numWords; i++)
+    {
+        fprintf(out, ",%s%d", (i % 16 == 15) ? "\n    " : " ", (int)strlen(words[i]));
+    }
+
+    fprintf(out, "\n};\n\n");
+
+    // The lookup function.
+    fprintf(out, "static constexpr %s find%s(const char *s, size_t len)\n{\n", type, type);
+    fprintf(out, "    if (len < %sMinLength || len > %sMaxLength)\n", lower, lower);
+    fprintf(out, "        return %s::None;\n\n", type);
+    fprintf(out, "    uint8_t i = %sSlots[%sHash(s, len)];\n", lower, lower);
+    fprintf(out, "    if (i == 0 || %sLength[i] != len || std::char_traits<char>::compare(%sText[i], s, len) != 0)\n", lower, lower);
+    fprintf(out, "        return %s::None;\n\n", type);
+    fprintf(out, "    return static_cast<%s>(i);\n", type);
+    fprintf(out, "}\n\n");
+
+    // Check every word at compile time.
+    for (int i = 0; i < numWords; i++)
+    {
+        LexerGenWordName(words[i], name, sizeof(name));
+        fprintf(out, "static_assert(find%s(\"%s\", %d) == %s::%s, \"%s hash\");\n", type, words[i], (int)strlen(words[i]), type, name, defName);
+    }
+
+    fprintf(out, "\n\n");
+    free(words);
+
+    return true;
+}
+
+
+//
+// Write the DFA out as C++ tables.
+//
+
+bool LexerGenWriteTables(LexerGen *lgen, const char *fileName, const char **hashNames, int numHashNames)
+{
+    LexDfa *dfa = &lgen->dfa;
+    FILE *out = fopen(fileName, "w");
+    if (out == NULL)
+    {
+        AllocSprintf(&lgen->errMsg, "can't create '%s'", fileName);
+        return false;
+    }
+
+    const char *stateType = dfa->numStates <= 256 ? "uint8_t" : "uint16_t";
+    char name[256];
+
+    fprintf(out, "//\n");
+    fprintf(out, "// Lexer tables generated by dcparsergen from %s. Don't edit.\n", lgen->grammar.fileName);
+    fprintf(out, "//\n");
+    fprintf(out, "// A minimised DFA with %d states and %d byte classes. State 0 is the\n", dfa->numStates, dfa->numClasses);
+    fprintf(out, "// dead state, which never accepts, and state 1 is the start state.\n");
+    fprintf(out, "// The next state is transitions[state * numClasses + byteClass[ch]].\n");
+    fprintf(out, "//\n");
+    fprintf(out, "// Keywords and punctuators are identified after the DFA has matched\n");
+    fprintf(out, "// them, using a perfect hash.\n");
+    fprintf(out, "//\n\n");
+    fprintf(out, "#ifndef DEEPC_CLEXERTABLES_H\n");
+    fprintf(out, "#define DEEPC_CLEXERTABLES_H\n\n");
+    fprintf(out, "#include <cstddef>\n");
+    fprintf(out, "#include <cstdint>\n");
+    fprintf(out, "#include <string>\n\n\n");
+    fprintf(out, "namespace deepC\n{\nnamespace lexTables\n{\n\n\n");
+
+    // What each state accepts.
+    fprintf(out, "enum Accept : uint8_t\n{\n    AcceptNone = 0");
+    for (int i = 0; i < lgen->numRoots; i++)
+    {
+        LexerGenCamelCase(lgen->rootNames[i], name, sizeof(name));
+        fprintf(out, ",\n    Accept%s = %d", name, i + 1);
+    }
+
+    fprintf(out, "\n};\n\n");
+    fprintf(out, "typedef %s State;\n\n", stateType);
+    fprintf(out, "static constexpr int   numStates = %d;\n", dfa->numStates);
+    fprintf(out, "static constexpr int   numClasses = %d;\n", dfa->numClasses);
+    fprintf(out, "static constexpr State deadState = 0;\n");
+    fprintf(out, "static constexpr State startState = 1;\n\n");
+
+    // The byte classes.
+    fprintf(out, "static constexpr uint8_t byteClass[256] =\n{");
+    for (int ch = 0; ch < 256; ch++)
+    {
+        fprintf(out, "%s%3d,", (ch % 16 == 0) ? "\n    " : " ", dfa->byteClass[ch]);
+    }
+
+    fprintf(out, "\n};\n\n");
+
+    // The transitions.
+    fprintf(out, "static constexpr State transitions[numStates * numClasses] =\n{\n");
+    for (int state = 0; state < dfa->numStates; state++)
+    {
+        fprintf(out, "    /* %3d */", state);
+        for (int cls = 0; cls < dfa->numClasses; cls++)
+        {
+            if (cls > 0 && cls % 16 == 0)
+            {
+                fprintf(out, "\n             ");
+            }
+
+            fprintf(out, " %3d,", dfa->transitions[state * dfa->numClasses + cls]);
+        }
+
+        fprintf(out, "\n");
+    }
+
+    fprintf(out, "};\n\n");
+
+    // The accepting states.
+    fprintf(out, "static constexpr uint8_t accepting[numStates] =\n{");
+    for (int state = 0; state < dfa->numStates; state++)
+    {
+        fprintf(out, "%s%d,", (state % 16 == 0) ? "\n    " : " ", dfa->accept[state]);
+    }
+
+    fprintf(out, "\n};\n\n\n");
+
+    // Perfect hashes of fixed sets of words.
+    for (int i = 0; i < numHashNames; i++)
+    {
+        if (!LexerGenWritePerfectHash(lgen, out, hashNames[i]))
+        {
+            fclose(out);
+            return false;
+        }
+    }
+
+    fprintf(out, "} // namespace lexTables\n");
+    fprintf(out, "} // namespace deepC\n\n");
+    fprintf(out, "#endif // DEEPC_CLEXERTABLES_H\n");
+
+    if (fclose(out) != 0)
+    {
+        AllocSprintf(&lgen->errMsg, "can't write '%s'", fileName);
+        return false;
+    }
+
+    return true;
+}
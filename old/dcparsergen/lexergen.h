@@ -2,19 +2,70 @@
 #define LEXERGEN_H
 
 #include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
 
 #include "grammar.h"
 
-typedef struct 
+
+//
+// A state in the non-deterministic automaton built from the grammar.
+// Each state has up to two epsilon transitions and one transition on a
+// set of characters.
+//
+
+typedef struct
+{
+    int     out1;           // Epsilon transitions, or -1.
+    int     out2;
+    int     next;           // Transition on a character in charSet, or -1.
+    uint8_t charSet[32];
+    int     accept;         // Token number + 1 if this state accepts, otherwise 0.
+} LexNfaState;
+
+
+//
+// A deterministic automaton. State 0 is the dead state which never
+// accepts and state 1 is the start state.
+//
+
+typedef struct
+{
+    int      numStates;
+    int      numClasses;
+    uint8_t  byteClass[256];    // Which class each byte is in.
+    int     *transitions;       // numStates * numClasses next states.
+    int     *accept;            // Token number + 1 for each state, or 0.
+} LexDfa;
+
+
+typedef struct
 {
     Grammar grammar;
     char *errMsg;
+
+    // The token definitions to recognise, in priority order.
+    const char **rootNames;
+    int          numRoots;
+
+    // The automata.
+    LexNfaState *nfa;
+    int          nfaSize;
+    int          nfaCapacity;
+    int          nfaStart;
+    LexDfa       dfa;
 } LexerGen;
 
 // Prototypes.
 void LexerGenInit(LexerGen *lgen);
 void LexerGenClose(LexerGen *lgen);
 bool LexerGenReadGrammar(LexerGen *lgen, const char *fileName);
+bool LexerGenGenerate(LexerGen *lgen, const char **rootNames, int numRoots);
+bool LexerGenWriteTables(LexerGen *lgen, const char *fileName, const char **hashNames, int numHashNames);
 const char *LexerGenGetError(LexerGen *lgen);
 
+// Naming, which the parser generator shares.
+void LexerGenCamelCase(const char *name, char *buf, size_t bufSize);
+bool LexerGenWordName(const char *word, char *buf, size_t bufSize);
+
 #endif // LEXERGEN_H
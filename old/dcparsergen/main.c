@@ -1,10 +1,59 @@
 #include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
 
 #include "lexergen.h"
 #include "parsergen.h"
 
 
+// The preprocessing tokens the C lexer recognises with its DFA, in order
+// of priority. Whitespace and comments are handled by the lexer itself,
+// and header names depend on context so the preprocessor handles them.
+static const char *lexerRoots[] =
+{
+    "identifier",
+    "pp-number",
+    "character-constant",
+    "string-literal",
+    "punctuator"
+};
+
+// Definitions which are a fixed set of words. The lexer looks these up
+// with a perfect hash once the DFA has matched them.
+static const char *lexerHashed[] =
+{
+    "keyword",
+    "punctuator"
+};
+
+// Tokens from the lexical grammar which the parser sees as terminals.
+// typedef-name is defined in the syntax grammar, but it's a terminal as
+// the parser looks identifiers up to see if they're typedef names.
+static const ParserGenToken parserTokens[] =
+{
+    { "identifier",             "Identifier" },
+    { "enumeration-constant",   "Identifier" },
+    { "typedef-name",           "TypedefName" },
+    { "constant",               "Constant" },
+    { "string-literal",         "StringLiteral" }
+};
+
+// Where typedef names go out of scope, and what declares them.
+static const char *parserScopes[] =
+{
+    "compound-statement",
+    "selection-statement",
+    "iteration-statement"
+};
+
+static const char *parserDeclarations[] =
+{
+    "declaration",
+    "external-declaration"
+};
+
+
 //
 // The main program.
 //
@@ -12,30 +61,82 @@
 int main(int argc, char **argv)
 {
     // Check args.
-    if (argc != 3)
+    const char *lexerTablesFile = NULL;
+    const char *parserFile = NULL;
+    const char *parserRulesFile = NULL;
+    int opt;
+    while ((opt = getopt(argc, argv, "l:p:r:")) != -1)
     {
-        fprintf(stderr, "Format: %s <lexical.pgen> <syntax.pgen>\n", argv[0]);
+        switch (opt)
+        {
+        case 'l':
+            lexerTablesFile = optarg;
+            break;
+
+        case 'p':
+            parserFile = optarg;
+            break;
+
+        case 'r':
+            parserRulesFile = optarg;
+            break;
+
+        default:
+            fprintf(stderr, "Format: %s [-l <lexer-tables.h>] [-p <parser.cpp> -r <parse-rules.h>] <lexical.pgen> [<syntax.pgen>]\n", argv[0]);
+            exit(EXIT_FAILURE);
+        }
+    }
+
+    if (optind >= argc || argc - optind > 2 || (parserFile != NULL) != (parserRulesFile != NULL) ||
+        (parserFile != NULL && argc - optind != 2))
+    {
+        fprintf(stderr, "Format: %s [-l <lexer-tables.h>] [-p <parser.cpp> -r <parse-rules.h>] <lexical.pgen> [<syntax.pgen>]\n", argv[0]);
         exit(EXIT_FAILURE);
     }
 
     // Invoke the lexer generator.
     LexerGen lgen;
     LexerGenInit(&lgen);
-    if (!LexerGenReadGrammar(&lgen, argv[1]))
+    if (!LexerGenReadGrammar(&lgen, argv[optind]))
     {
         fprintf(stderr, "%s\n", LexerGenGetError(&lgen));
         exit(EXIT_FAILURE);
     }
+
+    if (lexerTablesFile != NULL)
+    {
+        if (!LexerGenGenerate(&lgen, lexerRoots, sizeof(lexerRoots) / sizeof(lexerRoots[0])) ||
+            !LexerGenWriteTables(&lgen, lexerTablesFile, lexerHashed, sizeof(lexerHashed) / sizeof(lexerHashed[0])))
+        {
+            fprintf(stderr, "%s\n", LexerGenGetError(&lgen));
+            LexerGenClose(&lgen);
+            exit(EXIT_FAILURE);
+        }
+    }
     
     // Invoke the parser generator.
     ParserGen pgen;
     ParserGenInit(&pgen);
-    if (!ParserGenReadGrammar(&pgen, argv[2]))
+    if (optind + 1 < argc && !ParserGenReadGrammar(&pgen, argv[optind + 1]))
     {
         fprintf(stderr, "%s\n", ParserGenGetError(&pgen));
         LexerGenClose(&lgen);
         exit(EXIT_FAILURE);
     }
+
+    if (parserFile != NULL)
+    {
+        if (!ParserGenGenerate(&pgen, &lgen.grammar, "translation-unit", parserTokens, sizeof(parserTokens) / sizeof(parserTokens[0])) ||
+            !ParserGenSetHooks(&pgen, parserScopes, sizeof(parserScopes) / sizeof(parserScopes[0]),
+                               parserDeclarations, sizeof(parserDeclarations) / sizeof(parserDeclarations[0])) ||
+            !ParserGenWriteParser(&pgen, parserFile, parserRulesFile))
+        {
+            fprintf(stderr, "%s\n", ParserGenGetError(&pgen));
+            ParserGenClose(&pgen);
+            LexerGenClose(&lgen);
+            exit(EXIT_FAILURE);
+        }
+    }
     
     // Clean up.
     ParserGenClose(&pgen);
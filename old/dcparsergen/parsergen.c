@@ -1,10 +1,70 @@
+#include <ctype.h>
+#include <stdarg.h>
 #include <stdlib.h>
 #include <string.h>
 
+#include "lexergen.h"
 #include "parsergen.h"
 #include "util.h"
 
 
+// What items refer to: terminals are positive and definitions negative.
+#define PARSERGEN_TERMINAL(t)   ((t) + 1)
+#define PARSERGEN_RULE(r)       (-(r) - 1)
+
+
+//
+// An alternative which the parser chooses between: what's left of an
+// option. The exit alternative of a loop leaves it.
+//
+
+typedef struct
+{
+    GrammarItem **items;
+    int           count;
+    int           option;
+    bool          exit;
+} ParserGenAlt;
+
+
+//
+// Alternatives which start with the same item, or which are empty, and
+// what they can start with.
+//
+
+typedef struct
+{
+    GrammarItem  *first;
+    ParserGenAlt *alts;
+    int           numAlts;
+    ParserGenSet  la;
+} ParserGenGroup;
+
+
+//
+// How far along its option the parser is: how many children it has and
+// how many other tokens it's matched.
+//
+
+typedef struct
+{
+    int children;
+    int tokens;
+} ParserGenPath;
+
+
+//
+// The function code is being written for.
+//
+
+typedef struct
+{
+    int                 rule;
+    bool                loop;       // Whether it's choosing between the tails of a loop.
+    const ParserGenSet *cont;       // What follows the alternatives.
+} ParserGenContext;
+
+
 void ParserGenInit(ParserGen *pgen)
 {
     memset(pgen, 0, sizeof(*pgen));
@@ -13,8 +73,27 @@ void ParserGenInit(ParserGen *pgen)
 }
 
 
+static void ParserGenSetFree(ParserGenSet *set);
+
 void ParserGenClose(ParserGen *pgen)
 {
+    for (int t = 0; t < pgen->numTerminals; t++)
+    {
+        FreeStr(&pgen->terminals[t].label);
+        FreeStr(&pgen->terminals[t].spelling);
+        FreeStr(&pgen->terminals[t].leafRule);
+    }
+
+    for (int r = 0; r < pgen->numRules; r++)
+    {
+        FreeStr(&pgen->rules[r].name);
+        ParserGenSetFree(&pgen->rules[r].first);
+        ParserGenSetFree(&pgen->rules[r].follow);
+        ParserGenSetFree(&pgen->rules[r].exit);
+    }
+
+    free(pgen->terminals);
+    free(pgen->rules);
     GrammarClose(&pgen->grammar);
     FreeStr(&pgen->errMsg);
 }
@@ -27,7 +106,7 @@ bool ParserGenReadGrammar(ParserGen *pgen, const char *fileName)
         pgen->errMsg = strdup(GrammarGetError(&pgen->grammar));
         return false;
     }
-    
+
     return true;
 }
 
@@ -36,3 +115,1679 @@ const char *ParserGenGetError(ParserGen *pgen)
 {
     return pgen->errMsg;
 }
+
+
+//
+// Sets of strings of terminals.
+//
+
+static bool ParserGenBit(const uint64_t *words, int i)
+{
+    return (words[i / 64] >> (i % 64)) & 1;
+}
+
+
+static void ParserGenSetBit(uint64_t *words, int i)
+{
+    words[i / 64] |= (uint64_t)1 << (i % 64);
+}
+
+
+static uint64_t *ParserGenRow(ParserGen *pgen, const ParserGenSet *set, int t)
+{
+    return set->pairs + (size_t)t * pgen->setWords;
+}
+
+
+static bool ParserGenRowEmpty(ParserGen *pgen, const ParserGenSet *set, int t)
+{
+    const uint64_t *row = ParserGenRow(pgen, set, t);
+    for (int w = 0; w < pgen->setWords; w++)
+    {
+        if (row[w] != 0)
+            return false;
+    }
+
+    return true;
+}
+
+
+static void ParserGenSetInit(ParserGen *pgen, ParserGenSet *set)
+{
+    set->empty = false;
+    set->singles = calloc(pgen->setWords, sizeof(uint64_t));
+    set->pairs = calloc((size_t)pgen->numTerminals * pgen->setWords, sizeof(uint64_t));
+}
+
+
+static void ParserGenSetFree(ParserGenSet *set)
+{
+    free(set->singles);
+    free(set->pairs);
+    set->singles = NULL;
+    set->pairs = NULL;
+}
+
+
+static void ParserGenSetClear(ParserGen *pgen, ParserGenSet *set)
+{
+    set->empty = false;
+    memset(set->singles, 0, pgen->setWords * sizeof(uint64_t));
+    memset(set->pairs, 0, (size_t)pgen->numTerminals * pgen->setWords * sizeof(uint64_t));
+}
+
+
+static void ParserGenSetCopy(ParserGen *pgen, ParserGenSet *to, const ParserGenSet *from)
+{
+    to->empty = from->empty;
+    memcpy(to->singles, from->singles, pgen->setWords * sizeof(uint64_t));
+    memcpy(to->pairs, from->pairs, (size_t)pgen->numTerminals * pgen->setWords * sizeof(uint64_t));
+}
+
+
+//
+// Add one set to another, returning whether it changed.
+//
+
+static bool ParserGenSetUnion(ParserGen *pgen, ParserGenSet *to, const ParserGenSet *from)
+{
+    bool changed = from->empty && !to->empty;
+    to->empty = to->empty || from->empty;
+
+    for (int w = 0; w < pgen->setWords; w++)
+    {
+        changed = changed || (from->singles[w] & ~to->singles[w]) != 0;
+        to->singles[w] |= from->singles[w];
+    }
+
+    size_t numPairWords = (size_t)pgen->numTerminals * pgen->setWords;
+    for (size_t w = 0; w < numPairWords; w++)
+    {
+        changed = changed || (from->pairs[w] & ~to->pairs[w]) != 0;
+        to->pairs[w] |= from->pairs[w];
+    }
+
+    return changed;
+}
+
+
+//
+// Make the set of strings of one set followed by another, cut to two
+// terminals.
+//
+
+static void ParserGenSetConcat(ParserGen *pgen, const ParserGenSet *a, const ParserGenSet *b, ParserGenSet *result)
+{
+    ParserGenSetClear(pgen, result);
+    result->empty = a->empty && b->empty;
+
+    size_t numPairWords = (size_t)pgen->numTerminals * pgen->setWords;
+    memcpy(result->pairs, a->pairs, numPairWords * sizeof(uint64_t));
+    if (a->empty)
+    {
+        for (size_t w = 0; w < numPairWords; w++)
+        {
+            result->pairs[w] |= b->pairs[w];
+        }
+
+        memcpy(result->singles, b->singles, pgen->setWords * sizeof(uint64_t));
+    }
+
+    // What b starts with follows each of a's singles.
+    uint64_t *firstOfB = calloc(pgen->setWords, sizeof(uint64_t));
+    memcpy(firstOfB, b->singles, pgen->setWords * sizeof(uint64_t));
+    for (int t = 0; t < pgen->numTerminals; t++)
+    {
+        if (!ParserGenRowEmpty(pgen, b, t))
+        {
+            ParserGenSetBit(firstOfB, t);
+        }
+    }
+
+    for (int t = 0; t < pgen->numTerminals; t++)
+    {
+        if (!ParserGenBit(a->singles, t))
+            continue;
+
+        uint64_t *row = ParserGenRow(pgen, result, t);
+        for (int w = 0; w < pgen->setWords; w++)
+        {
+            row[w] |= firstOfB[w];
+        }
+
+        if (b->empty)
+        {
+            ParserGenSetBit(result->singles, t);
+        }
+    }
+
+    free(firstOfB);
+}
+
+
+//
+// Terminals.
+//
+
+static int ParserGenAddTerminal(ParserGen *pgen, const char *label, const char *spelling, const char *leafRule)
+{
+    for (int t = 0; t < pgen->numTerminals; t++)
+    {
+        if (strcmp(pgen->terminals[t].label, label) == 0)
+            return t;
+    }
+
+    pgen->terminals = realloc(pgen->terminals, (pgen->numTerminals + 1) * sizeof(ParserGenTerminal));
+    ParserGenTerminal *terminal = &pgen->terminals[pgen->numTerminals];
+    terminal->label = strdup(label);
+    terminal->spelling = strdup(spelling);
+    terminal->leafRule = leafRule != NULL ? strdup(leafRule) : NULL;
+
+    return pgen->numTerminals++;
+}
+
+
+static int ParserGenFindTerminal(ParserGen *pgen, const char *label)
+{
+    for (int t = 0; t < pgen->numTerminals; t++)
+    {
+        if (strcmp(pgen->terminals[t].label, label) == 0)
+            return t;
+    }
+
+    return -1;
+}
+
+
+//
+// Check if a word is one of the options of a definition in the lexical
+// grammar, like "keyword".
+//
+
+static bool ParserGenIsWord(Grammar *lexical, const char *defName, const char *word)
+{
+    GrammarDefinition *def = GrammarFindDefinition(lexical, defName);
+    if (def == NULL)
+        return false;
+
+    for (GrammarOption *opt = def->firstOption; opt != NULL; opt = opt->nextOption)
+    {
+        GrammarItem *item = opt->firstItem;
+        if (item != NULL && item->token != NULL && strcmp(item->token, word) == 0)
+            return true;
+    }
+
+    return false;
+}
+
+
+//
+// Get the terminal for a keyword or punctuator, checking the lexer knows
+// it.
+//
+
+static bool ParserGenWordTerminal(ParserGen *pgen, Grammar *lexical, const char *word, int *terminal)
+{
+    bool keyword = isalpha((unsigned char)word[0]) || word[0] == '_';
+    if (!ParserGenIsWord(lexical, keyword ? "keyword" : "punctuator", word))
+    {
+        AllocSprintf(&pgen->errMsg, "'%s' isn't a %s in the lexical grammar", word, keyword ? "keyword" : "punctuator");
+        return false;
+    }
+
+    char name[256];
+    char label[300];
+    char spelling[300];
+    if (!LexerGenWordName(word, name, sizeof(name)))
+    {
+        AllocSprintf(&pgen->errMsg, "can't name '%s'", word);
+        return false;
+    }
+
+    snprintf(label, sizeof(label), keyword ? "keyword(Keyword::%s)" : "punctuator(Punctuator::%s)", name);
+    snprintf(spelling, sizeof(spelling), "'%s'", word);
+    *terminal = ParserGenAddTerminal(pgen, label, spelling, NULL);
+
+    return true;
+}
+
+
+//
+// Definitions.
+//
+
+static int ParserGenFindRule(ParserGen *pgen, const char *name)
+{
+    for (int r = 0; r < pgen->numRules; r++)
+    {
+        if (strcmp(pgen->rules[r].def->name, name) == 0)
+            return r;
+    }
+
+    return -1;
+}
+
+
+static const ParserGenToken *ParserGenFindToken(const char *name, const ParserGenToken *tokens, int numTokens)
+{
+    for (int i = 0; i < numTokens; i++)
+    {
+        if (strcmp(tokens[i].name, name) == 0)
+            return &tokens[i];
+    }
+
+    return NULL;
+}
+
+
+//
+// Work out what each item refers to. A name which isn't a definition is
+// a token the parser sees as a terminal or, unquoted, a keyword.
+//
+
+static bool ParserGenResolve(ParserGen *pgen, Grammar *lexical, GrammarItem *item, const ParserGenToken *tokens, int numTokens)
+{
+    for (; item != NULL; item = item->nextItem)
+    {
+        int terminal;
+        if (item->optional)
+        {
+            if (!ParserGenResolve(pgen, lexical, item->group, tokens, numTokens))
+                return false;
+        }
+        else if (item->token != NULL)
+        {
+            if (!ParserGenWordTerminal(pgen, lexical, item->token, &terminal))
+                return false;
+
+            item->symbol = PARSERGEN_TERMINAL(terminal);
+        }
+        else if (item->definitionName != NULL)
+        {
+            const ParserGenToken *token = ParserGenFindToken(item->definitionName, tokens, numTokens);
+            int r = ParserGenFindRule(pgen, item->definitionName);
+            if (token != NULL)
+            {
+                item->symbol = PARSERGEN_TERMINAL(ParserGenFindTerminal(pgen, token->terminal));
+            }
+            else if (r >= 0)
+            {
+                item->symbol = PARSERGEN_RULE(r);
+            }
+            else if (ParserGenIsWord(lexical, "keyword", item->definitionName))
+            {
+                if (!ParserGenWordTerminal(pgen, lexical, item->definitionName, &terminal))
+                    return false;
+
+                item->symbol = PARSERGEN_TERMINAL(terminal);
+            }
+            else
+            {
+                AllocSprintf(&pgen->errMsg, "undefined definition '%s'", item->definitionName);
+                return false;
+            }
+        }
+        else
+        {
+            AllocSprintf(&pgen->errMsg, "character sets can't be used in the syntax grammar");
+            return false;
+        }
+    }
+
+    return true;
+}
+
+
+static void ParserGenMarkUsed(ParserGen *pgen, GrammarItem *item)
+{
+    for (; item != NULL; item = item->nextItem)
+    {
+        if (item->optional)
+        {
+            ParserGenMarkUsed(pgen, item->group);
+        }
+        else if (item->symbol < 0 && !pgen->rules[PARSERGEN_RULE(item->symbol)].used)
+        {
+            ParserGenRule *rule = &pgen->rules[PARSERGEN_RULE(item->symbol)];
+            rule->used = true;
+            for (GrammarOption *opt = rule->def->firstOption; opt != NULL; opt = opt->nextOption)
+            {
+                ParserGenMarkUsed(pgen, opt->firstItem);
+            }
+        }
+    }
+}
+
+
+//
+// Check if an option of a definition is left recursive, like:
+//
+//     postfix-expression '++'
+//     [direct-abstract-declarator] '(' [parameter-type-list] ')'
+//
+// Returns 0 if it's a base, 1 if it's a tail, and 2 if it's both, as an
+// optional reference to itself can be left out.
+//
+
+static int ParserGenLeftRecursive(GrammarOption *opt, int r)
+{
+    GrammarItem *item = opt->firstItem;
+    if (item == NULL)
+        return 0;
+
+    if (!item->optional && item->symbol == PARSERGEN_RULE(r))
+        return 1;
+
+    if (item->optional && item->group->nextItem == NULL && item->group->symbol == PARSERGEN_RULE(r))
+        return 2;
+
+    return 0;
+}
+
+
+//
+// Get the items of a list as an array, which must be freed.
+//
+
+static GrammarItem **ParserGenItemArray(GrammarItem *first, int *count)
+{
+    *count = 0;
+    for (GrammarItem *item = first; item != NULL; item = item->nextItem)
+    {
+        (*count)++;
+    }
+
+    GrammarItem **items = calloc(*count + 1, sizeof(GrammarItem *));
+    int i = 0;
+    for (GrammarItem *item = first; item != NULL; item = item->nextItem)
+    {
+        items[i++] = item;
+    }
+
+    return items;
+}
+
+
+static void ParserGenItemsFirst(ParserGen *pgen, GrammarItem **items, int count, const ParserGenSet *cont, ParserGenSet *result);
+
+//
+// Make the set of strings an item followed by a set can start with.
+//
+
+static void ParserGenItemFirst(ParserGen *pgen, GrammarItem *item, const ParserGenSet *cont, ParserGenSet *result)
+{
+    if (item->optional)
+    {
+        int count;
+        GrammarItem **items = ParserGenItemArray(item->group, &count);
+        ParserGenItemsFirst(pgen, items, count, cont, result);
+        ParserGenSetUnion(pgen, result, cont);
+        free(items);
+    }
+    else if (item->symbol < 0)
+    {
+        ParserGenSetConcat(pgen, &pgen->rules[PARSERGEN_RULE(item->symbol)].first, cont, result);
+    }
+    else
+    {
+        ParserGenSet single;
+        ParserGenSetInit(pgen, &single);
+        ParserGenSetBit(single.singles, item->symbol - 1);
+        ParserGenSetConcat(pgen, &single, cont, result);
+        ParserGenSetFree(&single);
+    }
+}
+
+
+//
+// Make the set of strings some items followed by a set can start with.
+//
+
+static void ParserGenItemsFirst(ParserGen *pgen, GrammarItem **items, int count, const ParserGenSet *cont, ParserGenSet *result)
+{
+    ParserGenSet next;
+    ParserGenSetInit(pgen, &next);
+    ParserGenSetCopy(pgen, result, cont);
+    for (int i = count - 1; i >= 0; i--)
+    {
+        ParserGenItemFirst(pgen, items[i], result, &next);
+        ParserGenSetCopy(pgen, result, &next);
+    }
+
+    ParserGenSetFree(&next);
+}
+
+
+//
+// Add what follows each definition in some items to what can follow it.
+// For the exit sets, definitions which start options of themselves don't
+// count, so they're what follows a loop from outside it.
+//
+
+static bool ParserGenItemsFollow(ParserGen *pgen, int r, GrammarItem **items, int count, const ParserGenSet *cont, bool leading, bool exits)
+{
+    bool changed = false;
+    ParserGenSet after;
+    ParserGenSet next;
+    ParserGenSetInit(pgen, &after);
+    ParserGenSetInit(pgen, &next);
+    ParserGenSetCopy(pgen, &after, cont);
+
+    for (int i = count - 1; i >= 0; i--)
+    {
+        GrammarItem *item = items[i];
+        if (item->optional)
+        {
+            int groupCount;
+            GrammarItem **group = ParserGenItemArray(item->group, &groupCount);
+            changed = ParserGenItemsFollow(pgen, r, group, groupCount, &after, leading && i == 0, exits) || changed;
+            free(group);
+        }
+        else if (item->symbol < 0)
+        {
+            ParserGenRule *rule = &pgen->rules[PARSERGEN_RULE(item->symbol)];
+            if (!exits)
+            {
+                changed = ParserGenSetUnion(pgen, &rule->follow, &after) || changed;
+            }
+            else if (!(leading && i == 0 && PARSERGEN_RULE(item->symbol) == r))
+            {
+                changed = ParserGenSetUnion(pgen, &rule->exit, &after) || changed;
+            }
+        }
+
+        ParserGenItemFirst(pgen, item, &after, &next);
+        ParserGenSetCopy(pgen, &after, &next);
+    }
+
+    ParserGenSetFree(&after);
+    ParserGenSetFree(&next);
+
+    return changed;
+}
+
+
+static bool ParserGenOptionsFollow(ParserGen *pgen, bool exits)
+{
+    bool changed = false;
+    for (int r = 0; r < pgen->numRules; r++)
+    {
+        ParserGenRule *rule = &pgen->rules[r];
+        if (!rule->used)
+            continue;
+
+        for (GrammarOption *opt = rule->def->firstOption; opt != NULL; opt = opt->nextOption)
+        {
+            int count;
+            GrammarItem **items = ParserGenItemArray(opt->firstItem, &count);
+            changed = ParserGenItemsFollow(pgen, r, items, count, &rule->follow, true, exits) || changed;
+            free(items);
+        }
+    }
+
+    return changed;
+}
+
+
+//
+// Work out what each definition can start with and what can follow it,
+// as strings of up to two terminals.
+//
+
+static void ParserGenAnalyse(ParserGen *pgen)
+{
+    for (int r = 0; r < pgen->numRules; r++)
+    {
+        ParserGenSetInit(pgen, &pgen->rules[r].first);
+        ParserGenSetInit(pgen, &pgen->rules[r].follow);
+        ParserGenSetInit(pgen, &pgen->rules[r].exit);
+    }
+
+    ParserGenSet empty;
+    ParserGenSet first;
+    ParserGenSetInit(pgen, &empty);
+    ParserGenSetInit(pgen, &first);
+    empty.empty = true;
+
+    bool changed = true;
+    while (changed)
+    {
+        changed = false;
+        for (int r = 0; r < pgen->numRules; r++)
+        {
+            ParserGenRule *rule = &pgen->rules[r];
+            if (!rule->used)
+                continue;
+
+            for (GrammarOption *opt = rule->def->firstOption; opt != NULL; opt = opt->nextOption)
+            {
+                int count;
+                GrammarItem **items = ParserGenItemArray(opt->firstItem, &count);
+                ParserGenItemsFirst(pgen, items, count, &empty, &first);
+                changed = ParserGenSetUnion(pgen, &rule->first, &first) || changed;
+                free(items);
+            }
+        }
+    }
+
+    // The start is followed by the end of the file.
+    ParserGenSetBit(ParserGenRow(pgen, &pgen->rules[pgen->start].follow, 0), 0);
+    ParserGenSetBit(ParserGenRow(pgen, &pgen->rules[pgen->start].exit, 0), 0);
+    while (ParserGenOptionsFollow(pgen, false))
+    {
+    }
+
+    ParserGenOptionsFollow(pgen, true);
+
+    ParserGenSetFree(&empty);
+    ParserGenSetFree(&first);
+}
+
+
+//
+// Check there's no left recursion other than a definition starting some
+// of its own options, as a recursive descent parser would never stop.
+//
+
+static bool ParserGenCheckLeft(ParserGen *pgen, int r, bool *done);
+
+static bool ParserGenCheckLeftItems(ParserGen *pgen, int r, GrammarItem *item, bool *done)
+{
+    for (; item != NULL; item = item->nextItem)
+    {
+        if (item->optional)
+        {
+            if (!ParserGenCheckLeftItems(pgen, r, item->group, done))
+                return false;
+
+            continue;
+        }
+
+        if (item->symbol > 0)
+            break;
+
+        int s = PARSERGEN_RULE(item->symbol);
+        if (pgen->rules[s].def->expanding)
+        {
+            AllocSprintf(&pgen->errMsg, "'%s' is left recursive through '%s'", pgen->rules[s].def->name, pgen->rules[r].def->name);
+            return false;
+        }
+
+        if (!ParserGenCheckLeft(pgen, s, done))
+            return false;
+
+        if (!pgen->rules[s].first.empty)
+            break;
+    }
+
+    return true;
+}
+
+
+static bool ParserGenCheckLeft(ParserGen *pgen, int r, bool *done)
+{
+    if (done[r])
+        return true;
+
+    GrammarDefinition *def = pgen->rules[r].def;
+    def->expanding = true;
+
+    bool ok = true;
+    for (GrammarOption *opt = def->firstOption; opt != NULL && ok; opt = opt->nextOption)
+    {
+        GrammarItem *item = opt->firstItem;
+        if (ParserGenLeftRecursive(opt, r) != 0)
+        {
+            item = item->nextItem;
+        }
+
+        ok = ParserGenCheckLeftItems(pgen, r, item, done);
+    }
+
+    def->expanding = false;
+    done[r] = true;
+
+    return ok;
+}
+
+
+//
+// Work out the terminals and definitions of the syntax grammar, starting
+// from startName. The tokens are the definitions of the lexical grammar
+// the parser sees as terminals. The first terminal is the end of the
+// file, the tokens' terminals come next, and then the keywords and
+// punctuators the grammar uses.
+//
+
+bool ParserGenGenerate(ParserGen *pgen, Grammar *lexical, const char *startName, const ParserGenToken *tokens, int numTokens)
+{
+    ParserGenAddTerminal(pgen, "EndOfFile", "end of file", NULL);
+    for (int i = 0; i < numTokens; i++)
+    {
+        if (ParserGenFindTerminal(pgen, tokens[i].terminal) < 0)
+        {
+            ParserGenAddTerminal(pgen, tokens[i].terminal, tokens[i].name, tokens[i].terminal);
+        }
+    }
+
+    // The definitions, other than those which are tokens.
+    for (GrammarDefinition *def = pgen->grammar.firstDef; def != NULL; def = def->nextDefinition)
+    {
+        if (ParserGenFindToken(def->name, tokens, numTokens) != NULL)
+            continue;
+
+        char name[256];
+        LexerGenCamelCase(def->name, name, sizeof(name));
+        pgen->rules = realloc(pgen->rules, (pgen->numRules + 1) * sizeof(ParserGenRule));
+        ParserGenRule *rule = &pgen->rules[pgen->numRules++];
+        memset(rule, 0, sizeof(*rule));
+        rule->def = def;
+        rule->name = strdup(name);
+    }
+
+    for (int r = 0; r < pgen->numRules; r++)
+    {
+        for (GrammarOption *opt = pgen->rules[r].def->firstOption; opt != NULL; opt = opt->nextOption)
+        {
+            if (!ParserGenResolve(pgen, lexical, opt->firstItem, tokens, numTokens))
+                return false;
+        }
+    }
+
+    pgen->setWords = (pgen->numTerminals + 63) / 64;
+
+    // Only generate what's used.
+    pgen->start = ParserGenFindRule(pgen, startName);
+    if (pgen->start < 0)
+    {
+        AllocSprintf(&pgen->errMsg, "can't find definition '%s'", startName);
+        return false;
+    }
+
+    GrammarItem start;
+    memset(&start, 0, sizeof(start));
+    start.symbol = PARSERGEN_RULE(pgen->start);
+    ParserGenMarkUsed(pgen, &start);
+
+    for (int r = 0; r < pgen->numRules; r++)
+    {
+        ParserGenRule *rule = &pgen->rules[r];
+        if (!rule->used)
+        {
+            fprintf(stderr, "warning: '%s' isn't used\n", rule->def->name);
+            continue;
+        }
+
+        for (GrammarOption *opt = rule->def->firstOption; opt != NULL; opt = opt->nextOption)
+        {
+            int left = ParserGenLeftRecursive(opt, r);
+            if (left != 0 && opt->firstItem->nextItem == NULL)
+            {
+                AllocSprintf(&pgen->errMsg, "an option of '%s' is just itself", rule->def->name);
+                return false;
+            }
+
+            rule->numBases += left != 1;
+            rule->numTails += left != 0;
+        }
+
+        if (rule->numBases == 0)
+        {
+            AllocSprintf(&pgen->errMsg, "'%s' never stops recursing", rule->def->name);
+            return false;
+        }
+    }
+
+    ParserGenAnalyse(pgen);
+
+    bool *done = calloc(pgen->numRules, sizeof(bool));
+    bool ok = true;
+    for (int r = 0; r < pgen->numRules && ok; r++)
+    {
+        ok = !pgen->rules[r].used || ParserGenCheckLeft(pgen, r, done);
+    }
+
+    free(done);
+
+    return ok;
+}
+
+
+//
+// Say which definitions are scopes for typedef names and which declare
+// names, so the parser can call its hooks for them.
+//
+
+bool ParserGenSetHooks(ParserGen *pgen, const char **scopeNames, int numScopes, const char **declarationNames, int numDeclarations)
+{
+    for (int i = 0; i < numScopes + numDeclarations; i++)
+    {
+        const char *name = i < numScopes ? scopeNames[i] : declarationNames[i - numScopes];
+        int r = ParserGenFindRule(pgen, name);
+        if (r < 0)
+        {
+            AllocSprintf(&pgen->errMsg, "can't find definition '%s'", name);
+            return false;
+        }
+
+        if (i < numScopes)
+        {
+            pgen->rules[r].scope = true;
+        }
+        else
+        {
+            pgen->rules[r].declaration = true;
+        }
+    }
+
+    return true;
+}
+
+
+//
+// Write a line of code.
+//
+
+static void ParserGenLine(ParserGen *pgen, int indent, const char *format, ...)
+{
+    va_list args;
+    va_start(args, format);
+    fprintf(pgen->out, "%*s", indent * 4, "");
+    vfprintf(pgen->out, format, args);
+    fprintf(pgen->out, "\n");
+    va_end(args);
+}
+
+
+static void ParserGenFreeAlts(ParserGenAlt *alts, int numAlts)
+{
+    for (int i = 0; i < numAlts; i++)
+    {
+        free(alts[i].items);
+    }
+
+    free(alts);
+}
+
+
+//
+// Add an alternative to a list, copying some items.
+//
+
+static void ParserGenAddAlt(ParserGenAlt **alts, int *numAlts, const ParserGenAlt *from, GrammarItem **items, int count)
+{
+    *alts = realloc(*alts, (*numAlts + 1) * sizeof(ParserGenAlt));
+    ParserGenAlt *alt = &(*alts)[(*numAlts)++];
+    *alt = *from;
+    alt->items = calloc(count + 1, sizeof(GrammarItem *));
+    alt->count = count;
+    memcpy(alt->items, items, count * sizeof(GrammarItem *));
+}
+
+
+//
+// Replace an alternative which starts with an optional group with one
+// with the group and one without it, so each alternative starts with
+// something which has to be there.
+//
+
+static void ParserGenExpand(ParserGenAlt **alts, int *numAlts, const ParserGenAlt *alt)
+{
+    if (alt->count == 0 || !alt->items[0]->optional)
+    {
+        ParserGenAddAlt(alts, numAlts, alt, alt->items, alt->count);
+        return;
+    }
+
+    int groupCount;
+    GrammarItem **group = ParserGenItemArray(alt->items[0]->group, &groupCount);
+    ParserGenAlt with = *alt;
+    with.count = groupCount + alt->count - 1;
+    with.items = calloc(with.count + 1, sizeof(GrammarItem *));
+    memcpy(with.items, group, groupCount * sizeof(GrammarItem *));
+    memcpy(with.items + groupCount, alt->items + 1, (alt->count - 1) * sizeof(GrammarItem *));
+    ParserGenExpand(alts, numAlts, &with);
+    free(with.items);
+    free(group);
+
+    ParserGenAlt without = *alt;
+    without.items = alt->items + 1;
+    without.count = alt->count - 1;
+    ParserGenExpand(alts, numAlts, &without);
+}
+
+
+//
+// Write an item which has to be next. If the choice that led here has
+// already checked it's there, a token can just be taken.
+//
+
+static void ParserGenWriteItem(ParserGen *pgen, GrammarItem *item, bool checked, ParserGenPath *path, int indent)
+{
+    if (item->symbol < 0)
+    {
+        ParserGenLine(pgen, indent, "children.add(parse%s());", pgen->rules[PARSERGEN_RULE(item->symbol)].name);
+        path->children++;
+        return;
+    }
+
+    ParserGenTerminal *terminal = &pgen->terminals[item->symbol - 1];
+    if (terminal->leafRule != NULL)
+    {
+        if (checked)
+        {
+            ParserGenLine(pgen, indent, "children.add(p.leaf(Rule::%s));", terminal->leafRule);
+        }
+        else
+        {
+            ParserGenLine(pgen, indent, "children.add(p.expectLeaf(Rule::%s, %s));", terminal->leafRule, terminal->label);
+        }
+
+        path->children++;
+    }
+    else
+    {
+        ParserGenLine(pgen, indent, checked ? "p.advance();" : "p.expect(%s);", terminal->label);
+        path->tokens++;
+    }
+}
+
+
+//
+// Write the end of an option: make its node, unless it's just a single
+// child, and return it or go round the loop again.
+//
+
+static void ParserGenWriteEnd(ParserGen *pgen, const ParserGenContext *ctx, const ParserGenAlt *alt, ParserGenPath path, int indent)
+{
+    ParserGenRule *rule = &pgen->rules[ctx->rule];
+    char node[300];
+    if (alt->exit)
+    {
+        snprintf(node, sizeof(node), "node");
+    }
+    else if (path.children == 1 && path.tokens == 0)
+    {
+        snprintf(node, sizeof(node), "children.first");
+    }
+    else
+    {
+        snprintf(node, sizeof(node), "p.node(Rule::%s, %d, children)", rule->name, alt->option);
+    }
+
+    if (ctx->loop && !alt->exit)
+    {
+        ParserGenLine(pgen, indent, "node = %s;", node);
+        ParserGenLine(pgen, indent, "continue;");
+    }
+    else if (rule->declaration)
+    {
+        ParserGenLine(pgen, indent, "return p.declared(%s);", node);
+    }
+    else
+    {
+        ParserGenLine(pgen, indent, "return %s;", node);
+    }
+}
+
+
+static void ParserGenWriteChoice(ParserGen *pgen, const ParserGenContext *ctx, const ParserGenAlt *alts, int numAlts, ParserGenPath path, int indent);
+
+//
+// Write a group of alternatives, which start with the same item.
+//
+
+static void ParserGenWriteGroup(ParserGen *pgen, const ParserGenContext *ctx, const ParserGenGroup *group, bool checked, ParserGenPath path, int indent)
+{
+    if (group->first == NULL)
+    {
+        for (int i = 1; i < group->numAlts; i++)
+        {
+            if (group->alts[i].option != group->alts[0].option || group->alts[i].exit != group->alts[0].exit)
+            {
+                fprintf(stderr, "warning: '%s' has options which are the same, using the first\n", pgen->rules[ctx->rule].def->name);
+                pgen->numConflicts++;
+                break;
+            }
+        }
+
+        ParserGenWriteEnd(pgen, ctx, &group->alts[0], path, indent);
+        return;
+    }
+
+    ParserGenWriteItem(pgen, group->first, checked, &path, indent);
+    ParserGenWriteChoice(pgen, ctx, group->alts, group->numAlts, path, indent);
+}
+
+
+//
+// Choose a group for the strings starting with a terminal, which are in
+// the lookahead sets of more than one. Each second terminal chooses the
+// first group it's in, so a conflict goes to the earliest option or to
+// taking an optional part, which is how an 'else' goes with the nearest
+// 'if'.
+//
+// Returns the group, -1 if none has it, -3 for the empty group, or -2 to
+// choose by the second terminal, with second filled in the same way.
+//
+
+static int ParserGenChooseFirst(ParserGen *pgen, const ParserGenContext *ctx, const ParserGenGroup *groups, int numGroups, int emptyGroup, int t, int *second)
+{
+    int owner = -1;
+    int numOwners = 0;
+    bool emptyOwns = emptyGroup >= 0 && !ParserGenRowEmpty(pgen, &groups[emptyGroup].la, t);
+    for (int g = 0; g < numGroups; g++)
+    {
+        if (g != emptyGroup && !ParserGenRowEmpty(pgen, &groups[g].la, t))
+        {
+            owner = owner < 0 ? g : owner;
+            numOwners++;
+        }
+    }
+
+    if (numOwners == 0)
+        return emptyOwns ? -3 : -1;
+
+    if (numOwners == 1 && !emptyOwns)
+        return owner;
+
+    int only = -1;
+    bool single = true;
+    bool conflict = false;
+    for (int u = 0; u < pgen->numTerminals; u++)
+    {
+        second[u] = -1;
+        for (int g = 0; g < numGroups; g++)
+        {
+            if (g == emptyGroup || !ParserGenBit(ParserGenRow(pgen, &groups[g].la, t), u))
+                continue;
+
+            conflict = conflict || second[u] >= 0;
+            second[u] = second[u] >= 0 ? second[u] : g;
+        }
+
+        if (emptyGroup >= 0 && ParserGenBit(ParserGenRow(pgen, &groups[emptyGroup].la, t), u))
+        {
+            conflict = conflict || second[u] >= 0;
+            second[u] = second[u] >= 0 ? second[u] : -3;
+        }
+
+        if (second[u] != -1)
+        {
+            single = single && (only == -1 || only == second[u]);
+            only = only == -1 ? second[u] : only;
+        }
+    }
+
+    if (conflict)
+    {
+        fprintf(stderr, "warning: '%s' is ambiguous after %s, taking the earliest option\n",
+                pgen->rules[ctx->rule].def->name, pgen->terminals[t].spelling);
+        pgen->numConflicts++;
+    }
+
+    return single && only != -1 ? only : -2;
+}
+
+
+//
+// Write the case labels for the terminals which choose a group.
+//
+
+static bool ParserGenWriteLabels(ParserGen *pgen, const int *choices, int group, int indent)
+{
+    bool any = false;
+    for (int t = 0; t < pgen->numTerminals; t++)
+    {
+        if (choices[t] == group)
+        {
+            ParserGenLine(pgen, indent, "case %s:", pgen->terminals[t].label);
+            any = true;
+        }
+    }
+
+    return any;
+}
+
+
+//
+// A typedef name is an identifier wherever the grammar doesn't say what
+// to do with one.
+//
+
+static void ParserGenAliasTypedefName(ParserGen *pgen, int *choices, int *seconds)
+{
+    int identifier = ParserGenFindTerminal(pgen, "Identifier");
+    int typedefName = ParserGenFindTerminal(pgen, "TypedefName");
+    if (identifier < 0 || typedefName < 0 || choices[typedefName] != -1)
+        return;
+
+    choices[typedefName] = choices[identifier];
+    if (seconds != NULL)
+    {
+        memcpy(seconds + (size_t)typedefName * pgen->numTerminals, seconds + (size_t)identifier * pgen->numTerminals,
+               pgen->numTerminals * sizeof(int));
+    }
+}
+
+
+//
+// A typedef name is an identifier when the terminal after it can't follow
+// it in the group which takes typedef names but can follow an identifier
+// in another one, which is how a label can have the same name as a
+// typedef: "T: ;". Returns the group which takes the typedef name
+// otherwise if the second terminal now chooses, or -1.
+//
+
+static int ParserGenSplitTypedefName(ParserGen *pgen, const ParserGenGroup *groups, int numGroups, int emptyGroup, int *choices, int *seconds)
+{
+    int identifier = ParserGenFindTerminal(pgen, "Identifier");
+    int typedefName = ParserGenFindTerminal(pgen, "TypedefName");
+    if (identifier < 0 || typedefName < 0 || choices[typedefName] < 0)
+        return -1;
+
+    int owner = choices[typedefName];
+    const uint64_t *ownerRow = ParserGenRow(pgen, &groups[owner].la, typedefName);
+    int *second = seconds + (size_t)typedefName * pgen->numTerminals;
+    bool split = false;
+    for (int u = 0; u < pgen->numTerminals; u++)
+    {
+        second[u] = -1;
+        if (ParserGenBit(ownerRow, u))
+            continue;
+
+        for (int g = 0; g < numGroups && second[u] < 0; g++)
+        {
+            if (g != owner && g != emptyGroup && ParserGenBit(ParserGenRow(pgen, &groups[g].la, identifier), u))
+            {
+                second[u] = g;
+                split = true;
+            }
+        }
+    }
+
+    if (!split)
+        return -1;
+
+    choices[typedefName] = -2;
+    return owner;
+}
+
+
+//
+// Write a switch on the next terminal, or the next two, which chooses
+// between groups of alternatives and carries on with the one chosen. The
+// empty group, if there is one, is the default.
+//
+
+static void ParserGenWriteDispatch(ParserGen *pgen, const ParserGenContext *ctx, const ParserGenGroup *groups, int numGroups, ParserGenPath path, int indent)
+{
+    const char *ruleName = pgen->rules[ctx->rule].name;
+    int numTerminals = pgen->numTerminals;
+    int emptyGroup = -1;
+    for (int g = 0; g < numGroups; g++)
+    {
+        emptyGroup = groups[g].first == NULL ? g : emptyGroup;
+    }
+
+    // What each first terminal chooses, and each second terminal for the
+    // first terminals which need it.
+    int *choices = calloc(numTerminals, sizeof(int));
+    int *seconds = calloc((size_t)numTerminals * numTerminals, sizeof(int));
+    int typedefName = ParserGenFindTerminal(pgen, "TypedefName");
+    bool nested = false;
+    for (int t = 0; t < numTerminals; t++)
+    {
+        choices[t] = ParserGenChooseFirst(pgen, ctx, groups, numGroups, emptyGroup, t, seconds + (size_t)t * numTerminals);
+        if (choices[t] == -2)
+        {
+            ParserGenAliasTypedefName(pgen, seconds + (size_t)t * numTerminals, NULL);
+            nested = true;
+        }
+    }
+
+    int typedefOwner = ParserGenSplitTypedefName(pgen, groups, numGroups, emptyGroup, choices, seconds);
+    nested = nested || typedefOwner >= 0;
+    ParserGenAliasTypedefName(pgen, choices, seconds);
+
+    if (!nested)
+    {
+        ParserGenLine(pgen, indent, "switch (p.la(0))");
+        ParserGenLine(pgen, indent, "{");
+        for (int g = 0; g < numGroups; g++)
+        {
+            if (g != emptyGroup && ParserGenWriteLabels(pgen, choices, g, indent))
+            {
+                ParserGenWriteGroup(pgen, ctx, &groups[g], true, path, indent + 1);
+                fprintf(pgen->out, "\n");
+            }
+        }
+
+        ParserGenLine(pgen, indent, "default:");
+        if (emptyGroup >= 0)
+        {
+            ParserGenWriteGroup(pgen, ctx, &groups[emptyGroup], false, path, indent + 1);
+        }
+        else
+        {
+            ParserGenLine(pgen, indent + 1, "p.unexpected(Rule::%s);", ruleName);
+        }
+
+        ParserGenLine(pgen, indent, "}");
+        free(choices);
+        free(seconds);
+        return;
+    }
+
+    // Choose, then carry on with the choice.
+    int choice = ++pgen->numChoices;
+    char fallback[300];
+    if (emptyGroup >= 0)
+    {
+        snprintf(fallback, sizeof(fallback), "choice%d = %d;", choice, emptyGroup);
+    }
+    else
+    {
+        snprintf(fallback, sizeof(fallback), "p.unexpected(Rule::%s);", ruleName);
+    }
+
+    bool *chosen = calloc(numGroups, sizeof(bool));
+    ParserGenLine(pgen, indent, "int choice%d;", choice);
+    ParserGenLine(pgen, indent, "switch (p.la(0))");
+    ParserGenLine(pgen, indent, "{");
+    for (int g = 0; g < numGroups; g++)
+    {
+        if (g != emptyGroup && ParserGenWriteLabels(pgen, choices, g, indent))
+        {
+            ParserGenLine(pgen, indent + 1, "choice%d = %d;", choice, g);
+            ParserGenLine(pgen, indent + 1, "break;");
+            fprintf(pgen->out, "\n");
+            chosen[g] = true;
+        }
+    }
+
+    for (int t = 0; t < numTerminals; t++)
+    {
+        if (choices[t] != -2)
+            continue;
+
+        const int *second = seconds + (size_t)t * numTerminals;
+        ParserGenLine(pgen, indent, "case %s:", pgen->terminals[t].label);
+        ParserGenLine(pgen, indent + 1, "switch (p.la(1))");
+        ParserGenLine(pgen, indent + 1, "{");
+        for (int g = 0; g < numGroups; g++)
+        {
+            if (g != emptyGroup && ParserGenWriteLabels(pgen, second, g, indent + 1))
+            {
+                ParserGenLine(pgen, indent + 2, "choice%d = %d;", choice, g);
+                ParserGenLine(pgen, indent + 2, "break;");
+                fprintf(pgen->out, "\n");
+                chosen[g] = true;
+            }
+        }
+
+        ParserGenLine(pgen, indent + 1, "default:");
+        if (t == typedefName && typedefOwner >= 0)
+        {
+            ParserGenLine(pgen, indent + 2, "choice%d = %d;", choice, typedefOwner);
+            ParserGenLine(pgen, indent + 2, "break;");
+            chosen[typedefOwner] = true;
+        }
+        else
+        {
+            ParserGenLine(pgen, indent + 2, "%s", fallback);
+            if (emptyGroup >= 0)
+            {
+                ParserGenLine(pgen, indent + 2, "break;");
+            }
+        }
+
+        ParserGenLine(pgen, indent + 1, "}");
+        ParserGenLine(pgen, indent + 1, "break;");
+        fprintf(pgen->out, "\n");
+    }
+
+    ParserGenLine(pgen, indent, "default:");
+    ParserGenLine(pgen, indent + 1, "%s", fallback);
+    if (emptyGroup >= 0)
+    {
+        ParserGenLine(pgen, indent + 1, "break;");
+        chosen[emptyGroup] = true;
+    }
+
+    ParserGenLine(pgen, indent, "}");
+    fprintf(pgen->out, "\n");
+
+    // The last group chosen is the default, so every path returns.
+    int last = -1;
+    for (int g = 0; g < numGroups; g++)
+    {
+        last = chosen[g] && g != emptyGroup ? g : last;
+    }
+
+    last = emptyGroup >= 0 ? emptyGroup : last;
+    ParserGenLine(pgen, indent, "switch (choice%d)", choice);
+    ParserGenLine(pgen, indent, "{");
+    for (int g = 0; g < numGroups; g++)
+    {
+        if (chosen[g] && g != last)
+        {
+            ParserGenLine(pgen, indent, "case %d:", g);
+            ParserGenWriteGroup(pgen, ctx, &groups[g], true, path, indent + 1);
+            fprintf(pgen->out, "\n");
+        }
+    }
+
+    ParserGenLine(pgen, indent, "default:");
+    ParserGenWriteGroup(pgen, ctx, &groups[last], last != emptyGroup, path, indent + 1);
+    ParserGenLine(pgen, indent, "}");
+
+    free(chosen);
+    free(choices);
+    free(seconds);
+}
+
+
+//
+// Write the code to choose between some alternatives and parse the rest
+// of the one chosen. Alternatives which start with the same item are
+// grouped so it's only parsed once, and the choice is made after it.
+//
+
+static void ParserGenWriteChoice(ParserGen *pgen, const ParserGenContext *ctx, const ParserGenAlt *alts, int numAlts, ParserGenPath path, int indent)
+{
+    ParserGenAlt *expanded = NULL;
+    int numExpanded = 0;
+    for (int i = 0; i < numAlts; i++)
+    {
+        ParserGenExpand(&expanded, &numExpanded, &alts[i]);
+    }
+
+    // Group them by their first item.
+    ParserGenGroup *groups = calloc(numExpanded, sizeof(ParserGenGroup));
+    int numGroups = 0;
+    for (int i = 0; i < numExpanded; i++)
+    {
+        ParserGenAlt *alt = &expanded[i];
+        GrammarItem *first = alt->count > 0 ? alt->items[0] : NULL;
+        int g = 0;
+        while (g < numGroups && !(groups[g].first == first || (groups[g].first != NULL && first != NULL && groups[g].first->symbol == first->symbol)))
+        {
+            g++;
+        }
+
+        if (g == numGroups)
+        {
+            groups[numGroups].first = first;
+            ParserGenSetInit(pgen, &groups[numGroups].la);
+            numGroups++;
+        }
+
+        // What it can start with.
+        ParserGenSet la;
+        ParserGenSetInit(pgen, &la);
+        if (alt->exit)
+        {
+            ParserGenSetCopy(pgen, &la, &pgen->rules[ctx->rule].exit);
+        }
+        else
+        {
+            ParserGenItemsFirst(pgen, alt->items, alt->count, ctx->cont, &la);
+        }
+
+        ParserGenSetUnion(pgen, &groups[g].la, &la);
+        ParserGenSetFree(&la);
+
+        if (first != NULL)
+        {
+            ParserGenAddAlt(&groups[g].alts, &groups[g].numAlts, alt, alt->items + 1, alt->count - 1);
+        }
+        else
+        {
+            ParserGenAddAlt(&groups[g].alts, &groups[g].numAlts, alt, alt->items, 0);
+        }
+    }
+
+    if (numGroups == 1)
+    {
+        ParserGenWriteGroup(pgen, ctx, &groups[0], false, path, indent);
+    }
+    else
+    {
+        ParserGenWriteDispatch(pgen, ctx, groups, numGroups, path, indent);
+    }
+
+    for (int g = 0; g < numGroups; g++)
+    {
+        ParserGenFreeAlts(groups[g].alts, groups[g].numAlts);
+        ParserGenSetFree(&groups[g].la);
+    }
+
+    free(groups);
+    ParserGenFreeAlts(expanded, numExpanded);
+}
+
+
+//
+// Get the bases or the tails of a definition as alternatives. A tail's
+// items are what follows the reference to the definition itself.
+//
+
+static ParserGenAlt *ParserGenRuleAlts(ParserGen *pgen, int r, bool tails, int *numAlts)
+{
+    ParserGenAlt *alts = NULL;
+    *numAlts = 0;
+    int option = 0;
+    for (GrammarOption *opt = pgen->rules[r].def->firstOption; opt != NULL; opt = opt->nextOption, option++)
+    {
+        int left = ParserGenLeftRecursive(opt, r);
+        if (tails ? left == 0 : left == 1)
+            continue;
+
+        int count;
+        GrammarItem **items = ParserGenItemArray(opt->firstItem, &count);
+        ParserGenAlt alt = { NULL, 0, option, false };
+        if (left != 0)
+        {
+            ParserGenAddAlt(&alts, numAlts, &alt, items + 1, count - 1);
+        }
+        else
+        {
+            ParserGenAddAlt(&alts, numAlts, &alt, items, count);
+        }
+
+        free(items);
+    }
+
+    return alts;
+}
+
+
+//
+// A left recursive definition with a single base which is just another
+// definition or a leaf parses it in place. Otherwise the bases have a
+// function of their own.
+//
+
+static bool ParserGenInlineHead(ParserGen *pgen, int r, char *head, size_t headSize)
+{
+    GrammarOption *base = NULL;
+    for (GrammarOption *opt = pgen->rules[r].def->firstOption; opt != NULL; opt = opt->nextOption)
+    {
+        if (ParserGenLeftRecursive(opt, r) != 1)
+        {
+            if (base != NULL)
+                return false;
+
+            base = opt;
+        }
+    }
+
+    GrammarItem *only = ParserGenLeftRecursive(base, r) == 0 && base->firstItem->nextItem == NULL ? base->firstItem : NULL;
+    if (only == NULL || only->optional)
+        return false;
+
+    if (only->symbol < 0)
+    {
+        snprintf(head, headSize, "parse%s()", pgen->rules[PARSERGEN_RULE(only->symbol)].name);
+        return true;
+    }
+
+    ParserGenTerminal *terminal = &pgen->terminals[only->symbol - 1];
+    if (terminal->leafRule == NULL)
+        return false;
+
+    snprintf(head, headSize, "p.expectLeaf(Rule::%s, %s)", terminal->leafRule, terminal->label);
+    return true;
+}
+
+
+//
+// Write the function for a definition. A left recursive one parses one
+// of its bases and then loops round its tails, each of which makes a new
+// node with the one so far as its first child.
+//
+
+static void ParserGenWriteRule(ParserGen *pgen, int r)
+{
+    ParserGenRule *rule = &pgen->rules[r];
+    ParserGenPath path = { 0, 0 };
+    int numBases;
+    ParserGenAlt *bases = ParserGenRuleAlts(pgen, r, false, &numBases);
+    ParserGenContext ctx = { r, false, &rule->follow };
+
+    if (rule->numTails == 0)
+    {
+        fprintf(pgen->out, "ParseNode *CParser::Rules::parse%s()\n{\n", rule->name);
+        ParserGenLine(pgen, 1, "DepthGuard depth(p);");
+        if (rule->scope)
+        {
+            ParserGenLine(pgen, 1, "ScopeGuard scope(p);");
+        }
+
+        ParserGenLine(pgen, 1, "Children children(p.position());");
+        ParserGenWriteChoice(pgen, &ctx, bases, numBases, path, 1);
+        fprintf(pgen->out, "}\n\n\n");
+        ParserGenFreeAlts(bases, numBases);
+        return;
+    }
+
+    char head[300];
+    if (!ParserGenInlineHead(pgen, r, head, sizeof(head)))
+    {
+        snprintf(head, sizeof(head), "parse%sHead()", rule->name);
+        fprintf(pgen->out, "ParseNode *CParser::Rules::parse%sHead()\n{\n", rule->name);
+        ParserGenLine(pgen, 1, "DepthGuard depth(p);");
+        ParserGenLine(pgen, 1, "Children children(p.position());");
+        ParserGenWriteChoice(pgen, &ctx, bases, numBases, path, 1);
+        fprintf(pgen->out, "}\n\n\n");
+    }
+
+    int numTails;
+    ParserGenAlt *tails = ParserGenRuleAlts(pgen, r, true, &numTails);
+    ParserGenAlt exit = { NULL, 0, 0, true };
+    ParserGenAddAlt(&tails, &numTails, &exit, NULL, 0);
+
+    fprintf(pgen->out, "ParseNode *CParser::Rules::parse%s()\n{\n", rule->name);
+    ParserGenLine(pgen, 1, "DepthGuard depth(p);");
+    if (rule->scope)
+    {
+        ParserGenLine(pgen, 1, "ScopeGuard scope(p);");
+    }
+
+    ParserGenLine(pgen, 1, "ParseNode *node = %s;", head);
+    ParserGenLine(pgen, 1, "for (;;)");
+    ParserGenLine(pgen, 1, "{");
+    ParserGenLine(pgen, 2, "Children children(node);");
+    ctx.loop = true;
+    path.children = 1;
+    ParserGenWriteChoice(pgen, &ctx, tails, numTails, path, 2);
+    ParserGenLine(pgen, 1, "}");
+    fprintf(pgen->out, "}\n\n\n");
+
+    ParserGenFreeAlts(bases, numBases);
+    ParserGenFreeAlts(tails, numTails);
+}
+
+
+//
+// Write the rules header: an enumerator for each kind of parse tree node.
+//
+
+static bool ParserGenWriteRules(ParserGen *pgen, const char *fileName)
+{
+    FILE *out = fopen(fileName, "w");
+    if (out == NULL)
+    {
+        AllocSprintf(&pgen->errMsg, "can't create '%s'", fileName);
+        return false;
+    }
+
+    fprintf(out, "//\n");
+    fprintf(out, "// Parse tree rules generated by dcparsergen from %s. Don't edit.\n", pgen->grammar.fileName);
+    fprintf(out, "//\n");
+    fprintf(out, "// There's a rule for each token which is a leaf of the parse tree and\n");
+    fprintf(out, "// for each definition of the grammar.\n");
+    fprintf(out, "//\n\n");
+    fprintf(out, "#ifndef DEEPC_PARSERULES_H\n");
+    fprintf(out, "#define DEEPC_PARSERULES_H\n\n");
+    fprintf(out, "#include <cstdint>\n\n\n");
+    fprintf(out, "namespace deepC\n{\n\n\n");
+    fprintf(out, "enum class Rule : uint16_t\n{\n");
+    for (int t = 0; t < pgen->numTerminals; t++)
+    {
+        if (pgen->terminals[t].leafRule != NULL)
+        {
+            fprintf(out, "    %s,\n", pgen->terminals[t].leafRule);
+        }
+    }
+
+    for (int r = 0; r < pgen->numRules; r++)
+    {
+        if (pgen->rules[r].used)
+        {
+            fprintf(out, "    %s,\n", pgen->rules[r].name);
+        }
+    }
+
+    fprintf(out, "    Count\n};\n\n\n");
+    fprintf(out, "// The grammar's name for a rule, like \"postfix-expression\".\n");
+    fprintf(out, "const char *ruleName(Rule rule);\n\n\n");
+    fprintf(out, "} // namespace deepC\n\n");
+    fprintf(out, "#endif // DEEPC_PARSERULES_H\n");
+
+    if (fclose(out) != 0)
+    {
+        AllocSprintf(&pgen->errMsg, "can't write '%s'", fileName);
+        return false;
+    }
+
+    return true;
+}
+
+
+//
+// Write the parser: a function for each definition which is used, in a
+// class CParser declares.
+//
+
+bool ParserGenWriteParser(ParserGen *pgen, const char *parserFile, const char *rulesFile)
+{
+    if (!ParserGenWriteRules(pgen, rulesFile))
+        return false;
+
+    pgen->out = fopen(parserFile, "w");
+    if (pgen->out == NULL)
+    {
+        AllocSprintf(&pgen->errMsg, "can't create '%s'", parserFile);
+        return false;
+    }
+
+    FILE *out = pgen->out;
+    fprintf(out, "//\n");
+    fprintf(out, "// C parser generated by dcparsergen from %s. Don't edit.\n", pgen->grammar.fileName);
+    fprintf(out, "//\n");
+    fprintf(out, "// A recursive descent parser with a function for each definition. Left\n");
+    fprintf(out, "// recursive definitions are loops, and each choice is a switch on the\n");
+    fprintf(out, "// next token, or the next two where one isn't enough. Each function\n");
+    fprintf(out, "// counts how deeply they're nested, see CParser::maxDepth.\n");
+    fprintf(out, "//\n\n");
+    fprintf(out, "#include \"cparser.h\"\n\n\n");
+    fprintf(out, "namespace deepC\n{\n\n\n");
+
+    // Rule names.
+    fprintf(out, "static const char *const ruleNames[] =\n{\n");
+    for (int t = 0; t < pgen->numTerminals; t++)
+    {
+        if (pgen->terminals[t].leafRule != NULL)
+        {
+            fprintf(out, "    \"%s\",\n", pgen->terminals[t].spelling);
+        }
+    }
+
+    for (int r = 0; r < pgen->numRules; r++)
+    {
+        if (pgen->rules[r].used)
+        {
+            fprintf(out, "    \"%s\",\n", pgen->rules[r].def->name);
+        }
+    }
+
+    fprintf(out, "};\n\n\n");
+    fprintf(out, "const char *ruleName(Rule rule)\n{\n");
+    fprintf(out, "    return ruleNames[static_cast<size_t>(rule)];\n");
+    fprintf(out, "}\n\n\n");
+
+    // Terminal spellings.
+    fprintf(out, "const char *CParser::spelling(unsigned terminal)\n{\n");
+    fprintf(out, "    switch (terminal)\n    {\n");
+    for (int t = 0; t < pgen->numTerminals; t++)
+    {
+        fprintf(out, "    case %s:\n", pgen->terminals[t].label);
+        fprintf(out, "        return \"%s\";\n\n", pgen->terminals[t].spelling);
+    }
+
+    fprintf(out, "    default:\n");
+    fprintf(out, "        return \"a token\";\n");
+    fprintf(out, "    }\n}\n\n\n");
+
+    // The parsing functions.
+    fprintf(out, "//\n");
+    fprintf(out, "// The parsing functions, one for each definition.\n");
+    fprintf(out, "//\n\n");
+    fprintf(out, "class CParser::Rules\n{\n");
+    fprintf(out, "    CParser &p;\n\n");
+    fprintf(out, "public:\n");
+    fprintf(out, "    explicit Rules(CParser &parser) : p(parser) {}\n\n");
+    for (int r = 0; r < pgen->numRules; r++)
+    {
+        if (pgen->rules[r].used)
+        {
+            fprintf(out, "    ParseNode *parse%s();\n", pgen->rules[r].name);
+        }
+    }
+
+    fprintf(out, "\n");
+    for (int r = 0; r < pgen->numRules; r++)
+    {
+        char head[300];
+        if (pgen->rules[r].used && pgen->rules[r].numTails > 0 && !ParserGenInlineHead(pgen, r, head, sizeof(head)))
+        {
+            fprintf(out, "    ParseNode *parse%sHead();\n", pgen->rules[r].name);
+        }
+    }
+
+    fprintf(out, "};\n\n\n");
+
+    for (int r = 0; r < pgen->numRules; r++)
+    {
+        if (pgen->rules[r].used)
+        {
+            ParserGenWriteRule(pgen, r);
+        }
+    }
+
+    // The entry point.
+    fprintf(out, "//\n");
+    fprintf(out, "// Parse the tokens. Returns nullptr if there aren't any.\n");
+    fprintf(out, "//\n\n");
+    fprintf(out, "ParseNode *CParser::parse()\n{\n");
+    fprintf(out, "    if (la(0) == EndOfFile)\n");
+    fprintf(out, "        return nullptr;\n\n");
+    fprintf(out, "    Rules rules(*this);\n");
+    fprintf(out, "    ParseNode *root = rules.parse%s();\n", pgen->rules[pgen->start].name);
+    fprintf(out, "    expect(EndOfFile);\n");
+    fprintf(out, "    tree_.setRoot(root);\n\n");
+    fprintf(out, "    return root;\n");
+    fprintf(out, "}\n\n\n");
+    fprintf(out, "} // namespace deepC\n");
+
+    pgen->out = NULL;
+    if (fclose(out) != 0)
+    {
+        AllocSprintf(&pgen->errMsg, "can't write '%s'", parserFile);
+        return false;
+    }
+
+    return true;
+}
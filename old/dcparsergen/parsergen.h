@@ -2,19 +2,100 @@
 #define PARSERGEN_H
 
 #include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
 
 #include "grammar.h"
 
-typedef struct 
+
+//
+// A definition the parser sees as a single token, like "identifier", and
+// the terminal it's seen as, like "Identifier". Each terminal named here
+// is also a leaf of the parse tree.
+//
+
+typedef struct
+{
+    const char *name;
+    const char *terminal;
+} ParserGenToken;
+
+
+//
+// A terminal: a kind of token the parser dispatches on.
+//
+
+typedef struct
+{
+    char *label;        // The C++ constant for it, like "punctuator(Punctuator::LeftParen)".
+    char *spelling;     // How it's written in error messages, like "'('".
+    char *leafRule;     // Its parse tree rule if it's a leaf, like "Identifier", otherwise NULL.
+} ParserGenTerminal;
+
+
+//
+// A set of strings of up to two terminals, like the strings a definition
+// can start with. Strings of two terminals are a bit matrix of pairs, and
+// shorter ones are a bit set of singles and whether it has the empty one.
+//
+
+typedef struct
+{
+    bool      empty;
+    uint64_t *singles;      // setWords words.
+    uint64_t *pairs;        // numTerminals rows of setWords words.
+} ParserGenSet;
+
+
+//
+// What the generator works out about a definition of the syntax grammar.
+// Options which start with the definition itself are left recursive, so
+// what follows that is a tail which the parser repeats in a loop after
+// one of the other options, the bases.
+//
+
+typedef struct
+{
+    GrammarDefinition *def;
+    char              *name;            // Camel cased, like "PostfixExpression".
+    bool               used;            // Whether the start definition uses it.
+    bool               scope;           // Whether typedef names declared in it go out of scope at its end.
+    bool               declaration;     // Whether it declares names.
+    int                numBases;
+    int                numTails;
+    ParserGenSet       first;           // What it can start with.
+    ParserGenSet       follow;          // What can follow it, including its tails.
+    ParserGenSet       exit;            // What can follow it from outside.
+} ParserGenRule;
+
+
+typedef struct
 {
     Grammar grammar;
     char *errMsg;
+
+    // The terminals, of which the first is the end of the file, and the
+    // definitions.
+    ParserGenTerminal *terminals;
+    int                numTerminals;
+    int                setWords;
+    ParserGenRule     *rules;
+    int                numRules;
+    int                start;
+
+    // While writing the parser.
+    FILE              *out;
+    int                numChoices;
+    int                numConflicts;
 } ParserGen;
 
 // Prototypes.
-void ParserGenInit(ParserGen *lgen);
-void ParserGenClose(ParserGen *lgen);
-bool ParserGenReadGrammar(ParserGen *lgen, const char *fileName);
-const char *ParserGenGetError(ParserGen *lgen);
+void ParserGenInit(ParserGen *pgen);
+void ParserGenClose(ParserGen *pgen);
+bool ParserGenReadGrammar(ParserGen *pgen, const char *fileName);
+bool ParserGenGenerate(ParserGen *pgen, Grammar *lexical, const char *startName, const ParserGenToken *tokens, int numTokens);
+bool ParserGenSetHooks(ParserGen *pgen, const char **scopeNames, int numScopes, const char **declarationNames, int numDeclarations);
+bool ParserGenWriteParser(ParserGen *pgen, const char *parserFile, const char *rulesFile);
+const char *ParserGenGetError(ParserGen *pgen);
 
 #endif // PARSERGEN_H
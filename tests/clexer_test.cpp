@@ -0,0 +1,301 @@
+#include <cstdlib>
+#include <string>
+#include <vector>
+#include <gtest/gtest.h>
+
+#include "clexer.h"
+
+
+namespace deepC
+{
+
+
+//
+// Lex some text and return the kind and text of each token.
+//
+
+static std::vector<std::pair<TokenKind, std::string>> lex(const std::string &text)
+{
+    TokenStream tokens;
+    CLexer lexer(text);
+    lexer.lexAll(&tokens);
+
+    std::vector<std::pair<TokenKind, std::string>> result;
+    for (size_t i = 0; i < tokens.size(); i++)
+    {
+        result.push_back(std::make_pair(tokens.kind(i), std::string(tokens.text(i, text))));
+    }
+
+    return result;
+}
+
+
+TEST(CLexerTest, TokenKinds)
+{
+    auto tokens = lex("x1 _y 0x1Fu 1.5e+3f .5 'a' L'\\'' \"s\\\"t\" u8\"u\" ->");
+    std::vector<std::pair<TokenKind, std::string>> expected =
+    {
+        { TokenKind::Identifier,        "x1" },
+        { TokenKind::Identifier,        "_y" },
+        { TokenKind::PpNumber,          "0x1Fu" },
+        { TokenKind::PpNumber,          "1.5e+3f" },
+        { TokenKind::PpNumber,          ".5" },
+        { TokenKind::CharacterConstant, "'a'" },
+        { TokenKind::CharacterConstant, "L'\\''" },
+        { TokenKind::StringLiteral,     "\"s\\\"t\"" },
+        { TokenKind::StringLiteral,     "u8\"u\"" },
+        { TokenKind::Punctuator,        "->" }
+    };
+
+    EXPECT_EQ(tokens, expected);
+}
+
+
+//
+// Punctuators take the longest match.
+//
+
+TEST(CLexerTest, Punctuators)
+{
+    auto tokens = lex("<<=<<<...>>=%:%:..a+++b");
+    std::vector<std::string> texts;
+    for (auto &token : tokens)
+    {
+        texts.push_back(token.second);
+    }
+
+    std::vector<std::string> expected = { "<<=", "<<", "<", "...", ">>=", "%:%:", ".", ".", "a", "++", "+", "b" };
+    EXPECT_EQ(texts, expected);
+}
+
+
+//
+// Keywords and punctuators say which one they are.
+//
+
+TEST(CLexerTest, KeywordsAndPunctuators)
+{
+    std::string text = "while (_Static_assert) int_ inte in -> %:%: return";
+    TokenStream tokens;
+    CLexer lexer(text);
+    lexer.lexAll(&tokens);
+
+    ASSERT_EQ(tokens.size(), 10u);
+    EXPECT_EQ(tokens.keyword(0), Keyword::While);
+    EXPECT_EQ(tokens.punctuator(1), Punctuator::LeftParen);
+    EXPECT_EQ(tokens.keyword(2), Keyword::StaticAssert);
+    EXPECT_EQ(tokens.punctuator(3), Punctuator::RightParen);
+    EXPECT_EQ(tokens.keyword(4), Keyword::None);
+    EXPECT_EQ(tokens.keyword(5), Keyword::None);
+    EXPECT_EQ(tokens.keyword(6), Keyword::None);
+    EXPECT_EQ(tokens.punctuator(7), Punctuator::MinusGreater);
+    EXPECT_EQ(tokens.punctuator(8), Punctuator::PercentColonPercentColon);
+    EXPECT_EQ(tokens[9].keyword(), Keyword::Return);
+    EXPECT_EQ(tokens[9].punctuator(), Punctuator::None);
+}
+
+
+//
+// Whitespace and comments are skipped and recorded in the flags.
+//
+
+TEST(CLexerTest, WhitespaceAndComments)
+{
+    std::string text = "a/* x */b // y \\\n still a comment\n  #c\\\nd";
+    TokenStream tokens;
+    CLexer lexer(text, 7);
+    lexer.lexAll(&tokens);
+
+    ASSERT_EQ(tokens.size(), 5u);
+    EXPECT_EQ(tokens[0].text(text), "a");
+    EXPECT_TRUE(tokens[0].startOfLine());
+    EXPECT_EQ(tokens[1].text(text), "b");
+    EXPECT_TRUE(tokens[1].precededBySpace());
+    EXPECT_FALSE(tokens[1].startOfLine());
+    EXPECT_EQ(tokens[2].text(text), "#");
+    EXPECT_TRUE(tokens[2].startOfLine());
+    EXPECT_EQ(tokens[3].text(text), "c");
+    EXPECT_FALSE(tokens[3].precededBySpace());
+    EXPECT_EQ(tokens[4].text(text), "d");
+    EXPECT_FALSE(tokens[4].startOfLine());
+
+    EXPECT_EQ(tokens[2].loc(), SourceLoc(7, 36));
+}
+
+
+//
+// Identifiers and numbers which are scanned directly stop in the same
+// places as the DFA, and the ones the DFA has to finish are left to it.
+//
+
+TEST(CLexerTest, ScannedTokens)
+{
+    auto tokens = lex("abc\\u00e9d 0xe+1 1e-5+2 1.2.3p+x L\"w\" u'c' u8 U \xc3\xa9t\xc3\xa9 9\xc3\xa9 a.b\tLx\"s\"");
+    std::vector<std::pair<TokenKind, std::string>> expected =
+    {
+        { TokenKind::Identifier,        "abc\\u00e9d" },
+        { TokenKind::PpNumber,          "0xe+1" },
+        { TokenKind::PpNumber,          "1e-5" },
+        { TokenKind::Punctuator,        "+" },
+        { TokenKind::PpNumber,          "2" },
+        { TokenKind::PpNumber,          "1.2.3p+x" },
+        { TokenKind::StringLiteral,     "L\"w\"" },
+        { TokenKind::CharacterConstant, "u'c'" },
+        { TokenKind::Identifier,        "u8" },
+        { TokenKind::Identifier,        "U" },
+        { TokenKind::Identifier,        "\xc3\xa9t\xc3\xa9" },
+        { TokenKind::PpNumber,          "9\xc3\xa9" },
+        { TokenKind::Identifier,        "a" },
+        { TokenKind::Punctuator,        "." },
+        { TokenKind::Identifier,        "b" },
+        { TokenKind::Identifier,        "Lx" },
+        { TokenKind::StringLiteral,     "\"s\"" }
+    };
+
+    EXPECT_EQ(tokens, expected);
+}
+
+
+//
+// Characters which can't start a token come out one at a time.
+//
+
+TEST(CLexerTest, OtherCharacters)
+{
+    auto tokens = lex("`'x");
+    ASSERT_EQ(tokens.size(), 3u);
+    EXPECT_EQ(tokens[0].first, TokenKind::Other);
+    EXPECT_EQ(tokens[1].first, TokenKind::Other);
+    EXPECT_EQ(tokens[1].second, "'");
+    EXPECT_EQ(tokens[2].first, TokenKind::Identifier);
+}
+
+
+//
+// Relex an edited version of some text and check it gives the same tokens
+// as lexing it from scratch. Returns how many tokens were lexed.
+//
+
+static size_t expectRelexSame(const std::string &before, const std::string &after)
+{
+    TokenStream oldTokens;
+    CLexer oldLexer(before);
+    oldLexer.lexAll(&oldTokens);
+
+    TokenStream tokens;
+    CLexer lexer(after);
+    EXPECT_TRUE(lexer.relex(before, oldTokens, &tokens));
+
+    TokenStream expected;
+    CLexer fullLexer(after);
+    fullLexer.lexAll(&expected);
+
+    EXPECT_EQ(tokens.size(), expected.size()) << "relexing \"" << before << "\" to \"" << after << "\"";
+    for (size_t i = 0; i < tokens.size() && i < expected.size(); i++)
+    {
+        EXPECT_EQ(tokens.offset(i), expected.offset(i)) << "token " << i << " relexing \"" << before << "\" to \"" << after << "\"";
+        EXPECT_EQ(tokens.length(i), expected.length(i));
+        EXPECT_EQ(tokens.kind(i), expected.kind(i));
+        EXPECT_EQ(tokens.subKind(i), expected.subKind(i));
+        EXPECT_EQ(tokens.flags(i), expected.flags(i));
+    }
+
+    return lexer.lexedTokens();
+}
+
+
+TEST(CLexerTest, RelexEdits)
+{
+    std::string text = "int main(void)\n{\n    int a = 1;\n    return a + 2;\n}\n";
+
+    // Changes within a token, joining and splitting tokens, at the start
+    // and the end, and changes to the whitespace.
+    expectRelexSame(text, "int main(void)\n{\n    int ab = 1;\n    return ab + 2;\n}\n");
+    expectRelexSame(text, "int main(void)\n{\n    int a = 1;\n    return a++2;\n}\n");
+    expectRelexSame(text, "int main(void)\n{\n    int a = 1;\n    return a + + 2;\n}\n");
+    expectRelexSame(text, "long main(void)\n{\n    int a = 1;\n    return a + 2;\n}\n");
+    expectRelexSame(text, "int main(void)\n{\n    int a = 1;\n    return a + 2;\n}");
+    expectRelexSame(text, "int main(void)\n{    int a = 1;\n    return a + 2;\n}\n");
+    expectRelexSame(text, "");
+    expectRelexSame("", text);
+
+    // Comments and strings which swallow or release following tokens.
+    expectRelexSame(text, "int main(void)\n{\n    /* int a = 1;\n    return a */ + 2;\n}\n");
+    expectRelexSame(text, "int main(void)\n{\n    int a = 1; // \\\n    return a + 2;\n}\n");
+    expectRelexSame(text, "int main(void)\n{\n    int a = \"1;\n    return a + 2;\n}\n");
+    expectRelexSame("a /* b */ c\nd\n", "a /* b  c\nd\n");
+    expectRelexSame("a /* b  c\nd\n", "a /* b */ c\nd\n");
+    expectRelexSame("x ... y\n", "x .. y\n");
+    expectRelexSame("x 1.e y\n", "x 1.e+ y\n");
+}
+
+
+//
+// A small change to a big file should only lex the tokens around the
+// change.
+//
+
+TEST(CLexerTest, RelexOnlyLexesChanges)
+{
+    std::string text;
+    for (int i = 0; i < 10000; i++)
+    {
+        text += "static int value" + std::to_string(i) + " = " + std::to_string(i) + "; /* comment */\n";
+    }
+
+    std::string edited = text;
+    edited.insert(text.size() / 2, "x");
+    EXPECT_LT(expectRelexSame(text, edited), 10u);
+
+    edited = text;
+    edited.erase(100, 1);
+    edited.erase(text.size() / 3, 2);
+    edited.insert(text.size() - 50, " y + z ");
+    EXPECT_LT(expectRelexSame(text, edited), 40u);
+
+    // Too big a change isn't worth relexing.
+    TokenStream oldTokens;
+    CLexer oldLexer(text);
+    oldLexer.lexAll(&oldTokens);
+    TokenStream tokens;
+    std::string rewritten = text.substr(CLexer::maxRelexChange * 2);
+    CLexer lexer(rewritten);
+    EXPECT_FALSE(lexer.relex(text, oldTokens, &tokens));
+}
+
+
+//
+// Random changes to C code, checked against lexing from scratch.
+//
+
+TEST(CLexerTest, RelexRandomEdits)
+{
+    const std::string pieces[] = { "a", "1", "+", ".", "=", " ", "\n", "/*", "*/", "//", "\"", "'", "\\", "int", "e" };
+    std::string text = "int f(int x)\n{\n    /* add one */\n    return x + 1.5e3; // done\n}\nchar *s = \"str\\n\";\nchar c = 'c';\n";
+    srand(2);
+    for (int test = 0; test < 500; test++)
+    {
+        std::string edited = text;
+        for (int edit = rand() % 3 + 1; edit > 0; edit--)
+        {
+            size_t pos = rand() % (edited.size() + 1);
+            if (rand() % 3 == 0 && pos < edited.size())
+            {
+                edited.erase(pos, rand() % 4 + 1);
+            }
+            else
+            {
+                edited.insert(pos, pieces[rand() % (sizeof(pieces) / sizeof(pieces[0]))]);
+            }
+        }
+
+        expectRelexSame(text, edited);
+        if (rand() % 4 == 0)
+        {
+            text = edited;
+        }
+    }
+}
+
+
+} // namespace deepC
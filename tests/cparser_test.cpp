@@ -0,0 +1,186 @@
+#include <string>
+#include <gtest/gtest.h>
+
+#include "clexer.h"
+#include "cparser.h"
+#include "pptokenstream.h"
+
+
+namespace deepC
+{
+
+
+//
+// Lex some text into a stream of preprocessed tokens.
+//
+
+static PpTokenStream lex(const std::string &text)
+{
+    TokenStream tokens;
+    CLexer lexer(text);
+    lexer.lexAll(&tokens);
+
+    PpTokenStream stream;
+    for (size_t i = 0; i < tokens.size(); i++)
+    {
+        if (tokens.kind(i) == TokenKind::EndOfFile)
+            break;
+
+        stream.push_back(tokens.kind(i), tokens.subKind(i), tokens.flags(i), PpTokenStream::noIdent, tokens.text(i, text), tokens.loc(i), tokens.loc(i));
+    }
+
+    return stream;
+}
+
+
+//
+// Find the first node for a rule, depth first.
+//
+
+static const ParseNode *find(const ParseNode *node, Rule rule)
+{
+    for (; node != nullptr; node = node->next)
+    {
+        if (node->rule == rule)
+            return node;
+
+        const ParseNode *found = find(node->child, rule);
+        if (found != nullptr)
+            return found;
+    }
+
+    return nullptr;
+}
+
+
+//
+// Parse some text and give the S-expression of the first node for a rule.
+//
+
+static std::string parse(const std::string &text, Rule rule = Rule::TranslationUnit)
+{
+    PpTokenStream tokens = lex(text);
+    CParser parser(tokens);
+    const ParseNode *root = parser.parse();
+    return ParseTree::toText(find(root, rule), tokens);
+}
+
+
+static std::string statement(const std::string &text, Rule rule)
+{
+    return parse("void f(void) { " + text + " }", rule);
+}
+
+
+TEST(CParserTest, Expressions)
+{
+    EXPECT_EQ(statement("a - b - c;", Rule::AdditiveExpression), "(additive-expression (additive-expression a - b) - c)");
+    EXPECT_EQ(statement("a = b = c + d * e;", Rule::AssignmentExpression),
+              "(assignment-expression a = (assignment-expression b = (additive-expression c + (multiplicative-expression d * e))))");
+    EXPECT_EQ(statement("f(x, 1)[2].m->n++;", Rule::PostfixExpression),
+              "(postfix-expression (postfix-expression (postfix-expression (postfix-expression (postfix-expression f ( "
+              "(argument-expression-list x , 1) )) [ 2 ]) . m) -> n) ++)");
+    EXPECT_EQ(statement("x = c ? -a : !b;", Rule::ConditionalExpression), "(conditional-expression c ? (unary-expression - a) : (unary-expression ! b))");
+    EXPECT_EQ(statement("s = \"a\" \"b\";", Rule::AssignmentExpression), "(assignment-expression s = \"a\" \"b\")");
+    EXPECT_EQ(statement("n = sizeof(int) + sizeof x;", Rule::AdditiveExpression),
+              "(additive-expression (unary-expression sizeof ( int )) + (unary-expression sizeof x))");
+    EXPECT_EQ(statement("t = _Generic(x, int: 1, default: 2);", Rule::GenericSelection),
+              "(generic-selection _Generic ( x , (generic-assoc-list (generic-association int : 1) , (generic-association default : 2)) ))");
+}
+
+
+TEST(CParserTest, CastsAndCompoundLiterals)
+{
+    EXPECT_EQ(statement("x = (long)(y);", Rule::CastExpression), "(cast-expression ( long ) (primary-expression ( y )))");
+    EXPECT_EQ(statement("x = (y);", Rule::AssignmentExpression), "(assignment-expression x = (primary-expression ( y )))");
+    EXPECT_EQ(statement("p = (int []){ 1, 2, };", Rule::CastExpression),
+              "(cast-expression ( (type-name int [ ]) ) { (initializer-list 1 , 2) , })");
+}
+
+
+TEST(CParserTest, Declarations)
+{
+    EXPECT_EQ(parse("int a, *b = &a, c[3];", Rule::ExternalDeclaration),
+              "(external-declaration int a , (init-declarator-list (init-declarator (declarator * b) = (unary-expression & a)) , "
+              "(direct-declarator c [ 3 ])) ;)");
+    EXPECT_EQ(parse("static const char *s;", Rule::DeclarationSpecifiers),
+              "(declaration-specifiers static (declaration-specifiers const char))");
+    EXPECT_EQ(parse("int f(int x, char *, ...) { return x; }", Rule::ParameterTypeList),
+              "(parameter-type-list (parameter-list (parameter-declaration int x) , (parameter-declaration char *)) , ...)");
+    EXPECT_EQ(parse("struct s { int a : 3; union { int b; }; } v = { .a = 1, [0] = 2 };", Rule::Initializer),
+              "(initializer { (initializer-list (initializer-list (designation (designator . a) =) 1) , (designation (designator [ 0 ]) =) 2) })");
+    EXPECT_EQ(parse("enum e { A, B = 2, };", Rule::EnumSpecifier), "(enum-specifier enum e { (enumerator-list A , (enumerator B = 2)) , })");
+    EXPECT_EQ(parse("_Static_assert(1, \"x\");", Rule::StaticAssertDeclaration), "(static_assert-declaration _Static_assert ( 1 , \"x\" ) ;)");
+    EXPECT_EQ(parse(""), "");
+}
+
+
+//
+// Whether an identifier is a typedef name depends on the declarations in
+// scope.
+//
+
+TEST(CParserTest, TypedefNames)
+{
+    EXPECT_EQ(parse("typedef int T; void f(void) { T * x; }", Rule::CompoundStatement),
+              "(compound-statement { (declaration T (declarator * x) ;) })");
+    EXPECT_EQ(parse("int T; void f(void) { T * x; }", Rule::CompoundStatement),
+              "(compound-statement { (expression-statement (multiplicative-expression T * x) ;) })");
+    EXPECT_EQ(parse("typedef int T; void f(void) { { int T; T * x; } T * y; }", Rule::BlockItemList),
+              "(block-item-list (compound-statement { (block-item-list (declaration int T ;) (expression-statement (multiplicative-expression T * x) ;)) }) "
+              "(declaration T (declarator * y) ;))");
+    EXPECT_EQ(parse("typedef int T; void f(void) { struct S *const T; T * x; }", Rule::ExpressionStatement),
+              "(expression-statement (multiplicative-expression T * x) ;)");
+    EXPECT_NO_THROW(parse("typedef int T; struct S { unsigned T : 1; }; T x;"));
+    EXPECT_EQ(parse("typedef struct T T; T *p; int f(T x) { return (T)x; }", Rule::CastExpression), "(cast-expression ( T ) x)");
+    EXPECT_EQ(parse("typedef int A, *B; B b; A a;", Rule::TranslationUnit),
+              "(translation-unit (translation-unit (external-declaration (declaration-specifiers typedef int) A , (declarator * B) ;) (external-declaration B b ;)) "
+              "(external-declaration A a ;))");
+
+    // A typedef name can be redeclared in an inner scope or used as a label.
+    EXPECT_EQ(parse("typedef int T; void f(void) { T T = 1; T * x; }", Rule::BlockItemList),
+              "(block-item-list (declaration T (init-declarator T = 1) ;) (expression-statement (multiplicative-expression T * x) ;))");
+    EXPECT_EQ(parse("typedef int T; void f(void) { T: ; goto T; }", Rule::LabeledStatement), "(labeled-statement T : ;)");
+    EXPECT_EQ(parse("typedef int T; int x = _Generic(0, T: 1);", Rule::GenericAssociation), "(generic-association T : 1)");
+    EXPECT_NO_THROW(parse("typedef int T; struct S { T : 3; T t; }; T y;"));
+}
+
+
+TEST(CParserTest, Statements)
+{
+    EXPECT_EQ(statement("if (a) if (b) x; else y;", Rule::SelectionStatement),
+              "(selection-statement if ( a ) (selection-statement if ( b ) (expression-statement x ;) else (expression-statement y ;)))");
+    EXPECT_EQ(statement("for (int i = 0; i < n; i++) ;", Rule::IterationStatement),
+              "(iteration-statement for ( (declaration int (init-declarator i = 0) ;) (relational-expression i < n) ; (postfix-expression i ++) ) ;)");
+    EXPECT_EQ(statement("for (;;) break;", Rule::IterationStatement), "(iteration-statement for ( ; ; ) break ;)");
+    EXPECT_EQ(statement("l: do x--; while (x); goto l;", Rule::LabeledStatement),
+              "(labeled-statement l : (iteration-statement do (expression-statement (postfix-expression x --) ;) while ( x ) ;))");
+    EXPECT_EQ(statement("switch (x) { case 1: default: return; }", Rule::LabeledStatement),
+              "(labeled-statement case 1 : (labeled-statement default : return ;))");
+}
+
+
+TEST(CParserTest, Errors)
+{
+    EXPECT_THROW(parse("int x = ;"), ParserException);
+    EXPECT_THROW(parse("int f(void) { return 1 }"), ParserException);
+    EXPECT_THROW(parse("int x"), ParserException);
+    EXPECT_THROW(parse("x;"), ParserException);
+
+    // Source nested too deeply is an error rather than running out of stack.
+    EXPECT_NO_THROW(statement("x = " + std::string(200, '(') + "1" + std::string(200, ')') + ";", Rule::AssignmentExpression));
+    EXPECT_THROW(statement("x = " + std::string(10000, '(') + "1" + std::string(10000, ')') + ";", Rule::AssignmentExpression), ParserException);
+    EXPECT_THROW(parse("int " + std::string(10000, '*') + "p;"), ParserException);
+
+    try
+    {
+        parse("int f(void) { return 1 }");
+    }
+    catch (const ParserException &e)
+    {
+        EXPECT_EQ(std::string(e.what()), "expected ';' but found '}'");
+    }
+}
+
+
+} // namespace deepC
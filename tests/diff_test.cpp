@@ -0,0 +1,150 @@
+#include <cstdlib>
+#include <string>
+#include <vector>
+#include <gtest/gtest.h>
+
+#include "diff.h"
+
+
+namespace deepC
+{
+
+
+//
+// Apply an edit script to the old text to check it gives the new text.
+//
+
+static std::string applyEdits(const std::string &a, const std::string &b, const std::vector<DiffEdit> &edits)
+{
+    std::string result;
+    for (const DiffEdit &e : edits)
+    {
+        if (e.op() == DiffEdit::Op::Match)
+        {
+            result += a.substr(e.offset(), e.length());
+        }
+        else if (e.op() == DiffEdit::Op::Insert)
+        {
+            result += b.substr(e.offset(), e.length());
+        }
+    }
+
+    return result;
+}
+
+
+TEST(DiffTest, Same)
+{
+    std::string a = "hello\nthere\n";
+    Diff d(a, a);
+    std::vector<DiffEdit> edits;
+    EXPECT_EQ(d.diff(&edits), 0);
+    ASSERT_EQ(edits.size(), 1u);
+    EXPECT_EQ(edits[0].op(), DiffEdit::Op::Match);
+    EXPECT_EQ(edits[0].length(), a.size());
+}
+
+
+TEST(DiffTest, Insert)
+{
+    std::string a = "hello\nthere\nare\nyou?\n";
+    std::string b = "hello\nthere\nhow\nare\nyou?\n";
+
+    Diff d(a, b);
+    std::vector<DiffEdit> edits;
+    EXPECT_EQ(d.diff(&edits), 4);
+    ASSERT_EQ(edits.size(), 3u);
+    EXPECT_EQ(edits[1].op(), DiffEdit::Op::Insert);
+    EXPECT_EQ(edits[1].length(), 4u);
+    EXPECT_EQ(applyEdits(a, b, edits), b);
+}
+
+
+TEST(DiffTest, Delete)
+{
+    std::string a = "hello\nthere\nhow\nare\nyou?\n";
+    std::string b = "hello\nthere\nare\nyou?\n";
+
+    Diff d(a, b);
+    std::vector<DiffEdit> edits;
+    EXPECT_EQ(d.diff(&edits), 4);
+    ASSERT_EQ(edits.size(), 3u);
+    EXPECT_EQ(edits[1].op(), DiffEdit::Op::Delete);
+    EXPECT_EQ(edits[1].length(), 4u);
+    EXPECT_EQ(applyEdits(a, b, edits), b);
+}
+
+
+TEST(DiffTest, MultiPart)
+{
+    std::string a = "hello\nthere\nhow\nare\nyou?\nI\nam\na\nturnip.\n";
+    std::string b = "hello\nthere\nwho\nare\nyou?\nI\nam\nthe\nturnip.\n";
+
+    Diff d(a, b);
+    std::vector<DiffEdit> edits;
+    EXPECT_EQ(d.diff(&edits), 6);
+    EXPECT_EQ(applyEdits(a, b, edits), b);
+}
+
+
+//
+// Random edits to random text should always give a script which works,
+// and never cost more than the edits made.
+//
+
+TEST(DiffTest, RandomEdits)
+{
+    srand(1);
+    for (int test = 0; test < 200; test++)
+    {
+        std::string a;
+        size_t size = rand() % 200;
+        for (size_t i = 0; i < size; i++)
+        {
+            a += "abc\n"[rand() % 4];
+        }
+
+        std::string b = a;
+        int maxCost = 0;
+        for (int edit = rand() % 6; edit > 0; edit--)
+        {
+            size_t pos = b.empty() ? 0 : rand() % b.size();
+            if (rand() % 2 && !b.empty())
+            {
+                b.erase(pos, 1);
+            }
+            else
+            {
+                b.insert(pos, 1, "abcd"[rand() % 4]);
+            }
+
+            maxCost++;
+        }
+
+        Diff d(a, b);
+        std::vector<DiffEdit> edits;
+        ssize_t cost = d.diff(&edits);
+        EXPECT_LE(cost, maxCost);
+        EXPECT_EQ(applyEdits(a, b, edits), b);
+    }
+}
+
+
+TEST(DiffTest, MaxCost)
+{
+    std::string a(1000, 'a');
+    std::string b = "x" + a.substr(100) + "yyyy";
+
+    Diff d(a, b);
+    std::vector<DiffEdit> edits;
+    d.setMaxCost(100);
+    EXPECT_EQ(d.diff(&edits), -1);
+    EXPECT_TRUE(edits.empty());
+
+    d.setMaxCost(105);
+    EXPECT_EQ(d.diff(&edits), 105);
+    EXPECT_EQ(applyEdits(a, b, edits), b);
+}
+
+
+} // namespace deepC
@@ -0,0 +1,65 @@
+#include <gtest/gtest.h>
+
+#include "hideset.h"
+
+
+namespace deepC
+{
+
+
+//
+// Each set is made once, however it's arrived at.
+//
+
+TEST(HideSetTest, Shared)
+{
+    HideSetTable table;
+    const HideSet *a = table.add(table.add(nullptr, 5), 3);
+    const HideSet *b = table.add(table.add(nullptr, 3), 5);
+    EXPECT_EQ(a, b);
+    EXPECT_EQ(table.add(a, 3), a);
+    EXPECT_EQ(table.unite(a, table.add(nullptr, 5)), a);
+    EXPECT_EQ(table.size(), 3u);
+
+    ASSERT_EQ(a->size, 2u);
+    EXPECT_EQ(a->ids[0], 3u);
+    EXPECT_EQ(a->ids[1], 5u);
+}
+
+
+TEST(HideSetTest, Operations)
+{
+    HideSetTable table;
+    const HideSet *a = nullptr;
+    const HideSet *b = nullptr;
+    for (Interner::Id id = 1; id <= 20; id++)
+    {
+        a = table.add(a, id);
+        if (id % 2 == 0)
+        {
+            b = table.add(b, id);
+        }
+    }
+
+    b = table.add(b, 21);
+    EXPECT_TRUE(HideSetTable::contains(a, 20));
+    EXPECT_FALSE(HideSetTable::contains(a, 21));
+    EXPECT_FALSE(HideSetTable::contains(nullptr, 1));
+
+    const HideSet *both = table.intersect(a, b);
+    ASSERT_NE(both, nullptr);
+    EXPECT_EQ(both->size, 10u);
+    EXPECT_FALSE(both->contains(21));
+    EXPECT_EQ(table.intersect(b, a), both);
+
+    const HideSet *either = table.unite(a, b);
+    EXPECT_EQ(either->size, 21u);
+    EXPECT_EQ(either, table.add(a, 21));
+
+    EXPECT_EQ(table.unite(nullptr, a), a);
+    EXPECT_EQ(table.intersect(a, nullptr), nullptr);
+    EXPECT_EQ(table.intersect(table.add(nullptr, 1), table.add(nullptr, 2)), nullptr);
+}
+
+
+} // namespace deepC
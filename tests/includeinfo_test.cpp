@@ -0,0 +1,99 @@
+#include <string>
+#include <vector>
+#include <gtest/gtest.h>
+
+#include "clexer.h"
+#include "includeinfo.h"
+
+
+namespace deepC
+{
+
+
+//
+// Scan the includes of some text.
+//
+
+static IncludeInfo scan(const std::string &text)
+{
+    TokenStream tokens;
+    CLexer lexer(text);
+    lexer.lexAll(&tokens);
+
+    IncludeInfo info(1, ContentDigest(text));
+    info.scan(tokens, text);
+    return info;
+}
+
+
+TEST(IncludeInfoTest, Includes)
+{
+    IncludeInfo info = scan("#include \"a.h\"\n"
+                            "  # include <sys/stat.h>\n"
+                            "#include HEADER(x)\n"
+                            "int include; x # include <no.h>\n"
+                            "#if 0\n"
+                            "%:include \"b.h\" // comment\n"
+                            "#endif\n");
+    std::vector<IncludeInfo::Include> expected =
+    {
+        { "a.h",        false, false },
+        { "sys/stat.h", true,  false },
+        { "HEADER(x)",  false, true },
+        { "b.h",        false, false }
+    };
+
+    EXPECT_EQ(info.includes(), expected);
+    EXPECT_EQ(info.guard(), IncludeInfo::Guard::None);
+}
+
+
+TEST(IncludeInfoTest, IfndefGuard)
+{
+    const char *guarded[] =
+    {
+        "#ifndef A_H\n#define A_H\nint a;\n#endif\n",
+        "/* Copyright */\n#ifndef A_H\n#define A_H 1\n#ifdef X\n#else\n#endif\n#endif // A_H\n/* end */\n",
+        "#if !defined A_H\n#define A_H\n#endif\n",
+        "#if !defined(A_H)\n#define A_H\n#include <b.h>\n#endif\n"
+    };
+
+    for (const char *text : guarded)
+    {
+        IncludeInfo info = scan(text);
+        EXPECT_EQ(info.guard(), IncludeInfo::Guard::IfndefGuard) << text;
+        EXPECT_EQ(info.guardMacro(), "A_H") << text;
+    }
+
+    const char *unguarded[] =
+    {
+        "int a;\n#ifndef A_H\n#define A_H\n#endif\n",
+        "#ifndef A_H\n#define A_H\n#endif\nint a;\n",
+        "#ifndef A_H\n#define B_H\n#endif\n",
+        "#ifndef A_H\nint a;\n#define A_H\n#endif\n",
+        "#ifndef A_H\n#define A_H\n#else\nint a;\n#endif\n",
+        "#ifndef A_H\n#define A_H\n#endif\n#ifndef A_H\n#endif\n",
+        "#if !defined(A_H) || 1\n#define A_H\n#endif\n",
+        "#ifndef A_H\n#define A_H\n"
+    };
+
+    for (const char *text : unguarded)
+    {
+        IncludeInfo info = scan(text);
+        EXPECT_EQ(info.guard(), IncludeInfo::Guard::None) << text;
+        EXPECT_EQ(info.guardMacro(), "") << text;
+    }
+}
+
+
+TEST(IncludeInfoTest, PragmaOnce)
+{
+    EXPECT_EQ(scan("// header\n#pragma once\nint a;\n").guard(), IncludeInfo::Guard::PragmaOnce);
+    EXPECT_EQ(scan("#ifndef A_H\n#define A_H\n#pragma once\n#endif\n").guard(), IncludeInfo::Guard::IfndefGuard);
+    EXPECT_EQ(scan("#pragma once\n#ifndef A_H\n#define A_H\n#endif\n").guard(), IncludeInfo::Guard::PragmaOnce);
+    EXPECT_EQ(scan("#ifdef X\n#pragma once\n#endif\n").guard(), IncludeInfo::Guard::None);
+    EXPECT_EQ(scan("#pragma pack\n").guard(), IncludeInfo::Guard::None);
+}
+
+
+} // namespace deepC
@@ -0,0 +1,137 @@
+#include <string>
+#include <thread>
+#include <vector>
+#include <gtest/gtest.h>
+
+#include "clexer.h"
+#include "interner.h"
+
+
+namespace deepC
+{
+
+
+TEST(InternerTest, SameTextSameId)
+{
+    Interner interner;
+    Interner::Id a = interner.intern("alpha");
+    Interner::Id b = interner.intern("beta");
+    EXPECT_EQ(a, 1u);
+    EXPECT_EQ(b, 2u);
+    EXPECT_EQ(interner.intern(std::string("alp") + "ha"), a);
+    EXPECT_EQ(interner.find("beta"), b);
+    EXPECT_EQ(interner.find("gamma"), Interner::none);
+    EXPECT_EQ(interner.text(b), "beta");
+    EXPECT_EQ(interner.size(), 2u);
+}
+
+
+TEST(InternerTest, ManyIdentifiers)
+{
+    Interner interner;
+    for (int i = 0; i < 100000; i++)
+    {
+        EXPECT_EQ(interner.intern("id_" + std::to_string(i)), static_cast<Interner::Id>(i + 1));
+    }
+
+    for (int i = 0; i < 100000; i += 997)
+    {
+        std::string name = "id_" + std::to_string(i);
+        EXPECT_EQ(interner.find(name), static_cast<Interner::Id>(i + 1));
+        EXPECT_EQ(interner.text(i + 1), name);
+    }
+}
+
+
+//
+// Threads interning overlapping sets of identifiers should agree on the
+// ids, and the ids should be dense.
+//
+
+TEST(InternerTest, Concurrent)
+{
+    const int numThreads = 8;
+    const int numNames = 20000;
+    Interner interner;
+    std::vector<std::vector<Interner::Id>> ids(numThreads, std::vector<Interner::Id>(numNames));
+
+    std::vector<std::thread> threads;
+    for (int t = 0; t < numThreads; t++)
+    {
+        threads.emplace_back([&, t]()
+        {
+            for (int i = 0; i < numNames; i++)
+            {
+                int n = (i * 7 + t * 1000) % numNames;
+                ids[t][n] = interner.intern("name" + std::to_string(n));
+            }
+        });
+    }
+
+    for (auto &thread : threads)
+    {
+        thread.join();
+    }
+
+    EXPECT_EQ(interner.size(), static_cast<size_t>(numNames));
+    for (int n = 0; n < numNames; n++)
+    {
+        for (int t = 1; t < numThreads; t++)
+        {
+            ASSERT_EQ(ids[t][n], ids[0][n]);
+        }
+
+        EXPECT_EQ(interner.text(ids[0][n]), "name" + std::to_string(n));
+    }
+}
+
+
+TEST(InternerTest, LexerInternsIdentifiers)
+{
+    std::string text = "int x = y + x;";
+    Interner interner;
+    TokenStream tokens;
+    CLexer lexer(text);
+    lexer.setInterner(&interner);
+    lexer.lexAll(&tokens);
+
+    ASSERT_EQ(tokens.size(), 7u);
+    EXPECT_EQ(tokens.identId(0), interner.find("int"));
+    EXPECT_EQ(tokens.identId(1), tokens.identId(5));
+    EXPECT_NE(tokens.identId(1), tokens.identId(3));
+    EXPECT_EQ(tokens.identId(2), TokenStream::noIdent);
+}
+
+
+//
+// Ids only need mapping to the program database's once they differ.
+//
+
+TEST(InternerTest, StoredIds)
+{
+    Interner interner;
+    Interner::Id a = interner.intern("a");
+    Interner::Id b = interner.intern("b");
+    interner.setStoredId(a, 1);
+    interner.setSavedCount(1);
+    EXPECT_FALSE(interner.storedIdsDiffer());
+    EXPECT_EQ(interner.toStored(a), 1u);
+    EXPECT_EQ(interner.fromStored(1), a);
+    EXPECT_EQ(interner.fromStored(2), Interner::none);
+
+    interner.setStoredId(b, 3);
+    Interner::Id c = interner.intern("c");
+    interner.setStoredId(c, 2);
+    interner.setSavedCount(3);
+    EXPECT_TRUE(interner.storedIdsDiffer());
+    EXPECT_EQ(interner.storedCount(), 3u);
+    EXPECT_EQ(interner.toStored(a), 1u);
+    EXPECT_EQ(interner.toStored(b), 3u);
+    EXPECT_EQ(interner.toStored(c), 2u);
+    EXPECT_EQ(interner.fromStored(3), b);
+    EXPECT_EQ(interner.fromStored(2), c);
+    EXPECT_EQ(interner.fromStored(4), Interner::none);
+}
+
+
+} // namespace deepC
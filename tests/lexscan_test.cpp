@@ -0,0 +1,162 @@
+#include <cstdlib>
+#include <initializer_list>
+#include <string>
+#include <vector>
+#include <gtest/gtest.h>
+
+#include "clexer.h"
+#include "lexscan.h"
+
+
+namespace deepC
+{
+
+
+//
+// The kernels this CPU can run.
+//
+
+static std::vector<const ScanKernels *> availableKernels()
+{
+    std::vector<const ScanKernels *> kernels;
+    for (ScanLevel level : { ScanLevel::Portable, ScanLevel::Sse42, ScanLevel::Avx2 })
+    {
+        if (const ScanKernels *levelKernels = scanKernels(level))
+        {
+            kernels.push_back(levelKernels);
+        }
+    }
+
+    return kernels;
+}
+
+
+//
+// Make some text out of characters which start and end every kind of run.
+//
+
+static std::string randomText(size_t size)
+{
+    const char chars[] = "  \t\t\t aZ_09.+-*/#%'\n\\\x80\xff\0\"";
+    std::string text;
+    for (size_t i = 0; i < size; i++)
+    {
+        // Long runs of one kind of character now and then.
+        size_t run = (rand() % 8 == 0) ? rand() % 80 : 1;
+        char ch = chars[rand() % (sizeof(chars) - 1)];
+        text.append(run, ch);
+    }
+
+    return text;
+}
+
+
+TEST(LexScanTest, PortableAlwaysAvailable)
+{
+    ASSERT_NE(scanKernels(ScanLevel::Portable), nullptr);
+    EXPECT_NE(bestScanKernels().name, nullptr);
+}
+
+
+TEST(LexScanTest, Runs)
+{
+    for (const ScanKernels *kernels : availableKernels())
+    {
+        std::string text = std::string(40, ' ') + "\t x";
+        EXPECT_EQ(kernels->skipBlanks(text.data(), 0, text.size()), 42u) << kernels->name;
+
+        text = "abcdefghijklmnopqrstuvwxyzABCDEFGHIJKLMNOPQRSTUVWXYZ_0123456789\xc3\xa9.x";
+        EXPECT_EQ(kernels->skipIdentifier(text.data(), 0, text.size()), text.size() - 2) << kernels->name;
+        EXPECT_EQ(kernels->skipNumber(text.data(), 0, text.size()), text.size()) << kernels->name;
+
+        text = std::string(50, '*') + "/ */";
+        EXPECT_EQ(kernels->findCommentEnd(text.data(), 0, text.size()), 49u) << kernels->name;
+        EXPECT_EQ(kernels->findCommentEnd(text.data(), 51, text.size()), 52u) << kernels->name;
+        EXPECT_EQ(kernels->findCommentEnd(text.data(), 51, text.size() - 1), text.size() - 1) << kernels->name;
+
+        text = std::string(70, 'x') + "\\\n";
+        EXPECT_EQ(kernels->findLineBreak(text.data(), 0, text.size()), 70u) << kernels->name;
+        EXPECT_EQ(kernels->findLineBreak(text.data(), 71, text.size()), 71u) << kernels->name;
+
+        text = std::string(35, 'x') + "#%/\"'";
+        EXPECT_EQ(kernels->findSkipStop(text.data(), 0, text.size()), 35u) << kernels->name;
+        for (size_t i = 35; i < text.size(); i++)
+        {
+            EXPECT_EQ(kernels->findSkipStop(text.data(), i, text.size()), i) << kernels->name;
+        }
+
+        EXPECT_EQ(kernels->findSkipStop(text.data(), 0, 35), 35u) << kernels->name;
+    }
+}
+
+
+//
+// Every kernel gives the same answer as the portable one from every
+// position, including ones near the end of the text where only part of a
+// block is left.
+//
+
+TEST(LexScanTest, MatchesPortable)
+{
+    const ScanKernels *portable = scanKernels(ScanLevel::Portable);
+    srand(3);
+    for (int test = 0; test < 20; test++)
+    {
+        std::string text = randomText(rand() % 200);
+        for (const ScanKernels *kernels : availableKernels())
+        {
+            for (size_t pos = 0; pos <= text.size(); pos++)
+            {
+                const char *data = text.data();
+                size_t size = text.size();
+                EXPECT_EQ(kernels->skipBlanks(data, pos, size), portable->skipBlanks(data, pos, size)) << kernels->name << " at " << pos;
+                EXPECT_EQ(kernels->skipIdentifier(data, pos, size), portable->skipIdentifier(data, pos, size)) << kernels->name << " at " << pos;
+                EXPECT_EQ(kernels->skipNumber(data, pos, size), portable->skipNumber(data, pos, size)) << kernels->name << " at " << pos;
+                EXPECT_EQ(kernels->findCommentEnd(data, pos, size), portable->findCommentEnd(data, pos, size)) << kernels->name << " at " << pos;
+                EXPECT_EQ(kernels->findLineBreak(data, pos, size), portable->findLineBreak(data, pos, size)) << kernels->name << " at " << pos;
+                EXPECT_EQ(kernels->findSkipStop(data, pos, size), portable->findSkipStop(data, pos, size)) << kernels->name << " at " << pos;
+            }
+        }
+    }
+}
+
+
+//
+// The lexer gives the same tokens whichever kernels it uses.
+//
+
+TEST(LexScanTest, LexerMatchesPortable)
+{
+    const char *pieces[] = { "identifier_name", "0x1e+5", " ", "        ", "\t", "\n", "/* comment */", "// comment \\\n more\n", "\"s\"", "'c'", "L", "+", ".", "\\" };
+    srand(4);
+    std::string text;
+    for (int i = 0; i < 2000; i++)
+    {
+        text += pieces[rand() % (sizeof(pieces) / sizeof(pieces[0]))];
+    }
+
+    TokenStream expected;
+    CLexer portableLexer(text);
+    portableLexer.setScanKernels(*scanKernels(ScanLevel::Portable));
+    portableLexer.lexAll(&expected);
+
+    for (const ScanKernels *kernels : availableKernels())
+    {
+        TokenStream tokens;
+        CLexer lexer(text);
+        lexer.setScanKernels(*kernels);
+        lexer.lexAll(&tokens);
+
+        ASSERT_EQ(tokens.size(), expected.size()) << kernels->name;
+        for (size_t i = 0; i < tokens.size(); i++)
+        {
+            EXPECT_EQ(tokens.offset(i), expected.offset(i)) << kernels->name << " token " << i;
+            EXPECT_EQ(tokens.length(i), expected.length(i));
+            EXPECT_EQ(tokens.kind(i), expected.kind(i));
+            EXPECT_EQ(tokens.flags(i), expected.flags(i));
+        }
+    }
+}
+
+
+} // namespace deepC
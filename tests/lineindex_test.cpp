@@ -0,0 +1,129 @@
+#include <string>
+#include <string_view>
+#include <vector>
+#include <random>
+#include <gtest/gtest.h>
+
+#include "lineindex.h"
+
+
+namespace deepC
+{
+
+
+//
+// Split text into lines the slow, obvious way.
+//
+
+static std::vector<std::string_view> splitLines(std::string_view text)
+{
+    std::vector<std::string_view> lines;
+    size_t pos = 0;
+    while (pos < text.size())
+    {
+        size_t nl = text.find('\n', pos);
+        if (nl == std::string_view::npos)
+        {
+            lines.push_back(text.substr(pos));
+            break;
+        }
+
+        lines.push_back(text.substr(pos, nl - pos));
+        pos = nl + 1;
+    }
+
+    return lines;
+}
+
+
+//
+// Check an index against the obvious way of doing it.
+//
+
+static void checkIndex(const std::string &text)
+{
+    LineIndex index;
+    index.build(text);
+
+    std::vector<std::string_view> lines = splitLines(text);
+    ASSERT_EQ(index.lineCount(), lines.size()) << text;
+    for (size_t i = 0; i < lines.size(); i++)
+    {
+        EXPECT_EQ(index.line(text, i), lines[i]);
+        EXPECT_EQ(index.lineOf(index.lineStart(i)), i);
+        EXPECT_EQ(index.lineOf(index.lineEnd(i)), i);
+    }
+}
+
+
+TEST(LineIndexTest, EdgeCases)
+{
+    checkIndex("");
+    checkIndex("\n");
+    checkIndex("\n\n");
+    checkIndex("a");
+    checkIndex("a\n");
+    checkIndex("a\nb");
+    checkIndex("\na\n\nb\n");
+    checkIndex(std::string(100, 'x') + "\n" + std::string(100, 'y'));
+}
+
+
+//
+// The vector scanners must match the scalar one exactly, including
+// newlines at the edges of each vector.
+//
+
+TEST(LineIndexTest, VectorScannersMatchScalar)
+{
+    std::mt19937 rng(1234);
+    for (int run = 0; run < 500; run++)
+    {
+        std::string text(rng() % 300, 'a');
+        for (char &c : text)
+        {
+            if (rng() % 6 == 0)
+            {
+                c = '\n';
+            }
+        }
+
+        std::vector<uint32_t> scalar;
+        std::vector<uint32_t> sse2;
+        std::vector<uint32_t> avx2;
+        std::vector<uint32_t> best;
+        LineIndex::scanScalar(text.data(), text.size(), 5, &scalar);
+        LineIndex::scanSse2(text.data(), text.size(), 5, &sse2);
+        LineIndex::scanAvx2(text.data(), text.size(), 5, &avx2);
+        LineIndex::scan(text.data(), text.size(), 5, &best);
+        EXPECT_EQ(sse2, scalar);
+        EXPECT_EQ(avx2, scalar);
+        EXPECT_EQ(best, scalar);
+
+        checkIndex(text);
+    }
+}
+
+
+//
+// A table which has been saved and loaded again gives the same lines.
+//
+
+TEST(LineIndexTest, Assign)
+{
+    std::string text = "first\nsecond\n\nfourth";
+    LineIndex original;
+    original.build(text);
+
+    std::vector<uint32_t> saved(original.table(), original.table() + original.tableSize());
+    LineIndex loaded;
+    loaded.assign(saved.data(), saved.size());
+
+    ASSERT_EQ(loaded.lineCount(), 4u);
+    EXPECT_EQ(loaded.line(text, 0), "first");
+    EXPECT_EQ(loaded.line(text, 2), "");
+    EXPECT_EQ(loaded.line(text, 3), "fourth");
+}
+
+
+} // namespace deepC
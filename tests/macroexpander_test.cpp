@@ -0,0 +1,291 @@
+#include <memory>
+#include <string>
+#include <vector>
+#include <gtest/gtest.h>
+
+#include "clexer.h"
+#include "macroexpander.h"
+#include "ppexpression.h"
+#include "preprocessor.h"
+
+
+namespace deepC
+{
+
+
+//
+// Lex some text into tokens for the expander. The text has to outlive
+// the tokens.
+//
+
+static std::vector<PpToken> lex(const std::string &text)
+{
+    TokenStream tokens;
+    CLexer lexer(text);
+    lexer.lexAll(&tokens);
+
+    std::vector<PpToken> result;
+    for (size_t i = 0; i < tokens.size(); i++)
+    {
+        PpToken token;
+        token.kind = tokens.kind(i);
+        token.subKind = tokens.subKind(i);
+        token.flags = tokens.flags(i);
+        token.text = tokens.text(i, text);
+        token.loc = tokens.loc(i);
+        result.push_back(token);
+    }
+
+    return result;
+}
+
+
+//
+// Expand the macros in some text, giving the tokens separated by spaces.
+//
+
+static std::string expand(MacroExpander &expander, const std::string &text)
+{
+    std::vector<PpToken> input = lex(text);
+    MacroExpander::VectorSource source(input);
+    std::vector<PpToken> out;
+    expander.expand(source, &out);
+
+    std::string result;
+    for (const PpToken &token : out)
+    {
+        if (!result.empty())
+        {
+            result.push_back(' ');
+        }
+
+        result += token.text;
+    }
+
+    return result;
+}
+
+
+static std::string expand(MacroEnvironment &env, const std::string &text)
+{
+    MacroExpander expander(env);
+    return expand(expander, text);
+}
+
+
+//
+// Define macros.
+//
+
+static void define(MacroEnvironment &env, const std::string &name, const std::string &body)
+{
+    env.define(std::make_shared<Macro>(name, false, false, std::vector<std::string>(), body));
+}
+
+
+static void define(MacroEnvironment &env, const std::string &name, const std::vector<std::string> &params, const std::string &body, bool variadic = false)
+{
+    env.define(std::make_shared<Macro>(name, true, variadic, params, body));
+}
+
+
+//
+// Evaluate a #if expression.
+//
+
+static bool evaluate(MacroEnvironment &env, const std::string &text)
+{
+    std::vector<PpToken> input = lex(text);
+    MacroExpander expander(env);
+    expander.setKeepDefined(true);
+    MacroExpander::VectorSource source(input);
+    std::vector<PpToken> out;
+    expander.expand(source, &out);
+    return PpExpression::evaluate(out, env);
+}
+
+
+TEST(MacroExpanderTest, ObjectLike)
+{
+    MacroEnvironment env;
+    define(env, "A", "1 + B");
+    define(env, "B", "2");
+    define(env, "foo", "foo a");
+    define(env, "x", "y");
+    define(env, "y", "x");
+
+    EXPECT_EQ(expand(env, "A;"), "1 + 2 ;");
+    EXPECT_EQ(expand(env, "foo"), "foo a");
+    EXPECT_EQ(expand(env, "x y"), "x y");
+}
+
+
+TEST(MacroExpanderTest, FunctionLike)
+{
+    MacroEnvironment env;
+    define(env, "f", { "a" }, "a*2");
+    define(env, "max", { "a", "b" }, "((a) > (b) ? (a) : (b))");
+    define(env, "empty", {}, "e");
+
+    EXPECT_EQ(expand(env, "f(3) f"), "3 * 2 f");
+    EXPECT_EQ(expand(env, "f(f(1))"), "1 * 2 * 2");
+    EXPECT_EQ(expand(env, "max((1, 2), 3)"), "( ( ( 1 , 2 ) ) > ( 3 ) ? ( ( 1 , 2 ) ) : ( 3 ) )");
+    EXPECT_EQ(expand(env, "empty() empty"), "e empty");
+    EXPECT_THROW(expand(env, "max(1)"), MacroException);
+    EXPECT_THROW(expand(env, "f(1"), MacroException);
+}
+
+
+//
+// The examples of rescanning from the C standard.
+//
+
+TEST(MacroExpanderTest, Rescanning)
+{
+    MacroEnvironment env;
+    define(env, "x", "2");
+    define(env, "f", { "a" }, "f(x * (a))");
+    define(env, "g", "f");
+    define(env, "z", "z[0]");
+    define(env, "h", "g(~");
+    define(env, "m", { "a" }, "a(w)");
+    define(env, "w", "0,1");
+    define(env, "t", { "a" }, "a");
+    define(env, "p", {}, "int");
+    define(env, "q", { "x" }, "x");
+    define(env, "r", { "x", "y" }, "x ## y");
+
+    EXPECT_EQ(expand(env, "f(y+1) + f(f(z)) % t(t(g)(0) + t)(1);"),
+              "f ( 2 * ( y + 1 ) ) + f ( 2 * ( f ( 2 * ( z [ 0 ] ) ) ) ) % f ( 2 * ( 0 ) ) + t ( 1 ) ;");
+    EXPECT_EQ(expand(env, "g(x+(3,4)-w) | h 5) & m(f)^m(m);"),
+              "f ( 2 * ( 2 + ( 3 , 4 ) - 0 , 1 ) ) | f ( 2 * ( ~ 5 ) ) & f ( 2 * ( 0 , 1 ) ) ^ m ( 0 , 1 ) ;");
+    EXPECT_EQ(expand(env, "p() i[q()] = { q(1), r(2,3), r(4,), r(,5), r(,) };"),
+              "int i [ ] = { 1 , 23 , 4 , 5 , } ;");
+}
+
+
+TEST(MacroExpanderTest, StringizeAndPaste)
+{
+    MacroEnvironment env;
+    define(env, "str", { "s" }, "# s");
+    define(env, "xstr", { "s" }, "str(s)");
+    define(env, "cat", { "a", "b" }, "a ## b");
+    define(env, "N", "4");
+
+    EXPECT_EQ(expand(env, "str(strncmp(\"abc\\0d\", \"abc\", '\\4') == 0)"), "\"strncmp(\\\"abc\\\\0d\\\", \\\"abc\\\", '\\\\4') == 0\"");
+    EXPECT_EQ(expand(env, "str(N) xstr(N)"), "\"N\" \"4\"");
+    EXPECT_EQ(expand(env, "cat(N, 2) cat(x, y) cat(<, <=)"), "N2 xy <<=");
+    EXPECT_THROW(expand(env, "cat(+, -)"), MacroException);
+}
+
+
+TEST(MacroExpanderTest, Variadic)
+{
+    MacroEnvironment env;
+    define(env, "debug", { "__VA_ARGS__" }, "fprintf(stderr, __VA_ARGS__)", true);
+    define(env, "err", { "fmt", "__VA_ARGS__" }, "printf(fmt, ## __VA_ARGS__)", true);
+    define(env, "named", { "args" }, "g(args)", true);
+
+    EXPECT_EQ(expand(env, "debug(\"x\", a, b)"), "fprintf ( stderr , \"x\" , a , b )");
+    EXPECT_EQ(expand(env, "err(\"x\")"), "printf ( \"x\" )");
+    EXPECT_EQ(expand(env, "err(\"x\", 1, 2)"), "printf ( \"x\" , 1 , 2 )");
+    EXPECT_EQ(expand(env, "named(1, (2, 3))"), "g ( 1 , ( 2 , 3 ) )");
+}
+
+
+//
+// Macros looked up while recording are reads unless the recording has
+// already changed them.
+//
+
+TEST(MacroExpanderTest, Recording)
+{
+    MacroEnvironment env;
+    define(env, "A", "B");
+    env.beginRecording();
+    define(env, "C", "1");
+    EXPECT_EQ(expand(env, "A C"), "B 1");
+    MacroEnvironment::Recording recording = env.endRecording();
+
+    EXPECT_EQ(recording.reads.size(), 2u);
+    EXPECT_EQ(recording.reads["A"], env.hash("A"));
+    EXPECT_EQ(recording.reads["B"], MacroEnvironment::undefined);
+    EXPECT_EQ(recording.writes.size(), 1u);
+    EXPECT_EQ(recording.writes.count("C"), 1u);
+}
+
+
+//
+// The expansions of object like macros are reused until a macro they use
+// changes, but not where they depend on what's around them.
+//
+
+TEST(MacroExpanderTest, Memoised)
+{
+    MacroEnvironment env;
+    define(env, "A", "B + B");
+    define(env, "B", "C * 2");
+    define(env, "C", "1");
+    define(env, "f", { "a" }, "[a]");
+    define(env, "F", "f");
+    define(env, "Q", {}, "N");
+    define(env, "N", "Q()");
+
+    MacroExpander expander(env);
+    EXPECT_EQ(expand(expander, "A"), "1 * 2 + 1 * 2");
+    EXPECT_EQ(expand(expander, "x A;"), "x 1 * 2 + 1 * 2 ;");
+    EXPECT_EQ(expander.memoHits(), 1u);
+
+    define(env, "C", "3");
+    EXPECT_EQ(expand(expander, "A"), "3 * 2 + 3 * 2");
+    EXPECT_EQ(expander.memoHits(), 1u);
+
+    // A function like macro at the end takes arguments from after it.
+    EXPECT_EQ(expand(expander, "F(1) F(2)"), "[ 1 ] [ 2 ]");
+
+    // Q hides itself in the expansion of N which it makes.
+    EXPECT_EQ(expand(expander, "N Q() N"), "N Q ( ) N");
+
+    // Reusing an expansion still records the macros it used.
+    env.beginRecording();
+    EXPECT_EQ(expand(expander, "A"), "3 * 2 + 3 * 2");
+    MacroEnvironment::Recording recording = env.endRecording();
+    EXPECT_EQ(expander.memoHits(), 3u);
+    EXPECT_EQ(recording.reads.count("A"), 1u);
+    EXPECT_EQ(recording.reads.count("B"), 1u);
+    EXPECT_EQ(recording.reads["C"], env.hash("C"));
+}
+
+
+TEST(PpExpressionTest, Arithmetic)
+{
+    MacroEnvironment env;
+    define(env, "A", "");
+    define(env, "TWO", "2");
+
+    EXPECT_TRUE(evaluate(env, "1 + 2 * 3 == 7"));
+    EXPECT_TRUE(evaluate(env, "(1 ? TWO : 0) == 2 && !0"));
+    EXPECT_TRUE(evaluate(env, "-1 < 0"));
+    EXPECT_FALSE(evaluate(env, "-1 < 0u"));
+    EXPECT_TRUE(evaluate(env, "0x10 == 16 && 010 == 8 && 0b11 == 3"));
+    EXPECT_TRUE(evaluate(env, "'A' == 65 && '\\n' == 10"));
+    EXPECT_TRUE(evaluate(env, "defined A && !defined(B) && defined TWO"));
+    EXPECT_TRUE(evaluate(env, "UNDEFINED == 0"));
+    EXPECT_TRUE(evaluate(env, "1 || 1 / 0"));
+    EXPECT_TRUE(evaluate(env, "(2, 0) == 0 && (1 << 4) == 16"));
+}
+
+
+TEST(PpExpressionTest, Errors)
+{
+    MacroEnvironment env;
+    EXPECT_THROW(evaluate(env, "1 / 0"), PreprocessorException);
+    EXPECT_THROW(evaluate(env, "1 +"), PreprocessorException);
+    EXPECT_THROW(evaluate(env, "(1"), PreprocessorException);
+    EXPECT_THROW(evaluate(env, "1 2"), PreprocessorException);
+    EXPECT_THROW(evaluate(env, "1.0"), PreprocessorException);
+    EXPECT_THROW(evaluate(env, "defined"), PreprocessorException);
+}
+
+
+} // namespace deepC
@@ -0,0 +1,89 @@
+#include <string>
+#include <vector>
+#include <gtest/gtest.h>
+
+#include "pptokenstream.h"
+
+
+namespace deepC
+{
+
+
+//
+// Tokens in a known file refer to its text, and others have their text
+// copied.
+//
+
+TEST(PpTokenStreamTest, Text)
+{
+    std::string file = "int x = A;";
+    PpTokenStream stream;
+    stream.addFile(3, file);
+    stream.push_back(TokenKind::Identifier, 0, Token::StartOfLine, 7, "int", SourceLoc(3, 0), SourceLoc(3, 0));
+    stream.push_back(TokenKind::Identifier, 0, Token::PrecededBySpace, 8, "x", SourceLoc(3, 4), SourceLoc(3, 4));
+    stream.push_back(TokenKind::PpNumber, 0, Token::PrecededBySpace | PpTokenStream::Expanded, PpTokenStream::noIdent, std::string("1"), SourceLoc(4, 10), SourceLoc(3, 8));
+    stream.push_back(TokenKind::PpNumber, 0, PpTokenStream::Expanded, PpTokenStream::noIdent, std::string("2"), SourceLoc(), SourceLoc(3, 8));
+
+    ASSERT_EQ(stream.size(), 4u);
+    EXPECT_EQ(stream.text(0).data(), file.data());
+    EXPECT_EQ(stream.text(1), "x");
+    EXPECT_EQ(stream.text(2), "1");
+    EXPECT_EQ(stream.text(3), "2");
+    EXPECT_EQ(stream.identId(1), 8u);
+    EXPECT_EQ(stream.originalLoc(2), SourceLoc(4, 10));
+    EXPECT_EQ(stream.expansionLoc(2), SourceLoc(3, 8));
+    EXPECT_FALSE(stream.originalLoc(3).exists());
+
+    // Tokens from expansions are kept apart when they'd join.
+    EXPECT_EQ(stream.toText(), "int x 1 2\n");
+}
+
+
+//
+// A slice holds its own text and survives a round trip through a blob,
+// apart from its identifier ids.
+//
+
+TEST(PpTokenStreamTest, Blob)
+{
+    std::string file = "a\n+ b";
+    PpTokenStream stream;
+    stream.addFile(1, file);
+    stream.push_back(TokenKind::Identifier, 0, Token::StartOfLine, 5, "a", SourceLoc(1, 0), SourceLoc(1, 0));
+    stream.push_back(TokenKind::Punctuator, static_cast<uint8_t>(Punctuator::Plus), Token::StartOfLine, PpTokenStream::noIdent, "+", SourceLoc(1, 2), SourceLoc(1, 2));
+    stream.push_back(TokenKind::Identifier, 0, Token::PrecededBySpace, 6, "b", SourceLoc(1, 4), SourceLoc(1, 4));
+
+    PpTokenStream slice = stream.slice(1, 3);
+    file.assign(file.size(), '?');
+    ASSERT_EQ(slice.size(), 2u);
+    EXPECT_EQ(slice.toText(), "+ b\n");
+
+    std::vector<uint8_t> blob(slice.blobSize());
+    slice.writeBlob(blob.data());
+    PpTokenStream copy;
+    ASSERT_TRUE(copy.assign(blob.data(), blob.size()));
+    ASSERT_EQ(copy.size(), 2u);
+    EXPECT_EQ(copy.punctuator(0), Punctuator::Plus);
+    EXPECT_EQ(copy.flags(1), Token::PrecededBySpace);
+    EXPECT_EQ(copy.originalLoc(1), SourceLoc(1, 4));
+    EXPECT_EQ(copy.identId(1), PpTokenStream::noIdent);
+    EXPECT_EQ(copy.toText(), "+ b\n");
+
+    PpTokenStream joined;
+    joined.append(copy, 0, copy.size());
+    joined.append(copy, 1, copy.size());
+    EXPECT_EQ(joined.toText(), "+ b b\n");
+
+    // Only the spellings of the tokens appended are copied.
+    PpTokenStream tail;
+    tail.append(copy, 1, copy.size());
+    EXPECT_EQ(tail.text(0), "b");
+    EXPECT_EQ(tail.blobSize(), copy.slice(1, copy.size()).blobSize());
+
+    blob.pop_back();
+    EXPECT_FALSE(copy.assign(blob.data(), blob.size()));
+    EXPECT_TRUE(copy.empty());
+}
+
+
+} // namespace deepC
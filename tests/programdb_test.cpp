@@ -0,0 +1,1002 @@
+#include <string>
+#include <algorithm>
+#include <vector>
+#include <memory>
+#include <cstdlib>
+#include <cerrno>
+#include <fstream>
+#include <ftw.h>
+#include <unistd.h>
+#include <sys/stat.h>
+#include <gtest/gtest.h>
+
+#include "programdb.h"
+#include "sourcefile.h"
+#include "compileargs.h"
+#include "compiler.h"
+#include "interner.h"
+#include "sourcetokens.h"
+#include "includeinfo.h"
+#include "includeresolver.h"
+#include "macrocontext.h"
+#include "preprocessor.h"
+
+
+namespace deepC
+{
+
+
+//
+// Each test gets its own database in a temporary directory.
+//
+
+class ProgramDbTest : public ::testing::Test
+{
+public:
+    std::string dirName_;
+
+public:
+    void SetUp();
+    void TearDown();
+
+    std::vector<std::unique_ptr<SourceFileInMemory>> makeSourceFiles(const std::string &prefix, int count, size_t size);
+
+    // For tests which compile files.
+    std::string writeFile(const std::string &name, const std::string &text);
+    std::unique_ptr<Compiler> makeCompiler(CompileArgs &args, const std::string &dbName = "db");
+};
+
+
+void ProgramDbTest::SetUp()
+{
+    char dirName[] = "/tmp/programdbtest.XXXXXX";
+    ASSERT_NE(mkdtemp(dirName), nullptr);
+    dirName_ = dirName;
+}
+
+
+static int removeEntry(const char *path, const struct stat *, int, struct FTW *)
+{
+    return remove(path);
+}
+
+void ProgramDbTest::TearDown()
+{
+    nftw(dirName_.c_str(), removeEntry, 16, FTW_DEPTH | FTW_PHYS);
+}
+
+
+std::vector<std::unique_ptr<SourceFileInMemory>> ProgramDbTest::makeSourceFiles(const std::string &prefix, int count, size_t size)
+{
+    std::vector<std::unique_ptr<SourceFileInMemory>> files;
+    for (int i = 0; i < count; i++)
+    {
+        // Make the contents unique so nothing can be shared between them.
+        std::string text = "// " + prefix + " " + std::to_string(i) + "\n";
+        while (text.size() < size)
+        {
+            text += "int v" + std::to_string(text.size()) + ";\n";
+        }
+
+        files.push_back(std::make_unique<SourceFileInMemory>(prefix + "/file" + std::to_string(i) + ".c", text));
+    }
+
+    return files;
+}
+
+
+//
+// Write a file in the test's directory, making any directories it's in.
+// Returns its full path.
+//
+
+std::string ProgramDbTest::writeFile(const std::string &name, const std::string &text)
+{
+    std::string path = dirName_ + "/" + name;
+    for (size_t slash = path.find('/', dirName_.size() + 1); slash != std::string::npos; slash = path.find('/', slash + 1))
+    {
+        mkdir(path.substr(0, slash).c_str(), 0775);
+    }
+
+    std::ofstream(path) << text;
+    return path;
+}
+
+
+//
+// Make a compiler which uses a program database in the test's directory.
+// Compilers made with the same database name share it. The arguments
+// must outlive the compiler.
+//
+
+std::unique_ptr<Compiler> ProgramDbTest::makeCompiler(CompileArgs &args, const std::string &dbName)
+{
+    std::string dbDir = dirName_ + "/" + dbName;
+    EXPECT_TRUE(mkdir(dbDir.c_str(), 0775) == 0 || errno == EEXIST);
+    args.setProgramDbFileName(dbDir);
+    return std::make_unique<Compiler>(args);
+}
+
+
+//
+// Start with a tiny map and write enough to make it double several times,
+// both with single puts and with a batch.
+//
+
+TEST_F(ProgramDbTest, MapGrowsWhenFull)
+{
+    const size_t initialMapSize = 256 * 1024;
+    auto pdb = ProgramDb::create(dirName_, initialMapSize);
+    ASSERT_TRUE(pdb->isOpen());
+
+    auto singleFiles = makeSourceFiles("single", 200, 4096);
+    for (auto &sf : singleFiles)
+    {
+        pdb->put(*sf);
+    }
+
+    auto batchFiles = makeSourceFiles("batch", 200, 4096);
+    {
+        ProgramDb::Batch batch(*pdb, 50);
+        for (auto &sf : batchFiles)
+        {
+            batch.put(*sf);
+        }
+
+        batch.commit();
+    }
+
+    EXPECT_GE(pdb->mapSize(), initialMapSize * 8);
+
+    // Everything should have been written exactly once with a distinct id.
+    for (auto *files : { &singleFiles, &batchFiles })
+    {
+        for (auto &sf : *files)
+        {
+            ASSERT_NE(sf->id(), 0u);
+            EXPECT_EQ(pdb->getId(*sf), sf->id());
+
+            auto stored = std::dynamic_pointer_cast<SourceFile>(pdb->get(Storable::DbGroup::SourceFiles, sf->id()));
+            ASSERT_NE(stored, nullptr);
+            EXPECT_EQ(stored->fileName(), sf->fileName());
+            EXPECT_EQ(stored->sourceText(), sf->sourceText());
+            EXPECT_EQ(stored->lineCount(), sf->lineCount());
+            EXPECT_EQ(stored->line(0), sf->line(0));
+        }
+    }
+}
+
+
+//
+// Objects read from the database refer directly to its memory map, so
+// they must stay valid however much is written while they're held.
+//
+
+TEST_F(ProgramDbTest, HeldObjectsSurviveWrites)
+{
+    auto pdb = ProgramDb::create(dirName_);
+    const std::string text = "int held;\n";
+    SourceFileInMemory a("a.c", text);
+    pdb->put(a);
+
+    SourceTokens tokens(a.id(), a.digest());
+    for (uint32_t i = 0; i < 2000; i++)
+    {
+        tokens.tokens().push_back(TokenKind::Identifier, 0, i * 2, 1, 0, i % 50 + 1);
+    }
+
+    pdb->put(tokens);
+
+    auto storedFile = pdb->getSourceFile("a.c");
+    auto storedTokens = pdb->getSourceTokens(a.id());
+    ASSERT_NE(storedFile, nullptr);
+    ASSERT_NE(storedTokens, nullptr);
+    ASSERT_TRUE(storedTokens->tokens().isView());
+
+    auto files = makeSourceFiles("more", 4000, 8192);
+    for (auto &sf : files)
+    {
+        pdb->put(*sf);
+    }
+
+    EXPECT_EQ(storedFile->sourceText(), text);
+    EXPECT_EQ(storedFile->line(0), "int held;");
+    ASSERT_EQ(storedTokens->tokens().size(), 2000u);
+    EXPECT_EQ(storedTokens->tokens().offset(1999), 3998u);
+    EXPECT_EQ(storedTokens->tokens().identId(1999), 50u);
+}
+
+
+//
+// A full map can't grow while anything read from it is held. Writing
+// fails straight away rather than waiting, and works again once the
+// objects are released.
+//
+
+TEST_F(ProgramDbTest, MapDoesntGrowUnderHeldObjects)
+{
+    auto pdb = ProgramDb::create(dirName_, 256 * 1024);
+    SourceFileInMemory a("a.c", "int held;\n");
+    pdb->put(a);
+
+    auto stored = pdb->getSourceFile("a.c");
+    ASSERT_NE(stored, nullptr);
+
+    auto files = makeSourceFiles("more", 200, 4096);
+    size_t written = 0;
+    try {
+        for (; written < files.size(); written++)
+        {
+            pdb->put(*files[written]);
+        }
+
+        FAIL() << "the map should have filled up";
+    }
+    catch (const ProgramDbException &e) {
+        EXPECT_EQ(e.rc(), MDB_MAP_FULL);
+    }
+
+    EXPECT_EQ(files[written]->id(), 0u);
+    EXPECT_EQ(stored->sourceText(), "int held;\n");
+
+    stored.reset();
+    for (; written < files.size(); written++)
+    {
+        pdb->put(*files[written]);
+    }
+
+    EXPECT_GT(pdb->mapSize(), 256u * 1024u);
+    EXPECT_EQ(pdb->getSourceFile(files.back()->fileName())->sourceText(), files.back()->sourceText());
+}
+
+
+//
+// Files with identical contents should share one stored copy, and
+// changing a file should release its old copy.
+//
+
+TEST_F(ProgramDbTest, IdenticalSourceIsStoredOnce)
+{
+    auto pdb = ProgramDb::create(dirName_);
+    ASSERT_TRUE(pdb->isOpen());
+
+    const std::string text = "int main() { return 0; }\n";
+    SourceFileInMemory a("a.c", text);
+    SourceFileInMemory b("b.c", text);
+    SourceFileInMemory c("c.c", text);
+    pdb->put(a);
+    pdb->put(b);
+    pdb->put(c);
+
+    ProgramDb::Stats stats = pdb->stats();
+    EXPECT_EQ(stats.sourceFiles, 3u);
+    EXPECT_EQ(stats.blobs, 1u);
+    EXPECT_EQ(stats.storedBytes, text.size());
+    EXPECT_EQ(stats.logicalBytes, text.size() * 3);
+    EXPECT_DOUBLE_EQ(stats.dedupRatio(), 3.0);
+
+    // Change one of them.
+    const std::string changed = "int main() { return 1; }\n";
+    SourceFileInMemory c2("c.c", changed);
+    pdb->put(c2);
+    EXPECT_EQ(c2.id(), c.id());
+
+    stats = pdb->stats();
+    EXPECT_EQ(stats.sourceFiles, 3u);
+    EXPECT_EQ(stats.blobs, 2u);
+    EXPECT_EQ(stats.storedBytes, text.size() + changed.size());
+
+    // Everything still reads back correctly.
+    auto storedB = std::dynamic_pointer_cast<SourceFile>(pdb->get(Storable::DbGroup::SourceFiles, b.id()));
+    auto storedC = std::dynamic_pointer_cast<SourceFile>(pdb->get(Storable::DbGroup::SourceFiles, c.id()));
+    ASSERT_NE(storedB, nullptr);
+    ASSERT_NE(storedC, nullptr);
+    EXPECT_EQ(storedB->sourceText(), text);
+    EXPECT_EQ(storedC->sourceText(), changed);
+}
+
+
+//
+// Two handles on one database mustn't hand out the same ids, whichever
+// way their writes are interleaved.
+//
+
+TEST_F(ProgramDbTest, TwoHandlesShareIdSequences)
+{
+    auto first = ProgramDb::create(dirName_);
+    auto second = ProgramDb::create(dirName_);
+
+    SourceFileInMemory a("a.c", "int a;\n");
+    SourceFileInMemory b("b.c", "int b;\n");
+    SourceFileInMemory c("c.c", "int c;\n");
+    SourceFileInMemory d("d.c", "int d;\n");
+    ASSERT_NO_THROW(first->put(a));
+    ASSERT_NO_THROW(second->put(b));
+    ASSERT_NO_THROW(first->put(c));
+    uint32_t reserved = second->reserveIds(Storable::DbGroup::SourceFiles, 4);
+    {
+        ProgramDb::Batch batch(*first);
+        batch.put(d);
+        ASSERT_NO_THROW(batch.commit());
+    }
+
+    std::vector<Storable::Id> ids = { a.id(), b.id(), c.id() };
+    for (uint32_t i = 0; i < 4; i++)
+    {
+        ids.push_back(reserved + i);
+    }
+
+    ids.push_back(d.id());
+    std::sort(ids.begin(), ids.end());
+    EXPECT_EQ(std::adjacent_find(ids.begin(), ids.end()), ids.end());
+
+    for (auto pdb : { first, second })
+    {
+        for (const SourceFileInMemory *file : { &a, &b, &c, &d })
+        {
+            auto stored = pdb->getSourceFile(file->fileName());
+            ASSERT_NE(stored, nullptr);
+            EXPECT_EQ(stored->id(), file->id());
+            EXPECT_EQ(stored->sourceText(), file->sourceText());
+        }
+    }
+}
+
+
+//
+// A source file whose digest is forced, to make a collision.
+//
+
+class CollidingSourceFile : public SourceFileInMemory
+{
+public:
+    CollidingSourceFile(const std::string &fileName, const std::string &text, const ContentDigest &digest) :
+        SourceFileInMemory(fileName, text)
+    {
+        digest_ = digest;
+        haveDigest_ = true;
+    }
+};
+
+
+//
+// Text is only shared with stored text which has the same digest if it's
+// really the same.
+//
+
+TEST_F(ProgramDbTest, DifferentTextWithTheSameDigestIsRejected)
+{
+    auto pdb = ProgramDb::create(dirName_);
+    ContentDigest digest(1234, 4);
+    CollidingSourceFile a("a.c", "one\n", digest);
+    CollidingSourceFile b("b.c", "two\n", digest);
+    CollidingSourceFile a2("a.c", "uno\n", digest);
+    pdb->put(a);
+    EXPECT_THROW(pdb->put(b), ProgramDbException);
+    EXPECT_THROW(pdb->put(a2), ProgramDbException);
+
+    CollidingSourceFile same("c.c", "one\n", digest);
+    pdb->put(same);
+    EXPECT_EQ(pdb->getSourceFile("a.c")->sourceText(), "one\n");
+    EXPECT_EQ(pdb->getSourceFile("c.c")->sourceText(), "one\n");
+    EXPECT_EQ(pdb->getSourceFile("b.c"), nullptr);
+}
+
+
+//
+// Anything read from the database keeps it open, so it can outlive the
+// caller's reference to the database.
+//
+
+TEST_F(ProgramDbTest, StoredObjectsKeepTheDatabaseOpen)
+{
+    const std::string text = "int answer = 42;\n";
+    std::shared_ptr<SourceFile> stored;
+    {
+        auto pdb = ProgramDb::create(dirName_);
+        SourceFileInMemory a("a.c", text);
+        pdb->put(a);
+        stored = pdb->getSourceFile("a.c");
+    }
+
+    ASSERT_NE(stored, nullptr);
+    EXPECT_EQ(stored->sourceText(), text);
+    EXPECT_EQ(stored->line(0), "int answer = 42;");
+}
+
+
+//
+// Lookups on the same thread share a read transaction until something is
+// written, even when the caller doesn't keep the objects it read.
+//
+
+TEST_F(ProgramDbTest, ReadTransactionsAreReusedUntilAWrite)
+{
+    auto pdb = ProgramDb::create(dirName_);
+    SourceFileInMemory a("a.c", "int a;\n");
+    pdb->put(a);
+
+    ProgramDb::ReadStats before = pdb->readStats();
+    for (int i = 0; i < 10; i++)
+    {
+        ASSERT_NE(pdb->getSourceFile("a.c"), nullptr);
+    }
+
+    ProgramDb::ReadStats reading = pdb->readStats();
+    EXPECT_EQ(reading.renewed + reading.created, before.renewed + before.created + 1);
+    EXPECT_EQ(reading.threadHits, before.threadHits + 9);
+
+    // A write means the next lookup needs a new transaction to see it.
+    SourceFileInMemory b("b.c", "int b;\n");
+    pdb->put(b);
+    ASSERT_NE(pdb->getSourceFile("b.c"), nullptr);
+
+    ProgramDb::ReadStats after = pdb->readStats();
+    EXPECT_EQ(after.renewed + after.created, reading.renewed + reading.created + 1);
+    EXPECT_EQ(after.threadHits, reading.threadHits);
+}
+
+
+//
+// A source file which hasn't changed since it was stored should be
+// recognised from its modification time and size alone.
+//
+
+TEST_F(ProgramDbTest, UnchangedFileIsNotStoredAgain)
+{
+    std::string fileName = writeFile("hello.c", "int main() { return 0; }\n");
+
+    CompileArgs args;
+    auto comp = makeCompiler(args);
+
+    auto first = comp->loadSourceFile(fileName);
+    EXPECT_EQ(comp->storedFiles(), 1u);
+    EXPECT_EQ(comp->unchangedFiles(), 0u);
+
+    auto second = comp->loadSourceFile(fileName);
+    EXPECT_EQ(comp->storedFiles(), 1u);
+    EXPECT_EQ(comp->unchangedFiles(), 1u);
+    EXPECT_EQ(second->id(), first->id());
+    EXPECT_EQ(second->sourceText(), first->sourceText());
+
+    // Changing the size is always noticed, even within the timestamp
+    // resolution.
+    writeFile("hello.c", "int main() { return 42; }\n");
+    auto third = comp->loadSourceFile(fileName);
+    EXPECT_EQ(comp->storedFiles(), 2u);
+    EXPECT_EQ(third->id(), first->id());
+    EXPECT_EQ(third->sourceText(), "int main() { return 42; }\n");
+}
+
+
+//
+// Identifiers should get the same ids when the database is opened again.
+//
+
+TEST_F(ProgramDbTest, IdentifierIdsAreStable)
+{
+    Interner::Id fooId;
+    Interner::Id barId;
+    {
+        auto pdb = ProgramDb::create(dirName_);
+        Interner interner;
+        pdb->loadIdentifiers(interner);
+        EXPECT_EQ(interner.size(), 0u);
+
+        interner.intern("main");
+        fooId = interner.intern("foo");
+        pdb->saveIdentifiers(interner);
+        EXPECT_EQ(interner.savedCount(), 2u);
+        EXPECT_EQ(pdb->stats().identifiers, 2u);
+    }
+
+    {
+        auto pdb = ProgramDb::create(dirName_);
+        Interner interner;
+        pdb->loadIdentifiers(interner);
+        EXPECT_EQ(interner.size(), 2u);
+        EXPECT_EQ(interner.find("foo"), fooId);
+
+        barId = interner.intern("bar");
+        pdb->saveIdentifiers(interner);
+    }
+
+    auto pdb = ProgramDb::create(dirName_);
+    Interner interner;
+    interner.intern("bar");
+    EXPECT_THROW(pdb->loadIdentifiers(interner), ProgramDbException);
+
+    Interner fresh;
+    pdb->loadIdentifiers(fresh);
+    EXPECT_EQ(fresh.find("main"), 1u);
+    EXPECT_EQ(fresh.find("foo"), fooId);
+    EXPECT_EQ(fresh.find("bar"), barId);
+}
+
+
+//
+// Two compilers which intern some of the same identifiers in different
+// orders both save them. The second keeps the first one's ids for those,
+// and each learns about the other's new ones the next time it saves.
+//
+
+TEST_F(ProgramDbTest, IdentifiersFromTwoCompilersAreMerged)
+{
+    auto pdb = ProgramDb::create(dirName_);
+    Interner first;
+    Interner second;
+    pdb->loadIdentifiers(first);
+    pdb->loadIdentifiers(second);
+
+    Interner::Id foo = first.intern("foo");
+    Interner::Id bar = first.intern("bar");
+    second.intern("baz");
+    Interner::Id secondBar = second.intern("bar");
+    Interner::Id secondFoo = second.intern("foo");
+
+    pdb->saveIdentifiers(first);
+    EXPECT_FALSE(first.storedIdsDiffer());
+    ASSERT_NO_THROW(pdb->saveIdentifiers(second));
+    EXPECT_TRUE(second.storedIdsDiffer());
+    EXPECT_EQ(second.toStored(secondFoo), foo);
+    EXPECT_EQ(second.toStored(secondBar), bar);
+    EXPECT_EQ(second.fromStored(bar), secondBar);
+    Interner::Id baz = second.toStored(second.find("baz"));
+    EXPECT_EQ(baz, 3u);
+
+    first.intern("qux");
+    pdb->saveIdentifiers(first);
+    ASSERT_NE(first.find("baz"), Interner::none);
+    EXPECT_EQ(first.toStored(first.find("baz")), baz);
+    EXPECT_EQ(first.toStored(first.find("qux")), 4u);
+    EXPECT_EQ(pdb->stats().identifiers, 4u);
+
+    Interner fresh;
+    pdb->loadIdentifiers(fresh);
+    EXPECT_EQ(fresh.size(), 4u);
+    EXPECT_EQ(fresh.find("foo"), foo);
+    EXPECT_EQ(fresh.find("bar"), bar);
+    EXPECT_EQ(fresh.find("baz"), baz);
+    EXPECT_EQ(fresh.find("qux"), 4u);
+}
+
+
+//
+// Stored tokens should be used in place rather than copied.
+//
+
+TEST_F(ProgramDbTest, SourceTokensAreUsedInPlace)
+{
+    auto pdb = ProgramDb::create(dirName_);
+    ContentDigest digest(std::string_view("some text"));
+    SourceTokens tokens(7, digest);
+    for (uint32_t i = 0; i < 2000; i++)
+    {
+        tokens.tokens().push_back(TokenKind::Identifier, 0, i * 2, 1, 0, i % 50 + 1);
+    }
+
+    pdb->put(tokens);
+    ASSERT_NE(tokens.id(), 0u);
+
+    auto stored = pdb->getSourceTokens(7);
+    ASSERT_NE(stored, nullptr);
+    EXPECT_EQ(stored->id(), tokens.id());
+    EXPECT_EQ(stored->sourceFileId(), 7u);
+    EXPECT_TRUE(stored->digest() == digest);
+    ASSERT_EQ(stored->tokens().size(), 2000u);
+    EXPECT_EQ(stored->tokens().offset(1999), 3998u);
+    EXPECT_EQ(stored->tokens().identId(1999), 50u);
+
+    // This big it's in overflow pages, which are page aligned.
+    EXPECT_TRUE(stored->tokens().isView());
+
+    EXPECT_EQ(pdb->getSourceTokens(8), nullptr);
+}
+
+
+//
+// Compiling an unchanged file again should reuse its stored tokens
+// rather than lexing it.
+//
+
+TEST_F(ProgramDbTest, UnchangedFileIsNotLexedAgain)
+{
+    std::string fileName = writeFile("hello.c", "int main() { return answer; }\n");
+
+    CompileArgs args;
+    size_t numTokens;
+    uint32_t answerId;
+    {
+        auto comp = makeCompiler(args);
+        comp->compile(fileName);
+        EXPECT_EQ(comp->lexedFiles(), 1u);
+        EXPECT_EQ(comp->reusedTokenFiles(), 0u);
+        numTokens = comp->tokens()->tokens().size();
+        answerId = comp->tokens()->tokens().identId(6);
+        EXPECT_EQ(comp->identifiers().text(answerId), "answer");
+    }
+
+    auto comp = makeCompiler(args);
+    comp->compile(fileName);
+    EXPECT_EQ(comp->lexedFiles(), 0u);
+    EXPECT_EQ(comp->reusedTokenFiles(), 1u);
+    ASSERT_EQ(comp->tokens()->tokens().size(), numTokens);
+    EXPECT_EQ(comp->tokens()->tokens().identId(6), answerId);
+    EXPECT_EQ(comp->tokens()->tokens().keyword(0), Keyword::Int);
+
+    // Only the change in a changed file is lexed again.
+    writeFile("hello.c", "int main() { return answer + 1; }\n");
+    comp->compile(fileName);
+    EXPECT_EQ(comp->lexedFiles(), 0u);
+    EXPECT_EQ(comp->relexedFiles(), 1u);
+    ASSERT_EQ(comp->tokens()->tokens().size(), numTokens + 2);
+    EXPECT_EQ(comp->tokens()->tokens().identId(6), answerId);
+    EXPECT_EQ(comp->tokens()->tokens().punctuator(7), Punctuator::Plus);
+    EXPECT_EQ(comp->tokens()->tokens().offset(10), 32u);
+}
+
+
+//
+// Compiling files in parallel should give the same tokens as compiling
+// them one at a time, and store them all.
+//
+
+TEST_F(ProgramDbTest, ParallelCompile)
+{
+    std::vector<std::string> fileNames;
+    for (int i = 0; i < 40; i++)
+    {
+        std::string text;
+        for (int j = 0; j < 50; j++)
+        {
+            text += "int shared" + std::to_string(j) + " = unique" + std::to_string(i) + "_" + std::to_string(j) + " + " + std::to_string(j) + ";\n";
+        }
+
+        fileNames.push_back(writeFile("file" + std::to_string(i) + ".c", text));
+    }
+
+    CompileArgs args;
+    args.setJobs(4);
+    {
+        auto comp = makeCompiler(args);
+        EXPECT_TRUE(comp->compileAll(fileNames));
+        EXPECT_EQ(comp->storedFiles(), 40u);
+        EXPECT_EQ(comp->lexedFiles(), 40u);
+        EXPECT_EQ(comp->identifiers().size(), 50u + 40u * 50u + 1u);
+    }
+
+    CompileArgs serialArgs;
+    auto serial = makeCompiler(serialArgs, "serialdb");
+    serial->compileAll(fileNames);
+
+    // Everything was stored, so a second run reuses it all.
+    auto comp = makeCompiler(args);
+    comp->compileAll(fileNames);
+    EXPECT_EQ(comp->unchangedFiles(), 40u);
+    EXPECT_EQ(comp->reusedTokenFiles(), 40u);
+    EXPECT_EQ(comp->lexedFiles(), 0u);
+
+    for (const std::string &fileName : fileNames)
+    {
+        auto parallelFile = comp->loadSourceFile(fileName);
+        auto serialFile = serial->loadSourceFile(fileName);
+        auto parallelTokens = comp->programDb()->getSourceTokens(parallelFile->id());
+        auto serialTokens = serial->programDb()->getSourceTokens(serialFile->id());
+        ASSERT_NE(parallelTokens, nullptr);
+        ASSERT_NE(serialTokens, nullptr);
+        ASSERT_EQ(parallelTokens->tokens().size(), serialTokens->tokens().size());
+        for (size_t i = 0; i < serialTokens->tokens().size(); i++)
+        {
+            ASSERT_EQ(parallelTokens->tokens().offset(i), serialTokens->tokens().offset(i));
+            ASSERT_EQ(parallelTokens->tokens().kind(i), serialTokens->tokens().kind(i));
+
+            // Ids depend on the order the files were lexed in, but they
+            // must be for the same text.
+            if (serialTokens->tokens().kind(i) == TokenKind::Identifier)
+            {
+                ASSERT_EQ(comp->identifiers().text(parallelTokens->tokens().identId(i)), serial->identifiers().text(serialTokens->tokens().identId(i)));
+            }
+        }
+    }
+}
+
+
+//
+// When one file fails the files compiled alongside it are still stored,
+// including files which were new and only had reserved ids.
+//
+
+TEST_F(ProgramDbTest, FailedFileDoesntLoseTheOthers)
+{
+    std::vector<std::string> fileNames;
+    for (int i = 0; i < 8; i++)
+    {
+        fileNames.push_back(writeFile("file" + std::to_string(i) + ".c", "int x" + std::to_string(i) + " = " + std::to_string(i) + ";\n"));
+    }
+
+    fileNames.push_back(writeFile("broken.c", "int x = ;\n"));
+
+    CompileArgs args;
+    args.setJobs(4);
+    {
+        auto comp = makeCompiler(args);
+        EXPECT_ANY_THROW(comp->compileAll(fileNames));
+    }
+
+    auto comp = makeCompiler(args);
+    EXPECT_ANY_THROW(comp->compileAll(fileNames));
+    EXPECT_EQ(comp->unchangedFiles(), 9u);
+    EXPECT_EQ(comp->storedFiles(), 0u);
+    EXPECT_EQ(comp->reusedTokenFiles(), 9u);
+    EXPECT_EQ(comp->lexedFiles(), 0u);
+}
+
+
+//
+// Guarded headers which are included again are skipped. On the next run
+// the include graph comes from the program database, so the headers don't
+// have to be lexed.
+//
+
+TEST_F(ProgramDbTest, RepeatIncludesAreSkipped)
+{
+    std::string includeDir = dirName_ + "/include";
+    writeFile("include/guarded.h", "#ifndef GUARDED_H\n#define GUARDED_H\nint g;\n#endif\n");
+    writeFile("include/once.h", "#pragma once\n#include \"guarded.h\"\nint o;\n");
+    writeFile("include/plain.h", "int p;\n");
+    std::string fileName = writeFile("main.c", "#include <guarded.h>\n#include <once.h>\n#include <once.h>\n"
+                                               "#include <plain.h>\n#include <plain.h>\nint main;\n");
+
+    CompileArgs args;
+    args.addIncludePath(includeDir);
+    {
+        auto comp = makeCompiler(args);
+        comp->compile(fileName);
+        EXPECT_EQ(comp->skippedIncludes(), 2u);
+        EXPECT_EQ(comp->scannedIncludeFiles(), 4u);
+        EXPECT_EQ(comp->lexedFiles(), 4u);
+    }
+
+    auto comp = makeCompiler(args);
+    comp->compile(fileName);
+    EXPECT_EQ(comp->skippedIncludes(), 2u);
+    EXPECT_EQ(comp->scannedIncludeFiles(), 0u);
+    EXPECT_EQ(comp->reusedIncludeFiles(), 4u);
+    EXPECT_EQ(comp->lexedFiles(), 0u);
+    EXPECT_EQ(comp->reusedTokenFiles(), 1u);
+
+    auto guarded = comp->loadSourceFile(includeDir + "/guarded.h");
+    auto info = comp->programDb()->getIncludeInfo(guarded->id());
+    ASSERT_NE(info, nullptr);
+    EXPECT_EQ(info->guard(), IncludeInfo::Guard::IfndefGuard);
+    EXPECT_EQ(info->guardMacro(), "GUARDED_H");
+
+    auto once = comp->loadSourceFile(includeDir + "/once.h");
+    info = comp->programDb()->getIncludeInfo(once->id());
+    ASSERT_NE(info, nullptr);
+    EXPECT_EQ(info->guard(), IncludeInfo::Guard::PragmaOnce);
+    ASSERT_EQ(info->includes().size(), 1u);
+    EXPECT_EQ(info->includes()[0].name, "guarded.h");
+    EXPECT_FALSE(info->includes()[0].angled);
+}
+
+
+//
+// Headers are kept for the whole run, so what they read from the program
+// database is copied out rather than holding its snapshot open, whether
+// or not they were lexed.
+//
+
+TEST_F(ProgramDbTest, HeadersDontHoldSnapshots)
+{
+    std::string includeDir = dirName_ + "/include";
+    std::vector<std::pair<std::string, std::string>> headers = {
+        { "guarded.h", "#ifndef GUARDED_H\n#define GUARDED_H\nint g;\n#endif\n" },
+        { "plain.h", "int p;\n" }
+    };
+
+    for (const auto &header : headers)
+    {
+        writeFile("include/" + header.first, header.second);
+    }
+
+    std::string fileName = writeFile("main.c", "#include <guarded.h>\n#include <plain.h>\nint main;\n");
+
+    CompileArgs args;
+    args.addIncludePath(includeDir);
+    makeCompiler(args)->compile(fileName);
+
+    auto comp = makeCompiler(args);
+    comp->compile(fileName);
+    EXPECT_EQ(comp->unchangedFiles(), 3u);
+    ASSERT_NE(comp->tokens(), nullptr);
+    EXPECT_FALSE(comp->tokens()->tokens().isView());
+
+    CompileUnit includer(fileName, nullptr);
+    for (const auto &item : headers)
+    {
+        auto header = comp->includeHeader(includeDir + "/" + item.first, includer);
+        EXPECT_EQ(std::dynamic_pointer_cast<SourceFileOnDatabase>(header->sourceFile), nullptr);
+        EXPECT_EQ(header->previousVersion, nullptr);
+        EXPECT_TRUE(header->tokens == nullptr || !header->tokens->tokens().isView());
+
+        // The copy still has the text if the header has to be lexed.
+        EXPECT_EQ(header->sourceFile->sourceText(), item.second);
+        EXPECT_FALSE(comp->headerTokens(*header).empty());
+        EXPECT_FALSE(header->tokens->tokens().isView());
+    }
+
+    EXPECT_EQ(comp->unchangedFiles(), 3u);
+}
+
+
+//
+// Where #includes were found, and that they weren't, is kept for the next
+// run even though a header which isn't found is an error. Adding a header
+// changes the directory's time, which makes the results which depend on
+// that directory search again.
+//
+
+TEST_F(ProgramDbTest, IncludeResolutionsAreCached)
+{
+    std::string includeDir = dirName_ + "/include";
+    writeFile("include/guarded.h", "#ifndef GUARDED_H\n#define GUARDED_H\nint g;\n#endif\n");
+    writeFile("include/once.h", "#pragma once\n#include \"guarded.h\"\nint o;\n");
+    std::string fileName = writeFile("main.c", "#include <guarded.h>\n#include <once.h>\n#include <once.h>\n#include <missing.h>\nint main;\n");
+
+    CompileArgs args;
+    args.addIncludePath(dirName_ + "/none");
+    args.addIncludePath(includeDir);
+    {
+        auto comp = makeCompiler(args);
+        EXPECT_THROW(comp->compile(fileName), PreprocessorException);
+        IncludeResolver::Stats stats = comp->includeResolver().stats();
+        EXPECT_EQ(stats.searches, 4u);
+        EXPECT_EQ(stats.cacheHits, 1u);
+        EXPECT_EQ(stats.storedHits, 0u);
+        EXPECT_GT(stats.fileStats, 0u);
+    }
+
+    {
+        auto comp = makeCompiler(args);
+        EXPECT_THROW(comp->compile(fileName), PreprocessorException);
+        IncludeResolver::Stats stats = comp->includeResolver().stats();
+        EXPECT_EQ(stats.searches, 0u);
+        EXPECT_EQ(stats.storedHits, 4u);
+        EXPECT_EQ(stats.fileStats, 0u);
+        EXPECT_EQ(comp->includeResolver().resolve("missing.h", true, ""), "");
+        EXPECT_EQ(comp->includeResolver().resolve("guarded.h", false, includeDir), includeDir + "/guarded.h");
+    }
+
+    writeFile("include/missing.h", "int m;\n");
+
+    auto comp = makeCompiler(args);
+    EXPECT_TRUE(comp->compile(fileName));
+    EXPECT_GT(comp->includeResolver().stats().searches, 0u);
+    EXPECT_EQ(comp->includeResolver().resolve("missing.h", true, ""), includeDir + "/missing.h");
+}
+
+
+//
+// An #include which can't be found is an error where it's made, unless
+// it's in a group which isn't taken, and when a header's context which
+// has one is replayed.
+//
+
+TEST_F(ProgramDbTest, MissingHeadersAreErrors)
+{
+    std::string includeDir = dirName_ + "/include";
+    writeFile("include/plain.h", "int p;\n");
+    writeFile("include/other.h", "int o;\n");
+    std::string fileName = writeFile("main.c", "#if 0\n#include <skipped.h>\n#endif\n#include <plain.h>\nint main;\n");
+
+    CompileArgs args;
+    args.addIncludePath(includeDir);
+    auto comp = makeCompiler(args);
+    EXPECT_TRUE(comp->compile(fileName));
+
+    fileName = writeFile("missing.c", "int a;\n#include \"missing.h\"\n");
+    try {
+        comp->compile(fileName);
+        FAIL() << "the missing header should be an error";
+    }
+    catch (const PreprocessorException &e) {
+        EXPECT_EQ(std::string(e.what()), fileName + ":2: can't find header \"missing.h\"");
+    }
+
+    // A context stored when a missing header wasn't an error.
+    auto context = std::make_shared<MacroContext>();
+    MacroContext::Inclusion inclusion;
+    inclusion.name = "gone.h";
+    inclusion.angled = true;
+    inclusion.firstDir = 0;
+    inclusion.entered = false;
+    context->inclusions.push_back(inclusion);
+    context->setFingerprint();
+    CompileUnit includer(fileName, nullptr);
+    auto other = comp->includeHeader(includeDir + "/other.h", includer);
+    comp->macroContexts().add(*other->sourceFile, context);
+
+    fileName = writeFile("replayed.c", "#include <other.h>\n");
+    try {
+        comp->compile(fileName);
+        FAIL() << "the replayed missing header should be an error";
+    }
+    catch (const PreprocessorException &e) {
+        EXPECT_EQ(std::string(e.what()), includeDir + "/other.h: can't find header <gone.h>");
+    }
+}
+
+
+//
+// A header included in a macro context it's been in before, earlier in
+// the run or in an earlier run, has its macro changes and its output
+// replayed rather than being preprocessed again. Changing the header
+// forgets its contexts.
+//
+
+TEST_F(ProgramDbTest, HeaderMacroContextsAreReplayed)
+{
+    writeFile("include/config.h", "#ifndef CONFIG_H\n#define CONFIG_H\n#define SIZE (N * 2)\nint config[SIZE];\n#endif\n");
+    writeFile("include/count.h", "int count = N;\n#undef N\n#define N 3\n");
+    std::string fileName = writeFile("main.c", "#define N 1\n#include <config.h>\n#include <count.h>\n#include <count.h>\n"
+                                               "#undef N\n#define N 1\n#include <count.h>\nint size = SIZE;\n");
+
+    CompileArgs args;
+    args.addIncludePath(dirName_ + "/include");
+    {
+        auto comp = makeCompiler(args);
+        comp->compile(fileName);
+        EXPECT_EQ(comp->preprocessedHeaders(), 3u);
+        EXPECT_EQ(comp->replayedHeaders(), 1u);
+    }
+
+    {
+        auto comp = makeCompiler(args);
+        comp->compile(fileName);
+        EXPECT_EQ(comp->preprocessedHeaders(), 0u);
+        EXPECT_EQ(comp->replayedHeaders(), 4u);
+        EXPECT_EQ(comp->lexedFiles(), 0u);
+    }
+
+    writeFile("include/count.h", "int count = N + 1;\n#undef N\n#define N 3\n");
+
+    auto comp = makeCompiler(args);
+    comp->compile(fileName);
+    EXPECT_EQ(comp->preprocessedHeaders(), 2u);
+    EXPECT_EQ(comp->replayedHeaders(), 2u);
+}
+
+
+//
+// The tokens of conditional groups which aren't taken are skipped rather
+// than expanded, and counted. Directives in them are still followed.
+//
+
+TEST_F(ProgramDbTest, InactiveGroupsAreSkipped)
+{
+    std::string fileName = writeFile("main.c", "#if 0\n#if 1\nint a;\n#endif\n/* #endif */ x\n#else\nint b;\n#endif\n#ifdef X\nint c;\n#endif\n");
+
+    CompileArgs args;
+    auto comp = makeCompiler(args);
+    comp->compile(fileName);
+    EXPECT_EQ(comp->skippedTokens(), 7u);
+}
+
+
+//
+// Pragmas other than #pragma once are dropped by the preprocessor rather
+// than being passed to the parser.
+//
+
+TEST_F(ProgramDbTest, PragmasArentParsed)
+{
+    std::string fileName = writeFile("main.c", "#pragma GCC diagnostic push\n#pragma pack(1)\nint x;\n#pragma GCC diagnostic pop\n");
+
+    CompileArgs args;
+    auto comp = makeCompiler(args);
+    EXPECT_TRUE(comp->compile(fileName));
+}
+
+
+} // namespace deepC
@@ -0,0 +1,109 @@
+#include <string>
+#include <fstream>
+#include <cstdlib>
+#include <ftw.h>
+#include <unistd.h>
+#include <gtest/gtest.h>
+
+#include "arena.h"
+#include "sourcefile.h"
+
+
+namespace deepC
+{
+
+
+//
+// Each test gets its own temporary directory for its source files.
+//
+
+class SourceFileTest : public ::testing::Test
+{
+public:
+    std::string dirName_;
+
+public:
+    void SetUp();
+    void TearDown();
+
+    std::string writeFile(const std::string &name, const std::string &text);
+};
+
+
+void SourceFileTest::SetUp()
+{
+    char dirName[] = "/tmp/sourcefiletest.XXXXXX";
+    ASSERT_NE(mkdtemp(dirName), nullptr);
+    dirName_ = dirName;
+}
+
+
+static int removeEntry(const char *path, const struct stat *, int, struct FTW *)
+{
+    return remove(path);
+}
+
+void SourceFileTest::TearDown()
+{
+    nftw(dirName_.c_str(), removeEntry, 16, FTW_DEPTH | FTW_PHYS);
+}
+
+
+std::string SourceFileTest::writeFile(const std::string &name, const std::string &text)
+{
+    std::string fileName = dirName_ + "/" + name;
+    std::ofstream(fileName) << text;
+    return fileName;
+}
+
+
+//
+// Small files are read into the arena, bigger ones are mapped.
+//
+
+TEST_F(SourceFileTest, SmallFilesAreReadIntoArena)
+{
+    Arena arena;
+
+    std::string smallText = "int x;\n";
+    SourceFileOnFilesystem small(writeFile("small.c", smallText), &arena);
+    EXPECT_FALSE(small.isMapped());
+    EXPECT_EQ(small.sourceText(), smallText);
+    EXPECT_EQ(arena.bytesAllocated(), smallText.size());
+
+    std::string bigText(SourceFileOnFilesystem::smallFileSize + 1, 'x');
+    SourceFileOnFilesystem big(writeFile("big.c", bigText), &arena);
+    EXPECT_TRUE(big.isMapped());
+    EXPECT_EQ(big.sourceText(), bigText);
+    EXPECT_EQ(arena.bytesAllocated(), smallText.size());
+
+    // Hints are harmless whichever way the file was read.
+    small.adviseSequential();
+    big.adviseSequential();
+    big.willNeed(100, 5000);
+    EXPECT_EQ(big.sourceText(), bigText);
+
+    // Without an arena everything is mapped.
+    SourceFileOnFilesystem mapped(writeFile("mapped.c", smallText));
+    EXPECT_TRUE(mapped.isMapped());
+    EXPECT_EQ(mapped.sourceText(), smallText);
+}
+
+
+//
+// An empty file can't be mapped but should still load.
+//
+
+TEST_F(SourceFileTest, EmptyFile)
+{
+    Arena arena;
+
+    SourceFileOnFilesystem empty(writeFile("empty.c", ""), &arena);
+    EXPECT_TRUE(empty.sourceText().empty());
+
+    SourceFileOnFilesystem emptyMapped(writeFile("empty2.c", ""));
+    EXPECT_TRUE(emptyMapped.sourceText().empty());
+}
+
+
+} // namespace deepC
@@ -0,0 +1,92 @@
+#include <string>
+#include <memory>
+#include <gtest/gtest.h>
+
+#include "sourceloc.h"
+#include "sourcefile.h"
+
+
+namespace deepC
+{
+
+
+//
+// Make an in-memory source file with a given id.
+//
+
+static std::shared_ptr<SourceFile> makeFile(uint32_t id, const std::string &fileName, const std::string &text)
+{
+    auto sf = std::make_shared<SourceFileInMemory>(fileName, text);
+    sf->setId(id);
+    return sf;
+}
+
+
+TEST(SourceLocTest, OffsetToLineColumn)
+{
+    SourceLocator locator;
+    locator.addFile(makeFile(3, "test.c", "int x;\n\nint main()\n{\n}"));
+
+    uint32_t line;
+    uint32_t column;
+    ASSERT_TRUE(locator.lineColumn(SourceLoc(3, 0), &line, &column));
+    EXPECT_EQ(line, 1u);
+    EXPECT_EQ(column, 1u);
+
+    ASSERT_TRUE(locator.lineColumn(SourceLoc(3, 4), &line, &column));
+    EXPECT_EQ(line, 1u);
+    EXPECT_EQ(column, 5u);
+
+    // The newline itself is at the end of its line.
+    ASSERT_TRUE(locator.lineColumn(SourceLoc(3, 6), &line, &column));
+    EXPECT_EQ(line, 1u);
+    EXPECT_EQ(column, 7u);
+
+    ASSERT_TRUE(locator.lineColumn(SourceLoc(3, 7), &line, &column));
+    EXPECT_EQ(line, 2u);
+    EXPECT_EQ(column, 1u);
+
+    ASSERT_TRUE(locator.lineColumn(SourceLoc(3, 12), &line, &column));
+    EXPECT_EQ(line, 3u);
+    EXPECT_EQ(column, 5u);
+
+    SourcePos pos = locator.toPos(SourceLoc(3, 21));
+    EXPECT_EQ(pos.fileName(), "test.c");
+    EXPECT_EQ(pos.line(), 5);
+    EXPECT_EQ(pos.column(), 1);
+
+    // Unknown files.
+    EXPECT_FALSE(locator.lineColumn(SourceLoc(4, 0), &line, &column));
+    EXPECT_FALSE(locator.toPos(SourceLoc(4, 0)).exists());
+}
+
+
+TEST(SourceLocTest, LineColumnToOffset)
+{
+    SourceLocator locator;
+    locator.addFile(makeFile(1, "test.c", "int x;\n\nint main()\n{\n}"));
+
+    EXPECT_EQ(locator.toLoc(1, 1, 1), SourceLoc(1, 0));
+    EXPECT_EQ(locator.toLoc(1, 3, 5), SourceLoc(1, 12));
+    EXPECT_EQ(locator.toLoc(1, 5, 1), SourceLoc(1, 21));
+
+    // Columns past the end of the line stay on the line.
+    EXPECT_EQ(locator.toLoc(1, 2, 40), SourceLoc(1, 7));
+
+    // Lines which don't exist.
+    EXPECT_FALSE(locator.toLoc(1, 0, 1).exists());
+    EXPECT_FALSE(locator.toLoc(1, 6, 1).exists());
+    EXPECT_FALSE(locator.toLoc(2, 1, 1).exists());
+
+    // Every offset converts there and back.
+    for (uint32_t offset = 0; offset < 22; offset++)
+    {
+        uint32_t line;
+        uint32_t column;
+        ASSERT_TRUE(locator.lineColumn(SourceLoc(1, offset), &line, &column));
+        EXPECT_EQ(locator.toLoc(1, line, column), SourceLoc(1, offset));
+    }
+}
+
+
+} // namespace deepC
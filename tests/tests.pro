@@ -4,7 +4,22 @@ CONFIG -= app_bundle
 CONFIG -= qt
 QMAKE_CXXFLAGS += -std=c++17
 
-SOURCES += main.cpp
+SOURCES += main.cpp \
+    clexer_test.cpp \
+    cparser_test.cpp \
+    diff_test.cpp \
+    hideset_test.cpp \
+    includeinfo_test.cpp \
+    interner_test.cpp \
+    lexscan_test.cpp \
+    lineindex_test.cpp \
+    macroexpander_test.cpp \
+    pptokenstream_test.cpp \
+    programdb_test.cpp \
+    sourceloc_test.cpp \
+    sourcefile_test.cpp \
+    threadpool_test.cpp \
+    tokenstream_test.cpp
 
 win32:CONFIG(release, debug|release): LIBS += -L$$OUT_PWD/../libdeepcc/release/ -llibdeepcc
 else:win32:CONFIG(debug, debug|release): LIBS += -L$$OUT_PWD/../libdeepcc/debug/ -llibdeepcc
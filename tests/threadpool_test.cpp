@@ -0,0 +1,96 @@
+#include <atomic>
+#include <stdexcept>
+#include <vector>
+#include <gtest/gtest.h>
+
+#include "threadpool.h"
+
+
+namespace deepC
+{
+
+
+TEST(ThreadPoolTest, RunsEveryTask)
+{
+    ThreadPool pool(4);
+    EXPECT_EQ(pool.size(), 4u);
+
+    std::vector<std::atomic<int>> counts(1000);
+    std::atomic<bool> badWorker(false);
+    for (size_t i = 0; i < counts.size(); i++)
+    {
+        pool.submit([&, i](size_t worker)
+        {
+            if (worker >= 4)
+            {
+                badWorker = true;
+            }
+
+            counts[i]++;
+        });
+    }
+
+    pool.wait();
+    EXPECT_FALSE(badWorker);
+    for (auto &count : counts)
+    {
+        EXPECT_EQ(count, 1);
+    }
+}
+
+
+//
+// Tasks can submit more tasks, which go on the worker's own queue and
+// get stolen by idle workers.
+//
+
+TEST(ThreadPoolTest, NestedTasks)
+{
+    ThreadPool pool(3);
+    std::atomic<int> leaves(0);
+    std::function<void(int)> split = [&](int depth)
+    {
+        if (depth == 0)
+        {
+            leaves++;
+            return;
+        }
+
+        pool.submit([&, depth](size_t) { split(depth - 1); });
+        pool.submit([&, depth](size_t) { split(depth - 1); });
+    };
+
+    pool.submit([&](size_t) { split(12); });
+    pool.wait();
+    EXPECT_EQ(leaves, 1 << 12);
+
+    // It can be used again.
+    pool.submit([&](size_t) { split(3); });
+    pool.wait();
+    EXPECT_EQ(leaves, (1 << 12) + 8);
+}
+
+
+TEST(ThreadPoolTest, TaskExceptionIsRethrown)
+{
+    ThreadPool pool(2);
+    std::atomic<int> ran(0);
+    for (int i = 0; i < 10; i++)
+    {
+        pool.submit([&, i](size_t)
+        {
+            ran++;
+            if (i == 5)
+                throw std::runtime_error("task failed");
+        });
+    }
+
+    EXPECT_THROW(pool.wait(), std::runtime_error);
+    EXPECT_EQ(ran, 10);
+
+    // The error has been reported so waiting again is fine.
+    pool.wait();
+}
+
+
+} // namespace deepC
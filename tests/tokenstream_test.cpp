@@ -0,0 +1,114 @@
+#include <string>
+#include <vector>
+#include <gtest/gtest.h>
+
+#include "clexer.h"
+#include "tokenstream.h"
+
+
+namespace deepC
+{
+
+
+TEST(TokenStreamTest, PushAndGet)
+{
+    TokenStream tokens(3);
+    for (uint32_t i = 0; i < 1000; i++)
+    {
+        tokens.push_back(TokenKind::Identifier, 0, i * 4, 3, Token::PrecededBySpace, i + 1);
+    }
+
+    ASSERT_EQ(tokens.size(), 1000u);
+    EXPECT_EQ(tokens.kind(999), TokenKind::Identifier);
+    EXPECT_EQ(tokens.offset(999), 3996u);
+    EXPECT_EQ(tokens.length(999), 3u);
+    EXPECT_EQ(tokens.identId(999), 1000u);
+    EXPECT_EQ(tokens.loc(10), SourceLoc(3, 40));
+
+    Token token = tokens[10];
+    EXPECT_TRUE(token.precededBySpace());
+    EXPECT_EQ(token.loc(), SourceLoc(3, 40));
+}
+
+
+TEST(TokenStreamTest, BlobRoundTrip)
+{
+    std::string text = "int main(void)\n{\n    return 'a' + 0x10;\n}\n";
+    TokenStream tokens;
+    CLexer lexer(text, 5);
+    lexer.lexAll(&tokens);
+    tokens.setIdentId(0, 42);
+
+    std::vector<uint32_t> blob((tokens.blobSize() + 3) / 4);
+    tokens.writeBlob(blob.data());
+
+    // Viewing the blob doesn't copy it.
+    TokenStream view;
+    ASSERT_TRUE(view.viewBlob(blob.data(), tokens.blobSize()));
+    EXPECT_EQ(view.kinds(), reinterpret_cast<const uint8_t *>(blob.data()) + tokens.blobSize() - 3 * tokens.size());
+
+    TokenStream copy;
+    ASSERT_TRUE(copy.assignBlob(blob.data(), tokens.blobSize()));
+
+    for (const TokenStream *stream : { &view, &copy })
+    {
+        ASSERT_EQ(stream->size(), tokens.size());
+        EXPECT_EQ(stream->fileId(), 5u);
+        EXPECT_EQ(stream->identId(0), 42u);
+        for (size_t i = 0; i < tokens.size(); i++)
+        {
+            EXPECT_EQ(stream->kind(i), tokens.kind(i));
+            EXPECT_EQ(stream->subKind(i), tokens.subKind(i));
+            EXPECT_EQ(stream->flags(i), tokens.flags(i));
+            EXPECT_EQ(stream->text(i, text), tokens.text(i, text));
+        }
+    }
+
+    // Changing a view copies it rather than writing to the blob.
+    view.push_back(TokenKind::Punctuator, 0, 100, 1, 0);
+    EXPECT_EQ(view.size(), tokens.size() + 1);
+    TokenStream again;
+    ASSERT_TRUE(again.viewBlob(blob.data(), tokens.blobSize()));
+    EXPECT_EQ(again.size(), tokens.size());
+}
+
+
+TEST(TokenStreamTest, AppendShifted)
+{
+    TokenStream from;
+    for (uint32_t i = 0; i < 100; i++)
+    {
+        from.push_back(TokenKind::PpNumber, 0, 10 + i * 2, 1, 0, i);
+    }
+
+    TokenStream tokens;
+    tokens.push_back(TokenKind::Identifier, 0, 0, 3, Token::StartOfLine);
+    tokens.append(from, 10, 20, -5);
+    tokens.append(from, 90, 100, 7);
+    ASSERT_EQ(tokens.size(), 21u);
+    EXPECT_EQ(tokens.kind(0), TokenKind::Identifier);
+    EXPECT_EQ(tokens.offset(1), 25u);
+    EXPECT_EQ(tokens.identId(10), 19u);
+    EXPECT_EQ(tokens.offset(11), 197u);
+    EXPECT_EQ(tokens.kind(20), TokenKind::PpNumber);
+}
+
+
+TEST(TokenStreamTest, BadBlob)
+{
+    TokenStream tokens;
+    tokens.push_back(TokenKind::Punctuator, 0, 0, 1, 0);
+
+    std::vector<char> blob(tokens.blobSize());
+    tokens.writeBlob(blob.data());
+
+    TokenStream read;
+    EXPECT_FALSE(read.assignBlob(blob.data(), blob.size() - 1));
+    EXPECT_TRUE(read.empty());
+
+    blob[0] = 'X';
+    EXPECT_FALSE(read.viewBlob(blob.data(), blob.size()));
+}
+
+
+} // namespace deepC